@@ -0,0 +1,235 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <stdlib.h>
+#include <time.h>
+#include <glib.h>
+
+#include <cutter.h>
+#include <cutter/cut-main.h>
+#include <cutter/cut-run-context.h>
+#include <cutter/cut-test-runner.h>
+#include <cutter/cut-test-suite.h>
+#include <cutter/cut-test-case.h>
+#include <cutter/cut-test-container.h>
+#include <cutter/cut-listener.h>
+#include <cutter/cut-stream.h>
+#include <cutter/cut-stream-parser.h>
+
+/*
+ * Measures CPU time that a parent process spends to parse
+ * the result stream of a child process for the XML stream
+ * and the binary stream. The same run is recorded by both
+ * streams and each recorded stream is parsed in 64KiB
+ * chunks like a pipe reader does.
+ *
+ * The number of tests can be specified as the first
+ * argument. Every tenth test fails. The stream modules are
+ * loaded from CUT_STREAM_MODULE_DIR when they aren't
+ * installed yet. "make benchmark" sets it.
+ */
+
+#define DEFAULT_N_TESTS 10000
+#define N_PARSES 10
+#define CHUNK_SIZE (64 * 1024)
+
+static guint n_runs = 0;
+
+static void
+stub_test (void)
+{
+    cut_assert_true(TRUE);
+    cut_assert_equal_int(1, 1);
+    cut_assert_equal_string("value", "value");
+    if ((n_runs++ % 10) == 9)
+        cut_assert_equal_string("expected value", "actual value");
+}
+
+static CutTestSuite *
+create_test_suite (guint n_tests)
+{
+    CutTestSuite *test_suite;
+    CutTestCase *test_case;
+    guint i;
+
+    test_suite = cut_test_suite_new_empty();
+    test_case = cut_test_case_new("test_stream", NULL, NULL, NULL, NULL);
+    for (i = 0; i < n_tests; i++) {
+        CutTest *test;
+        gchar *name;
+
+        name = g_strdup_printf("test_stub_%u", i);
+        test = cut_test_new(name, stub_test);
+        cut_test_container_add_test(CUT_TEST_CONTAINER(test_case), test);
+        g_object_unref(test);
+        g_free(name);
+    }
+    cut_test_suite_add_test_case(test_suite, test_case);
+    g_object_unref(test_case);
+
+    return test_suite;
+}
+
+static gboolean
+xml_stream_to_string (const gchar *message, GError **error, gpointer user_data)
+{
+    GString *string = user_data;
+
+    g_string_append(string, message);
+
+    return TRUE;
+}
+
+static gboolean
+binary_stream_to_string (const gchar *data, gsize length, GError **error,
+                         gpointer user_data)
+{
+    GString *string = user_data;
+
+    g_string_append_len(string, data, length);
+
+    return TRUE;
+}
+
+static gboolean
+record (CutTestSuite *test_suite, GString *xml, GString *binary)
+{
+    CutRunContext *run_context;
+    CutStream *xml_stream, *binary_stream;
+
+    xml_stream = cut_stream_new("xml",
+                                "stream-function", xml_stream_to_string,
+                                "stream-function-user-data", xml,
+                                NULL);
+    binary_stream = cut_stream_new("binary",
+                                   "stream-write-function",
+                                   binary_stream_to_string,
+                                   "stream-write-function-user-data", binary,
+                                   NULL);
+    if (!xml_stream || !binary_stream) {
+        g_print("  stream modules aren't found\n");
+        if (xml_stream)
+            g_object_unref(xml_stream);
+        if (binary_stream)
+            g_object_unref(binary_stream);
+        return FALSE;
+    }
+
+    run_context = cut_test_runner_new();
+    cut_run_context_set_test_suite(run_context, test_suite);
+    cut_listener_attach_to_run_context(CUT_LISTENER(xml_stream), run_context);
+    cut_listener_attach_to_run_context(CUT_LISTENER(binary_stream),
+                                       run_context);
+
+    cut_run_context_start(run_context);
+
+    cut_listener_detach_from_run_context(CUT_LISTENER(xml_stream),
+                                         run_context);
+    cut_listener_detach_from_run_context(CUT_LISTENER(binary_stream),
+                                         run_context);
+    g_object_unref(xml_stream);
+    g_object_unref(binary_stream);
+    g_object_unref(run_context);
+
+    return TRUE;
+}
+
+static gdouble
+parse (const gchar *label, const GString *stream)
+{
+    clock_t start_cpu_time;
+    gdouble cpu_time;
+    guint i, n_results = 0;
+    GError *error = NULL;
+
+    start_cpu_time = clock();
+    for (i = 0; i < N_PARSES && !error; i++) {
+        CutRunContext *run_context;
+        CutStreamParser *parser;
+        gsize offset;
+
+        run_context = cut_test_runner_new();
+        parser = cut_stream_parser_new(run_context);
+        for (offset = 0; offset < stream->len && !error; offset += CHUNK_SIZE) {
+            cut_stream_parser_parse(parser,
+                                    stream->str + offset,
+                                    MIN(CHUNK_SIZE, stream->len - offset),
+                                    &error);
+        }
+        if (!error)
+            cut_stream_parser_end_parse(parser, &error);
+        n_results = cut_run_context_get_n_tests(run_context);
+        g_object_unref(parser);
+        g_object_unref(run_context);
+    }
+    cpu_time = (gdouble)(clock() - start_cpu_time) / CLOCKS_PER_SEC / N_PARSES;
+
+    if (error) {
+        g_print("  %-8s %s\n", label, error->message);
+        g_error_free(error);
+        return -1.0;
+    }
+
+    g_print("  %-8s %8u tests (%8.1fKiB): %8.3fs CPU/parse\n",
+            label, n_results, stream->len / 1024.0, cpu_time);
+
+    return cpu_time;
+}
+
+int
+main (int argc, char *argv[])
+{
+    CutTestSuite *test_suite;
+    GString *xml, *binary;
+    guint n_tests;
+    gdouble xml_cpu_time, binary_cpu_time;
+
+    cut_init(&argc, &argv);
+
+    n_tests = DEFAULT_N_TESTS;
+    if (argc > 1)
+        n_tests = strtoul(argv[1], NULL, 10);
+
+    test_suite = create_test_suite(n_tests);
+    xml = g_string_new(NULL);
+    binary = g_string_new(NULL);
+    if (record(test_suite, xml, binary)) {
+        xml_cpu_time = parse("XML:", xml);
+        binary_cpu_time = parse("binary:", binary);
+        if (xml_cpu_time > 0.0 && binary_cpu_time > 0.0)
+            g_print("  %-8s %8.1fx less CPU time\n",
+                    "ratio:", xml_cpu_time / binary_cpu_time);
+    }
+
+    g_string_free(xml, TRUE);
+    g_string_free(binary, TRUE);
+    g_object_unref(test_suite);
+
+    cut_quit();
+
+    return EXIT_SUCCESS;
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
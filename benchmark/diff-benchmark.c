@@ -0,0 +1,156 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include <cutter/cut-main.h>
+#include <cutter/cut-public.h>
+#include <cutter/cut-sequence-matcher.h>
+
+/*
+ * Measures the differs and CutSequenceMatcher with texts
+ * from 10KiB to 10MiB. The "to" text is the "from" text
+ * with a few changed lines like a typical failed
+ * assertion for a large expected value.
+ *
+ * The max text size can be specified in KiB as the first
+ * argument. "diff-benchmark 1024" stops at 1MiB.
+ */
+
+#define DEFAULT_MAX_SIZE_IN_KB (10 * 1024)
+#define N_CHANGED_LINES 10
+
+static gchar *
+create_text (gsize size, gboolean changed)
+{
+    GString *text;
+    guint i, n_lines, changed_interval;
+
+    text = g_string_sized_new(size + 128);
+    for (i = 0; text->len < size; i++) {
+        g_string_append_printf(text,
+                               "line %08u: The quick brown fox jumps over "
+                               "the lazy dog.\n",
+                               i);
+    }
+    if (!changed)
+        return g_string_free(text, FALSE);
+
+    n_lines = i;
+    changed_interval = MAX(n_lines / N_CHANGED_LINES, 1);
+    for (i = changed_interval / 2; i < n_lines; i += changed_interval) {
+        gchar *prefix, *line;
+
+        prefix = g_strdup_printf("line %08u:", i);
+        line = g_strstr_len(text->str, text->len, prefix);
+        g_free(prefix);
+        if (line)
+            memcpy(line + strlen("line 00000000: The "), "QUICK", 5);
+    }
+
+    return g_string_free(text, FALSE);
+}
+
+static void
+report_diff (const gchar *label, GTimer *timer, gchar *diff)
+{
+    g_print("  %-16s %8.3fs (%" G_GSIZE_FORMAT " bytes)\n",
+            label, g_timer_elapsed(timer, NULL), strlen(diff));
+    g_free(diff);
+}
+
+static void
+report_matcher (const gchar *label, GTimer *timer, CutSequenceMatcher *matcher)
+{
+    gdouble ratio;
+
+    ratio = cut_sequence_matcher_get_ratio(matcher);
+    g_print("  %-16s %8.3fs (ratio: %.3f%s)\n",
+            label, g_timer_elapsed(timer, NULL), ratio,
+            cut_sequence_matcher_is_coarse(matcher) ? ", coarse" : "");
+    g_object_unref(matcher);
+}
+
+static void
+run (gsize size)
+{
+    GTimer *timer;
+    gchar *from, *to;
+    gchar **from_lines, **to_lines;
+
+    from = create_text(size, FALSE);
+    to = create_text(size, TRUE);
+    from_lines = g_strsplit(from, "\n", 0);
+    to_lines = g_strsplit(to, "\n", 0);
+    g_print("%.0fKiB:\n", size / 1024.0);
+
+    timer = g_timer_new();
+
+    g_timer_start(timer);
+    report_diff("readable diff:", timer, cut_diff_readable(from, to));
+
+    g_timer_start(timer);
+    report_diff("unified diff:", timer,
+                cut_diff_unified(from, to, "from", "to"));
+
+    g_timer_start(timer);
+    report_matcher("line matcher:", timer,
+                   cut_sequence_matcher_string_new(from_lines, to_lines));
+
+    g_timer_start(timer);
+    report_matcher("char matcher:", timer,
+                   cut_sequence_matcher_char_new(from, to));
+
+    g_timer_destroy(timer);
+    g_strfreev(from_lines);
+    g_strfreev(to_lines);
+    g_free(from);
+    g_free(to);
+}
+
+int
+main (int argc, char *argv[])
+{
+    gsize size, max_size;
+
+    cut_init(&argc, &argv);
+
+    max_size = DEFAULT_MAX_SIZE_IN_KB;
+    if (argc > 1)
+        max_size = strtoul(argv[1], NULL, 10);
+    max_size *= 1024;
+
+    for (size = 10 * 1024; size <= max_size; size *= 10) {
+        run(size);
+    }
+
+    cut_quit();
+
+    return EXIT_SUCCESS;
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
@@ -0,0 +1,96 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <stdlib.h>
+#include <glib.h>
+
+#include <cutter/cut-main.h>
+#include <cutter/cut-run-context.h>
+#include <cutter/cut-test-runner.h>
+#include <cutter/cut-scheduler.h>
+
+/*
+ * Measures how many "pass-assertion" signals a run context
+ * accepts per second while N threads emit them.
+ */
+
+#define N_ASSERTIONS_PER_TASK 100000
+
+static void
+pass_assertions (gpointer data, gpointer user_data)
+{
+    CutRunContext *run_context = user_data;
+    gint i;
+
+    for (i = 0; i < N_ASSERTIONS_PER_TASK; i++) {
+        g_signal_emit_by_name(run_context, "pass-assertion", NULL, NULL);
+    }
+}
+
+static void
+run (gint n_threads)
+{
+    CutRunContext *run_context;
+    CutScheduler *scheduler;
+    CutSchedulerGroup *group;
+    GTimer *timer;
+    gdouble elapsed;
+    guint n_assertions;
+    gint i;
+
+    run_context = cut_test_runner_new();
+    scheduler = cut_scheduler_new(n_threads);
+
+    timer = g_timer_new();
+    group = cut_scheduler_group_new(scheduler, pass_assertions, run_context);
+    for (i = 0; i < n_threads; i++)
+        cut_scheduler_group_push(group, NULL);
+    cut_scheduler_group_join(group);
+    elapsed = g_timer_elapsed(timer, NULL);
+    g_timer_destroy(timer);
+
+    n_assertions = cut_run_context_get_n_assertions(run_context);
+    g_print("  %2d thread(s): %10u assertions in %.3fs: %12.0f assertions/s\n",
+            n_threads, n_assertions, elapsed, n_assertions / elapsed);
+
+    cut_scheduler_free(scheduler);
+    g_object_unref(run_context);
+}
+
+int
+main (int argc, char *argv[])
+{
+    gint n_threads;
+
+    cut_init(&argc, &argv);
+    for (n_threads = 1; n_threads <= 8; n_threads *= 2) {
+        run(n_threads);
+    }
+    cut_quit();
+
+    return EXIT_SUCCESS;
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
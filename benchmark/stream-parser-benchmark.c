@@ -0,0 +1,171 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <stdlib.h>
+#include <glib.h>
+
+#include <cutter/cut-main.h>
+#include <cutter/cut-stream-parser.h>
+
+/*
+ * Measures throughput of the XML stream parser with
+ * CutXMLPullParser and with GMarkupParseContext. A
+ * synthetic stream that has many test results is fed in
+ * 64KiB chunks like a pipe reader does.
+ *
+ * The stream size can be specified in MiB as the first
+ * argument. "stream-parser-benchmark 1024" parses a 1GiB
+ * stream.
+ */
+
+#define DEFAULT_STREAM_SIZE_IN_MB 64
+#define CHUNK_SIZE (64 * 1024)
+
+static const gchar result_format[] =
+    "  <test-result>\n"
+    "    <test>\n"
+    "      <name>test_%u</name>\n"
+    "    </test>\n"
+    "    <test-context>\n"
+    "      <test-case>\n"
+    "        <name>test_stream_parser</name>\n"
+    "      </test-case>\n"
+    "      <test>\n"
+    "        <name>test_%u</name>\n"
+    "      </test>\n"
+    "      <failed>TRUE</failed>\n"
+    "    </test-context>\n"
+    "    <result>\n"
+    "      <test-case>\n"
+    "        <name>test_stream_parser</name>\n"
+    "      </test-case>\n"
+    "      <test>\n"
+    "        <name>test_%u</name>\n"
+    "      </test>\n"
+    "      <status>failure</status>\n"
+    "      <detail>&lt;%u&gt; == value &amp;&amp; value != 0</detail>\n"
+    "      <backtrace>\n"
+    "        <entry>\n"
+    "          <file>test-stream-parser.c</file>\n"
+    "          <line>%u</line>\n"
+    "          <info>test_%u()</info>\n"
+    "        </entry>\n"
+    "      </backtrace>\n"
+    "      <start-time>2014-01-01T00:00:00Z</start-time>\n"
+    "      <elapsed>0.000100</elapsed>\n"
+    "    </result>\n"
+    "  </test-result>\n";
+
+static GString *
+create_results_chunk (void)
+{
+    GString *chunk;
+    guint i;
+
+    chunk = g_string_new(NULL);
+    for (i = 0; chunk->len < CHUNK_SIZE; i++) {
+        g_string_append_printf(chunk, result_format, i, i, i, i, i, i);
+    }
+
+    return chunk;
+}
+
+static void
+cb_result (CutStreamParser *parser, CutTestResult *result, gpointer data)
+{
+    guint *n_results = data;
+
+    (*n_results)++;
+}
+
+static void
+run (const GString *chunk, gsize stream_size, gboolean use_pull_parser)
+{
+    CutStreamParser *parser;
+    GTimer *timer;
+    GError *error = NULL;
+    gdouble elapsed;
+    gsize parsed_size = 0;
+    guint n_results = 0;
+    const gchar header[] = "<stream>\n";
+    const gchar footer[] = "</stream>\n";
+
+    parser = g_object_new(CUT_TYPE_STREAM_PARSER,
+                          "use-pull-parser", use_pull_parser,
+                          NULL);
+    g_signal_connect(parser, "result", G_CALLBACK(cb_result), &n_results);
+
+    timer = g_timer_new();
+    cut_stream_parser_parse(parser, header, sizeof(header) - 1, &error);
+    while (!error && parsed_size < stream_size) {
+        cut_stream_parser_parse(parser, chunk->str, chunk->len, &error);
+        parsed_size += chunk->len;
+    }
+    if (!error)
+        cut_stream_parser_parse(parser, footer, sizeof(footer) - 1, &error);
+    if (!error)
+        cut_stream_parser_end_parse(parser, &error);
+    elapsed = g_timer_elapsed(timer, NULL);
+    g_timer_destroy(timer);
+
+    if (error) {
+        g_print("  %-16s %s\n",
+                use_pull_parser ? "pull parser:" : "GMarkup:",
+                error->message);
+        g_error_free(error);
+    } else {
+        g_print("  %-16s %8u results (%.1fMiB) in %.3fs: %8.3fMiB/s\n",
+                use_pull_parser ? "pull parser:" : "GMarkup:",
+                n_results, parsed_size / 1024.0 / 1024.0, elapsed,
+                parsed_size / 1024.0 / 1024.0 / elapsed);
+    }
+
+    g_object_unref(parser);
+}
+
+int
+main (int argc, char *argv[])
+{
+    GString *chunk;
+    gsize stream_size;
+
+    cut_init(&argc, &argv);
+
+    stream_size = DEFAULT_STREAM_SIZE_IN_MB;
+    if (argc > 1)
+        stream_size = strtoul(argv[1], NULL, 10);
+    stream_size *= 1024 * 1024;
+
+    chunk = create_results_chunk();
+    run(chunk, stream_size, TRUE);
+    run(chunk, stream_size, FALSE);
+    g_string_free(chunk, TRUE);
+
+    cut_quit();
+
+    return EXIT_SUCCESS;
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
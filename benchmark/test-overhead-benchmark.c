@@ -0,0 +1,126 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <stdlib.h>
+#include <glib.h>
+
+#include <cutter/cut-main.h>
+#include <cutter/cut-run-context.h>
+#include <cutter/cut-test-runner.h>
+#include <cutter/cut-test-suite.h>
+#include <cutter/cut-test-case.h>
+#include <cutter/cut-test-container.h>
+
+/*
+ * Measures framework overhead per test by running a test
+ * case that has many empty tests. It is measured with and
+ * without a listener that receives each test event.
+ */
+
+#define N_TESTS 100000
+
+static void
+empty_test (void)
+{
+}
+
+static void
+cb_complete_test (CutRunContext *run_context, CutTest *test,
+                  CutTestContext *test_context, gboolean success,
+                  gpointer data)
+{
+    guint *n_completed_tests = data;
+
+    (*n_completed_tests)++;
+}
+
+static CutTestSuite *
+create_test_suite (void)
+{
+    CutTestSuite *test_suite;
+    CutTestCase *test_case;
+    gint i;
+
+    test_suite = cut_test_suite_new_empty();
+    test_case = cut_test_case_new("test_overhead", NULL, NULL, NULL, NULL);
+    for (i = 0; i < N_TESTS; i++) {
+        CutTest *test;
+        gchar *name;
+
+        name = g_strdup_printf("test_empty_%d", i);
+        test = cut_test_new(name, empty_test);
+        cut_test_container_add_test(CUT_TEST_CONTAINER(test_case), test);
+        g_object_unref(test);
+        g_free(name);
+    }
+    cut_test_suite_add_test_case(test_suite, test_case);
+    g_object_unref(test_case);
+
+    return test_suite;
+}
+
+static void
+run (CutTestSuite *test_suite, gboolean with_listener)
+{
+    CutRunContext *run_context;
+    GTimer *timer;
+    gdouble elapsed;
+    guint n_tests, n_completed_tests = 0;
+
+    run_context = cut_test_runner_new();
+    cut_run_context_set_test_suite(run_context, test_suite);
+    if (with_listener)
+        g_signal_connect(run_context, "complete-test",
+                         G_CALLBACK(cb_complete_test), &n_completed_tests);
+
+    timer = g_timer_new();
+    cut_test_runner_run_test_suite(CUT_TEST_RUNNER(run_context), test_suite);
+    elapsed = g_timer_elapsed(timer, NULL);
+    g_timer_destroy(timer);
+
+    n_tests = cut_run_context_get_n_tests(run_context);
+    g_print("  %-16s %8u tests in %.3fs: %8.3fus/test\n",
+            with_listener ? "with listener:" : "without listener:",
+            n_tests, elapsed, elapsed * 1000000 / n_tests);
+
+    g_object_unref(run_context);
+}
+
+int
+main (int argc, char *argv[])
+{
+    CutTestSuite *test_suite;
+
+    cut_init(&argc, &argv);
+    test_suite = create_test_suite();
+    run(test_suite, FALSE);
+    run(test_suite, TRUE);
+    g_object_unref(test_suite);
+    cut_quit();
+
+    return EXIT_SUCCESS;
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
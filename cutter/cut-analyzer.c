@@ -1,6 +1,6 @@
 /* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
 /*
- *  Copyright (C) 2008-2010  Kouhei Sutou <kou@clear-code.com>
+ *  Copyright (C) 2008-2014  Kouhei Sutou <kou@clear-code.com>
  *
  *  This library is free software: you can redistribute it and/or modify
  *  it under the terms of the GNU Lesser General Public License as published by
@@ -25,14 +25,37 @@
 #include <glib-compatible/glib-compatible.h>
 
 #include "cut-analyzer.h"
-#include "cut-file-stream-reader.h"
+#include "cut-log-index.h"
+#include "cut-scheduler.h"
+#include "cut-stream-parser.h"
+#include "cut-stream-reader.h"
+#include "cut-backtrace-entry.h"
+#include "cut-iterated-test.h"
+#include "cut-test-case.h"
+#include "cut-test-context.h"
+#include "cut-test-data.h"
+#include "cut-test-iterator.h"
+#include "cut-test-result.h"
+#include "cut-test-suite.h"
+#include "cut-logger.h"
 
 #define CUT_ANALYZER_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE((obj), CUT_TYPE_ANALYZER, CutAnalyzerPrivate))
 
 typedef struct _CutAnalyzerPrivate	CutAnalyzerPrivate;
 struct _CutAnalyzerPrivate
 {
-    GList *run_contexts;
+    GList *run_summaries;
+    gint max_threads;
+};
+
+typedef struct _LogTask LogTask;
+struct _LogTask
+{
+    gchar *log_name;
+    gchar *file_name;
+    CutRunSummary *summary;
+    gboolean parsed;
+    GError *error;
 };
 
 G_DEFINE_TYPE(CutAnalyzer, cut_analyzer, G_TYPE_OBJECT)
@@ -56,7 +79,18 @@ cut_analyzer_init (CutAnalyzer *analyzer)
 {
     CutAnalyzerPrivate *priv = CUT_ANALYZER_GET_PRIVATE(analyzer);
 
-    priv->run_contexts = FALSE;
+    priv->run_summaries = NULL;
+    priv->max_threads = 1;
+}
+
+static void
+free_run_summaries (CutAnalyzerPrivate *priv)
+{
+    if (priv->run_summaries) {
+        g_list_foreach(priv->run_summaries, (GFunc)cut_run_summary_free, NULL);
+        g_list_free(priv->run_summaries);
+        priv->run_summaries = NULL;
+    }
 }
 
 static void
@@ -64,11 +98,7 @@ dispose (GObject *object)
 {
     CutAnalyzerPrivate *priv = CUT_ANALYZER_GET_PRIVATE(object);
 
-    if (priv->run_contexts) {
-        g_list_foreach(priv->run_contexts, (GFunc)g_object_unref, NULL);
-        g_list_free(priv->run_contexts);
-        priv->run_contexts = NULL;
-    }
+    free_run_summaries(priv);
 
     G_OBJECT_CLASS(cut_analyzer_parent_class)->dispose(object);
 }
@@ -79,12 +109,87 @@ cut_analyzer_new (void)
     return g_object_new(CUT_TYPE_ANALYZER, NULL);
 }
 
+void
+cut_analyzer_set_max_threads (CutAnalyzer *analyzer, gint max_threads)
+{
+    CUT_ANALYZER_GET_PRIVATE(analyzer)->max_threads = max_threads;
+}
+
+gint
+cut_analyzer_get_max_threads (CutAnalyzer *analyzer)
+{
+    return CUT_ANALYZER_GET_PRIVATE(analyzer)->max_threads;
+}
+
+static void
+ensure_stream_types (void)
+{
+    /* GType registration isn't thread-safe on old GLib. */
+    g_type_class_unref(g_type_class_ref(CUT_TYPE_STREAM_READER));
+    g_type_class_unref(g_type_class_ref(CUT_TYPE_STREAM_PARSER));
+    g_type_class_unref(g_type_class_ref(CUT_TYPE_TEST_SUITE));
+    g_type_class_unref(g_type_class_ref(CUT_TYPE_TEST_CASE));
+    g_type_class_unref(g_type_class_ref(CUT_TYPE_TEST_ITERATOR));
+    g_type_class_unref(g_type_class_ref(CUT_TYPE_ITERATED_TEST));
+    g_type_class_unref(g_type_class_ref(CUT_TYPE_TEST_CONTEXT));
+    g_type_class_unref(g_type_class_ref(CUT_TYPE_TEST_DATA));
+    g_type_class_unref(g_type_class_ref(CUT_TYPE_TEST_RESULT));
+    g_type_class_unref(g_type_class_ref(CUT_TYPE_BACKTRACE_ENTRY));
+}
+
+static void
+parse_log (gpointer data, gpointer user_data)
+{
+    LogTask *task = data;
+
+    task->summary = cut_run_summary_new_from_log(task->file_name,
+                                                 &(task->error));
+    task->parsed = TRUE;
+}
+
+static gint
+compare_log_task (gconstpointer a, gconstpointer b)
+{
+    const LogTask *task1 = a;
+    const LogTask *task2 = b;
+
+    return g_utf8_collate(task2->log_name, task1->log_name);
+}
+
 static void
-error_cb (CutRunContext *context, GError *error, gpointer user_data)
+log_task_free (LogTask *task)
 {
-    GError **user_error = user_data;
+    g_free(task->log_name);
+    g_free(task->file_name);
+    if (task->summary)
+        cut_run_summary_free(task->summary);
+    if (task->error)
+        g_error_free(task->error);
+    g_slice_free(LogTask, task);
+}
+
+static void
+parse_logs (CutAnalyzerPrivate *priv, GList *tasks)
+{
+    GList *node;
 
-    *user_error = g_error_copy(error);
+    if (priv->max_threads != 1 && tasks && g_list_next(tasks)) {
+        CutScheduler *scheduler;
+        CutSchedulerGroup *group;
+
+        ensure_stream_types();
+        scheduler = cut_scheduler_new(priv->max_threads);
+        group = cut_scheduler_group_new(scheduler, parse_log, NULL);
+        for (node = tasks; node; node = g_list_next(node)) {
+            cut_scheduler_group_push(group, node->data);
+        }
+        cut_scheduler_group_join(group);
+        cut_scheduler_free(scheduler);
+    } else {
+        for (node = tasks; node; node = g_list_next(node)) {
+            parse_log(node->data, NULL);
+        }
+    }
 }
 
 gboolean
@@ -92,13 +197,16 @@ cut_analyzer_analyze (CutAnalyzer *analyzer, const gchar *log_directory,
                       GError **error)
 {
     CutAnalyzerPrivate *priv;
+    CutLogIndex *index;
     GDir *log_dir;
     const gchar *name;
-    GList *names = NULL;
+    GList *tasks = NULL, *parse_tasks = NULL;
     GList *node;
-    gboolean success =TRUE;
+    GError *index_error = NULL;
+    gboolean success = TRUE;
 
     priv = CUT_ANALYZER_GET_PRIVATE(analyzer);
+    free_run_summaries(priv);
 
     log_dir = g_dir_open(log_directory, 0, error);
     if (!log_dir)
@@ -106,42 +214,73 @@ cut_analyzer_analyze (CutAnalyzer *analyzer, const gchar *log_directory,
 
     while ((name = g_dir_read_name(log_dir))) {
         if (g_regex_match_simple("^\\d{4}(?:-\\d{2}){5}\\.xml$", name, 0, 0)) {
-            gchar *file_name;
+            LogTask *task;
 
-            file_name = g_build_filename(log_directory, name, NULL);
-            names = g_list_prepend(names, file_name);
+            task = g_slice_new0(LogTask);
+            task->log_name = g_strdup(name);
+            task->file_name = g_build_filename(log_directory, name, NULL);
+            tasks = g_list_prepend(tasks, task);
         }
     }
     g_dir_close(log_dir);
 
-    names = g_list_reverse(g_list_sort(names, (GCompareFunc)g_utf8_collate));
-    for (node = names; node && success; node = g_list_next(node)) {
-        gchar *file_name = node->data;
-        CutRunContext *reader;
-        GError *local_error = NULL;
-
-        reader = cut_file_stream_reader_new(file_name);
-        g_signal_connect(reader, "error", G_CALLBACK(error_cb), &local_error);
-        priv->run_contexts = g_list_append(priv->run_contexts, reader);
-        cut_run_context_start(reader);
-        if (local_error) {
-            success = FALSE;
-            g_propagate_error(error, local_error);
+    index = cut_log_index_new(log_directory);
+    if (!cut_log_index_load(index, &index_error)) {
+        cut_log_warning("[analyzer][log-index][load][error] <%s>: %s",
+                        cut_log_index_get_file_name(index),
+                        index_error->message);
+        g_clear_error(&index_error);
+    }
+
+    for (node = tasks; node; node = g_list_next(node)) {
+        LogTask *task = node->data;
+
+        task->summary = cut_log_index_lookup(index, task->log_name);
+        if (!task->summary)
+            parse_tasks = g_list_prepend(parse_tasks, task);
+    }
+    parse_logs(priv, parse_tasks);
+
+    /* newest first */
+    tasks = g_list_sort(tasks, (GCompareFunc)compare_log_task);
+    for (node = tasks; node; node = g_list_next(node)) {
+        LogTask *task = node->data;
+
+        if (task->error) {
+            if (success) {
+                success = FALSE;
+                g_propagate_error(error, task->error);
+                task->error = NULL;
+            }
+            continue;
         }
+        if (task->parsed)
+            cut_log_index_store(index, task->summary);
+        priv->run_summaries = g_list_prepend(priv->run_summaries,
+                                             task->summary);
+        task->summary = NULL;
     }
+    priv->run_summaries = g_list_reverse(priv->run_summaries);
 
-    if (names) {
-        g_list_foreach(names, (GFunc)g_free, NULL);
-        g_list_free(names);
+    if (!cut_log_index_save(index, &index_error)) {
+        cut_log_warning("[analyzer][log-index][save][error] <%s>: %s",
+                        cut_log_index_get_file_name(index),
+                        index_error->message);
+        g_error_free(index_error);
     }
+    cut_log_index_free(index);
+
+    g_list_free(parse_tasks);
+    g_list_foreach(tasks, (GFunc)log_task_free, NULL);
+    g_list_free(tasks);
 
     return success;
 }
 
 const GList *
-cut_analyzer_get_run_contexts (CutAnalyzer *analyzer)
+cut_analyzer_get_run_summaries (CutAnalyzer *analyzer)
 {
-    return CUT_ANALYZER_GET_PRIVATE(analyzer)->run_contexts;
+    return CUT_ANALYZER_GET_PRIVATE(analyzer)->run_summaries;
 }
 
 
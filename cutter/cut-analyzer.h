@@ -22,6 +22,8 @@
 
 #include <glib-object.h>
 
+#include <cutter/cut-run-summary.h>
+
 G_BEGIN_DECLS
 
 #define CUT_TYPE_ANALYZER            (cut_analyzer_get_type ())
@@ -48,11 +50,17 @@ GType          cut_analyzer_get_type  (void) G_GNUC_CONST;
 
 CutAnalyzer   *cut_analyzer_new       (void);
 
+void           cut_analyzer_set_max_threads
+                                      (CutAnalyzer  *analyzer,
+                                       gint          max_threads);
+gint           cut_analyzer_get_max_threads
+                                      (CutAnalyzer  *analyzer);
+
 gboolean       cut_analyzer_analyze   (CutAnalyzer  *analyzer,
                                        const gchar  *log_directory,
                                        GError      **error);
 
-const GList   *cut_analyzer_get_run_contexts
+const GList   *cut_analyzer_get_run_summaries
                                       (CutAnalyzer  *analyzer);
 
 G_END_DECLS
@@ -1,6 +1,6 @@
 /* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
 /*
- *  Copyright (C) 2008-2011  Kouhei Sutou <kou@clear-code.com>
+ *  Copyright (C) 2008-2014  Kouhei Sutou <kou@clear-code.com>
  *
  *  This library is free software: you can redistribute it and/or modify
  *  it under the terms of the GNU Lesser General Public License as published by
@@ -68,6 +68,9 @@
 #include <errno.h>
 
 #include "cut-helper.h"
+#include "cut-utils.h"
+#include "cut-test-context.h"
+#include "cut-run-context.h"
 #include <gcutter/gcut-assertions-helper.h>
 
 void
@@ -1234,6 +1237,81 @@ cut_assert_not_equal_substring_helper (const char     *expected,
     }
 }
 
+static cut_boolean
+is_full_memory_dump (void)
+{
+    CutTestContext *test_context;
+    CutRunContext *run_context;
+
+    test_context = cut_get_current_test_context();
+    if (!test_context)
+        return FALSE;
+    run_context = cut_test_context_get_run_context(test_context);
+
+    return run_context && cut_run_context_get_full_memory_dump(run_context);
+}
+
+/*
+ * Small memories are inspected as is. Large memories are
+ * inspected as hex dump rows around differences because
+ * inspecting and diffing whole multi-MB memories is too
+ * slow and too noisy. The returned string describes the
+ * differences for the failure message.
+ */
+static const char *
+inspect_memory_difference (const void     *expected,
+                           size_t          expected_size,
+                           const void     *actual,
+                           size_t          actual_size,
+                           const char    **inspected_expected,
+                           const char    **inspected_actual)
+{
+    CutMemoryDifference difference;
+    gboolean found;
+    gchar *expected_dump, *actual_dump;
+
+    if (MAX(expected_size, actual_size) <= CUT_UTILS_INSPECT_MEMORY_MAX_SIZE) {
+        *inspected_expected =
+            cut_take_printf("%s (size: %" G_GSIZE_FORMAT ")",
+                            cut_take_string(
+                                cut_utils_inspect_memory(expected,
+                                                         expected_size)),
+                            expected_size);
+        *inspected_actual =
+            cut_take_printf("%s (size: %" G_GSIZE_FORMAT ")",
+                            cut_take_string(
+                                cut_utils_inspect_memory(actual,
+                                                         actual_size)),
+                            actual_size);
+        return "";
+    }
+
+    found = cut_utils_find_memory_difference(expected, expected_size,
+                                             actual, actual_size,
+                                             &difference);
+    cut_utils_inspect_memory_difference(expected, expected_size,
+                                        actual, actual_size,
+                                        found ? &difference : NULL,
+                                        is_full_memory_dump(),
+                                        &expected_dump, &actual_dump);
+    *inspected_expected = cut_take_printf("%s\n(size: %" G_GSIZE_FORMAT ")",
+                                          expected_dump, expected_size);
+    *inspected_actual = cut_take_printf("%s\n(size: %" G_GSIZE_FORMAT ")",
+                                        actual_dump, actual_size);
+    g_free(expected_dump);
+    g_free(actual_dump);
+
+    if (!found)
+        return "";
+
+    return cut_take_printf(": %" G_GSIZE_FORMAT " byte(s) differ "
+                           "between 0x%08" G_GSIZE_MODIFIER "x "
+                           "and 0x%08" G_GSIZE_MODIFIER "x",
+                           difference.n_differences,
+                           difference.first,
+                           difference.last);
+}
+
 void
 cut_assert_equal_memory_helper (const void     *expected,
                                 size_t          expected_size,
@@ -1244,30 +1322,28 @@ cut_assert_equal_memory_helper (const void     *expected,
                                 const char     *expression_actual,
                                 const char     *expression_actual_size)
 {
-    if (expected_size == actual_size &&
-        memcmp(expected, actual, expected_size) == 0) {
+    if (cut_utils_equal_memory(expected, expected_size,
+                               actual, actual_size)) {
         cut_test_pass();
     } else {
         const char *message;
         const char *inspected_expected;
         const char *inspected_actual;
+        const char *difference;
 
-        inspected_expected =
-            cut_take_string(cut_utils_inspect_memory(expected, expected_size));
-        inspected_actual =
-            cut_take_string(cut_utils_inspect_memory(actual, actual_size));
+        difference = inspect_memory_difference(expected, expected_size,
+                                               actual, actual_size,
+                                               &inspected_expected,
+                                               &inspected_actual);
         message = cut_take_printf(
-            "<%s(size: %s) == %s(size: %s)>",
+            "<%s(size: %s) == %s(size: %s)>%s",
             expression_expected,
             expression_expected_size,
             expression_actual,
-            expression_actual_size);
-        cut_set_expected(cut_take_printf("%s (size: %" G_GSIZE_FORMAT ")",
-                                         inspected_expected,
-                                         expected_size));
-        cut_set_actual(cut_take_printf("%s (size: %" G_GSIZE_FORMAT ")",
-                                       inspected_actual,
-                                       actual_size));
+            expression_actual_size,
+            difference);
+        cut_set_expected(inspected_expected);
+        cut_set_actual(inspected_actual);
         cut_test_fail(message);
     }
 }
@@ -1282,8 +1358,8 @@ cut_assert_not_equal_memory_helper (const void     *expected,
                                     const char     *expression_actual,
                                     const char     *expression_actual_size)
 {
-    if ((expected_size != actual_size) ||
-        memcmp(expected, actual, expected_size) != 0) {
+    if (!cut_utils_equal_memory(expected, expected_size,
+                                actual, actual_size)) {
         cut_test_pass();
     } else {
         const char *message;
@@ -1589,32 +1665,29 @@ cut_assert_equal_file_raw_helper (const char     *expected,
     gcut_assert_error_helper(error, expression_actual);
     cut_take_string(actual_data);
 
-    if ((expected_size == actual_size) &&
-        memcmp(expected_data, actual_data, expected_size) == 0) {
+    if (cut_utils_equal_memory(expected_data, expected_size,
+                               actual_data, actual_size)) {
         cut_test_pass();
     } else {
         const char *message;
         const char *inspected_expected;
         const char *inspected_actual;
+        const char *difference;
 
-        inspected_expected =
-            cut_take_string(cut_utils_inspect_memory(expected_data,
-                                                     expected_size));
-        inspected_actual =
-            cut_take_string(cut_utils_inspect_memory(actual_data, actual_size));
-        message = cut_take_printf("<content(%s) == content(%s)>",
+        difference = inspect_memory_difference(expected_data, expected_size,
+                                               actual_data, actual_size,
+                                               &inspected_expected,
+                                               &inspected_actual);
+        message = cut_take_printf("<content(%s) == content(%s)>%s",
                                   expression_expected,
-                                  expression_actual);
-        cut_set_expected(cut_take_printf("path: <%s>\n"
-                                         "%s (size: %" G_GSIZE_FORMAT ")",
+                                  expression_actual,
+                                  difference);
+        cut_set_expected(cut_take_printf("path: <%s>\n%s",
                                          expected,
-                                         inspected_expected,
-                                         expected_size));
-        cut_set_actual(cut_take_printf("path: <%s>\n"
-                                       "%s (size: %" G_GSIZE_FORMAT ")",
+                                         inspected_expected));
+        cut_set_actual(cut_take_printf("path: <%s>\n%s",
                                        actual,
-                                       inspected_actual,
-                                       actual_size));
+                                       inspected_actual));
         cut_test_fail(message);
     }
 }
@@ -1639,8 +1712,8 @@ cut_assert_not_equal_file_raw_helper (const char     *expected,
     gcut_assert_error_helper(error, expression_actual);
     cut_take_string(actual_data);
 
-    if ((expected_size != actual_size) ||
-        memcmp(expected_data, actual_data, expected_size) != 0) {
+    if (!cut_utils_equal_memory(expected_data, expected_size,
+                                actual_data, actual_size)) {
         cut_test_pass();
     } else {
         const char *message;
@@ -1,6 +1,6 @@
 /* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
 /*
- *  Copyright (C) 2007-2010  Kouhei Sutou <kou@clear-code.com>
+ *  Copyright (C) 2007-2014  Kouhei Sutou <kou@clear-code.com>
  *
  *  This library is free software: you can redistribute it and/or modify
  *  it under the terms of the GNU Lesser General Public License as published by
@@ -1563,6 +1563,10 @@ extern "C" {
  *
  * Passes if @expected_size == @actual_size and
  * memcmp(@expected, @actual, @expected_size) == 0.
+ *
+ * If @expected or @actual is larger than 1KiB, only hex
+ * dump rows around differences are shown on failure. Use
+ * --full-memory-dump option to show them as a whole.
  */
 #define cut_assert_equal_memory(expected, expected_size,                \
                                 actual, actual_size, ...) do            \
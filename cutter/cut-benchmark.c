@@ -0,0 +1,252 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <glib.h>
+
+#include "cut-benchmark.h"
+#include "cut-run-context.h"
+#include "cut-logger.h"
+#include "cut-utils.h"
+
+/* The number of measured samples. */
+#define N_SAMPLES 10
+/* Calibration never grows iterations more than this times at
+ * once. It keeps a function that is slow only sometimes from
+ * making a too long sample. */
+#define MAX_ITERATIONS_GROWTH 100
+#define MAX_ITERATIONS G_GUINT64_CONSTANT(1000000000)
+
+G_DEFINE_TYPE(CutBenchmark, cut_benchmark, CUT_TYPE_TEST)
+
+static void invoke (CutTest        *test,
+                    CutTestContext *test_context,
+                    CutRunContext  *run_context);
+
+static void
+cut_benchmark_class_init (CutBenchmarkClass *klass)
+{
+    CutTestClass *test_class;
+
+    test_class = CUT_TEST_CLASS(klass);
+    test_class->invoke = invoke;
+}
+
+static void
+cut_benchmark_init (CutBenchmark *benchmark)
+{
+}
+
+CutBenchmark *
+cut_benchmark_new (const gchar *name, CutTestFunction function)
+{
+    return g_object_new(CUT_TYPE_BENCHMARK,
+                        "element-name", "test",
+                        "name", name,
+                        "test-function", function,
+                        NULL);
+}
+
+CutBenchmark *
+cut_benchmark_new_empty (void)
+{
+    return cut_benchmark_new(NULL, NULL);
+}
+
+gboolean
+cut_benchmark_is_target (CutBenchmark *benchmark, CutRunContext *run_context)
+{
+    CutTest *test;
+    const gchar **filter;
+    GList *regexs;
+    gboolean matched;
+
+    filter = cut_run_context_get_benchmark_filter(run_context);
+    if (!filter)
+        return FALSE;
+
+    regexs = cut_utils_filter_to_regexs(filter);
+    if (!regexs)
+        return FALSE;
+
+    test = CUT_TEST(benchmark);
+    matched = cut_utils_filter_match(regexs, cut_test_get_name(test)) ||
+        cut_utils_filter_match(regexs, cut_test_get_full_name(test));
+    g_list_foreach(regexs, (GFunc)g_regex_unref, NULL);
+    g_list_free(regexs);
+
+    return matched;
+}
+
+static gdouble
+get_min_time (CutTest *test, CutRunContext *run_context)
+{
+    const gchar *value;
+
+    value = cut_test_get_attribute(test, "benchmark-min-time");
+    if (value) {
+        gchar *end;
+        gdouble min_time;
+
+        min_time = g_ascii_strtod(value, &end);
+        if (end != value && end[0] == '\0' && min_time >= 0.0)
+            return min_time;
+        cut_log_warning("[benchmark] invalid min time attribute value: "
+                        "<%s>: <%s>",
+                        cut_test_get_name(test), value);
+    }
+
+    return cut_run_context_get_benchmark_min_time(run_context);
+}
+
+static gdouble
+run_iterations (CutTestFunction function, guint64 n_iterations)
+{
+    guint64 i, start;
+
+    start = cut_utils_get_monotonic_time();
+    for (i = 0; i < n_iterations; i++)
+        function();
+
+    return (cut_utils_get_monotonic_time() - start) / 1e9;
+}
+
+/*
+ * Returns the number of iterations that takes sample_time at
+ * least. Runs during calibration also warm up caches.
+ */
+static guint64
+calibrate (CutTestFunction function, gdouble sample_time)
+{
+    guint64 n_iterations = 1;
+
+    while (TRUE) {
+        gdouble elapsed;
+        guint64 next_n_iterations;
+
+        elapsed = run_iterations(function, n_iterations);
+        if (elapsed >= sample_time || n_iterations >= MAX_ITERATIONS)
+            break;
+
+        if (elapsed <= 0.0)
+            next_n_iterations = n_iterations * MAX_ITERATIONS_GROWTH;
+        else
+            next_n_iterations = n_iterations * (sample_time / elapsed) * 1.2;
+        next_n_iterations = MIN(next_n_iterations,
+                                n_iterations * MAX_ITERATIONS_GROWTH);
+        next_n_iterations = MAX(next_n_iterations, n_iterations + 1);
+        n_iterations = MIN(next_n_iterations, MAX_ITERATIONS);
+    }
+
+    return n_iterations;
+}
+
+static gint
+compare_double (gconstpointer a, gconstpointer b)
+{
+    gdouble value1 = *(const gdouble *)a;
+    gdouble value2 = *(const gdouble *)b;
+
+    if (value1 < value2)
+        return -1;
+    else if (value1 > value2)
+        return 1;
+    else
+        return 0;
+}
+
+static void
+set_time_attribute (CutTest *test, const gchar *name, gdouble seconds)
+{
+    gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+    g_ascii_formatd(buffer, sizeof(buffer), "%.3f", seconds * 1e9);
+    cut_test_set_attribute(test, name, buffer);
+}
+
+static void
+set_statistics (CutTest *test, guint64 n_iterations,
+                gdouble *samples, guint n_samples)
+{
+    gdouble sum = 0.0, mean, median, squared_sum = 0.0, stddev = 0.0;
+    gchar *value;
+    guint i;
+
+    qsort(samples, n_samples, sizeof(gdouble), compare_double);
+    for (i = 0; i < n_samples; i++)
+        sum += samples[i];
+    mean = sum / n_samples;
+    if (n_samples % 2 == 1)
+        median = samples[n_samples / 2];
+    else
+        median = (samples[n_samples / 2 - 1] + samples[n_samples / 2]) / 2.0;
+    if (n_samples > 1) {
+        for (i = 0; i < n_samples; i++)
+            squared_sum += (samples[i] - mean) * (samples[i] - mean);
+        stddev = sqrt(squared_sum / (n_samples - 1));
+    }
+
+    value = g_strdup_printf("%" G_GUINT64_FORMAT, n_iterations);
+    cut_test_set_attribute(test, "benchmark-iterations", value);
+    g_free(value);
+    value = g_strdup_printf("%u", n_samples);
+    cut_test_set_attribute(test, "benchmark-samples", value);
+    g_free(value);
+    set_time_attribute(test, "benchmark-mean", mean);
+    set_time_attribute(test, "benchmark-median", median);
+    set_time_attribute(test, "benchmark-stddev", stddev);
+    set_time_attribute(test, "benchmark-min", samples[0]);
+}
+
+static void
+invoke (CutTest *test, CutTestContext *test_context, CutRunContext *run_context)
+{
+    CutTestFunction function = NULL;
+    guint64 n_iterations;
+    gdouble samples[N_SAMPLES];
+    guint i;
+
+    g_object_get(test, "test-function", &function, NULL);
+    if (!cut_benchmark_is_target(CUT_BENCHMARK(test), run_context)) {
+        CUT_TEST_CLASS(cut_benchmark_parent_class)->invoke(test,
+                                                           test_context,
+                                                           run_context);
+        return;
+    }
+
+    function();
+    n_iterations = calibrate(function,
+                             get_min_time(test, run_context) / N_SAMPLES);
+    for (i = 0; i < N_SAMPLES; i++)
+        samples[i] = run_iterations(function, n_iterations) / n_iterations;
+    cut_log_trace("[benchmark][measured] <%s>:<%" G_GUINT64_FORMAT ">",
+                  cut_test_get_name(test), n_iterations);
+
+    set_statistics(test, n_iterations, samples, N_SAMPLES);
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
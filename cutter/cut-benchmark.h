@@ -0,0 +1,83 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CUT_BENCHMARK_H__
+#define __CUT_BENCHMARK_H__
+
+#include <glib-object.h>
+
+#include <cutter/cut-test.h>
+
+G_BEGIN_DECLS
+
+/*
+ * CutBenchmark is a test that measures how long its function
+ * takes. It is loaded from a "bench_" function or a "test_"
+ * function that has "benchmark" attribute.
+ *
+ * A benchmark that matches benchmark-filter of the run
+ * context is warmed up, calibrated to take at least
+ * benchmark-min-time and then run for some samples. The
+ * result is stored in the following attributes. Times are
+ * nanoseconds per call of the function:
+ *
+ *   benchmark-iterations: calls in a sample
+ *   benchmark-samples: the number of samples
+ *   benchmark-mean, benchmark-median, benchmark-stddev,
+ *   benchmark-min: statistics of the samples
+ *
+ * Other benchmarks are run only once like a normal test.
+ */
+
+#define CUT_TYPE_BENCHMARK            (cut_benchmark_get_type ())
+#define CUT_BENCHMARK(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), CUT_TYPE_BENCHMARK, CutBenchmark))
+#define CUT_BENCHMARK_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), CUT_TYPE_BENCHMARK, CutBenchmarkClass))
+#define CUT_IS_BENCHMARK(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), CUT_TYPE_BENCHMARK))
+#define CUT_IS_BENCHMARK_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), CUT_TYPE_BENCHMARK))
+#define CUT_BENCHMARK_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), CUT_TYPE_BENCHMARK, CutBenchmarkClass))
+
+typedef struct _CutBenchmark         CutBenchmark;
+typedef struct _CutBenchmarkClass    CutBenchmarkClass;
+
+struct _CutBenchmark
+{
+    CutTest object;
+};
+
+struct _CutBenchmarkClass
+{
+    CutTestClass parent_class;
+};
+
+GType          cut_benchmark_get_type    (void) G_GNUC_CONST;
+
+CutBenchmark  *cut_benchmark_new         (const gchar     *name,
+                                          CutTestFunction  function);
+CutBenchmark  *cut_benchmark_new_empty   (void);
+
+gboolean       cut_benchmark_is_target   (CutBenchmark    *benchmark,
+                                          CutRunContext   *run_context);
+
+G_END_DECLS
+
+#endif /* __CUT_BENCHMARK_H__ */
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
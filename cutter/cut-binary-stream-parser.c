@@ -0,0 +1,843 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <string.h>
+#include <glib.h>
+
+#include "cut-binary-stream-parser.h"
+#include "cut-test.h"
+#include "cut-test-case.h"
+#include "cut-test-suite.h"
+#include "cut-test-iterator.h"
+#include "cut-iterated-test.h"
+#include "cut-test-context.h"
+#include "cut-test-data.h"
+#include "cut-test-result.h"
+#include "cut-backtrace-entry.h"
+
+struct _CutBinaryStreamParser
+{
+    CutRunContext *run_context;
+    gboolean in_run;
+    gboolean magic_read;
+    GString *buffer;
+    GPtrArray *names;
+};
+
+typedef struct _Reader Reader;
+struct _Reader
+{
+    const guchar *data;
+    gsize length;
+    gsize offset;
+};
+
+GQuark
+cut_binary_stream_parser_error_quark (void)
+{
+    return g_quark_from_static_string("cut-binary-stream-parser-error-quark");
+}
+
+static void
+run_context_weak_notify (gpointer data, GObject *where_the_object_was)
+{
+    CutBinaryStreamParser *parser = data;
+
+    parser->run_context = NULL;
+}
+
+CutBinaryStreamParser *
+cut_binary_stream_parser_new (CutRunContext *run_context, gboolean in_run)
+{
+    CutBinaryStreamParser *parser;
+
+    parser = g_new0(CutBinaryStreamParser, 1);
+    parser->run_context = run_context;
+    if (parser->run_context)
+        g_object_weak_ref(G_OBJECT(parser->run_context),
+                          run_context_weak_notify, parser);
+    parser->in_run = in_run;
+    parser->magic_read = FALSE;
+    parser->buffer = g_string_new(NULL);
+    parser->names = g_ptr_array_new();
+
+    return parser;
+}
+
+void
+cut_binary_stream_parser_free (CutBinaryStreamParser *parser)
+{
+    if (parser->run_context)
+        g_object_weak_unref(G_OBJECT(parser->run_context),
+                            run_context_weak_notify, parser);
+    g_string_free(parser->buffer, TRUE);
+    g_ptr_array_foreach(parser->names, (GFunc)g_free, NULL);
+    g_ptr_array_free(parser->names, TRUE);
+    g_free(parser);
+}
+
+static gboolean
+read_data (Reader *reader, gpointer data, gsize size)
+{
+    if (reader->length - reader->offset < size)
+        return FALSE;
+
+    memcpy(data, reader->data + reader->offset, size);
+    reader->offset += size;
+    return TRUE;
+}
+
+static gboolean
+read_uint8 (Reader *reader, guint8 *value)
+{
+    return read_data(reader, value, sizeof(*value));
+}
+
+static gboolean
+read_uint32 (Reader *reader, guint32 *value)
+{
+    return read_data(reader, value, sizeof(*value));
+}
+
+static gboolean
+read_boolean (Reader *reader, gboolean *value)
+{
+    guint8 byte;
+
+    if (!read_uint8(reader, &byte))
+        return FALSE;
+    *value = byte != 0;
+    return TRUE;
+}
+
+static gboolean
+read_time_val (Reader *reader, GTimeVal *time_val)
+{
+    gint64 seconds, microseconds;
+
+    if (!read_data(reader, &seconds, sizeof(seconds)))
+        return FALSE;
+    if (!read_data(reader, &microseconds, sizeof(microseconds)))
+        return FALSE;
+    time_val->tv_sec = seconds;
+    time_val->tv_usec = microseconds;
+    return TRUE;
+}
+
+static gboolean
+read_double (Reader *reader, gdouble *value)
+{
+    return read_data(reader, value, sizeof(*value));
+}
+
+static gboolean
+read_resource_usage (Reader *reader, CutResourceUsage *usage,
+                     gboolean *have_usage)
+{
+    if (!read_boolean(reader, have_usage))
+        return FALSE;
+    if (!*have_usage)
+        return TRUE;
+    return read_data(reader, usage, sizeof(*usage));
+}
+
+static gboolean
+read_phase_elapsed (Reader *reader, CutPhaseElapsed *phase_elapsed)
+{
+    return read_data(reader, phase_elapsed, sizeof(*phase_elapsed));
+}
+
+static gboolean
+read_name (CutBinaryStreamParser *parser, Reader *reader, const gchar **name)
+{
+    guint32 id;
+
+    if (!read_uint32(reader, &id))
+        return FALSE;
+    if (id == 0) {
+        *name = NULL;
+        return TRUE;
+    }
+    if (id > parser->names->len)
+        return FALSE;
+    *name = g_ptr_array_index(parser->names, id - 1);
+    return TRUE;
+}
+
+static gboolean
+read_string (Reader *reader, gchar **string)
+{
+    guint32 length;
+
+    if (!read_uint32(reader, &length))
+        return FALSE;
+    if (length == G_MAXUINT32) {
+        *string = NULL;
+        return TRUE;
+    }
+    if (reader->length - reader->offset < length)
+        return FALSE;
+    *string = g_strndup((const gchar *)reader->data + reader->offset, length);
+    reader->offset += length;
+    return TRUE;
+}
+
+static CutTest *
+test_new_empty (CutBinaryObjectType type)
+{
+    switch (type) {
+      case CUT_BINARY_OBJECT_TEST:
+        return cut_test_new_empty();
+      case CUT_BINARY_OBJECT_ITERATED_TEST:
+        return CUT_TEST(cut_iterated_test_new_empty());
+      case CUT_BINARY_OBJECT_TEST_CASE:
+        return CUT_TEST(cut_test_case_new_empty());
+      case CUT_BINARY_OBJECT_TEST_ITERATOR:
+        return CUT_TEST(cut_test_iterator_new_empty());
+      case CUT_BINARY_OBJECT_TEST_SUITE:
+        return CUT_TEST(cut_test_suite_new_empty());
+      default:
+        return NULL;
+    }
+}
+
+static gboolean
+read_test (CutBinaryStreamParser *parser, Reader *reader, GType type,
+           CutTest **test)
+{
+    guint8 object_type;
+    const gchar *name;
+    GTimeVal start_time;
+    gdouble elapsed;
+    CutResourceUsage resource_usage;
+    gboolean have_resource_usage;
+    CutPhaseElapsed phase_elapsed;
+    guint32 i, n_attributes;
+
+    *test = NULL;
+    if (!read_uint8(reader, &object_type))
+        return FALSE;
+    if (object_type == CUT_BINARY_OBJECT_NONE)
+        return TRUE;
+
+    *test = test_new_empty(object_type);
+    if (!*test)
+        return FALSE;
+    if (!G_TYPE_CHECK_INSTANCE_TYPE(*test, type))
+        goto error;
+
+    if (!read_name(parser, reader, &name))
+        goto error;
+    if (name)
+        cut_test_set_name(*test, name);
+    if (!read_time_val(reader, &start_time))
+        goto error;
+    cut_test_set_start_time(*test, &start_time);
+    if (!read_double(reader, &elapsed))
+        goto error;
+    cut_test_set_elapsed(*test, elapsed);
+    if (!read_resource_usage(reader, &resource_usage, &have_resource_usage))
+        goto error;
+    if (have_resource_usage)
+        cut_test_set_resource_usage(*test, &resource_usage);
+    if (!read_phase_elapsed(reader, &phase_elapsed))
+        goto error;
+    cut_test_set_phase_elapsed(*test, &phase_elapsed);
+
+    if (!read_uint32(reader, &n_attributes))
+        goto error;
+    for (i = 0; i < n_attributes; i++) {
+        const gchar *attribute_name, *attribute_value;
+
+        if (!read_name(parser, reader, &attribute_name))
+            goto error;
+        if (!read_name(parser, reader, &attribute_value))
+            goto error;
+        if (!attribute_name || !attribute_value)
+            goto error;
+        cut_test_set_attribute(*test, attribute_name, attribute_value);
+    }
+
+    return TRUE;
+
+error:
+    g_object_unref(*test);
+    *test = NULL;
+    return FALSE;
+}
+
+static gboolean
+read_test_data (CutBinaryStreamParser *parser, Reader *reader,
+                CutTestData **test_data)
+{
+    gboolean have_data;
+    const gchar *name;
+
+    *test_data = NULL;
+    if (!read_boolean(reader, &have_data))
+        return FALSE;
+    if (!have_data)
+        return TRUE;
+
+    if (!read_name(parser, reader, &name))
+        return FALSE;
+    *test_data = cut_test_data_new_empty();
+    if (name)
+        cut_test_data_set_name(*test_data, name);
+    return TRUE;
+}
+
+static gboolean
+read_test_context (CutBinaryStreamParser *parser, Reader *reader,
+                   CutTestContext **test_context)
+{
+    gboolean have_context, failed;
+    CutTest *test_suite = NULL, *test_case = NULL, *test_iterator = NULL;
+    CutTest *test = NULL;
+    CutTestData *test_data = NULL;
+    gboolean success = FALSE;
+
+    *test_context = NULL;
+    if (!read_boolean(reader, &have_context))
+        return FALSE;
+    if (!have_context)
+        return TRUE;
+
+    if (!read_test(parser, reader, CUT_TYPE_TEST_SUITE, &test_suite))
+        goto done;
+    if (!read_test(parser, reader, CUT_TYPE_TEST_CASE, &test_case))
+        goto done;
+    if (!read_test(parser, reader, CUT_TYPE_TEST_ITERATOR, &test_iterator))
+        goto done;
+    if (!read_test(parser, reader, CUT_TYPE_TEST, &test))
+        goto done;
+    if (!read_test_data(parser, reader, &test_data))
+        goto done;
+    if (!read_boolean(reader, &failed))
+        goto done;
+
+    *test_context = cut_test_context_new_empty();
+    if (test_suite)
+        cut_test_context_set_test_suite(*test_context,
+                                        CUT_TEST_SUITE(test_suite));
+    if (test_case)
+        cut_test_context_set_test_case(*test_context, CUT_TEST_CASE(test_case));
+    if (test_iterator)
+        cut_test_context_set_test_iterator(*test_context,
+                                           CUT_TEST_ITERATOR(test_iterator));
+    if (test)
+        cut_test_context_set_test(*test_context, test);
+    if (test_data)
+        cut_test_context_set_data(*test_context, test_data);
+    cut_test_context_set_failed(*test_context, failed);
+    success = TRUE;
+
+done:
+    if (test_suite)
+        g_object_unref(test_suite);
+    if (test_case)
+        g_object_unref(test_case);
+    if (test_iterator)
+        g_object_unref(test_iterator);
+    if (test)
+        g_object_unref(test);
+    if (test_data)
+        g_object_unref(test_data);
+
+    return success;
+}
+
+static gboolean
+read_backtrace (CutBinaryStreamParser *parser, Reader *reader,
+                CutTestResult *result)
+{
+    guint32 i, n_entries;
+    GList *backtrace = NULL;
+    gboolean success = TRUE;
+
+    if (!read_uint32(reader, &n_entries))
+        return FALSE;
+
+    for (i = 0; i < n_entries; i++) {
+        const gchar *file, *function;
+        guint32 line;
+        gchar *info;
+
+        if (!read_name(parser, reader, &file) ||
+            !read_uint32(reader, &line) ||
+            !read_name(parser, reader, &function) ||
+            !read_string(reader, &info)) {
+            success = FALSE;
+            break;
+        }
+        backtrace = g_list_prepend(backtrace,
+                                   cut_backtrace_entry_new(file, line,
+                                                           function, info));
+        g_free(info);
+    }
+
+    if (success && backtrace) {
+        backtrace = g_list_reverse(backtrace);
+        cut_test_result_set_backtrace(result, backtrace);
+    }
+    g_list_foreach(backtrace, (GFunc)g_object_unref, NULL);
+    g_list_free(backtrace);
+
+    return success;
+}
+
+#define READ_RESULT_STRING(reader, result, setter) do   \
+{                                                       \
+    gchar *_string;                                     \
+                                                        \
+    if (!read_string((reader), &_string))               \
+        goto error;                                     \
+    if (_string) {                                      \
+        setter((result), _string);                      \
+        g_free(_string);                                \
+    }                                                   \
+} while (0)
+
+static gboolean
+read_test_result (CutBinaryStreamParser *parser, Reader *reader,
+                  CutTestResult **result)
+{
+    guint8 status;
+    CutTest *test = NULL;
+    CutTestData *test_data = NULL;
+    GTimeVal start_time;
+    gdouble elapsed;
+    CutResourceUsage resource_usage;
+    gboolean have_resource_usage;
+    CutPhaseElapsed phase_elapsed;
+
+    if (!read_uint8(reader, &status))
+        return FALSE;
+    if (status >= CUT_TEST_RESULT_LAST)
+        return FALSE;
+
+    *result = cut_test_result_new_empty();
+    cut_test_result_set_status(*result, status);
+
+    if (!read_test(parser, reader, CUT_TYPE_TEST_CASE, &test))
+        goto error;
+    if (test) {
+        cut_test_result_set_test_case(*result, CUT_TEST_CASE(test));
+        g_object_unref(test);
+    }
+    if (!read_test(parser, reader, CUT_TYPE_TEST_ITERATOR, &test))
+        goto error;
+    if (test) {
+        cut_test_result_set_test_iterator(*result, CUT_TEST_ITERATOR(test));
+        g_object_unref(test);
+    }
+    if (!read_test(parser, reader, CUT_TYPE_TEST, &test))
+        goto error;
+    if (test) {
+        cut_test_result_set_test(*result, test);
+        g_object_unref(test);
+    }
+    if (!read_test_data(parser, reader, &test_data))
+        goto error;
+    if (test_data) {
+        cut_test_result_set_test_data(*result, test_data);
+        g_object_unref(test_data);
+    }
+
+    READ_RESULT_STRING(reader, *result, cut_test_result_set_message);
+    if (!read_backtrace(parser, reader, *result))
+        goto error;
+    if (!read_time_val(reader, &start_time))
+        goto error;
+    cut_test_result_set_start_time(*result, &start_time);
+    if (!read_double(reader, &elapsed))
+        goto error;
+    cut_test_result_set_elapsed(*result, elapsed);
+    if (!read_resource_usage(reader, &resource_usage, &have_resource_usage))
+        goto error;
+    if (have_resource_usage)
+        cut_test_result_set_resource_usage(*result, &resource_usage);
+    if (!read_phase_elapsed(reader, &phase_elapsed))
+        goto error;
+    cut_test_result_set_phase_elapsed(*result, &phase_elapsed);
+    READ_RESULT_STRING(reader, *result, cut_test_result_set_expected);
+    READ_RESULT_STRING(reader, *result, cut_test_result_set_actual);
+    READ_RESULT_STRING(reader, *result, cut_test_result_set_diff);
+    READ_RESULT_STRING(reader, *result, cut_test_result_set_folded_diff);
+
+    return TRUE;
+
+error:
+    g_object_unref(*result);
+    *result = NULL;
+    return FALSE;
+}
+
+static void
+emit_result_signal (CutRunContext *run_context, const gchar *suffix,
+                    CutTestResult *result, ...)
+{
+    CutTestResultStatus status;
+    gchar *signal_name;
+    guint signal_id;
+    va_list args;
+
+    status = cut_test_result_get_status(result);
+    signal_name = g_strdup_printf("%s-%s",
+                                  cut_test_result_status_to_signal_name(status),
+                                  suffix);
+    signal_id = g_signal_lookup(signal_name, G_OBJECT_TYPE(run_context));
+    g_free(signal_name);
+    if (signal_id == 0)
+        return;
+
+    va_start(args, result);
+    g_signal_emit_valist(run_context, signal_id, 0, args);
+    va_end(args);
+}
+
+static gboolean
+parse_name (CutBinaryStreamParser *parser, Reader *reader)
+{
+    guint32 id;
+
+    if (!read_uint32(reader, &id))
+        return FALSE;
+    if (id != parser->names->len + 1)
+        return FALSE;
+
+    g_ptr_array_add(parser->names,
+                    g_strndup((const gchar *)reader->data + reader->offset,
+                              reader->length - reader->offset));
+    reader->offset = reader->length;
+    return TRUE;
+}
+
+static gboolean
+parse_ready_container (CutBinaryStreamParser *parser, Reader *reader,
+                       CutBinaryRecordType type)
+{
+    CutTest *container;
+    guint32 n_test_cases = 0, n_tests;
+    GType container_type;
+
+    if (type == CUT_BINARY_RECORD_READY_TEST_SUITE)
+        container_type = CUT_TYPE_TEST_SUITE;
+    else if (type == CUT_BINARY_RECORD_READY_TEST_CASE)
+        container_type = CUT_TYPE_TEST_CASE;
+    else
+        container_type = CUT_TYPE_TEST_ITERATOR;
+
+    if (!read_test(parser, reader, container_type, &container) || !container)
+        return FALSE;
+    if ((type == CUT_BINARY_RECORD_READY_TEST_SUITE &&
+         !read_uint32(reader, &n_test_cases)) ||
+        !read_uint32(reader, &n_tests)) {
+        g_object_unref(container);
+        return FALSE;
+    }
+
+    if (parser->run_context) {
+        if (type == CUT_BINARY_RECORD_READY_TEST_SUITE)
+            g_signal_emit_by_name(parser->run_context, "ready-test-suite",
+                                  container, n_test_cases, n_tests);
+        else if (type == CUT_BINARY_RECORD_READY_TEST_CASE)
+            g_signal_emit_by_name(parser->run_context, "ready-test-case",
+                                  container, n_tests);
+        else
+            g_signal_emit_by_name(parser->run_context, "ready-test-iterator",
+                                  container, n_tests);
+    }
+    g_object_unref(container);
+
+    return TRUE;
+}
+
+static gboolean
+parse_container (CutBinaryStreamParser *parser, Reader *reader,
+                 GType container_type, const gchar *signal_name,
+                 gboolean with_success)
+{
+    CutTest *container;
+    gboolean success = TRUE;
+
+    if (!read_test(parser, reader, container_type, &container) || !container)
+        return FALSE;
+    if (with_success && !read_boolean(reader, &success)) {
+        g_object_unref(container);
+        return FALSE;
+    }
+
+    if (parser->run_context) {
+        if (with_success)
+            g_signal_emit_by_name(parser->run_context, signal_name,
+                                  container, success);
+        else
+            g_signal_emit_by_name(parser->run_context, signal_name,
+                                  container);
+    }
+    g_object_unref(container);
+
+    return TRUE;
+}
+
+static gboolean
+parse_container_result (CutBinaryStreamParser *parser, Reader *reader,
+                        GType container_type, const gchar *suffix)
+{
+    CutTest *container;
+    CutTestResult *result;
+
+    if (!read_test(parser, reader, container_type, &container) || !container)
+        return FALSE;
+    if (!read_test_result(parser, reader, &result)) {
+        g_object_unref(container);
+        return FALSE;
+    }
+
+    if (parser->run_context)
+        emit_result_signal(parser->run_context, suffix, result,
+                           container, result);
+    g_object_unref(container);
+    g_object_unref(result);
+
+    return TRUE;
+}
+
+static gboolean
+parse_test_event (CutBinaryStreamParser *parser, Reader *reader,
+                  CutBinaryRecordType type)
+{
+    CutTest *test;
+    CutTestContext *test_context;
+    GType test_type = CUT_TYPE_TEST;
+    gboolean success = FALSE;
+
+    if (type == CUT_BINARY_RECORD_START_ITERATED_TEST ||
+        type == CUT_BINARY_RECORD_COMPLETE_ITERATED_TEST)
+        test_type = CUT_TYPE_ITERATED_TEST;
+
+    if (!read_test(parser, reader, test_type, &test) || !test)
+        return FALSE;
+    if (!read_test_context(parser, reader, &test_context)) {
+        g_object_unref(test);
+        return FALSE;
+    }
+
+    switch (type) {
+      case CUT_BINARY_RECORD_START_ITERATED_TEST:
+      case CUT_BINARY_RECORD_START_TEST:
+        success = TRUE;
+        if (parser->run_context)
+            g_signal_emit_by_name(parser->run_context,
+                                  type == CUT_BINARY_RECORD_START_TEST ?
+                                  "start-test" : "start-iterated-test",
+                                  test, test_context);
+        break;
+      case CUT_BINARY_RECORD_PASS_ASSERTIONS:
+      {
+        guint32 n_assertions;
+
+        success = read_uint32(reader, &n_assertions);
+        if (success && parser->run_context)
+            g_signal_emit_by_name(parser->run_context, "pass-assertions",
+                                  test, test_context, n_assertions);
+        break;
+      }
+      case CUT_BINARY_RECORD_TEST_RESULT:
+      {
+        CutTestResult *result;
+
+        success = read_test_result(parser, reader, &result);
+        if (success) {
+            if (parser->run_context)
+                emit_result_signal(parser->run_context, "test", result,
+                                   test, test_context, result);
+            g_object_unref(result);
+        }
+        break;
+      }
+      case CUT_BINARY_RECORD_COMPLETE_ITERATED_TEST:
+      case CUT_BINARY_RECORD_COMPLETE_TEST:
+      {
+        gboolean test_success;
+
+        success = read_boolean(reader, &test_success);
+        if (success && parser->run_context)
+            g_signal_emit_by_name(parser->run_context,
+                                  type == CUT_BINARY_RECORD_COMPLETE_TEST ?
+                                  "complete-test" : "complete-iterated-test",
+                                  test, test_context, test_success);
+        break;
+      }
+      default:
+        break;
+    }
+
+    g_object_unref(test);
+    if (test_context)
+        g_object_unref(test_context);
+
+    return success;
+}
+
+static gboolean
+parse_record (CutBinaryStreamParser *parser, CutBinaryRecordType type,
+              Reader *reader)
+{
+    gboolean success;
+
+    switch (type) {
+      case CUT_BINARY_RECORD_NAME:
+        return parse_name(parser, reader);
+      case CUT_BINARY_RECORD_START_RUN:
+        if (parser->run_context && !parser->in_run)
+            g_signal_emit_by_name(parser->run_context, "start-run");
+        return TRUE;
+      case CUT_BINARY_RECORD_READY_TEST_SUITE:
+      case CUT_BINARY_RECORD_READY_TEST_CASE:
+      case CUT_BINARY_RECORD_READY_TEST_ITERATOR:
+        return parse_ready_container(parser, reader, type);
+      case CUT_BINARY_RECORD_START_TEST_SUITE:
+        return parse_container(parser, reader, CUT_TYPE_TEST_SUITE,
+                               "start-test-suite", FALSE);
+      case CUT_BINARY_RECORD_START_TEST_CASE:
+        return parse_container(parser, reader, CUT_TYPE_TEST_CASE,
+                               "start-test-case", FALSE);
+      case CUT_BINARY_RECORD_START_TEST_ITERATOR:
+        return parse_container(parser, reader, CUT_TYPE_TEST_ITERATOR,
+                               "start-test-iterator", FALSE);
+      case CUT_BINARY_RECORD_START_ITERATED_TEST:
+      case CUT_BINARY_RECORD_START_TEST:
+      case CUT_BINARY_RECORD_PASS_ASSERTIONS:
+      case CUT_BINARY_RECORD_TEST_RESULT:
+      case CUT_BINARY_RECORD_COMPLETE_ITERATED_TEST:
+      case CUT_BINARY_RECORD_COMPLETE_TEST:
+        return parse_test_event(parser, reader, type);
+      case CUT_BINARY_RECORD_TEST_ITERATOR_RESULT:
+        return parse_container_result(parser, reader, CUT_TYPE_TEST_ITERATOR,
+                                      "test-iterator");
+      case CUT_BINARY_RECORD_COMPLETE_TEST_ITERATOR:
+        return parse_container(parser, reader, CUT_TYPE_TEST_ITERATOR,
+                               "complete-test-iterator", TRUE);
+      case CUT_BINARY_RECORD_TEST_CASE_RESULT:
+        return parse_container_result(parser, reader, CUT_TYPE_TEST_CASE,
+                                      "test-case");
+      case CUT_BINARY_RECORD_COMPLETE_TEST_CASE:
+        return parse_container(parser, reader, CUT_TYPE_TEST_CASE,
+                               "complete-test-case", TRUE);
+      case CUT_BINARY_RECORD_COMPLETE_TEST_SUITE:
+        return parse_container(parser, reader, CUT_TYPE_TEST_SUITE,
+                               "complete-test-suite", TRUE);
+      case CUT_BINARY_RECORD_COMPLETE_RUN:
+        if (!read_boolean(reader, &success))
+            return FALSE;
+        if (parser->run_context && !parser->in_run)
+            cut_run_context_emit_complete_run(parser->run_context, success);
+        return TRUE;
+      default:
+        return FALSE;
+    }
+}
+
+gboolean
+cut_binary_stream_parser_parse (CutBinaryStreamParser *parser,
+                                const gchar *data, gsize length,
+                                GError **error)
+{
+    const guchar *buffer;
+    gsize buffer_length, offset = 0;
+    gboolean success = TRUE;
+
+    g_string_append_len(parser->buffer, data, length);
+    buffer = (const guchar *)parser->buffer->str;
+    buffer_length = parser->buffer->len;
+
+    if (!parser->magic_read) {
+        gsize compared_length;
+
+        compared_length = MIN(buffer_length, CUT_BINARY_STREAM_MAGIC_LENGTH);
+        if (memcmp(buffer, CUT_BINARY_STREAM_MAGIC, compared_length) != 0) {
+            g_set_error(error,
+                        CUT_BINARY_STREAM_PARSER_ERROR,
+                        CUT_BINARY_STREAM_PARSER_ERROR_INVALID_MAGIC,
+                        "invalid binary stream magic");
+            return FALSE;
+        }
+        if (compared_length < CUT_BINARY_STREAM_MAGIC_LENGTH)
+            return TRUE;
+        offset = CUT_BINARY_STREAM_MAGIC_LENGTH;
+        parser->magic_read = TRUE;
+    }
+
+    while (buffer_length - offset >= CUT_BINARY_RECORD_HEADER_SIZE) {
+        guint8 type;
+        guint32 payload_length;
+        Reader reader;
+
+        type = buffer[offset];
+        memcpy(&payload_length, buffer + offset + 1, sizeof(payload_length));
+        if (buffer_length - offset - CUT_BINARY_RECORD_HEADER_SIZE <
+            payload_length)
+            break;
+
+        reader.data = buffer + offset + CUT_BINARY_RECORD_HEADER_SIZE;
+        reader.length = payload_length;
+        reader.offset = 0;
+        if (!parse_record(parser, type, &reader) ||
+            reader.offset != reader.length) {
+            g_set_error(error,
+                        CUT_BINARY_STREAM_PARSER_ERROR,
+                        CUT_BINARY_STREAM_PARSER_ERROR_INVALID_RECORD,
+                        "invalid binary stream record: type=%u, length=%u",
+                        type, payload_length);
+            success = FALSE;
+            break;
+        }
+        offset += CUT_BINARY_RECORD_HEADER_SIZE + payload_length;
+    }
+
+    g_string_erase(parser->buffer, 0, offset);
+
+    return success;
+}
+
+gboolean
+cut_binary_stream_parser_end_parse (CutBinaryStreamParser *parser,
+                                    GError **error)
+{
+    if (!parser->magic_read || parser->buffer->len > 0) {
+        g_set_error(error,
+                    CUT_BINARY_STREAM_PARSER_ERROR,
+                    CUT_BINARY_STREAM_PARSER_ERROR_TRUNCATED,
+                    "binary stream is truncated: %" G_GSIZE_FORMAT " bytes",
+                    parser->buffer->len);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
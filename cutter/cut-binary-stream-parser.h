@@ -0,0 +1,116 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CUT_BINARY_STREAM_PARSER_H__
+#define __CUT_BINARY_STREAM_PARSER_H__
+
+#include <glib.h>
+
+#include <cutter/cut-run-context.h>
+
+G_BEGIN_DECLS
+
+/*
+ * The binary stream is a compact alternative to the XML
+ * stream for transporting events from a child cutter to
+ * its parent. It isn't for logs: integers and doubles are
+ * written in host byte order.
+ *
+ * A stream starts with CUT_BINARY_STREAM_MAGIC. It is
+ * followed by records. A record is a 1 byte record type, a
+ * 4 byte payload length and the payload.
+ *
+ * Names (test names, attributes, file names and so on) are
+ * interned: a CUT_BINARY_RECORD_NAME record defines a name
+ * once and later records refer it by ID. ID 0 is NULL.
+ * Other strings are written as a 4 byte length and their
+ * bytes. G_MAXUINT32 length is NULL. CutResourceUsage is
+ * written as is after a 1 byte flag of its existence.
+ * CutPhaseElapsed is always written as is.
+ */
+
+#define CUT_BINARY_STREAM_MAGIC        "\x89" "CUT\x03"
+#define CUT_BINARY_STREAM_MAGIC_LENGTH 5
+#define CUT_BINARY_RECORD_HEADER_SIZE  5
+
+typedef enum {
+    CUT_BINARY_RECORD_NAME = 1,
+    CUT_BINARY_RECORD_START_RUN,
+    CUT_BINARY_RECORD_READY_TEST_SUITE,
+    CUT_BINARY_RECORD_START_TEST_SUITE,
+    CUT_BINARY_RECORD_READY_TEST_CASE,
+    CUT_BINARY_RECORD_START_TEST_CASE,
+    CUT_BINARY_RECORD_READY_TEST_ITERATOR,
+    CUT_BINARY_RECORD_START_TEST_ITERATOR,
+    CUT_BINARY_RECORD_START_ITERATED_TEST,
+    CUT_BINARY_RECORD_START_TEST,
+    CUT_BINARY_RECORD_PASS_ASSERTIONS,
+    CUT_BINARY_RECORD_TEST_RESULT,
+    CUT_BINARY_RECORD_COMPLETE_ITERATED_TEST,
+    CUT_BINARY_RECORD_COMPLETE_TEST,
+    CUT_BINARY_RECORD_TEST_ITERATOR_RESULT,
+    CUT_BINARY_RECORD_COMPLETE_TEST_ITERATOR,
+    CUT_BINARY_RECORD_TEST_CASE_RESULT,
+    CUT_BINARY_RECORD_COMPLETE_TEST_CASE,
+    CUT_BINARY_RECORD_COMPLETE_TEST_SUITE,
+    CUT_BINARY_RECORD_COMPLETE_RUN
+} CutBinaryRecordType;
+
+typedef enum {
+    CUT_BINARY_OBJECT_NONE,
+    CUT_BINARY_OBJECT_TEST,
+    CUT_BINARY_OBJECT_ITERATED_TEST,
+    CUT_BINARY_OBJECT_TEST_CASE,
+    CUT_BINARY_OBJECT_TEST_ITERATOR,
+    CUT_BINARY_OBJECT_TEST_SUITE
+} CutBinaryObjectType;
+
+#define CUT_BINARY_STREAM_PARSER_ERROR           (cut_binary_stream_parser_error_quark())
+
+typedef enum {
+    CUT_BINARY_STREAM_PARSER_ERROR_INVALID_MAGIC,
+    CUT_BINARY_STREAM_PARSER_ERROR_INVALID_RECORD,
+    CUT_BINARY_STREAM_PARSER_ERROR_TRUNCATED
+} CutBinaryStreamParserError;
+
+typedef struct _CutBinaryStreamParser CutBinaryStreamParser;
+
+GQuark                 cut_binary_stream_parser_error_quark (void);
+
+CutBinaryStreamParser *cut_binary_stream_parser_new
+                                        (CutRunContext         *run_context,
+                                         gboolean               in_run);
+void                   cut_binary_stream_parser_free
+                                        (CutBinaryStreamParser *parser);
+gboolean               cut_binary_stream_parser_parse
+                                        (CutBinaryStreamParser *parser,
+                                         const gchar           *data,
+                                         gsize                  length,
+                                         GError               **error);
+gboolean               cut_binary_stream_parser_end_parse
+                                        (CutBinaryStreamParser *parser,
+                                         GError               **error);
+
+G_END_DECLS
+
+#endif /* __CUT_BINARY_STREAM_PARSER_H__ */
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
@@ -1,6 +1,6 @@
 /* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
 /*
- *  Copyright (C) 2009-2012  Kouhei Sutou <kou@clear-code.com>
+ *  Copyright (C) 2009-2014  Kouhei Sutou <kou@clear-code.com>
  *
  *  This library is free software: you can redistribute it and/or modify
  *  it under the terms of the GNU Lesser General Public License as published by
@@ -27,18 +27,27 @@
 #  include <unistd.h>
 #endif
 
+#if defined(HAVE_EXECINFO_H) && defined(HAVE_BACKTRACE)
+#  include <execinfo.h>
+#  define USE_EXECINFO 1
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <glib.h>
+#ifndef G_OS_WIN32
+#  include <pthread.h>
+#endif
 
 #include "cut-main.h"
 #include "cut-test-result.h"
 #include "cut-backtrace-entry.h"
 #include "cut-utils.h"
+#include "cut-glib-compatible.h"
 #include "cut-crash-backtrace.h"
 
 static gboolean cut_crash_backtrace_show_on_the_moment = TRUE;
-static gboolean cut_crash_backtrace_signal_received = FALSE;
 
 
 void
@@ -56,7 +65,8 @@ cut_crash_backtrace_get_show_on_the_moment (void)
 void
 cut_crash_backtrace_reset_signal_received (void)
 {
-    cut_crash_backtrace_signal_received = FALSE;
+    /* Signals received while handling a crash are detected
+       per crash backtrace. There is nothing to reset. */
 }
 
 #ifdef G_OS_WIN32
@@ -73,85 +83,129 @@ cut_crash_backtrace_free (CutCrashBacktrace *crash_backtrace)
 }
 
 void
-cut_crash_backtrace_emit (CutTestSuite    *test_suite,
-                          CutTestCase     *test_case,
-                          CutTest         *test,
-                          CutTestIterator *test_iterator,
-                          CutTestData     *test_data,
-                          CutTestContext  *test_context)
+cut_crash_backtrace_hold_interrupts (CutCrashBacktrace *crash_backtrace)
+{
+}
+
+void
+cut_crash_backtrace_release_interrupts (CutCrashBacktrace *crash_backtrace)
+{
+}
+
+void
+cut_crash_backtrace_emit (CutCrashBacktrace *crash_backtrace,
+                          CutTestSuite      *test_suite,
+                          CutTestCase       *test_case,
+                          CutTest           *test,
+                          CutTestIterator   *test_iterator,
+                          CutTestData       *test_data,
+                          CutTestContext    *test_context)
 {
 }
 
 #else
 
-static CutCrashBacktrace *current_crash_backtrace = NULL;
-static gchar crash_backtrace[40960];
-static gchar crash_backtrace_read_buffer[4096];
+#define ALTERNATE_STACK_SIZE    (64 * 1024)
+#define MAX_BACKTRACE_ADDRESSES 128
+/* i_will_be_back_handler() and the signal trampoline. */
+#define N_HANDLER_FRAMES        2
+#define GDB_BACKTRACE_SIZE      40960
 
 struct _CutCrashBacktrace
 {
     CutCrashBacktrace *previous;
     jmp_buf *jump_buffer;
-    struct sigaction i_will_be_back_action;
-    struct sigaction previous_segv_action;
-    struct sigaction previous_abort_action;
-    struct sigaction previous_terminate_action;
-    struct sigaction previous_interrupt_action;
-    struct sigaction previous_bus_error_action;
-    gboolean set_segv_action;
-    gboolean set_abort_action;
-    gboolean set_terminate_action;
-    gboolean set_interrupt_action;
-    gboolean set_bus_error_action;
+    volatile sig_atomic_t handling;
+    volatile sig_atomic_t holding_interrupts;
+    volatile sig_atomic_t held_signum;
+    gpointer alternate_stack;
+    stack_t previous_alternate_stack;
+#ifdef USE_EXECINFO
+    void *addresses[MAX_BACKTRACE_ADDRESSES];
+    gint n_addresses;
+#else
+    gchar *gdb_backtrace;
+#endif
 };
 
+/* The innermost crash backtrace of the current thread. */
+static GPrivate current_crash_backtrace_private = G_PRIVATE_INIT(NULL);
+
+G_LOCK_DEFINE_STATIC(actions);
+static guint n_action_users = 0;
+/* The thread that installed the actions. It is the main
+   thread that runs the test suite and outlives the other
+   users. */
+static pthread_t actions_thread;
+static struct sigaction i_will_be_back_action;
+static struct sigaction previous_segv_action;
+static struct sigaction previous_abort_action;
+static struct sigaction previous_terminate_action;
+static struct sigaction previous_interrupt_action;
+static struct sigaction previous_bus_error_action;
+static gboolean set_segv_action = FALSE;
+static gboolean set_abort_action = FALSE;
+static gboolean set_terminate_action = FALSE;
+static gboolean set_interrupt_action = FALSE;
+static gboolean set_bus_error_action = FALSE;
+
 static void
-read_backtrace (int in_fd)
+write_to_stderr (const gchar *message)
 {
+    ssize_t written_bytes;
+
+    written_bytes = write(STDERR_FILENO, message, strlen(message));
+    (void)written_bytes;
+}
+
+#ifndef USE_EXECINFO
+static void
+read_backtrace (CutCrashBacktrace *crash_backtrace, int in_fd)
+{
+    gchar read_buffer[4096];
     gssize i, read_size;
+    gchar *gdb_backtrace;
     gchar *internal_backtrace;
 
     if (cut_crash_backtrace_show_on_the_moment)
-        g_print("\n");
+        write_to_stderr("\n");
 
-    crash_backtrace[0] = '\0';
+    gdb_backtrace = crash_backtrace->gdb_backtrace;
+    gdb_backtrace[0] = '\0';
     i = 0;
-    while ((read_size = read(in_fd,
-                             crash_backtrace_read_buffer,
-                             sizeof(crash_backtrace_read_buffer))) > 0) {
+    while ((read_size = read(in_fd, read_buffer, sizeof(read_buffer))) > 0) {
         if (cut_crash_backtrace_show_on_the_moment) {
             ssize_t written_bytes;
-            written_bytes = write(STDERR_FILENO, crash_backtrace_read_buffer, read_size);
-            if (read_size == written_bytes)
-                break;
+            written_bytes = write(STDERR_FILENO, read_buffer, read_size);
+            (void)written_bytes;
         }
 
-        if (i + read_size > sizeof(crash_backtrace))
+        if (i + read_size >= GDB_BACKTRACE_SIZE)
             break;
-        memcpy(crash_backtrace + i, crash_backtrace_read_buffer, read_size);
+        memcpy(gdb_backtrace + i, read_buffer, read_size);
         i += read_size;
     }
-    crash_backtrace[i] = '\0';
+    gdb_backtrace[i] = '\0';
     if (i == 0)
         return;
 
 #define INTERNAL_BACKTRACE_MARK "<signal handler called>\n"
-    internal_backtrace = strstr(crash_backtrace, INTERNAL_BACKTRACE_MARK);
+    internal_backtrace = strstr(gdb_backtrace, INTERNAL_BACKTRACE_MARK);
     if (internal_backtrace) {
         internal_backtrace += strlen(INTERNAL_BACKTRACE_MARK);
-        crash_backtrace[internal_backtrace - crash_backtrace] = '\0';
+        gdb_backtrace[internal_backtrace - gdb_backtrace] = '\0';
     }
 #undef INTERNAL_BACKTRACE_MARK
 }
 
 static void
-collect_backtrace (void)
+collect_backtrace (CutCrashBacktrace *crash_backtrace)
 {
     int fds[2];
     int original_stdout_fileno;
 
     if (pipe(fds) == -1) {
-        perror("unable to open pipe for collecting stack trace");
+        write_to_stderr("unable to open pipe for collecting stack trace\n");
         return;
     }
 
@@ -162,77 +216,231 @@ collect_backtrace (void)
     close(original_stdout_fileno);
     close(fds[1]);
 
-    read_backtrace(fds[0]);
+    read_backtrace(crash_backtrace, fds[0]);
 
     close(fds[0]);
 }
+#endif
+
+static const struct sigaction *
+get_previous_action (int signum)
+{
+    switch (signum) {
+    case SIGSEGV:
+        return set_segv_action ? &previous_segv_action : NULL;
+    case SIGABRT:
+        return set_abort_action ? &previous_abort_action : NULL;
+    case SIGTERM:
+        return set_terminate_action ? &previous_terminate_action : NULL;
+    case SIGINT:
+        return set_interrupt_action ? &previous_interrupt_action : NULL;
+    case SIGBUS:
+        return set_bus_error_action ? &previous_bus_error_action : NULL;
+    default:
+        return NULL;
+    }
+}
 
+/*
+ * Handles a signal received by a thread that isn't running
+ * any test. Process-wide actions are kept as is so that
+ * other threads still catch their crashes.
+ */
 static void
-i_will_be_back_handler (int signum)
+forward_signal (int signum, siginfo_t *info, void *user_context)
 {
-    jmp_buf *jump_buffer;
+    const struct sigaction *previous_action;
+    struct sigaction default_action;
+
+    /* SIGINT and SIGTERM are sent to the process and the
+       kernel may deliver them to an idle thread. The thread
+       that runs the test suite handles them instead. */
+    if ((signum == SIGINT || signum == SIGTERM) &&
+        !pthread_equal(actions_thread, pthread_self())) {
+        pthread_kill(actions_thread, signum);
+        return;
+    }
 
-    if (cut_crash_backtrace_signal_received) {
-        g_print("signal received on crash\n");
-        exit(EXIT_FAILURE);
+    previous_action = get_previous_action(signum);
+    if (previous_action) {
+        if (previous_action->sa_flags & SA_SIGINFO) {
+            previous_action->sa_sigaction(signum, info, user_context);
+            return;
+        }
+        if (previous_action->sa_handler == SIG_IGN)
+            return;
+        if (previous_action->sa_handler != SIG_DFL) {
+            previous_action->sa_handler(signum);
+            return;
+        }
     }
-    cut_crash_backtrace_signal_received = TRUE;
 
-    jump_buffer = current_crash_backtrace->jump_buffer;
+    /* The default action of these signals terminates the
+       process. The action is installed again in case the
+       signal doesn't terminate it. */
+    default_action.sa_handler = SIG_DFL;
+    sigemptyset(&(default_action.sa_mask));
+    default_action.sa_flags = 0;
+    sigaction(signum, &default_action, NULL);
+    raise(signum);
+    sigaction(signum, &i_will_be_back_action, NULL);
+}
+
+static void
+i_will_be_back_handler (int signum, siginfo_t *info, void *user_context)
+{
+    CutCrashBacktrace *crash_backtrace;
+
+    crash_backtrace = g_private_get(&current_crash_backtrace_private);
+    if (!crash_backtrace) {
+        forward_signal(signum, info, user_context);
+        return;
+    }
 
-    cut_crash_backtrace_free(current_crash_backtrace);
+    if (crash_backtrace->holding_interrupts &&
+        (signum == SIGINT || signum == SIGTERM)) {
+        crash_backtrace->held_signum = signum;
+        return;
+    }
+
+    if (crash_backtrace->handling) {
+        write_to_stderr("signal received on crash\n");
+        _exit(EXIT_FAILURE);
+    }
+    crash_backtrace->handling = TRUE;
 
     if (signum != SIGINT) {
-        collect_backtrace();
+#ifdef USE_EXECINFO
+        crash_backtrace->n_addresses =
+            backtrace(crash_backtrace->addresses, MAX_BACKTRACE_ADDRESSES);
+        if (cut_crash_backtrace_show_on_the_moment) {
+            write_to_stderr("\n");
+            backtrace_symbols_fd(crash_backtrace->addresses +
+                                 N_HANDLER_FRAMES,
+                                 crash_backtrace->n_addresses -
+                                 N_HANDLER_FRAMES,
+                                 STDERR_FILENO);
+        }
+#else
+        collect_backtrace(crash_backtrace);
+#endif
+    }
+
+    g_private_set(&current_crash_backtrace_private, crash_backtrace->previous);
+    longjmp(*(crash_backtrace->jump_buffer), signum);
+}
+
+static void
+install_actions (void)
+{
+    G_LOCK(actions);
+    if (n_action_users++ > 0) {
+        G_UNLOCK(actions);
+        return;
+    }
+    actions_thread = pthread_self();
+
+#ifdef USE_EXECINFO
+    {
+        void *address;
+
+        /* backtrace() may load libgcc on the first call. It must
+           not be done in signal handler. */
+        backtrace(&address, 1);
+    }
+#endif
+
+    i_will_be_back_action.sa_sigaction = i_will_be_back_handler;
+    sigemptyset(&(i_will_be_back_action.sa_mask));
+    /* SA_NODEFER: The signal isn't unblocked by longjmp(). */
+    i_will_be_back_action.sa_flags = SA_SIGINFO | SA_ONSTACK | SA_NODEFER;
+    set_segv_action =
+        sigaction(SIGSEGV, &i_will_be_back_action, &previous_segv_action) == 0;
+    set_abort_action =
+        sigaction(SIGABRT, &i_will_be_back_action, &previous_abort_action) == 0;
+    set_terminate_action =
+        sigaction(SIGTERM, &i_will_be_back_action,
+                  &previous_terminate_action) == 0;
+    set_interrupt_action =
+        sigaction(SIGINT, &i_will_be_back_action,
+                  &previous_interrupt_action) == 0;
+    set_bus_error_action =
+        sigaction(SIGBUS, &i_will_be_back_action,
+                  &previous_bus_error_action) == 0;
+    G_UNLOCK(actions);
+}
+
+static void
+uninstall_actions (void)
+{
+    G_LOCK(actions);
+    if (--n_action_users > 0) {
+        G_UNLOCK(actions);
+        return;
+    }
+
+    if (set_interrupt_action)
+        sigaction(SIGINT, &previous_interrupt_action, NULL);
+    if (set_terminate_action)
+        sigaction(SIGTERM, &previous_terminate_action, NULL);
+    if (set_abort_action)
+        sigaction(SIGABRT, &previous_abort_action, NULL);
+    if (set_segv_action)
+        sigaction(SIGSEGV, &previous_segv_action, NULL);
+    if (set_bus_error_action)
+        sigaction(SIGBUS, &previous_bus_error_action, NULL);
+    G_UNLOCK(actions);
+}
+
+static void
+setup_alternate_stack (CutCrashBacktrace *crash_backtrace)
+{
+    stack_t stack;
+
+    if (sigaltstack(NULL, &(crash_backtrace->previous_alternate_stack)) == -1)
+        return;
+    if (!(crash_backtrace->previous_alternate_stack.ss_flags & SS_DISABLE))
+        return;
+
+    crash_backtrace->alternate_stack = g_malloc(ALTERNATE_STACK_SIZE);
+    stack.ss_sp = crash_backtrace->alternate_stack;
+    stack.ss_size = ALTERNATE_STACK_SIZE;
+    stack.ss_flags = 0;
+    if (sigaltstack(&stack, NULL) == -1) {
+        g_free(crash_backtrace->alternate_stack);
+        crash_backtrace->alternate_stack = NULL;
     }
-    longjmp(*jump_buffer, signum);
+}
+
+static void
+teardown_alternate_stack (CutCrashBacktrace *crash_backtrace)
+{
+    if (!crash_backtrace->alternate_stack)
+        return;
+
+    sigaltstack(&(crash_backtrace->previous_alternate_stack), NULL);
+    g_free(crash_backtrace->alternate_stack);
+    crash_backtrace->alternate_stack = NULL;
 }
 
 CutCrashBacktrace *
 cut_crash_backtrace_new (jmp_buf *jump_buffer)
 {
     CutCrashBacktrace *crash_backtrace;
-    struct sigaction *i_will_be_back_action;
-    struct sigaction *previous_segv_action;
-    struct sigaction *previous_abort_action;
-    struct sigaction *previous_terminate_action;
-    struct sigaction *previous_interrupt_action;
-    struct sigaction *previous_bus_error_action;
 
     crash_backtrace = g_new0(CutCrashBacktrace, 1);
     crash_backtrace->jump_buffer = jump_buffer;
-    crash_backtrace->set_segv_action = TRUE;
-    crash_backtrace->set_abort_action = TRUE;
-    crash_backtrace->set_terminate_action = TRUE;
-    crash_backtrace->set_interrupt_action = TRUE;
-    crash_backtrace->set_bus_error_action = TRUE;
-
-    i_will_be_back_action = &(crash_backtrace->i_will_be_back_action);
-    previous_segv_action = &(crash_backtrace->previous_segv_action);
-    previous_abort_action = &(crash_backtrace->previous_abort_action);
-    previous_terminate_action = &(crash_backtrace->previous_terminate_action);
-    previous_interrupt_action = &(crash_backtrace->previous_interrupt_action);
-    previous_bus_error_action = &(crash_backtrace->previous_bus_error_action);
-
-    i_will_be_back_action->sa_handler = i_will_be_back_handler;
-    sigemptyset(&(i_will_be_back_action->sa_mask));
-    i_will_be_back_action->sa_flags = 0;
-    if (sigaction(SIGSEGV, i_will_be_back_action, previous_segv_action) == -1)
-        crash_backtrace->set_segv_action = FALSE;
-    if (sigaction(SIGABRT, i_will_be_back_action, previous_abort_action) == -1)
-        crash_backtrace->set_abort_action = FALSE;
-    if (sigaction(SIGTERM, i_will_be_back_action,
-                  previous_terminate_action) == -1)
-        crash_backtrace->set_terminate_action = FALSE;
-    if (sigaction(SIGINT, i_will_be_back_action,
-                  previous_interrupt_action) == -1)
-        crash_backtrace->set_interrupt_action = FALSE;
-    if (sigaction(SIGBUS, i_will_be_back_action,
-                  previous_bus_error_action) == -1)
-        crash_backtrace->set_bus_error_action = FALSE;
-
-    crash_backtrace->previous = current_crash_backtrace;
-    current_crash_backtrace = crash_backtrace;
+    crash_backtrace->handling = FALSE;
+#ifndef USE_EXECINFO
+    crash_backtrace->gdb_backtrace = g_new0(gchar, GDB_BACKTRACE_SIZE);
+#endif
+
+    crash_backtrace->previous =
+        g_private_get(&current_crash_backtrace_private);
+    if (!crash_backtrace->previous)
+        setup_alternate_stack(crash_backtrace);
+    install_actions();
+    g_private_set(&current_crash_backtrace_private, crash_backtrace);
 
     return crash_backtrace;
 }
@@ -240,36 +448,115 @@ cut_crash_backtrace_new (jmp_buf *jump_buffer)
 void
 cut_crash_backtrace_free (CutCrashBacktrace *crash_backtrace)
 {
-    if (crash_backtrace->set_interrupt_action)
-        sigaction(SIGINT, &(crash_backtrace->previous_interrupt_action), NULL);
-    if (crash_backtrace->set_terminate_action)
-        sigaction(SIGTERM, &(crash_backtrace->previous_terminate_action), NULL);
-    if (crash_backtrace->set_abort_action)
-        sigaction(SIGABRT, &(crash_backtrace->previous_abort_action), NULL);
-    if (crash_backtrace->set_segv_action)
-        sigaction(SIGSEGV, &(crash_backtrace->previous_segv_action), NULL);
-    if (crash_backtrace->set_bus_error_action)
-        sigaction(SIGBUS, &(crash_backtrace->previous_bus_error_action), NULL);
-
-    current_crash_backtrace = crash_backtrace->previous;
+    g_private_set(&current_crash_backtrace_private, crash_backtrace->previous);
+    uninstall_actions();
+    teardown_alternate_stack(crash_backtrace);
 
+#ifndef USE_EXECINFO
+    g_free(crash_backtrace->gdb_backtrace);
+#endif
     g_free(crash_backtrace);
 }
 
+/*
+ * While other threads run tests, SIGINT and SIGTERM must not
+ * jump out of the code waiting for them. They are held until
+ * cut_crash_backtrace_release_interrupts() and handled then.
+ */
+void
+cut_crash_backtrace_hold_interrupts (CutCrashBacktrace *crash_backtrace)
+{
+    crash_backtrace->held_signum = 0;
+    crash_backtrace->holding_interrupts = TRUE;
+}
+
+void
+cut_crash_backtrace_release_interrupts (CutCrashBacktrace *crash_backtrace)
+{
+    gint signum;
+
+    crash_backtrace->holding_interrupts = FALSE;
+    signum = crash_backtrace->held_signum;
+    crash_backtrace->held_signum = 0;
+    if (signum != 0)
+        raise(signum);
+}
+
+#ifdef USE_EXECINFO
+static CutBacktraceEntry *
+parse_backtrace_symbol (const gchar *symbol)
+{
+    CutBacktraceEntry *entry;
+    const gchar *open, *close, *offset;
+    gchar *file = NULL, *function = NULL, *info;
+
+    /* glibc: "FILE(FUNCTION+OFFSET) [ADDRESS]" */
+    open = strchr(symbol, '(');
+    close = open ? strchr(open, ')') : NULL;
+    if (open && close) {
+        file = g_strndup(symbol, open - symbol);
+        offset = memchr(open, '+', close - open);
+        if (!offset)
+            offset = close;
+        if (offset > open + 1)
+            function = g_strndup(open + 1, offset - (open + 1));
+        info = g_strdup_printf("%.*s%s",
+                               (gint)(close - offset), offset, close + 1);
+        g_strstrip(info);
+    } else {
+        info = g_strdup(symbol);
+    }
+
+    entry = cut_backtrace_entry_new(file, 0, function, info);
+    g_free(file);
+    g_free(function);
+    g_free(info);
+
+    return entry;
+}
+#endif
+
+static GList *
+symbolize_backtrace (CutCrashBacktrace *crash_backtrace)
+{
+#ifdef USE_EXECINFO
+    GList *entries = NULL;
+    gchar **symbols;
+    gint i;
+
+    if (crash_backtrace->n_addresses <= N_HANDLER_FRAMES)
+        return NULL;
+
+    symbols = backtrace_symbols(crash_backtrace->addresses,
+                                crash_backtrace->n_addresses);
+    if (!symbols)
+        return NULL;
+    for (i = N_HANDLER_FRAMES; i < crash_backtrace->n_addresses; i++) {
+        entries = g_list_prepend(entries, parse_backtrace_symbol(symbols[i]));
+    }
+    free(symbols);
+
+    return g_list_reverse(entries);
+#else
+    return cut_utils_parse_gdb_backtrace(crash_backtrace->gdb_backtrace);
+#endif
+}
+
 void
-cut_crash_backtrace_emit (CutTestSuite    *test_suite,
-                          CutTestCase     *test_case,
-                          CutTest         *test,
-                          CutTestIterator *test_iterator,
-                          CutTestData     *test_data,
-                          CutTestContext  *test_context)
+cut_crash_backtrace_emit (CutCrashBacktrace *crash_backtrace,
+                          CutTestSuite      *test_suite,
+                          CutTestCase       *test_case,
+                          CutTest           *test,
+                          CutTestIterator   *test_iterator,
+                          CutTestData       *test_data,
+                          CutTestContext    *test_context)
 {
     CutTestResult *result;
     GList *parsed_backtrace = NULL;
     CutTest *target;
 
-    parsed_backtrace = cut_utils_parse_gdb_backtrace(crash_backtrace);
-    crash_backtrace[0] = '\0';
+    if (crash_backtrace)
+        parsed_backtrace = symbolize_backtrace(crash_backtrace);
 
     result = cut_test_result_new(CUT_TEST_RESULT_CRASH,
                                  test, test_iterator, test_case, test_suite,
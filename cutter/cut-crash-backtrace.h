@@ -39,13 +39,18 @@ void               cut_crash_backtrace_reset_signal_received  (void);
 
 CutCrashBacktrace *cut_crash_backtrace_new      (jmp_buf *jump_buffer);
 void               cut_crash_backtrace_free     (CutCrashBacktrace *crash_backtrace);
-
-void               cut_crash_backtrace_emit     (CutTestSuite    *test_suite,
-                                                 CutTestCase     *test_case,
-                                                 CutTest         *test,
-                                                 CutTestIterator *test_iterator,
-                                                 CutTestData     *test_data,
-                                                 CutTestContext  *test_context);
+void               cut_crash_backtrace_hold_interrupts
+                                                (CutCrashBacktrace *crash_backtrace);
+void               cut_crash_backtrace_release_interrupts
+                                                (CutCrashBacktrace *crash_backtrace);
+
+void               cut_crash_backtrace_emit     (CutCrashBacktrace *crash_backtrace,
+                                                 CutTestSuite      *test_suite,
+                                                 CutTestCase       *test_case,
+                                                 CutTest           *test,
+                                                 CutTestIterator   *test_iterator,
+                                                 CutTestData       *test_data,
+                                                 CutTestContext    *test_context);
 
 
 G_END_DECLS
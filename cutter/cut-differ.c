@@ -1,6 +1,6 @@
 /* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
 /*
- *  Copyright (C) 2008-2011  Kouhei Sutou <kou@clear-code.com>
+ *  Copyright (C) 2008-2014  Kouhei Sutou <kou@clear-code.com>
  *
  *  This library is free software: you can redistribute it and/or modify
  *  it under the terms of the GNU Lesser General Public License as published by
@@ -297,6 +297,9 @@ cut_differ_need_diff (CutDiffer *differ)
             from_end = operation->from_end;
             to_begin = operation->to_begin;
             to_end = operation->to_end;
+            if ((guint64)(from_end - from_begin) * (to_end - to_begin) >
+                CUT_DIFFER_MAX_REPLACED_LINE_PAIRS)
+                return TRUE;
             for (from_index = from_begin; from_index < from_end; from_index++) {
                 for (to_index = to_begin; to_index < to_end; to_index++) {
                     CutSequenceMatcher *char_matcher;
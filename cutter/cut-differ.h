@@ -1,6 +1,6 @@
 /* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
 /*
- *  Copyright (C) 2008-2010  Kouhei Sutou <kou@clear-code.com>
+ *  Copyright (C) 2008-2014  Kouhei Sutou <kou@clear-code.com>
  *
  *  This library is free software: you can redistribute it and/or modify
  *  it under the terms of the GNU Lesser General Public License as published by
@@ -27,6 +27,13 @@
 
 G_BEGIN_DECLS
 
+/*
+ * Replaced lines are compared with each other to find
+ * similar lines. They are just marked as deleted and
+ * inserted when there are more pairs than this.
+ */
+#define CUT_DIFFER_MAX_REPLACED_LINE_PAIRS 10000
+
 #define CUT_TYPE_DIFFER            (cut_differ_get_type ())
 #define CUT_DIFFER(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), CUT_TYPE_DIFFER, CutDiffer))
 #define CUT_DIFFER_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), CUT_TYPE_DIFFER, CutDifferClass))
@@ -31,6 +31,7 @@
 #include <glib/gstdio.h>
 
 #include "cut-elf-loader.h"
+#include "cut-glib-compatible.h"
 #include "cut-logger.h"
 
 #define CUT_ELF_LOADER_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE((obj), CUT_TYPE_ELF_LOADER, CutELFLoaderPrivate))
@@ -45,7 +46,8 @@ typedef struct _CutELFLoaderPrivate	CutELFLoaderPrivate;
 struct _CutELFLoaderPrivate
 {
     gchar *so_filename;
-    gchar *content;
+    GMappedFile *mapped_file;
+    const gchar *content;
     gsize length;
     ArchitectureBit bit;
 };
@@ -68,6 +70,41 @@ static void get_property    (GObject               *object,
                              GValue                *value,
                              GParamSpec            *pspec);
 
+/*
+ * We map the shared object instead of reading it. Only
+ * pages for the headers, .dynsym and .dynstr are touched;
+ * large debug sections are never read.
+ */
+#ifdef HAVE_ELF_H
+static gboolean
+map_file (CutELFLoaderPrivate *priv)
+{
+    GError *error = NULL;
+
+    priv->mapped_file = g_mapped_file_new(priv->so_filename, FALSE, &error);
+    if (!priv->mapped_file) {
+        g_warning("can't read shared library file: %s", error->message);
+        g_error_free(error);
+        return FALSE;
+    }
+    priv->content = g_mapped_file_get_contents(priv->mapped_file);
+    priv->length = g_mapped_file_get_length(priv->mapped_file);
+
+    return TRUE;
+}
+#endif
+
+static void
+unmap_file (CutELFLoaderPrivate *priv)
+{
+    if (priv->mapped_file) {
+        g_mapped_file_unref(priv->mapped_file);
+        priv->mapped_file = NULL;
+    }
+    priv->content = NULL;
+    priv->length = 0;
+}
+
 static void
 cut_elf_loader_class_init (CutELFLoaderClass *klass)
 {
@@ -96,6 +133,7 @@ cut_elf_loader_init (CutELFLoader *loader)
     CutELFLoaderPrivate *priv = CUT_ELF_LOADER_GET_PRIVATE(loader);
 
     priv->so_filename = NULL;
+    priv->mapped_file = NULL;
     priv->content = NULL;
     priv->length = 0;
     priv->bit = ARCHITECTURE_UNKNOWN;
@@ -111,10 +149,7 @@ dispose (GObject *object)
         priv->so_filename = NULL;
     }
 
-    if (priv->content) {
-        g_free(priv->content);
-        priv->content = NULL;
-    }
+    unmap_file(priv);
 
     G_OBJECT_CLASS(cut_elf_loader_parent_class)->dispose(object);
 }
@@ -170,23 +205,18 @@ cut_elf_loader_is_elf (CutELFLoader *loader)
 {
 #ifdef HAVE_ELF_H
     CutELFLoaderPrivate *priv;
-    GError *error = NULL;
     unsigned char ident[EI_NIDENT];
 
     priv = CUT_ELF_LOADER_GET_PRIVATE(loader);
     cut_log_trace("[loader][elf][open] <%s>", priv->so_filename);
-    if (!g_file_get_contents(priv->so_filename, &priv->content, &priv->length,
-                             &error)) {
-        g_warning("can't read shared library file: %s", error->message);
-        g_error_free(error);
+    unmap_file(priv);
+    if (!map_file(priv))
         return FALSE;
-    }
 
-    if (priv->length < sizeof(ident)) {
+    if (priv->length < sizeof(Elf32_Ehdr)) {
         cut_log_warning("ELF file must have at least %zd size: %" G_GSIZE_FORMAT,
-                        sizeof(ident), priv->length);
-        g_free(priv->content);
-        priv->content = NULL;
+                        sizeof(Elf32_Ehdr), priv->length);
+        unmap_file(priv);
         return FALSE;
     }
 
@@ -207,14 +237,20 @@ cut_elf_loader_is_elf (CutELFLoader *loader)
             break;
         default:
             g_warning("unknown ELF class: 0x%x", ident[EI_CLASS]);
-            g_free(priv->content);
-            priv->content = NULL;
+            unmap_file(priv);
             break;
         }
     } else {
         cut_log_trace("[loader][elf][header][unknown]");
-        g_free(priv->content);
-        priv->content = NULL;
+        unmap_file(priv);
+    }
+
+    if (priv->content && priv->bit == ARCHITECTURE_64BIT &&
+        priv->length < sizeof(Elf64_Ehdr)) {
+        cut_log_warning("64-bit ELF file must have at least %zd size: "
+                        "%" G_GSIZE_FORMAT,
+                        sizeof(Elf64_Ehdr), priv->length);
+        unmap_file(priv);
     }
 
     if (priv->content) {
@@ -224,8 +260,7 @@ cut_elf_loader_is_elf (CutELFLoader *loader)
         cut_log_trace("[loader][elf][type] <%#x>", type);
         if (type != ET_DYN) {
             g_warning("not dynamic library: %#x", type);
-            g_free(priv->content);
-            priv->content = NULL;
+            unmap_file(priv);
         }
     }
 
@@ -246,119 +281,149 @@ cut_elf_loader_support_attribute (CutELFLoader *loader)
 }
 
 #ifdef HAVE_ELF_H
+static gboolean
+is_valid_range (CutELFLoaderPrivate *priv, guint64 offset, guint64 size)
+{
+    return offset <= priv->length && size <= priv->length - offset;
+}
+
 static gboolean
 collect_symbol_information (CutELFLoaderPrivate *priv,
                             gsize *symbol_section_offset,
                             gsize *symbol_entry_size,
                             guint *n_entries,
                             gsize *name_section_offset,
+                            gsize *name_section_size,
                             uint16_t *text_section_header_index)
 {
-    gboolean collected = FALSE;
-    gsize section_offset = 0;
-    Elf32_Ehdr *header_32 = NULL;
-    Elf64_Ehdr *header_64 = NULL;
+    guint64 section_offset;
     uint16_t i, n_headers;
     uint16_t section_header_size;
-    const gchar *section_names;
-    Elf32_Shdr *dynstr_32 = NULL;
-    Elf32_Shdr *dynsym_32 = NULL;
-    Elf64_Shdr *dynstr_64 = NULL;
-    Elf64_Shdr *dynsym_64 = NULL;
+    uint16_t section_name_header_index;
+    guint64 section_names_offset, section_names_size;
+    guint64 dynsym_offset = 0, dynsym_size = 0, dynsym_entry_size = 0;
+    guint64 dynstr_offset = 0, dynstr_size = 0;
+    gboolean have_dynsym = FALSE, have_dynstr = FALSE;
     uint16_t _text_section_header_index = 0;
 
     if (priv->bit == ARCHITECTURE_32BIT) {
-        Elf32_Shdr *section_name_header;
-        gsize section_name_header_offset;
+        const Elf32_Ehdr *header_32 = (const Elf32_Ehdr *)priv->content;
 
-        header_32 = (Elf32_Ehdr *)priv->content;
         section_offset = header_32->e_shoff;
         section_header_size = header_32->e_shentsize;
         n_headers = header_32->e_shnum;
-
-        section_name_header_offset =
-            header_32->e_shoff +
-            (header_32->e_shstrndx * header_32->e_shentsize);
-        section_name_header =
-            (Elf32_Shdr *)(priv->content + section_name_header_offset);
-        section_names = priv->content + section_name_header->sh_offset;
+        section_name_header_index = header_32->e_shstrndx;
+        if (section_header_size < sizeof(Elf32_Shdr))
+            return FALSE;
     } else {
-        Elf64_Shdr *section_name_header;
-        gsize section_name_header_offset;
+        const Elf64_Ehdr *header_64 = (const Elf64_Ehdr *)priv->content;
 
-        header_64 = (Elf64_Ehdr *)priv->content;
         section_offset = header_64->e_shoff;
         section_header_size = header_64->e_shentsize;
         n_headers = header_64->e_shnum;
+        section_name_header_index = header_64->e_shstrndx;
+        if (section_header_size < sizeof(Elf64_Shdr))
+            return FALSE;
+    }
+
+    if (!is_valid_range(priv, section_offset,
+                        (guint64)section_header_size * n_headers) ||
+        section_name_header_index >= n_headers) {
+        cut_log_warning("[loader][elf][collect-symbols][broken-section-headers]");
+        return FALSE;
+    }
+
+#define SECTION_HEADER(type, index)                                     \
+    ((const type *)(priv->content + section_offset +                   \
+                    (guint64)section_header_size * (index)))
+
+    if (priv->bit == ARCHITECTURE_32BIT) {
+        const Elf32_Shdr *header;
+
+        header = SECTION_HEADER(Elf32_Shdr, section_name_header_index);
+        section_names_offset = header->sh_offset;
+        section_names_size = header->sh_size;
+    } else {
+        const Elf64_Shdr *header;
 
-        section_name_header_offset =
-            header_64->e_shoff +
-            (header_64->e_shstrndx * header_64->e_shentsize);
-        section_name_header =
-            (Elf64_Shdr *)(priv->content + section_name_header_offset);
-        section_names = priv->content + section_name_header->sh_offset;
+        header = SECTION_HEADER(Elf64_Shdr, section_name_header_index);
+        section_names_offset = header->sh_offset;
+        section_names_size = header->sh_size;
     }
+    if (!is_valid_range(priv, section_names_offset, section_names_size))
+        return FALSE;
 
     cut_log_trace("[loader][elf][collect-symbols][n-header] <%d>", n_headers);
     for (i = 0; i < n_headers; i++) {
-        Elf32_Shdr *section_header_32 = NULL;
-        Elf64_Shdr *section_header_64 = NULL;
-        gsize offset;
+        guint64 name_index, offset, size, entry_size;
         const gchar *section_name;
 
-        offset = section_offset + (section_header_size * i);
         if (priv->bit == ARCHITECTURE_32BIT) {
-            section_header_32 = (Elf32_Shdr *)(priv->content + offset);
-            section_name = section_names + section_header_32->sh_name;
+            const Elf32_Shdr *header = SECTION_HEADER(Elf32_Shdr, i);
+
+            name_index = header->sh_name;
+            offset = header->sh_offset;
+            size = header->sh_size;
+            entry_size = header->sh_entsize;
         } else {
-            section_header_64 = (Elf64_Shdr *)(priv->content + offset);
-            section_name = section_names + section_header_64->sh_name;
+            const Elf64_Shdr *header = SECTION_HEADER(Elf64_Shdr, i);
+
+            name_index = header->sh_name;
+            offset = header->sh_offset;
+            size = header->sh_size;
+            entry_size = header->sh_entsize;
         }
 
+        if (name_index >= section_names_size)
+            continue;
+        section_name = priv->content + section_names_offset + name_index;
+        if (!memchr(section_name, '\0', section_names_size - name_index))
+            continue;
+
         if (g_str_equal(section_name, ".dynstr")) {
-            if (priv->bit == ARCHITECTURE_32BIT) {
-                dynstr_32 = section_header_32;
-            } else {
-                dynstr_64 = section_header_64;
-            }
+            have_dynstr = TRUE;
+            dynstr_offset = offset;
+            dynstr_size = size;
         } else if (g_str_equal(section_name, ".dynsym")) {
-            if (priv->bit == ARCHITECTURE_32BIT) {
-                dynsym_32 = section_header_32;
-            } else {
-                dynsym_64 = section_header_64;
-            }
+            have_dynsym = TRUE;
+            dynsym_offset = offset;
+            dynsym_size = size;
+            dynsym_entry_size = entry_size;
         } else if (g_str_equal(section_name, ".text")) {
             _text_section_header_index = i;
         }
     }
 
+#undef SECTION_HEADER
+
+    if (!have_dynsym || !have_dynstr || _text_section_header_index == 0)
+        return FALSE;
+
+    if (!is_valid_range(priv, dynsym_offset, dynsym_size) ||
+        !is_valid_range(priv, dynstr_offset, dynstr_size)) {
+        cut_log_warning("[loader][elf][collect-symbols][broken-dynamic-symbols]");
+        return FALSE;
+    }
+
     if (priv->bit == ARCHITECTURE_32BIT) {
-        if (dynsym_32 && dynstr_32 && _text_section_header_index > 0) {
-            collected = TRUE;
-            *symbol_section_offset = dynsym_32->sh_offset;
-            *symbol_entry_size = dynsym_32->sh_entsize;
-            if (*symbol_entry_size > 0)
-                *n_entries = dynsym_32->sh_size / *symbol_entry_size;
-            else
-                *n_entries = 0;
-            *name_section_offset = dynstr_32->sh_offset;
-            *text_section_header_index = _text_section_header_index;
-        }
+        if (dynsym_entry_size < sizeof(Elf32_Sym))
+            dynsym_entry_size = 0;
     } else {
-        if (dynsym_64 && dynstr_64 && _text_section_header_index > 0) {
-            collected = TRUE;
-            *symbol_section_offset = dynsym_64->sh_offset;
-            *symbol_entry_size = dynsym_64->sh_entsize;
-            if (*symbol_entry_size > 0)
-                *n_entries = dynsym_64->sh_size / *symbol_entry_size;
-            else
-                *n_entries = 0;
-            *name_section_offset = dynstr_64->sh_offset;
-            *text_section_header_index = _text_section_header_index;
-        }
+        if (dynsym_entry_size < sizeof(Elf64_Sym))
+            dynsym_entry_size = 0;
     }
 
-    return collected;
+    *symbol_section_offset = dynsym_offset;
+    *symbol_entry_size = dynsym_entry_size;
+    if (dynsym_entry_size > 0)
+        *n_entries = dynsym_size / dynsym_entry_size;
+    else
+        *n_entries = 0;
+    *name_section_offset = dynstr_offset;
+    *name_section_size = dynstr_size;
+    *text_section_header_index = _text_section_header_index;
+
+    return TRUE;
 }
 
 static const gchar *
@@ -406,21 +471,25 @@ cut_elf_loader_collect_symbols (CutELFLoader *loader)
     gsize symbol_entry_size;
     guint i, n_entries;
     gsize name_section_offset;
+    gsize name_section_size;
     uint16_t text_section_header_index;
 
     priv = CUT_ELF_LOADER_GET_PRIVATE(loader);
+    if (!priv->content)
+        return NULL;
     if (!collect_symbol_information(priv,
                                     &symbol_section_offset,
                                     &symbol_entry_size,
                                     &n_entries,
                                     &name_section_offset,
+                                    &name_section_size,
                                     &text_section_header_index))
         return NULL;
 
     cut_log_trace("[loader][elf][collect-symbols][n-symbols] <%d>", n_entries);
     for (i = 0; i < n_entries; i++) {
-        Elf32_Sym *symbol_32;
-        Elf64_Sym *symbol_64;
+        const Elf32_Sym *symbol_32;
+        const Elf64_Sym *symbol_64;
         uint32_t name_index;
         unsigned char info, type, bind;
         uint16_t section_header_index;
@@ -429,14 +498,14 @@ cut_elf_loader_collect_symbols (CutELFLoader *loader)
 
         offset = symbol_section_offset + (i * symbol_entry_size);
         if (priv->bit == ARCHITECTURE_32BIT) {
-            symbol_32 = (Elf32_Sym *)(priv->content + offset);
+            symbol_32 = (const Elf32_Sym *)(priv->content + offset);
             name_index = symbol_32->st_name;
             info = symbol_32->st_info;
             type = ELF32_ST_TYPE(info);
             bind = ELF32_ST_BIND(info);
             section_header_index = symbol_32->st_shndx;
         } else {
-            symbol_64 = (Elf64_Sym *)(priv->content + offset);
+            symbol_64 = (const Elf64_Sym *)(priv->content + offset);
             name_index = symbol_64->st_name;
             info = symbol_64->st_info;
             type = ELF64_ST_TYPE(info);
@@ -444,7 +513,11 @@ cut_elf_loader_collect_symbols (CutELFLoader *loader)
             section_header_index = symbol_64->st_shndx;
         }
 
+        if (name_index >= name_section_size)
+            continue;
         name = priv->content + name_section_offset + name_index;
+        if (!memchr(name, '\0', name_section_size - name_index))
+            continue;
         cut_log_trace("[loader][elf][collect-symbols][symbol] <%s>:<%s>:<%s>",
                       name_index > 0 ? name : "null",
                       inspect_type(type),
@@ -464,6 +537,147 @@ cut_elf_loader_collect_symbols (CutELFLoader *loader)
 #endif
 }
 
+#ifdef HAVE_ELF_H
+#  ifndef NT_GNU_BUILD_ID
+#    define NT_GNU_BUILD_ID 3
+#  endif
+
+static gboolean
+read_at (FILE *file, long offset, gpointer buffer, gsize size)
+{
+    if (fseek(file, offset, SEEK_SET) != 0)
+        return FALSE;
+    return fread(buffer, 1, size, file) == size;
+}
+
+#define ALIGN_4(size) (((size) + 3) & ~3)
+
+static gchar *
+find_build_id_note (const guchar *notes, gsize size)
+{
+    gsize offset = 0;
+
+    while (offset + sizeof(Elf32_Nhdr) <= size) {
+        Elf32_Nhdr note;
+        const guchar *name, *description;
+
+        memcpy(&note, notes + offset, sizeof(note));
+        offset += sizeof(note);
+        name = notes + offset;
+        if (offset + ALIGN_4(note.n_namesz) > size)
+            break;
+        offset += ALIGN_4(note.n_namesz);
+        description = notes + offset;
+        if (offset + note.n_descsz > size)
+            break;
+        offset += ALIGN_4(note.n_descsz);
+
+        if (note.n_type == NT_GNU_BUILD_ID &&
+            note.n_namesz == sizeof("GNU") &&
+            memcmp(name, "GNU", sizeof("GNU")) == 0 &&
+            note.n_descsz > 0) {
+            GString *build_id;
+            guint32 i;
+
+            build_id = g_string_sized_new(note.n_descsz * 2);
+            for (i = 0; i < note.n_descsz; i++)
+                g_string_append_printf(build_id, "%02x", description[i]);
+            return g_string_free(build_id, FALSE);
+        }
+    }
+
+    return NULL;
+}
+#endif
+
+/*
+ * Reads the GNU build-id note without reading the whole
+ * file. Only the ELF header, the program headers and
+ * PT_NOTE segments are read.
+ */
+gchar *
+cut_elf_loader_read_build_id (const gchar *so_filename)
+{
+#ifdef HAVE_ELF_H
+    FILE *file;
+    unsigned char ident[EI_NIDENT];
+    gsize program_header_offset = 0, program_header_size = 0;
+    guint i, n_program_headers = 0;
+    gchar *build_id = NULL;
+
+    file = g_fopen(so_filename, "rb");
+    if (!file)
+        return NULL;
+
+    if (!read_at(file, 0, ident, sizeof(ident)) ||
+        ident[EI_MAG0] != ELFMAG0 || ident[EI_MAG1] != ELFMAG1 ||
+        ident[EI_MAG2] != ELFMAG2 || ident[EI_MAG3] != ELFMAG3) {
+        fclose(file);
+        return NULL;
+    }
+
+    if (ident[EI_CLASS] == ELFCLASS32) {
+        Elf32_Ehdr header;
+
+        if (read_at(file, 0, &header, sizeof(header))) {
+            program_header_offset = header.e_phoff;
+            program_header_size = header.e_phentsize;
+            n_program_headers = header.e_phnum;
+        }
+    } else if (ident[EI_CLASS] == ELFCLASS64) {
+        Elf64_Ehdr header;
+
+        if (read_at(file, 0, &header, sizeof(header))) {
+            program_header_offset = header.e_phoff;
+            program_header_size = header.e_phentsize;
+            n_program_headers = header.e_phnum;
+        }
+    }
+
+    for (i = 0; i < n_program_headers && !build_id; i++) {
+        gsize offset, note_offset, note_size;
+        guchar *notes;
+
+        offset = program_header_offset + program_header_size * i;
+        if (ident[EI_CLASS] == ELFCLASS32) {
+            Elf32_Phdr program_header;
+
+            if (!read_at(file, offset, &program_header, sizeof(program_header)))
+                break;
+            if (program_header.p_type != PT_NOTE)
+                continue;
+            note_offset = program_header.p_offset;
+            note_size = program_header.p_filesz;
+        } else {
+            Elf64_Phdr program_header;
+
+            if (!read_at(file, offset, &program_header, sizeof(program_header)))
+                break;
+            if (program_header.p_type != PT_NOTE)
+                continue;
+            note_offset = program_header.p_offset;
+            note_size = program_header.p_filesz;
+        }
+
+        /* build-id notes are tiny; don't read a broken huge one. */
+        if (note_size == 0 || note_size > 64 * 1024)
+            continue;
+        notes = g_malloc(note_size);
+        if (read_at(file, note_offset, notes, note_size))
+            build_id = find_build_id_note(notes, note_size);
+        g_free(notes);
+    }
+
+    fclose(file);
+    cut_log_trace("[loader][elf][build-id] <%s>:<%s>",
+                  so_filename, build_id ? build_id : "none");
+
+    return build_id;
+#else
+    return NULL;
+#endif
+}
+
 /*
 vi:ts=4:nowrap:ai:expandtab:sw=4
 */
@@ -53,6 +53,8 @@ gboolean           cut_elf_loader_is_elf            (CutELFLoader *loader);
 gboolean           cut_elf_loader_support_attribute (CutELFLoader *loader);
 GList             *cut_elf_loader_collect_symbols   (CutELFLoader *loader);
 
+gchar             *cut_elf_loader_read_build_id     (const gchar  *so_filename);
+
 G_END_DECLS
 
 #endif /* __CUT_ELF_LOADER_H__ */
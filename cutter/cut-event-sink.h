@@ -0,0 +1,82 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CUT_EVENT_SINK_H__
+#define __CUT_EVENT_SINK_H__
+
+#include <glib.h>
+
+#include <cutter/cut-test.h>
+#include <cutter/cut-test-context.h>
+#include <cutter/cut-test-result.h>
+
+G_BEGIN_DECLS
+
+/*
+ * CutEventSink receives events of a test directly from
+ * CutTest instead of through signals of the test. It is
+ * attached to the test context that runs the test, so a
+ * runner doesn't need to connect to and disconnect from
+ * each test. Signals of the test are still emitted for
+ * handlers connected to them.
+ *
+ * pass_assertion may be NULL. Passed assertions are
+ * reported only in batch by pass_assertions and
+ * "pass-assertions" signal of the test in the case.
+ * "pass-assertion" signal of the test isn't emitted.
+ */
+
+typedef struct _CutEventSink CutEventSink;
+struct _CutEventSink
+{
+    void (*start)           (CutTest        *test,
+                             CutTestContext *test_context,
+                             gpointer        user_data);
+    void (*pass_assertion)  (CutTest        *test,
+                             CutTestContext *test_context,
+                             gpointer        user_data);
+    void (*pass_assertions) (CutTest        *test,
+                             CutTestContext *test_context,
+                             guint           n_assertions,
+                             gpointer        user_data);
+    void (*result)          (CutTest        *test,
+                             CutTestContext *test_context,
+                             CutTestResult  *result,
+                             gpointer        user_data);
+    void (*complete)        (CutTest        *test,
+                             CutTestContext *test_context,
+                             gboolean        success,
+                             gpointer        user_data);
+};
+
+void                cut_test_context_set_event_sink
+                                        (CutTestContext     *context,
+                                         const CutEventSink *sink,
+                                         gpointer            user_data);
+const CutEventSink *cut_test_context_get_event_sink
+                                        (CutTestContext     *context,
+                                         gpointer           *user_data);
+
+G_END_DECLS
+
+#endif /* __CUT_EVENT_SINK_H__ */
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
@@ -39,6 +39,22 @@ cut_glib_compatible_mutex_free(GMutex *mutex)
     g_mutex_clear(mutex);
     g_free(mutex);
 }
+
+GCond *
+cut_glib_compatible_cond_new(void)
+{
+    GCond *cond;
+    cond = g_new(GCond, 1);
+    g_cond_init(cond);
+    return cond;
+}
+
+void
+cut_glib_compatible_cond_free(GCond *cond)
+{
+    g_cond_clear(cond);
+    g_free(cond);
+}
 #endif
 
 /*
@@ -24,6 +24,16 @@
 
 G_BEGIN_DECLS
 
+#if !GLIB_CHECK_VERSION(2, 22, 0)
+#  define g_mapped_file_unref(file) g_mapped_file_free(file)
+#endif
+
+#if !GLIB_CHECK_VERSION(2, 30, 0)
+#  undef g_atomic_int_add
+#  define g_atomic_int_add(atomic, value)       \
+    g_atomic_int_exchange_and_add(atomic, value)
+#endif
+
 #if !GLIB_CHECK_VERSION(2, 32, 0)
 #  define GPrivate                  GStaticPrivate
 #  define G_PRIVATE_INIT(notify)    G_STATIC_PRIVATE_INIT
@@ -32,9 +42,15 @@ G_BEGIN_DECLS
 #else
 #  define g_mutex_new()             cut_glib_compatible_mutex_new()
 #  define g_mutex_free(mutex)       cut_glib_compatible_mutex_free(mutex)
+#  define g_cond_new()              cut_glib_compatible_cond_new()
+#  define g_cond_free(cond)         cut_glib_compatible_cond_free(cond)
+#  define g_thread_create(func, data, joinable, error)  \
+    g_thread_try_new(NULL, func, data, error)
 
 GMutex *cut_glib_compatible_mutex_new (void);
 void    cut_glib_compatible_mutex_free(GMutex *mutex);
+GCond  *cut_glib_compatible_cond_new  (void);
+void    cut_glib_compatible_cond_free (GCond  *cond);
 
 #endif
 
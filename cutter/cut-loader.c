@@ -38,12 +38,16 @@
 #include "cut-elf-loader.h"
 #include "cut-mach-o-loader.h"
 #include "cut-pe-loader.h"
+#include "cut-test-index.h"
 #include "cut-test-iterator.h"
+#include "cut-benchmark.h"
 #include "cut-experimental.h"
 #include "cut-logger.h"
+#include "cut-utils.h"
 
 #define TEST_SUITE_SO_NAME_PREFIX "suite"
 #define TEST_NAME_PREFIX "test_"
+#define BENCHMARK_NAME_PREFIX "bench_"
 #define DATA_SETUP_FUNCTION_NAME_PREFIX "data_"
 #define ATTRIBUTES_SETUP_FUNCTION_NAME_PREFIX "attributes_"
 #define CUT_LOADER_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CUT_TYPE_LOADER, CutLoaderPrivate))
@@ -63,6 +67,7 @@ struct _SymbolNames
     gchar *data_setup_function_name;
     gchar *attributes_setup_function_name;
     gboolean require_data_setup_function;
+    gboolean benchmark;
     gboolean cpp;
     gboolean gcc;
 };
@@ -72,11 +77,21 @@ struct _CutLoaderPrivate
 {
     gchar *so_filename;
     GList *symbols;
+    GHashTable *symbol_table;
+    GHashTable *attribute_function_table;
+    GHashTable *cpp_attribute_function_table;
     GModule *module;
     CutBinaryType binary_type;
     CutELFLoader *elf_loader;
     CutMachOLoader *mach_o_loader;
     CutPELoader *pe_loader;
+    CutTestIndex *test_index;
+    gboolean symbols_from_test_index;
+    gboolean test_index_support_attribute;
+    GList *test_names;
+    gboolean test_functions_collected;
+    gchar **target_test_case_names;
+    gchar **target_test_names;
     gboolean keep_opening;
     gboolean enable_convenience_attribute_definition;
     gchar *base_directory;
@@ -180,6 +195,16 @@ cut_loader_init (CutLoader *loader)
     priv->elf_loader = NULL;
     priv->mach_o_loader = NULL;
     priv->pe_loader = NULL;
+    priv->symbol_table = NULL;
+    priv->attribute_function_table = NULL;
+    priv->cpp_attribute_function_table = NULL;
+    priv->test_index = NULL;
+    priv->symbols_from_test_index = FALSE;
+    priv->test_index_support_attribute = FALSE;
+    priv->test_names = NULL;
+    priv->test_functions_collected = FALSE;
+    priv->target_test_case_names = NULL;
+    priv->target_test_names = NULL;
     priv->keep_opening = FALSE;
     priv->enable_convenience_attribute_definition = FALSE;
     priv->base_directory = NULL;
@@ -192,6 +217,21 @@ cut_loader_init (CutLoader *loader)
 static void
 free_symbols (CutLoaderPrivate *priv)
 {
+    if (priv->symbol_table) {
+        g_hash_table_unref(priv->symbol_table);
+        priv->symbol_table = NULL;
+    }
+
+    if (priv->attribute_function_table) {
+        g_hash_table_unref(priv->attribute_function_table);
+        priv->attribute_function_table = NULL;
+    }
+
+    if (priv->cpp_attribute_function_table) {
+        g_hash_table_unref(priv->cpp_attribute_function_table);
+        priv->cpp_attribute_function_table = NULL;
+    }
+
     if (priv->symbols) {
         g_list_foreach(priv->symbols, (GFunc)g_free, NULL);
         g_list_free(priv->symbols);
@@ -199,6 +239,16 @@ free_symbols (CutLoaderPrivate *priv)
     }
 }
 
+static void
+free_test_names (CutLoaderPrivate *priv)
+{
+    if (priv->test_names) {
+        g_list_foreach(priv->test_names, (GFunc)symbol_names_free, NULL);
+        g_list_free(priv->test_names);
+        priv->test_names = NULL;
+    }
+}
+
 static void
 dispose (GObject *object)
 {
@@ -231,6 +281,17 @@ dispose (GObject *object)
     }
 
     free_symbols(priv);
+    free_test_names(priv);
+
+    if (priv->target_test_case_names) {
+        g_strfreev(priv->target_test_case_names);
+        priv->target_test_case_names = NULL;
+    }
+
+    if (priv->target_test_names) {
+        g_strfreev(priv->target_test_names);
+        priv->target_test_names = NULL;
+    }
 
     if (priv->base_directory) {
         g_free(priv->base_directory);
@@ -333,6 +394,48 @@ cut_loader_set_base_directory (CutLoader *loader, const gchar *base_directory)
     priv->base_directory = g_strdup(base_directory);
 }
 
+CutTestIndex *
+cut_loader_get_test_index (CutLoader *loader)
+{
+    return CUT_LOADER_GET_PRIVATE(loader)->test_index;
+}
+
+void
+cut_loader_set_test_index (CutLoader *loader, CutTestIndex *test_index)
+{
+    CUT_LOADER_GET_PRIVATE(loader)->test_index = test_index;
+}
+
+const gchar **
+cut_loader_get_target_test_case_names (CutLoader *loader)
+{
+    return (const gchar **)CUT_LOADER_GET_PRIVATE(loader)->target_test_case_names;
+}
+
+void
+cut_loader_set_target_test_case_names (CutLoader *loader, const gchar **names)
+{
+    CutLoaderPrivate *priv = CUT_LOADER_GET_PRIVATE(loader);
+
+    g_strfreev(priv->target_test_case_names);
+    priv->target_test_case_names = g_strdupv((gchar **)names);
+}
+
+const gchar **
+cut_loader_get_target_test_names (CutLoader *loader)
+{
+    return (const gchar **)CUT_LOADER_GET_PRIVATE(loader)->target_test_names;
+}
+
+void
+cut_loader_set_target_test_names (CutLoader *loader, const gchar **names)
+{
+    CutLoaderPrivate *priv = CUT_LOADER_GET_PRIVATE(loader);
+
+    g_strfreev(priv->target_test_names);
+    priv->target_test_names = g_strdupv((gchar **)names);
+}
+
 void
 cut_loader_set_create_test_function (CutLoader *loader,
                                      CutCreateTestFunction create_test_function,
@@ -684,6 +787,26 @@ detect_test_function_symbol_names (const gchar *name)
                                 FALSE);
     }
 
+    if (g_str_has_prefix(name, BENCHMARK_NAME_PREFIX)) {
+        SymbolNames *names;
+        gchar *attributes_setup_function_name;
+
+        attributes_setup_function_name =
+            g_strconcat(ATTRIBUTES_SETUP_FUNCTION_NAME_PREFIX,
+                        name + strlen(BENCHMARK_NAME_PREFIX),
+                        NULL);
+        names = symbol_names_new(NULL,
+                                 g_strdup(name),
+                                 g_strdup(name),
+                                 NULL,
+                                 attributes_setup_function_name,
+                                 FALSE,
+                                 FALSE,
+                                 FALSE);
+        names->benchmark = TRUE;
+        return names;
+    }
+
     return detect_cpp_test_function_symbol_names(name);
 }
 
@@ -872,16 +995,15 @@ collect_symbols_scan (CutLoaderPrivate *priv)
 }
 #endif
 
-gboolean
-cut_loader_support_attribute (CutLoader *loader)
+static gboolean
+binary_support_attribute (CutLoader *loader)
 {
     CutLoaderPrivate *priv;
 
     priv = CUT_LOADER_GET_PRIVATE(loader);
-    if (!priv->enable_convenience_attribute_definition)
-        return FALSE;
-
-    if (priv->elf_loader) {
+    if (priv->symbols_from_test_index) {
+        return priv->test_index_support_attribute;
+    } else if (priv->elf_loader) {
         return cut_elf_loader_support_attribute(priv->elf_loader);
     } else if (priv->mach_o_loader) {
         return cut_mach_o_loader_support_attribute(priv->mach_o_loader);
@@ -896,6 +1018,18 @@ cut_loader_support_attribute (CutLoader *loader)
     }
 }
 
+gboolean
+cut_loader_support_attribute (CutLoader *loader)
+{
+    CutLoaderPrivate *priv;
+
+    priv = CUT_LOADER_GET_PRIVATE(loader);
+    if (!priv->enable_convenience_attribute_definition)
+        return FALSE;
+
+    return binary_support_attribute(loader);
+}
+
 static GList *
 collect_symbols (CutLoaderPrivate *priv)
 {
@@ -931,93 +1065,190 @@ collect_test_functions (CutLoaderPrivate *priv)
 }
 
 static gboolean
-is_including_test_name (const gchar *function_name, SymbolNames *names)
+has_symbol (CutLoaderPrivate *priv, const gchar *name)
 {
-    gboolean included = FALSE;
-    GString *suffix;
-    gchar *base_name;
+    if (!priv->symbol_table) {
+        GList *node;
 
-    if (names->cpp) {
-        const gchar *target_namespace_end;
-        GString *target_namespace;
-        GString *test_namespace;
-        guint64 function_name_length;
-
-        target_namespace = g_string_new(NULL);
-        target_namespace_end = skip_cpp_namespace_gcc(function_name,
-                                                      target_namespace);
-        if (!target_namespace_end) {
-            g_string_free(target_namespace, TRUE);
-            return FALSE;
+        priv->symbol_table = g_hash_table_new(g_str_hash, g_str_equal);
+        for (node = priv->symbols; node; node = g_list_next(node)) {
+            g_hash_table_insert(priv->symbol_table, node->data, node->data);
         }
+    }
 
-        test_namespace = g_string_new(NULL);
-        skip_cpp_namespace_gcc(names->test_function_name, test_namespace);
-        included = g_str_equal(target_namespace->str, test_namespace->str);
-        g_string_free(target_namespace, TRUE);
-        g_string_free(test_namespace, TRUE);
-        if (!included)
-            return FALSE;
+    return g_hash_table_lookup(priv->symbol_table, name) != NULL;
+}
 
-        function_name_length = g_ascii_strtoull(target_namespace_end,
-                                                &base_name, 10);
-        if (function_name_length == 0)
-            return FALSE;
-    } else {
-        base_name = (gchar *)function_name;
-    }
+typedef struct _AttributeFunction AttributeFunction;
+struct _AttributeFunction
+{
+    const gchar *function_name;
+    gchar *name;
+};
+
+static void
+attribute_functions_free (GQueue *attribute_functions)
+{
+    GList *node;
 
-    suffix = g_string_new("_");
-    g_string_append(suffix, names->test_name + strlen(TEST_NAME_PREFIX));
-    if (names->cpp)
-        g_string_append(suffix, "Ev");
-    included = g_str_has_suffix(base_name, suffix->str);
-    g_string_free(suffix, TRUE);
+    for (node = attribute_functions->head; node; node = g_list_next(node)) {
+        AttributeFunction *attribute_function = node->data;
 
-    return included;
+        g_free(attribute_function->name);
+        g_free(attribute_function);
+    }
+    g_queue_free(attribute_functions);
 }
 
 static gboolean
-is_valid_attribute_function_name (const gchar *function_name, SymbolNames *names)
+is_attribute_function_base_name (const gchar *base_name)
 {
-    gchar *base_name;
+    return
+        !g_str_has_prefix(base_name, TEST_NAME_PREFIX) &&
+        !g_str_has_prefix(base_name, BENCHMARK_NAME_PREFIX) &&
+        !g_str_has_prefix(base_name, ATTRIBUTES_SETUP_FUNCTION_NAME_PREFIX) &&
+        !g_str_has_prefix(base_name, DATA_SETUP_FUNCTION_NAME_PREFIX);
+}
 
-    if (!function_name)
-        return FALSE;
+/*
+ * An attribute function is "ATTRIBUTE-NAME_TEST-BASE-NAME"
+ * (TEST-BASE-NAME is a test name without "test_" or
+ * "bench_"). We can't
+ * know where ATTRIBUTE-NAME ends, so the function is
+ * registered for all names after "_". Tests look up their
+ * attribute functions by TEST-BASE-NAME (prefixed by
+ * namespaces for C++) instead of matching all symbols for
+ * each test.
+ */
+static void
+register_attribute_function (GHashTable *table, const gchar *function_name,
+                             const gchar *namespaces,
+                             const gchar *base_name, gsize base_name_length)
+{
+    gsize i;
+
+    for (i = 0; i + 1 < base_name_length; i++) {
+        AttributeFunction *attribute_function;
+        GQueue *attribute_functions;
+        gchar *key;
+
+        if (base_name[i] != '_')
+            continue;
+
+        key = g_strdup_printf("%s%.*s",
+                              namespaces,
+                              (gint)(base_name_length - i - 1),
+                              base_name + i + 1);
+        attribute_functions = g_hash_table_lookup(table, key);
+        if (attribute_functions) {
+            g_free(key);
+        } else {
+            attribute_functions = g_queue_new();
+            g_hash_table_insert(table, key, attribute_functions);
+        }
 
-    if (names->cpp) {
-        if (!find_cpp_test_name_gcc(function_name, &base_name, NULL, NULL))
-            return FALSE;
-    } else {
-        base_name = (gchar *)function_name;
+        attribute_function = g_new0(AttributeFunction, 1);
+        attribute_function->function_name = function_name;
+        attribute_function->name = g_strndup(base_name, i);
+        g_queue_push_tail(attribute_functions, attribute_function);
     }
+}
 
-    return
-        !g_str_has_prefix(base_name, TEST_NAME_PREFIX) &&
-        !g_str_has_prefix(base_name,
-                          ATTRIBUTES_SETUP_FUNCTION_NAME_PREFIX) &&
-        !g_str_has_prefix(base_name, DATA_SETUP_FUNCTION_NAME_PREFIX) &&
-        is_including_test_name(function_name, names);
+static GHashTable *
+create_attribute_function_table (void)
+{
+    return g_hash_table_new_full(g_str_hash, g_str_equal,
+                                 g_free,
+                                 (GDestroyNotify)attribute_functions_free);
 }
 
-static gchar *
-get_attribute_name (const gchar *attribute_function_name, SymbolNames *names)
+static void
+build_attribute_function_tables (CutLoaderPrivate *priv)
+{
+    GList *node;
+    GString *namespaces;
+
+    priv->attribute_function_table = create_attribute_function_table();
+    priv->cpp_attribute_function_table = create_attribute_function_table();
+
+    namespaces = g_string_new(NULL);
+    for (node = priv->symbols; node; node = g_list_next(node)) {
+        const gchar *function_name = node->data;
+
+        if (is_gcc_cpp_symbol(function_name)) {
+            const gchar *namespace_end;
+            gchar *base_name;
+            guint64 base_name_length;
+
+            g_string_truncate(namespaces, 0);
+            namespace_end = skip_cpp_namespace_gcc(function_name, namespaces);
+            if (!namespace_end)
+                continue;
+            base_name_length = g_ascii_strtoull(namespace_end, &base_name, 10);
+            if (base_name_length == 0 ||
+                base_name_length > strlen(base_name) ||
+                !g_str_equal(base_name + base_name_length, "Ev"))
+                continue;
+            if (!is_attribute_function_base_name(base_name))
+                continue;
+            register_attribute_function(priv->cpp_attribute_function_table,
+                                        function_name,
+                                        namespaces->str,
+                                        base_name,
+                                        base_name_length);
+        } else {
+            if (!is_attribute_function_base_name(function_name))
+                continue;
+            register_attribute_function(priv->attribute_function_table,
+                                        function_name,
+                                        "",
+                                        function_name,
+                                        strlen(function_name));
+        }
+    }
+    g_string_free(namespaces, TRUE);
+}
+
+static GList *
+lookup_attribute_functions (CutLoaderPrivate *priv, SymbolNames *names)
 {
-    gchar *base_name;
-    gchar *test_base_name;
+    GQueue *attribute_functions = NULL;
+
+    if (!priv->attribute_function_table)
+        build_attribute_function_tables(priv);
 
     if (names->cpp) {
-        const gchar *namespace_end;
+        GString *key;
+        gchar *test_name_start;
+        guint64 test_name_length;
+        size_t test_name_prefix_length;
 
-        namespace_end = skip_cpp_namespace_gcc(attribute_function_name, NULL);
-        g_ascii_strtoull(namespace_end, &base_name, 10);
+        key = g_string_new(NULL);
+        if (find_cpp_test_name_gcc(names->test_function_name,
+                                   &test_name_start, &test_name_length,
+                                   key)) {
+            test_name_prefix_length = strlen(TEST_NAME_PREFIX);
+            g_string_append_len(key,
+                                test_name_start + test_name_prefix_length,
+                                test_name_length - test_name_prefix_length);
+            attribute_functions =
+                g_hash_table_lookup(priv->cpp_attribute_function_table,
+                                    key->str);
+        }
+        g_string_free(key, TRUE);
     } else {
-        base_name = (gchar *)attribute_function_name;
+        size_t test_name_prefix_length;
+
+        if (names->benchmark)
+            test_name_prefix_length = strlen(BENCHMARK_NAME_PREFIX);
+        else
+            test_name_prefix_length = strlen(TEST_NAME_PREFIX);
+        attribute_functions =
+            g_hash_table_lookup(priv->attribute_function_table,
+                                names->test_name + test_name_prefix_length);
     }
 
-    test_base_name = g_strrstr(base_name,
-                               names->test_name + strlen(TEST_NAME_PREFIX)) - 1;
-    return g_strndup(base_name, test_base_name - base_name);
+    return attribute_functions ? attribute_functions->head : NULL;
 }
 
 typedef const gchar *(*CutAttributeItemFunction)     (void);
@@ -1032,20 +1263,19 @@ apply_attributes (CutLoaderPrivate *priv, CutTest *test, SymbolNames *names)
     if (!names)
         return;
 
-    for (node = priv->symbols; node; node = g_list_next(node)) {
-        gchar *function_name = node->data;
-        if (is_valid_attribute_function_name(function_name, names)) {
-            CutAttributeItemFunction function = NULL;
-            g_module_symbol(priv->module, function_name, (gpointer)&function);
-            if (function) {
-                gchar *name;
-                const gchar *value;
-
-                name = get_attribute_name(function_name, names);
-                value = function();
-                cut_test_set_attribute(test, name, value);
-                g_free(name);
-            }
+    for (node = lookup_attribute_functions(priv, names);
+         node;
+         node = g_list_next(node)) {
+        AttributeFunction *attribute_function = node->data;
+        CutAttributeItemFunction function = NULL;
+
+        g_module_symbol(priv->module, attribute_function->function_name,
+                        (gpointer)&function);
+        if (function) {
+            const gchar *value;
+
+            value = function();
+            cut_test_set_attribute(test, attribute_function->name, value);
         }
     }
 }
@@ -1082,6 +1312,44 @@ create_test_iterator (CutLoaderPrivate *priv,
     }
 }
 
+static void
+copy_attribute (gpointer key, gpointer value, gpointer user_data)
+{
+    CutTest *test = user_data;
+
+    cut_test_set_attribute(test, key, value);
+}
+
+/*
+ * A "test_" function that has "benchmark" attribute is also
+ * a benchmark. Attributes are known only after the test is
+ * created, so the test is replaced with a benchmark here.
+ */
+static CutTest *
+convert_to_benchmark (CutLoaderPrivate *priv, CutTest *test)
+{
+    CutTest *benchmark;
+    CutTestFunction test_function = NULL;
+    const gchar *value;
+
+    if (CUT_IS_BENCHMARK(test) || CUT_IS_TEST_ITERATOR(test))
+        return test;
+
+    value = cut_test_get_attribute(test, "benchmark");
+    if (!value || g_ascii_strcasecmp(value, "false") == 0)
+        return test;
+
+    g_object_get(test, "test-function", &test_function, NULL);
+    benchmark = CUT_TEST(cut_benchmark_new(cut_test_get_name(test),
+                                           test_function));
+    cut_test_set_base_directory(benchmark, priv->base_directory);
+    g_hash_table_foreach(cut_test_get_attributes(test),
+                         copy_attribute, benchmark);
+    g_object_unref(test);
+
+    return benchmark;
+}
+
 static void
 register_valid_test (CutLoader *loader, CutTestCase *test_case,
                      SymbolNames *names)
@@ -1117,6 +1385,8 @@ register_valid_test (CutLoader *loader, CutTestCase *test_case,
                                  (CutIteratedTestFunction)test_function,
                                  data_setup_function);
         test = CUT_TEST(test_iterator);
+    } else if (names->benchmark) {
+        test = CUT_TEST(cut_benchmark_new(names->test_name, test_function));
     } else {
         test = create_test(priv, names->test_name, test_function);
     }
@@ -1141,6 +1411,7 @@ register_valid_test (CutLoader *loader, CutTestCase *test_case,
     if (cut_loader_support_attribute(loader))
         apply_attributes(priv, test, names);
 
+    test = convert_to_benchmark(priv, test);
     cut_test_case_add_test(test_case, test);
 
     g_object_unref(test);
@@ -1213,6 +1484,27 @@ cb_complete (CutTestCase *test_case, CutTestContext *test_context,
     g_object_unref(loader);
 }
 
+static gchar *
+compute_c_test_case_name (CutLoaderPrivate *priv)
+{
+    gchar *filename;
+    gchar *test_case_name;
+
+    filename = g_path_get_basename(priv->so_filename);
+    if (g_str_has_prefix(filename, "lib")) {
+        gchar *string;
+        string = g_strdup(filename + strlen("lib"));
+        g_free(filename);
+        filename = string;
+    }
+    test_case_name =
+        g_strndup(filename,
+                  strlen(filename) - strlen(G_MODULE_SUFFIX) -1);
+    g_free(filename);
+
+    return test_case_name;
+}
+
 static CutTestCase *
 create_test_case (CutLoader *loader, const gchar *namespace, gboolean gcc)
 {
@@ -1250,19 +1542,7 @@ create_test_case (CutLoader *loader, const gchar *namespace, gboolean gcc)
     if (namespace) {
         test_case_name = g_strdup(namespace);
     } else {
-        gchar *filename;
-
-        filename = g_path_get_basename(priv->so_filename);
-        if (g_str_has_prefix(filename, "lib")) {
-            gchar *string;
-            string = g_strdup(filename + strlen("lib"));
-            g_free(filename);
-            filename = string;
-        }
-        test_case_name =
-            g_strndup(filename,
-                      strlen(filename) - strlen(G_MODULE_SUFFIX) -1);
-        g_free(filename);
+        test_case_name = compute_c_test_case_name(priv);
     }
     test_case = cut_test_case_new(test_case_name,
                                   setup, teardown,
@@ -1293,26 +1573,12 @@ find_cpp_test_case (gconstpointer value1, gconstpointer value2)
     }
 }
 
-GList *
-cut_loader_load_test_cases (CutLoader *loader)
+static void
+collect_symbols_from_binary (CutLoader *loader)
 {
     CutLoaderPrivate *priv;
-    GList *node;
-    GList *test_names, *test_cases = NULL;
-    CutTestCase *c_test_case = NULL;
 
     priv = CUT_LOADER_GET_PRIVATE(loader);
-    if (!priv->so_filename)
-        return NULL;
-
-    cut_log_trace("[loader][test-cases][open] <%s>", priv->so_filename);
-    priv->module = g_module_open(priv->so_filename,
-                                 G_MODULE_BIND_LAZY | G_MODULE_BIND_LOCAL);
-    if (!priv->module) {
-        g_warning("can't load a shared object for test case: %s: %s",
-                  priv->so_filename, g_module_error());
-        return NULL;
-    }
 
     priv->elf_loader = cut_elf_loader_new(priv->so_filename);
     if (!cut_elf_loader_is_elf(priv->elf_loader)) {
@@ -1345,16 +1611,180 @@ cut_loader_load_test_cases (CutLoader *loader)
     cut_log_trace("[loader][test-cases][collect-symbols] <%d>:<%s>",
                   g_list_length(priv->symbols),
                   priv->so_filename);
-    if (!priv->symbols)
-        return NULL;
+}
+
+static void
+store_test_index (CutLoader *loader, GList *test_names)
+{
+    CutLoaderPrivate *priv;
+    gboolean all_symbols;
+
+    priv = CUT_LOADER_GET_PRIVATE(loader);
+    all_symbols = priv->enable_convenience_attribute_definition;
+    if (all_symbols) {
+        cut_test_index_store(priv->test_index, priv->so_filename, TRUE,
+                             priv->symbols, binary_support_attribute(loader));
+    } else {
+        GList *node, *test_function_names = NULL;
+
+        for (node = test_names; node; node = g_list_next(node)) {
+            SymbolNames *names = node->data;
+
+            test_function_names = g_list_prepend(test_function_names,
+                                                 names->test_function_name);
+            /* needed to know iterated tests before opening the module */
+            if (names->data_setup_function_name &&
+                has_symbol(priv, names->data_setup_function_name))
+                test_function_names =
+                    g_list_prepend(test_function_names,
+                                   names->data_setup_function_name);
+        }
+        cut_test_index_store(priv->test_index, priv->so_filename, FALSE,
+                             test_function_names,
+                             binary_support_attribute(loader));
+        g_list_free(test_function_names);
+    }
+}
+
+static gboolean
+may_be_test_iterator (CutLoaderPrivate *priv, SymbolNames *names)
+{
+    if (names->require_data_setup_function)
+        return TRUE;
 
-    test_names = collect_test_functions(priv);
+    return names->data_setup_function_name &&
+        has_symbol(priv, names->data_setup_function_name);
+}
+
+/*
+ * Tests are filtered again when they are run. This is only
+ * for not opening modules that have no test to be run. An
+ * iterated test is always a candidate because its data
+ * names are unknown until the module is opened.
+ */
+static gboolean
+has_target_test (CutLoaderPrivate *priv)
+{
+    GList *test_case_regexs = NULL, *test_regexs = NULL;
+    GList *node;
+    gchar *c_test_case_name = NULL;
+    gboolean found = FALSE;
+
+    if (priv->target_test_case_names)
+        test_case_regexs =
+            cut_utils_filter_to_regexs((const gchar **)priv->target_test_case_names);
+    if (priv->target_test_names)
+        test_regexs =
+            cut_utils_filter_to_regexs((const gchar **)priv->target_test_names);
+    if (!test_case_regexs && !test_regexs)
+        return priv->test_names != NULL;
+
+    for (node = priv->test_names; node && !found; node = g_list_next(node)) {
+        SymbolNames *names = node->data;
+
+        if (test_case_regexs) {
+            const gchar *test_case_name;
+
+            if (names->namespace) {
+                test_case_name = names->namespace;
+            } else {
+                if (!c_test_case_name)
+                    c_test_case_name = compute_c_test_case_name(priv);
+                test_case_name = c_test_case_name;
+            }
+            if (!cut_utils_filter_match(test_case_regexs, test_case_name))
+                continue;
+        }
+
+        if (test_regexs &&
+            !cut_utils_filter_match(test_regexs, names->test_name) &&
+            !may_be_test_iterator(priv, names))
+            continue;
+
+        found = TRUE;
+    }
+
+    g_free(c_test_case_name);
+    g_list_foreach(test_case_regexs, (GFunc)g_regex_unref, NULL);
+    g_list_free(test_case_regexs);
+    g_list_foreach(test_regexs, (GFunc)g_regex_unref, NULL);
+    g_list_free(test_regexs);
+
+    return found;
+}
+
+/*
+ * This doesn't open the module. It only reads the binary
+ * (or the test index), so it can be called for different
+ * loaders in parallel.
+ */
+void
+cut_loader_collect_test_functions (CutLoader *loader)
+{
+    CutLoaderPrivate *priv;
+
+    priv = CUT_LOADER_GET_PRIVATE(loader);
+    if (priv->test_functions_collected)
+        return;
+    priv->test_functions_collected = TRUE;
+
+    if (!priv->so_filename)
+        return;
+
+    if (priv->test_index &&
+        cut_test_index_lookup(priv->test_index, priv->so_filename,
+                              priv->enable_convenience_attribute_definition,
+                              &(priv->symbols),
+                              &(priv->test_index_support_attribute))) {
+        priv->symbols_from_test_index = TRUE;
+        cut_log_trace("[loader][test-cases][test-index][hit] <%d>:<%s>",
+                      g_list_length(priv->symbols),
+                      priv->so_filename);
+    } else {
+        collect_symbols_from_binary(loader);
+    }
+
+    priv->test_names = collect_test_functions(priv);
     cut_log_trace("[loader][test-cases][collect-test-functions] <%d>:<%s>",
-                  g_list_length(test_names),
+                  g_list_length(priv->test_names),
                   priv->so_filename);
-    if (!test_names)
+    if (priv->test_index && !priv->symbols_from_test_index)
+        store_test_index(loader, priv->test_names);
+
+    if (!has_target_test(priv)) {
+        cut_log_trace("[loader][test-cases][no-target-test] <%s>",
+                      priv->so_filename);
+        free_test_names(priv);
+    }
+}
+
+GList *
+cut_loader_load_test_cases (CutLoader *loader)
+{
+    CutLoaderPrivate *priv;
+    GList *node;
+    GList *test_names, *test_cases = NULL;
+    CutTestCase *c_test_case = NULL;
+
+    priv = CUT_LOADER_GET_PRIVATE(loader);
+    if (!priv->so_filename)
+        return NULL;
+
+    cut_loader_collect_test_functions(loader);
+    if (!priv->test_names)
+        return NULL;
+
+    cut_log_trace("[loader][test-cases][open] <%s>", priv->so_filename);
+    priv->module = g_module_open(priv->so_filename,
+                                 G_MODULE_BIND_LAZY | G_MODULE_BIND_LOCAL);
+    if (!priv->module) {
+        g_warning("can't load a shared object for test case: %s: %s",
+                  priv->so_filename, g_module_error());
         return NULL;
+    }
 
+    test_names = priv->test_names;
+    priv->test_names = NULL;
     for (node = test_names; node; node = g_list_next(node)) {
         SymbolNames *names = node->data;
         CutTestCase *test_case = NULL;
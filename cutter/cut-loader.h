@@ -25,6 +25,7 @@
 #include "cut-test.h"
 #include "cut-test-case.h"
 #include "cut-test-suite.h"
+#include "cut-test-index.h"
 
 G_BEGIN_DECLS
 
@@ -74,6 +75,19 @@ void          cut_loader_set_enable_convenience_attribute_definition
 const gchar  *cut_loader_get_base_directory(CutLoader *loader);
 void          cut_loader_set_base_directory(CutLoader *loader,
                                             const gchar *base_directory);
+CutTestIndex *cut_loader_get_test_index    (CutLoader *loader);
+void          cut_loader_set_test_index    (CutLoader *loader,
+                                            CutTestIndex *test_index);
+const gchar **cut_loader_get_target_test_case_names
+                                           (CutLoader *loader);
+void          cut_loader_set_target_test_case_names
+                                           (CutLoader *loader,
+                                            const gchar **names);
+const gchar **cut_loader_get_target_test_names
+                                           (CutLoader *loader);
+void          cut_loader_set_target_test_names
+                                           (CutLoader *loader,
+                                            const gchar **names);
 void          cut_loader_set_create_test_function
                                            (CutLoader *loader,
                                             CutCreateTestFunction create_test_function,
@@ -83,6 +97,8 @@ void          cut_loader_set_create_test_iterator_function
                                             CutCreateTestIteratorFunction
                                                        create_test_iterator_function,
                                             gpointer   user_data);
+void          cut_loader_collect_test_functions
+                                           (CutLoader *loader);
 GList        *cut_loader_load_test_cases   (CutLoader *loader);
 CutTestCase  *cut_loader_load_test_case    (CutLoader *loader);
 CutTestSuite *cut_loader_load_test_suite   (CutLoader *loader);
@@ -0,0 +1,358 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "cut-log-index.h"
+#include "cut-logger.h"
+
+#define KEY_SIZE            "size"
+#define KEY_MTIME           "mtime"
+#define KEY_SUCCESS         "success"
+#define KEY_ELAPSED         "elapsed"
+#define KEY_N_TESTS         "n-tests"
+#define KEY_N_ASSERTIONS    "n-assertions"
+#define KEY_N_FAILURES      "n-failures"
+#define KEY_N_ERRORS        "n-errors"
+#define KEY_N_PENDINGS      "n-pendings"
+#define KEY_N_NOTIFICATIONS "n-notifications"
+#define KEY_N_OMISSIONS     "n-omissions"
+#define KEY_TEST_CASE_NAMES "test-case-names"
+#define KEY_TEST_NAMES      "test-names"
+#define KEY_TEST_STATUSES   "test-statuses"
+#define KEY_TEST_ELAPSED    "test-elapsed"
+
+struct _CutLogIndex
+{
+    gchar *log_directory;
+    gchar *file_name;
+    GKeyFile *key_file;
+    gboolean modified;
+};
+
+typedef struct _LogStamp LogStamp;
+struct _LogStamp
+{
+    gchar *size;
+    gchar *mtime;
+};
+
+CutLogIndex *
+cut_log_index_new (const gchar *log_directory)
+{
+    CutLogIndex *index;
+
+    index = g_new0(CutLogIndex, 1);
+    index->log_directory = g_strdup(log_directory);
+    index->file_name = g_build_filename(log_directory,
+                                        CUT_LOG_INDEX_FILE_NAME,
+                                        NULL);
+    index->key_file = g_key_file_new();
+    index->modified = FALSE;
+
+    return index;
+}
+
+void
+cut_log_index_free (CutLogIndex *index)
+{
+    g_free(index->log_directory);
+    g_free(index->file_name);
+    g_key_file_free(index->key_file);
+    g_free(index);
+}
+
+const gchar *
+cut_log_index_get_file_name (CutLogIndex *index)
+{
+    return index->file_name;
+}
+
+gboolean
+cut_log_index_load (CutLogIndex *index, GError **error)
+{
+    GError *local_error = NULL;
+
+    if (!g_file_test(index->file_name, G_FILE_TEST_EXISTS))
+        return TRUE;
+
+    if (!g_key_file_load_from_file(index->key_file, index->file_name,
+                                   G_KEY_FILE_NONE, &local_error)) {
+        g_key_file_free(index->key_file);
+        index->key_file = g_key_file_new();
+        g_propagate_error(error, local_error);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void
+remove_vanished_logs (CutLogIndex *index)
+{
+    gchar **groups, **group;
+
+    groups = g_key_file_get_groups(index->key_file, NULL);
+    for (group = groups; *group; group++) {
+        gchar *log_file_name;
+        gboolean exist;
+
+        log_file_name = g_build_filename(index->log_directory, *group, NULL);
+        exist = g_file_test(log_file_name, G_FILE_TEST_EXISTS);
+        g_free(log_file_name);
+        if (exist)
+            continue;
+        g_key_file_remove_group(index->key_file, *group, NULL);
+        index->modified = TRUE;
+    }
+    g_strfreev(groups);
+}
+
+gboolean
+cut_log_index_save (CutLogIndex *index, GError **error)
+{
+    gchar *data;
+    gsize length;
+    gboolean success;
+
+    remove_vanished_logs(index);
+    if (!index->modified)
+        return TRUE;
+
+    data = g_key_file_to_data(index->key_file, &length, NULL);
+    success = g_file_set_contents(index->file_name, data, length, error);
+    g_free(data);
+    if (success)
+        index->modified = FALSE;
+
+    return success;
+}
+
+static gboolean
+log_stamp_init (LogStamp *stamp, CutLogIndex *index, const gchar *log_name)
+{
+    struct stat buffer;
+    gchar *log_file_name;
+    gint result;
+
+    log_file_name = g_build_filename(index->log_directory, log_name, NULL);
+    result = g_stat(log_file_name, &buffer);
+    g_free(log_file_name);
+    if (result != 0)
+        return FALSE;
+
+    stamp->size = g_strdup_printf("%" G_GUINT64_FORMAT,
+                                  (guint64)buffer.st_size);
+    stamp->mtime = g_strdup_printf("%" G_GINT64_FORMAT,
+                                   (gint64)buffer.st_mtime);
+
+    return TRUE;
+}
+
+static void
+log_stamp_clear (LogStamp *stamp)
+{
+    g_free(stamp->size);
+    g_free(stamp->mtime);
+}
+
+static gboolean
+is_same_string (GKeyFile *key_file, const gchar *group, const gchar *key,
+                const gchar *expected)
+{
+    gchar *actual;
+    gboolean same;
+
+    actual = g_key_file_get_string(key_file, group, key, NULL);
+    same = actual && g_str_equal(actual, expected);
+    g_free(actual);
+
+    return same;
+}
+
+static guint
+get_uint (GKeyFile *key_file, const gchar *group, const gchar *key)
+{
+    return MAX(g_key_file_get_integer(key_file, group, key, NULL), 0);
+}
+
+static CutRunSummary *
+load_summary (GKeyFile *key_file, const gchar *group)
+{
+    CutRunSummary *summary = NULL;
+    gchar **test_case_names, **test_names;
+    gint *statuses;
+    gdouble *elapsed_times;
+    gsize n_test_case_names = 0, n_test_names = 0;
+    gsize n_statuses = 0, n_elapsed_times = 0;
+
+    test_case_names = g_key_file_get_string_list(key_file, group,
+                                                 KEY_TEST_CASE_NAMES,
+                                                 &n_test_case_names, NULL);
+    test_names = g_key_file_get_string_list(key_file, group,
+                                            KEY_TEST_NAMES,
+                                            &n_test_names, NULL);
+    statuses = g_key_file_get_integer_list(key_file, group,
+                                           KEY_TEST_STATUSES,
+                                           &n_statuses, NULL);
+    elapsed_times = g_key_file_get_double_list(key_file, group,
+                                               KEY_TEST_ELAPSED,
+                                               &n_elapsed_times, NULL);
+    if (n_test_case_names == n_test_names &&
+        n_test_names == n_statuses &&
+        n_statuses == n_elapsed_times) {
+        gsize i;
+
+        summary = cut_run_summary_new(group);
+        summary->success =
+            g_key_file_get_boolean(key_file, group, KEY_SUCCESS, NULL);
+        summary->elapsed =
+            g_key_file_get_double(key_file, group, KEY_ELAPSED, NULL);
+        summary->n_tests = get_uint(key_file, group, KEY_N_TESTS);
+        summary->n_assertions = get_uint(key_file, group, KEY_N_ASSERTIONS);
+        summary->n_failures = get_uint(key_file, group, KEY_N_FAILURES);
+        summary->n_errors = get_uint(key_file, group, KEY_N_ERRORS);
+        summary->n_pendings = get_uint(key_file, group, KEY_N_PENDINGS);
+        summary->n_notifications =
+            get_uint(key_file, group, KEY_N_NOTIFICATIONS);
+        summary->n_omissions = get_uint(key_file, group, KEY_N_OMISSIONS);
+        for (i = 0; i < n_test_names; i++) {
+            const gchar *test_case_name = test_case_names[i];
+
+            if (test_case_name[0] == '\0')
+                test_case_name = NULL;
+            cut_run_summary_add_test(summary, test_case_name, test_names[i],
+                                     statuses[i], elapsed_times[i]);
+        }
+    }
+
+    g_strfreev(test_case_names);
+    g_strfreev(test_names);
+    g_free(statuses);
+    g_free(elapsed_times);
+
+    return summary;
+}
+
+CutRunSummary *
+cut_log_index_lookup (CutLogIndex *index, const gchar *log_name)
+{
+    LogStamp stamp;
+    CutRunSummary *summary = NULL;
+
+    if (!g_key_file_has_group(index->key_file, log_name))
+        return NULL;
+
+    if (!log_stamp_init(&stamp, index, log_name))
+        return NULL;
+
+    if (is_same_string(index->key_file, log_name, KEY_SIZE, stamp.size) &&
+        is_same_string(index->key_file, log_name, KEY_MTIME, stamp.mtime))
+        summary = load_summary(index->key_file, log_name);
+
+    cut_log_trace("[log-index][lookup][%s] <%s>",
+                  summary ? "hit" : "miss", log_name);
+
+    log_stamp_clear(&stamp);
+
+    return summary;
+}
+
+void
+cut_log_index_store (CutLogIndex *index, CutRunSummary *summary)
+{
+    GKeyFile *key_file;
+    const gchar *group;
+    LogStamp stamp;
+    const gchar **test_case_names, **test_names;
+    gint *statuses;
+    gdouble *elapsed_times;
+    guint i, n_tests;
+
+    group = summary->log_name;
+    if (strpbrk(group, "[]\n\r"))
+        return;
+
+    if (!log_stamp_init(&stamp, index, group))
+        return;
+
+    n_tests = summary->tests->len;
+    test_case_names = g_new(const gchar *, n_tests + 1);
+    test_names = g_new(const gchar *, n_tests + 1);
+    statuses = g_new(gint, n_tests + 1);
+    elapsed_times = g_new(gdouble, n_tests + 1);
+    for (i = 0; i < n_tests; i++) {
+        CutTestSummary *test = g_ptr_array_index(summary->tests, i);
+
+        test_case_names[i] = test->test_case_name ? test->test_case_name : "";
+        test_names[i] = test->test_name ? test->test_name : "";
+        statuses[i] = test->status;
+        elapsed_times[i] = test->elapsed;
+    }
+    test_case_names[n_tests] = NULL;
+    test_names[n_tests] = NULL;
+
+    key_file = index->key_file;
+    g_key_file_remove_group(key_file, group, NULL);
+    g_key_file_set_string(key_file, group, KEY_SIZE, stamp.size);
+    g_key_file_set_string(key_file, group, KEY_MTIME, stamp.mtime);
+    g_key_file_set_boolean(key_file, group, KEY_SUCCESS, summary->success);
+    g_key_file_set_double(key_file, group, KEY_ELAPSED, summary->elapsed);
+    g_key_file_set_integer(key_file, group, KEY_N_TESTS, summary->n_tests);
+    g_key_file_set_integer(key_file, group, KEY_N_ASSERTIONS,
+                           summary->n_assertions);
+    g_key_file_set_integer(key_file, group, KEY_N_FAILURES,
+                           summary->n_failures);
+    g_key_file_set_integer(key_file, group, KEY_N_ERRORS, summary->n_errors);
+    g_key_file_set_integer(key_file, group, KEY_N_PENDINGS,
+                           summary->n_pendings);
+    g_key_file_set_integer(key_file, group, KEY_N_NOTIFICATIONS,
+                           summary->n_notifications);
+    g_key_file_set_integer(key_file, group, KEY_N_OMISSIONS,
+                           summary->n_omissions);
+    g_key_file_set_string_list(key_file, group, KEY_TEST_CASE_NAMES,
+                               test_case_names, n_tests);
+    g_key_file_set_string_list(key_file, group, KEY_TEST_NAMES,
+                               test_names, n_tests);
+    g_key_file_set_integer_list(key_file, group, KEY_TEST_STATUSES,
+                                statuses, n_tests);
+    g_key_file_set_double_list(key_file, group, KEY_TEST_ELAPSED,
+                               elapsed_times, n_tests);
+    index->modified = TRUE;
+
+    cut_log_trace("[log-index][store] <%s>:<%u>", group, n_tests);
+
+    g_free(test_case_names);
+    g_free(test_names);
+    g_free(statuses);
+    g_free(elapsed_times);
+    log_stamp_clear(&stamp);
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
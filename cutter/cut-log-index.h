@@ -0,0 +1,61 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CUT_LOG_INDEX_H__
+#define __CUT_LOG_INDEX_H__
+
+#include <glib.h>
+
+#include <cutter/cut-run-summary.h>
+
+G_BEGIN_DECLS
+
+/*
+ * CutLogIndex is an on-disk cache of CutRunSummary for XML
+ * logs in a log directory. It is stored in the log
+ * directory. An entry is valid while the log has the same
+ * size and mtime.
+ */
+
+#define CUT_LOG_INDEX_FILE_NAME "summary-index"
+
+typedef struct _CutLogIndex CutLogIndex;
+
+CutLogIndex   *cut_log_index_new    (const gchar   *log_directory);
+void           cut_log_index_free   (CutLogIndex   *index);
+
+const gchar   *cut_log_index_get_file_name
+                                    (CutLogIndex   *index);
+gboolean       cut_log_index_load   (CutLogIndex   *index,
+                                     GError       **error);
+gboolean       cut_log_index_save   (CutLogIndex   *index,
+                                     GError       **error);
+
+CutRunSummary *cut_log_index_lookup (CutLogIndex   *index,
+                                     const gchar   *log_name);
+void           cut_log_index_store  (CutLogIndex   *index,
+                                     CutRunSummary *summary);
+
+G_END_DECLS
+
+#endif /* __CUT_LOG_INDEX_H__ */
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
@@ -32,6 +32,7 @@
 #include <glib/gstdio.h>
 
 #include "cut-mach-o-loader.h"
+#include "cut-glib-compatible.h"
 
 #define CUT_MACH_O_LOADER_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE((obj), CUT_TYPE_MACH_O_LOADER, CutMachOLoaderPrivate))
 
@@ -45,7 +46,8 @@ typedef struct _CutMachOLoaderPrivate	CutMachOLoaderPrivate;
 struct _CutMachOLoaderPrivate
 {
     gchar *so_filename;
-    gchar *content;
+    GMappedFile *mapped_file;
+    const gchar *content;
     gsize length;
     ArchitectureBit bit;
 };
@@ -68,6 +70,42 @@ static void get_property    (GObject               *object,
                              GValue                *value,
                              GParamSpec            *pspec);
 
+#ifdef HAVE_MACH_O_LOADER_H
+static gboolean
+map_file (CutMachOLoaderPrivate *priv)
+{
+    GError *error = NULL;
+
+    priv->mapped_file = g_mapped_file_new(priv->so_filename, FALSE, &error);
+    if (!priv->mapped_file) {
+        g_warning("can't read shared library file: %s", error->message);
+        g_error_free(error);
+        return FALSE;
+    }
+    priv->content = g_mapped_file_get_contents(priv->mapped_file);
+    priv->length = g_mapped_file_get_length(priv->mapped_file);
+
+    return TRUE;
+}
+
+static gboolean
+is_valid_range (CutMachOLoaderPrivate *priv, guint64 offset, guint64 size)
+{
+    return offset <= priv->length && size <= priv->length - offset;
+}
+#endif
+
+static void
+unmap_file (CutMachOLoaderPrivate *priv)
+{
+    if (priv->mapped_file) {
+        g_mapped_file_unref(priv->mapped_file);
+        priv->mapped_file = NULL;
+    }
+    priv->content = NULL;
+    priv->length = 0;
+}
+
 static void
 cut_mach_o_loader_class_init (CutMachOLoaderClass *klass)
 {
@@ -96,6 +134,7 @@ cut_mach_o_loader_init (CutMachOLoader *loader)
     CutMachOLoaderPrivate *priv = CUT_MACH_O_LOADER_GET_PRIVATE(loader);
 
     priv->so_filename = NULL;
+    priv->mapped_file = NULL;
     priv->content = NULL;
     priv->length = 0;
     priv->bit = ARCHITECTURE_UNKNOWN;
@@ -111,10 +150,7 @@ dispose (GObject *object)
         priv->so_filename = NULL;
     }
 
-    if (priv->content) {
-        g_free(priv->content);
-        priv->content = NULL;
-    }
+    unmap_file(priv);
 
     G_OBJECT_CLASS(cut_mach_o_loader_parent_class)->dispose(object);
 }
@@ -170,30 +206,31 @@ cut_mach_o_loader_is_mach_o (CutMachOLoader *loader)
 {
 #ifdef HAVE_MACH_O_LOADER_H
     CutMachOLoaderPrivate *priv;
-    GError *error = NULL;
     uint32_t magic = 0;
 
     priv = CUT_MACH_O_LOADER_GET_PRIVATE(loader);
-    if (!g_file_get_contents(priv->so_filename, &priv->content, &priv->length,
-                             &error)) {
-        g_warning("can't read shared library file: %s", error->message);
-        g_error_free(error);
+    unmap_file(priv);
+    if (!map_file(priv))
         return FALSE;
-    }
 
     if (priv->length >= sizeof(magic))
         memcpy(&magic, priv->content, sizeof(magic));
 
     switch (magic) {
     case MH_MAGIC:
-        priv->bit = ARCHITECTURE_32BIT;
+        if (priv->length >= sizeof(struct mach_header))
+            priv->bit = ARCHITECTURE_32BIT;
+        else
+            unmap_file(priv);
         break;
     case MH_MAGIC_64:
-        priv->bit = ARCHITECTURE_64BIT;
+        if (priv->length >= sizeof(struct mach_header_64))
+            priv->bit = ARCHITECTURE_64BIT;
+        else
+            unmap_file(priv);
         break;
     default:
-        g_free(priv->content);
-        priv->content = NULL;
+        unmap_file(priv);
         break;
     }
 
@@ -218,20 +255,25 @@ static void
 update_section_index (CutMachOLoaderPrivate *priv, gsize offset,
                       uint32_t *section_index, uint32_t *text_section_index)
 {
-    struct segment_command *segment;
-    struct segment_command_64 *segment_64;
+    const struct segment_command *segment;
+    const struct segment_command_64 *segment_64;
     gint j;
     const gchar *segment_name;
     uint32_t n_sections;
-    struct section *section = NULL;
-    struct section_64 *section_64 = NULL;
+    const struct section *section = NULL;
+    const struct section_64 *section_64 = NULL;
 
     if (priv->bit == ARCHITECTURE_32BIT) {
-        segment = (struct segment_command *)(priv->content + offset);
+        if (!is_valid_range(priv, offset, sizeof(*segment)))
+            return;
+        segment = (const struct segment_command *)(priv->content + offset);
         segment_name = segment->segname;
         n_sections = segment->nsects;
     } else {
-        segment_64 = (struct segment_command_64 *)(priv->content + offset);
+        if (!is_valid_range(priv, offset, sizeof(*segment_64)))
+            return;
+        segment_64 =
+            (const struct segment_command_64 *)(priv->content + offset);
         segment_name = segment_64->segname;
         n_sections = segment_64->nsects;
     }
@@ -242,10 +284,17 @@ update_section_index (CutMachOLoaderPrivate *priv, gsize offset,
     }
 
     if (priv->bit == ARCHITECTURE_32BIT) {
-        section = (struct section *)(priv->content + offset + sizeof(*segment));
+        if (!is_valid_range(priv, offset + sizeof(*segment),
+                            (guint64)sizeof(*section) * n_sections))
+            return;
+        section = (const struct section *)(priv->content + offset +
+                                           sizeof(*segment));
     } else {
-        section_64 =
-            (struct section_64 *)(priv->content + offset + sizeof(*segment_64));
+        if (!is_valid_range(priv, offset + sizeof(*segment_64),
+                            (guint64)sizeof(*section_64) * n_sections))
+            return;
+        section_64 = (const struct section_64 *)(priv->content + offset +
+                                                 sizeof(*segment_64));
     }
 
     for (j = 0; j < n_sections; j++) {
@@ -269,20 +318,30 @@ static void
 update_symbols (CutMachOLoaderPrivate *priv, gsize offset,
                 uint32_t text_section_index, GList **symbols)
 {
-    struct symtab_command *table;
-    struct nlist *symbol = NULL;
-    struct nlist_64 *symbol_64 = NULL;
-    gchar *string_table;
+    const struct symtab_command *table;
+    const struct nlist *symbol = NULL;
+    const struct nlist_64 *symbol_64 = NULL;
+    const gchar *string_table;
     gint j;
 
     if (text_section_index == 0)
         return;
 
-    table = (struct symtab_command *)(priv->content + offset);
+    if (!is_valid_range(priv, offset, sizeof(*table)))
+        return;
+    table = (const struct symtab_command *)(priv->content + offset);
+    if (!is_valid_range(priv, table->stroff, table->strsize))
+        return;
     if (priv->bit == ARCHITECTURE_32BIT) {
-        symbol = (struct nlist *)(priv->content + table->symoff);
+        if (!is_valid_range(priv, table->symoff,
+                            (guint64)sizeof(*symbol) * table->nsyms))
+            return;
+        symbol = (const struct nlist *)(priv->content + table->symoff);
     } else {
-        symbol_64 = (struct nlist_64 *)(priv->content + table->symoff);
+        if (!is_valid_range(priv, table->symoff,
+                            (guint64)sizeof(*symbol_64) * table->nsyms))
+            return;
+        symbol_64 = (const struct nlist_64 *)(priv->content + table->symoff);
     }
     string_table = priv->content + table->stroff;
     for (j = 0; j < table->nsyms; j++) {
@@ -308,9 +367,13 @@ update_symbols (CutMachOLoaderPrivate *priv, gsize offset,
         if (defined_in_section &&
             defined_section_index == text_section_index &&
             type & N_EXT) {
-            gchar *name;
+            const gchar *name;
 
+            if (string_offset <= 0 || (uint32_t)string_offset >= table->strsize)
+                continue;
             name = string_table + string_offset;
+            if (!memchr(name, '\0', table->strsize - string_offset))
+                continue;
             *symbols = g_list_prepend(*symbols, g_strdup(name + 1));
         }
     }
@@ -324,26 +387,30 @@ cut_mach_o_loader_collect_symbols (CutMachOLoader *loader)
     CutMachOLoaderPrivate *priv;
     GList *symbols = NULL;
     gsize offset = 0;
-    struct mach_header *header = NULL;
-    struct mach_header_64 *header_64 = NULL;
+    const struct mach_header *header = NULL;
+    const struct mach_header_64 *header_64 = NULL;
     uint32_t i, n_commands;
     uint32_t section_index = 0, text_section_index = 0;
 
     priv = CUT_MACH_O_LOADER_GET_PRIVATE(loader);
+    if (!priv->content)
+        return NULL;
     if (priv->bit == ARCHITECTURE_32BIT) {
-        header = (struct mach_header *)priv->content;
+        header = (const struct mach_header *)priv->content;
         offset += sizeof(*header);
         n_commands = header->ncmds;
     } else {
-        header_64 = (struct mach_header_64 *)priv->content;
+        header_64 = (const struct mach_header_64 *)priv->content;
         offset += sizeof(*header_64);
         n_commands = header_64->ncmds;
     }
 
     for (i = 0; i < n_commands; i++) {
-        struct load_command *load;
+        const struct load_command *load;
 
-        load = (struct load_command *)(priv->content + offset);
+        if (!is_valid_range(priv, offset, sizeof(*load)))
+            break;
+        load = (const struct load_command *)(priv->content + offset);
         switch (load->cmd) {
         case LC_SEGMENT:
         case LC_SEGMENT_64:
@@ -356,6 +423,8 @@ cut_mach_o_loader_collect_symbols (CutMachOLoader *loader)
         default:
             break;
         }
+        if (load->cmdsize == 0)
+            break;
         offset += load->cmdsize;
     }
 
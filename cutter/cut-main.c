@@ -75,15 +75,29 @@ static gboolean initialized = FALSE;
 static RunMode mode = MODE_TEST;
 static gchar *test_directory = NULL;
 static gchar *log_directory = NULL;
+static gchar *shard_log = NULL;
 static gchar *log_file = NULL;
+static gchar *test_index_file = NULL;
 static gchar *source_directory = NULL;
 static gchar **test_case_names = NULL;
 static gchar **test_names = NULL;
 static gchar **exclude_files = NULL;
 static gchar **exclude_directories = NULL;
 static CutOrder test_case_order = CUT_ORDER_NONE_SPECIFIED;
+static CutKeepResults keep_results = CUT_KEEP_RESULTS_ALL;
+static CutElapsedRegression elapsed_regression = CUT_ELAPSED_REGRESSION_NONE;
+static gdouble elapsed_regression_threshold =
+    CUT_ELAPSED_REGRESSION_THRESHOLD_DEFAULT;
+static gchar **benchmark_filter = NULL;
+static gdouble benchmark_min_time = CUT_BENCHMARK_MIN_TIME_DEFAULT;
+static gboolean measure_resource_usage = FALSE;
+static gboolean measure_phases = FALSE;
+static gboolean full_memory_dump = FALSE;
 static gboolean use_multi_thread = FALSE;
 static gint max_threads = 10;
+static gint n_processes = 0;
+static gint shard_index = 0;
+static gint shard_count = 0;
 static gboolean disable_signal_handling = FALSE;
 static GList *listener_factories = NULL;
 static GList *loader_customizer_factories = NULL;
@@ -160,6 +174,8 @@ parse_test_case_order (const gchar *option_name, const gchar *value,
         test_case_order = CUT_ORDER_NAME_ASCENDING;
     } else if (g_utf8_collate(value, "name-desc") == 0) {
         test_case_order = CUT_ORDER_NAME_DESCENDING;
+    } else if (g_utf8_collate(value, "elapsed") == 0) {
+        test_case_order = CUT_ORDER_ELAPSED_DESCENDING;
     } else {
         g_set_error(error,
                     G_OPTION_ERROR,
@@ -171,6 +187,75 @@ parse_test_case_order (const gchar *option_name, const gchar *value,
     return TRUE;
 }
 
+static gboolean
+parse_keep_results (const gchar *option_name, const gchar *value,
+                    gpointer data, GError **error)
+{
+    if (g_utf8_collate(value, "all") == 0) {
+        keep_results = CUT_KEEP_RESULTS_ALL;
+    } else if (g_utf8_collate(value, "failures") == 0) {
+        keep_results = CUT_KEEP_RESULTS_FAILURES;
+    } else if (g_utf8_collate(value, "none") == 0) {
+        keep_results = CUT_KEEP_RESULTS_NONE;
+    } else {
+        g_set_error(error,
+                    G_OPTION_ERROR,
+                    G_OPTION_ERROR_BAD_VALUE,
+                    _("Invalid keep results value: %s"), value);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static gboolean
+parse_elapsed_regression (const gchar *option_name, const gchar *value,
+                          gpointer data, GError **error)
+{
+    if (g_utf8_collate(value, "none") == 0) {
+        elapsed_regression = CUT_ELAPSED_REGRESSION_NONE;
+    } else if (g_utf8_collate(value, "notification") == 0) {
+        elapsed_regression = CUT_ELAPSED_REGRESSION_NOTIFICATION;
+    } else if (g_utf8_collate(value, "failure") == 0) {
+        elapsed_regression = CUT_ELAPSED_REGRESSION_FAILURE;
+    } else {
+        g_set_error(error,
+                    G_OPTION_ERROR,
+                    G_OPTION_ERROR_BAD_VALUE,
+                    _("Invalid elapsed regression value: %s"), value);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static gboolean
+parse_shard (const gchar *option_name, const gchar *value,
+             gpointer data, GError **error)
+{
+    gchar *end;
+    guint64 index, count;
+
+    index = g_ascii_strtoull(value, &end, 10);
+    if (end != value && end[0] == '/') {
+        const gchar *count_value = end + 1;
+
+        count = g_ascii_strtoull(count_value, &end, 10);
+        if (end != count_value && end[0] == '\0' &&
+            count > 0 && count <= G_MAXINT32 && index < count) {
+            shard_index = index;
+            shard_count = count;
+            return TRUE;
+        }
+    }
+
+    g_set_error(error,
+                G_OPTION_ERROR,
+                G_OPTION_ERROR_BAD_VALUE,
+                _("Invalid shard value: %s"), value);
+    return FALSE;
+}
+
 static const GOptionEntry option_entries[] =
 {
     {"version", 0, G_OPTION_FLAG_NO_ARG, G_OPTION_ARG_CALLBACK, print_version,
@@ -195,15 +280,69 @@ static const GOptionEntry option_entries[] =
         "concurrently at a maximum "
         "(default: 10; -1 is no limit)"),
      "MAX_THREADS"},
+    {"multi-process", 0, 0, G_OPTION_ARG_INT, &n_processes,
+     N_("Run test cases in N_PROCESSES forked worker processes "
+        "(default: 0; 0 or 1 is disabled)"),
+     "N_PROCESSES"},
+    {"shard", 0, 0, G_OPTION_ARG_CALLBACK, parse_shard,
+     N_("Run only test cases in the INDEX-th (0 origin) of COUNT shards"),
+     "INDEX/COUNT"},
+    {"shard-log", 0, 0, G_OPTION_ARG_STRING, &shard_log,
+     N_("Partition test cases for --shard by elapsed time in FILE"),
+     "FILE"},
     {"disable-signal-handling", 0, 0, G_OPTION_ARG_NONE,
      &disable_signal_handling,
      N_("Disable signal handling"), NULL},
     {"test-case-order", 0, 0, G_OPTION_ARG_CALLBACK, parse_test_case_order,
-     N_("Sort test case by. Default is 'none'."), "[none|name|name-desc]"},
+     N_("Sort test case by. Default is 'none'."),
+     "[none|name|name-desc|elapsed]"},
+    {"log-directory", 0, 0, G_OPTION_ARG_STRING, &log_directory,
+     N_("Read logs of previous runs in DIRECTORY for "
+        "--test-case-order=elapsed"), "DIRECTORY"},
     {"exclude-file", 0, 0, G_OPTION_ARG_STRING_ARRAY, &exclude_files,
      N_("Skip files"), "FILE"},
     {"exclude-directory", 0, 0, G_OPTION_ARG_STRING_ARRAY, &exclude_directories,
      N_("Skip directories"), "DIRECTORY"},
+    {"test-index", 0, 0, G_OPTION_ARG_STRING, &test_index_file,
+     N_("Cache symbols of test modules in FILE to skip scanning "
+        "unchanged modules"), "FILE"},
+    {"keep-results", 0, 0, G_OPTION_ARG_CALLBACK, parse_keep_results,
+     N_("Keep results of tests until the end of run. "
+        "'failures' releases results of succeeded tests after they are "
+        "reported. 'none' releases all results after they are reported. "
+        "Default is 'all'."),
+     "[all|failures|none]"},
+    {"elapsed-regression", 0, 0, G_OPTION_ARG_CALLBACK,
+     parse_elapsed_regression,
+     N_("Report tests that are significantly slower than in previous runs "
+        "in --log-directory. Default is 'none'."),
+     "[none|notification|failure]"},
+    {"elapsed-regression-threshold", 0, 0, G_OPTION_ARG_DOUBLE,
+     &elapsed_regression_threshold,
+     N_("Report a test as slow when it is slower than the median of "
+        "previous runs by more than THRESHOLD times the scaled MAD "
+        "(default: 5.0)"),
+     "THRESHOLD"},
+    {"benchmark-filter", 0, 0, G_OPTION_ARG_STRING_ARRAY, &benchmark_filter,
+     N_("Measure benchmarks whose name is NAME. "
+        "Other benchmarks are run only once as tests."),
+     "NAME"},
+    {"benchmark-min-time", 0, 0, G_OPTION_ARG_DOUBLE, &benchmark_min_time,
+     N_("Run a measured benchmark for SECONDS at least (default: 1.0)"),
+     "SECONDS"},
+    {"measure-resource-usage", 0, 0, G_OPTION_ARG_NONE,
+     &measure_resource_usage,
+     N_("Measure CPU time, memory, page faults and context switches "
+        "used by each test"),
+     NULL},
+    {"measure-phases", 0, 0, G_OPTION_ARG_NONE, &measure_phases,
+     N_("Measure elapsed time of startup, shutdown, data setup, setup, "
+        "test and teardown separately"),
+     NULL},
+    {"full-memory-dump", 0, 0, G_OPTION_ARG_NONE, &full_memory_dump,
+     N_("Show whole memories instead of differences on memory "
+        "assertion failures"),
+     NULL},
     {"fatal-failures", 0, 0, G_OPTION_ARG_NONE, &fatal_failures,
      N_("Treat failures as fatal problem"), NULL},
     {"keep-opening-modules", 0, 0, G_OPTION_ARG_NONE, &keep_opening_modules,
@@ -454,10 +593,14 @@ cut_setup_run_context (CutRunContext *run_context)
 {
     cut_run_context_set_test_directory(run_context, test_directory);
     cut_run_context_set_log_directory(run_context, log_directory);
+    cut_run_context_set_test_index_file(run_context, test_index_file);
     if (source_directory)
         cut_run_context_set_source_directory(run_context, source_directory);
     cut_run_context_set_multi_thread(run_context, use_multi_thread);
     cut_run_context_set_max_threads(run_context, max_threads);
+    cut_run_context_set_n_processes(run_context, n_processes);
+    cut_run_context_set_shard(run_context, shard_index, shard_count);
+    cut_run_context_set_shard_log(run_context, shard_log);
     cut_run_context_set_handle_signals(run_context, !disable_signal_handling);
     cut_run_context_set_exclude_files(run_context,
                                       (const gchar **)exclude_files);
@@ -468,6 +611,17 @@ cut_setup_run_context (CutRunContext *run_context)
     cut_run_context_set_target_test_names(run_context,
                                           (const gchar **)test_names);
     cut_run_context_set_test_case_order(run_context, test_case_order);
+    cut_run_context_set_keep_results(run_context, keep_results);
+    cut_run_context_set_elapsed_regression(run_context, elapsed_regression);
+    cut_run_context_set_elapsed_regression_threshold(run_context,
+                                                     elapsed_regression_threshold);
+    cut_run_context_set_benchmark_filter(run_context,
+                                         (const gchar **)benchmark_filter);
+    cut_run_context_set_benchmark_min_time(run_context, benchmark_min_time);
+    cut_run_context_set_measure_resource_usage(run_context,
+                                               measure_resource_usage);
+    cut_run_context_set_measure_phases(run_context, measure_phases);
+    cut_run_context_set_full_memory_dump(run_context, full_memory_dump);
     cut_run_context_set_fatal_failures(run_context, fatal_failures);
     cut_run_context_set_keep_opening_modules(run_context, keep_opening_modules);
     cut_run_context_set_enable_convenience_attribute_definition(run_context,
@@ -597,6 +751,7 @@ cut_run_in_analyze_mode (void)
     gboolean success;
 
     analyzer = cut_analyzer_new();
+    cut_analyzer_set_max_threads(analyzer, use_multi_thread ? max_threads : 1);
     success = cut_analyzer_analyze(analyzer, log_directory, &error);
     if (error) {
         cut_utils_report_error(error);
@@ -283,6 +283,49 @@ int            cut_sub_process_get_max_threads    (CutSubProcess  *sub_process);
 void           cut_sub_process_set_max_threads    (CutSubProcess  *sub_process,
                                                    int             max_threads);
 
+/**
+ * cut_sub_process_get_shard_index:
+ * @sub_process: a #CutSubProcess.
+ *
+ * Returns the index of the shard that is run in @sub_process.
+ *
+ * Returns: the index of the shard that is run in @sub_process.
+ *
+ * Since: 1.2.4
+ */
+int            cut_sub_process_get_shard_index    (CutSubProcess  *sub_process);
+
+/**
+ * cut_sub_process_get_shard_count:
+ * @sub_process: a #CutSubProcess.
+ *
+ * Returns how many shards test cases are partitioned into
+ * in @sub_process.
+ *
+ * Returns: how many shards test cases are partitioned into.
+ *
+ * Since: 1.2.4
+ */
+int            cut_sub_process_get_shard_count    (CutSubProcess  *sub_process);
+
+/**
+ * cut_sub_process_set_shard:
+ * @sub_process: a #CutSubProcess.
+ * @index: the index of the shard to be ran (0 origin).
+ * @count: how many shards test cases are partitioned into.
+ *
+ * Sets that @sub_process runs only test cases in the
+ * @index-th shard of @count shards. 0 or 1 @count means
+ * all test cases are ran. This is same as --shard command
+ * line option. It is useful to run a test suite in
+ * parallel with #CutSubProcessGroup.
+ *
+ * Since: 1.2.4
+ */
+void           cut_sub_process_set_shard          (CutSubProcess  *sub_process,
+                                                   int             index,
+                                                   int             count);
+
 /**
  * cut_sub_process_get_exclude_files:
  * @sub_process: a #CutSubProcess.
@@ -31,6 +31,7 @@
 #include <glib/gstdio.h>
 
 #include "cut-pe-loader.h"
+#include "cut-glib-compatible.h"
 #include "cut-logger.h"
 
 #define CUT_PE_LOADER_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE((obj), CUT_TYPE_PE_LOADER, CutPELoaderPrivate))
@@ -39,7 +40,8 @@ typedef struct _CutPELoaderPrivate	CutPELoaderPrivate;
 struct _CutPELoaderPrivate
 {
     gchar *so_filename;
-    gchar *content;
+    GMappedFile *mapped_file;
+    const gchar *content;
     gsize length;
 #ifdef HAVE_WINDOWS_H
     IMAGE_NT_HEADERS *nt_headers;
@@ -64,6 +66,36 @@ static void get_property    (GObject               *object,
                              GValue                *value,
                              GParamSpec            *pspec);
 
+#ifdef HAVE_WINDOWS_H
+static gboolean
+map_file (CutPELoaderPrivate *priv)
+{
+    GError *error = NULL;
+
+    priv->mapped_file = g_mapped_file_new(priv->so_filename, FALSE, &error);
+    if (!priv->mapped_file) {
+        g_warning("can't read shared library file: %s", error->message);
+        g_error_free(error);
+        return FALSE;
+    }
+    priv->content = g_mapped_file_get_contents(priv->mapped_file);
+    priv->length = g_mapped_file_get_length(priv->mapped_file);
+
+    return TRUE;
+}
+#endif
+
+static void
+unmap_file (CutPELoaderPrivate *priv)
+{
+    if (priv->mapped_file) {
+        g_mapped_file_unref(priv->mapped_file);
+        priv->mapped_file = NULL;
+    }
+    priv->content = NULL;
+    priv->length = 0;
+}
+
 static void
 cut_pe_loader_class_init (CutPELoaderClass *klass)
 {
@@ -92,6 +124,7 @@ cut_pe_loader_init (CutPELoader *loader)
     CutPELoaderPrivate *priv = CUT_PE_LOADER_GET_PRIVATE(loader);
 
     priv->so_filename = NULL;
+    priv->mapped_file = NULL;
     priv->content = NULL;
     priv->length = 0;
 #ifdef HAVE_WINDOWS_H
@@ -109,10 +142,7 @@ dispose (GObject *object)
         priv->so_filename = NULL;
     }
 
-    if (priv->content) {
-        g_free(priv->content);
-        priv->content = NULL;
-    }
+    unmap_file(priv);
 
     G_OBJECT_CLASS(cut_pe_loader_parent_class)->dispose(object);
 }
@@ -168,23 +198,23 @@ cut_pe_loader_is_dll (CutPELoader *loader)
 {
 #ifdef HAVE_WINDOWS_H
     CutPELoaderPrivate *priv;
-    GError *error = NULL;
-    IMAGE_DOS_HEADER *dos_header;
+    const IMAGE_DOS_HEADER *dos_header;
 
     priv = CUT_PE_LOADER_GET_PRIVATE(loader);
     cut_log_trace("[loader][pe][open] <%s>", priv->so_filename);
-    if (!g_file_get_contents(priv->so_filename, &priv->content, &priv->length,
-                             &error)) {
-        g_warning("can't read shared library file: %s", error->message);
-        g_error_free(error);
+    unmap_file(priv);
+    priv->nt_headers = NULL;
+    if (!map_file(priv))
         return FALSE;
-    }
 
     if (priv->length < sizeof(*dos_header))
         return FALSE;
 
-    dos_header = (IMAGE_DOS_HEADER *)priv->content;
-    if (priv->length < dos_header->e_lfanew)
+    dos_header = (const IMAGE_DOS_HEADER *)priv->content;
+    if (dos_header->e_lfanew < 0 ||
+        priv->length < sizeof(IMAGE_NT_HEADERS) ||
+        priv->length - sizeof(IMAGE_NT_HEADERS) <
+        (gsize)dos_header->e_lfanew)
         return FALSE;
 
     priv->nt_headers =
@@ -230,6 +260,8 @@ cut_pe_loader_collect_symbols (CutPELoader *loader)
     DWORD min_text_section_address, max_text_section_address;
 
     priv = CUT_PE_LOADER_GET_PRIVATE(loader);
+    if (!priv->nt_headers)
+        return NULL;
     first_section = IMAGE_FIRST_SECTION(priv->nt_headers);
     cut_log_trace("[loader][pe][collect-symbols][n-sections] <%d>",
                   priv->nt_headers->FileHeader.NumberOfSections);
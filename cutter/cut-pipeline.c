@@ -1,6 +1,6 @@
 /* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
 /*
- *  Copyright (C) 2008-2011  Kouhei Sutou <kou@clear-code.com>
+ *  Copyright (C) 2008-2014  Kouhei Sutou <kou@clear-code.com>
  *
  *  This library is free software: you can redistribute it and/or modify
  *  it under the terms of the GNU Lesser General Public License as published by
@@ -35,6 +35,7 @@
 #include "cut-runner.h"
 #include "cut-experimental.h"
 #include "cut-utils.h"
+#include "cut-module-factory-utils.h"
 
 #ifdef G_OS_WIN32
 #  include <io.h>
@@ -153,6 +154,14 @@ cut_pipeline_new_from_run_context (CutRunContext *run_context)
                         cut_run_context_get_multi_thread(run_context),
                         "max-threads",
                         cut_run_context_get_max_threads(run_context),
+                        "n-processes",
+                        cut_run_context_get_n_processes(run_context),
+                        "shard-index",
+                        cut_run_context_get_shard_index(run_context),
+                        "shard-count",
+                        cut_run_context_get_shard_count(run_context),
+                        "shard-log",
+                        cut_run_context_get_shard_log(run_context),
                         "handle-signals",
                         cut_run_context_get_handle_signals(run_context),
                         "exclude-files",
@@ -165,10 +174,30 @@ cut_pipeline_new_from_run_context (CutRunContext *run_context)
                         cut_run_context_get_target_test_names(run_context),
                         "test-case-order",
                         cut_run_context_get_test_case_order(run_context),
+                        "log-directory",
+                        cut_run_context_get_log_directory(run_context),
+                        "test-index-file",
+                        cut_run_context_get_test_index_file(run_context),
                         "source-directory",
                         cut_run_context_get_source_directory(run_context),
                         "command-line-args",
                         cut_run_context_get_command_line_args(run_context),
+                        "keep-results",
+                        cut_run_context_get_keep_results(run_context),
+                        "elapsed-regression",
+                        cut_run_context_get_elapsed_regression(run_context),
+                        "elapsed-regression-threshold",
+                        cut_run_context_get_elapsed_regression_threshold(run_context),
+                        "benchmark-filter",
+                        cut_run_context_get_benchmark_filter(run_context),
+                        "benchmark-min-time",
+                        cut_run_context_get_benchmark_min_time(run_context),
+                        "measure-resource-usage",
+                        cut_run_context_get_measure_resource_usage(run_context),
+                        "measure-phases",
+                        cut_run_context_get_measure_phases(run_context),
+                        "full-memory-dump",
+                        cut_run_context_get_full_memory_dump(run_context),
                         "fatal-failures",
                         cut_run_context_get_fatal_failures(run_context),
                         "keep-opening-modules",
@@ -249,6 +278,7 @@ create_child_out_channel (CutPipeline *pipeline)
         return NULL;
 
     g_io_channel_set_close_on_unref(channel, TRUE);
+    g_io_channel_set_encoding(channel, NULL, NULL);
 
     reader = CUT_STREAM_READER(pipeline);
     cut_stream_reader_watch_io_channel(reader, channel);
@@ -256,6 +286,14 @@ create_child_out_channel (CutPipeline *pipeline)
     return channel;
 }
 
+static const gchar *
+get_stream_option (void)
+{
+    if (cut_module_factory_exist_module("stream", "binary"))
+        return "--stream=binary";
+    return "--stream=xml";
+}
+
 static gchar **
 create_command_line_args_from_argv (CutPipeline *pipeline, const gchar **argv)
 {
@@ -286,8 +324,9 @@ create_command_line_args_from_argv (CutPipeline *pipeline, const gchar **argv)
                                      "--ui=console",
                                      "-v", "s",
                                      "--notify", "no",
-                                     "--stream=xml",
+                                     get_stream_option(),
                                      stream_fd,
+                                     "--stream-buffer-size=0",
                                      test_directory,
                                      NULL);
     g_free(stream_fd);
@@ -326,6 +365,7 @@ create_command_line_args_from_parameters (CutPipeline *pipeline)
     GArray *argv;
     const gchar *directory;
     const gchar **strings;
+    const gchar *elapsed_regression;
 
     priv = CUT_PIPELINE_GET_PRIVATE(pipeline);
     run_context = CUT_RUN_CONTEXT(pipeline);
@@ -335,8 +375,9 @@ create_command_line_args_from_parameters (CutPipeline *pipeline)
     append_arg(argv, cut_utils_get_cutter_command_path());
     append_arg(argv, "--verbose=silent");
     append_arg(argv, "--notify=no");
-    append_arg(argv, "--stream=xml");
+    append_arg(argv, get_stream_option());
     append_arg_printf(argv, "--stream-fd=%d", priv->child_pipe[CUT_WRITE]);
+    append_arg(argv, "--stream-buffer-size=0");
 
     directory = cut_run_context_get_source_directory(run_context);
     if (directory)
@@ -349,6 +390,21 @@ create_command_line_args_from_parameters (CutPipeline *pipeline)
                       "--max-threads=%d",
                       cut_run_context_get_max_threads(run_context));
 
+    if (cut_run_context_get_n_processes(run_context) > 1)
+        append_arg_printf(argv,
+                          "--multi-process=%d",
+                          cut_run_context_get_n_processes(run_context));
+
+    if (cut_run_context_get_shard_count(run_context) > 1)
+        append_arg_printf(argv,
+                          "--shard=%d/%d",
+                          cut_run_context_get_shard_index(run_context),
+                          cut_run_context_get_shard_count(run_context));
+
+    if (cut_run_context_get_shard_log(run_context))
+        append_arg_printf(argv, "--shard-log=%s",
+                          cut_run_context_get_shard_log(run_context));
+
     strings = cut_run_context_get_exclude_files(run_context);
     while (strings && *strings) {
         append_arg_printf(argv, "--exclude-file=%s", *strings);
@@ -373,9 +429,60 @@ create_command_line_args_from_parameters (CutPipeline *pipeline)
         strings++;
     }
 
+    switch (cut_run_context_get_elapsed_regression(run_context)) {
+    case CUT_ELAPSED_REGRESSION_NOTIFICATION:
+        elapsed_regression = "notification";
+        break;
+    case CUT_ELAPSED_REGRESSION_FAILURE:
+        elapsed_regression = "failure";
+        break;
+    default:
+        elapsed_regression = NULL;
+        break;
+    }
+    if (elapsed_regression) {
+        gchar threshold[G_ASCII_DTOSTR_BUF_SIZE];
+
+        append_arg_printf(argv, "--elapsed-regression=%s", elapsed_regression);
+        g_ascii_dtostr(threshold, sizeof(threshold),
+                       cut_run_context_get_elapsed_regression_threshold(run_context));
+        append_arg_printf(argv, "--elapsed-regression-threshold=%s",
+                          threshold);
+    }
+
+    strings = cut_run_context_get_benchmark_filter(run_context);
+    if (strings) {
+        gchar min_time[G_ASCII_DTOSTR_BUF_SIZE];
+
+        while (*strings) {
+            append_arg_printf(argv, "--benchmark-filter=%s", *strings);
+            strings++;
+        }
+        g_ascii_dtostr(min_time, sizeof(min_time),
+                       cut_run_context_get_benchmark_min_time(run_context));
+        append_arg_printf(argv, "--benchmark-min-time=%s", min_time);
+    }
+
+    if (cut_run_context_get_measure_resource_usage(run_context))
+        append_arg(argv, "--measure-resource-usage");
+
+    if (cut_run_context_get_measure_phases(run_context))
+        append_arg(argv, "--measure-phases");
+
+    if (cut_run_context_get_full_memory_dump(run_context))
+        append_arg(argv, "--full-memory-dump");
+
     if (cut_run_context_get_fatal_failures(run_context))
         append_arg(argv, "--fatal-failures");
 
+    directory = cut_run_context_get_log_directory(run_context);
+    if (directory)
+        append_arg_printf(argv, "--log-directory=%s", directory);
+
+    if (cut_run_context_get_test_index_file(run_context))
+        append_arg_printf(argv, "--test-index=%s",
+                          cut_run_context_get_test_index_file(run_context));
+
     append_arg(argv, cut_run_context_get_test_directory(run_context));
 
     return (gchar **)(g_array_free(argv, FALSE));
@@ -471,6 +578,10 @@ run_async (CutPipeline *pipeline)
         return;
     }
 
+#ifndef G_OS_WIN32
+    cut_stream_reader_set_process_id(CUT_STREAM_READER(pipeline), priv->pid);
+#endif
+
     priv->child_out = create_child_out_channel(pipeline);
     if (!priv->child_out) {
         emit_error(pipeline, CUT_PIPELINE_ERROR_PIPE,
@@ -33,6 +33,7 @@ typedef struct _CutTestIterator    CutTestIterator;
 typedef struct _CutTest            CutTest;
 typedef struct _CutIteratedTest    CutIteratedTest;
 typedef struct _CutTestResult      CutTestResult;
+typedef struct _CutTestHistory     CutTestHistory;
 
 G_END_DECLS
 
@@ -1,6 +1,6 @@
 /* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
 /*
- *  Copyright (C) 2008-2010  Kouhei Sutou <kou@clear-code.com>
+ *  Copyright (C) 2008-2014  Kouhei Sutou <kou@clear-code.com>
  *
  *  This library is free software: you can redistribute it and/or modify
  *  it under the terms of the GNU Lesser General Public License as published by
@@ -239,6 +239,13 @@ diff_lines (CutDiffer *differ, CutDiffWriter *writer,
 
     klass = CUT_READABLE_DIFFER_GET_CLASS(differ);
 
+    if ((guint64)(from_end - from_begin) * (to_end - to_begin) >
+        CUT_DIFFER_MAX_REPLACED_LINE_PAIRS) {
+        mark_deleted(writer, from, from_begin, from_end);
+        mark_inserted(writer, to, to_begin, to_end);
+        return;
+    }
+
     best_ratio = cut_differ_get_best_ratio(differ);
     cut_off_ratio = cut_differ_get_cut_off_ratio(differ);
 
@@ -23,11 +23,21 @@
 
 #include <stdlib.h>
 #include <string.h>
+#ifdef HAVE_UNISTD_H
+#  include <unistd.h>
+#endif
 #include <glib.h>
 #include <glib-compatible/glib-compatible.h>
 
 #include "cut-repository.h"
 #include "cut-loader.h"
+#include "cut-elf-loader.h"
+#include "cut-mach-o-loader.h"
+#include "cut-pe-loader.h"
+#include "cut-scheduler.h"
+#include "cut-test-index.h"
+#include "cut-glib-compatible.h"
+#include "cut-logger.h"
 #include "cut-utils.h"
 
 #define CUT_REPOSITORY_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CUT_TYPE_REPOSITORY, CutRepositoryPrivate))
@@ -46,6 +56,34 @@ struct _CutRepositoryPrivate
 
     gboolean keep_opening_modules;
     gboolean enable_convenience_attribute_definition;
+    gchar *test_index_file;
+    gint max_threads;
+    gchar **target_test_case_names;
+    gchar **target_test_names;
+};
+
+typedef struct _ModuleEntry ModuleEntry;
+struct _ModuleEntry
+{
+    gchar *path_name;
+    gchar *relative_path;
+    gint deep;
+};
+
+typedef struct _CollectContext CollectContext;
+struct _CollectContext
+{
+    CutRepositoryPrivate *priv;
+    CutSchedulerGroup *group;
+    GMutex *mutex;
+    GList *entries;
+};
+
+typedef struct _DirectoryTask DirectoryTask;
+struct _DirectoryTask
+{
+    gchar *dir_name;
+    GArray *paths;
 };
 
 enum
@@ -102,6 +140,10 @@ cut_repository_init (CutRepository *repository)
     priv->test_suite_loader = NULL;
     priv->keep_opening_modules = FALSE;
     priv->enable_convenience_attribute_definition = FALSE;
+    priv->test_index_file = NULL;
+    priv->max_threads = 1;
+    priv->target_test_case_names = NULL;
+    priv->target_test_names = NULL;
 }
 
 static void
@@ -121,6 +163,21 @@ dispose (GObject *object)
         priv->directory = NULL;
     }
 
+    if (priv->test_index_file) {
+        g_free(priv->test_index_file);
+        priv->test_index_file = NULL;
+    }
+
+    if (priv->target_test_case_names) {
+        g_strfreev(priv->target_test_case_names);
+        priv->target_test_case_names = NULL;
+    }
+
+    if (priv->target_test_names) {
+        g_strfreev(priv->target_test_names);
+        priv->target_test_names = NULL;
+    }
+
     if (priv->loaders) {
         g_list_foreach(priv->loaders, (GFunc)g_object_unref, NULL);
         g_list_free(priv->loaders);
@@ -221,6 +278,54 @@ cut_repository_set_enable_convenience_attribute_definition (CutRepository *repos
     CUT_REPOSITORY_GET_PRIVATE(repository)->enable_convenience_attribute_definition = enable_convenience_attribute_definition;
 }
 
+const gchar *
+cut_repository_get_test_index_file (CutRepository *repository)
+{
+    return CUT_REPOSITORY_GET_PRIVATE(repository)->test_index_file;
+}
+
+void
+cut_repository_set_test_index_file (CutRepository *repository,
+                                    const gchar   *file_name)
+{
+    CutRepositoryPrivate *priv = CUT_REPOSITORY_GET_PRIVATE(repository);
+
+    g_free(priv->test_index_file);
+    priv->test_index_file = g_strdup(file_name);
+}
+
+void
+cut_repository_set_target_test_case_names (CutRepository *repository,
+                                           const gchar **names)
+{
+    CutRepositoryPrivate *priv = CUT_REPOSITORY_GET_PRIVATE(repository);
+
+    g_strfreev(priv->target_test_case_names);
+    priv->target_test_case_names = g_strdupv((gchar **)names);
+}
+
+void
+cut_repository_set_target_test_names (CutRepository *repository,
+                                      const gchar **names)
+{
+    CutRepositoryPrivate *priv = CUT_REPOSITORY_GET_PRIVATE(repository);
+
+    g_strfreev(priv->target_test_names);
+    priv->target_test_names = g_strdupv((gchar **)names);
+}
+
+gint
+cut_repository_get_max_threads (CutRepository *repository)
+{
+    return CUT_REPOSITORY_GET_PRIVATE(repository)->max_threads;
+}
+
+void
+cut_repository_set_max_threads (CutRepository *repository, gint max_threads)
+{
+    CUT_REPOSITORY_GET_PRIVATE(repository)->max_threads = max_threads;
+}
+
 static gboolean
 is_test_suite_so_path_name (const gchar *path_name)
 {
@@ -283,13 +388,67 @@ compute_relative_path (GArray *paths)
     return relative_path;
 }
 
+static GArray *
+paths_new (void)
+{
+    return g_array_new(TRUE, TRUE, sizeof(gchar *));
+}
+
+static GArray *
+paths_copy (GArray *paths)
+{
+    GArray *copied_paths;
+    guint i;
+
+    copied_paths = g_array_sized_new(TRUE, TRUE, sizeof(gchar *), paths->len);
+    for (i = 0; i < paths->len; i++) {
+        gchar *component;
+
+        component = g_strdup(g_array_index(paths, gchar *, i));
+        g_array_append_val(copied_paths, component);
+    }
+
+    return copied_paths;
+}
+
+static void
+paths_free (GArray *paths)
+{
+    guint i;
+
+    for (i = 0; i < paths->len; i++) {
+        g_free(g_array_index(paths, gchar *, i));
+    }
+    g_array_free(paths, TRUE);
+}
+
+static void
+module_entry_free (ModuleEntry *entry)
+{
+    g_free(entry->path_name);
+    g_free(entry->relative_path);
+    g_slice_free(ModuleEntry, entry);
+}
+
+static gint
+compare_module_entry (gconstpointer a, gconstpointer b)
+{
+    const ModuleEntry *entry1 = a;
+    const ModuleEntry *entry2 = b;
+
+    return strcmp(entry1->path_name, entry2->path_name);
+}
+
+static void collect_module_entries_in_directory (gpointer data,
+                                                 gpointer user_data);
+
 static void
-cut_repository_collect_loader (CutRepository *repository, const gchar *dir_name,
-                               GArray *paths)
+collect_module_entries (CollectContext *context, const gchar *dir_name,
+                        GArray *paths)
 {
     GDir *dir;
     const gchar *entry;
-    CutRepositoryPrivate *priv = CUT_REPOSITORY_GET_PRIVATE(repository);
+    CutRepositoryPrivate *priv = context->priv;
 
     if (is_ignore_directory(dir_name))
         return;
@@ -303,17 +462,28 @@ cut_repository_collect_loader (CutRepository *repository, const gchar *dir_name,
 
         path_name = g_build_filename(dir_name, entry, NULL);
         if (g_file_test(path_name, G_FILE_TEST_IS_DIR)) {
+            gchar *component;
+
             if (cut_utils_filter_match(priv->exclude_dirs_regexs, entry)) {
                 g_free(path_name);
                 continue;
             }
-            g_array_append_val(paths, entry);
-            cut_repository_collect_loader(repository, path_name, paths);
+            component = g_strdup(entry);
+            g_array_append_val(paths, component);
+            if (context->group) {
+                DirectoryTask *task;
+
+                task = g_slice_new(DirectoryTask);
+                task->dir_name = g_strdup(path_name);
+                task->paths = paths_copy(paths);
+                cut_scheduler_group_push(context->group, task);
+            } else {
+                collect_module_entries(context, path_name, paths);
+            }
+            g_free(component);
             g_array_remove_index(paths, paths->len - 1);
         } else {
-            CutLoader *loader;
-            gchar *relative_path;
-            GList *node;
+            ModuleEntry *module_entry;
 
             if (cut_utils_filter_match(priv->exclude_files_regexs, entry) ||
                 !g_str_has_suffix(entry, "."G_MODULE_SUFFIX)) {
@@ -321,45 +491,182 @@ cut_repository_collect_loader (CutRepository *repository, const gchar *dir_name,
                 continue;
             }
 
-            loader = cut_loader_new(path_name);
-            relative_path = compute_relative_path(paths);
-            cut_loader_set_base_directory(loader, relative_path);
-            cut_loader_set_keep_opening(loader, priv->keep_opening_modules);
-            cut_loader_set_enable_convenience_attribute_definition(
-                loader, priv->enable_convenience_attribute_definition);
-            for (node = priv->loader_customizers; node; node = g_list_next(node)) {
-                CutLoaderCustomizer *customizer = node->data;
-                cut_loader_customizer_customize(customizer, loader);
-            }
-            if (is_test_suite_so_path_name(path_name)) {
-                update_test_suite_loader(priv, loader, paths->len);
-            } else {
-                priv->loaders = g_list_prepend(priv->loaders, loader);
-            }
-            g_free(relative_path);
+            module_entry = g_slice_new(ModuleEntry);
+            module_entry->path_name = g_strdup(path_name);
+            module_entry->relative_path = compute_relative_path(paths);
+            module_entry->deep = paths->len;
+            if (context->mutex)
+                g_mutex_lock(context->mutex);
+            context->entries = g_list_prepend(context->entries, module_entry);
+            if (context->mutex)
+                g_mutex_unlock(context->mutex);
         }
         g_free(path_name);
     }
     g_dir_close(dir);
 }
 
+static void
+collect_module_entries_in_directory (gpointer data, gpointer user_data)
+{
+    DirectoryTask *task = data;
+    CollectContext *context = user_data;
+
+    collect_module_entries(context, task->dir_name, task->paths);
+
+    g_free(task->dir_name);
+    paths_free(task->paths);
+    g_slice_free(DirectoryTask, task);
+}
+
+static CutLoader *
+create_loader (CutRepositoryPrivate *priv, ModuleEntry *entry)
+{
+    CutLoader *loader;
+    GList *node;
+
+    loader = cut_loader_new(entry->path_name);
+    cut_loader_set_base_directory(loader, entry->relative_path);
+    cut_loader_set_keep_opening(loader, priv->keep_opening_modules);
+    cut_loader_set_enable_convenience_attribute_definition(
+        loader, priv->enable_convenience_attribute_definition);
+    cut_loader_set_target_test_case_names(
+        loader, (const gchar **)priv->target_test_case_names);
+    cut_loader_set_target_test_names(
+        loader, (const gchar **)priv->target_test_names);
+    for (node = priv->loader_customizers; node; node = g_list_next(node)) {
+        CutLoaderCustomizer *customizer = node->data;
+        cut_loader_customizer_customize(customizer, loader);
+    }
+
+    return loader;
+}
+
+/*
+ * Directories are walked in parallel when a scheduler is
+ * given. Loaders are created on the caller's thread in
+ * path order because loader customizers aren't thread-safe
+ * and readdir() order isn't stable.
+ */
+static void
+cut_repository_collect_loaders (CutRepository *repository,
+                                CutScheduler *scheduler)
+{
+    CutRepositoryPrivate *priv = CUT_REPOSITORY_GET_PRIVATE(repository);
+    CollectContext context;
+    GArray *paths;
+    GList *node;
+
+    context.priv = priv;
+    context.group = NULL;
+    context.mutex = NULL;
+    context.entries = NULL;
+
+    paths = paths_new();
+    if (scheduler) {
+        DirectoryTask *task;
+
+        context.mutex = g_mutex_new();
+        context.group =
+            cut_scheduler_group_new(scheduler,
+                                    collect_module_entries_in_directory,
+                                    &context);
+        task = g_slice_new(DirectoryTask);
+        task->dir_name = g_strdup(priv->directory);
+        task->paths = paths;
+        cut_scheduler_group_push(context.group, task);
+        cut_scheduler_group_join(context.group);
+        g_mutex_free(context.mutex);
+    } else {
+        collect_module_entries(&context, priv->directory, paths);
+        paths_free(paths);
+    }
+
+    context.entries = g_list_sort(context.entries, compare_module_entry);
+    for (node = context.entries; node; node = g_list_next(node)) {
+        ModuleEntry *entry = node->data;
+        CutLoader *loader;
+
+        loader = create_loader(priv, entry);
+        if (is_test_suite_so_path_name(entry->path_name)) {
+            update_test_suite_loader(priv, loader, entry->deep);
+            g_object_unref(loader);
+        } else {
+            priv->loaders = g_list_prepend(priv->loaders, loader);
+        }
+        module_entry_free(entry);
+    }
+    g_list_free(context.entries);
+    priv->loaders = g_list_reverse(priv->loaders);
+}
+
+static void
+collect_test_functions (gpointer data, gpointer user_data)
+{
+    cut_loader_collect_test_functions(CUT_LOADER(data));
+}
+
+/* Scanning is I/O and ELF parsing bound. More threads than
+ * this don't make it faster. */
+#define MAX_SCAN_THREADS 16
+
+static gint
+get_n_processors (void)
+{
+#if GLIB_CHECK_VERSION(2, 36, 0)
+    return g_get_num_processors();
+#elif defined(_SC_NPROCESSORS_ONLN)
+    glong n_processors;
+
+    n_processors = sysconf(_SC_NPROCESSORS_ONLN);
+    return n_processors > 0 ? n_processors : 1;
+#else
+    return 1;
+#endif
+}
+
+static gint
+get_n_scan_threads (CutRepositoryPrivate *priv)
+{
+    gint n_threads, max_n_threads;
+
+    max_n_threads = MIN(get_n_processors(), MAX_SCAN_THREADS);
+    n_threads = priv->max_threads;
+    if (n_threads <= 0 || n_threads > max_n_threads)
+        n_threads = max_n_threads;
+
+    return n_threads;
+}
+
+static void
+ensure_binary_loader_types (void)
+{
+    /* GType registration isn't thread-safe on old GLib. */
+    g_type_class_unref(g_type_class_ref(CUT_TYPE_ELF_LOADER));
+    g_type_class_unref(g_type_class_ref(CUT_TYPE_MACH_O_LOADER));
+    g_type_class_unref(g_type_class_ref(CUT_TYPE_PE_LOADER));
+}
+
 CutTestSuite *
 cut_repository_create_test_suite (CutRepository *repository)
 {
     CutTestSuite *suite = NULL;
     CutRepositoryPrivate *priv = CUT_REPOSITORY_GET_PRIVATE(repository);
+    CutScheduler *scheduler = NULL;
+    CutTestIndex *test_index = NULL;
     GList *list;
+    gint n_scan_threads;
 
     if (!priv->directory)
         return NULL;
 
-    if (!priv->loaders) {
-        GArray *paths;
+    n_scan_threads = get_n_scan_threads(priv);
+    if (n_scan_threads > 1)
+        scheduler = cut_scheduler_new(n_scan_threads);
 
+    if (!priv->loaders) {
         priv->deep = 0;
-        paths = g_array_new(TRUE, TRUE, sizeof(gchar *));
-        cut_repository_collect_loader(repository, priv->directory, paths);
-        g_array_free(paths, TRUE);
+        cut_repository_collect_loaders(repository, scheduler);
     }
 
     if (priv->test_suite_loader)
@@ -367,11 +674,39 @@ cut_repository_create_test_suite (CutRepository *repository)
     if (!suite)
         suite = cut_test_suite_new_empty();
 
+    if (priv->test_index_file) {
+        GError *error = NULL;
+
+        test_index = cut_test_index_new(priv->test_index_file);
+        if (!cut_test_index_load(test_index, &error)) {
+            cut_log_warning("[repository][test-index][load][error] <%s>: %s",
+                            priv->test_index_file, error->message);
+            g_error_free(error);
+        }
+    }
+
+    for (list = priv->loaders; list; list = g_list_next(list)) {
+        cut_loader_set_test_index(CUT_LOADER(list->data), test_index);
+    }
+
+    if (scheduler) {
+        CutSchedulerGroup *group;
+
+        ensure_binary_loader_types();
+        group = cut_scheduler_group_new(scheduler, collect_test_functions, NULL);
+        for (list = priv->loaders; list; list = g_list_next(list)) {
+            cut_scheduler_group_push(group, list->data);
+        }
+        cut_scheduler_group_join(group);
+        cut_scheduler_free(scheduler);
+    }
+
     for (list = priv->loaders; list; list = g_list_next(list)) {
         CutLoader *loader = CUT_LOADER(list->data);
         GList *test_cases, *node;
 
         test_cases = cut_loader_load_test_cases(loader);
+        cut_loader_set_test_index(loader, NULL);
         for (node = test_cases; node; node = g_list_next(node)) {
             CutTestCase *test_case = node->data;
 
@@ -380,6 +715,18 @@ cut_repository_create_test_suite (CutRepository *repository)
         }
         g_list_free(test_cases);
     }
+
+    if (test_index) {
+        GError *error = NULL;
+
+        if (!cut_test_index_save(test_index, &error)) {
+            cut_log_warning("[repository][test-index][save][error] <%s>: %s",
+                            priv->test_index_file, error->message);
+            g_error_free(error);
+        }
+        cut_test_index_free(test_index);
+    }
+
     return suite;
 }
 
@@ -0,0 +1,219 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+/* for RUSAGE_THREAD */
+#  define _GNU_SOURCE
+#endif
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <string.h>
+#include <glib.h>
+#ifdef HAVE_SYS_RESOURCE_H
+#  include <sys/time.h>
+#  include <sys/resource.h>
+#endif
+
+#include "cut-resource-usage.h"
+#include "cut-utils.h"
+
+#define ELEMENT_USER_TIME                    "user-time"
+#define ELEMENT_SYSTEM_TIME                  "system-time"
+#define ELEMENT_MAX_RSS                      "max-rss"
+#define ELEMENT_MINOR_FAULTS                 "minor-faults"
+#define ELEMENT_MAJOR_FAULTS                 "major-faults"
+#define ELEMENT_VOLUNTARY_CONTEXT_SWITCHES   "voluntary-context-switches"
+#define ELEMENT_INVOLUNTARY_CONTEXT_SWITCHES "involuntary-context-switches"
+
+#if defined(HAVE_SYS_RESOURCE_H) && defined(HAVE_GETRUSAGE)
+static gdouble
+time_val_to_double (const struct timeval *value)
+{
+    return value->tv_sec + value->tv_usec / (gdouble)G_USEC_PER_SEC;
+}
+#endif
+
+/*
+ * With thread, only resources of the current thread are
+ * got. It returns FALSE if the platform can't do it. Tests
+ * run in parallel in multi-thread mode, so resources of the
+ * process are meaningless for a test.
+ */
+gboolean
+cut_resource_usage_get (CutResourceUsage *usage, gboolean thread)
+{
+#if defined(HAVE_SYS_RESOURCE_H) && defined(HAVE_GETRUSAGE)
+    struct rusage rusage;
+    int who = RUSAGE_SELF;
+
+    if (thread) {
+#ifdef RUSAGE_THREAD
+        who = RUSAGE_THREAD;
+#else
+        return FALSE;
+#endif
+    }
+
+    if (getrusage(who, &rusage) != 0)
+        return FALSE;
+
+    usage->user_time = time_val_to_double(&(rusage.ru_utime));
+    usage->system_time = time_val_to_double(&(rusage.ru_stime));
+#ifdef __APPLE__
+    usage->max_rss = rusage.ru_maxrss / 1024;
+#else
+    usage->max_rss = rusage.ru_maxrss;
+#endif
+    usage->minor_faults = rusage.ru_minflt;
+    usage->major_faults = rusage.ru_majflt;
+    usage->voluntary_context_switches = rusage.ru_nvcsw;
+    usage->involuntary_context_switches = rusage.ru_nivcsw;
+
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+static guint64
+subtract_count (guint64 value, guint64 start)
+{
+    return value > start ? value - start : 0;
+}
+
+void
+cut_resource_usage_subtract (CutResourceUsage *usage,
+                             const CutResourceUsage *start)
+{
+    usage->user_time = MAX(usage->user_time - start->user_time, 0.0);
+    usage->system_time = MAX(usage->system_time - start->system_time, 0.0);
+    usage->max_rss = subtract_count(usage->max_rss, start->max_rss);
+    usage->minor_faults = subtract_count(usage->minor_faults,
+                                         start->minor_faults);
+    usage->major_faults = subtract_count(usage->major_faults,
+                                         start->major_faults);
+    usage->voluntary_context_switches =
+        subtract_count(usage->voluntary_context_switches,
+                       start->voluntary_context_switches);
+    usage->involuntary_context_switches =
+        subtract_count(usage->involuntary_context_switches,
+                       start->involuntary_context_switches);
+}
+
+gdouble
+cut_resource_usage_get_cpu_time (const CutResourceUsage *usage)
+{
+    return usage->user_time + usage->system_time;
+}
+
+static gboolean
+parse_double (const gchar *value, gdouble *result)
+{
+    gchar *end;
+
+    *result = g_ascii_strtod(value, &end);
+    return end != value && end[0] == '\0';
+}
+
+static gboolean
+parse_count (const gchar *value, guint64 *result)
+{
+    gchar *end;
+
+    *result = g_ascii_strtoull(value, &end, 10);
+    return end != value && end[0] == '\0';
+}
+
+/*
+ * Sets a value by the name of its XML element. It is for
+ * stream parsers.
+ */
+gboolean
+cut_resource_usage_set_value (CutResourceUsage *usage,
+                              const gchar *name, const gchar *value)
+{
+    if (g_str_equal(name, ELEMENT_USER_TIME))
+        return parse_double(value, &(usage->user_time));
+    else if (g_str_equal(name, ELEMENT_SYSTEM_TIME))
+        return parse_double(value, &(usage->system_time));
+    else if (g_str_equal(name, ELEMENT_MAX_RSS))
+        return parse_count(value, &(usage->max_rss));
+    else if (g_str_equal(name, ELEMENT_MINOR_FAULTS))
+        return parse_count(value, &(usage->minor_faults));
+    else if (g_str_equal(name, ELEMENT_MAJOR_FAULTS))
+        return parse_count(value, &(usage->major_faults));
+    else if (g_str_equal(name, ELEMENT_VOLUNTARY_CONTEXT_SWITCHES))
+        return parse_count(value, &(usage->voluntary_context_switches));
+    else if (g_str_equal(name, ELEMENT_INVOLUNTARY_CONTEXT_SWITCHES))
+        return parse_count(value, &(usage->involuntary_context_switches));
+    else
+        return FALSE;
+}
+
+static void
+append_double (GString *string, guint indent,
+               const gchar *name, gdouble value)
+{
+    gchar *formatted_value;
+
+    formatted_value = cut_utils_double_to_string(value);
+    cut_utils_append_xml_element_with_value(string, indent,
+                                            name, formatted_value);
+    g_free(formatted_value);
+}
+
+static void
+append_count (GString *string, guint indent,
+              const gchar *name, guint64 value)
+{
+    gchar *formatted_value;
+
+    formatted_value = g_strdup_printf("%" G_GUINT64_FORMAT, value);
+    cut_utils_append_xml_element_with_value(string, indent,
+                                            name, formatted_value);
+    g_free(formatted_value);
+}
+
+void
+cut_resource_usage_to_xml_string (const CutResourceUsage *usage,
+                                  GString *string, guint indent)
+{
+    cut_utils_append_indent(string, indent);
+    g_string_append(string, "<resource-usage>\n");
+    append_double(string, indent + 2, ELEMENT_USER_TIME, usage->user_time);
+    append_double(string, indent + 2, ELEMENT_SYSTEM_TIME, usage->system_time);
+    append_count(string, indent + 2, ELEMENT_MAX_RSS, usage->max_rss);
+    append_count(string, indent + 2, ELEMENT_MINOR_FAULTS,
+                 usage->minor_faults);
+    append_count(string, indent + 2, ELEMENT_MAJOR_FAULTS,
+                 usage->major_faults);
+    append_count(string, indent + 2, ELEMENT_VOLUNTARY_CONTEXT_SWITCHES,
+                 usage->voluntary_context_switches);
+    append_count(string, indent + 2, ELEMENT_INVOLUNTARY_CONTEXT_SWITCHES,
+                 usage->involuntary_context_switches);
+    cut_utils_append_indent(string, indent);
+    g_string_append(string, "</resource-usage>\n");
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
@@ -0,0 +1,70 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CUT_RESOURCE_USAGE_H__
+#define __CUT_RESOURCE_USAGE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * CutResourceUsage is resources used by a test. A test
+ * records the difference of getrusage() between before its
+ * setup and after its teardown. A result records the
+ * difference until the result is emitted.
+ *
+ * max_rss is how much the maximum resident set size grew in
+ * KiB. It is a high-water mark of the process, so only a
+ * test that uses more memory than all tests before it has
+ * non-zero value.
+ */
+
+typedef struct _CutResourceUsage CutResourceUsage;
+struct _CutResourceUsage
+{
+    gdouble user_time;
+    gdouble system_time;
+    guint64 max_rss;
+    guint64 minor_faults;
+    guint64 major_faults;
+    guint64 voluntary_context_switches;
+    guint64 involuntary_context_switches;
+};
+
+gboolean  cut_resource_usage_get            (CutResourceUsage       *usage,
+                                             gboolean                thread);
+void      cut_resource_usage_subtract       (CutResourceUsage       *usage,
+                                             const CutResourceUsage *start);
+gdouble   cut_resource_usage_get_cpu_time   (const CutResourceUsage *usage);
+
+gboolean  cut_resource_usage_set_value      (CutResourceUsage       *usage,
+                                             const gchar            *name,
+                                             const gchar            *value);
+void      cut_resource_usage_to_xml_string  (const CutResourceUsage *usage,
+                                             GString                *string,
+                                             guint                   indent);
+
+G_END_DECLS
+
+#endif /* __CUT_RESOURCE_USAGE_H__ */
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
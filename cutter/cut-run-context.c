@@ -30,7 +30,12 @@
 #include "cut-runner.h"
 #include "cut-listener.h"
 #include "cut-repository.h"
+#include "cut-scheduler.h"
+#include "cut-test-history.h"
+#include "cut-logger.h"
 #include "cut-test-case.h"
+#include "cut-iterated-test.h"
+#include "cut-test-data.h"
 #include "cut-test-result.h"
 #include "cut-glib-compatible.h"
 
@@ -48,26 +53,63 @@
 
 #define CUT_RUN_CONTEXT_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CUT_TYPE_RUN_CONTEXT, CutRunContextPrivate))
 
+typedef enum {
+    COUNTER_TESTS,
+    COUNTER_ASSERTIONS,
+    COUNTER_SUCCESSES,
+    COUNTER_FAILURES,
+    COUNTER_ERRORS,
+    COUNTER_PENDINGS,
+    COUNTER_NOTIFICATIONS,
+    COUNTER_OMISSIONS,
+    N_COUNTERS
+} Counter;
+
+/*
+ * Counters and results are recorded into per-thread
+ * buckets to avoid contention on the context's mutex in
+ * multi-thread runs. Threads are assigned to buckets in
+ * round robin. Results have a sequence number to be merged
+ * in the registered order.
+ */
+#define N_RESULT_BUCKETS 16
+
+typedef struct _BucketResult BucketResult;
+struct _BucketResult
+{
+    guint sequence;
+    CutTestResult *result;
+};
+
+typedef struct _ResultBucket ResultBucket;
+struct _ResultBucket
+{
+    volatile gint counters[N_COUNTERS];
+    GMutex *mutex;
+    GList *results;
+    /* to not share a cache line with other buckets */
+    gchar padding[64];
+};
+
 typedef struct _CutRunContextPrivate	CutRunContextPrivate;
 struct _CutRunContextPrivate
 {
-    guint n_tests;
-    guint n_assertions;
-    guint n_successes;
-    guint n_failures;
-    guint n_errors;
-    guint n_pendings;
-    guint n_notifications;
-    guint n_omissions;
+    guint counters[N_COUNTERS];
+    ResultBucket *buckets[N_RESULT_BUCKETS];
+    volatile gint n_registered_results;
     gdouble elapsed;
     GTimer *timer;
     GList *results;
     GList *reversed_results;
     gboolean use_multi_thread;
     gboolean is_multi_thread;
-    gboolean max_threads;
+    gint max_threads;
+    gint n_processes;
+    gint shard_index;
+    gint shard_count;
     gboolean handle_signals;
     GMutex *mutex;
+    CutScheduler *scheduler;
     gboolean crashed;
     gchar *backtrace;
     gchar *test_directory;
@@ -75,6 +117,9 @@ struct _CutRunContextPrivate
     gchar **exclude_directories;
     gchar *source_directory;
     gchar *log_directory;
+    CutTestHistory *test_history;
+    gchar *shard_log;
+    gchar *test_index_file;
     gchar **target_test_case_names;
     gchar **target_test_names;
     GList *loader_customizers;
@@ -88,6 +133,14 @@ struct _CutRunContextPrivate
     gboolean keep_opening_modules;
     gboolean enable_convenience_attribute_definition;
     gboolean stop_before_test;
+    CutKeepResults keep_results;
+    CutElapsedRegression elapsed_regression;
+    gdouble elapsed_regression_threshold;
+    gchar **benchmark_filter;
+    gdouble benchmark_min_time;
+    gboolean measure_resource_usage;
+    gboolean measure_phases;
+    gboolean full_memory_dump;
 };
 
 enum
@@ -104,11 +157,16 @@ enum
     PROP_USE_MULTI_THREAD,
     PROP_IS_MULTI_THREAD,
     PROP_MAX_THREADS,
+    PROP_N_PROCESSES,
+    PROP_SHARD_INDEX,
+    PROP_SHARD_COUNT,
     PROP_HANDLE_SIGNALS,
     PROP_TEST_CASE_ORDER,
     PROP_TEST_DIRECTORY,
     PROP_SOURCE_DIRECTORY,
     PROP_LOG_DIRECTORY,
+    PROP_SHARD_LOG,
+    PROP_TEST_INDEX_FILE,
     PROP_TARGET_TEST_CASE_NAMES,
     PROP_TARGET_TEST_NAMES,
     PROP_EXCLUDE_FILES,
@@ -117,7 +175,15 @@ enum
     PROP_FATAL_FAILURES,
     PROP_KEEP_OPENING_MODULES,
     PROP_ENABLE_CONVENIENCE_ATTRIBUTE_DEFINITION,
-    PROP_STOP_BEFORE_TEST
+    PROP_STOP_BEFORE_TEST,
+    PROP_KEEP_RESULTS,
+    PROP_ELAPSED_REGRESSION,
+    PROP_ELAPSED_REGRESSION_THRESHOLD,
+    PROP_BENCHMARK_FILTER,
+    PROP_BENCHMARK_MIN_TIME,
+    PROP_MEASURE_RESOURCE_USAGE,
+    PROP_MEASURE_PHASES,
+    PROP_FULL_MEMORY_DUMP
 };
 
 enum
@@ -135,6 +201,7 @@ enum
     START_ITERATED_TEST,
 
     PASS_ASSERTION,
+    PASS_ASSERTIONS,
 
     SUCCESS_TEST,
     FAILURE_TEST,
@@ -188,6 +255,9 @@ static GQuark detail_delegate;
 
 static void runner_init (CutRunnerIface *iface);
 
+static GPrivate current_bucket_index_private = G_PRIVATE_INIT(NULL);
+static volatile gint n_bucket_threads = 0;
+
 G_DEFINE_ABSTRACT_TYPE_WITH_CODE(CutRunContext, cut_run_context, G_TYPE_OBJECT,
                                  G_IMPLEMENT_INTERFACE(CUT_TYPE_RUNNER,
                                                        runner_init));
@@ -214,6 +284,10 @@ static void start_test     (CutRunContext   *context,
 static void pass_assertion (CutRunContext   *context,
                             CutTest         *test,
                             CutTestContext  *test_context);
+static void pass_assertions(CutRunContext   *context,
+                            CutTest         *test,
+                            CutTestContext  *test_context,
+                            guint            n_assertions);
 static void success_test   (CutRunContext   *context,
                             CutTest         *test,
                             CutTestContext  *test_context,
@@ -305,6 +379,7 @@ cut_run_context_class_init (CutRunContextClass *klass)
     klass->start_iterated_test = start_iterated_test;
     klass->start_test        = start_test;
     klass->pass_assertion    = pass_assertion;
+    klass->pass_assertions   = pass_assertions;
     klass->success_test      = success_test;
     klass->failure_test      = failure_test;
     klass->error_test        = error_test;
@@ -403,6 +478,30 @@ cut_run_context_class_init (CutRunContextClass *klass)
                             G_PARAM_READWRITE);
     g_object_class_install_property(gobject_class, PROP_MAX_THREADS, spec);
 
+    spec = g_param_spec_int("n-processes",
+                            "Number of worker processes",
+                            "How many worker processes run test cases "
+                            "concurrently (0 or 1 disables)",
+                            0, G_MAXINT32, 0,
+                            G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_N_PROCESSES, spec);
+
+    spec = g_param_spec_int("shard-index",
+                            "Shard index",
+                            "The index of the shard that is run "
+                            "(0 to shard-count - 1)",
+                            0, G_MAXINT32, 0,
+                            G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_SHARD_INDEX, spec);
+
+    spec = g_param_spec_int("shard-count",
+                            "Number of shards",
+                            "How many shards test cases are partitioned into "
+                            "(0 or 1 disables)",
+                            0, G_MAXINT32, 0,
+                            G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_SHARD_COUNT, spec);
+
     spec = g_param_spec_boolean("handle-signals",
                                 "Whether handle signals",
                                 "Whether the run context handles signals",
@@ -439,6 +538,22 @@ cut_run_context_class_init (CutRunContextClass *klass)
                                G_PARAM_READWRITE);
     g_object_class_install_property(gobject_class, PROP_LOG_DIRECTORY, spec);
 
+    spec = g_param_spec_string("shard-log",
+                               "Shard log",
+                               "The log file name that all shards use "
+                               "to partition test cases by elapsed time",
+                               NULL,
+                               G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_SHARD_LOG, spec);
+
+    spec = g_param_spec_string("test-index-file",
+                               "Test index file",
+                               "The file name in which symbols of "
+                               "test modules are cached",
+                               NULL,
+                               G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_TEST_INDEX_FILE, spec);
+
     spec = g_param_spec_pointer("target-test-case-names",
                                 "Test case names",
                                 "The names of the target test case",
@@ -505,6 +620,78 @@ cut_run_context_class_init (CutRunContextClass *klass)
                                     PROP_STOP_BEFORE_TEST,
                                     spec);
 
+    spec = g_param_spec_enum("keep-results",
+                             "Keep results",
+                             "Which results are kept until the run context "
+                             "is destroyed",
+                             CUT_TYPE_KEEP_RESULTS,
+                             CUT_KEEP_RESULTS_ALL,
+                             G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_KEEP_RESULTS, spec);
+
+    spec = g_param_spec_enum("elapsed-regression",
+                             "Elapsed regression",
+                             "How a test that is slower than previous runs "
+                             "is reported",
+                             CUT_TYPE_ELAPSED_REGRESSION,
+                             CUT_ELAPSED_REGRESSION_NONE,
+                             G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_ELAPSED_REGRESSION,
+                                    spec);
+
+    spec = g_param_spec_double("elapsed-regression-threshold",
+                               "Elapsed regression threshold",
+                               "The number of scaled MADs that a test can be "
+                               "slower than the median of previous runs",
+                               0.0, G_MAXDOUBLE,
+                               CUT_ELAPSED_REGRESSION_THRESHOLD_DEFAULT,
+                               G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class,
+                                    PROP_ELAPSED_REGRESSION_THRESHOLD,
+                                    spec);
+
+    spec = g_param_spec_pointer("benchmark-filter",
+                                "Benchmark filter",
+                                "The names of the benchmarks to be measured",
+                                G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_BENCHMARK_FILTER,
+                                    spec);
+
+    spec = g_param_spec_double("benchmark-min-time",
+                               "Benchmark minimum time",
+                               "The minimum time in seconds to measure "
+                               "a benchmark",
+                               0.0, G_MAXDOUBLE,
+                               CUT_BENCHMARK_MIN_TIME_DEFAULT,
+                               G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_BENCHMARK_MIN_TIME,
+                                    spec);
+
+    spec = g_param_spec_boolean("measure-resource-usage",
+                                "Measure resource usage",
+                                "Whether measure resources used by each test",
+                                FALSE,
+                                G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_MEASURE_RESOURCE_USAGE,
+                                    spec);
+
+    spec = g_param_spec_boolean("measure-phases",
+                                "Measure phases",
+                                "Whether measure elapsed time of each phase: "
+                                "startup, shutdown, data setup, setup, "
+                                "test and teardown",
+                                FALSE,
+                                G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_MEASURE_PHASES, spec);
+
+    spec = g_param_spec_boolean("full-memory-dump",
+                                "Full memory dump",
+                                "Whether show whole memories instead of "
+                                "differences on memory assertion failures",
+                                FALSE,
+                                G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_FULL_MEMORY_DUMP, spec);
+
     signals[START_RUN]
         = g_signal_new("start-run",
                        G_TYPE_FROM_CLASS(klass),
@@ -598,6 +785,16 @@ cut_run_context_class_init (CutRunContextClass *klass)
                         _gcut_marshal_VOID__OBJECT_OBJECT,
                         G_TYPE_NONE, 2, CUT_TYPE_TEST, CUT_TYPE_TEST_CONTEXT);
 
+    signals[PASS_ASSERTIONS]
+        = g_signal_new ("pass-assertions",
+                        G_TYPE_FROM_CLASS (klass),
+                        G_SIGNAL_RUN_LAST | G_SIGNAL_DETAILED,
+                        G_STRUCT_OFFSET (CutRunContextClass, pass_assertions),
+                        NULL, NULL,
+                        _gcut_marshal_VOID__OBJECT_OBJECT_UINT,
+                        G_TYPE_NONE, 3,
+                        CUT_TYPE_TEST, CUT_TYPE_TEST_CONTEXT, G_TYPE_UINT);
+
     signals[SUCCESS_TEST]
         = g_signal_new ("success-test",
                         G_TYPE_FROM_CLASS (klass),
@@ -947,15 +1144,20 @@ static void
 cut_run_context_init (CutRunContext *context)
 {
     CutRunContextPrivate *priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
+    gint i;
 
-    priv->n_tests = 0;
-    priv->n_assertions = 0;
-    priv->n_successes = 0;
-    priv->n_failures = 0;
-    priv->n_errors = 0;
-    priv->n_pendings = 0;
-    priv->n_notifications = 0;
-    priv->n_omissions = 0;
+    for (i = 0; i < N_COUNTERS; i++) {
+        priv->counters[i] = 0;
+    }
+    for (i = 0; i < N_RESULT_BUCKETS; i++) {
+        ResultBucket *bucket;
+
+        bucket = g_new0(ResultBucket, 1);
+        bucket->mutex = g_mutex_new();
+        bucket->results = NULL;
+        priv->buckets[i] = bucket;
+    }
+    priv->n_registered_results = 0;
     priv->elapsed = 0.0;
     priv->timer = NULL;
     priv->results = NULL;
@@ -963,12 +1165,19 @@ cut_run_context_init (CutRunContext *context)
     priv->use_multi_thread = FALSE;
     priv->is_multi_thread = FALSE;
     priv->max_threads = 10;
+    priv->n_processes = 0;
+    priv->shard_index = 0;
+    priv->shard_count = 0;
     priv->handle_signals = TRUE;
     priv->mutex = g_mutex_new();
+    priv->scheduler = NULL;
     priv->crashed = FALSE;
     priv->test_directory = NULL;
     priv->source_directory = NULL;
     priv->log_directory = NULL;
+    priv->test_history = NULL;
+    priv->shard_log = NULL;
+    priv->test_index_file = NULL;
     priv->exclude_files = NULL;
     priv->exclude_directories = NULL;
     priv->target_test_case_names = NULL;
@@ -983,6 +1192,15 @@ cut_run_context_init (CutRunContext *context)
     priv->keep_opening_modules = FALSE;
     priv->enable_convenience_attribute_definition = FALSE;
     priv->stop_before_test = FALSE;
+    priv->keep_results = CUT_KEEP_RESULTS_ALL;
+    priv->elapsed_regression = CUT_ELAPSED_REGRESSION_NONE;
+    priv->elapsed_regression_threshold =
+        CUT_ELAPSED_REGRESSION_THRESHOLD_DEFAULT;
+    priv->benchmark_filter = NULL;
+    priv->benchmark_min_time = CUT_BENCHMARK_MIN_TIME_DEFAULT;
+    priv->measure_resource_usage = FALSE;
+    priv->measure_phases = FALSE;
+    priv->full_memory_dump = FALSE;
 }
 
 static void
@@ -992,16 +1210,36 @@ remove_listener (CutListener *listener, CutRunContext *context)
     g_object_unref(listener);
 }
 
+static void
+bucket_result_free (BucketResult *bucket_result)
+{
+    g_object_unref(bucket_result->result);
+    g_slice_free(BucketResult, bucket_result);
+}
+
 static void
 dispose (GObject *object)
 {
     CutRunContextPrivate *priv = CUT_RUN_CONTEXT_GET_PRIVATE(object);
+    gint i;
 
     if (priv->timer) {
         g_timer_destroy(priv->timer);
         priv->timer = NULL;
     }
 
+    for (i = 0; i < N_RESULT_BUCKETS; i++) {
+        ResultBucket *bucket = priv->buckets[i];
+
+        if (!bucket)
+            continue;
+        g_list_foreach(bucket->results, (GFunc)bucket_result_free, NULL);
+        g_list_free(bucket->results);
+        g_mutex_free(bucket->mutex);
+        g_free(bucket);
+        priv->buckets[i] = NULL;
+    }
+
     if (priv->results) {
         g_list_foreach(priv->results, (GFunc)g_object_unref, NULL);
         g_list_free(priv->results);
@@ -1013,6 +1251,16 @@ dispose (GObject *object)
         priv->reversed_results = NULL;
     }
 
+    if (priv->scheduler) {
+        cut_scheduler_free(priv->scheduler);
+        priv->scheduler = NULL;
+    }
+
+    if (priv->test_history) {
+        cut_test_history_free(priv->test_history);
+        priv->test_history = NULL;
+    }
+
     if (priv->mutex) {
         g_mutex_free(priv->mutex);
         priv->mutex = NULL;
@@ -1039,6 +1287,12 @@ dispose (GObject *object)
     g_free(priv->log_directory);
     priv->log_directory = NULL;
 
+    g_free(priv->shard_log);
+    priv->shard_log = NULL;
+
+    g_free(priv->test_index_file);
+    priv->test_index_file = NULL;
+
     g_free(priv->test_directory);
     priv->test_directory = NULL;
 
@@ -1054,6 +1308,9 @@ dispose (GObject *object)
     g_strfreev(priv->target_test_names);
     priv->target_test_names = NULL;
 
+    g_strfreev(priv->benchmark_filter);
+    priv->benchmark_filter = NULL;
+
     g_list_foreach(priv->loader_customizers, (GFunc)g_object_unref, NULL);
     g_list_free(priv->loader_customizers);
     priv->loader_customizers = NULL;
@@ -1064,6 +1321,142 @@ dispose (GObject *object)
     G_OBJECT_CLASS(cut_run_context_parent_class)->dispose(object);
 }
 
+static ResultBucket *
+get_current_bucket (CutRunContextPrivate *priv)
+{
+    gint index;
+
+    index = GPOINTER_TO_INT(g_private_get(&current_bucket_index_private));
+    if (index == 0) {
+        index = g_atomic_int_add(&n_bucket_threads, 1) % N_RESULT_BUCKETS + 1;
+        g_private_set(&current_bucket_index_private, GINT_TO_POINTER(index));
+    }
+
+    return priv->buckets[index - 1];
+}
+
+static guint
+get_counter (CutRunContextPrivate *priv, Counter counter)
+{
+    guint count;
+    gint i;
+
+    count = priv->counters[counter];
+    for (i = 0; i < N_RESULT_BUCKETS; i++) {
+        count += g_atomic_int_get(&(priv->buckets[i]->counters[counter]));
+    }
+
+    return count;
+}
+
+static void
+set_counter (CutRunContextPrivate *priv, Counter counter, guint count)
+{
+    gint i;
+
+    priv->counters[counter] = count;
+    for (i = 0; i < N_RESULT_BUCKETS; i++) {
+        g_atomic_int_set(&(priv->buckets[i]->counters[counter]), 0);
+    }
+}
+
+static void
+increment_counter (CutRunContextPrivate *priv, Counter counter)
+{
+    g_atomic_int_inc(&(get_current_bucket(priv)->counters[counter]));
+}
+
+static void
+add_counter (CutRunContextPrivate *priv, Counter counter, guint n)
+{
+    g_atomic_int_add(&(get_current_bucket(priv)->counters[counter]), n);
+}
+
+static gboolean
+need_to_keep_result (CutRunContextPrivate *priv, CutTestResult *result)
+{
+    switch (priv->keep_results) {
+    case CUT_KEEP_RESULTS_FAILURES:
+        return cut_test_result_get_status(result) != CUT_TEST_RESULT_SUCCESS;
+    case CUT_KEEP_RESULTS_NONE:
+        return FALSE;
+    default:
+        return TRUE;
+    }
+}
+
+static void
+register_result (CutRunContextPrivate *priv, CutTestResult *result,
+                 gint counter)
+{
+    ResultBucket *bucket;
+    BucketResult *bucket_result;
+
+    bucket = get_current_bucket(priv);
+    if (!need_to_keep_result(priv, result)) {
+        if (counter >= 0)
+            g_atomic_int_inc(&(bucket->counters[counter]));
+        return;
+    }
+
+    bucket_result = g_slice_new(BucketResult);
+    bucket_result->result = g_object_ref(result);
+    g_mutex_lock(bucket->mutex);
+    bucket_result->sequence = g_atomic_int_add(&(priv->n_registered_results), 1);
+    bucket->results = g_list_prepend(bucket->results, bucket_result);
+    g_mutex_unlock(bucket->mutex);
+    if (counter >= 0)
+        g_atomic_int_inc(&(bucket->counters[counter]));
+}
+
+static gint
+compare_bucket_result (gconstpointer a, gconstpointer b)
+{
+    const BucketResult *result1 = a;
+    const BucketResult *result2 = b;
+
+    if (result1->sequence < result2->sequence)
+        return -1;
+    else if (result1->sequence > result2->sequence)
+        return 1;
+    else
+        return 0;
+}
+
+/*
+ * Must be called with priv->mutex locked. All buckets are
+ * locked while they are merged. So no result registered
+ * after that has smaller sequence than merged results.
+ */
+static void
+merge_bucket_results (CutRunContextPrivate *priv)
+{
+    GList *bucket_results = NULL, *node;
+    gint i;
+
+    for (i = 0; i < N_RESULT_BUCKETS; i++) {
+        g_mutex_lock(priv->buckets[i]->mutex);
+    }
+    for (i = 0; i < N_RESULT_BUCKETS; i++) {
+        ResultBucket *bucket = priv->buckets[i];
+
+        bucket_results = g_list_concat(bucket->results, bucket_results);
+        bucket->results = NULL;
+    }
+    for (i = N_RESULT_BUCKETS - 1; i >= 0; i--) {
+        g_mutex_unlock(priv->buckets[i]->mutex);
+    }
+
+    bucket_results = g_list_sort(bucket_results, compare_bucket_result);
+    for (node = bucket_results; node; node = g_list_next(node)) {
+        BucketResult *bucket_result = node->data;
+
+        priv->results = g_list_prepend(priv->results, bucket_result->result);
+        g_slice_free(BucketResult, bucket_result);
+    }
+    g_list_free(bucket_results);
+}
+
 static void
 set_property (GObject      *object,
               guint         prop_id,
@@ -1074,28 +1467,28 @@ set_property (GObject      *object,
 
     switch (prop_id) {
       case PROP_N_TESTS:
-        priv->n_tests = g_value_get_uint(value);
+        set_counter(priv, COUNTER_TESTS, g_value_get_uint(value));
         break;
       case PROP_N_ASSERTIONS:
-        priv->n_assertions = g_value_get_uint(value);
+        set_counter(priv, COUNTER_ASSERTIONS, g_value_get_uint(value));
         break;
       case PROP_N_SUCCESSES:
-        priv->n_successes = g_value_get_uint(value);
+        set_counter(priv, COUNTER_SUCCESSES, g_value_get_uint(value));
         break;
       case PROP_N_FAILURES:
-        priv->n_failures = g_value_get_uint(value);
+        set_counter(priv, COUNTER_FAILURES, g_value_get_uint(value));
         break;
       case PROP_N_ERRORS:
-        priv->n_errors = g_value_get_uint(value);
+        set_counter(priv, COUNTER_ERRORS, g_value_get_uint(value));
         break;
       case PROP_N_PENDINGS:
-        priv->n_pendings = g_value_get_uint(value);
+        set_counter(priv, COUNTER_PENDINGS, g_value_get_uint(value));
         break;
       case PROP_N_NOTIFICATIONS:
-        priv->n_notifications = g_value_get_uint(value);
+        set_counter(priv, COUNTER_NOTIFICATIONS, g_value_get_uint(value));
         break;
       case PROP_N_OMISSIONS:
-        priv->n_omissions = g_value_get_uint(value);
+        set_counter(priv, COUNTER_OMISSIONS, g_value_get_uint(value));
         break;
       case PROP_USE_MULTI_THREAD:
         priv->use_multi_thread = g_value_get_boolean(value);
@@ -1106,6 +1499,15 @@ set_property (GObject      *object,
       case PROP_MAX_THREADS:
         priv->max_threads = g_value_get_int(value);
         break;
+      case PROP_N_PROCESSES:
+        priv->n_processes = g_value_get_int(value);
+        break;
+      case PROP_SHARD_INDEX:
+        priv->shard_index = g_value_get_int(value);
+        break;
+      case PROP_SHARD_COUNT:
+        priv->shard_count = g_value_get_int(value);
+        break;
       case PROP_HANDLE_SIGNALS:
         priv->handle_signals = g_value_get_boolean(value);
         break;
@@ -1121,6 +1523,14 @@ set_property (GObject      *object,
       case PROP_LOG_DIRECTORY:
         priv->log_directory = g_value_dup_string(value);
         break;
+      case PROP_SHARD_LOG:
+        cut_run_context_set_shard_log(CUT_RUN_CONTEXT(object),
+                                      g_value_get_string(value));
+        break;
+      case PROP_TEST_INDEX_FILE:
+        cut_run_context_set_test_index_file(CUT_RUN_CONTEXT(object),
+                                            g_value_get_string(value));
+        break;
       case PROP_TARGET_TEST_CASE_NAMES:
         priv->target_test_case_names = g_strdupv(g_value_get_pointer(value));
         break;
@@ -1148,6 +1558,31 @@ set_property (GObject      *object,
       case PROP_STOP_BEFORE_TEST:
         priv->stop_before_test = g_value_get_boolean(value);
         break;
+      case PROP_KEEP_RESULTS:
+        priv->keep_results = g_value_get_enum(value);
+        break;
+      case PROP_ELAPSED_REGRESSION:
+        priv->elapsed_regression = g_value_get_enum(value);
+        break;
+      case PROP_ELAPSED_REGRESSION_THRESHOLD:
+        priv->elapsed_regression_threshold = g_value_get_double(value);
+        break;
+      case PROP_BENCHMARK_FILTER:
+        cut_run_context_set_benchmark_filter(CUT_RUN_CONTEXT(object),
+                                             g_value_get_pointer(value));
+        break;
+      case PROP_BENCHMARK_MIN_TIME:
+        priv->benchmark_min_time = g_value_get_double(value);
+        break;
+      case PROP_MEASURE_RESOURCE_USAGE:
+        priv->measure_resource_usage = g_value_get_boolean(value);
+        break;
+      case PROP_MEASURE_PHASES:
+        priv->measure_phases = g_value_get_boolean(value);
+        break;
+      case PROP_FULL_MEMORY_DUMP:
+        priv->full_memory_dump = g_value_get_boolean(value);
+        break;
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -1164,28 +1599,28 @@ get_property (GObject    *object,
 
     switch (prop_id) {
       case PROP_N_TESTS:
-        g_value_set_uint(value, priv->n_tests);
+        g_value_set_uint(value, get_counter(priv, COUNTER_TESTS));
         break;
       case PROP_N_ASSERTIONS:
-        g_value_set_uint(value, priv->n_assertions);
+        g_value_set_uint(value, get_counter(priv, COUNTER_ASSERTIONS));
         break;
       case PROP_N_SUCCESSES:
-        g_value_set_uint(value, priv->n_successes);
+        g_value_set_uint(value, get_counter(priv, COUNTER_SUCCESSES));
         break;
       case PROP_N_FAILURES:
-        g_value_set_uint(value, priv->n_failures);
+        g_value_set_uint(value, get_counter(priv, COUNTER_FAILURES));
         break;
       case PROP_N_ERRORS:
-        g_value_set_uint(value, priv->n_errors);
+        g_value_set_uint(value, get_counter(priv, COUNTER_ERRORS));
         break;
       case PROP_N_PENDINGS:
-        g_value_set_uint(value, priv->n_pendings);
+        g_value_set_uint(value, get_counter(priv, COUNTER_PENDINGS));
         break;
       case PROP_N_NOTIFICATIONS:
-        g_value_set_uint(value, priv->n_notifications);
+        g_value_set_uint(value, get_counter(priv, COUNTER_NOTIFICATIONS));
         break;
       case PROP_N_OMISSIONS:
-        g_value_set_uint(value, priv->n_omissions);
+        g_value_set_uint(value, get_counter(priv, COUNTER_OMISSIONS));
         break;
       case PROP_USE_MULTI_THREAD:
         g_value_set_boolean(value, priv->use_multi_thread);
@@ -1196,6 +1631,15 @@ get_property (GObject    *object,
       case PROP_MAX_THREADS:
         g_value_set_int(value, priv->max_threads);
         break;
+      case PROP_N_PROCESSES:
+        g_value_set_int(value, priv->n_processes);
+        break;
+      case PROP_SHARD_INDEX:
+        g_value_set_int(value, priv->shard_index);
+        break;
+      case PROP_SHARD_COUNT:
+        g_value_set_int(value, priv->shard_count);
+        break;
       case PROP_HANDLE_SIGNALS:
         g_value_set_boolean(value, priv->handle_signals);
         break;
@@ -1211,6 +1655,12 @@ get_property (GObject    *object,
       case PROP_LOG_DIRECTORY:
         g_value_set_string(value, priv->log_directory);
         break;
+      case PROP_SHARD_LOG:
+        g_value_set_string(value, priv->shard_log);
+        break;
+      case PROP_TEST_INDEX_FILE:
+        g_value_set_string(value, priv->test_index_file);
+        break;
       case PROP_TARGET_TEST_CASE_NAMES:
         g_value_set_pointer(value, priv->target_test_case_names);
         break;
@@ -1238,6 +1688,30 @@ get_property (GObject    *object,
       case PROP_STOP_BEFORE_TEST:
         g_value_set_boolean(value, priv->stop_before_test);
         break;
+      case PROP_KEEP_RESULTS:
+        g_value_set_enum(value, priv->keep_results);
+        break;
+      case PROP_ELAPSED_REGRESSION:
+        g_value_set_enum(value, priv->elapsed_regression);
+        break;
+      case PROP_ELAPSED_REGRESSION_THRESHOLD:
+        g_value_set_double(value, priv->elapsed_regression_threshold);
+        break;
+      case PROP_BENCHMARK_FILTER:
+        g_value_set_pointer(value, priv->benchmark_filter);
+        break;
+      case PROP_BENCHMARK_MIN_TIME:
+        g_value_set_double(value, priv->benchmark_min_time);
+        break;
+      case PROP_MEASURE_RESOURCE_USAGE:
+        g_value_set_boolean(value, priv->measure_resource_usage);
+        break;
+      case PROP_MEASURE_PHASES:
+        g_value_set_boolean(value, priv->measure_phases);
+        break;
+      case PROP_FULL_MEMORY_DUMP:
+        g_value_set_boolean(value, priv->full_memory_dump);
+        break;
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -1282,9 +1756,7 @@ start_test (CutRunContext   *context,
     CutRunContextPrivate *priv;
 
     priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
-    g_mutex_lock(priv->mutex);
-    priv->n_tests++;
-    g_mutex_unlock(priv->mutex);
+    increment_counter(priv, COUNTER_TESTS);
 }
 
 static void
@@ -1295,9 +1767,7 @@ start_iterated_test (CutRunContext   *context,
     CutRunContextPrivate *priv;
 
     priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
-    g_mutex_lock(priv->mutex);
-    priv->n_tests++;
-    g_mutex_unlock(priv->mutex);
+    increment_counter(priv, COUNTER_TESTS);
 }
 
 static void
@@ -1308,9 +1778,19 @@ pass_assertion (CutRunContext   *context,
     CutRunContextPrivate *priv;
 
     priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
-    g_mutex_lock(priv->mutex);
-    priv->n_assertions++;
-    g_mutex_unlock(priv->mutex);
+    increment_counter(priv, COUNTER_ASSERTIONS);
+}
+
+static void
+pass_assertions (CutRunContext   *context,
+                 CutTest         *test,
+                 CutTestContext  *test_context,
+                 guint            n_assertions)
+{
+    CutRunContextPrivate *priv;
+
+    priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
+    add_counter(priv, COUNTER_ASSERTIONS, n_assertions);
 }
 
 static void
@@ -1319,10 +1799,7 @@ register_success_result (CutRunContext *context, CutTestResult *result)
     CutRunContextPrivate *priv;
 
     priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
-    g_mutex_lock(priv->mutex);
-    priv->results = g_list_prepend(priv->results, g_object_ref(result));
-    priv->n_successes++;
-    g_mutex_unlock(priv->mutex);
+    register_result(priv, result, COUNTER_SUCCESSES);
 }
 
 static void
@@ -1330,10 +1807,7 @@ register_failure_result (CutRunContext *context, CutTestResult *result)
 {
     CutRunContextPrivate *priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
 
-    g_mutex_lock(priv->mutex);
-    priv->results = g_list_prepend(priv->results, g_object_ref(result));
-    priv->n_failures++;
-    g_mutex_unlock(priv->mutex);
+    register_result(priv, result, COUNTER_FAILURES);
 }
 
 static void
@@ -1342,10 +1816,7 @@ register_error_result (CutRunContext *context, CutTestResult *result)
     CutRunContextPrivate *priv;
 
     priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
-    g_mutex_lock(priv->mutex);
-    priv->results = g_list_prepend(priv->results, g_object_ref(result));
-    priv->n_errors++;
-    g_mutex_unlock(priv->mutex);
+    register_result(priv, result, COUNTER_ERRORS);
 }
 
 static void
@@ -1354,10 +1825,7 @@ register_pending_result (CutRunContext *context, CutTestResult *result)
     CutRunContextPrivate *priv;
 
     priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
-    g_mutex_lock(priv->mutex);
-    priv->results = g_list_prepend(priv->results, g_object_ref(result));
-    priv->n_pendings++;
-    g_mutex_unlock(priv->mutex);
+    register_result(priv, result, COUNTER_PENDINGS);
 }
 
 static void
@@ -1366,10 +1834,7 @@ register_notification_result (CutRunContext  *context, CutTestResult *result)
     CutRunContextPrivate *priv;
 
     priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
-    g_mutex_lock(priv->mutex);
-    priv->results = g_list_prepend(priv->results, g_object_ref(result));
-    priv->n_notifications++;
-    g_mutex_unlock(priv->mutex);
+    register_result(priv, result, COUNTER_NOTIFICATIONS);
 }
 
 static void
@@ -1378,10 +1843,7 @@ register_omission_result (CutRunContext *context, CutTestResult *result)
     CutRunContextPrivate *priv;
 
     priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
-    g_mutex_lock(priv->mutex);
-    priv->results = g_list_prepend(priv->results, g_object_ref(result));
-    priv->n_omissions++;
-    g_mutex_unlock(priv->mutex);
+    register_result(priv, result, COUNTER_OMISSIONS);
 }
 
 static void
@@ -1391,9 +1853,7 @@ register_crash_result (CutRunContext *context, CutTestResult *result)
 
     priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
     priv->crashed = TRUE;
-    g_mutex_lock(priv->mutex);
-    priv->results = g_list_prepend(priv->results, g_object_ref(result));
-    g_mutex_unlock(priv->mutex);
+    register_result(priv, result, -1);
 }
 
 static void
@@ -1552,6 +2012,7 @@ complete_run (CutRunContext *context, gboolean success)
     g_mutex_lock(priv->mutex);
     if (priv->timer)
         g_timer_stop(priv->timer);
+    merge_bucket_results(priv);
     priv->completed = TRUE;
     g_mutex_unlock(priv->mutex);
 }
@@ -1597,6 +2058,11 @@ cut_run_context_set_log_directory (CutRunContext *context,
 
     g_free(priv->log_directory);
     priv->log_directory = g_strdup(directory);
+
+    if (priv->test_history) {
+        cut_test_history_free(priv->test_history);
+        priv->test_history = NULL;
+    }
 }
 
 const gchar *
@@ -1605,6 +2071,37 @@ cut_run_context_get_log_directory (CutRunContext *context)
     return CUT_RUN_CONTEXT_GET_PRIVATE(context)->log_directory;
 }
 
+void
+cut_run_context_set_shard_log (CutRunContext *context, const gchar *file_name)
+{
+    CutRunContextPrivate *priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
+
+    g_free(priv->shard_log);
+    priv->shard_log = g_strdup(file_name);
+}
+
+const gchar *
+cut_run_context_get_shard_log (CutRunContext *context)
+{
+    return CUT_RUN_CONTEXT_GET_PRIVATE(context)->shard_log;
+}
+
+void
+cut_run_context_set_test_index_file (CutRunContext *context,
+                                     const gchar *file_name)
+{
+    CutRunContextPrivate *priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
+
+    g_free(priv->test_index_file);
+    priv->test_index_file = g_strdup(file_name);
+}
+
+const gchar *
+cut_run_context_get_test_index_file (CutRunContext *context)
+{
+    return CUT_RUN_CONTEXT_GET_PRIVATE(context)->test_index_file;
+}
+
 void
 cut_run_context_set_multi_thread (CutRunContext *context,
                                   gboolean use_multi_thread)
@@ -1644,6 +2141,56 @@ cut_run_context_get_max_threads (CutRunContext *context)
     return CUT_RUN_CONTEXT_GET_PRIVATE(context)->max_threads;
 }
 
+CutScheduler *
+cut_run_context_get_scheduler (CutRunContext *context)
+{
+    CutRunContextPrivate *priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
+    CutScheduler *scheduler;
+
+    g_mutex_lock(priv->mutex);
+    if (!priv->scheduler)
+        priv->scheduler = cut_scheduler_new(priv->max_threads);
+    scheduler = priv->scheduler;
+    g_mutex_unlock(priv->mutex);
+
+    return scheduler;
+}
+
+void
+cut_run_context_set_n_processes (CutRunContext *context, gint n_processes)
+{
+    CutRunContextPrivate *priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
+
+    priv->n_processes = n_processes;
+}
+
+gint
+cut_run_context_get_n_processes (CutRunContext *context)
+{
+    return CUT_RUN_CONTEXT_GET_PRIVATE(context)->n_processes;
+}
+
+void
+cut_run_context_set_shard (CutRunContext *context, gint index, gint count)
+{
+    CutRunContextPrivate *priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
+
+    priv->shard_index = index;
+    priv->shard_count = count;
+}
+
+gint
+cut_run_context_get_shard_index (CutRunContext *context)
+{
+    return CUT_RUN_CONTEXT_GET_PRIVATE(context)->shard_index;
+}
+
+gint
+cut_run_context_get_shard_count (CutRunContext *context)
+{
+    return CUT_RUN_CONTEXT_GET_PRIVATE(context)->shard_count;
+}
+
 void
 cut_run_context_set_handle_signals (CutRunContext *context,
                                     gboolean handle_signals)
@@ -1745,49 +2292,57 @@ cut_run_context_get_loader_customizers (CutRunContext *context)
 guint
 cut_run_context_get_n_tests (CutRunContext *context)
 {
-    return CUT_RUN_CONTEXT_GET_PRIVATE(context)->n_tests;
+    return get_counter(CUT_RUN_CONTEXT_GET_PRIVATE(context),
+                       COUNTER_TESTS);
 }
 
 guint
 cut_run_context_get_n_assertions (CutRunContext *context)
 {
-    return CUT_RUN_CONTEXT_GET_PRIVATE(context)->n_assertions;
+    return get_counter(CUT_RUN_CONTEXT_GET_PRIVATE(context),
+                       COUNTER_ASSERTIONS);
 }
 
 guint
 cut_run_context_get_n_successes (CutRunContext *context)
 {
-    return CUT_RUN_CONTEXT_GET_PRIVATE(context)->n_successes;
+    return get_counter(CUT_RUN_CONTEXT_GET_PRIVATE(context),
+                       COUNTER_SUCCESSES);
 }
 
 guint
 cut_run_context_get_n_failures (CutRunContext *context)
 {
-    return CUT_RUN_CONTEXT_GET_PRIVATE(context)->n_failures;
+    return get_counter(CUT_RUN_CONTEXT_GET_PRIVATE(context),
+                       COUNTER_FAILURES);
 }
 
 guint
 cut_run_context_get_n_errors (CutRunContext *context)
 {
-    return CUT_RUN_CONTEXT_GET_PRIVATE(context)->n_errors;
+    return get_counter(CUT_RUN_CONTEXT_GET_PRIVATE(context),
+                       COUNTER_ERRORS);
 }
 
 guint
 cut_run_context_get_n_pendings (CutRunContext *context)
 {
-    return CUT_RUN_CONTEXT_GET_PRIVATE(context)->n_pendings;
+    return get_counter(CUT_RUN_CONTEXT_GET_PRIVATE(context),
+                       COUNTER_PENDINGS);
 }
 
 guint
 cut_run_context_get_n_notifications (CutRunContext *context)
 {
-    return CUT_RUN_CONTEXT_GET_PRIVATE(context)->n_notifications;
+    return get_counter(CUT_RUN_CONTEXT_GET_PRIVATE(context),
+                       COUNTER_NOTIFICATIONS);
 }
 
 guint
 cut_run_context_get_n_omissions (CutRunContext *context)
 {
-    return CUT_RUN_CONTEXT_GET_PRIVATE(context)->n_omissions;
+    return get_counter(CUT_RUN_CONTEXT_GET_PRIVATE(context),
+                       COUNTER_OMISSIONS);
 }
 
 CutTestResultStatus
@@ -1800,15 +2355,15 @@ cut_run_context_get_status (CutRunContext *context)
 
     if (priv->crashed) {
         status = CUT_TEST_RESULT_CRASH;
-    } else if (priv->n_errors > 0) {
+    } else if (get_counter(priv, COUNTER_ERRORS) > 0) {
         status = CUT_TEST_RESULT_ERROR;
-    } else if (priv->n_failures > 0) {
+    } else if (get_counter(priv, COUNTER_FAILURES) > 0) {
         status = CUT_TEST_RESULT_FAILURE;
-    } else if (priv->n_pendings > 0) {
+    } else if (get_counter(priv, COUNTER_PENDINGS) > 0) {
         status = CUT_TEST_RESULT_PENDING;
-    } else if (priv->n_omissions > 0) {
+    } else if (get_counter(priv, COUNTER_OMISSIONS) > 0) {
         status = CUT_TEST_RESULT_OMISSION;
-    } else if (priv->n_notifications > 0) {
+    } else if (get_counter(priv, COUNTER_NOTIFICATIONS) > 0) {
         status = CUT_TEST_RESULT_NOTIFICATION;
     } else {
         status = CUT_TEST_RESULT_SUCCESS;
@@ -1841,10 +2396,13 @@ cut_run_context_get_results (CutRunContext *context)
     CutRunContextPrivate *priv;
 
     priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
+    g_mutex_lock(priv->mutex);
+    merge_bucket_results(priv);
     if (priv->reversed_results)
         g_list_free(priv->reversed_results);
 
     priv->reversed_results = g_list_reverse(g_list_copy(priv->results));
+    g_mutex_unlock(priv->mutex);
     return priv->reversed_results;
 }
 
@@ -1884,6 +2442,14 @@ cut_run_context_create_test_suite (CutRunContext *context)
                                             priv->keep_opening_modules);
     cut_repository_set_enable_convenience_attribute_definition(repository,
                                                                priv->enable_convenience_attribute_definition);
+    cut_repository_set_test_index_file(repository, priv->test_index_file);
+    cut_repository_set_max_threads(repository,
+                                   priv->use_multi_thread ?
+                                   priv->max_threads : 1);
+    cut_repository_set_target_test_case_names(
+        repository, (const gchar **)priv->target_test_case_names);
+    cut_repository_set_target_test_names(
+        repository, (const gchar **)priv->target_test_names);
     exclude_files = (const gchar **)priv->exclude_files;
     cut_repository_set_exclude_files(repository, exclude_files);
     exclude_directories = (const gchar **)priv->exclude_directories;
@@ -2023,10 +2589,409 @@ compare_test_cases_by_name (gconstpointer a, gconstpointer b, gpointer user_data
         return strcmp(test_case_name2, test_case_name1);
 }
 
+/* The number of the latest logs used to estimate elapsed time. */
+#define TEST_HISTORY_MAX_RUNS 10
+
+CutTestHistory *
+cut_run_context_get_test_history (CutRunContext *context)
+{
+    CutRunContextPrivate *priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
+    CutTestHistory *history;
+
+    g_mutex_lock(priv->mutex);
+    if (!priv->test_history) {
+        priv->test_history = cut_test_history_new();
+        if (priv->log_directory)
+            cut_test_history_load(priv->test_history, priv->log_directory,
+                                  TEST_HISTORY_MAX_RUNS, NULL);
+    }
+    history = priv->test_history;
+    g_mutex_unlock(priv->mutex);
+
+    return history;
+}
+
+/* Fewer runs don't give a meaningful spread. */
+#define ELAPSED_REGRESSION_MIN_RUNS 3
+/* 1.4826 * MAD estimates the standard deviation of normally
+ * distributed samples. The estimate is floored at a small
+ * part of the median and at 1ms so that identical or very
+ * short previous runs don't make any jitter a regression. */
+#define ELAPSED_REGRESSION_MAD_SCALE 1.4826
+#define ELAPSED_REGRESSION_MIN_SPREAD_RATIO 0.05
+#define ELAPSED_REGRESSION_MIN_SPREAD 0.001
+
+static gboolean
+parse_elapsed_regression (const gchar *value, CutElapsedRegression *regression)
+{
+    if (g_str_equal(value, "none")) {
+        *regression = CUT_ELAPSED_REGRESSION_NONE;
+    } else if (g_str_equal(value, "notification")) {
+        *regression = CUT_ELAPSED_REGRESSION_NOTIFICATION;
+    } else if (g_str_equal(value, "failure")) {
+        *regression = CUT_ELAPSED_REGRESSION_FAILURE;
+    } else {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+CutTestResultStatus
+cut_run_context_check_elapsed_regression (CutRunContext *context,
+                                          CutTest *test,
+                                          CutTestCase *test_case,
+                                          gchar **message)
+{
+    CutRunContextPrivate *priv;
+    CutElapsedRegression regression;
+    CutTestHistory *history;
+    const gchar *value;
+    const gchar *test_case_name = NULL;
+    gdouble threshold, elapsed, elapsed_median, elapsed_mad, spread, limit;
+    guint n_runs;
+
+    priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
+
+    regression = priv->elapsed_regression;
+    value = cut_test_get_attribute(test, "elapsed-regression");
+    if (value && !parse_elapsed_regression(value, &regression))
+        cut_log_warning("[run-context][elapsed-regression] "
+                        "invalid attribute value: <%s>: <%s>",
+                        cut_test_get_name(test), value);
+    if (regression == CUT_ELAPSED_REGRESSION_NONE)
+        return CUT_TEST_RESULT_SUCCESS;
+
+    threshold = priv->elapsed_regression_threshold;
+    value = cut_test_get_attribute(test, "elapsed-regression-threshold");
+    if (value) {
+        gchar *end;
+        gdouble parsed_threshold;
+
+        parsed_threshold = g_ascii_strtod(value, &end);
+        if (end != value && end[0] == '\0' && parsed_threshold >= 0.0)
+            threshold = parsed_threshold;
+        else
+            cut_log_warning("[run-context][elapsed-regression] "
+                            "invalid threshold attribute value: <%s>: <%s>",
+                            cut_test_get_name(test), value);
+    }
+
+    history = cut_run_context_get_test_history(context);
+    if (test_case)
+        test_case_name = cut_test_get_name(CUT_TEST(test_case));
+    if (CUT_IS_ITERATED_TEST(test)) {
+        CutTestData *data;
+
+        data = cut_iterated_test_get_data(CUT_ITERATED_TEST(test));
+        n_runs = cut_test_history_get_iterated_test_elapsed_baseline(
+            history,
+            test_case_name,
+            cut_test_get_name(test),
+            data ? cut_test_data_get_name(data) : NULL,
+            &elapsed_median,
+            &elapsed_mad);
+    } else {
+        n_runs = cut_test_history_get_test_elapsed_baseline(
+            history,
+            test_case_name,
+            cut_test_get_name(test),
+            &elapsed_median,
+            &elapsed_mad);
+    }
+    if (n_runs < ELAPSED_REGRESSION_MIN_RUNS)
+        return CUT_TEST_RESULT_SUCCESS;
+
+    spread = MAX(ELAPSED_REGRESSION_MAD_SCALE * elapsed_mad,
+                 ELAPSED_REGRESSION_MIN_SPREAD_RATIO * elapsed_median);
+    spread = MAX(spread, ELAPSED_REGRESSION_MIN_SPREAD);
+    limit = elapsed_median + threshold * spread;
+    elapsed = cut_test_get_elapsed(test);
+    if (elapsed <= limit)
+        return CUT_TEST_RESULT_SUCCESS;
+
+    *message = g_strdup_printf("elapsed time regression: "
+                               "%.6fs > %.6fs "
+                               "(median: %.6fs, MAD: %.6fs, runs: %u)",
+                               elapsed, limit,
+                               elapsed_median, elapsed_mad, n_runs);
+    if (regression == CUT_ELAPSED_REGRESSION_FAILURE)
+        return CUT_TEST_RESULT_FAILURE;
+    else
+        return CUT_TEST_RESULT_NOTIFICATION;
+}
+
+typedef struct _ElapsedSortItem
+{
+    CutTestCase *test_case;
+    const gchar *name;
+    gdouble elapsed;
+    gboolean have_elapsed;
+} ElapsedSortItem;
+
+static gint
+compare_elapsed_sort_items (gconstpointer a, gconstpointer b)
+{
+    const ElapsedSortItem *item1 = a;
+    const ElapsedSortItem *item2 = b;
+
+    /* Longest first. Test cases that have never been run go
+     * after known ones in name order. */
+    if (item1->have_elapsed && item2->have_elapsed) {
+        if (item1->elapsed > item2->elapsed)
+            return -1;
+        else if (item1->elapsed < item2->elapsed)
+            return 1;
+    } else if (item1->have_elapsed) {
+        return -1;
+    } else if (item2->have_elapsed) {
+        return 1;
+    }
+
+    return strcmp(item1->name, item2->name);
+}
+
+/*
+ * Each median needs a copy and a sort of the history
+ * samples. They are looked up once per test case here
+ * instead of once per comparison.
+ */
+static GList *
+sort_test_cases_by_elapsed (GList *test_cases, CutTestHistory *history)
+{
+    GArray *items;
+    GList *node, *sorted_test_cases = NULL;
+    guint i;
+
+    items = g_array_new(FALSE, FALSE, sizeof(ElapsedSortItem));
+    for (node = test_cases; node; node = g_list_next(node)) {
+        ElapsedSortItem item;
+
+        item.test_case = node->data;
+        item.name = cut_test_get_name(CUT_TEST(item.test_case));
+        item.elapsed = 0.0;
+        item.have_elapsed =
+            cut_test_history_get_test_case_elapsed(history, item.name,
+                                                   &(item.elapsed));
+        g_array_append_val(items, item);
+    }
+    g_list_free(test_cases);
+
+    g_array_sort(items, compare_elapsed_sort_items);
+    for (i = items->len; i > 0; i--) {
+        ElapsedSortItem *item = &g_array_index(items, ElapsedSortItem, i - 1);
+
+        sorted_test_cases = g_list_prepend(sorted_test_cases, item->test_case);
+    }
+    g_array_free(items, TRUE);
+
+    return sorted_test_cases;
+}
+
+typedef struct _ShardItem
+{
+    guint position;
+    const gchar *name;
+    gdouble weight;
+} ShardItem;
+
+static gint
+compare_double (gconstpointer a, gconstpointer b)
+{
+    gdouble value1 = *(const gdouble *)a;
+    gdouble value2 = *(const gdouble *)b;
+
+    if (value1 < value2)
+        return -1;
+    else if (value1 > value2)
+        return 1;
+    else
+        return 0;
+}
+
+/* FNV-1a: the result must not depend on GLib version or host
+ * because all shards of a suite must agree on it. */
+static guint32
+shard_hash (const gchar *name)
+{
+    guint32 hash = 2166136261U;
+
+    for (; *name; name++) {
+        hash ^= (guchar)*name;
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+static gint
+compare_shard_items (gconstpointer a, gconstpointer b)
+{
+    const ShardItem *item1 = a;
+    const ShardItem *item2 = b;
+
+    if (item1->weight > item2->weight)
+        return -1;
+    else if (item1->weight < item2->weight)
+        return 1;
+    else
+        return strcmp(item1->name, item2->name);
+}
+
+/*
+ * Assigns the heaviest test case to the least loaded shard
+ * first. Test cases that aren't in the history are weighted
+ * by the median of the known ones.
+ */
+static void
+assign_shards_by_elapsed (GArray *items, CutTestHistory *history,
+                          gint shard_count, gint *shards)
+{
+    GArray *known_weights;
+    gdouble default_weight = 0.0;
+    gdouble *loads;
+    guint i;
+
+    known_weights = g_array_new(FALSE, FALSE, sizeof(gdouble));
+    for (i = 0; i < items->len; i++) {
+        ShardItem *item = &g_array_index(items, ShardItem, i);
+
+        if (cut_test_history_get_test_case_elapsed(history, item->name,
+                                                   &(item->weight)))
+            g_array_append_val(known_weights, item->weight);
+        else
+            item->weight = -1.0;
+    }
+    if (known_weights->len > 0) {
+        g_array_sort(known_weights, compare_double);
+        default_weight = g_array_index(known_weights, gdouble,
+                                       known_weights->len / 2);
+    }
+    g_array_free(known_weights, TRUE);
+
+    for (i = 0; i < items->len; i++) {
+        ShardItem *item = &g_array_index(items, ShardItem, i);
+
+        if (item->weight < 0.0)
+            item->weight = default_weight;
+    }
+    g_array_sort(items, compare_shard_items);
+
+    loads = g_new0(gdouble, shard_count);
+    for (i = 0; i < items->len; i++) {
+        ShardItem *item = &g_array_index(items, ShardItem, i);
+        gint shard, lightest_shard = 0;
+
+        for (shard = 1; shard < shard_count; shard++) {
+            if (loads[shard] < loads[lightest_shard])
+                lightest_shard = shard;
+        }
+        loads[lightest_shard] += item->weight;
+        shards[item->position] = lightest_shard;
+    }
+    g_free(loads);
+}
+
+static gboolean
+has_test_case_history (CutTestHistory *history, GArray *items)
+{
+    guint i;
+
+    for (i = 0; i < items->len; i++) {
+        ShardItem *item = &g_array_index(items, ShardItem, i);
+        gdouble elapsed;
+
+        if (cut_test_history_get_test_case_elapsed(history, item->name,
+                                                   &elapsed))
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+/*
+ * Shards may run on different hosts that have different
+ * --log-directory contents. Only the explicitly given shard
+ * log is used because every shard must compute the same
+ * partition. The history of the context isn't used.
+ */
+static CutTestHistory *
+load_shard_history (CutRunContext *context)
+{
+    CutRunContextPrivate *priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
+    CutTestHistory *history;
+    GError *error = NULL;
+
+    if (!priv->shard_log)
+        return NULL;
+
+    history = cut_test_history_new();
+    if (!cut_test_history_load_file(history, priv->shard_log, &error)) {
+        g_warning("[shard] %s: falling back to name hash", error->message);
+        g_error_free(error);
+        cut_test_history_free(history);
+        return NULL;
+    }
+
+    return history;
+}
+
+GList *
+cut_run_context_shard_test_cases (CutRunContext *context, GList *test_cases)
+{
+    CutRunContextPrivate *priv;
+    CutTestHistory *history;
+    GArray *items;
+    GList *node, *sharded_test_cases = NULL;
+    gint *shards;
+    guint i;
+
+    priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
+    if (priv->shard_count <= 1)
+        return test_cases;
+
+    items = g_array_new(FALSE, FALSE, sizeof(ShardItem));
+    for (node = test_cases; node; node = g_list_next(node)) {
+        ShardItem item;
+
+        item.position = items->len;
+        item.name = cut_test_get_name(CUT_TEST(node->data));
+        item.weight = 0.0;
+        g_array_append_val(items, item);
+    }
+
+    shards = g_new0(gint, MAX(items->len, 1));
+    history = load_shard_history(context);
+    if (history && has_test_case_history(history, items)) {
+        assign_shards_by_elapsed(items, history, priv->shard_count, shards);
+    } else {
+        for (i = 0; i < items->len; i++) {
+            ShardItem *item = &g_array_index(items, ShardItem, i);
+
+            shards[item->position] =
+                shard_hash(item->name) % priv->shard_count;
+        }
+    }
+    if (history)
+        cut_test_history_free(history);
+    g_array_free(items, TRUE);
+
+    for (node = test_cases, i = 0; node; node = g_list_next(node), i++) {
+        if (shards[i] == priv->shard_index)
+            sharded_test_cases = g_list_prepend(sharded_test_cases,
+                                                node->data);
+    }
+    g_free(shards);
+    g_list_free(test_cases);
+
+    return g_list_reverse(sharded_test_cases);
+}
+
 GList *
 cut_run_context_sort_test_cases (CutRunContext *context, GList *test_cases)
 {
     CutRunContextPrivate *priv;
+    CutTestHistory *history;
     GList *sorted_test_cases = NULL;
     gboolean ascending;
 
@@ -2047,6 +3012,10 @@ cut_run_context_sort_test_cases (CutRunContext *context, GList *test_cases)
                                                   compare_test_cases_by_name,
                                                   &ascending);
         break;
+      case CUT_ORDER_ELAPSED_DESCENDING:
+        history = cut_run_context_get_test_history(context);
+        sorted_test_cases = sort_test_cases_by_elapsed(test_cases, history);
+        break;
     }
 
     return sorted_test_cases;
@@ -2221,6 +3190,18 @@ cb_delegate_pass_assertion (CutRunContext *context,
                   test, test_context);
 }
 
+static void
+cb_delegate_pass_assertions (CutRunContext *context,
+                             CutTest *test,
+                             CutTestContext *test_context,
+                             guint n_assertions,
+                             gpointer user_data)
+{
+    CutRunContext *other_context = user_data;
+    g_signal_emit(other_context, signals[PASS_ASSERTIONS], detail_delegate,
+                  test, test_context, n_assertions);
+}
+
 static void
 cb_delegate_success_test (CutRunContext *context,
                           CutTest *test,
@@ -2539,6 +3520,7 @@ cb_delegate_complete_run (CutRunContext *context, gboolean success,
     DISCONNECT_DELEGATE_SIGNAL(start_iterated_test);
 
     DISCONNECT_DELEGATE_SIGNAL(pass_assertion);
+    DISCONNECT_DELEGATE_SIGNAL(pass_assertions);
     DISCONNECT_DELEGATE_SIGNAL(success_test);
     DISCONNECT_DELEGATE_SIGNAL(failure_test);
     DISCONNECT_DELEGATE_SIGNAL(error_test);
@@ -2596,6 +3578,7 @@ cut_run_context_delegate_signals (CutRunContext *context,
     CONNECT_DELEGATE_SIGNAL(start_iterated_test);
 
     CONNECT_DELEGATE_SIGNAL(pass_assertion);
+    CONNECT_DELEGATE_SIGNAL(pass_assertions);
     CONNECT_DELEGATE_SIGNAL(success_test);
     CONNECT_DELEGATE_SIGNAL(failure_test);
     CONNECT_DELEGATE_SIGNAL(error_test);
@@ -2690,6 +3673,115 @@ cut_run_context_get_stop_before_test (CutRunContext *context)
     return CUT_RUN_CONTEXT_GET_PRIVATE(context)->stop_before_test;
 }
 
+void
+cut_run_context_set_keep_results (CutRunContext *context,
+                                  CutKeepResults keep_results)
+{
+    CUT_RUN_CONTEXT_GET_PRIVATE(context)->keep_results = keep_results;
+}
+
+CutKeepResults
+cut_run_context_get_keep_results (CutRunContext *context)
+{
+    return CUT_RUN_CONTEXT_GET_PRIVATE(context)->keep_results;
+}
+
+void
+cut_run_context_set_elapsed_regression (CutRunContext *context,
+                                        CutElapsedRegression regression)
+{
+    CUT_RUN_CONTEXT_GET_PRIVATE(context)->elapsed_regression = regression;
+}
+
+CutElapsedRegression
+cut_run_context_get_elapsed_regression (CutRunContext *context)
+{
+    return CUT_RUN_CONTEXT_GET_PRIVATE(context)->elapsed_regression;
+}
+
+void
+cut_run_context_set_elapsed_regression_threshold (CutRunContext *context,
+                                                  gdouble threshold)
+{
+    CUT_RUN_CONTEXT_GET_PRIVATE(context)->elapsed_regression_threshold =
+        threshold;
+}
+
+gdouble
+cut_run_context_get_elapsed_regression_threshold (CutRunContext *context)
+{
+    return CUT_RUN_CONTEXT_GET_PRIVATE(context)->elapsed_regression_threshold;
+}
+
+void
+cut_run_context_set_benchmark_filter (CutRunContext *context,
+                                      const gchar **filter)
+{
+    CutRunContextPrivate *priv = CUT_RUN_CONTEXT_GET_PRIVATE(context);
+
+    g_strfreev(priv->benchmark_filter);
+    priv->benchmark_filter = g_strdupv((gchar **)filter);
+}
+
+const gchar **
+cut_run_context_get_benchmark_filter (CutRunContext *context)
+{
+    return (const gchar **)CUT_RUN_CONTEXT_GET_PRIVATE(context)->benchmark_filter;
+}
+
+void
+cut_run_context_set_benchmark_min_time (CutRunContext *context,
+                                        gdouble min_time)
+{
+    CUT_RUN_CONTEXT_GET_PRIVATE(context)->benchmark_min_time = min_time;
+}
+
+gdouble
+cut_run_context_get_benchmark_min_time (CutRunContext *context)
+{
+    return CUT_RUN_CONTEXT_GET_PRIVATE(context)->benchmark_min_time;
+}
+
+void
+cut_run_context_set_measure_resource_usage (CutRunContext *context,
+                                            gboolean measure_resource_usage)
+{
+    CUT_RUN_CONTEXT_GET_PRIVATE(context)->measure_resource_usage =
+        measure_resource_usage;
+}
+
+gboolean
+cut_run_context_get_measure_resource_usage (CutRunContext *context)
+{
+    return CUT_RUN_CONTEXT_GET_PRIVATE(context)->measure_resource_usage;
+}
+
+void
+cut_run_context_set_measure_phases (CutRunContext *context,
+                                    gboolean measure_phases)
+{
+    CUT_RUN_CONTEXT_GET_PRIVATE(context)->measure_phases = measure_phases;
+}
+
+gboolean
+cut_run_context_get_measure_phases (CutRunContext *context)
+{
+    return CUT_RUN_CONTEXT_GET_PRIVATE(context)->measure_phases;
+}
+
+void
+cut_run_context_set_full_memory_dump (CutRunContext *context,
+                                      gboolean full_memory_dump)
+{
+    CUT_RUN_CONTEXT_GET_PRIVATE(context)->full_memory_dump = full_memory_dump;
+}
+
+gboolean
+cut_run_context_get_full_memory_dump (CutRunContext *context)
+{
+    return CUT_RUN_CONTEXT_GET_PRIVATE(context)->full_memory_dump;
+}
+
 /*
 vi:ts=4:nowrap:ai:expandtab:sw=4
 */
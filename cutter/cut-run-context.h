@@ -39,9 +39,22 @@ G_BEGIN_DECLS
 typedef enum {
     CUT_ORDER_NONE_SPECIFIED,
     CUT_ORDER_NAME_ASCENDING,
-    CUT_ORDER_NAME_DESCENDING
+    CUT_ORDER_NAME_DESCENDING,
+    CUT_ORDER_ELAPSED_DESCENDING
 } CutOrder;
 
+typedef enum {
+    CUT_KEEP_RESULTS_ALL,
+    CUT_KEEP_RESULTS_FAILURES,
+    CUT_KEEP_RESULTS_NONE
+} CutKeepResults;
+
+typedef enum {
+    CUT_ELAPSED_REGRESSION_NONE,
+    CUT_ELAPSED_REGRESSION_NOTIFICATION,
+    CUT_ELAPSED_REGRESSION_FAILURE
+} CutElapsedRegression;
+
 typedef struct _CutRunContextClass    CutRunContextClass;
 
 struct _CutRunContext
@@ -210,6 +223,11 @@ struct _CutRunContextClass
 
     void (*error)               (CutRunContext  *context,
                                  GError         *error);
+
+    void (*pass_assertions)     (CutRunContext  *context,
+                                 CutTest        *test,
+                                 CutTestContext *test_context,
+                                 guint           n_assertions);
 };
 
 GType          cut_run_context_get_type  (void) G_GNUC_CONST;
@@ -223,6 +241,13 @@ const gchar   *cut_run_context_get_source_directory (CutRunContext *context);
 void           cut_run_context_set_log_directory    (CutRunContext *context,
                                                      const gchar   *directory);
 const gchar   *cut_run_context_get_log_directory    (CutRunContext *context);
+void           cut_run_context_set_shard_log        (CutRunContext *context,
+                                                     const gchar   *file_name);
+const gchar   *cut_run_context_get_shard_log        (CutRunContext *context);
+
+void           cut_run_context_set_test_index_file  (CutRunContext *context,
+                                                     const gchar   *file_name);
+const gchar   *cut_run_context_get_test_index_file  (CutRunContext *context);
 
 void           cut_run_context_set_multi_thread     (CutRunContext *context,
                                                      gboolean       use_multi_thread);
@@ -233,6 +258,16 @@ void           cut_run_context_set_max_threads      (CutRunContext *context,
                                                      gint           max_threads);
 gint           cut_run_context_get_max_threads      (CutRunContext *context);
 
+void           cut_run_context_set_n_processes      (CutRunContext *context,
+                                                     gint           n_processes);
+gint           cut_run_context_get_n_processes      (CutRunContext *context);
+
+void           cut_run_context_set_shard            (CutRunContext *context,
+                                                     gint           index,
+                                                     gint           count);
+gint           cut_run_context_get_shard_index      (CutRunContext *context);
+gint           cut_run_context_get_shard_count      (CutRunContext *context);
+
 void           cut_run_context_set_handle_signals   (CutRunContext *context,
                                                      gboolean       handle_signals);
 gboolean       cut_run_context_get_handle_signals   (CutRunContext *context);
@@ -270,6 +305,14 @@ CutTestResultStatus cut_run_context_get_status      (CutRunContext *context);
 gdouble        cut_run_context_get_elapsed          (CutRunContext *context);
 gdouble        cut_run_context_get_total_elapsed    (CutRunContext *context);
 
+/*
+ * Returns the registered results in registered order. It
+ * depends on keep-results:
+ *   CUT_KEEP_RESULTS_ALL: all results.
+ *   CUT_KEEP_RESULTS_FAILURES: all results except successes.
+ *   CUT_KEEP_RESULTS_NONE: no results.
+ * Results that aren't kept are still counted and emitted.
+ */
 const GList   *cut_run_context_get_results          (CutRunContext *context);
 
 gboolean       cut_run_context_is_crashed           (CutRunContext *context);
@@ -287,6 +330,8 @@ void           cut_run_context_set_test_case_order  (CutRunContext *context,
 CutOrder       cut_run_context_get_test_case_order  (CutRunContext *context);
 GList         *cut_run_context_sort_test_cases      (CutRunContext *context,
                                                      GList         *test_cases);
+GList         *cut_run_context_shard_test_cases     (CutRunContext *context,
+                                                     GList         *test_cases);
 
 void           cut_run_context_add_listener         (CutRunContext *context,
                                                      CutListener   *listener);
@@ -336,6 +381,76 @@ void           cut_run_context_set_stop_before_test (CutRunContext *context,
                                                      gboolean       stop);
 gboolean       cut_run_context_get_stop_before_test (CutRunContext *context);
 
+void           cut_run_context_set_keep_results     (CutRunContext *context,
+                                                     CutKeepResults keep_results);
+CutKeepResults cut_run_context_get_keep_results     (CutRunContext *context);
+
+/*
+ * A test that is slower than the median of its elapsed
+ * times in the previous runs in log-directory by more than
+ * threshold times the scaled MAD (median absolute
+ * deviation) is reported as elapsed-regression.
+ */
+#define CUT_ELAPSED_REGRESSION_THRESHOLD_DEFAULT 5.0
+
+void           cut_run_context_set_elapsed_regression
+                                                    (CutRunContext *context,
+                                                     CutElapsedRegression regression);
+CutElapsedRegression cut_run_context_get_elapsed_regression
+                                                    (CutRunContext *context);
+void           cut_run_context_set_elapsed_regression_threshold
+                                                    (CutRunContext *context,
+                                                     gdouble        threshold);
+gdouble        cut_run_context_get_elapsed_regression_threshold
+                                                    (CutRunContext *context);
+
+CutTestHistory *cut_run_context_get_test_history
+                                                    (CutRunContext *context);
+
+/*
+ * Compares elapsed time of the test with the previous runs
+ * and returns the status to be reported. It returns
+ * CUT_TEST_RESULT_SUCCESS when the test isn't slow or there
+ * isn't enough history. Otherwise message is set to a newly
+ * allocated description. The "elapsed-regression" and
+ * "elapsed-regression-threshold" attributes of the test
+ * override the run context's settings.
+ */
+CutTestResultStatus cut_run_context_check_elapsed_regression
+                                                    (CutRunContext *context,
+                                                     CutTest       *test,
+                                                     CutTestCase   *test_case,
+                                                     gchar        **message);
+
+/*
+ * Benchmarks whose names match benchmark-filter are
+ * measured for benchmark-min-time seconds at least. Other
+ * benchmarks are run only once as normal tests.
+ */
+#define CUT_BENCHMARK_MIN_TIME_DEFAULT 1.0
+
+void           cut_run_context_set_benchmark_filter (CutRunContext *context,
+                                                     const gchar  **filter);
+const gchar  **cut_run_context_get_benchmark_filter (CutRunContext *context);
+void           cut_run_context_set_benchmark_min_time
+                                                    (CutRunContext *context,
+                                                     gdouble        min_time);
+gdouble        cut_run_context_get_benchmark_min_time
+                                                    (CutRunContext *context);
+
+void           cut_run_context_set_measure_resource_usage
+                                                    (CutRunContext *context,
+                                                     gboolean       measure_resource_usage);
+gboolean       cut_run_context_get_measure_resource_usage
+                                                    (CutRunContext *context);
+
+void           cut_run_context_set_measure_phases   (CutRunContext *context,
+                                                     gboolean       measure_phases);
+gboolean       cut_run_context_get_measure_phases   (CutRunContext *context);
+
+void           cut_run_context_set_full_memory_dump (CutRunContext *context,
+                                                     gboolean       full_memory_dump);
+gboolean       cut_run_context_get_full_memory_dump (CutRunContext *context);
 
 G_END_DECLS
 
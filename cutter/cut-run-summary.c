@@ -0,0 +1,256 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <glib.h>
+
+#include "cut-run-summary.h"
+#include "cut-stream-reader.h"
+#include "cut-test-case.h"
+#include "cut-test-context.h"
+#include "cut-test-result.h"
+#include "cut-utils.h"
+
+static void
+test_summary_free (CutTestSummary *test)
+{
+    g_free(test->test_case_name);
+    g_free(test->test_name);
+    g_slice_free(CutTestSummary, test);
+}
+
+CutRunSummary *
+cut_run_summary_new (const gchar *log_name)
+{
+    CutRunSummary *summary;
+
+    summary = g_slice_new0(CutRunSummary);
+    summary->log_name = g_strdup(log_name);
+    summary->success = TRUE;
+    summary->tests = g_ptr_array_new();
+
+    return summary;
+}
+
+void
+cut_run_summary_free (CutRunSummary *summary)
+{
+    g_free(summary->log_name);
+    g_ptr_array_foreach(summary->tests, (GFunc)test_summary_free, NULL);
+    g_ptr_array_free(summary->tests, TRUE);
+    g_slice_free(CutRunSummary, summary);
+}
+
+CutTestSummary *
+cut_run_summary_add_test (CutRunSummary *summary,
+                          const gchar *test_case_name,
+                          const gchar *test_name,
+                          CutTestResultStatus status,
+                          gdouble elapsed)
+{
+    CutTestSummary *test;
+
+    test = g_slice_new(CutTestSummary);
+    test->test_case_name = g_strdup(test_case_name);
+    test->test_name = g_strdup(test_name);
+    test->status = status;
+    test->elapsed = elapsed;
+    g_ptr_array_add(summary->tests, test);
+
+    return test;
+}
+
+CutTestSummary *
+cut_run_summary_find_test (CutRunSummary *summary,
+                           const gchar *test_case_name,
+                           const gchar *test_name)
+{
+    guint i;
+
+    for (i = 0; i < summary->tests->len; i++) {
+        CutTestSummary *test = g_ptr_array_index(summary->tests, i);
+
+        if (cut_utils_equal_string(test->test_case_name, test_case_name) &&
+            cut_utils_equal_string(test->test_name, test_name))
+            return test;
+    }
+
+    return NULL;
+}
+
+typedef struct _Collector Collector;
+struct _Collector
+{
+    CutRunSummary *summary;
+    GHashTable *tests;
+    GError *error;
+};
+
+static CutTestSummary *
+collector_get_test (Collector *collector,
+                    const gchar *test_case_name, const gchar *test_name)
+{
+    CutTestSummary *test;
+    gchar *key;
+
+    key = g_strconcat(test_case_name ? test_case_name : "", "\n",
+                      test_name, NULL);
+    test = g_hash_table_lookup(collector->tests, key);
+    if (test) {
+        g_free(key);
+    } else {
+        test = cut_run_summary_add_test(collector->summary,
+                                        test_case_name, test_name,
+                                        CUT_TEST_RESULT_SUCCESS, 0.0);
+        g_hash_table_insert(collector->tests, key, test);
+    }
+
+    return test;
+}
+
+static void
+cb_result (CutRunContext *run_context, CutTest *test,
+           CutTestContext *test_context, CutTestResult *result,
+           gpointer data)
+{
+    Collector *collector = data;
+    CutTestSummary *test_summary;
+    CutTestResultStatus status;
+
+    test_summary =
+        collector_get_test(collector,
+                           cut_test_result_get_test_case_name(result),
+                           cut_test_result_get_test_name(result));
+    status = cut_test_result_get_status(result);
+    if (status > test_summary->status)
+        test_summary->status = status;
+}
+
+static void
+cb_complete_test (CutRunContext *run_context, CutTest *test,
+                  CutTestContext *test_context, gboolean success,
+                  gpointer data)
+{
+    Collector *collector = data;
+    CutTestSummary *test_summary;
+    CutTestCase *test_case = NULL;
+
+    if (test_context)
+        test_case = cut_test_context_get_test_case(test_context);
+    test_summary =
+        collector_get_test(collector,
+                           test_case ? cut_test_get_name(CUT_TEST(test_case)) :
+                                       NULL,
+                           cut_test_get_name(test));
+    test_summary->elapsed = cut_test_get_elapsed(test);
+    if (!success && test_summary->status == CUT_TEST_RESULT_SUCCESS)
+        test_summary->status = CUT_TEST_RESULT_FAILURE;
+}
+
+static void
+cb_complete_run (CutRunContext *run_context, gboolean success, gpointer data)
+{
+    Collector *collector = data;
+
+    collector->summary->success = success;
+}
+
+static void
+cb_error (CutRunContext *run_context, GError *error, gpointer data)
+{
+    Collector *collector = data;
+
+    if (!collector->error)
+        collector->error = g_error_copy(error);
+}
+
+CutRunSummary *
+cut_run_summary_new_from_log (const gchar *log_file_name, GError **error)
+{
+    CutRunContext *reader;
+    CutRunSummary *summary;
+    GIOChannel *channel;
+    Collector collector;
+    gchar *log_name;
+    CutTestResultStatus status;
+
+    channel = g_io_channel_new_file(log_file_name, "r", error);
+    if (!channel)
+        return NULL;
+    g_io_channel_set_encoding(channel, NULL, NULL);
+
+    log_name = g_path_get_basename(log_file_name);
+    summary = cut_run_summary_new(log_name);
+    g_free(log_name);
+
+    collector.summary = summary;
+    collector.tests = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                            g_free, NULL);
+    collector.error = NULL;
+
+    reader = cut_stream_reader_new();
+    cut_run_context_set_keep_results(reader, CUT_KEEP_RESULTS_NONE);
+    for (status = CUT_TEST_RESULT_SUCCESS;
+         status < CUT_TEST_RESULT_LAST;
+         status++) {
+        gchar *signal_name;
+
+        signal_name =
+            g_strdup_printf("%s-test",
+                            cut_test_result_status_to_signal_name(status));
+        g_signal_connect(reader, signal_name,
+                         G_CALLBACK(cb_result), &collector);
+        g_free(signal_name);
+    }
+    g_signal_connect(reader, "complete-test",
+                     G_CALLBACK(cb_complete_test), &collector);
+    g_signal_connect(reader, "complete-run",
+                     G_CALLBACK(cb_complete_run), &collector);
+    g_signal_connect(reader, "error", G_CALLBACK(cb_error), &collector);
+
+    cut_stream_reader_read_from_io_channel_to_end(CUT_STREAM_READER(reader),
+                                                  channel);
+    g_io_channel_unref(channel);
+
+    summary->elapsed = cut_run_context_get_total_elapsed(reader);
+    summary->n_tests = cut_run_context_get_n_tests(reader);
+    summary->n_assertions = cut_run_context_get_n_assertions(reader);
+    summary->n_failures = cut_run_context_get_n_failures(reader);
+    summary->n_errors = cut_run_context_get_n_errors(reader);
+    summary->n_pendings = cut_run_context_get_n_pendings(reader);
+    summary->n_notifications = cut_run_context_get_n_notifications(reader);
+    summary->n_omissions = cut_run_context_get_n_omissions(reader);
+    g_object_unref(reader);
+    g_hash_table_unref(collector.tests);
+
+    if (collector.error) {
+        g_propagate_error(error, collector.error);
+        cut_run_summary_free(summary);
+        return NULL;
+    }
+
+    return summary;
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
@@ -0,0 +1,81 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CUT_RUN_SUMMARY_H__
+#define __CUT_RUN_SUMMARY_H__
+
+#include <glib.h>
+
+#include <cutter/cut-public.h>
+
+G_BEGIN_DECLS
+
+/*
+ * CutRunSummary is a compact summary of a run that is
+ * extracted from an XML log: counts of the run and status
+ * and elapsed time of each test. It is small enough to be
+ * kept for many runs.
+ */
+
+typedef struct _CutTestSummary CutTestSummary;
+struct _CutTestSummary
+{
+    gchar *test_case_name;
+    gchar *test_name;
+    CutTestResultStatus status;
+    gdouble elapsed;
+};
+
+typedef struct _CutRunSummary CutRunSummary;
+struct _CutRunSummary
+{
+    gchar *log_name;
+    gboolean success;
+    gdouble elapsed;
+    guint n_tests;
+    guint n_assertions;
+    guint n_failures;
+    guint n_errors;
+    guint n_pendings;
+    guint n_notifications;
+    guint n_omissions;
+    GPtrArray *tests;
+};
+
+CutRunSummary  *cut_run_summary_new          (const gchar    *log_name);
+CutRunSummary  *cut_run_summary_new_from_log (const gchar    *log_file_name,
+                                              GError        **error);
+void            cut_run_summary_free         (CutRunSummary  *summary);
+
+CutTestSummary *cut_run_summary_add_test     (CutRunSummary  *summary,
+                                              const gchar    *test_case_name,
+                                              const gchar    *test_name,
+                                              CutTestResultStatus status,
+                                              gdouble         elapsed);
+CutTestSummary *cut_run_summary_find_test    (CutRunSummary  *summary,
+                                              const gchar    *test_case_name,
+                                              const gchar    *test_name);
+
+G_END_DECLS
+
+#endif /* __CUT_RUN_SUMMARY_H__ */
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
@@ -0,0 +1,405 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <glib.h>
+
+#include "cut-scheduler.h"
+#include "cut-glib-compatible.h"
+#include "cut-utils.h"
+#include "../gcutter/gcut-error.h"
+
+/* -1 means "no limit" but we need a fixed size worker table
+ * to steal without locking the scheduler. */
+#define UNLIMITED_MAX_WORKERS 1024
+
+typedef struct _Task Task;
+struct _Task
+{
+    CutSchedulerGroup *group;
+    gpointer data;
+};
+
+typedef struct _Deque Deque;
+struct _Deque
+{
+    GMutex *mutex;
+    GQueue *tasks;
+};
+
+typedef struct _Worker Worker;
+struct _Worker
+{
+    CutScheduler *scheduler;
+    Deque *deque;
+    GThread *thread;
+    guint index;
+};
+
+struct _CutScheduler
+{
+    GMutex *mutex;
+    GCond *cond;
+    gint max_threads;
+    guint max_workers;
+    Worker **workers;
+    volatile gint n_workers;
+    Deque *external;
+    volatile gint n_queued;
+    guint n_waiting;
+    gboolean shutdown;
+};
+
+struct _CutSchedulerGroup
+{
+    CutScheduler *scheduler;
+    CutSchedulerFunction function;
+    gpointer user_data;
+    guint n_pending;
+};
+
+static GPrivate current_worker_private = G_PRIVATE_INIT(NULL);
+
+static Deque *
+deque_new (void)
+{
+    Deque *deque;
+
+    deque = g_slice_new(Deque);
+    deque->mutex = g_mutex_new();
+    deque->tasks = g_queue_new();
+
+    return deque;
+}
+
+static void
+deque_free (Deque *deque)
+{
+    g_mutex_free(deque->mutex);
+    g_queue_free(deque->tasks);
+    g_slice_free(Deque, deque);
+}
+
+static void
+deque_push_head (Deque *deque, Task *task)
+{
+    g_mutex_lock(deque->mutex);
+    g_queue_push_head(deque->tasks, task);
+    g_mutex_unlock(deque->mutex);
+}
+
+static Task *
+deque_pop_head (Deque *deque)
+{
+    Task *task;
+
+    g_mutex_lock(deque->mutex);
+    task = g_queue_pop_head(deque->tasks);
+    g_mutex_unlock(deque->mutex);
+
+    return task;
+}
+
+static Task *
+deque_pop_tail (Deque *deque)
+{
+    Task *task;
+
+    g_mutex_lock(deque->mutex);
+    task = g_queue_pop_tail(deque->tasks);
+    g_mutex_unlock(deque->mutex);
+
+    return task;
+}
+
+static Worker *
+get_current_worker (CutScheduler *scheduler)
+{
+    Worker *worker;
+
+    worker = g_private_get(&current_worker_private);
+    if (worker && worker->scheduler == scheduler)
+        return worker;
+    return NULL;
+}
+
+static Task *
+take_task (CutScheduler *scheduler, Worker *self)
+{
+    Task *task = NULL;
+
+    if (self)
+        task = deque_pop_head(self->deque);
+    if (!task)
+        task = deque_pop_tail(scheduler->external);
+    if (!task) {
+        guint i, n_workers, start;
+
+        n_workers = g_atomic_int_get(&(scheduler->n_workers));
+        start = self ? self->index + 1 : 0;
+        for (i = 0; i < n_workers && !task; i++) {
+            Worker *victim;
+
+            victim = scheduler->workers[(start + i) % n_workers];
+            if (victim == self)
+                continue;
+            task = deque_pop_tail(victim->deque);
+        }
+    }
+
+    if (task)
+        g_atomic_int_add(&(scheduler->n_queued), -1);
+
+    return task;
+}
+
+static void
+run_task (CutScheduler *scheduler, Task *task)
+{
+    CutSchedulerGroup *group;
+
+    group = task->group;
+    group->function(task->data, group->user_data);
+    g_slice_free(Task, task);
+
+    g_mutex_lock(scheduler->mutex);
+    group->n_pending--;
+    if (group->n_pending == 0)
+        g_cond_broadcast(scheduler->cond);
+    g_mutex_unlock(scheduler->mutex);
+}
+
+static gpointer
+worker_main (gpointer data)
+{
+    Worker *worker = data;
+    CutScheduler *scheduler;
+
+    scheduler = worker->scheduler;
+    g_private_set(&current_worker_private, worker);
+
+    while (TRUE) {
+        Task *task;
+        gboolean finished;
+
+        task = take_task(scheduler, worker);
+        if (task) {
+            run_task(scheduler, task);
+            continue;
+        }
+
+        g_mutex_lock(scheduler->mutex);
+        while (g_atomic_int_get(&(scheduler->n_queued)) <= 0 &&
+               !scheduler->shutdown) {
+            scheduler->n_waiting++;
+            g_cond_wait(scheduler->cond, scheduler->mutex);
+            scheduler->n_waiting--;
+        }
+        finished = scheduler->shutdown &&
+            g_atomic_int_get(&(scheduler->n_queued)) <= 0;
+        g_mutex_unlock(scheduler->mutex);
+
+        if (finished)
+            break;
+    }
+
+    g_private_set(&current_worker_private, NULL);
+
+    return NULL;
+}
+
+/* must be called with scheduler->mutex locked */
+static void
+spawn_worker (CutScheduler *scheduler)
+{
+    Worker *worker;
+    GError *error = NULL;
+    guint n_workers;
+
+    n_workers = g_atomic_int_get(&(scheduler->n_workers));
+    worker = g_new0(Worker, 1);
+    worker->scheduler = scheduler;
+    worker->deque = deque_new();
+    worker->index = n_workers;
+    worker->thread = g_thread_create(worker_main, worker, TRUE, &error);
+    if (!worker->thread) {
+        cut_utils_report_error(error);
+        deque_free(worker->deque);
+        g_free(worker);
+        return;
+    }
+
+    scheduler->workers[n_workers] = worker;
+    g_atomic_int_inc(&(scheduler->n_workers));
+}
+
+CutScheduler *
+cut_scheduler_new (gint max_threads)
+{
+    CutScheduler *scheduler;
+
+    scheduler = g_new0(CutScheduler, 1);
+    scheduler->mutex = g_mutex_new();
+    scheduler->cond = g_cond_new();
+    scheduler->max_threads = max_threads;
+    /* A thread that joins a group runs tasks too. So we need
+     * one less worker thread than max_threads. */
+    if (max_threads > 0)
+        scheduler->max_workers = max_threads - 1;
+    else
+        scheduler->max_workers = UNLIMITED_MAX_WORKERS;
+    scheduler->workers = g_new0(Worker *, MAX(scheduler->max_workers, 1));
+    scheduler->n_workers = 0;
+    scheduler->external = deque_new();
+    scheduler->n_queued = 0;
+    scheduler->n_waiting = 0;
+    scheduler->shutdown = FALSE;
+
+    return scheduler;
+}
+
+void
+cut_scheduler_free (CutScheduler *scheduler)
+{
+    guint i, n_workers;
+
+    g_mutex_lock(scheduler->mutex);
+    scheduler->shutdown = TRUE;
+    g_cond_broadcast(scheduler->cond);
+    g_mutex_unlock(scheduler->mutex);
+
+    n_workers = g_atomic_int_get(&(scheduler->n_workers));
+    for (i = 0; i < n_workers; i++) {
+        Worker *worker = scheduler->workers[i];
+
+        g_thread_join(worker->thread);
+        deque_free(worker->deque);
+        g_free(worker);
+    }
+    g_free(scheduler->workers);
+
+    deque_free(scheduler->external);
+    g_cond_free(scheduler->cond);
+    g_mutex_free(scheduler->mutex);
+    g_free(scheduler);
+}
+
+gint
+cut_scheduler_get_max_threads (CutScheduler *scheduler)
+{
+    return scheduler->max_threads;
+}
+
+guint
+cut_scheduler_get_n_threads (CutScheduler *scheduler)
+{
+    return g_atomic_int_get(&(scheduler->n_workers));
+}
+
+CutSchedulerGroup *
+cut_scheduler_group_new (CutScheduler *scheduler,
+                         CutSchedulerFunction function, gpointer user_data)
+{
+    CutSchedulerGroup *group;
+
+    group = g_slice_new(CutSchedulerGroup);
+    group->scheduler = scheduler;
+    group->function = function;
+    group->user_data = user_data;
+    group->n_pending = 0;
+
+    return group;
+}
+
+void
+cut_scheduler_group_push (CutSchedulerGroup *group, gpointer data)
+{
+    CutScheduler *scheduler;
+    Worker *self;
+    Task *task;
+    guint n_workers;
+
+    scheduler = group->scheduler;
+    self = get_current_worker(scheduler);
+
+    task = g_slice_new(Task);
+    task->group = group;
+    task->data = data;
+
+    g_mutex_lock(scheduler->mutex);
+    group->n_pending++;
+    g_mutex_unlock(scheduler->mutex);
+
+    deque_push_head(self ? self->deque : scheduler->external, task);
+
+    g_mutex_lock(scheduler->mutex);
+    g_atomic_int_inc(&(scheduler->n_queued));
+    if (scheduler->n_waiting > 0)
+        g_cond_signal(scheduler->cond);
+    n_workers = g_atomic_int_get(&(scheduler->n_workers));
+    if (g_atomic_int_get(&(scheduler->n_queued)) > (gint)scheduler->n_waiting &&
+        n_workers < scheduler->max_workers)
+        spawn_worker(scheduler);
+    g_mutex_unlock(scheduler->mutex);
+}
+
+void
+cut_scheduler_group_join (CutSchedulerGroup *group)
+{
+    CutScheduler *scheduler;
+    Worker *self;
+
+    scheduler = group->scheduler;
+    self = get_current_worker(scheduler);
+
+    while (TRUE) {
+        Task *task;
+        gboolean completed;
+
+        g_mutex_lock(scheduler->mutex);
+        completed = (group->n_pending == 0);
+        g_mutex_unlock(scheduler->mutex);
+        if (completed)
+            break;
+
+        task = take_task(scheduler, self);
+        if (task) {
+            run_task(scheduler, task);
+            continue;
+        }
+
+        g_mutex_lock(scheduler->mutex);
+        while (group->n_pending > 0 &&
+               g_atomic_int_get(&(scheduler->n_queued)) <= 0) {
+            scheduler->n_waiting++;
+            g_cond_wait(scheduler->cond, scheduler->mutex);
+            scheduler->n_waiting--;
+        }
+        g_mutex_unlock(scheduler->mutex);
+    }
+
+    g_slice_free(CutSchedulerGroup, group);
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
@@ -0,0 +1,68 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CUT_SCHEDULER_H__
+#define __CUT_SCHEDULER_H__
+
+#include <glib.h>
+
+#include <cutter/cut-run-context.h>
+
+G_BEGIN_DECLS
+
+/*
+ * CutScheduler is a work-stealing executor shared by all
+ * multi-thread runs in a run context. Each worker thread
+ * has its own task deque: the owner pushes and pops at
+ * the head and idle workers steal from the tail of the
+ * others. A thread that waits for a group runs queued
+ * tasks instead of blocking, so nested groups (test cases
+ * -> iterated tests) never need more than max_threads
+ * threads in total.
+ */
+
+typedef struct _CutScheduler      CutScheduler;
+typedef struct _CutSchedulerGroup CutSchedulerGroup;
+
+typedef void (*CutSchedulerFunction) (gpointer data, gpointer user_data);
+
+CutScheduler      *cut_scheduler_new         (gint                  max_threads);
+void               cut_scheduler_free        (CutScheduler         *scheduler);
+gint               cut_scheduler_get_max_threads
+                                             (CutScheduler         *scheduler);
+guint              cut_scheduler_get_n_threads
+                                             (CutScheduler         *scheduler);
+
+CutSchedulerGroup *cut_scheduler_group_new   (CutScheduler         *scheduler,
+                                              CutSchedulerFunction  function,
+                                              gpointer              user_data);
+void               cut_scheduler_group_push  (CutSchedulerGroup    *group,
+                                              gpointer              data);
+void               cut_scheduler_group_join  (CutSchedulerGroup    *group);
+
+CutScheduler      *cut_run_context_get_scheduler
+                                             (CutRunContext        *context);
+
+G_END_DECLS
+
+#endif /* __CUT_SCHEDULER_H__ */
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
@@ -1,6 +1,6 @@
 /* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
 /*
- *  Copyright (C) 2008-2010  Kouhei Sutou <kou@clear-code.com>
+ *  Copyright (C) 2008-2014  Kouhei Sutou <kou@clear-code.com>
  *
  *  This library is free software: you can redistribute it and/or modify
  *  it under the terms of the GNU Lesser General Public License as published by
@@ -28,6 +28,15 @@
 #include "cut-sequence-matcher.h"
 #include "../gcutter/gcut-list.h"
 
+/*
+ * MYERS_AUTO_THRESHOLD is the product of the sequence lengths
+ * that CUT_SEQUENCE_MATCHER_ALGORITHM_AUTO switches to the
+ * Myers algorithm at. The difflib algorithm gives more
+ * readable results for small sequences but it is too slow
+ * for large sequences.
+ */
+#define MYERS_AUTO_THRESHOLD (1024 * 1024)
+
 #define CUT_SEQUENCE_MATCHER_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CUT_TYPE_SEQUENCE_MATCHER, CutSequenceMatcherPrivate))
 
 typedef struct _CutSequenceMatcherPrivate	CutSequenceMatcherPrivate;
@@ -37,8 +46,20 @@ struct _CutSequenceMatcherPrivate
     GSequence *to;
     GSequenceIterCompareFunc compare_func;
     gpointer compare_func_user_data;
+    GHashFunc content_hash_func;
+    GEqualFunc content_equal_func;
+    CutJunkFilterFunc junk_filter_func;
+    gpointer junk_filter_func_user_data;
     GHashTable *to_indices;
     GHashTable *junks;
+    gboolean to_indices_updated;
+    guint *from_tokens;
+    guint *to_tokens;
+    guint from_length;
+    guint to_length;
+    CutSequenceMatcherAlgorithm algorithm;
+    guint64 max_cost;
+    gboolean coarse;
     GList *matches;
     GList *blocks;
     GList *operations;
@@ -70,6 +91,8 @@ static void get_property   (GObject         *object,
                             GValue          *value,
                             GParamSpec      *pspec);
 
+static void ensure_sequences (CutSequenceMatcherPrivate *priv);
+
 CutSequenceMatchInfo *
 cut_sequence_match_info_new (guint from_index, guint to_index, guint size)
 {
@@ -170,8 +193,20 @@ cut_sequence_matcher_init (CutSequenceMatcher *sequence_matcher)
 
     priv->from = NULL;
     priv->to = NULL;
+    priv->content_hash_func = NULL;
+    priv->content_equal_func = NULL;
+    priv->junk_filter_func = NULL;
+    priv->junk_filter_func_user_data = NULL;
     priv->to_indices = NULL;
     priv->junks = NULL;
+    priv->to_indices_updated = FALSE;
+    priv->from_tokens = NULL;
+    priv->to_tokens = NULL;
+    priv->from_length = 0;
+    priv->to_length = 0;
+    priv->algorithm = CUT_SEQUENCE_MATCHER_ALGORITHM_AUTO;
+    priv->max_cost = CUT_SEQUENCE_MATCHER_DEFAULT_MAX_COST;
+    priv->coarse = FALSE;
     priv->matches = NULL;
     priv->blocks = NULL;
     priv->operations = NULL;
@@ -198,6 +233,34 @@ dispose_goruped_operations (CutSequenceMatcherPrivate *priv)
     priv->grouped_operations = NULL;
 }
 
+static void
+dispose_results (CutSequenceMatcherPrivate *priv)
+{
+    if (priv->matches) {
+        g_list_foreach(priv->matches, (GFunc)cut_sequence_match_info_free, NULL);
+        g_list_free(priv->matches);
+        priv->matches = NULL;
+    }
+
+    if (priv->blocks) {
+        g_list_foreach(priv->blocks, (GFunc)cut_sequence_match_info_free, NULL);
+        g_list_free(priv->blocks);
+        priv->blocks = NULL;
+    }
+
+    if (priv->operations) {
+        g_list_foreach(priv->operations,
+                       (GFunc)cut_sequence_match_operation_free, NULL);
+        g_list_free(priv->operations);
+        priv->operations = NULL;
+    }
+
+    dispose_goruped_operations(priv);
+
+    priv->ratio = -1.0;
+    priv->coarse = FALSE;
+}
+
 static void
 dispose (GObject *object)
 {
@@ -225,27 +288,17 @@ dispose (GObject *object)
         priv->junks = NULL;
     }
 
-    if (priv->matches) {
-        g_list_foreach(priv->matches, (GFunc)cut_sequence_match_info_free, NULL);
-        g_list_free(priv->matches);
-        priv->matches = NULL;
+    if (priv->from_tokens) {
+        g_free(priv->from_tokens);
+        priv->from_tokens = NULL;
     }
 
-    if (priv->blocks) {
-        g_list_foreach(priv->blocks, (GFunc)cut_sequence_match_info_free, NULL);
-        g_list_free(priv->blocks);
-        priv->blocks = NULL;
+    if (priv->to_tokens) {
+        g_free(priv->to_tokens);
+        priv->to_tokens = NULL;
     }
 
-
-    if (priv->operations) {
-        g_list_foreach(priv->operations,
-                       (GFunc)cut_sequence_match_operation_free, NULL);
-        g_list_free(priv->operations);
-        priv->operations = NULL;
-    }
-
-    dispose_goruped_operations(priv);
+    dispose_results(priv);
 
     G_OBJECT_CLASS(cut_sequence_matcher_parent_class)->dispose(object);
 }
@@ -295,9 +348,11 @@ get_property (GObject    *object,
 
     switch (prop_id) {
       case PROP_FROM_SEQUENCE:
+        ensure_sequences(priv);
         g_value_set_pointer(value, priv->from);
         break;
       case PROP_TO_SEQUENCE:
+        ensure_sequences(priv);
         g_value_set_pointer(value, priv->to);
         break;
       case PROP_COMPARE_FUNC:
@@ -338,52 +393,127 @@ remove_junk (gpointer key, gpointer value, gpointer user_data)
 }
 
 static void
-remove_junks_from_to_indices (CutSequenceMatcher *matcher,
-                              CutJunkFilterFunc junk_filter_func,
-                              gpointer junk_filter_func_user_data)
+update_to_indices (CutSequenceMatcherPrivate *priv)
 {
-    CutSequenceMatcherPrivate *priv;
-    RemoveJunkData data;
-
-    priv = CUT_SEQUENCE_MATCHER_GET_PRIVATE(matcher);
-    data.junk_filter_func = junk_filter_func;
-    data.junk_filter_func_user_data = junk_filter_func_user_data;
-    data.junks = priv->junks;
-    g_hash_table_foreach_steal(priv->to_indices, remove_junk, &data);
-}
-
-static void
-update_to_indices (CutSequenceMatcher *matcher,
-                   CutJunkFilterFunc junk_filter_func,
-                   gpointer junk_filter_func_user_data)
-{
-    CutSequenceMatcherPrivate *priv;
     gint i;
-    GSequenceIter *iter, *begin, *end;
+    GSequenceIter *iter, *begin;
 
-    priv = CUT_SEQUENCE_MATCHER_GET_PRIVATE(matcher);
+    if (priv->to_indices_updated)
+        return;
+    priv->to_indices_updated = TRUE;
 
     if (!priv->to)
         return;
 
     begin = g_sequence_get_begin_iter(priv->to);
-    end = g_sequence_get_end_iter(priv->to);
-    for (i = 0, iter = begin;
-         iter != end;
-         i++, iter = g_sequence_iter_next(iter)) {
+    iter = g_sequence_get_end_iter(priv->to);
+    for (i = priv->to_length - 1; iter != begin; i--) {
         gpointer data;
         GList *indices;
 
+        iter = g_sequence_iter_prev(iter);
         data = g_sequence_get(iter);
         indices = g_hash_table_lookup(priv->to_indices, data);
-        indices = g_list_append(indices, GINT_TO_POINTER(i));
-        g_hash_table_replace(priv->to_indices, data, g_list_copy(indices));
+        if (indices)
+            g_hash_table_steal(priv->to_indices, data);
+        indices = g_list_prepend(indices, GINT_TO_POINTER(i));
+        g_hash_table_insert(priv->to_indices, data, indices);
     }
 
-    if (junk_filter_func)
-        remove_junks_from_to_indices(matcher,
-                                     junk_filter_func,
-                                     junk_filter_func_user_data);
+    if (priv->junk_filter_func) {
+        RemoveJunkData data;
+
+        data.junk_filter_func = priv->junk_filter_func;
+        data.junk_filter_func_user_data = priv->junk_filter_func_user_data;
+        data.junks = priv->junks;
+        g_hash_table_foreach_steal(priv->to_indices, remove_junk, &data);
+    }
+}
+
+static GSequence *
+token_sequence_new (const guint *tokens, guint length)
+{
+    GSequence *sequence;
+    guint i;
+
+    sequence = g_sequence_new(NULL);
+    for (i = 0; i < length; i++) {
+        g_sequence_append(sequence, GUINT_TO_POINTER(tokens[i]));
+    }
+
+    return sequence;
+}
+
+/*
+ * Matchers created by cut_sequence_matcher_char_new() only
+ * have tokens that are characters. Sequences are needed
+ * only by the difflib algorithm.
+ */
+static void
+ensure_sequences (CutSequenceMatcherPrivate *priv)
+{
+    if (!priv->from && priv->from_tokens)
+        priv->from = token_sequence_new(priv->from_tokens, priv->from_length);
+    if (!priv->to && priv->to_tokens)
+        priv->to = token_sequence_new(priv->to_tokens, priv->to_length);
+}
+
+static void
+prepare_difflib (CutSequenceMatcherPrivate *priv)
+{
+    ensure_sequences(priv);
+    update_to_indices(priv);
+}
+
+static guint *
+tokenize_sequence (GSequence *sequence, guint length, GHashTable *ids)
+{
+    guint *tokens;
+    guint i;
+    GSequenceIter *iter;
+
+    tokens = g_new(guint, MAX(length, 1));
+    for (i = 0, iter = g_sequence_get_begin_iter(sequence);
+         !g_sequence_iter_is_end(iter);
+         i++, iter = g_sequence_iter_next(iter)) {
+        gpointer data, id;
+
+        data = g_sequence_get(iter);
+        id = g_hash_table_lookup(ids, data);
+        if (!id) {
+            id = GUINT_TO_POINTER(g_hash_table_size(ids) + 1);
+            g_hash_table_insert(ids, data, id);
+        }
+        tokens[i] = GPOINTER_TO_UINT(id);
+    }
+
+    return tokens;
+}
+
+/*
+ * Each content is mapped to an integer token. Equal
+ * contents have the same token. So the Myers algorithm can
+ * compare contents as integers.
+ */
+static void
+ensure_tokens (CutSequenceMatcherPrivate *priv)
+{
+    GHashTable *ids;
+
+    if (priv->from_tokens && priv->to_tokens)
+        return;
+
+    ids = g_hash_table_new(priv->content_hash_func, priv->content_equal_func);
+    g_free(priv->from_tokens);
+    g_free(priv->to_tokens);
+    priv->from_tokens = NULL;
+    priv->to_tokens = NULL;
+    if (priv->from)
+        priv->from_tokens = tokenize_sequence(priv->from, priv->from_length,
+                                              ids);
+    if (priv->to)
+        priv->to_tokens = tokenize_sequence(priv->to, priv->to_length, ids);
+    g_hash_table_unref(ids);
 }
 
 CutSequenceMatcher *
@@ -396,6 +526,7 @@ cut_sequence_matcher_new (GSequence *from, GSequence *to,
                           gpointer junk_filter_func_user_data)
 {
     CutSequenceMatcher *matcher;
+    CutSequenceMatcherPrivate *priv;
 
     matcher = g_object_new(CUT_TYPE_SEQUENCE_MATCHER,
                            "from-sequence", from,
@@ -410,22 +541,32 @@ cut_sequence_matcher_new (GSequence *from, GSequence *to,
                            "junks", g_hash_table_new(content_hash_func,
                                                      content_equal_func),
                            NULL);
-    update_to_indices(matcher, junk_filter_func, junk_filter_func_user_data);
+    priv = CUT_SEQUENCE_MATCHER_GET_PRIVATE(matcher);
+    priv->content_hash_func = content_hash_func;
+    priv->content_equal_func = content_equal_func;
+    priv->junk_filter_func = junk_filter_func;
+    priv->junk_filter_func_user_data = junk_filter_func_user_data;
+    if (from)
+        priv->from_length = g_sequence_get_length(from);
+    if (to)
+        priv->to_length = g_sequence_get_length(to);
+
     return matcher;
 }
 
-static GSequence *
-char_sequence_new (const gchar *string)
+static guint *
+char_tokens_new (const gchar *string, guint *length)
 {
-    GSequence *sequence;
+    guint *tokens;
+    guint i;
 
-    sequence = g_sequence_new(NULL);
-
-    for (; *string != '\0'; string = g_utf8_next_char(string)) {
-        g_sequence_append(sequence, GUINT_TO_POINTER(g_utf8_get_char(string)));
+    tokens = g_new(guint, MAX(strlen(string), 1));
+    for (i = 0; *string != '\0'; i++, string = g_utf8_next_char(string)) {
+        tokens[i] = g_utf8_get_char(string);
     }
+    *length = i;
 
-    return sequence;
+    return tokens;
 }
 
 static gint
@@ -472,12 +613,19 @@ cut_sequence_matcher_char_new_full (const gchar *from, const gchar *to,
                                     CutJunkFilterFunc junk_filter_func,
                                     gpointer junk_filter_func_user_data)
 {
-    return cut_sequence_matcher_new(char_sequence_new(from),
-                                    char_sequence_new(to),
-                                    char_sequence_iter_compare, NULL,
-                                    char_value_hash, char_value_equal,
-                                    junk_filter_func,
-                                    junk_filter_func_user_data);
+    CutSequenceMatcher *matcher;
+    CutSequenceMatcherPrivate *priv;
+
+    matcher = cut_sequence_matcher_new(NULL, NULL,
+                                       char_sequence_iter_compare, NULL,
+                                       char_value_hash, char_value_equal,
+                                       junk_filter_func,
+                                       junk_filter_func_user_data);
+    priv = CUT_SEQUENCE_MATCHER_GET_PRIVATE(matcher);
+    priv->from_tokens = char_tokens_new(from, &(priv->from_length));
+    priv->to_tokens = char_tokens_new(to, &(priv->to_length));
+
+    return matcher;
 }
 
 static GSequence *
@@ -532,6 +680,7 @@ cut_sequence_matcher_get_to_index (CutSequenceMatcher *matcher,
     CutSequenceMatcherPrivate *priv;
 
     priv = CUT_SEQUENCE_MATCHER_GET_PRIVATE(matcher);
+    prepare_difflib(priv);
     if (!priv->to)
         return NULL;
 
@@ -663,6 +812,7 @@ cut_sequence_matcher_get_longest_match (CutSequenceMatcher *matcher,
     CutSequenceMatchInfo *info;
 
     priv = CUT_SEQUENCE_MATCHER_GET_PRIVATE(matcher);
+    prepare_difflib(priv);
 
     info = find_best_match_position(matcher,
                                     from_begin, from_end,
@@ -730,21 +880,19 @@ compare_match_info (gconstpointer data1, gconstpointer data2)
     }
 }
 
-const GList *
-cut_sequence_matcher_get_matches (CutSequenceMatcher *matcher)
+static GList *
+get_matches_by_difflib (CutSequenceMatcher *matcher)
 {
     CutSequenceMatcherPrivate *priv;
     GList *matches = NULL;
     GQueue *queue;
 
     priv = CUT_SEQUENCE_MATCHER_GET_PRIVATE(matcher);
-    if (priv->matches)
-        return priv->matches;
 
     queue = g_queue_new();
     push_matching_info(queue,
-                       0, g_sequence_get_length(priv->from),
-                       0, g_sequence_get_length(priv->to));
+                       0, priv->from_length,
+                       0, priv->to_length);
 
     while (!g_queue_is_empty(queue)) {
         MatchingInfo info;
@@ -777,7 +925,262 @@ cut_sequence_matcher_get_matches (CutSequenceMatcher *matcher)
     }
 
     g_queue_free(queue);
-    priv->matches = g_list_sort(matches, compare_match_info);
+
+    return g_list_sort(matches, compare_match_info);
+}
+
+/*
+ * The Myers algorithm in linear space: "An O(ND) Difference
+ * Algorithm and Its Variations" by Eugene W. Myers. It
+ * finds the middle of the shortest edit script by searching
+ * from both ends and recurses on both halves.
+ *
+ * The cost is the number of compared elements. If the cost
+ * exceeds max_cost, the remaining ranges aren't searched and
+ * are reported as replaced after their common prefix and
+ * suffix are matched.
+ */
+typedef struct _MyersContext MyersContext;
+struct _MyersContext
+{
+    const guint *from;
+    const guint *to;
+    gint *forward;
+    gint *backward;
+    guint64 cost;
+    guint64 max_cost;
+    gboolean coarse;
+    GList *matches;
+};
+
+static void
+myers_add_match (MyersContext *context,
+                 guint from_index, guint to_index, guint size)
+{
+    context->matches =
+        g_list_prepend(context->matches,
+                       cut_sequence_match_info_new(from_index, to_index, size));
+}
+
+static gboolean
+myers_bisect (MyersContext *context,
+              guint from_begin, guint from_end,
+              guint to_begin, guint to_end,
+              guint *from_middle, guint *to_middle)
+{
+    const guint *from, *to;
+    gint *forward, *backward;
+    gint from_size, to_size, delta;
+    gint max_d, offset, length, d, i;
+    gint forward_k_begin = 0, forward_k_end = 0;
+    gint backward_k_begin = 0, backward_k_end = 0;
+    gboolean odd;
+
+    from = context->from + from_begin;
+    to = context->to + to_begin;
+    from_size = from_end - from_begin;
+    to_size = to_end - to_begin;
+    delta = from_size - to_size;
+    odd = (delta % 2 != 0);
+    max_d = (from_size + to_size + 1) / 2;
+    offset = max_d;
+    length = 2 * max_d + 2;
+
+    forward = context->forward;
+    backward = context->backward;
+    for (i = 0; i < length; i++) {
+        forward[i] = -1;
+        backward[i] = -1;
+    }
+    forward[offset + 1] = 0;
+    backward[offset + 1] = 0;
+
+    for (d = 0; d < max_d; d++) {
+        gint k;
+
+        if (context->cost > context->max_cost) {
+            context->coarse = TRUE;
+            return FALSE;
+        }
+
+        for (k = -d + forward_k_begin; k <= d - forward_k_end; k += 2) {
+            gint k_offset, x, y, snake_begin;
+
+            k_offset = offset + k;
+            if (k == -d ||
+                (k != d && forward[k_offset - 1] < forward[k_offset + 1]))
+                x = forward[k_offset + 1];
+            else
+                x = forward[k_offset - 1] + 1;
+            y = x - k;
+            snake_begin = x;
+            while (x < from_size && y < to_size && from[x] == to[y]) {
+                x++;
+                y++;
+            }
+            context->cost += x - snake_begin + 1;
+            forward[k_offset] = x;
+
+            if (x > from_size) {
+                forward_k_end += 2;
+            } else if (y > to_size) {
+                forward_k_begin += 2;
+            } else if (odd) {
+                gint backward_k_offset = offset + delta - k;
+
+                if (backward_k_offset >= 0 && backward_k_offset < length &&
+                    backward[backward_k_offset] != -1 &&
+                    x >= from_size - backward[backward_k_offset]) {
+                    *from_middle = from_begin + x;
+                    *to_middle = to_begin + y;
+                    return TRUE;
+                }
+            }
+        }
+
+        for (k = -d + backward_k_begin; k <= d - backward_k_end; k += 2) {
+            gint k_offset, x, y, snake_begin;
+
+            k_offset = offset + k;
+            if (k == -d ||
+                (k != d && backward[k_offset - 1] < backward[k_offset + 1]))
+                x = backward[k_offset + 1];
+            else
+                x = backward[k_offset - 1] + 1;
+            y = x - k;
+            snake_begin = x;
+            while (x < from_size && y < to_size &&
+                   from[from_size - x - 1] == to[to_size - y - 1]) {
+                x++;
+                y++;
+            }
+            context->cost += x - snake_begin + 1;
+            backward[k_offset] = x;
+
+            if (x > from_size) {
+                backward_k_end += 2;
+            } else if (y > to_size) {
+                backward_k_begin += 2;
+            } else if (!odd) {
+                gint forward_k_offset = offset + delta - k;
+
+                if (forward_k_offset >= 0 && forward_k_offset < length &&
+                    forward[forward_k_offset] != -1) {
+                    gint forward_x, forward_y;
+
+                    forward_x = forward[forward_k_offset];
+                    forward_y = offset + forward_x - forward_k_offset;
+                    if (forward_x >= from_size - x) {
+                        *from_middle = from_begin + forward_x;
+                        *to_middle = to_begin + forward_y;
+                        return TRUE;
+                    }
+                }
+            }
+        }
+    }
+
+    return FALSE;
+}
+
+static void
+myers_diff (MyersContext *context,
+            guint from_begin, guint from_end,
+            guint to_begin, guint to_end)
+{
+    guint prefix_size = 0, suffix_size = 0;
+    guint from_middle, to_middle;
+
+    while (from_begin + prefix_size < from_end &&
+           to_begin + prefix_size < to_end &&
+           context->from[from_begin + prefix_size] ==
+           context->to[to_begin + prefix_size]) {
+        prefix_size++;
+    }
+    if (prefix_size > 0)
+        myers_add_match(context, from_begin, to_begin, prefix_size);
+    from_begin += prefix_size;
+    to_begin += prefix_size;
+
+    while (from_begin + suffix_size < from_end &&
+           to_begin + suffix_size < to_end &&
+           context->from[from_end - suffix_size - 1] ==
+           context->to[to_end - suffix_size - 1]) {
+        suffix_size++;
+    }
+    from_end -= suffix_size;
+    to_end -= suffix_size;
+
+    if (from_begin < from_end && to_begin < to_end &&
+        myers_bisect(context,
+                     from_begin, from_end, to_begin, to_end,
+                     &from_middle, &to_middle)) {
+        myers_diff(context, from_begin, from_middle, to_begin, to_middle);
+        myers_diff(context, from_middle, from_end, to_middle, to_end);
+    }
+
+    if (suffix_size > 0)
+        myers_add_match(context, from_end, to_end, suffix_size);
+}
+
+static GList *
+get_matches_by_myers (CutSequenceMatcher *matcher)
+{
+    CutSequenceMatcherPrivate *priv;
+    MyersContext context;
+    gsize v_length;
+
+    priv = CUT_SEQUENCE_MATCHER_GET_PRIVATE(matcher);
+    if (priv->from_length == 0 || priv->to_length == 0)
+        return NULL;
+
+    ensure_tokens(priv);
+    v_length = (priv->from_length + priv->to_length + 1) / 2 * 2 + 2;
+    context.from = priv->from_tokens;
+    context.to = priv->to_tokens;
+    context.forward = g_new(gint, v_length);
+    context.backward = g_new(gint, v_length);
+    context.cost = 0;
+    context.max_cost = priv->max_cost;
+    context.coarse = FALSE;
+    context.matches = NULL;
+
+    myers_diff(&context, 0, priv->from_length, 0, priv->to_length);
+
+    g_free(context.forward);
+    g_free(context.backward);
+    priv->coarse = context.coarse;
+
+    return g_list_reverse(context.matches);
+}
+
+static gboolean
+use_myers (CutSequenceMatcherPrivate *priv)
+{
+    switch (priv->algorithm) {
+    case CUT_SEQUENCE_MATCHER_ALGORITHM_DIFFLIB:
+        return FALSE;
+    case CUT_SEQUENCE_MATCHER_ALGORITHM_MYERS:
+        return TRUE;
+    default:
+        return (guint64)priv->from_length * priv->to_length >
+            MYERS_AUTO_THRESHOLD;
+    }
+}
+
+const GList *
+cut_sequence_matcher_get_matches (CutSequenceMatcher *matcher)
+{
+    CutSequenceMatcherPrivate *priv;
+
+    priv = CUT_SEQUENCE_MATCHER_GET_PRIVATE(matcher);
+    if (priv->matches)
+        return priv->matches;
+
+    if (use_myers(priv))
+        priv->matches = get_matches_by_myers(matcher);
+    else
+        priv->matches = get_matches_by_difflib(matcher);
 
     return priv->matches;
 }
@@ -822,8 +1225,8 @@ cut_sequence_matcher_get_blocks (CutSequenceMatcher *matcher)
         blocks = prepend_match_info(blocks, from_index, to_index, size);
 
     blocks = prepend_match_info(blocks,
-                                g_sequence_get_length(priv->from),
-                                g_sequence_get_length(priv->to),
+                                priv->from_length,
+                                priv->to_length,
                                 0);
     priv->blocks = g_list_reverse(blocks);
 
@@ -1028,7 +1431,7 @@ cut_sequence_matcher_get_ratio (CutSequenceMatcher *matcher)
     if (priv->ratio >= 0.0)
         return priv->ratio;
 
-    length = g_sequence_get_length(priv->from) + g_sequence_get_length(priv->to);
+    length = priv->from_length + priv->to_length;
     if (length == 0) {
         priv->ratio = 1.0;
     } else {
@@ -1066,6 +1469,51 @@ cut_sequence_matcher_set_context_size (CutSequenceMatcher *matcher,
     }
 }
 
+CutSequenceMatcherAlgorithm
+cut_sequence_matcher_get_algorithm (CutSequenceMatcher *matcher)
+{
+    return CUT_SEQUENCE_MATCHER_GET_PRIVATE(matcher)->algorithm;
+}
+
+void
+cut_sequence_matcher_set_algorithm (CutSequenceMatcher         *matcher,
+                                    CutSequenceMatcherAlgorithm algorithm)
+{
+    CutSequenceMatcherPrivate *priv;
+
+    priv = CUT_SEQUENCE_MATCHER_GET_PRIVATE(matcher);
+    if (priv->algorithm != algorithm) {
+        priv->algorithm = algorithm;
+        dispose_results(priv);
+    }
+}
+
+guint64
+cut_sequence_matcher_get_max_cost (CutSequenceMatcher *matcher)
+{
+    return CUT_SEQUENCE_MATCHER_GET_PRIVATE(matcher)->max_cost;
+}
+
+void
+cut_sequence_matcher_set_max_cost (CutSequenceMatcher *matcher,
+                                   guint64             max_cost)
+{
+    CutSequenceMatcherPrivate *priv;
+
+    priv = CUT_SEQUENCE_MATCHER_GET_PRIVATE(matcher);
+    if (priv->max_cost != max_cost) {
+        priv->max_cost = max_cost;
+        dispose_results(priv);
+    }
+}
+
+gboolean
+cut_sequence_matcher_is_coarse (CutSequenceMatcher *matcher)
+{
+    cut_sequence_matcher_get_matches(matcher);
+    return CUT_SEQUENCE_MATCHER_GET_PRIVATE(matcher)->coarse;
+}
+
 /*
 vi:ts=4:nowrap:ai:expandtab:sw=4
 */
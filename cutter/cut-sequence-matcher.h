@@ -1,6 +1,6 @@
 /* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
 /*
- *  Copyright (C) 2008-2010  Kouhei Sutou <kou@clear-code.com>
+ *  Copyright (C) 2008-2014  Kouhei Sutou <kou@clear-code.com>
  *
  *  This library is free software: you can redistribute it and/or modify
  *  it under the terms of the GNU Lesser General Public License as published by
@@ -40,6 +40,14 @@ typedef struct _CutSequenceMatchOperation  CutSequenceMatchOperation;
 
 typedef gboolean (*CutJunkFilterFunc)      (gpointer data, gpointer user_data);
 
+#define CUT_SEQUENCE_MATCHER_DEFAULT_MAX_COST (G_GUINT64_CONSTANT(64) * 1024 * 1024)
+
+typedef enum {
+    CUT_SEQUENCE_MATCHER_ALGORITHM_AUTO,
+    CUT_SEQUENCE_MATCHER_ALGORITHM_DIFFLIB,
+    CUT_SEQUENCE_MATCHER_ALGORITHM_MYERS
+} CutSequenceMatcherAlgorithm;
+
 typedef enum {
     CUT_SEQUENCE_MATCH_OPERATION_EQUAL,
     CUT_SEQUENCE_MATCH_OPERATION_INSERT,
@@ -134,6 +142,14 @@ guint        cut_sequence_matcher_get_context_size
 void         cut_sequence_matcher_set_context_size
                                                  (CutSequenceMatcher *matcher,
                                                   guint               context_size);
+CutSequenceMatcherAlgorithm
+             cut_sequence_matcher_get_algorithm  (CutSequenceMatcher *matcher);
+void         cut_sequence_matcher_set_algorithm  (CutSequenceMatcher *matcher,
+                                                  CutSequenceMatcherAlgorithm algorithm);
+guint64      cut_sequence_matcher_get_max_cost   (CutSequenceMatcher *matcher);
+void         cut_sequence_matcher_set_max_cost   (CutSequenceMatcher *matcher,
+                                                  guint64             max_cost);
+gboolean     cut_sequence_matcher_is_coarse      (CutSequenceMatcher *matcher);
 
 G_END_DECLS
 
@@ -33,6 +33,7 @@
 static gchar *stream_name = NULL;
 static int fd = -1;
 static gchar *directory = NULL;
+static gint buffer_size = -1;
 static CutStreamFactoryBuilder *the_builder = NULL;
 #ifdef G_OS_WIN32
 static gchar *win32_stream_factory_module_dir = NULL;
@@ -155,6 +156,10 @@ set_option_context (CutFactoryBuilder *builder, GOptionContext *context)
          N_("Stream to a file under DIRECTORY (default: none)"), "DIRECTORY"},
         {"stream-log-directory", 0, 0, G_OPTION_ARG_STRING, &directory,
          N_("Obsoleted. Use --stream-directory instead"), "DIRECTORY"},
+        {"stream-buffer-size", 0, 0, G_OPTION_ARG_INT, &buffer_size,
+         N_("Buffer SIZE bytes before streaming. "
+            "0 streams each event immediately"),
+         "SIZE"},
         {NULL}
     };
 
@@ -222,6 +227,11 @@ build (CutFactoryBuilder *builder)
                             "directory", directory,
                             NULL);
 
+    if (factory && buffer_size >= 0 &&
+        g_object_class_find_property(G_OBJECT_GET_CLASS(factory),
+                                     "buffer-size"))
+        g_object_set(factory, "buffer-size", (guint)buffer_size, NULL);
+
     if (factory)
         factories = g_list_prepend(factories, factory);
 
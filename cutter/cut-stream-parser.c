@@ -26,6 +26,8 @@
 #include <glib.h>
 
 #include "cut-stream-parser.h"
+#include "cut-binary-stream-parser.h"
+#include "cut-xml-pull-parser.h"
 #include "cut-backtrace-entry.h"
 
 typedef enum {
@@ -47,6 +49,10 @@ typedef enum {
     IN_TEST_OPTION,
     IN_TEST_START_TIME,
     IN_TEST_ELAPSED,
+    IN_TEST_RESOURCE_USAGE,
+    IN_TEST_RESOURCE_USAGE_VALUE,
+    IN_TEST_PHASE_ELAPSED,
+    IN_TEST_PHASE_ELAPSED_VALUE,
 
     IN_TEST_DATA_NAME,
 
@@ -78,6 +84,9 @@ typedef enum {
 
     IN_PASS_ASSERTION,
 
+    IN_PASS_ASSERTIONS,
+    IN_PASS_ASSERTIONS_N_ASSERTIONS,
+
     IN_TEST_RESULT,
 
     IN_RESULT,
@@ -90,6 +99,10 @@ typedef enum {
     IN_RESULT_BACKTRACE_ENTRY_INFO,
     IN_RESULT_START_TIME,
     IN_RESULT_ELAPSED,
+    IN_RESULT_RESOURCE_USAGE,
+    IN_RESULT_RESOURCE_USAGE_VALUE,
+    IN_RESULT_PHASE_ELAPSED,
+    IN_RESULT_PHASE_ELAPSED_VALUE,
     IN_RESULT_EXPECTED,
     IN_RESULT_ACTUAL,
     IN_RESULT_DIFF,
@@ -157,6 +170,7 @@ struct _PassAssertion
 {
     CutTest *test;
     CutTestContext *test_context;
+    guint n_assertions;
 };
 
 typedef struct _TestResult TestResult;
@@ -199,9 +213,13 @@ typedef struct _CutStreamParserPrivate	CutStreamParserPrivate;
 struct _CutStreamParserPrivate
 {
     GMarkupParseContext *context;
+    CutXMLPullParser *pull_parser;
+    gboolean use_pull_parser;
+    CutBinaryStreamParser *binary_parser;
+    gboolean format_detected;
     CutRunContext *run_context;
 
-    GQueue *states;
+    GArray *states;
     GQueue *iterated_tests;
     GQueue *tests;
     GQueue *test_iterators;
@@ -227,22 +245,54 @@ struct _CutStreamParserPrivate
     CutBacktraceEntry *backtrace_entry;
     gchar *option_name;
     gchar *option_value;
+    CutResourceUsage resource_usage;
+    CutPhaseElapsed phase_elapsed;
+    gchar *value_element_name;
     gboolean complete_success;
     gboolean stream_success;
+    gboolean in_run;
+    gint process_id;
 
     GQueue *element_stack;
 };
 
-#define PUSH_STATE(priv, state)                                 \
-    (g_queue_push_head((priv)->states, GINT_TO_POINTER(state)))
-#define POP_STATE(priv)                                 \
-    (GPOINTER_TO_INT(g_queue_pop_head((priv)->states)))
+static GPrivate current_process_id_private = G_PRIVATE_INIT(NULL);
+
+static void
+push_state (GArray *states, ParseState state)
+{
+    g_array_append_val(states, state);
+}
+
+static ParseState
+peek_nth_state (GArray *states, guint n)
+{
+    if (n >= states->len)
+        return IN_TOP_LEVEL;
+    return g_array_index(states, ParseState, states->len - n - 1);
+}
+
+static ParseState
+pop_state (GArray *states)
+{
+    ParseState state;
+
+    state = peek_nth_state(states, 0);
+    if (states->len > 0)
+        g_array_set_size(states, states->len - 1);
+    return state;
+}
+
+#define PUSH_STATE(priv, state)                 \
+    (push_state((priv)->states, (state)))
+#define POP_STATE(priv)                         \
+    (pop_state((priv)->states))
 #define DROP_STATE(priv)                        \
-    (g_queue_pop_head((priv)->states))
-#define PEEK_STATE(priv)                                        \
-    (GPOINTER_TO_INT(g_queue_peek_head((priv)->states)))
-#define PEEK_NTH_STATE(priv, n)                                 \
-    (GPOINTER_TO_INT(g_queue_peek_nth((priv)->states, n)))
+    (pop_state((priv)->states))
+#define PEEK_STATE(priv)                        \
+    (peek_nth_state((priv)->states, 0))
+#define PEEK_NTH_STATE(priv, n)                 \
+    (peek_nth_state((priv)->states, (n)))
 
 #define PUSH_TEST(priv, test)                                   \
     (g_queue_push_head((priv)->tests, g_object_ref(test)))
@@ -302,6 +352,7 @@ enum
 {
     PROP_0,
     PROP_RUN_CONTEXT,
+    PROP_USE_PULL_PARSER,
 };
 
 enum
@@ -370,6 +421,15 @@ cut_stream_parser_class_init (CutStreamParserClass *klass)
                                G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
     g_object_class_install_property(gobject_class, PROP_RUN_CONTEXT, spec);
 
+    spec = g_param_spec_boolean("use-pull-parser",
+                                "Use pull parser",
+                                "Whether the XML stream is parsed by "
+                                "CutXMLPullParser instead of "
+                                "GMarkupParseContext",
+                                TRUE,
+                                G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property(gobject_class, PROP_USE_PULL_PARSER, spec);
+
     signals[RESULT]
         = g_signal_new("result",
                        G_TYPE_FROM_CLASS(klass),
@@ -387,12 +447,14 @@ cut_stream_parser_init (CutStreamParser *stream_parser)
 {
     CutStreamParserPrivate *priv = CUT_STREAM_PARSER_GET_PRIVATE(stream_parser);
 
-    priv->context = g_markup_parse_context_new(&markup_parser,
-                                               G_MARKUP_TREAT_CDATA_AS_TEXT,
-                                               stream_parser, NULL);
+    priv->context = NULL;
+    priv->pull_parser = NULL;
+    priv->use_pull_parser = TRUE;
+    priv->binary_parser = NULL;
+    priv->format_detected = FALSE;
     priv->run_context = NULL;
 
-    priv->states = g_queue_new();
+    priv->states = g_array_new(FALSE, FALSE, sizeof(ParseState));
     PUSH_STATE(priv, IN_TOP_LEVEL);
     priv->iterated_tests = g_queue_new();
     priv->tests = g_queue_new();
@@ -419,8 +481,11 @@ cut_stream_parser_init (CutStreamParser *stream_parser)
     priv->backtrace_entry = NULL;
     priv->option_name = NULL;
     priv->option_value = NULL;
+    priv->value_element_name = NULL;
     priv->complete_success = TRUE;
     priv->stream_success = TRUE;
+    priv->in_run = FALSE;
+    priv->process_id = 0;
 
     priv->element_stack = g_queue_new();
 }
@@ -617,6 +682,16 @@ dispose (GObject *object)
         priv->context = NULL;
     }
 
+    if (priv->pull_parser) {
+        cut_xml_pull_parser_free(priv->pull_parser);
+        priv->pull_parser = NULL;
+    }
+
+    if (priv->binary_parser) {
+        cut_binary_stream_parser_free(priv->binary_parser);
+        priv->binary_parser = NULL;
+    }
+
     if (priv->run_context) {
         g_object_weak_unref(G_OBJECT(priv->run_context),
                             run_context_weak_notify, object);
@@ -624,7 +699,7 @@ dispose (GObject *object)
     }
 
     if (priv->states) {
-        g_queue_free(priv->states);
+        g_array_free(priv->states, TRUE);
         priv->states = NULL;
     }
 
@@ -735,6 +810,11 @@ dispose (GObject *object)
         priv->option_value = NULL;
     }
 
+    if (priv->value_element_name) {
+        g_free(priv->value_element_name);
+        priv->value_element_name = NULL;
+    }
+
     if (priv->element_stack) {
         g_queue_foreach(priv->element_stack, (GFunc)g_free, NULL);
         g_queue_free(priv->element_stack);
@@ -759,6 +839,9 @@ set_property (GObject      *object,
             g_object_weak_ref(G_OBJECT(priv->run_context),
                               run_context_weak_notify, object);
         break;
+      case PROP_USE_PULL_PARSER:
+        priv->use_pull_parser = g_value_get_boolean(value);
+        break;
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -777,6 +860,9 @@ get_property (GObject    *object,
       case PROP_RUN_CONTEXT:
         g_value_set_object(value, priv->run_context);
         break;
+      case PROP_USE_PULL_PARSER:
+        g_value_set_boolean(value, priv->use_pull_parser);
+        break;
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -791,6 +877,19 @@ cut_stream_parser_new (CutRunContext *run_context)
                         NULL);
 }
 
+CutStreamParser *
+cut_stream_parser_new_in_run (CutRunContext *run_context)
+{
+    CutStreamParser *parser;
+    CutStreamParserPrivate *priv;
+
+    parser = cut_stream_parser_new(run_context);
+    priv = CUT_STREAM_PARSER_GET_PRIVATE(parser);
+    priv->in_run = TRUE;
+
+    return parser;
+}
+
 CutStreamParser *
 cut_test_result_parser_new (void)
 {
@@ -806,23 +905,154 @@ cut_test_result_parser_new (void)
     return parser;
 }
 
+static void
+prepare_xml_parser (CutStreamParser *stream_parser,
+                    CutStreamParserPrivate *priv)
+{
+    if (priv->pull_parser || priv->context)
+        return;
+
+    if (priv->use_pull_parser)
+        priv->pull_parser = cut_xml_pull_parser_new();
+    else
+        priv->context = g_markup_parse_context_new(&markup_parser,
+                                                   G_MARKUP_TREAT_CDATA_AS_TEXT,
+                                                   stream_parser, NULL);
+}
+
+static gboolean
+pull (CutStreamParser *stream_parser, CutStreamParserPrivate *priv,
+      GError **error)
+{
+    CutXMLPullParser *pull_parser = priv->pull_parser;
+    const gchar *text;
+    gsize text_len;
+
+    while (TRUE) {
+        GError *local_error = NULL;
+
+        switch (cut_xml_pull_parser_next(pull_parser, &local_error)) {
+          case CUT_XML_PULL_PARSER_NEED_MORE:
+            return TRUE;
+          case CUT_XML_PULL_PARSER_START_ELEMENT:
+            start_element_handler(NULL,
+                                  cut_xml_pull_parser_get_element_name(pull_parser),
+                                  NULL, NULL, stream_parser, &local_error);
+            break;
+          case CUT_XML_PULL_PARSER_END_ELEMENT:
+            end_element_handler(NULL,
+                                cut_xml_pull_parser_get_element_name(pull_parser),
+                                stream_parser, &local_error);
+            break;
+          case CUT_XML_PULL_PARSER_TEXT:
+            text = cut_xml_pull_parser_get_text(pull_parser, &text_len);
+            text_handler(NULL, text, text_len, stream_parser, &local_error);
+            break;
+          case CUT_XML_PULL_PARSER_ERROR:
+            break;
+        }
+
+        if (local_error) {
+            cut_xml_pull_parser_abort(pull_parser);
+            g_propagate_error(error, local_error);
+            return FALSE;
+        }
+    }
+}
+
+static gboolean
+parse (CutStreamParser *stream_parser, CutStreamParserPrivate *priv,
+       const gchar *text, gsize text_len, GError **error)
+{
+    if (text_len < 0)
+        text_len = strlen(text);
+
+    if (!priv->format_detected && text_len > 0) {
+        priv->format_detected = TRUE;
+        if (PEEK_STATE(priv) == IN_TOP_LEVEL &&
+            text[0] == CUT_BINARY_STREAM_MAGIC[0])
+            priv->binary_parser =
+                cut_binary_stream_parser_new(priv->run_context, priv->in_run);
+    }
+    if (priv->binary_parser)
+        return cut_binary_stream_parser_parse(priv->binary_parser,
+                                              text, text_len, error);
+
+    prepare_xml_parser(stream_parser, priv);
+    if (priv->pull_parser) {
+        cut_xml_pull_parser_feed(priv->pull_parser, text, text_len);
+        return pull(stream_parser, priv, error);
+    }
+
+    return g_markup_parse_context_parse(priv->context, text, text_len, error);
+}
+
+static gboolean
+end_parse (CutStreamParser *stream_parser, CutStreamParserPrivate *priv,
+           GError **error)
+{
+    if (priv->binary_parser)
+        return cut_binary_stream_parser_end_parse(priv->binary_parser, error);
+
+    prepare_xml_parser(stream_parser, priv);
+    if (priv->pull_parser)
+        return cut_xml_pull_parser_end(priv->pull_parser, error);
+
+    return g_markup_parse_context_end_parse(priv->context, error);
+}
+
 gboolean
 cut_stream_parser_parse (CutStreamParser *stream_parser,
                          const gchar *text, gsize text_len, GError **error)
 {
     CutStreamParserPrivate *priv = CUT_STREAM_PARSER_GET_PRIVATE(stream_parser);
+    gpointer previous_process_id;
+    gboolean success;
 
-    if (text_len < 0)
-        text_len = strlen(text);
-    return g_markup_parse_context_parse(priv->context, text, text_len, error);
+    previous_process_id = g_private_get(&current_process_id_private);
+    if (priv->process_id > 0)
+        g_private_set(&current_process_id_private,
+                      GINT_TO_POINTER(priv->process_id));
+    success = parse(stream_parser, priv, text, text_len, error);
+    g_private_set(&current_process_id_private, previous_process_id);
+
+    return success;
 }
 
 gboolean
 cut_stream_parser_end_parse (CutStreamParser *stream_parser, GError **error)
 {
     CutStreamParserPrivate *priv = CUT_STREAM_PARSER_GET_PRIVATE(stream_parser);
+    gpointer previous_process_id;
+    gboolean success;
 
-    return g_markup_parse_context_end_parse(priv->context, error);
+    previous_process_id = g_private_get(&current_process_id_private);
+    if (priv->process_id > 0)
+        g_private_set(&current_process_id_private,
+                      GINT_TO_POINTER(priv->process_id));
+    success = end_parse(stream_parser, priv, error);
+    g_private_set(&current_process_id_private, previous_process_id);
+
+    return success;
+}
+
+void
+cut_stream_parser_set_process_id (CutStreamParser *stream_parser,
+                                  gint process_id)
+{
+    CUT_STREAM_PARSER_GET_PRIVATE(stream_parser)->process_id = process_id;
+}
+
+gint
+cut_stream_parser_get_process_id (CutStreamParser *stream_parser)
+{
+    return CUT_STREAM_PARSER_GET_PRIVATE(stream_parser)->process_id;
+}
+
+gint
+cut_stream_parser_get_current_process_id (void)
+{
+    return GPOINTER_TO_INT(g_private_get(&current_process_id_private));
 }
 
 static gchar *
@@ -854,8 +1084,13 @@ set_parse_error (CutStreamParserPrivate *priv,
     message = g_strdup_vprintf(format, var_args);
     va_end(var_args);
 
-    g_markup_parse_context_get_position(context, &line, &chr);
-    path = element_path(priv->element_stack->head);
+    if (priv->pull_parser) {
+        cut_xml_pull_parser_get_position(priv->pull_parser, &line, &chr);
+        path = cut_xml_pull_parser_get_element_path(priv->pull_parser);
+    } else {
+        g_markup_parse_context_get_position(context, &line, &chr);
+        path = element_path(priv->element_stack->head);
+    }
     g_set_error(error, G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE,
                 "Error on line %d char %d: %s: %s",
                 line, chr, path, message);
@@ -876,7 +1111,7 @@ start_top_level (CutStreamParserPrivate *priv, GMarkupParseContext *context,
 {
     if (g_str_equal("stream", element_name)) {
         PUSH_STATE(priv, IN_STREAM);
-        if (priv->run_context)
+        if (priv->run_context && !priv->in_run)
             g_signal_emit_by_name(priv->run_context, "start-run");
     } else {
         invalid_element(priv, context, error);
@@ -891,6 +1126,9 @@ start_stream (CutStreamParserPrivate *priv,
     if (g_str_equal("pass-assertion", element_name)) {
         PUSH_STATE(priv, IN_PASS_ASSERTION);
         priv->pass_assertion = pass_assertion_new();
+    } else if (g_str_equal("pass-assertions", element_name)) {
+        PUSH_STATE(priv, IN_PASS_ASSERTIONS);
+        priv->pass_assertion = pass_assertion_new();
     } else if (g_str_equal("test-result", element_name)) {
         PUSH_STATE(priv, IN_TEST_RESULT);
         priv->test_result = test_result_new();
@@ -1090,6 +1328,18 @@ start_pass_assertion (CutStreamParserPrivate *priv,
     }
 }
 
+static void
+start_pass_assertions (CutStreamParserPrivate *priv,
+                       GMarkupParseContext *context,
+                       const gchar *element_name, GError **error)
+{
+    if (g_str_equal("n-assertions", element_name)) {
+        PUSH_STATE(priv, IN_PASS_ASSERTIONS_N_ASSERTIONS);
+    } else {
+        start_pass_assertion(priv, context, element_name, error);
+    }
+}
+
 static void
 start_test_result (CutStreamParserPrivate *priv,
                    GMarkupParseContext *context,
@@ -1179,6 +1429,12 @@ start_result (CutStreamParserPrivate *priv, GMarkupParseContext *context,
         PUSH_STATE(priv, IN_RESULT_START_TIME);
     } else if (g_str_equal("elapsed", element_name)) {
         PUSH_STATE(priv, IN_RESULT_ELAPSED);
+    } else if (g_str_equal("resource-usage", element_name)) {
+        PUSH_STATE(priv, IN_RESULT_RESOURCE_USAGE);
+        memset(&(priv->resource_usage), 0, sizeof(priv->resource_usage));
+    } else if (g_str_equal("phase-elapsed", element_name)) {
+        PUSH_STATE(priv, IN_RESULT_PHASE_ELAPSED);
+        cut_phase_elapsed_init(&(priv->phase_elapsed));
     } else if (g_str_equal("expected", element_name)) {
         PUSH_STATE(priv, IN_RESULT_EXPECTED);
     } else if (g_str_equal("actual", element_name)) {
@@ -1329,11 +1585,28 @@ start_test_object (CutStreamParserPrivate *priv, GMarkupParseContext *context,
         PUSH_STATE(priv, IN_TEST_START_TIME);
     } else if (g_str_equal("elapsed", element_name)) {
         PUSH_STATE(priv, IN_TEST_ELAPSED);
+    } else if (g_str_equal("resource-usage", element_name)) {
+        PUSH_STATE(priv, IN_TEST_RESOURCE_USAGE);
+        memset(&(priv->resource_usage), 0, sizeof(priv->resource_usage));
+    } else if (g_str_equal("phase-elapsed", element_name)) {
+        PUSH_STATE(priv, IN_TEST_PHASE_ELAPSED);
+        cut_phase_elapsed_init(&(priv->phase_elapsed));
     } else {
         invalid_element(priv, context, error);
     }
 }
 
+static void
+start_value_element (CutStreamParserPrivate *priv,
+                     GMarkupParseContext *context,
+                     const gchar *element_name, ParseState value_state,
+                     GError **error)
+{
+    g_free(priv->value_element_name);
+    priv->value_element_name = g_strdup(element_name);
+    PUSH_STATE(priv, value_state);
+}
+
 static void
 start_test_option (CutStreamParserPrivate *priv, GMarkupParseContext *context,
                    const gchar *element_name, GError **error)
@@ -1461,7 +1734,8 @@ start_element_handler (GMarkupParseContext *context,
     ParseState state;
 
     priv = CUT_STREAM_PARSER_GET_PRIVATE(parser);
-    g_queue_push_tail(priv->element_stack, g_strdup(element_name));
+    if (!priv->pull_parser)
+        g_queue_push_tail(priv->element_stack, g_strdup(element_name));
 
     state = PEEK_STATE(priv);
     switch (state) {
@@ -1498,6 +1772,9 @@ start_element_handler (GMarkupParseContext *context,
       case IN_PASS_ASSERTION:
         start_pass_assertion(priv, context, element_name, error);
         break;
+      case IN_PASS_ASSERTIONS:
+        start_pass_assertions(priv, context, element_name, error);
+        break;
       case IN_TEST_RESULT:
         start_test_result(priv, context, element_name, error);
         break;
@@ -1538,6 +1815,22 @@ start_element_handler (GMarkupParseContext *context,
       case IN_TEST_OPTION:
         start_test_option(priv, context, element_name, error);
         break;
+      case IN_TEST_RESOURCE_USAGE:
+        start_value_element(priv, context, element_name,
+                            IN_TEST_RESOURCE_USAGE_VALUE, error);
+        break;
+      case IN_RESULT_RESOURCE_USAGE:
+        start_value_element(priv, context, element_name,
+                            IN_RESULT_RESOURCE_USAGE_VALUE, error);
+        break;
+      case IN_TEST_PHASE_ELAPSED:
+        start_value_element(priv, context, element_name,
+                            IN_TEST_PHASE_ELAPSED_VALUE, error);
+        break;
+      case IN_RESULT_PHASE_ELAPSED:
+        start_value_element(priv, context, element_name,
+                            IN_RESULT_PHASE_ELAPSED_VALUE, error);
+        break;
       case IN_RESULT_BACKTRACE:
         start_result_backtrace(priv, context, element_name, error);
         break;
@@ -1572,7 +1865,7 @@ end_stream (CutStreamParser *parser, CutStreamParserPrivate *priv,
             GMarkupParseContext *context,
             const gchar *element_name, GError **error)
 {
-    if (priv->run_context)
+    if (priv->run_context && !priv->in_run)
         cut_run_context_emit_complete_run(priv->run_context,
                                           priv->stream_success);
 }
@@ -1633,6 +1926,61 @@ end_test_option (CutStreamParser *parser, CutStreamParserPrivate *priv,
     }
 }
 
+static CutTest *target_test_object (CutStreamParserPrivate *priv,
+                                    ParseState              parent_state);
+
+static void
+end_test_resource_usage (CutStreamParser *parser,
+                         CutStreamParserPrivate *priv,
+                         GMarkupParseContext *context,
+                         const gchar *element_name, GError **error)
+{
+    CutTest *target;
+
+    target = target_test_object(priv, PEEK_STATE(priv));
+    if (target) {
+        cut_test_set_resource_usage(target, &(priv->resource_usage));
+    } else {
+        set_parse_error(priv, context, error,
+                        "can't find test resource usage target");
+    }
+}
+
+static void
+end_result_resource_usage (CutStreamParser *parser,
+                           CutStreamParserPrivate *priv,
+                           GMarkupParseContext *context,
+                           const gchar *element_name, GError **error)
+{
+    cut_test_result_set_resource_usage(priv->result, &(priv->resource_usage));
+}
+
+static void
+end_test_phase_elapsed (CutStreamParser *parser,
+                        CutStreamParserPrivate *priv,
+                        GMarkupParseContext *context,
+                        const gchar *element_name, GError **error)
+{
+    CutTest *target;
+
+    target = target_test_object(priv, PEEK_STATE(priv));
+    if (target) {
+        cut_test_set_phase_elapsed(target, &(priv->phase_elapsed));
+    } else {
+        set_parse_error(priv, context, error,
+                        "can't find test phase elapsed target");
+    }
+}
+
+static void
+end_result_phase_elapsed (CutStreamParser *parser,
+                          CutStreamParserPrivate *priv,
+                          GMarkupParseContext *context,
+                          const gchar *element_name, GError **error)
+{
+    cut_test_result_set_phase_elapsed(priv->result, &(priv->phase_elapsed));
+}
+
 static void
 end_result_backtrace (CutStreamParser *parser, CutStreamParserPrivate *priv,
                       GMarkupParseContext *context,
@@ -1841,6 +2189,28 @@ end_pass_assertion (CutStreamParser *parser, CutStreamParserPrivate *priv,
     priv->pass_assertion = NULL;
 }
 
+static void
+end_pass_assertions (CutStreamParser *parser, CutStreamParserPrivate *priv,
+                     GMarkupParseContext *context,
+                     const gchar *element_name, GError **error)
+{
+    if (!priv->pass_assertion)
+        return;
+
+    if (priv->run_context && priv->pass_assertion->n_assertions > 0)
+        g_signal_emit_by_name(priv->run_context, "pass-assertions",
+                              priv->pass_assertion->test,
+                              priv->pass_assertion->test_context,
+                              priv->pass_assertion->n_assertions);
+
+    if (priv->pass_assertion->test)
+        DROP_TEST(priv);
+    if (priv->pass_assertion->test_context)
+        DROP_TEST_CONTEXT(priv);
+    pass_assertion_free(priv->pass_assertion);
+    priv->pass_assertion = NULL;
+}
+
 static void
 end_test_result (CutStreamParser *parser, CutStreamParserPrivate *priv,
                  GMarkupParseContext *context,
@@ -2072,6 +2442,18 @@ end_element_handler (GMarkupParseContext *context,
     case IN_TEST_OPTION:
         end_test_option(parser, priv, context, element_name, error);
         break;
+    case IN_TEST_RESOURCE_USAGE:
+        end_test_resource_usage(parser, priv, context, element_name, error);
+        break;
+    case IN_RESULT_RESOURCE_USAGE:
+        end_result_resource_usage(parser, priv, context, element_name, error);
+        break;
+    case IN_TEST_PHASE_ELAPSED:
+        end_test_phase_elapsed(parser, priv, context, element_name, error);
+        break;
+    case IN_RESULT_PHASE_ELAPSED:
+        end_result_phase_elapsed(parser, priv, context, element_name, error);
+        break;
     case IN_RESULT_BACKTRACE:
         end_result_backtrace(parser, priv, context, element_name, error);
         break;
@@ -2105,6 +2487,9 @@ end_element_handler (GMarkupParseContext *context,
     case IN_PASS_ASSERTION:
         end_pass_assertion(parser, priv, context, element_name, error);
         break;
+    case IN_PASS_ASSERTIONS:
+        end_pass_assertions(parser, priv, context, element_name, error);
+        break;
     case IN_TEST_RESULT:
         end_test_result(parser, priv, context, element_name, error);
         break;
@@ -2133,7 +2518,8 @@ end_element_handler (GMarkupParseContext *context,
         break;
     }
 
-    g_free(g_queue_pop_tail(priv->element_stack));
+    if (!priv->pull_parser)
+        g_free(g_queue_pop_tail(priv->element_stack));
 }
 
 static CutTestResultStatus
@@ -2317,6 +2703,32 @@ text_test_elapsed (CutStreamParserPrivate *priv,
     }
 }
 
+static void
+text_resource_usage_value (CutStreamParserPrivate *priv,
+                           GMarkupParseContext *context,
+                           const gchar *text, gsize text_len, GError **error)
+{
+    if (!cut_resource_usage_set_value(&(priv->resource_usage),
+                                      priv->value_element_name, text)) {
+        set_parse_error(priv, context, error,
+                        "invalid resource usage value: %s: %s",
+                        priv->value_element_name, text);
+    }
+}
+
+static void
+text_phase_elapsed_value (CutStreamParserPrivate *priv,
+                          GMarkupParseContext *context,
+                          const gchar *text, gsize text_len, GError **error)
+{
+    if (!cut_phase_elapsed_set_value(&(priv->phase_elapsed),
+                                     priv->value_element_name, text)) {
+        set_parse_error(priv, context, error,
+                        "invalid phase elapsed value: %s: %s",
+                        priv->value_element_name, text);
+    }
+}
+
 static void
 text_result_status (CutStreamParserPrivate *priv, GMarkupParseContext *context,
                     const gchar *text, gsize text_len, GError **error)
@@ -2474,6 +2886,20 @@ text_ready_test_suite_n_tests (CutStreamParserPrivate *priv,
     }
 }
 
+static void
+text_pass_assertions_n_assertions (CutStreamParserPrivate *priv,
+                                   GMarkupParseContext *context,
+                                   const gchar *text, gsize text_len,
+                                   GError **error)
+{
+    if (is_integer(text)) {
+        priv->pass_assertion->n_assertions = atoi(text);
+    } else {
+        set_parse_error(priv, context, error,
+                        "invalid # of assertions: %s", text);
+    }
+}
+
 static void
 text_ready_test_case_n_tests (CutStreamParserPrivate *priv,
                               GMarkupParseContext *context,
@@ -2579,6 +3005,14 @@ text_handler (GMarkupParseContext *context,
     case IN_TEST_ELAPSED:
         text_test_elapsed(priv, context, text, text_len, error);
         break;
+    case IN_TEST_RESOURCE_USAGE_VALUE:
+    case IN_RESULT_RESOURCE_USAGE_VALUE:
+        text_resource_usage_value(priv, context, text, text_len, error);
+        break;
+    case IN_TEST_PHASE_ELAPSED_VALUE:
+    case IN_RESULT_PHASE_ELAPSED_VALUE:
+        text_phase_elapsed_value(priv, context, text, text_len, error);
+        break;
     case IN_RESULT_STATUS:
         text_result_status(priv, context, text, text_len, error);
         break;
@@ -2621,6 +3055,10 @@ text_handler (GMarkupParseContext *context,
     case IN_READY_TEST_CASE_N_TESTS:
         text_ready_test_case_n_tests(priv, context, text, text_len, error);
         break;
+    case IN_PASS_ASSERTIONS_N_ASSERTIONS:
+        text_pass_assertions_n_assertions(priv, context, text, text_len,
+                                          error);
+        break;
     case IN_READY_TEST_ITERATOR_N_TESTS:
         text_ready_test_iterator_n_tests(priv, context, text, text_len, error);
         break;
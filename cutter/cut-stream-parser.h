@@ -53,6 +53,7 @@ struct _CutStreamParserClass
 GType            cut_stream_parser_get_type  (void) G_GNUC_CONST;
 
 CutStreamParser *cut_stream_parser_new       (CutRunContext   *run_context);
+CutStreamParser *cut_stream_parser_new_in_run(CutRunContext   *run_context);
 CutStreamParser *cut_test_result_parser_new  (void);
 
 gboolean         cut_stream_parser_parse     (CutStreamParser *parser,
@@ -62,6 +63,20 @@ gboolean         cut_stream_parser_parse     (CutStreamParser *parser,
 gboolean         cut_stream_parser_end_parse (CutStreamParser *stream_parser,
                                               GError         **error);
 
+/*
+ * The process ID of the process that writes the parsed
+ * stream. While a parser that has it parses, signals are
+ * emitted with it as the current process ID in the thread.
+ * 0 means that the stream is from the current process.
+ */
+void             cut_stream_parser_set_process_id
+                                             (CutStreamParser *stream_parser,
+                                              gint             process_id);
+gint             cut_stream_parser_get_process_id
+                                             (CutStreamParser *stream_parser);
+gint             cut_stream_parser_get_current_process_id
+                                             (void);
+
 G_END_DECLS
 
 #endif /* __CUT_STREAM_PARSER_H__ */
@@ -283,6 +283,16 @@ cut_stream_reader_read_from_io_channel_to_end (CutStreamReader *stream_reader,
     return succeeded;
 }
 
+void
+cut_stream_reader_set_process_id (CutStreamReader *stream_reader,
+                                  gint process_id)
+{
+    CutStreamReaderPrivate *priv;
+
+    priv = CUT_STREAM_READER_GET_PRIVATE(stream_reader);
+    cut_stream_parser_set_process_id(priv->parser, process_id);
+}
+
 gboolean
 cut_stream_reader_read (CutStreamReader *stream_reader,
                         const gchar *stream, gsize length)
@@ -75,6 +75,9 @@ gboolean       cut_stream_reader_read      (CutStreamReader *stream_reader,
                                             const gchar     *stream,
                                             gsize            length);
 gboolean       cut_stream_reader_end_read  (CutStreamReader *stream_reader);
+void           cut_stream_reader_set_process_id
+                                           (CutStreamReader *stream_reader,
+                                            gint             process_id);
 
 G_END_DECLS
 
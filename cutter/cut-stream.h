@@ -34,6 +34,17 @@ G_BEGIN_DECLS
 typedef gboolean (*CutStreamFunction) (const gchar *message,
                                        GError **error,
                                        gpointer user_data);
+typedef gboolean (*CutStreamWriteFunction) (const gchar *data,
+                                            gsize length,
+                                            GError **error,
+                                            gpointer user_data);
+typedef gboolean (*CutStreamVectorFunction) (const gchar **messages,
+                                             const gsize *lengths,
+                                             guint n_messages,
+                                             GError **error,
+                                             gpointer user_data);
+
+#define CUT_STREAM_DEFAULT_BUFFER_SIZE (64 * 1024)
 
 typedef struct _CutStream         CutStream;
 typedef struct _CutStreamClass    CutStreamClass;
@@ -390,6 +390,33 @@ cut_sub_process_set_max_threads (CutSubProcess *sub_process,
     cut_run_context_set_max_threads(pipeline, max_threads);
 }
 
+int
+cut_sub_process_get_shard_index (CutSubProcess *sub_process)
+{
+    CutRunContext *pipeline;
+
+    pipeline = CUT_SUB_PROCESS_GET_PRIVATE(sub_process)->pipeline;
+    return cut_run_context_get_shard_index(pipeline);
+}
+
+int
+cut_sub_process_get_shard_count (CutSubProcess *sub_process)
+{
+    CutRunContext *pipeline;
+
+    pipeline = CUT_SUB_PROCESS_GET_PRIVATE(sub_process)->pipeline;
+    return cut_run_context_get_shard_count(pipeline);
+}
+
+void
+cut_sub_process_set_shard (CutSubProcess *sub_process, int index, int count)
+{
+    CutRunContext *pipeline;
+
+    pipeline = CUT_SUB_PROCESS_GET_PRIVATE(sub_process)->pipeline;
+    cut_run_context_set_shard(pipeline, index, count);
+}
+
 const char **
 cut_sub_process_get_exclude_files (CutSubProcess  *sub_process)
 {
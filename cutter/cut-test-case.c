@@ -401,13 +401,24 @@ run_test (CutTestCase *test_case, CutTest *test,
           CutTestContext *test_context, CutRunContext *run_context)
 {
     gboolean success = TRUE;
+    gboolean measure_phases;
 
+    measure_phases = cut_run_context_get_measure_phases(run_context);
     if (CUT_IS_TEST_ITERATOR(test)) {
         g_signal_emit_by_name(test_case, "start-test-iterator",
                               test, test_context);
     } else {
         g_signal_emit_by_name(test_case, "start-test", test, test_context);
+        if (cut_run_context_get_measure_resource_usage(run_context))
+            cut_test_start_resource_usage(
+                test, cut_run_context_is_multi_thread(run_context));
+        if (measure_phases) {
+            cut_test_set_phase_elapsed(test, NULL);
+            cut_test_start_phase(test, CUT_TEST_PHASE_SETUP);
+        }
         cut_test_case_run_setup(test_case, test_context);
+        if (measure_phases)
+            cut_test_stop_phase(test, CUT_TEST_PHASE_SETUP);
     }
 
     if (cut_test_context_is_failed(test_context)) {
@@ -420,7 +431,7 @@ run_test (CutTestCase *test_case, CutTest *test,
         g_signal_emit_by_name(test_case, "complete-test-iterator",
                               test, test_context, success);
     } else {
-        cut_test_case_run_teardown(test_case, test_context);
+        cut_test_run_teardown(test, test_context, run_context);
         g_signal_emit_by_name(test_case, "complete-test",
                               test, test_context, success);
     }
@@ -429,7 +440,8 @@ run_test (CutTestCase *test_case, CutTest *test,
 }
 
 static gboolean
-run (CutTestCase *test_case, CutTest *test, CutRunContext *run_context)
+run (CutTestCase *test_case, CutTest *test, CutRunContext *run_context,
+     CutTestResultStatus *status)
 {
     CutTestContext *test_context;
     gboolean success = TRUE;
@@ -450,6 +462,7 @@ run (CutTestCase *test_case, CutTest *test, CutRunContext *run_context)
     cut_test_context_set_test(test_context, test);
     success = run_test(test_case, test, test_context, run_context);
     cut_test_context_set_test(test_context, NULL);
+    *status = MAX(*status, cut_test_context_get_result_status(test_context));
 
     g_object_unref(test_context);
     cut_test_context_current_pop();
@@ -461,15 +474,6 @@ run (CutTestCase *test_case, CutTest *test, CutRunContext *run_context)
     return success;
 }
 
-static void
-cb_test_status (CutTest *test, CutTestContext *context, CutTestResult *result,
-                gpointer data)
-{
-    CutTestResultStatus *status = data;
-
-    *status = MAX(*status, cut_test_result_get_status(result));
-}
-
 static void
 cut_test_case_run_startup (CutTestCase *test_case, CutTestContext *test_context)
 {
@@ -544,25 +548,8 @@ run_tests (CutTestCase *test_case, CutRunContext *run_context,
             continue;
 
         if (CUT_IS_TEST(test)) {
-            g_signal_connect(test, "success", G_CALLBACK(cb_test_status),
-                             status);
-            g_signal_connect(test, "failure", G_CALLBACK(cb_test_status),
-                             status);
-            g_signal_connect(test, "error", G_CALLBACK(cb_test_status),
-                             status);
-            g_signal_connect(test, "pending", G_CALLBACK(cb_test_status),
-                             status);
-            g_signal_connect(test, "notification", G_CALLBACK(cb_test_status),
-                             status);
-            g_signal_connect(test, "omission", G_CALLBACK(cb_test_status),
-                             status);
-            g_signal_connect(test, "crash", G_CALLBACK(cb_test_status),
-                             status);
-            if (!run(test_case, test, run_context))
+            if (!run(test_case, test, run_context, status))
                 all_success = FALSE;
-            g_signal_handlers_disconnect_by_func(test,
-                                                 G_CALLBACK(cb_test_status),
-                                                 status);
         } else {
             g_warning("This object is not CutTest object");
         }
@@ -592,6 +579,11 @@ cut_test_case_run_tests (CutTestCase *test_case, CutRunContext *run_context,
     jmp_buf jump_buffer;
     CutTestSuite *test_suite;
     CutCrashBacktrace *crash_backtrace = NULL;
+    gboolean measure_phases;
+
+    measure_phases = cut_run_context_get_measure_phases(run_context);
+    if (measure_phases)
+        cut_test_set_phase_elapsed(CUT_TEST(test_case), NULL);
 
     g_signal_emit_by_name(test_case, "ready", g_list_length((GList *)tests));
     g_signal_emit_by_name(CUT_TEST(test_case), "start", NULL);
@@ -615,8 +607,7 @@ cut_test_case_run_tests (CutTestCase *test_case, CutRunContext *run_context,
 
 #undef CONNECT
 
-    if (cut_run_context_is_multi_thread(run_context) ||
-        !cut_run_context_get_handle_signals(run_context)) {
+    if (!cut_run_context_get_handle_signals(run_context)) {
         signum = 0;
     } else {
         crash_backtrace = cut_crash_backtrace_new(&jump_buffer);
@@ -624,17 +615,17 @@ cut_test_case_run_tests (CutTestCase *test_case, CutRunContext *run_context,
     }
     switch (signum) {
     case 0:
+        if (measure_phases)
+            cut_test_start_phase(CUT_TEST(test_case), CUT_TEST_PHASE_STARTUP);
         cut_test_case_run_startup(test_case, test_context);
+        if (measure_phases)
+            cut_test_stop_phase(CUT_TEST(test_case), CUT_TEST_PHASE_STARTUP);
         if (cut_test_context_is_failed(test_context)) {
             all_success = FALSE;
         } else {
             if (status != CUT_TEST_RESULT_OMISSION)
                 all_success = run_tests(test_case, run_context, tests, &status);
         }
-
-        if (crash_backtrace)
-            cut_crash_backtrace_free(crash_backtrace);
-
         break;
 #ifndef G_OS_WIN32
     case SIGSEGV:
@@ -642,7 +633,8 @@ cut_test_case_run_tests (CutTestCase *test_case, CutRunContext *run_context,
     case SIGTERM:
     case SIGBUS:
         all_success = FALSE;
-        cut_crash_backtrace_emit(test_suite, test_case, NULL, NULL, NULL,
+        cut_crash_backtrace_emit(crash_backtrace,
+                                 test_suite, test_case, NULL, NULL, NULL,
                                  test_context);
         break;
     case SIGINT:
@@ -653,7 +645,14 @@ cut_test_case_run_tests (CutTestCase *test_case, CutRunContext *run_context,
         break;
     }
 
+    if (crash_backtrace)
+        cut_crash_backtrace_free(crash_backtrace);
+
+    if (measure_phases)
+        cut_test_start_phase(CUT_TEST(test_case), CUT_TEST_PHASE_SHUTDOWN);
     cut_test_case_run_shutdown(test_case, test_context);
+    if (measure_phases)
+        cut_test_stop_phase(CUT_TEST(test_case), CUT_TEST_PHASE_SHUTDOWN);
 
     g_signal_handlers_disconnect_by_func(test_case,
                                          G_CALLBACK(cb_test_case_status_in),
@@ -53,10 +53,15 @@
 #include "cut-process.h"
 #include "cut-backtrace-entry.h"
 #include "cut-utils.h"
+#include "cut-event-sink.h"
 #include "cut-glib-compatible.h"
 
 #define CUT_SIGNAL_EXPLICIT_JUMP G_MININT
 
+/* Passed assertions are reported by "pass-assertions" per
+ * this number of assertions at most. */
+#define PASS_ASSERTIONS_FLUSH_SIZE 1000
+
 #define cut_omit(context, message) do                           \
 {                                                               \
     cut_test_context_register_result(context,                   \
@@ -100,6 +105,10 @@ struct _CutTestContextPrivate
     guint user_message_jump_nest;
     GThread *main_thread;
     CutTestContext *parent;
+    volatile gint n_unreported_pass_assertions;
+    const CutEventSink *event_sink;
+    gpointer event_sink_data;
+    CutTestResultStatus result_status;
 };
 
 enum
@@ -295,6 +304,12 @@ cut_test_context_init (CutTestContext *context)
     priv->main_thread = g_thread_self();
 
     priv->parent = NULL;
+
+    priv->n_unreported_pass_assertions = 0;
+
+    priv->event_sink = NULL;
+    priv->event_sink_data = NULL;
+    priv->result_status = CUT_TEST_RESULT_SUCCESS;
 }
 
 static void
@@ -686,6 +701,7 @@ cut_test_context_set_test (CutTestContext *context, CutTest *test)
 {
     CutTestContextPrivate *priv = CUT_TEST_CONTEXT_GET_PRIVATE(context);
 
+    cut_test_context_flush_pass_assertions(context);
     if (priv->test)
         g_object_unref(priv->test);
     if (test)
@@ -872,10 +888,14 @@ cut_test_context_long_jump (CutTestContext *context)
     }
 }
 
+static guint pass_assertion_signal_id = 0;
+
 void
 cut_test_context_pass_assertion (CutTestContext *context)
 {
     CutTestContextPrivate *priv;
+    const CutEventSink *sink;
+    gpointer sink_data;
 
     g_return_if_fail(CUT_IS_TEST_CONTEXT(context));
 
@@ -883,7 +903,62 @@ cut_test_context_pass_assertion (CutTestContext *context)
     g_return_if_fail(priv->test);
 
     clear_user_message(priv);
-    g_signal_emit_by_name(priv->test, "pass-assertion", context);
+
+    if (!pass_assertion_signal_id)
+        pass_assertion_signal_id = g_signal_lookup("pass-assertion",
+                                                   CUT_TYPE_TEST);
+
+    /* A passed assertion is reported either one by one or in
+     * batch, never both. The batch is also emitted as
+     * "pass-assertions" of the test. */
+    sink = cut_test_context_get_event_sink(context, &sink_data);
+    if (sink) {
+        if (sink->pass_assertion) {
+            if (g_signal_has_handler_pending(priv->test,
+                                             pass_assertion_signal_id,
+                                             0, FALSE))
+                g_signal_emit(priv->test, pass_assertion_signal_id, 0,
+                              context);
+            sink->pass_assertion(priv->test, context, sink_data);
+            return;
+        }
+    } else if (g_signal_has_handler_pending(priv->test,
+                                            pass_assertion_signal_id,
+                                            0, FALSE)) {
+        g_signal_emit(priv->test, pass_assertion_signal_id, 0, context);
+        return;
+    }
+
+    if (g_atomic_int_add(&(priv->n_unreported_pass_assertions), 1) + 1 >=
+        PASS_ASSERTIONS_FLUSH_SIZE)
+        cut_test_context_flush_pass_assertions(context);
+}
+
+void
+cut_test_context_flush_pass_assertions (CutTestContext *context)
+{
+    CutTestContextPrivate *priv;
+    const CutEventSink *sink;
+    gpointer sink_data;
+    gint n_assertions;
+
+    priv = CUT_TEST_CONTEXT_GET_PRIVATE(context);
+    do {
+        n_assertions = g_atomic_int_get(&(priv->n_unreported_pass_assertions));
+        if (n_assertions == 0)
+            return;
+    } while (!g_atomic_int_compare_and_exchange(
+                 &(priv->n_unreported_pass_assertions), n_assertions, 0));
+
+    if (!priv->test)
+        return;
+
+    g_signal_emit_by_name(priv->test, "pass-assertions",
+                          context, (guint)n_assertions);
+    sink = cut_test_context_get_event_sink(context, &sink_data);
+    if (sink)
+        sink->pass_assertions(priv->test, context, (guint)n_assertions,
+                              sink_data);
 }
 
 static CutProcess *
@@ -1074,6 +1149,63 @@ cut_test_context_need_test_run (CutTestContext *context)
         !CUT_TEST_CONTEXT_GET_PRIVATE(context)->omitted;
 }
 
+void
+cut_test_context_set_event_sink (CutTestContext *context,
+                                 const CutEventSink *sink,
+                                 gpointer user_data)
+{
+    CutTestContextPrivate *priv;
+
+    priv = CUT_TEST_CONTEXT_GET_PRIVATE(context);
+    priv->event_sink = sink;
+    priv->event_sink_data = user_data;
+}
+
+const CutEventSink *
+cut_test_context_get_event_sink (CutTestContext *context, gpointer *user_data)
+{
+    CutTestContextPrivate *priv;
+
+    priv = CUT_TEST_CONTEXT_GET_PRIVATE(context);
+    /* A sub context created in a thread in a test reports
+     * to the sink of the test. */
+    while (!priv->event_sink && priv->parent)
+        priv = CUT_TEST_CONTEXT_GET_PRIVATE(priv->parent);
+
+    if (user_data)
+        *user_data = priv->event_sink_data;
+    return priv->event_sink;
+}
+
+void
+cut_test_context_update_result_status (CutTestContext *context,
+                                       CutTestResultStatus status)
+{
+    CutTestContextPrivate *priv;
+
+    priv = CUT_TEST_CONTEXT_GET_PRIVATE(context);
+    g_mutex_lock(priv->mutex);
+    priv->result_status = MAX(priv->result_status, status);
+    g_mutex_unlock(priv->mutex);
+
+    if (priv->parent)
+        cut_test_context_update_result_status(priv->parent, status);
+}
+
+CutTestResultStatus
+cut_test_context_get_result_status (CutTestContext *context)
+{
+    CutTestContextPrivate *priv;
+    CutTestResultStatus status;
+
+    priv = CUT_TEST_CONTEXT_GET_PRIVATE(context);
+    g_mutex_lock(priv->mutex);
+    status = priv->result_status;
+    g_mutex_unlock(priv->mutex);
+
+    return status;
+}
+
 const void *
 cut_test_context_take (CutTestContext *context,
                        void           *object,
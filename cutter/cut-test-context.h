@@ -108,9 +108,17 @@ void          cut_test_context_set_failed     (CutTestContext *context,
                                                gboolean        failed);
 gboolean      cut_test_context_is_failed      (CutTestContext *context);
 gboolean      cut_test_context_need_test_run  (CutTestContext *context);
+void          cut_test_context_update_result_status
+                                              (CutTestContext *context,
+                                               CutTestResultStatus status);
+CutTestResultStatus
+              cut_test_context_get_result_status
+                                              (CutTestContext *context);
 
 void          cut_test_context_emit_signal    (CutTestContext *context,
                                                CutTestResult  *result);
+void          cut_test_context_flush_pass_assertions
+                                              (CutTestContext *context);
 
 gchar        *cut_test_context_to_xml         (CutTestContext *context);
 void          cut_test_context_to_xml_string  (CutTestContext *context,
@@ -0,0 +1,406 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <glib.h>
+#include <glib-compatible/glib-compatible.h>
+
+#include "cut-test-history.h"
+#include "cut-file-stream-reader.h"
+#include "cut-test-case.h"
+#include "cut-test-context.h"
+#include "cut-iterated-test.h"
+#include "cut-test-data.h"
+
+struct _CutTestHistory
+{
+    guint n_runs;
+    GHashTable *test_case_samples;
+    GHashTable *test_samples;
+};
+
+static void
+samples_free (GArray *samples)
+{
+    g_array_free(samples, TRUE);
+}
+
+CutTestHistory *
+cut_test_history_new (void)
+{
+    CutTestHistory *history;
+
+    history = g_new0(CutTestHistory, 1);
+    history->n_runs = 0;
+    history->test_case_samples =
+        g_hash_table_new_full(g_str_hash, g_str_equal,
+                              g_free, (GDestroyNotify)samples_free);
+    history->test_samples =
+        g_hash_table_new_full(g_str_hash, g_str_equal,
+                              g_free, (GDestroyNotify)samples_free);
+
+    return history;
+}
+
+void
+cut_test_history_free (CutTestHistory *history)
+{
+    g_hash_table_unref(history->test_case_samples);
+    g_hash_table_unref(history->test_samples);
+    g_free(history);
+}
+
+static void
+add_sample (GHashTable *table, const gchar *key, gdouble elapsed)
+{
+    GArray *samples;
+
+    if (elapsed < 0.0)
+        return;
+
+    samples = g_hash_table_lookup(table, key);
+    if (!samples) {
+        samples = g_array_new(FALSE, FALSE, sizeof(gdouble));
+        g_hash_table_insert(table, g_strdup(key), samples);
+    }
+    g_array_append_val(samples, elapsed);
+}
+
+static gint
+compare_double (gconstpointer a, gconstpointer b)
+{
+    gdouble value1 = *(const gdouble *)a;
+    gdouble value2 = *(const gdouble *)b;
+
+    if (value1 < value2)
+        return -1;
+    else if (value1 > value2)
+        return 1;
+    else
+        return 0;
+}
+
+/* values are sorted in place. */
+static gdouble
+median (gdouble *values, guint n)
+{
+    qsort(values, n, sizeof(gdouble), compare_double);
+    if (n % 2 == 1)
+        return values[n / 2];
+    else
+        return (values[n / 2 - 1] + values[n / 2]) / 2.0;
+}
+
+static gboolean
+get_median (GHashTable *table, const gchar *key, gdouble *elapsed)
+{
+    GArray *samples;
+    gdouble *sorted;
+    guint n;
+
+    samples = g_hash_table_lookup(table, key);
+    if (!samples || samples->len == 0)
+        return FALSE;
+
+    n = samples->len;
+    sorted = g_memdup(samples->data, sizeof(gdouble) * n);
+    *elapsed = median(sorted, n);
+    g_free(sorted);
+
+    return TRUE;
+}
+
+static gchar *
+test_key (const gchar *test_case_name, const gchar *test_name)
+{
+    return g_strconcat(test_case_name ? test_case_name : "", "\n",
+                       test_name, NULL);
+}
+
+/* Each test data of an iterated test has its own samples. */
+static gchar *
+iterated_test_key (const gchar *test_case_name, const gchar *test_name,
+                   const gchar *data_name)
+{
+    return g_strconcat(test_case_name ? test_case_name : "", "\n",
+                       test_name, "\n",
+                       data_name ? data_name : "", NULL);
+}
+
+void
+cut_test_history_add_test_case_elapsed (CutTestHistory *history,
+                                        const gchar *test_case_name,
+                                        gdouble elapsed)
+{
+    add_sample(history->test_case_samples, test_case_name, elapsed);
+}
+
+void
+cut_test_history_add_test_elapsed (CutTestHistory *history,
+                                   const gchar *test_case_name,
+                                   const gchar *test_name,
+                                   gdouble elapsed)
+{
+    gchar *key;
+
+    key = test_key(test_case_name, test_name);
+    add_sample(history->test_samples, key, elapsed);
+    g_free(key);
+}
+
+void
+cut_test_history_add_iterated_test_elapsed (CutTestHistory *history,
+                                            const gchar *test_case_name,
+                                            const gchar *test_name,
+                                            const gchar *data_name,
+                                            gdouble elapsed)
+{
+    gchar *key;
+
+    key = iterated_test_key(test_case_name, test_name, data_name);
+    add_sample(history->test_samples, key, elapsed);
+    g_free(key);
+}
+
+gboolean
+cut_test_history_get_test_case_elapsed (CutTestHistory *history,
+                                        const gchar *test_case_name,
+                                        gdouble *elapsed)
+{
+    return get_median(history->test_case_samples, test_case_name, elapsed);
+}
+
+gboolean
+cut_test_history_get_test_elapsed (CutTestHistory *history,
+                                   const gchar *test_case_name,
+                                   const gchar *test_name,
+                                   gdouble *elapsed)
+{
+    gchar *key;
+    gboolean found;
+
+    key = test_key(test_case_name, test_name);
+    found = get_median(history->test_samples, key, elapsed);
+    g_free(key);
+
+    return found;
+}
+
+static guint
+get_baseline (CutTestHistory *history, const gchar *key,
+              gdouble *elapsed_median, gdouble *elapsed_mad)
+{
+    GArray *samples;
+    gdouble *values;
+    guint i, n;
+
+    samples = g_hash_table_lookup(history->test_samples, key);
+    if (!samples || samples->len == 0)
+        return 0;
+
+    n = samples->len;
+    values = g_memdup(samples->data, sizeof(gdouble) * n);
+    *elapsed_median = median(values, n);
+    for (i = 0; i < n; i++)
+        values[i] = fabs(values[i] - *elapsed_median);
+    *elapsed_mad = median(values, n);
+    g_free(values);
+
+    return n;
+}
+
+guint
+cut_test_history_get_test_elapsed_baseline (CutTestHistory *history,
+                                            const gchar *test_case_name,
+                                            const gchar *test_name,
+                                            gdouble *elapsed_median,
+                                            gdouble *elapsed_mad)
+{
+    gchar *key;
+    guint n;
+
+    key = test_key(test_case_name, test_name);
+    n = get_baseline(history, key, elapsed_median, elapsed_mad);
+    g_free(key);
+
+    return n;
+}
+
+guint
+cut_test_history_get_iterated_test_elapsed_baseline (CutTestHistory *history,
+                                                     const gchar *test_case_name,
+                                                     const gchar *test_name,
+                                                     const gchar *data_name,
+                                                     gdouble *elapsed_median,
+                                                     gdouble *elapsed_mad)
+{
+    gchar *key;
+    guint n;
+
+    key = iterated_test_key(test_case_name, test_name, data_name);
+    n = get_baseline(history, key, elapsed_median, elapsed_mad);
+    g_free(key);
+
+    return n;
+}
+
+guint
+cut_test_history_get_n_runs (CutTestHistory *history)
+{
+    return history->n_runs;
+}
+
+static void
+cb_complete_test_case (CutRunContext *run_context, CutTestCase *test_case,
+                       gboolean success, gpointer data)
+{
+    CutTestHistory *history = data;
+
+    cut_test_history_add_test_case_elapsed(history,
+                                           cut_test_get_name(CUT_TEST(test_case)),
+                                           cut_test_get_elapsed(CUT_TEST(test_case)));
+}
+
+static void
+cb_complete_test (CutRunContext *run_context, CutTest *test,
+                  CutTestContext *test_context, gboolean success,
+                  gpointer data)
+{
+    CutTestHistory *history = data;
+    CutTestCase *test_case = NULL;
+
+    if (test_context)
+        test_case = cut_test_context_get_test_case(test_context);
+    cut_test_history_add_test_elapsed(history,
+                                      test_case ?
+                                      cut_test_get_name(CUT_TEST(test_case)) :
+                                      NULL,
+                                      cut_test_get_name(test),
+                                      cut_test_get_elapsed(test));
+}
+
+static void
+cb_complete_iterated_test (CutRunContext *run_context,
+                           CutIteratedTest *iterated_test,
+                           CutTestContext *test_context,
+                           gboolean success,
+                           gpointer data)
+{
+    CutTestHistory *history = data;
+    CutTestCase *test_case = NULL;
+    CutTestData *test_data = NULL;
+
+    if (test_context) {
+        test_case = cut_test_context_get_test_case(test_context);
+        if (cut_test_context_have_data(test_context))
+            test_data = cut_test_context_get_current_data(test_context);
+    }
+    /* A test context read from a log has the test data but
+     * the iterated test doesn't. */
+    if (!test_data)
+        test_data = cut_iterated_test_get_data(iterated_test);
+    cut_test_history_add_iterated_test_elapsed(
+        history,
+        test_case ? cut_test_get_name(CUT_TEST(test_case)) : NULL,
+        cut_test_get_name(CUT_TEST(iterated_test)),
+        test_data ? cut_test_data_get_name(test_data) : NULL,
+        cut_test_get_elapsed(CUT_TEST(iterated_test)));
+}
+
+static void
+load_log (CutTestHistory *history, const gchar *file_name)
+{
+    CutRunContext *reader;
+
+    reader = cut_file_stream_reader_new(file_name);
+    g_signal_connect(reader, "complete-test-case",
+                     G_CALLBACK(cb_complete_test_case), history);
+    g_signal_connect(reader, "complete-test",
+                     G_CALLBACK(cb_complete_test), history);
+    g_signal_connect(reader, "complete-iterated-test",
+                     G_CALLBACK(cb_complete_iterated_test), history);
+    cut_run_context_start(reader);
+    g_object_unref(reader);
+
+    history->n_runs++;
+}
+
+gboolean
+cut_test_history_load_file (CutTestHistory *history, const gchar *file_name,
+                            GError **error)
+{
+    if (!g_file_test(file_name, G_FILE_TEST_IS_REGULAR)) {
+        g_set_error(error, G_FILE_ERROR, G_FILE_ERROR_NOENT,
+                    "log file doesn't exist: <%s>", file_name);
+        return FALSE;
+    }
+
+    load_log(history, file_name);
+
+    return TRUE;
+}
+
+gboolean
+cut_test_history_load (CutTestHistory *history, const gchar *log_directory,
+                       guint max_runs, GError **error)
+{
+    GDir *log_dir;
+    const gchar *name;
+    GList *names = NULL, *node;
+    guint n_loaded = 0;
+
+    log_dir = g_dir_open(log_directory, 0, error);
+    if (!log_dir)
+        return FALSE;
+
+    while ((name = g_dir_read_name(log_dir))) {
+        if (g_regex_match_simple("^\\d{4}(?:-\\d{2}){5}\\.xml$", name, 0, 0))
+            names = g_list_prepend(names, g_strdup(name));
+    }
+    g_dir_close(log_dir);
+
+    /* newest first */
+    names = g_list_reverse(g_list_sort(names, (GCompareFunc)strcmp));
+    for (node = names; node; node = g_list_next(node)) {
+        gchar *file_name;
+
+        if (max_runs > 0 && n_loaded >= max_runs)
+            break;
+
+        file_name = g_build_filename(log_directory, node->data, NULL);
+        load_log(history, file_name);
+        g_free(file_name);
+        n_loaded++;
+    }
+
+    g_list_foreach(names, (GFunc)g_free, NULL);
+    g_list_free(names);
+
+    return TRUE;
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
@@ -0,0 +1,103 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CUT_TEST_HISTORY_H__
+#define __CUT_TEST_HISTORY_H__
+
+#include <glib.h>
+
+#include <cutter/cut-private.h>
+
+G_BEGIN_DECLS
+
+/*
+ * CutTestHistory collects elapsed times of test cases and
+ * tests from XML logs of previous runs (the files that
+ * --stream=xml --stream-directory=DIRECTORY writes).
+ */
+
+CutTestHistory *cut_test_history_new            (void);
+void            cut_test_history_free           (CutTestHistory *history);
+
+gboolean        cut_test_history_load           (CutTestHistory *history,
+                                                 const gchar    *log_directory,
+                                                 guint           max_runs,
+                                                 GError        **error);
+gboolean        cut_test_history_load_file      (CutTestHistory *history,
+                                                 const gchar    *file_name,
+                                                 GError        **error);
+guint           cut_test_history_get_n_runs     (CutTestHistory *history);
+
+void            cut_test_history_add_test_case_elapsed
+                                                (CutTestHistory *history,
+                                                 const gchar    *test_case_name,
+                                                 gdouble         elapsed);
+void            cut_test_history_add_test_elapsed
+                                                (CutTestHistory *history,
+                                                 const gchar    *test_case_name,
+                                                 const gchar    *test_name,
+                                                 gdouble         elapsed);
+void            cut_test_history_add_iterated_test_elapsed
+                                                (CutTestHistory *history,
+                                                 const gchar    *test_case_name,
+                                                 const gchar    *test_name,
+                                                 const gchar    *data_name,
+                                                 gdouble         elapsed);
+
+gboolean        cut_test_history_get_test_case_elapsed
+                                                (CutTestHistory *history,
+                                                 const gchar    *test_case_name,
+                                                 gdouble        *elapsed);
+gboolean        cut_test_history_get_test_elapsed
+                                                (CutTestHistory *history,
+                                                 const gchar    *test_case_name,
+                                                 const gchar    *test_name,
+                                                 gdouble        *elapsed);
+
+/*
+ * Returns the number of samples of the test. The median and
+ * the MAD (median absolute deviation) of them are stored
+ * only when it isn't 0.
+ */
+guint           cut_test_history_get_test_elapsed_baseline
+                                                (CutTestHistory *history,
+                                                 const gchar    *test_case_name,
+                                                 const gchar    *test_name,
+                                                 gdouble        *elapsed_median,
+                                                 gdouble        *elapsed_mad);
+/*
+ * Same as cut_test_history_get_test_elapsed_baseline() but
+ * for the iterated test that runs with the test data named
+ * data_name.
+ */
+guint           cut_test_history_get_iterated_test_elapsed_baseline
+                                                (CutTestHistory *history,
+                                                 const gchar    *test_case_name,
+                                                 const gchar    *test_name,
+                                                 const gchar    *data_name,
+                                                 gdouble        *elapsed_median,
+                                                 gdouble        *elapsed_mad);
+
+G_END_DECLS
+
+#endif /* __CUT_TEST_HISTORY_H__ */
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
@@ -0,0 +1,374 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "cut-test-index.h"
+#include "cut-elf-loader.h"
+#include "cut-glib-compatible.h"
+#include "cut-logger.h"
+
+/*
+ * Increment this when what is stored for a module is
+ * changed. For example, version 1 records data_ and bench_
+ * names that are needed by data-driven tests and benchmarks.
+ */
+#define FORMAT_VERSION        1
+
+#define GROUP_INDEX           "test-index"
+#define KEY_VERSION           "version"
+
+#define KEY_SIZE              "size"
+#define KEY_MTIME             "mtime"
+#define KEY_BUILD_ID          "build-id"
+#define KEY_SUPPORT_ATTRIBUTE "support-attribute"
+#define KEY_ALL_SYMBOLS       "all-symbols"
+#define KEY_SYMBOLS           "symbols"
+
+struct _CutTestIndex
+{
+    gchar *file_name;
+    GKeyFile *key_file;
+    GMutex *mutex;
+    gboolean modified;
+};
+
+typedef struct _ModuleStamp ModuleStamp;
+struct _ModuleStamp
+{
+    gchar *size;
+    gchar *mtime;
+    gchar *build_id;
+};
+
+static GKeyFile *
+key_file_new (void)
+{
+    GKeyFile *key_file;
+
+    key_file = g_key_file_new();
+    g_key_file_set_integer(key_file, GROUP_INDEX, KEY_VERSION, FORMAT_VERSION);
+
+    return key_file;
+}
+
+CutTestIndex *
+cut_test_index_new (const gchar *file_name)
+{
+    CutTestIndex *index;
+
+    index = g_new0(CutTestIndex, 1);
+    index->file_name = g_strdup(file_name);
+    index->key_file = key_file_new();
+    index->mutex = g_mutex_new();
+    index->modified = FALSE;
+
+    return index;
+}
+
+void
+cut_test_index_free (CutTestIndex *index)
+{
+    g_free(index->file_name);
+    g_key_file_free(index->key_file);
+    g_mutex_free(index->mutex);
+    g_free(index);
+}
+
+const gchar *
+cut_test_index_get_file_name (CutTestIndex *index)
+{
+    return index->file_name;
+}
+
+static gboolean
+is_current_version (GKeyFile *key_file)
+{
+    GError *error = NULL;
+    gint version;
+
+    version = g_key_file_get_integer(key_file, GROUP_INDEX, KEY_VERSION,
+                                     &error);
+    if (error) {
+        g_error_free(error);
+        return FALSE;
+    }
+
+    return version == FORMAT_VERSION;
+}
+
+gboolean
+cut_test_index_load (CutTestIndex *index, GError **error)
+{
+    GError *local_error = NULL;
+
+    if (!g_file_test(index->file_name, G_FILE_TEST_EXISTS))
+        return TRUE;
+
+    if (!g_key_file_load_from_file(index->key_file, index->file_name,
+                                   G_KEY_FILE_NONE, &local_error)) {
+        g_key_file_free(index->key_file);
+        index->key_file = key_file_new();
+        g_propagate_error(error, local_error);
+        return FALSE;
+    }
+
+    /* An index in other format may lack names that are
+     * needed now. It is rebuilt from scratch. */
+    if (!is_current_version(index->key_file)) {
+        cut_log_debug("[test-index][load][rebuild] <%s>: "
+                      "version isn't <%d>",
+                      index->file_name, FORMAT_VERSION);
+        g_key_file_free(index->key_file);
+        index->key_file = key_file_new();
+        index->modified = TRUE;
+    }
+
+    return TRUE;
+}
+
+static void
+remove_vanished_modules (CutTestIndex *index)
+{
+    gchar **groups, **group;
+
+    groups = g_key_file_get_groups(index->key_file, NULL);
+    for (group = groups; *group; group++) {
+        if (g_str_equal(*group, GROUP_INDEX))
+            continue;
+        if (g_file_test(*group, G_FILE_TEST_EXISTS))
+            continue;
+        g_key_file_remove_group(index->key_file, *group, NULL);
+        index->modified = TRUE;
+    }
+    g_strfreev(groups);
+}
+
+gboolean
+cut_test_index_save (CutTestIndex *index, GError **error)
+{
+    gchar *data, *directory;
+    gsize length;
+    gboolean success;
+
+    g_mutex_lock(index->mutex);
+    remove_vanished_modules(index);
+    if (!index->modified) {
+        g_mutex_unlock(index->mutex);
+        return TRUE;
+    }
+
+    data = g_key_file_to_data(index->key_file, &length, NULL);
+    g_mutex_unlock(index->mutex);
+
+    directory = g_path_get_dirname(index->file_name);
+    g_mkdir_with_parents(directory, 0755);
+    g_free(directory);
+
+    success = g_file_set_contents(index->file_name, data, length, error);
+    g_free(data);
+    if (success)
+        index->modified = FALSE;
+
+    return success;
+}
+
+static gchar *
+module_key (const gchar *so_filename)
+{
+    gchar *key;
+
+    if (g_path_is_absolute(so_filename)) {
+        key = g_strdup(so_filename);
+    } else {
+        gchar *current_directory;
+
+        current_directory = g_get_current_dir();
+        key = g_build_filename(current_directory, so_filename, NULL);
+        g_free(current_directory);
+    }
+
+    /* GKeyFile can't store these characters in a group name. */
+    if (strpbrk(key, "[]\n\r")) {
+        g_free(key);
+        return NULL;
+    }
+
+    return key;
+}
+
+static gboolean
+module_stamp_init (ModuleStamp *stamp, const gchar *so_filename)
+{
+    struct stat buffer;
+
+    if (g_stat(so_filename, &buffer) != 0)
+        return FALSE;
+
+    stamp->size = g_strdup_printf("%" G_GUINT64_FORMAT,
+                                  (guint64)buffer.st_size);
+    stamp->mtime = g_strdup_printf("%" G_GINT64_FORMAT,
+                                   (gint64)buffer.st_mtime);
+    stamp->build_id = cut_elf_loader_read_build_id(so_filename);
+    if (!stamp->build_id)
+        stamp->build_id = g_strdup("");
+
+    return TRUE;
+}
+
+static void
+module_stamp_clear (ModuleStamp *stamp)
+{
+    g_free(stamp->size);
+    g_free(stamp->mtime);
+    g_free(stamp->build_id);
+}
+
+static gboolean
+is_same_string (GKeyFile *key_file, const gchar *group, const gchar *key,
+                const gchar *expected)
+{
+    gchar *actual;
+    gboolean same;
+
+    actual = g_key_file_get_string(key_file, group, key, NULL);
+    same = actual && g_str_equal(actual, expected);
+    g_free(actual);
+
+    return same;
+}
+
+gboolean
+cut_test_index_lookup (CutTestIndex *index, const gchar *so_filename,
+                       gboolean need_all_symbols,
+                       GList **symbols, gboolean *support_attribute)
+{
+    gchar *group;
+    ModuleStamp stamp;
+    gboolean found = FALSE;
+
+    group = module_key(so_filename);
+    if (!group)
+        return FALSE;
+
+    g_mutex_lock(index->mutex);
+    if (!g_key_file_has_group(index->key_file, group)) {
+        g_mutex_unlock(index->mutex);
+        g_free(group);
+        return FALSE;
+    }
+    g_mutex_unlock(index->mutex);
+
+    if (!module_stamp_init(&stamp, so_filename)) {
+        g_free(group);
+        return FALSE;
+    }
+
+    g_mutex_lock(index->mutex);
+    if (is_same_string(index->key_file, group, KEY_SIZE, stamp.size) &&
+        is_same_string(index->key_file, group, KEY_MTIME, stamp.mtime) &&
+        is_same_string(index->key_file, group, KEY_BUILD_ID, stamp.build_id) &&
+        (!need_all_symbols ||
+         g_key_file_get_boolean(index->key_file, group, KEY_ALL_SYMBOLS,
+                                NULL))) {
+        gchar **names;
+        gsize i, n_names = 0;
+
+        found = TRUE;
+        *support_attribute =
+            g_key_file_get_boolean(index->key_file, group,
+                                   KEY_SUPPORT_ATTRIBUTE, NULL);
+        *symbols = NULL;
+        names = g_key_file_get_string_list(index->key_file, group, KEY_SYMBOLS,
+                                           &n_names, NULL);
+        for (i = 0; i < n_names; i++) {
+            *symbols = g_list_prepend(*symbols, names[i]);
+        }
+        *symbols = g_list_reverse(*symbols);
+        g_free(names);
+    }
+    g_mutex_unlock(index->mutex);
+
+    cut_log_trace("[test-index][lookup][%s] <%s>",
+                  found ? "hit" : "miss", so_filename);
+
+    module_stamp_clear(&stamp);
+    g_free(group);
+
+    return found;
+}
+
+void
+cut_test_index_store (CutTestIndex *index, const gchar *so_filename,
+                      gboolean all_symbols, const GList *symbols,
+                      gboolean support_attribute)
+{
+    gchar *group;
+    ModuleStamp stamp;
+    GPtrArray *names;
+    const GList *node;
+
+    group = module_key(so_filename);
+    if (!group)
+        return;
+
+    if (!module_stamp_init(&stamp, so_filename)) {
+        g_free(group);
+        return;
+    }
+
+    names = g_ptr_array_new();
+    for (node = symbols; node; node = g_list_next(node)) {
+        g_ptr_array_add(names, node->data);
+    }
+
+    g_mutex_lock(index->mutex);
+    g_key_file_remove_group(index->key_file, group, NULL);
+    g_key_file_set_string(index->key_file, group, KEY_SIZE, stamp.size);
+    g_key_file_set_string(index->key_file, group, KEY_MTIME, stamp.mtime);
+    g_key_file_set_string(index->key_file, group, KEY_BUILD_ID,
+                          stamp.build_id);
+    g_key_file_set_boolean(index->key_file, group, KEY_SUPPORT_ATTRIBUTE,
+                           support_attribute);
+    g_key_file_set_boolean(index->key_file, group, KEY_ALL_SYMBOLS,
+                           all_symbols);
+    g_key_file_set_string_list(index->key_file, group, KEY_SYMBOLS,
+                               (const gchar * const *)names->pdata,
+                               names->len);
+    index->modified = TRUE;
+    g_mutex_unlock(index->mutex);
+
+    cut_log_trace("[test-index][store] <%s>:<%u>", so_filename, names->len);
+
+    g_ptr_array_free(names, TRUE);
+    module_stamp_clear(&stamp);
+    g_free(group);
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
@@ -0,0 +1,66 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CUT_TEST_INDEX_H__
+#define __CUT_TEST_INDEX_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * CutTestIndex is an on-disk cache of symbols that CutLoader
+ * collected from test modules. An entry is valid while the
+ * module has the same path, size, mtime and ELF build-id.
+ * An entry has only test function symbols unless it is
+ * stored with all symbols for convenience attribute
+ * definition. An index that is written in other format
+ * version is discarded on load and rebuilt.
+ */
+
+typedef struct _CutTestIndex CutTestIndex;
+
+CutTestIndex *cut_test_index_new      (const gchar  *file_name);
+void          cut_test_index_free     (CutTestIndex *index);
+
+const gchar  *cut_test_index_get_file_name
+                                      (CutTestIndex *index);
+gboolean      cut_test_index_load     (CutTestIndex *index,
+                                       GError      **error);
+gboolean      cut_test_index_save     (CutTestIndex *index,
+                                       GError      **error);
+
+gboolean      cut_test_index_lookup   (CutTestIndex *index,
+                                       const gchar  *so_filename,
+                                       gboolean      need_all_symbols,
+                                       GList       **symbols,
+                                       gboolean     *support_attribute);
+void          cut_test_index_store    (CutTestIndex *index,
+                                       const gchar  *so_filename,
+                                       gboolean      all_symbols,
+                                       const GList  *symbols,
+                                       gboolean      support_attribute);
+
+G_END_DECLS
+
+#endif /* __CUT_TEST_INDEX_H__ */
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
@@ -34,6 +34,7 @@
 #include "cut-test-result.h"
 #include "cut-utils.h"
 #include "cut-crash-backtrace.h"
+#include "cut-scheduler.h"
 
 #include "../gcutter/gcut-error.h"
 #include "../gcutter/gcut-marshalers.h"
@@ -271,6 +272,7 @@ run_test_without_thread (gpointer data, gpointer user_data)
     jmp_buf crash_jump_buffer;
     CutCrashBacktrace *crash_backtrace = NULL;
     gboolean *success = user_data;
+    gboolean measure_phases;
 
     run_context = info->run_context;
     test_case = info->test_case;
@@ -282,10 +284,10 @@ run_test_without_thread (gpointer data, gpointer user_data)
     if (cut_run_context_is_canceled(run_context))
         return;
 
+    measure_phases = cut_run_context_get_measure_phases(run_context);
     cut_test_context_current_push(test_context);
 
-    if (cut_run_context_is_multi_thread(run_context) ||
-        !cut_run_context_get_handle_signals(run_context)) {
+    if (!cut_run_context_get_handle_signals(run_context)) {
         signum = 0;
     } else {
         crash_backtrace = cut_crash_backtrace_new(&crash_jump_buffer);
@@ -296,7 +298,18 @@ run_test_without_thread (gpointer data, gpointer user_data)
         g_signal_emit_by_name(test_iterator, "start-iterated-test",
                               iterated_test, test_context);
 
+        if (cut_run_context_get_measure_resource_usage(run_context))
+            cut_test_start_resource_usage(
+                CUT_TEST(iterated_test),
+                cut_run_context_is_multi_thread(run_context));
+        if (measure_phases) {
+            cut_test_set_phase_elapsed(CUT_TEST(iterated_test), NULL);
+            cut_test_start_phase(CUT_TEST(iterated_test),
+                                 CUT_TEST_PHASE_SETUP);
+        }
         cut_test_case_run_setup(test_case, test_context);
+        if (measure_phases)
+            cut_test_stop_phase(CUT_TEST(iterated_test), CUT_TEST_PHASE_SETUP);
         if (cut_test_context_is_failed(test_context)) {
             *success = FALSE;
         } else {
@@ -304,18 +317,15 @@ run_test_without_thread (gpointer data, gpointer user_data)
                               test_context, run_context))
                 *success = FALSE;
         }
-
-        if (crash_backtrace)
-            cut_crash_backtrace_free(crash_backtrace);
-
         break;
 #ifndef G_OS_WIN32
     case SIGSEGV:
     case SIGABRT:
     case SIGTERM:
     case SIGBUS:
-        success = FALSE;
-        cut_crash_backtrace_emit(cut_run_context_get_test_suite(run_context),
+        *success = FALSE;
+        cut_crash_backtrace_emit(crash_backtrace,
+                                 cut_run_context_get_test_suite(run_context),
                                  test_case, CUT_TEST(iterated_test),
                                  test_iterator,
                                  cut_iterated_test_get_data(iterated_test),
@@ -329,7 +339,10 @@ run_test_without_thread (gpointer data, gpointer user_data)
         break;
     }
 
-    cut_test_case_run_teardown(test_case, test_context);
+    if (crash_backtrace)
+        cut_crash_backtrace_free(crash_backtrace);
+
+    cut_test_run_teardown(CUT_TEST(iterated_test), test_context, run_context);
 
     cut_test_context_set_failed(parent_test_context,
                                 cut_test_context_is_failed(test_context));
@@ -355,7 +368,7 @@ run_test_with_thread_support (CutTestIterator *test_iterator,
                               CutIteratedTest *iterated_test,
                               CutTestContext *test_context,
                               CutRunContext *run_context,
-                              GThreadPool *thread_pool,
+                              CutSchedulerGroup *group,
                               gboolean *success)
 {
     RunTestInfo *info;
@@ -363,7 +376,6 @@ run_test_with_thread_support (CutTestIterator *test_iterator,
     CutTestCase *test_case;
     CutTestContext *local_test_context;
     gboolean is_multi_thread;
-    gboolean need_no_thread_run = TRUE;
     const gchar *multi_thread_attribute;
 
     if (cut_run_context_is_canceled(run_context))
@@ -394,18 +406,9 @@ run_test_with_thread_support (CutTestIterator *test_iterator,
     info->iterated_test = g_object_ref(iterated_test);
     info->test_context = local_test_context;
     info->parent_test_context = g_object_ref(test_context);
-    if (is_multi_thread && thread_pool) {
-        GError *error = NULL;
-
-        g_thread_pool_push(thread_pool, info, &error);
-        if (error) {
-            cut_utils_report_error(error);
-        } else {
-            need_no_thread_run = FALSE;
-        }
-    }
-
-    if (need_no_thread_run)
+    if (is_multi_thread && group)
+        cut_scheduler_group_push(group, info);
+    else
         run_test_without_thread(info, success);
 }
 
@@ -426,20 +429,18 @@ run_iterated_tests (CutTest *test, CutTestContext *test_context,
     CutTestIteratorPrivate *priv;
     CutTestIterator *test_iterator;
     CutTestContainer *test_container;
-    GError *error = NULL;
     GList *node, *iterated_tests = NULL, *filtered_tests = NULL;
     const gchar **test_names;
     guint n_tests;
-    GThreadPool *thread_pool = NULL;
-
-    thread_pool = g_thread_pool_new(run_test_without_thread,
-                                    all_success,
-                                    cut_run_context_get_max_threads(run_context),
-                                    FALSE,
-                                    &error);
-    if (error) {
-        cut_utils_report_error(error);
-        return;
+    CutSchedulerGroup *group = NULL;
+
+    if (cut_run_context_is_multi_thread(run_context)) {
+        CutScheduler *scheduler;
+
+        scheduler = cut_run_context_get_scheduler(run_context);
+        group = cut_scheduler_group_new(scheduler,
+                                        run_test_without_thread,
+                                        all_success);
     }
 
     priv = CUT_TEST_ITERATOR_GET_PRIVATE(test);
@@ -489,12 +490,12 @@ run_iterated_tests (CutTest *test, CutTestContext *test_context,
 
         run_test_with_thread_support(test_iterator, iterated_test,
                                      test_context, run_context,
-                                     thread_pool, all_success);
+                                     group, all_success);
     }
     g_list_free(filtered_tests);
 
-    if (thread_pool)
-        g_thread_pool_free(thread_pool, FALSE, TRUE);
+    if (group)
+        cut_scheduler_group_join(group);
 
     for (node = iterated_tests; node; node = g_list_next(node)) {
         CutIteratedTest *iterated_test = node->data;
@@ -526,10 +527,19 @@ run (CutTest *test, CutTestContext *test_context, CutRunContext *run_context)
 
     cut_test_context_set_test_iterator(test_context, test_iterator);
     if (priv->data_setup_function) {
+        gboolean measure_phases;
+
+        measure_phases = cut_run_context_get_measure_phases(run_context);
+        if (measure_phases) {
+            cut_test_set_phase_elapsed(test, NULL);
+            cut_test_start_phase(test, CUT_TEST_PHASE_DATA_SETUP);
+        }
         cut_test_context_set_jump_buffer(test_context, &jump_buffer);
         if (setjmp(jump_buffer) == 0) {
             priv->data_setup_function();
         }
+        if (measure_phases)
+            cut_test_stop_phase(test, CUT_TEST_PHASE_DATA_SETUP);
     }
 
     if (cut_test_context_is_failed(test_context)) {
@@ -0,0 +1,139 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <glib.h>
+
+#include "cut-test-phase.h"
+#include "cut-utils.h"
+
+#define NANOSECONDS_PER_SECOND 1000000000.0
+
+static const gchar *phase_names[] = {
+    "startup",
+    "shutdown",
+    "data-setup",
+    "setup",
+    "test",
+    "teardown"
+};
+
+const gchar *
+cut_test_phase_to_string (CutTestPhase phase)
+{
+    if (phase < 0 || phase >= CUT_TEST_PHASE_LAST)
+        return NULL;
+    return phase_names[phase];
+}
+
+void
+cut_phase_elapsed_init (CutPhaseElapsed *phase_elapsed)
+{
+    gint i;
+
+    for (i = 0; i < CUT_TEST_PHASE_LAST; i++)
+        phase_elapsed->elapsed[i] = -1;
+}
+
+gboolean
+cut_phase_elapsed_is_empty (const CutPhaseElapsed *phase_elapsed)
+{
+    gint i;
+
+    for (i = 0; i < CUT_TEST_PHASE_LAST; i++) {
+        if (phase_elapsed->elapsed[i] >= 0)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*
+ * A phase may run more than once for a test, e.g. a setup
+ * of an iterated test, so elapsed times are accumulated.
+ */
+void
+cut_phase_elapsed_add (CutPhaseElapsed *phase_elapsed,
+                       CutTestPhase phase, gint64 elapsed)
+{
+    if (phase < 0 || phase >= CUT_TEST_PHASE_LAST)
+        return;
+
+    if (phase_elapsed->elapsed[phase] < 0)
+        phase_elapsed->elapsed[phase] = 0;
+    phase_elapsed->elapsed[phase] += MAX(elapsed, 0);
+}
+
+/*
+ * Sets a value by the name of its XML element. It is for
+ * stream parsers.
+ */
+gboolean
+cut_phase_elapsed_set_value (CutPhaseElapsed *phase_elapsed,
+                             const gchar *name, const gchar *value)
+{
+    gint i;
+
+    for (i = 0; i < CUT_TEST_PHASE_LAST; i++) {
+        gdouble seconds;
+        gchar *end;
+
+        if (!g_str_equal(name, phase_names[i]))
+            continue;
+
+        seconds = g_ascii_strtod(value, &end);
+        if (end == value || end[0] != '\0' || seconds < 0.0)
+            return FALSE;
+        phase_elapsed->elapsed[i] =
+            (gint64)(seconds * NANOSECONDS_PER_SECOND + 0.5);
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+void
+cut_phase_elapsed_to_xml_string (const CutPhaseElapsed *phase_elapsed,
+                                 GString *string, guint indent)
+{
+    gint i;
+
+    cut_utils_append_indent(string, indent);
+    g_string_append(string, "<phase-elapsed>\n");
+    for (i = 0; i < CUT_TEST_PHASE_LAST; i++) {
+        gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+        if (phase_elapsed->elapsed[i] < 0)
+            continue;
+
+        g_ascii_formatd(buffer, sizeof(buffer), "%.9f",
+                        phase_elapsed->elapsed[i] / NANOSECONDS_PER_SECOND);
+        cut_utils_append_xml_element_with_value(string, indent + 2,
+                                                phase_names[i], buffer);
+    }
+    cut_utils_append_indent(string, indent);
+    g_string_append(string, "</phase-elapsed>\n");
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
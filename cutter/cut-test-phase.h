@@ -0,0 +1,74 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CUT_TEST_PHASE_H__
+#define __CUT_TEST_PHASE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * CutPhaseElapsed is how long each phase around a test took
+ * in nanoseconds. It is measured by a monotonic clock. A
+ * phase that isn't measured has -1.
+ *
+ * A test has setup, test and teardown. A test case has
+ * startup and shutdown. A test iterator has data-setup.
+ */
+
+typedef enum {
+    CUT_TEST_PHASE_STARTUP,
+    CUT_TEST_PHASE_SHUTDOWN,
+    CUT_TEST_PHASE_DATA_SETUP,
+    CUT_TEST_PHASE_SETUP,
+    CUT_TEST_PHASE_TEST,
+    CUT_TEST_PHASE_TEARDOWN,
+
+    CUT_TEST_PHASE_LAST
+} CutTestPhase;
+
+typedef struct _CutPhaseElapsed CutPhaseElapsed;
+struct _CutPhaseElapsed
+{
+    gint64 elapsed[CUT_TEST_PHASE_LAST];
+};
+
+const gchar *cut_test_phase_to_string        (CutTestPhase           phase);
+
+void         cut_phase_elapsed_init          (CutPhaseElapsed       *phase_elapsed);
+gboolean     cut_phase_elapsed_is_empty      (const CutPhaseElapsed *phase_elapsed);
+void         cut_phase_elapsed_add           (CutPhaseElapsed       *phase_elapsed,
+                                              CutTestPhase           phase,
+                                              gint64                 elapsed);
+
+gboolean     cut_phase_elapsed_set_value     (CutPhaseElapsed       *phase_elapsed,
+                                              const gchar           *name,
+                                              const gchar           *value);
+void         cut_phase_elapsed_to_xml_string (const CutPhaseElapsed *phase_elapsed,
+                                              GString               *string,
+                                              guint                  indent);
+
+G_END_DECLS
+
+#endif /* __CUT_TEST_PHASE_H__ */
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
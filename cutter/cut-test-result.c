@@ -56,6 +56,8 @@ struct _CutTestResultPrivate
     GList *backtrace;
     GTimeVal start_time;
     gdouble elapsed;
+    CutResourceUsage *resource_usage;
+    CutPhaseElapsed phase_elapsed;
     gchar *expected;
     gchar *actual;
     gchar *diff;
@@ -230,6 +232,8 @@ cut_test_result_init (CutTestResult *result)
     priv->start_time.tv_sec = 0;
     priv->start_time.tv_usec = 0;
     priv->elapsed = 0.0;
+    priv->resource_usage = NULL;
+    cut_phase_elapsed_init(&(priv->phase_elapsed));
     priv->expected = NULL;
     priv->actual = NULL;
     priv->diff = NULL;
@@ -309,6 +313,11 @@ dispose (GObject *object)
         priv->folded_diff = NULL;
     }
 
+    if (priv->resource_usage) {
+        g_free(priv->resource_usage);
+        priv->resource_usage = NULL;
+    }
+
     G_OBJECT_CLASS(cut_test_result_parent_class)->dispose(object);
 }
 
@@ -679,6 +688,18 @@ cut_test_result_get_elapsed (CutTestResult *result)
     return CUT_TEST_RESULT_GET_PRIVATE(result)->elapsed;
 }
 
+const CutResourceUsage *
+cut_test_result_get_resource_usage (CutTestResult *result)
+{
+    return CUT_TEST_RESULT_GET_PRIVATE(result)->resource_usage;
+}
+
+const CutPhaseElapsed *
+cut_test_result_get_phase_elapsed (CutTestResult *result)
+{
+    return &(CUT_TEST_RESULT_GET_PRIVATE(result)->phase_elapsed);
+}
+
 const gchar *
 cut_test_result_get_expected (CutTestResult *result)
 {
@@ -804,6 +825,8 @@ append_test_result_to_string (GString *string, CutTestResult *result,
     GTimeVal start_time;
     gchar *elapsed_string, *start_time_string;
     const gchar *message, *expected, *actual, *diff, *folded_diff;
+    const CutResourceUsage *resource_usage;
+    const CutPhaseElapsed *phase_elapsed;
 
     status = cut_test_result_get_status(result);
     message = cut_test_result_get_message(result);
@@ -832,6 +855,14 @@ append_test_result_to_string (GString *string, CutTestResult *result,
                                             elapsed_string);
     g_free(elapsed_string);
 
+    resource_usage = cut_test_result_get_resource_usage(result);
+    if (resource_usage)
+        cut_resource_usage_to_xml_string(resource_usage, string, indent);
+
+    phase_elapsed = cut_test_result_get_phase_elapsed(result);
+    if (!cut_phase_elapsed_is_empty(phase_elapsed))
+        cut_phase_elapsed_to_xml_string(phase_elapsed, string, indent);
+
     if (expected)
         cut_utils_append_xml_element_with_value(string, indent,
                                                 "expected", expected);
@@ -1068,6 +1099,37 @@ cut_test_result_set_elapsed (CutTestResult *result,
     CUT_TEST_RESULT_GET_PRIVATE(result)->elapsed = elapsed;
 }
 
+void
+cut_test_result_set_resource_usage (CutTestResult *result,
+                                    const CutResourceUsage *resource_usage)
+{
+    CutTestResultPrivate *priv;
+
+    priv = CUT_TEST_RESULT_GET_PRIVATE(result);
+    if (!resource_usage) {
+        g_free(priv->resource_usage);
+        priv->resource_usage = NULL;
+        return;
+    }
+
+    if (!priv->resource_usage)
+        priv->resource_usage = g_new(CutResourceUsage, 1);
+    *(priv->resource_usage) = *resource_usage;
+}
+
+void
+cut_test_result_set_phase_elapsed (CutTestResult *result,
+                                   const CutPhaseElapsed *phase_elapsed)
+{
+    CutTestResultPrivate *priv;
+
+    priv = CUT_TEST_RESULT_GET_PRIVATE(result);
+    if (phase_elapsed)
+        priv->phase_elapsed = *phase_elapsed;
+    else
+        cut_phase_elapsed_init(&(priv->phase_elapsed));
+}
+
 static void
 reset_diff (CutTestResultPrivate *priv)
 {
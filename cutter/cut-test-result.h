@@ -80,6 +80,12 @@ const GList         *cut_test_result_get_backtrace    (CutTestResult *result);
 void                 cut_test_result_get_start_time    (CutTestResult *result,
                                                         GTimeVal *start_time);
 gdouble              cut_test_result_get_elapsed       (CutTestResult *result);
+const CutResourceUsage *
+                     cut_test_result_get_resource_usage(CutTestResult *result);
+const CutPhaseElapsed *
+                     cut_test_result_get_phase_elapsed (CutTestResult *result);
+const CutPhaseElapsed *
+                     cut_test_result_get_phase_elapsed (CutTestResult *result);
 const gchar         *cut_test_result_get_expected      (CutTestResult *result);
 const gchar         *cut_test_result_get_actual        (CutTestResult *result);
 const gchar         *cut_test_result_get_diff          (CutTestResult *result);
@@ -109,6 +115,12 @@ void cut_test_result_set_start_time      (CutTestResult *result,
                                           GTimeVal *start_time);
 void cut_test_result_set_elapsed         (CutTestResult *result,
                                           gdouble elapsed);
+void cut_test_result_set_resource_usage  (CutTestResult *result,
+                                          const CutResourceUsage *resource_usage);
+void cut_test_result_set_phase_elapsed   (CutTestResult *result,
+                                          const CutPhaseElapsed *phase_elapsed);
+void cut_test_result_set_phase_elapsed   (CutTestResult *result,
+                                          const CutPhaseElapsed *phase_elapsed);
 void cut_test_result_set_expected        (CutTestResult *result,
                                           const gchar   *expected);
 void cut_test_result_set_actual          (CutTestResult *result,
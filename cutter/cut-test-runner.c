@@ -28,6 +28,7 @@
 #include "cut-repository.h"
 #include "cut-test-case.h"
 #include "cut-test-result.h"
+#include "cut-event-sink.h"
 
 #include "cut-enum-types.h"
 
@@ -83,67 +84,66 @@ cb_pass_assertion_test (CutTest *test, CutTestContext *test_context,
 }
 
 static void
-cb_success_test (CutTest *test, CutTestContext *test_context,
-                 CutTestResult *result, gpointer data)
+cb_pass_assertions_test (CutTest *test, CutTestContext *test_context,
+                         guint n_assertions, gpointer data)
 {
     CutRunContext *context = data;
 
-    g_signal_emit_by_name(context, "success-test", test, test_context, result);
+    g_signal_emit_by_name(context, "pass-assertions",
+                          test, test_context, n_assertions);
 }
 
-static void
-cb_failure_test (CutTest *test, CutTestContext *test_context,
-                 CutTestResult *result, gpointer data)
-{
-    CutRunContext *context = data;
-
-    g_signal_emit_by_name(context, "failure-test", test, test_context, result);
-}
-
-static void
-cb_error_test (CutTest *test, CutTestContext *test_context,
-               CutTestResult *result, gpointer data)
-{
-    CutRunContext *context = data;
-
-    g_signal_emit_by_name(context, "error-test", test, test_context, result);
-}
-
-static void
-cb_pending_test (CutTest *test, CutTestContext *test_context,
-                 CutTestResult *result, gpointer data)
-{
-    CutRunContext *context = data;
-
-    g_signal_emit_by_name(context, "pending-test", test, test_context, result);
-}
-
-static void
-cb_notification_test (CutTest *test, CutTestContext *test_context,
-                      CutTestResult *result, gpointer data)
+/*
+ * Passed assertions are reported in batch by
+ * "pass-assertions". Tests report each passed assertion by
+ * "pass-assertion" only when someone listens to it.
+ */
+static gboolean
+need_each_pass_assertion (CutRunContext *context)
 {
-    CutRunContext *context = data;
+    static guint pass_assertion_signal_id = 0;
 
-    g_signal_emit_by_name(context, "notification-test",
-                          test, test_context, result);
+    if (!pass_assertion_signal_id)
+        pass_assertion_signal_id = g_signal_lookup("pass-assertion",
+                                                   CUT_TYPE_RUN_CONTEXT);
+    return g_signal_has_handler_pending(context, pass_assertion_signal_id,
+                                        0, FALSE);
 }
 
 static void
-cb_omission_test (CutTest *test, CutTestContext *test_context,
-                  CutTestResult *result, gpointer data)
+cb_result_test (CutTest *test, CutTestContext *test_context,
+                CutTestResult *result, gpointer data)
 {
     CutRunContext *context = data;
+    const gchar *signal_name = NULL;
 
-    g_signal_emit_by_name(context, "omission-test", test, test_context, result);
-}
-
-static void
-cb_crash_test (CutTest *test, CutTestContext *test_context,
-               CutTestResult *result, gpointer data)
-{
-    CutRunContext *context = data;
+    switch (cut_test_result_get_status(result)) {
+    case CUT_TEST_RESULT_SUCCESS:
+        signal_name = "success-test";
+        break;
+    case CUT_TEST_RESULT_NOTIFICATION:
+        signal_name = "notification-test";
+        break;
+    case CUT_TEST_RESULT_OMISSION:
+        signal_name = "omission-test";
+        break;
+    case CUT_TEST_RESULT_PENDING:
+        signal_name = "pending-test";
+        break;
+    case CUT_TEST_RESULT_FAILURE:
+        signal_name = "failure-test";
+        break;
+    case CUT_TEST_RESULT_ERROR:
+        signal_name = "error-test";
+        break;
+    case CUT_TEST_RESULT_CRASH:
+        signal_name = "crash-test";
+        break;
+    default:
+        return;
+    }
 
-    g_signal_emit_by_name(context, "crash-test", test, test_context, result);
+    g_signal_emit_by_name(context, signal_name, test, test_context, result);
 }
 
 static void
@@ -155,24 +155,33 @@ cb_complete_test (CutTest *test, CutTestContext *test_context,
     g_signal_emit_by_name(context, "complete-test", test, test_context, success);
 }
 
+static const CutEventSink test_event_sink = {
+    cb_start_test,
+    NULL,
+    cb_pass_assertions_test,
+    cb_result_test,
+    cb_complete_test
+};
+
+static const CutEventSink test_event_sink_with_each_pass_assertion = {
+    cb_start_test,
+    cb_pass_assertion_test,
+    cb_pass_assertions_test,
+    cb_result_test,
+    cb_complete_test
+};
+
 static void
-connect_to_test (CutRunContext *context, CutTest *test)
+attach_to_test_context (CutRunContext *context, CutTestContext *test_context)
 {
-#define CONNECT(name)                                                   \
-    g_signal_connect(test, #name,                                       \
-                     G_CALLBACK(cb_ ## name ## _test), context)
-
-    CONNECT(start);
-    CONNECT(pass_assertion);
-    CONNECT(success);
-    CONNECT(failure);
-    CONNECT(error);
-    CONNECT(pending);
-    CONNECT(notification);
-    CONNECT(omission);
-    CONNECT(crash);
-    CONNECT(complete);
-#undef CONNECT
+    if (need_each_pass_assertion(context))
+        cut_test_context_set_event_sink(test_context,
+                                        &test_event_sink_with_each_pass_assertion,
+                                        context);
+    else
+        cut_test_context_set_event_sink(test_context,
+                                        &test_event_sink,
+                                        context);
 }
 
 static void
@@ -181,32 +190,7 @@ cb_start_test_test_case (CutTestCase *test_case, CutTest *test,
 {
     CutRunContext *context = data;
 
-    connect_to_test(context, test);
-}
-
-static void
-cb_complete_test_test_case (CutTestCase *test_case, CutTest *test,
-                            CutTestContext *test_context, gboolean success,
-                            gpointer data)
-{
-#define DISCONNECT(name)                                                \
-    g_signal_handlers_disconnect_by_func(test,                          \
-                                         G_CALLBACK(cb_ ##              \
-                                                    name ##             \
-                                                    _test),             \
-                                         data)
-
-    DISCONNECT(start);
-    DISCONNECT(pass_assertion);
-    DISCONNECT(success);
-    DISCONNECT(failure);
-    DISCONNECT(error);
-    DISCONNECT(pending);
-    DISCONNECT(notification);
-    DISCONNECT(omission);
-    DISCONNECT(crash);
-    DISCONNECT(complete);
-#undef DISCONNECT
+    attach_to_test_context(context, test_context);
 }
 
 static void
@@ -384,89 +368,40 @@ cb_crash_test_suite (CutTestSuite *test_suite, CutTestContext *test_context,
 }
 
 static void
-cb_start_iterated_test (CutIteratedTest *iterated_test,
-                        CutTestContext *test_context, gpointer data)
+cb_start_iterated_test (CutTest *test, CutTestContext *test_context,
+                        gpointer data)
 {
     CutRunContext *context = data;
 
-    g_signal_emit_by_name(context, "start-iterated-test",
-                          iterated_test, test_context);
-}
-
-static void
-cb_pass_assertion_iterated_test (CutIteratedTest *iterated_test,
-                                 CutTestContext *test_context, gpointer data)
-{
-    cb_pass_assertion_test(CUT_TEST(iterated_test), test_context, data);
-}
-
-static void
-cb_success_iterated_test (CutIteratedTest *iterated_test,
-                          CutTestContext *test_context,
-                          CutTestResult *result, gpointer data)
-{
-    cb_success_test(CUT_TEST(iterated_test), test_context, result, data);
+    g_signal_emit_by_name(context, "start-iterated-test", test, test_context);
 }
 
 static void
-cb_failure_iterated_test (CutIteratedTest *iterated_test,
-                          CutTestContext *test_context,
-                          CutTestResult *result, gpointer data)
-{
-    cb_failure_test(CUT_TEST(iterated_test), test_context, result, data);
-}
-
-static void
-cb_error_iterated_test (CutIteratedTest *iterated_test,
-                        CutTestContext *test_context,
-                        CutTestResult *result, gpointer data)
-{
-    cb_error_test(CUT_TEST(iterated_test), test_context, result, data);
-}
-
-static void
-cb_pending_iterated_test (CutIteratedTest *iterated_test,
-                          CutTestContext *test_context,
-                          CutTestResult *result, gpointer data)
-{
-    cb_pending_test(CUT_TEST(iterated_test), test_context, result, data);
-}
-
-static void
-cb_notification_iterated_test (CutIteratedTest *iterated_test,
-                               CutTestContext *test_context,
-                               CutTestResult *result, gpointer data)
-{
-    cb_notification_test(CUT_TEST(iterated_test), test_context, result, data);
-}
-
-static void
-cb_omission_iterated_test (CutIteratedTest *iterated_test,
-                           CutTestContext *test_context,
-                           CutTestResult *result, gpointer data)
-{
-    cb_omission_test(CUT_TEST(iterated_test), test_context, result, data);
-}
-
-static void
-cb_crash_iterated_test (CutIteratedTest *iterated_test,
-                        CutTestContext *test_context,
-                        CutTestResult *result, gpointer data)
-{
-    cb_crash_test(CUT_TEST(iterated_test), test_context, result, data);
-}
-
-static void
-cb_complete_iterated_test (CutIteratedTest *iterated_test,
-                           CutTestContext *test_context, gboolean success,
-                           gpointer data)
+cb_complete_iterated_test (CutTest *test, CutTestContext *test_context,
+                           gboolean success, gpointer data)
 {
     CutRunContext *context = data;
 
     g_signal_emit_by_name(context, "complete-iterated-test",
-                          iterated_test, test_context, success);
+                          test, test_context, success);
 }
 
+static const CutEventSink iterated_test_event_sink = {
+    cb_start_iterated_test,
+    NULL,
+    cb_pass_assertions_test,
+    cb_result_test,
+    cb_complete_iterated_test
+};
+
+static const CutEventSink iterated_test_event_sink_with_each_pass_assertion = {
+    cb_start_iterated_test,
+    cb_pass_assertion_test,
+    cb_pass_assertions_test,
+    cb_result_test,
+    cb_complete_iterated_test
+};
+
 static void
 cb_start_iterated_test_test_iterator (CutTestIterator *test_iterator,
                                       CutIteratedTest *iterated_test,
@@ -475,51 +410,15 @@ cb_start_iterated_test_test_iterator (CutTestIterator *test_iterator,
 {
     CutRunContext *context = data;
 
-#define CONNECT(name)                                                   \
-    g_signal_connect(iterated_test, #name,                              \
-                     G_CALLBACK(cb_ ## name ## _iterated_test),         \
-                     context)
-
-    CONNECT(start);
-    CONNECT(complete);
-
-    CONNECT(pass_assertion);
-    CONNECT(success);
-    CONNECT(failure);
-    CONNECT(error);
-    CONNECT(pending);
-    CONNECT(notification);
-    CONNECT(omission);
-    CONNECT(crash);
-#undef CONNECT
-}
-
-static void
-cb_complete_iterated_test_test_iterator (CutTestIterator *test_iterator,
-                                         CutIteratedTest *iterated_test,
-                                         CutTestContext *test_context,
-                                         gboolean success,
-                                         gpointer data)
-{
-#define DISCONNECT(name)                                                \
-    g_signal_handlers_disconnect_by_func(iterated_test,                 \
-                                         G_CALLBACK(cb_ ##              \
-                                                    name ##             \
-                                                    _iterated_test),    \
-                                         data)
-
-    DISCONNECT(start);
-    DISCONNECT(complete);
-
-    DISCONNECT(pass_assertion);
-    DISCONNECT(success);
-    DISCONNECT(failure);
-    DISCONNECT(error);
-    DISCONNECT(pending);
-    DISCONNECT(notification);
-    DISCONNECT(omission);
-    DISCONNECT(crash);
-#undef DISCONNECT
+    if (need_each_pass_assertion(context))
+        cut_test_context_set_event_sink(
+            test_context,
+            &iterated_test_event_sink_with_each_pass_assertion,
+            context);
+    else
+        cut_test_context_set_event_sink(test_context,
+                                        &iterated_test_event_sink,
+                                        context);
 }
 
 static void
@@ -638,7 +537,6 @@ connect_to_test_iterator (CutRunContext *context, CutTestIterator *test_iterator
                      G_CALLBACK(cb_ ## name ## _test_iterator), context)
 
     CONNECT(start_iterated_test);
-    CONNECT(complete_iterated_test);
 
     CONNECT(success);
     CONNECT(failure);
@@ -682,7 +580,6 @@ cb_complete_test_iterator_test_case (CutTestCase *test_case,
                                          context)
 
     DISCONNECT(start_iterated_test);
-    DISCONNECT(complete_iterated_test);
 
     DISCONNECT(success);
     DISCONNECT(failure);
@@ -706,7 +603,6 @@ connect_to_test_case (CutRunContext *context, CutTestCase *test_case)
                      G_CALLBACK(cb_ ## name ## _test_case), context)
 
     CONNECT(start_test);
-    CONNECT(complete_test);
     CONNECT(start_test_iterator);
     CONNECT(complete_test_iterator);
 
@@ -756,7 +652,6 @@ cb_complete_test_case_test_suite (CutTestSuite *test_suite,
                                          context)
 
     DISCONNECT(start_test);
-    DISCONNECT(complete_test);
     DISCONNECT(start_test_iterator);
     DISCONNECT(complete_test_iterator);
 
@@ -839,7 +734,7 @@ cut_test_runner_run_test (CutTestRunner *runner, CutTest *test,
     CutRunContext *context;
 
     context = CUT_RUN_CONTEXT(runner);
-    connect_to_test(context, test);
+    attach_to_test_context(context, test_context);
     return cut_test_run(test, test_context, context);
 }
 
@@ -25,13 +25,21 @@
 #include <stdlib.h>
 #include <string.h>
 #include <fcntl.h>
+#include <errno.h>
 #include <glib.h>
 #include <setjmp.h>
 #include <signal.h>
+#include <sys/types.h>
 
 #ifdef HAVE_UNISTD_H
 #  include <unistd.h>
 #endif
+#ifdef HAVE_SYS_WAIT_H
+#  include <sys/wait.h>
+#endif
+#ifndef G_OS_WIN32
+#  include <poll.h>
+#endif
 
 #include "cut-test-suite.h"
 
@@ -43,9 +51,13 @@
 #include "cut-test-result.h"
 #include "cut-backtrace-entry.h"
 #include "cut-crash-backtrace.h"
+#include "cut-scheduler.h"
+#include "cut-stream-parser.h"
+#include "cut-module-factory.h"
+#include "cut-module-factory-utils.h"
+#include "cut-listener.h"
 
 #include "../gcutter/gcut-marshalers.h"
-#include "../gcutter/gcut-error.h"
 
 #define CUT_TEST_SUITE_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CUT_TYPE_TEST_SUITE, CutTestSuitePrivate))
 
@@ -237,11 +249,15 @@ run (gpointer data, gpointer user_data)
     run_context = info->run_context;
     test_names = info->test_names;
 
-    g_signal_emit_by_name(test_suite, "start-test-case", test_case);
-    if (!cut_test_case_run_with_filter(test_case, run_context,
-                                       (const gchar**)test_names))
-        *success =  FALSE;
-    g_signal_emit_by_name(test_suite, "complete-test-case", test_case, *success);
+    /* Other thread may crash while this test case is queued. */
+    if (!cut_run_context_is_canceled(run_context)) {
+        g_signal_emit_by_name(test_suite, "start-test-case", test_case);
+        if (!cut_test_case_run_with_filter(test_case, run_context,
+                                           (const gchar**)test_names))
+            *success =  FALSE;
+        g_signal_emit_by_name(test_suite, "complete-test-case",
+                              test_case, *success);
+    }
 
     g_object_unref(test_suite);
     g_object_unref(test_case);
@@ -253,10 +269,9 @@ run (gpointer data, gpointer user_data)
 static void
 run_with_thread_support (CutTestSuite *test_suite, CutTestCase *test_case,
                          CutRunContext *run_context, const gchar **test_names,
-                         GThreadPool *thread_pool, gboolean *success)
+                         CutSchedulerGroup *group, gboolean *success)
 {
     RunTestInfo *info;
-    gboolean need_no_thread_run = TRUE;
 
     if (cut_run_context_is_canceled(run_context))
         return;
@@ -267,24 +282,467 @@ run_with_thread_support (CutTestSuite *test_suite, CutTestCase *test_case,
     info->run_context = g_object_ref(run_context);
     info->test_names = g_strdupv((gchar **)test_names);
 
-    if (thread_pool) {
-        GError *error = NULL;
+    if (group)
+        cut_scheduler_group_push(group, info);
+    else
+        run(info, success);
+}
+
+#ifndef G_OS_WIN32
+typedef struct _Worker
+{
+    pid_t pid;
+    gint task_fd;
+    gint result_fd;
+    CutStreamParser *parser;
+    CutTestCase *test_case;
+    gboolean started;
+} Worker;
+
+typedef struct _WorkerPool
+{
+    CutTestSuite *test_suite;
+    CutRunContext *run_context;
+    const gchar **test_names;
+    CutCrashBacktrace *crash_backtrace;
+    GPtrArray *test_cases;
+    Worker *workers;
+    guint n_workers;
+    Worker *current_worker;
+    gboolean *success;
+} WorkerPool;
+
+static gboolean
+write_all (gint fd, const gchar *data, gsize length)
+{
+    while (length > 0) {
+        ssize_t written;
+
+        written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return FALSE;
+        }
+        data += written;
+        length -= written;
+    }
 
-        g_thread_pool_push(thread_pool, info, &error);
-        if (error) {
-            gchar *inspected;
+    return TRUE;
+}
 
-            inspected = gcut_error_inspect(error);
-            g_warning("%s", inspected);
-            g_free(inspected);
-            g_error_free(error);
-        } else {
-            need_no_thread_run = FALSE;
+static gboolean
+worker_read_task (gint fd, guint *index)
+{
+    GString *line;
+    gboolean have_task = FALSE;
+
+    line = g_string_new(NULL);
+    while (TRUE) {
+        gchar character;
+        ssize_t n_read;
+
+        n_read = read(fd, &character, 1);
+        if (n_read < 0 && errno == EINTR)
+            continue;
+        if (n_read <= 0)
+            break;
+        if (character == '\n') {
+            have_task = TRUE;
+            break;
         }
+        g_string_append_c(line, character);
     }
+    if (have_task)
+        *index = (guint)g_ascii_strtoull(line->str, NULL, 10);
+    g_string_free(line, TRUE);
 
-    if (need_no_thread_run)
-        run(info, success);
+    return have_task;
+}
+
+static const gchar *
+get_stream_name (void)
+{
+    if (cut_module_factory_exist_module("stream", "binary"))
+        return "binary";
+    return "xml";
+}
+
+static void
+worker_main (WorkerPool *pool, gint task_fd, gint result_fd)
+{
+    CutModuleFactory *factory;
+    GObject *stream;
+    guint index;
+    const gchar stream_header[] = "<stream>\n";
+
+    if (pool->crash_backtrace)
+        cut_crash_backtrace_free(pool->crash_backtrace);
+
+    cut_run_context_detach_listeners(pool->run_context);
+    factory = cut_module_factory_new("stream", get_stream_name(),
+                                     "fd", result_fd, NULL);
+    if (!factory)
+        _exit(EXIT_FAILURE);
+    /* The parent reads results per test. Don't keep them in
+     * the XML stream's buffer until the worker exits. */
+    if (g_object_class_find_property(G_OBJECT_GET_CLASS(factory),
+                                     "buffer-size"))
+        g_object_set(factory, "buffer-size", 0, NULL);
+    stream = cut_module_factory_create(factory);
+    if (!stream)
+        _exit(EXIT_FAILURE);
+    cut_listener_attach_to_run_context(CUT_LISTENER(stream), pool->run_context);
+
+    /* The binary stream writes its magic by itself. The XML
+     * stream needs the top-level element because workers
+     * don't emit start-run. */
+    if (strcmp(get_stream_name(), "xml") == 0 &&
+        !write_all(result_fd, stream_header, strlen(stream_header)))
+        _exit(EXIT_FAILURE);
+
+    while (worker_read_task(task_fd, &index)) {
+        RunTestInfo *info;
+        gboolean success = TRUE;
+
+        if (index >= pool->test_cases->len)
+            continue;
+
+        info = g_new0(RunTestInfo, 1);
+        info->test_suite = g_object_ref(pool->test_suite);
+        info->test_case = g_object_ref(g_ptr_array_index(pool->test_cases,
+                                                         index));
+        info->run_context = g_object_ref(pool->run_context);
+        info->test_names = g_strdupv((gchar **)pool->test_names);
+        run(info, &success);
+    }
+
+    _exit(EXIT_SUCCESS);
+}
+
+static gboolean
+worker_spawn (WorkerPool *pool, Worker *worker)
+{
+    int task_pipe[2];
+    int result_pipe[2];
+    pid_t pid;
+
+    if (pipe(task_pipe) < 0)
+        return FALSE;
+    if (pipe(result_pipe) < 0) {
+        cut_utils_close_pipe(task_pipe, CUT_READ);
+        cut_utils_close_pipe(task_pipe, CUT_WRITE);
+        return FALSE;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    pid = fork();
+    if (pid == -1) {
+        cut_utils_close_pipe(task_pipe, CUT_READ);
+        cut_utils_close_pipe(task_pipe, CUT_WRITE);
+        cut_utils_close_pipe(result_pipe, CUT_READ);
+        cut_utils_close_pipe(result_pipe, CUT_WRITE);
+        return FALSE;
+    }
+
+    if (pid == 0) {
+        guint i;
+
+        for (i = 0; i < pool->n_workers; i++) {
+            Worker *other = &(pool->workers[i]);
+
+            if (other->pid <= 0)
+                continue;
+            close(other->task_fd);
+            close(other->result_fd);
+        }
+        cut_utils_close_pipe(task_pipe, CUT_WRITE);
+        cut_utils_close_pipe(result_pipe, CUT_READ);
+        worker_main(pool, task_pipe[CUT_READ], result_pipe[CUT_WRITE]);
+    }
+
+    cut_utils_close_pipe(task_pipe, CUT_READ);
+    cut_utils_close_pipe(result_pipe, CUT_WRITE);
+
+    worker->pid = pid;
+    worker->task_fd = task_pipe[CUT_WRITE];
+    worker->result_fd = result_pipe[CUT_READ];
+    worker->parser = cut_stream_parser_new_in_run(pool->run_context);
+    cut_stream_parser_set_process_id(worker->parser, pid);
+    worker->test_case = NULL;
+    worker->started = FALSE;
+
+    return TRUE;
+}
+
+static void
+worker_emit_crash (WorkerPool *pool, Worker *worker, gint status)
+{
+    CutTestCase *test_case;
+    CutTestResult *result;
+    gchar *message;
+
+    test_case = worker->test_case;
+    if (WIFSIGNALED(status))
+        message = g_strdup_printf("worker process (%d) was killed by "
+                                  "signal %d",
+                                  (gint)worker->pid, WTERMSIG(status));
+    else
+        message = g_strdup_printf("worker process (%d) exited with "
+                                  "status %d",
+                                  (gint)worker->pid, WEXITSTATUS(status));
+
+    if (!worker->started)
+        g_signal_emit_by_name(pool->run_context, "start-test-case", test_case);
+    result = cut_test_result_new(CUT_TEST_RESULT_CRASH,
+                                 NULL, NULL, test_case, pool->test_suite, NULL,
+                                 NULL, message, NULL);
+    g_signal_emit_by_name(pool->run_context, "crash-in-test-case",
+                          test_case, result);
+    g_signal_emit_by_name(pool->run_context, "crash-test-case",
+                          test_case, result);
+    g_signal_emit_by_name(pool->run_context, "complete-test-case",
+                          test_case, FALSE);
+    g_object_unref(result);
+    g_free(message);
+
+    *(pool->success) = FALSE;
+}
+
+static void
+worker_reap (WorkerPool *pool, Worker *worker)
+{
+    gint status = 0;
+
+    close(worker->task_fd);
+    close(worker->result_fd);
+    while (waitpid(worker->pid, &status, 0) == -1 && errno == EINTR)
+        ;
+
+    if (worker->test_case)
+        worker_emit_crash(pool, worker, status);
+
+    g_object_unref(worker->parser);
+    worker->parser = NULL;
+    worker->pid = 0;
+    worker->task_fd = -1;
+    worker->result_fd = -1;
+    worker->test_case = NULL;
+    worker->started = FALSE;
+}
+
+static gboolean
+worker_assign (Worker *worker, guint index, CutTestCase *test_case)
+{
+    gchar *task;
+    gboolean written;
+
+    task = g_strdup_printf("%u\n", index);
+    written = write_all(worker->task_fd, task, strlen(task));
+    g_free(task);
+    if (!written)
+        return FALSE;
+
+    worker->test_case = test_case;
+    worker->started = FALSE;
+    return TRUE;
+}
+
+static void
+worker_read_result (WorkerPool *pool, Worker *worker)
+{
+    gchar buffer[4096];
+    ssize_t n_read;
+    GError *error = NULL;
+
+    n_read = read(worker->result_fd, buffer, sizeof(buffer));
+    if (n_read < 0 && errno == EINTR)
+        return;
+    if (n_read <= 0) {
+        worker_reap(pool, worker);
+        return;
+    }
+
+    pool->current_worker = worker;
+    cut_stream_parser_parse(worker->parser, buffer, n_read, &error);
+    pool->current_worker = NULL;
+    if (error) {
+        cut_utils_report_error(error);
+        kill(worker->pid, SIGKILL);
+        worker_reap(pool, worker);
+    }
+}
+
+static void
+cb_worker_start_test_case (CutRunContext *run_context, CutTestCase *test_case,
+                           gpointer data)
+{
+    WorkerPool *pool = data;
+
+    if (pool->current_worker)
+        pool->current_worker->started = TRUE;
+}
+
+static void
+cb_worker_complete_test_case (CutRunContext *run_context,
+                              CutTestCase *test_case, gboolean success,
+                              gpointer data)
+{
+    WorkerPool *pool = data;
+
+    if (!pool->current_worker)
+        return;
+
+    if (!success)
+        *(pool->success) = FALSE;
+    pool->current_worker->test_case = NULL;
+    pool->current_worker->started = FALSE;
+}
+
+static void
+run_with_process_support (CutTestSuite *test_suite, GList *test_cases,
+                          CutRunContext *run_context, const gchar **test_names,
+                          CutCrashBacktrace *crash_backtrace,
+                          gboolean *success)
+{
+    WorkerPool pool;
+    GList *node;
+    struct pollfd *poll_fds;
+    Worker **polled_workers;
+    guint i, next_index = 0;
+    struct sigaction ignore_action, previous_pipe_action;
+
+    pool.test_suite = test_suite;
+    pool.run_context = run_context;
+    pool.test_names = test_names;
+    pool.crash_backtrace = crash_backtrace;
+    pool.current_worker = NULL;
+    pool.success = success;
+    pool.test_cases = g_ptr_array_new();
+    for (node = test_cases; node; node = g_list_next(node)) {
+        CutTestCase *test_case = node->data;
+
+        if (!test_case)
+            continue;
+        if (CUT_IS_TEST_CASE(test_case))
+            g_ptr_array_add(pool.test_cases, test_case);
+        else
+            g_warning("This object is not test case!");
+    }
+    pool.n_workers = MIN((guint)cut_run_context_get_n_processes(run_context),
+                         pool.test_cases->len);
+    pool.workers = g_new0(Worker, pool.n_workers);
+    poll_fds = g_new0(struct pollfd, pool.n_workers);
+    polled_workers = g_new0(Worker *, pool.n_workers);
+
+    ignore_action.sa_handler = SIG_IGN;
+    sigemptyset(&ignore_action.sa_mask);
+    ignore_action.sa_flags = 0;
+    sigaction(SIGPIPE, &ignore_action, &previous_pipe_action);
+
+    g_signal_connect(run_context, "start-test-case",
+                     G_CALLBACK(cb_worker_start_test_case), &pool);
+    g_signal_connect(run_context, "complete-test-case",
+                     G_CALLBACK(cb_worker_complete_test_case), &pool);
+
+    while (TRUE) {
+        guint n_polled_workers = 0;
+        gboolean have_worker = FALSE;
+        gint n_ready;
+
+        for (i = 0; i < pool.n_workers; i++) {
+            Worker *worker = &(pool.workers[i]);
+
+            if (worker->pid <= 0) {
+                if (next_index >= pool.test_cases->len ||
+                    cut_run_context_is_canceled(run_context))
+                    continue;
+                if (!worker_spawn(&pool, worker))
+                    continue;
+            }
+            have_worker = TRUE;
+
+            if (!worker->test_case &&
+                next_index < pool.test_cases->len &&
+                !cut_run_context_is_canceled(run_context)) {
+                CutTestCase *test_case;
+
+                test_case = g_ptr_array_index(pool.test_cases, next_index);
+                if (worker_assign(worker, next_index, test_case)) {
+                    next_index++;
+                } else {
+                    worker_reap(&pool, worker);
+                    continue;
+                }
+            }
+
+            if (worker->test_case) {
+                poll_fds[n_polled_workers].fd = worker->result_fd;
+                poll_fds[n_polled_workers].events = POLLIN;
+                poll_fds[n_polled_workers].revents = 0;
+                polled_workers[n_polled_workers] = worker;
+                n_polled_workers++;
+            }
+        }
+
+        if (!have_worker) {
+            for (; next_index < pool.test_cases->len; next_index++) {
+                CutTestCase *test_case;
+
+                test_case = g_ptr_array_index(pool.test_cases, next_index);
+                run_with_thread_support(test_suite, test_case, run_context,
+                                        test_names, NULL, success);
+            }
+            break;
+        }
+        if (n_polled_workers == 0)
+            break;
+
+        n_ready = poll(poll_fds, n_polled_workers, -1);
+        if (n_ready < 0)
+            continue;
+
+        for (i = 0; i < n_polled_workers; i++) {
+            if (poll_fds[i].revents == 0)
+                continue;
+            worker_read_result(&pool, polled_workers[i]);
+        }
+    }
+
+    for (i = 0; i < pool.n_workers; i++) {
+        Worker *worker = &(pool.workers[i]);
+
+        if (worker->pid > 0)
+            worker_reap(&pool, worker);
+    }
+
+    g_signal_handlers_disconnect_by_func(run_context,
+                                         G_CALLBACK(cb_worker_start_test_case),
+                                         &pool);
+    g_signal_handlers_disconnect_by_func(run_context,
+                                         G_CALLBACK(cb_worker_complete_test_case),
+                                         &pool);
+    sigaction(SIGPIPE, &previous_pipe_action, NULL);
+
+    g_free(polled_workers);
+    g_free(poll_fds);
+    g_free(pool.workers);
+    g_ptr_array_free(pool.test_cases, TRUE);
+}
+#endif
+
+static gboolean
+use_multi_process (CutRunContext *run_context)
+{
+#ifdef G_OS_WIN32
+    return FALSE;
+#else
+    if (cut_run_context_get_n_processes(run_context) <= 1)
+        return FALSE;
+    return cut_module_factory_exist_module("stream", "binary") ||
+        cut_module_factory_exist_module("stream", "xml");
+#endif
 }
 
 static void
@@ -315,9 +773,10 @@ cut_test_suite_run_test_cases (CutTestSuite *test_suite,
 {
     CutTestSuitePrivate *priv;
     GList *node;
-    GThreadPool *thread_pool = NULL;
+    CutSchedulerGroup *group = NULL;
     GList *sorted_test_cases;
     gboolean try_thread;
+    gboolean try_process;
     gboolean all_success = TRUE;
     gint signum;
     jmp_buf jump_buffer;
@@ -326,20 +785,18 @@ cut_test_suite_run_test_cases (CutTestSuite *test_suite,
     priv = CUT_TEST_SUITE_GET_PRIVATE(test_suite);
 
     sorted_test_cases = g_list_copy(test_cases);
+    sorted_test_cases = cut_run_context_shard_test_cases(run_context,
+                                                         sorted_test_cases);
     sorted_test_cases = cut_run_context_sort_test_cases(run_context,
                                                         sorted_test_cases);
 
-    try_thread = cut_run_context_get_multi_thread(run_context);
+    try_process = use_multi_process(run_context);
+    try_thread = !try_process && cut_run_context_get_multi_thread(run_context);
     if (try_thread) {
-        GError *error = NULL;
-        gint max_threads;
-
-        max_threads = cut_run_context_get_max_threads(run_context);
-        thread_pool = g_thread_pool_new(run, &all_success,
-                                        max_threads, FALSE, &error);
-        if (error) {
-            cut_utils_report_error(error);
-        }
+        CutScheduler *scheduler;
+
+        scheduler = cut_run_context_get_scheduler(run_context);
+        group = cut_scheduler_group_new(scheduler, run, &all_success);
     }
 
     if (cut_run_context_get_handle_signals(run_context)) {
@@ -356,21 +813,35 @@ cut_test_suite_run_test_cases (CutTestSuite *test_suite,
         if (priv->warmup)
             priv->warmup();
 
-        for (node = sorted_test_cases; node; node = g_list_next(node)) {
+#ifndef G_OS_WIN32
+        if (try_process) {
+            run_with_process_support(test_suite, sorted_test_cases,
+                                     run_context, test_names,
+                                     crash_backtrace, &all_success);
+        }
+#endif
+        if (group && crash_backtrace)
+            cut_crash_backtrace_hold_interrupts(crash_backtrace);
+        for (node = sorted_test_cases;
+             !try_process && node;
+             node = g_list_next(node)) {
             CutTestCase *test_case = node->data;
 
             if (!test_case)
                 continue;
             if (CUT_IS_TEST_CASE(test_case)) {
                 run_with_thread_support(test_suite, test_case, run_context,
-                                        test_names, thread_pool, &all_success);
+                                        test_names, group, &all_success);
             } else {
                 g_warning("This object is not test case!");
             }
         }
 
-        if (thread_pool)
-            g_thread_pool_free(thread_pool, FALSE, TRUE);
+        if (group) {
+            cut_scheduler_group_join(group);
+            if (crash_backtrace)
+                cut_crash_backtrace_release_interrupts(crash_backtrace);
+        }
 
         if (all_success) {
             CutTestResult *result;
@@ -380,8 +851,6 @@ cut_test_suite_run_test_cases (CutTestSuite *test_suite,
             cut_test_emit_result_signal(CUT_TEST(test_suite), NULL, result);
             g_object_unref(result);
         }
-        if (crash_backtrace)
-            cut_crash_backtrace_free(crash_backtrace);
         break;
 #ifndef G_OS_WIN32
     case SIGSEGV:
@@ -389,7 +858,8 @@ cut_test_suite_run_test_cases (CutTestSuite *test_suite,
     case SIGTERM:
     case SIGBUS:
         all_success = FALSE;
-        cut_crash_backtrace_emit(test_suite, NULL, NULL, NULL, NULL, NULL);
+        cut_crash_backtrace_emit(crash_backtrace,
+                                 test_suite, NULL, NULL, NULL, NULL, NULL);
         break;
     case SIGINT:
         cut_run_context_cancel(run_context);
@@ -399,6 +869,9 @@ cut_test_suite_run_test_cases (CutTestSuite *test_suite,
         break;
     }
 
+    if (crash_backtrace)
+        cut_crash_backtrace_free(crash_backtrace);
+
     if (priv->cooldown)
         priv->cooldown();
 
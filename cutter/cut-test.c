@@ -30,10 +30,13 @@
 
 #include "cut-test.h"
 #include "cut-test-container.h"
+#include "cut-test-case.h"
 #include "cut-run-context.h"
 #include "cut-test-result.h"
+#include "cut-test-history.h"
 #include "cut-utils.h"
 #include "cut-crash-backtrace.h"
+#include "cut-event-sink.h"
 
 #include <gcutter/gcut-marshalers.h>
 
@@ -50,9 +53,18 @@ struct _CutTestPrivate
     gchar *full_name;
     gchar *element_name;
     CutTestFunction test_function;
-    GTimer *timer;
+    guint64 start_monotonic_time;
+    guint64 stop_monotonic_time;
     GTimeVal start_time;
     gdouble elapsed;
+    CutPhaseElapsed phase_elapsed;
+    CutTestPhase current_phase;
+    guint64 phase_start_monotonic_time;
+    CutResourceUsage *resource_usage;
+    CutResourceUsage resource_usage_start;
+    gboolean resource_usage_thread;
+    gboolean measuring_resource_usage;
+    gboolean teardown_started;
     GHashTable *attributes;
     gchar *base_directory;
     jmp_buf *jump_buffer;
@@ -71,6 +83,7 @@ enum
 {
     START,
     PASS_ASSERTION,
+    PASS_ASSERTIONS,
     SUCCESS,
     FAILURE,
     ERROR,
@@ -183,6 +196,15 @@ cut_test_class_init (CutTestClass *klass)
                         g_cclosure_marshal_VOID__OBJECT,
                         G_TYPE_NONE, 1, CUT_TYPE_TEST_CONTEXT);
 
+    cut_test_signals[PASS_ASSERTIONS]
+        = g_signal_new ("pass-assertions",
+                        G_TYPE_FROM_CLASS (klass),
+                        G_SIGNAL_RUN_LAST,
+                        G_STRUCT_OFFSET (CutTestClass, pass_assertions),
+                        NULL, NULL,
+                        _gcut_marshal_VOID__OBJECT_UINT,
+                        G_TYPE_NONE, 2, CUT_TYPE_TEST_CONTEXT, G_TYPE_UINT);
+
     cut_test_signals[SUCCESS]
         = g_signal_new ("success",
                         G_TYPE_FROM_CLASS (klass),
@@ -274,10 +296,18 @@ cut_test_init (CutTest *test)
     priv->full_name = NULL;
 
     priv->test_function = NULL;
-    priv->timer = NULL;
+    priv->start_monotonic_time = 0;
+    priv->stop_monotonic_time = 0;
     priv->start_time.tv_sec = 0;
     priv->start_time.tv_usec = 0;
     priv->elapsed = -1.0;
+    cut_phase_elapsed_init(&(priv->phase_elapsed));
+    priv->current_phase = CUT_TEST_PHASE_LAST;
+    priv->phase_start_monotonic_time = 0;
+    priv->resource_usage = NULL;
+    priv->resource_usage_thread = FALSE;
+    priv->measuring_resource_usage = FALSE;
+    priv->teardown_started = FALSE;
     priv->attributes = g_hash_table_new_full(g_str_hash, g_str_equal,
                                              g_free, g_free);
     priv->jump_buffer = NULL;
@@ -309,9 +339,9 @@ dispose (GObject *object)
 
     priv->test_function = NULL;
 
-    if (priv->timer) {
-        g_timer_destroy(priv->timer);
-        priv->timer = NULL;
+    if (priv->resource_usage) {
+        g_free(priv->resource_usage);
+        priv->resource_usage = NULL;
     }
 
     if (priv->attributes) {
@@ -429,6 +459,102 @@ invoke (CutTest *test, CutTestContext *test_context, CutRunContext *run_context)
     priv->test_function();
 }
 
+/*
+ * Signals of a test are emitted by ID. GLib skips an
+ * emission that has neither handler nor class closure, so
+ * they cost almost nothing when nobody connects to them.
+ */
+static void
+emit_start (CutTest *test, CutTestContext *test_context)
+{
+    const CutEventSink *sink;
+    gpointer sink_data;
+
+    g_signal_emit(test, cut_test_signals[START], 0, test_context);
+
+    if (!test_context)
+        return;
+    sink = cut_test_context_get_event_sink(test_context, &sink_data);
+    if (sink)
+        sink->start(test, test_context, sink_data);
+}
+
+static void
+emit_complete (CutTest *test, CutTestContext *test_context, gboolean success)
+{
+    const CutEventSink *sink;
+    gpointer sink_data;
+
+    g_signal_emit(test, cut_test_signals[COMPLETE], 0, test_context, success);
+
+    if (!test_context)
+        return;
+    sink = cut_test_context_get_event_sink(test_context, &sink_data);
+    if (sink)
+        sink->complete(test, test_context, success, sink_data);
+}
+
+static gboolean
+check_elapsed_regression (CutTest *test, CutTestContext *test_context,
+                          CutRunContext *run_context, CutTestCase *test_case,
+                          CutTestIterator *test_iterator, CutTestData *data)
+{
+    CutTestResultStatus status;
+    CutTestResult *result;
+    gchar *message = NULL;
+
+    status = cut_run_context_check_elapsed_regression(run_context,
+                                                      test, test_case,
+                                                      &message);
+    if (status == CUT_TEST_RESULT_SUCCESS)
+        return TRUE;
+
+    result = cut_test_result_new(status,
+                                 test, test_iterator, test_case,
+                                 NULL, data,
+                                 NULL, message, NULL);
+    cut_test_emit_result_signal(test, test_context, result);
+    g_object_unref(result);
+    g_free(message);
+
+    if (status != CUT_TEST_RESULT_FAILURE)
+        return TRUE;
+
+    cut_test_context_set_failed(test_context, TRUE);
+    return FALSE;
+}
+
+/*
+ * Teardown runs before the result of the test is built so
+ * that the result has the elapsed time and the resource
+ * usage of the teardown phase. The flag is set before the
+ * teardown function is called so that a crash in it
+ * doesn't run it again.
+ */
+static void
+run_teardown (CutTest *test, CutTestContext *test_context,
+              CutRunContext *run_context)
+{
+    CutTestPrivate *priv;
+    CutTestCase *test_case;
+    gboolean measure_phases;
+
+    priv = CUT_TEST_GET_PRIVATE(test);
+    priv->teardown_started = TRUE;
+
+    test_case = cut_test_context_get_test_case(test_context);
+    if (test_case) {
+        measure_phases = cut_run_context_get_measure_phases(run_context);
+        if (measure_phases)
+            cut_test_start_phase(test, CUT_TEST_PHASE_TEARDOWN);
+        cut_test_case_run_teardown(test_case, test_context);
+        if (measure_phases)
+            cut_test_stop_phase(test, CUT_TEST_PHASE_TEARDOWN);
+    }
+
+    cut_test_stop_resource_usage(test);
+}
+
 static gboolean
 run (CutTest *test, CutTestContext *test_context, CutRunContext *run_context)
 {
@@ -443,11 +569,14 @@ run (CutTest *test, CutTestContext *test_context, CutRunContext *run_context)
     gint signum;
     jmp_buf crash_jump_buffer;
     CutCrashBacktrace *crash_backtrace = NULL;
+    gboolean measure_phases;
 
     priv = CUT_TEST_GET_PRIVATE(test);
     klass = CUT_TEST_GET_CLASS(test);
+    measure_phases = cut_run_context_get_measure_phases(run_context);
 
     priv->jump_buffer = &jump_buffer;
+    priv->teardown_started = FALSE;
 
     if (!klass->is_available(test, test_context, run_context)) {
         priv->jump_buffer = NULL;
@@ -459,8 +588,7 @@ run (CutTest *test, CutTestContext *test_context, CutRunContext *run_context)
     if (CUT_IS_ITERATED_TEST(test))
         data = cut_iterated_test_get_data(CUT_ITERATED_TEST(test));
 
-    if (cut_run_context_is_multi_thread(run_context) ||
-        !cut_run_context_get_handle_signals(run_context)) {
+    if (!cut_run_context_get_handle_signals(run_context)) {
         signum = 0;
     } else {
         crash_backtrace = cut_crash_backtrace_new(&crash_jump_buffer);
@@ -468,23 +596,19 @@ run (CutTest *test, CutTestContext *test_context, CutRunContext *run_context)
     }
     switch (signum) {
     case 0:
-        g_signal_emit_by_name(test, "start", test_context);
+        emit_start(test, test_context);
 
         cut_test_context_set_jump_buffer(test_context, &jump_buffer);
         if (setjmp(jump_buffer) == 0) {
-            if (priv->timer) {
-                g_timer_start(priv->timer);
-            } else {
-                priv->timer = g_timer_new();
-            }
+            if (measure_phases)
+                cut_test_start_phase(test, CUT_TEST_PHASE_TEST);
+            priv->start_monotonic_time = cut_utils_get_monotonic_time();
+            priv->stop_monotonic_time = 0;
             klass->invoke(test, test_context, run_context);
         }
-        g_timer_stop(priv->timer);
-
-        success = !cut_test_context_is_failed(test_context);
-
-        if (crash_backtrace)
-            cut_crash_backtrace_free(crash_backtrace);
+        priv->stop_monotonic_time = cut_utils_get_monotonic_time();
+        if (measure_phases)
+            cut_test_stop_phase(test, CUT_TEST_PHASE_TEST);
         break;
 #ifndef G_OS_WIN32
     case SIGSEGV:
@@ -495,7 +619,8 @@ run (CutTest *test, CutTestContext *test_context, CutRunContext *run_context)
         {
             CutTestSuite *test_suite;
             test_suite = cut_test_context_get_test_suite(test_context);
-            cut_crash_backtrace_emit(test_suite, test_case,
+            cut_crash_backtrace_emit(crash_backtrace,
+                                     test_suite, test_case,
                                      test, test_iterator, data,
                                      test_context);
         }
@@ -508,6 +633,19 @@ run (CutTest *test, CutTestContext *test_context, CutRunContext *run_context)
         break;
     }
 
+    if (crash_backtrace)
+        cut_crash_backtrace_free(crash_backtrace);
+
+    run_teardown(test, test_context, run_context);
+    if (signum == 0)
+        success = !cut_test_context_is_failed(test_context);
+
+    cut_test_context_flush_pass_assertions(test_context);
+
+    if (success && signum == 0)
+        success = check_elapsed_regression(test, test_context, run_context,
+                                           test_case, test_iterator, data);
+
     if (success) {
         result = cut_test_result_new(CUT_TEST_RESULT_SUCCESS,
                                      test, test_iterator, test_case,
@@ -517,7 +655,7 @@ run (CutTest *test, CutTestContext *test_context, CutRunContext *run_context)
         g_object_unref(result);
     }
 
-    g_signal_emit_by_name(test, "complete", test_context, success);
+    emit_complete(test, test_context, success);
 
     priv->jump_buffer = NULL;
 
@@ -537,6 +675,17 @@ cut_test_run (CutTest *test, CutTestContext *test_context,
     return CUT_TEST_GET_CLASS(test)->run(test, test_context, run_context);
 }
 
+void
+cut_test_run_teardown (CutTest *test, CutTestContext *test_context,
+                       CutRunContext *run_context)
+{
+    CutTestPrivate *priv = CUT_TEST_GET_PRIVATE(test);
+
+    if (!priv->teardown_started)
+        run_teardown(test, test_context, run_context);
+    priv->teardown_started = FALSE;
+}
+
 void
 cut_test_long_jump (CutTest *test, jmp_buf *jump_buffer, gint value)
 {
@@ -632,10 +781,16 @@ get_elapsed (CutTest *test)
     if (!(priv->elapsed < 0.0))
         return priv->elapsed;
 
-    if (priv->timer)
-        return g_timer_elapsed(priv->timer, NULL);
-    else
+    if (priv->start_monotonic_time == 0) {
         return 0.0;
+    } else {
+        guint64 stop_monotonic_time;
+
+        stop_monotonic_time = priv->stop_monotonic_time;
+        if (stop_monotonic_time == 0)
+            stop_monotonic_time = cut_utils_get_monotonic_time();
+        return (stop_monotonic_time - priv->start_monotonic_time) / 1e9;
+    }
 }
 
 gdouble
@@ -656,6 +811,116 @@ cut_test_set_elapsed (CutTest *test, gdouble elapsed)
     CUT_TEST_GET_CLASS(test)->set_elapsed(test, elapsed);
 }
 
+void
+cut_test_start_resource_usage (CutTest *test, gboolean thread)
+{
+    CutTestPrivate *priv = CUT_TEST_GET_PRIVATE(test);
+
+    cut_test_set_resource_usage(test, NULL);
+    priv->resource_usage_thread = thread;
+    priv->measuring_resource_usage =
+        cut_resource_usage_get(&(priv->resource_usage_start), thread);
+}
+
+static void
+update_resource_usage (CutTest *test)
+{
+    CutTestPrivate *priv = CUT_TEST_GET_PRIVATE(test);
+    CutResourceUsage usage;
+
+    if (!cut_resource_usage_get(&usage, priv->resource_usage_thread))
+        return;
+
+    cut_resource_usage_subtract(&usage, &(priv->resource_usage_start));
+    cut_test_set_resource_usage(test, &usage);
+}
+
+void
+cut_test_stop_resource_usage (CutTest *test)
+{
+    CutTestPrivate *priv = CUT_TEST_GET_PRIVATE(test);
+
+    if (!priv->measuring_resource_usage)
+        return;
+
+    update_resource_usage(test);
+    priv->measuring_resource_usage = FALSE;
+}
+
+const CutResourceUsage *
+cut_test_get_resource_usage (CutTest *test)
+{
+    CutTestPrivate *priv = CUT_TEST_GET_PRIVATE(test);
+
+    if (priv->measuring_resource_usage)
+        update_resource_usage(test);
+
+    return priv->resource_usage;
+}
+
+void
+cut_test_set_resource_usage (CutTest *test, const CutResourceUsage *usage)
+{
+    CutTestPrivate *priv = CUT_TEST_GET_PRIVATE(test);
+
+    if (!usage) {
+        g_free(priv->resource_usage);
+        priv->resource_usage = NULL;
+        return;
+    }
+
+    if (!priv->resource_usage)
+        priv->resource_usage = g_new(CutResourceUsage, 1);
+    *(priv->resource_usage) = *usage;
+}
+
+/*
+ * Phases of a test run one by one, so only one phase is
+ * measured at a time.
+ */
+void
+cut_test_start_phase (CutTest *test, CutTestPhase phase)
+{
+    CutTestPrivate *priv = CUT_TEST_GET_PRIVATE(test);
+
+    priv->current_phase = phase;
+    priv->phase_start_monotonic_time = cut_utils_get_monotonic_time();
+}
+
+void
+cut_test_stop_phase (CutTest *test, CutTestPhase phase)
+{
+    CutTestPrivate *priv = CUT_TEST_GET_PRIVATE(test);
+    guint64 now;
+
+    if (priv->current_phase != phase)
+        return;
+
+    now = cut_utils_get_monotonic_time();
+    cut_phase_elapsed_add(&(priv->phase_elapsed), phase,
+                          now - priv->phase_start_monotonic_time);
+    priv->current_phase = CUT_TEST_PHASE_LAST;
+}
+
+const CutPhaseElapsed *
+cut_test_get_phase_elapsed (CutTest *test)
+{
+    return &(CUT_TEST_GET_PRIVATE(test)->phase_elapsed);
+}
+
+void
+cut_test_set_phase_elapsed (CutTest *test,
+                            const CutPhaseElapsed *phase_elapsed)
+{
+    CutTestPrivate *priv = CUT_TEST_GET_PRIVATE(test);
+
+    if (phase_elapsed)
+        priv->phase_elapsed = *phase_elapsed;
+    else
+        cut_phase_elapsed_init(&(priv->phase_elapsed));
+    priv->current_phase = CUT_TEST_PHASE_LAST;
+}
+
 const gchar *
 cut_test_get_attribute (CutTest *test, const gchar *name)
 {
@@ -734,6 +999,7 @@ cut_test_to_xml_string (CutTest *test, GString *string, guint indent)
     CutTestPrivate *priv;
     gchar *escaped, *start_time, *elapsed;
     const gchar *description, *name;
+    const CutResourceUsage *resource_usage;
     GHashTable *attributes;
 
     priv = CUT_TEST_GET_PRIVATE(test);
@@ -762,6 +1028,14 @@ cut_test_to_xml_string (CutTest *test, GString *string, guint indent)
                                             "elapsed", elapsed);
     g_free(elapsed);
 
+    resource_usage = cut_test_get_resource_usage(test);
+    if (resource_usage)
+        cut_resource_usage_to_xml_string(resource_usage, string, indent + 2);
+
+    if (!cut_phase_elapsed_is_empty(&(priv->phase_elapsed)))
+        cut_phase_elapsed_to_xml_string(&(priv->phase_elapsed),
+                                        string, indent + 2);
+
     attributes = cut_test_get_attributes(test);
     if (attributes) {
         AppendAttributeInfo info;
@@ -784,6 +1058,32 @@ cut_test_set_result_elapsed (CutTest *test, CutTestResult *result)
     priv = CUT_TEST_GET_PRIVATE(test);
     cut_test_result_set_start_time(result, &(priv->start_time));
     cut_test_result_set_elapsed(result, cut_test_get_elapsed(test));
+    cut_test_result_set_resource_usage(result,
+                                       cut_test_get_resource_usage(test));
+    cut_test_result_set_phase_elapsed(result, &(priv->phase_elapsed));
+}
+
+static guint
+status_to_signal_id (CutTestResultStatus status)
+{
+    switch (status) {
+    case CUT_TEST_RESULT_SUCCESS:
+        return cut_test_signals[SUCCESS];
+    case CUT_TEST_RESULT_NOTIFICATION:
+        return cut_test_signals[NOTIFICATION];
+    case CUT_TEST_RESULT_OMISSION:
+        return cut_test_signals[OMISSION];
+    case CUT_TEST_RESULT_PENDING:
+        return cut_test_signals[PENDING];
+    case CUT_TEST_RESULT_FAILURE:
+        return cut_test_signals[FAILURE];
+    case CUT_TEST_RESULT_ERROR:
+        return cut_test_signals[ERROR];
+    case CUT_TEST_RESULT_CRASH:
+        return cut_test_signals[CRASH];
+    default:
+        return 0;
+    }
 }
 
 static void
@@ -791,12 +1091,24 @@ emit_result_signal (CutTest *test,
                     CutTestContext *test_context,
                     CutTestResult *result)
 {
-    const gchar *status_signal_name = NULL;
     CutTestResultStatus status;
+    guint signal_id;
+    const CutEventSink *sink;
+    gpointer sink_data;
 
     status = cut_test_result_get_status(result);
-    status_signal_name = cut_test_result_status_to_signal_name(status);
-    g_signal_emit_by_name(test, status_signal_name, test_context, result);
+    signal_id = status_to_signal_id(status);
+    if (signal_id == 0) {
+        g_warning("invalid test result status: %d", status);
+        return;
+    }
+    g_signal_emit(test, signal_id, 0, test_context, result);
+
+    if (!test_context)
+        return;
+    sink = cut_test_context_get_event_sink(test_context, &sink_data);
+    if (sink)
+        sink->result(test, test_context, result, sink_data);
 }
 
 void
@@ -806,6 +1118,11 @@ cut_test_emit_result_signal (CutTest *test,
 {
     cut_test_set_result_elapsed(test, result);
 
+    if (test_context) {
+        cut_test_context_flush_pass_assertions(test_context);
+        cut_test_context_update_result_status(test_context,
+                                              cut_test_result_get_status(result));
+    }
     CUT_TEST_GET_CLASS(test)->emit_result_signal(test, test_context, result);
 }
 
@@ -26,6 +26,8 @@
 
 #include <cutter/cut-private.h>
 #include <cutter/cut-test-context.h>
+#include <cutter/cut-resource-usage.h>
+#include <cutter/cut-test-phase.h>
 
 G_BEGIN_DECLS
 
@@ -58,6 +60,9 @@ struct _CutTestClass
                             CutTestContext *context);
     void (*pass_assertion) (CutTest        *test,
                             CutTestContext *context);
+    void (*pass_assertions)(CutTest        *test,
+                            CutTestContext *context,
+                            guint           n_assertions);
     void (*success)        (CutTest        *test,
                             CutTestContext *context,
                             CutTestResult  *result);
@@ -112,6 +117,9 @@ CutTest     *cut_test_new_empty           (void);
 gboolean     cut_test_run                 (CutTest        *test,
                                            CutTestContext *test_context,
                                            CutRunContext  *run_context);
+void         cut_test_run_teardown        (CutTest        *test,
+                                           CutTestContext *test_context,
+                                           CutRunContext  *run_context);
 
 void         cut_test_long_jump           (CutTest        *test,
                                            jmp_buf        *jump_buffer,
@@ -131,6 +139,21 @@ void         cut_test_set_start_time      (CutTest     *test,
 gdouble      cut_test_get_elapsed         (CutTest     *test);
 void         cut_test_set_elapsed         (CutTest     *test,
                                            gdouble      elapsed);
+void         cut_test_start_resource_usage(CutTest     *test,
+                                           gboolean     thread);
+void         cut_test_stop_resource_usage (CutTest     *test);
+const CutResourceUsage *
+             cut_test_get_resource_usage  (CutTest     *test);
+void         cut_test_set_resource_usage  (CutTest     *test,
+                                           const CutResourceUsage *usage);
+void         cut_test_start_phase         (CutTest     *test,
+                                           CutTestPhase phase);
+void         cut_test_stop_phase          (CutTest     *test,
+                                           CutTestPhase phase);
+const CutPhaseElapsed *
+             cut_test_get_phase_elapsed   (CutTest     *test);
+void         cut_test_set_phase_elapsed   (CutTest     *test,
+                                           const CutPhaseElapsed *phase_elapsed);
 const gchar *cut_test_get_attribute       (CutTest     *test,
                                            const gchar *name);
 void         cut_test_set_attribute       (CutTest     *test,
@@ -1,6 +1,6 @@
 /* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
 /*
- *  Copyright (C) 2007-2011  Kouhei Sutou <kou@clear-code.com>
+ *  Copyright (C) 2007-2014  Kouhei Sutou <kou@clear-code.com>
  *
  *  This library is free software: you can redistribute it and/or modify
  *  it under the terms of the GNU Lesser General Public License as published by
@@ -26,10 +26,14 @@
 #ifdef HAVE_UNISTD_H
 #  include <unistd.h>
 #endif
+#ifdef HAVE_CLOCK_GETTIME
+#  include <time.h>
+#endif
 #include <glib.h>
 #include <glib/gstdio.h>
 #ifdef G_OS_WIN32
 #  include <winsock2.h>
+#  include <windows.h>
 #  include <io.h>
 #  define close _close
 #endif
@@ -128,16 +132,17 @@ cut_utils_inspect_memory (const void *memory, size_t size)
     const guchar *binary = memory;
     GString *buffer;
     size_t i, n_printable_characters;
-    size_t max_size = 1024;
+    size_t max_size;
 
     if (memory == NULL || size == 0)
         return g_strdup("(null)");
 
-    buffer = g_string_sized_new(size * strlen("0xXX") +
-                                (size - 1) * strlen(" ") +
-                                strlen(": ") +
-                                size);
-    max_size = MIN(size, max_size);
+    max_size = MIN(size, CUT_UTILS_INSPECT_MEMORY_MAX_SIZE);
+    buffer = g_string_sized_new(max_size * strlen("0xXX") +
+                                (max_size - 1) * strlen(" ") +
+                                strlen(" ...: ") +
+                                max_size +
+                                strlen("..."));
     n_printable_characters = 0;
     for (i = 0; i < max_size; i++) {
         g_string_append_printf(buffer, "0x%02x ", binary[i]);
@@ -165,6 +170,258 @@ cut_utils_inspect_memory (const void *memory, size_t size)
     return g_string_free(buffer, FALSE);
 }
 
+gboolean
+cut_utils_equal_memory (const void *memory1, gsize size1,
+                        const void *memory2, gsize size2)
+{
+    if (size1 != size2)
+        return FALSE;
+    if (memory1 == memory2 || size1 == 0)
+        return TRUE;
+    return memcmp(memory1, memory2, size1) == 0;
+}
+
+/*
+ * Differences are searched by memcmp() per chunk because
+ * memcmp() is the most optimized compare on each
+ * platform. Only the chunk that has a difference is
+ * scanned byte by byte.
+ */
+#define MEMORY_SCAN_CHUNK_SIZE 4096
+
+static gsize
+find_memory_difference_forward (const guchar *memory1, const guchar *memory2,
+                                gsize begin, gsize end)
+{
+    gsize offset = begin;
+
+    while (offset < end) {
+        gsize size;
+
+        size = MIN(end - offset, MEMORY_SCAN_CHUNK_SIZE);
+        if (memcmp(memory1 + offset, memory2 + offset, size) != 0) {
+            while (memory1[offset] == memory2[offset])
+                offset++;
+            return offset;
+        }
+        offset += size;
+    }
+
+    return end;
+}
+
+static gsize
+find_memory_difference_backward (const guchar *memory1, const guchar *memory2,
+                                 gsize begin, gsize end)
+{
+    gsize offset = end;
+
+    while (offset > begin) {
+        gsize size;
+
+        size = MIN(offset - begin, MEMORY_SCAN_CHUNK_SIZE);
+        if (memcmp(memory1 + offset - size, memory2 + offset - size,
+                   size) != 0) {
+            while (memory1[offset - 1] == memory2[offset - 1])
+                offset--;
+            return offset;
+        }
+        offset -= size;
+    }
+
+    return begin;
+}
+
+static gsize
+count_memory_differences (const guchar *memory1, const guchar *memory2,
+                          gsize begin, gsize end)
+{
+    const guint64 low_bits = G_GUINT64_CONSTANT(0x0101010101010101);
+    gsize offset = begin;
+    gsize n_differences = 0;
+
+    /* Compares 8 bytes at once. The lowest bit of each byte
+     * of "bits" is set when the byte differs and the
+     * multiplication sums them into the highest byte. */
+    for (; offset + sizeof(guint64) <= end; offset += sizeof(guint64)) {
+        guint64 word1, word2, bits;
+
+        memcpy(&word1, memory1 + offset, sizeof(word1));
+        memcpy(&word2, memory2 + offset, sizeof(word2));
+        bits = word1 ^ word2;
+        bits |= bits >> 4;
+        bits |= bits >> 2;
+        bits |= bits >> 1;
+        bits &= low_bits;
+        n_differences += (gsize)((bits * low_bits) >> 56);
+    }
+    for (; offset < end; offset++) {
+        if (memory1[offset] != memory2[offset])
+            n_differences++;
+    }
+
+    return n_differences;
+}
+
+static gsize
+find_next_memory_difference (const guchar *memory1, gsize size1,
+                             const guchar *memory2, gsize size2,
+                             gsize offset)
+{
+    gsize common_size;
+
+    common_size = MIN(size1, size2);
+    if (offset < common_size) {
+        offset = find_memory_difference_forward(memory1, memory2,
+                                                offset, common_size);
+        if (offset < common_size)
+            return offset;
+    }
+
+    /* Bytes after the end of the shorter one are differences. */
+    return MIN(offset, MAX(size1, size2));
+}
+
+gboolean
+cut_utils_find_memory_difference (const void *memory1, gsize size1,
+                                  const void *memory2, gsize size2,
+                                  CutMemoryDifference *difference)
+{
+    gsize common_size, max_size, first, last_end;
+
+    common_size = MIN(size1, size2);
+    max_size = MAX(size1, size2);
+    first = find_next_memory_difference(memory1, size1, memory2, size2, 0);
+    if (first == max_size)
+        return FALSE;
+
+    if (size1 == size2)
+        last_end = find_memory_difference_backward(memory1, memory2,
+                                                   first, common_size);
+    else
+        last_end = max_size;
+
+    difference->first = first;
+    difference->last = last_end - 1;
+    difference->n_differences =
+        count_memory_differences(memory1, memory2,
+                                 first, MIN(last_end, common_size)) +
+        (max_size - common_size);
+
+    return TRUE;
+}
+
+#define MEMORY_DUMP_ROW_SIZE 16
+#define MEMORY_DIFFERENCE_CONTEXT_ROWS 2
+#define MEMORY_DIFFERENCE_MAX_WINDOWS 8
+
+static void
+append_memory_dump_row (GString *dump, const guchar *memory, gsize size,
+                        gsize offset)
+{
+    gsize i, end;
+
+    if (offset >= size)
+        return;
+
+    end = MIN(offset + MEMORY_DUMP_ROW_SIZE, size);
+    g_string_append_printf(dump, "0x%08" G_GSIZE_MODIFIER "x:", offset);
+    for (i = offset; i < offset + MEMORY_DUMP_ROW_SIZE; i++) {
+        if (i < end)
+            g_string_append_printf(dump, " %02x", memory[i]);
+        else
+            g_string_append(dump, "   ");
+    }
+    g_string_append(dump, "  ");
+    for (i = offset; i < end; i++) {
+        if (g_ascii_isprint(memory[i]))
+            g_string_append_c(dump, memory[i]);
+        else
+            g_string_append_c(dump, '.');
+    }
+    g_string_append_c(dump, '\n');
+}
+
+static void
+append_memory_dump_rows (GString *dump1, const guchar *memory1, gsize size1,
+                         GString *dump2, const guchar *memory2, gsize size2,
+                         gsize begin, gsize end)
+{
+    gsize offset;
+
+    for (offset = begin; offset < end; offset += MEMORY_DUMP_ROW_SIZE) {
+        append_memory_dump_row(dump1, memory1, size1, offset);
+        append_memory_dump_row(dump2, memory2, size2, offset);
+    }
+}
+
+void
+cut_utils_inspect_memory_difference (const void  *memory1,
+                                     gsize        size1,
+                                     const void  *memory2,
+                                     gsize        size2,
+                                     const CutMemoryDifference *difference,
+                                     gboolean     full,
+                                     gchar      **inspected1,
+                                     gchar      **inspected2)
+{
+    GString *dump1, *dump2;
+    gsize max_size, offset, window_end;
+    guint n_windows;
+
+    dump1 = g_string_new(NULL);
+    dump2 = g_string_new(NULL);
+    max_size = MAX(size1, size2);
+
+    if (full) {
+        append_memory_dump_rows(dump1, memory1, size1, dump2, memory2, size2,
+                                0, max_size);
+    } else {
+        /* The difference found by
+         * cut_utils_find_memory_difference() bounds the
+         * search. Bytes before the first difference and
+         * after the last difference aren't scanned again. */
+        window_end = 0;
+        offset = difference ? difference->first : max_size;
+        for (n_windows = 0;
+             offset < max_size && n_windows < MEMORY_DIFFERENCE_MAX_WINDOWS;
+             n_windows++) {
+            gsize row, context_size, window_begin;
+
+            row = offset - offset % MEMORY_DUMP_ROW_SIZE;
+            context_size = MEMORY_DIFFERENCE_CONTEXT_ROWS * MEMORY_DUMP_ROW_SIZE;
+            window_begin = row > context_size ? row - context_size : 0;
+            window_begin = MAX(window_begin, window_end);
+            if (window_begin > window_end) {
+                g_string_append(dump1, "...\n");
+                g_string_append(dump2, "...\n");
+            }
+            window_end = MIN(row + MEMORY_DUMP_ROW_SIZE + context_size,
+                             max_size);
+            append_memory_dump_rows(dump1, memory1, size1,
+                                    dump2, memory2, size2,
+                                    window_begin, window_end);
+            if (window_end <= difference->last)
+                offset = find_next_memory_difference(memory1, size1,
+                                                     memory2, size2,
+                                                     window_end);
+            else
+                offset = max_size;
+        }
+        if (window_end < max_size) {
+            g_string_append(dump1, "...\n");
+            g_string_append(dump2, "...\n");
+        }
+    }
+
+    if (dump1->len > 0)
+        g_string_truncate(dump1, dump1->len - 1);
+    if (dump2->len > 0)
+        g_string_truncate(dump2, dump2->len - 1);
+    *inspected1 = g_string_free(dump1, FALSE);
+    *inspected2 = g_string_free(dump2, FALSE);
+}
+
 gboolean
 cut_utils_equal_string (const gchar *string1, const gchar *string2)
 {
@@ -944,6 +1201,43 @@ cut_utils_double_to_string (gdouble value)
     return string;
 }
 
+/*
+ * Returns the current time of a monotonic clock in
+ * nanoseconds. Only differences between two values are
+ * meaningful. It falls back to the wall-clock time when no
+ * monotonic clock is available.
+ */
+guint64
+cut_utils_get_monotonic_time (void)
+{
+#if defined(HAVE_CLOCK_GETTIME) && defined(CLOCK_MONOTONIC)
+    struct timespec time_spec;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &time_spec) == 0)
+        return (guint64)time_spec.tv_sec * G_GUINT64_CONSTANT(1000000000) +
+            time_spec.tv_nsec;
+#elif defined(G_OS_WIN32)
+    LARGE_INTEGER frequency, counter;
+
+    if (QueryPerformanceFrequency(&frequency) &&
+        QueryPerformanceCounter(&counter)) {
+        guint64 seconds, rest;
+
+        seconds = counter.QuadPart / frequency.QuadPart;
+        rest = counter.QuadPart % frequency.QuadPart;
+        return seconds * G_GUINT64_CONSTANT(1000000000) +
+            rest * G_GUINT64_CONSTANT(1000000000) / frequency.QuadPart;
+    }
+#endif
+    {
+        GTimeVal time_value;
+
+        g_get_current_time(&time_value);
+        return (guint64)time_value.tv_sec * G_GUINT64_CONSTANT(1000000000) +
+            (guint64)time_value.tv_usec * 1000;
+    }
+}
+
 gint
 cut_utils_compare_string (gconstpointer data1, gconstpointer data2)
 {
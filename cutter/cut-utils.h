@@ -1,6 +1,6 @@
 /* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
 /*
- *  Copyright (C) 2007-2011  Kouhei Sutou <kou@clear-code.com>
+ *  Copyright (C) 2007-2014  Kouhei Sutou <kou@clear-code.com>
  *
  *  This library is free software: you can redistribute it and/or modify
  *  it under the terms of the GNU Lesser General Public License as published by
@@ -39,6 +39,20 @@ typedef enum {
     g_error_free(error);                        \
 } while (0)
 
+/*
+ * cut_utils_inspect_memory() shows only the first
+ * CUT_UTILS_INSPECT_MEMORY_MAX_SIZE bytes.
+ */
+#define CUT_UTILS_INSPECT_MEMORY_MAX_SIZE 1024
+
+typedef struct _CutMemoryDifference CutMemoryDifference;
+struct _CutMemoryDifference
+{
+    gsize first;
+    gsize last;
+    gsize n_differences;
+};
+
 gchar   *cut_utils_create_regex_pattern (const gchar *string);
 GList   *cut_utils_filter_to_regexs     (const gchar **filters);
 gboolean cut_utils_filter_match         (GList *regexs,
@@ -80,6 +94,28 @@ GList       *cut_utils_parse_gdb_backtrace   (const gchar  *gdb_backtrace);
 
 gchar       *cut_utils_double_to_string      (gdouble       value);
 
+guint64      cut_utils_get_monotonic_time    (void);
+
+gboolean     cut_utils_equal_memory          (const void   *memory1,
+                                              gsize         size1,
+                                              const void   *memory2,
+                                              gsize         size2);
+gboolean     cut_utils_find_memory_difference
+                                             (const void   *memory1,
+                                              gsize         size1,
+                                              const void   *memory2,
+                                              gsize         size2,
+                                              CutMemoryDifference *difference);
+void         cut_utils_inspect_memory_difference
+                                             (const void   *memory1,
+                                              gsize         size1,
+                                              const void   *memory2,
+                                              gsize         size2,
+                                              const CutMemoryDifference *difference,
+                                              gboolean      full,
+                                              gchar       **inspected1,
+                                              gchar       **inspected2);
+
 gint         cut_utils_compare_string        (gconstpointer data1,
                                               gconstpointer data2);
 gint         cut_utils_compare_direct        (gconstpointer data1,
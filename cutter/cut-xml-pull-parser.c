@@ -0,0 +1,695 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <cutter/config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "cut-xml-pull-parser.h"
+
+#define CDATA_START "<![CDATA["
+#define CDATA_END "]]>"
+#define COMMENT_START "<!--"
+#define COMMENT_END "-->"
+#define PROCESSING_INSTRUCTION_END "?>"
+
+struct _CutXMLPullParser
+{
+    /* input that isn't consumed yet. buffer->str[0] is at
+     * base in the whole document. */
+    GString *buffer;
+    gsize base;
+    gsize position;
+    gsize event_position;
+
+    GString *text;
+    gboolean in_text;
+
+    /* open element names separated by '\0' */
+    GString *names;
+    GArray *name_offsets;
+    gboolean pop_pending;
+    gboolean end_pending;
+
+    gboolean started;
+    gboolean failed;
+
+    /* GMarkupParseContext compatible position */
+    gsize counted_position;
+    gint line;
+    gsize last_new_line_position;
+    gboolean new_line_found;
+};
+
+CutXMLPullParser *
+cut_xml_pull_parser_new (void)
+{
+    CutXMLPullParser *parser;
+
+    parser = g_new0(CutXMLPullParser, 1);
+    parser->buffer = g_string_new(NULL);
+    parser->text = g_string_new(NULL);
+    parser->names = g_string_new(NULL);
+    parser->name_offsets = g_array_new(FALSE, FALSE, sizeof(gsize));
+    parser->line = 1;
+
+    return parser;
+}
+
+void
+cut_xml_pull_parser_free (CutXMLPullParser *parser)
+{
+    if (!parser)
+        return;
+
+    g_string_free(parser->buffer, TRUE);
+    g_string_free(parser->text, TRUE);
+    g_string_free(parser->names, TRUE);
+    g_array_free(parser->name_offsets, TRUE);
+    g_free(parser);
+}
+
+static void
+count_position (CutXMLPullParser *parser, gsize target)
+{
+    const gchar *data, *current, *end;
+    gsize last;
+
+    if (parser->buffer->len == 0)
+        return;
+
+    last = parser->base + parser->buffer->len - 1;
+    if (target > last)
+        target = last;
+    if (target <= parser->counted_position)
+        return;
+
+    data = parser->buffer->str - parser->base;
+    current = data + parser->counted_position + 1;
+    end = data + target + 1;
+    while (current < end &&
+           (current = memchr(current, '\n', end - current))) {
+        parser->line++;
+        parser->last_new_line_position = current - data;
+        parser->new_line_found = TRUE;
+        current++;
+    }
+    parser->counted_position = target;
+}
+
+void
+cut_xml_pull_parser_get_position (CutXMLPullParser *parser,
+                                  gint *line, gint *char_number)
+{
+    gsize position;
+
+    position = parser->base + parser->event_position;
+    count_position(parser, position);
+
+    if (line)
+        *line = parser->line;
+    if (char_number) {
+        if (parser->new_line_found)
+            *char_number = position - parser->last_new_line_position + 1;
+        else
+            *char_number = position + 1;
+    }
+}
+
+static void
+set_error (CutXMLPullParser *parser, GError **error,
+           GMarkupError code, const gchar *format, ...)
+{
+    gint line, char_number;
+    gchar *message;
+    va_list args;
+
+    parser->failed = TRUE;
+    if (!error)
+        return;
+
+    cut_xml_pull_parser_get_position(parser, &line, &char_number);
+    va_start(args, format);
+    message = g_strdup_vprintf(format, args);
+    va_end(args);
+    g_set_error(error, G_MARKUP_ERROR, code,
+                "Error on line %d char %d: %s", line, char_number, message);
+    g_free(message);
+}
+
+void
+cut_xml_pull_parser_feed (CutXMLPullParser *parser,
+                          const gchar *data, gsize length)
+{
+    if (parser->position > 0) {
+        count_position(parser, parser->base + parser->position - 1);
+        g_string_erase(parser->buffer, 0, parser->position);
+        parser->base += parser->position;
+        parser->event_position -= MIN(parser->event_position,
+                                      parser->position);
+        parser->position = 0;
+    }
+    g_string_append_len(parser->buffer, data, length);
+}
+
+void
+cut_xml_pull_parser_abort (CutXMLPullParser *parser)
+{
+    parser->failed = TRUE;
+}
+
+static guint
+get_depth (CutXMLPullParser *parser)
+{
+    return parser->name_offsets->len;
+}
+
+const gchar *
+cut_xml_pull_parser_get_element_name (CutXMLPullParser *parser)
+{
+    guint depth;
+
+    depth = get_depth(parser);
+    if (depth == 0)
+        return NULL;
+    return parser->names->str +
+        g_array_index(parser->name_offsets, gsize, depth - 1);
+}
+
+const gchar *
+cut_xml_pull_parser_get_text (CutXMLPullParser *parser, gsize *length)
+{
+    if (length)
+        *length = parser->text->len;
+    return parser->text->str;
+}
+
+gchar *
+cut_xml_pull_parser_get_element_path (CutXMLPullParser *parser)
+{
+    GString *path;
+    guint i;
+
+    path = g_string_new(NULL);
+    for (i = 0; i < get_depth(parser); i++) {
+        g_string_append_c(path, '/');
+        g_string_append(path,
+                        parser->names->str +
+                        g_array_index(parser->name_offsets, gsize, i));
+    }
+
+    return g_string_free(path, FALSE);
+}
+
+static void
+push_name (CutXMLPullParser *parser, const gchar *name, gsize length)
+{
+    gsize offset;
+
+    offset = parser->names->len;
+    g_string_append_len(parser->names, name, length);
+    g_string_append_c(parser->names, '\0');
+    g_array_append_val(parser->name_offsets, offset);
+}
+
+static void
+pop_name (CutXMLPullParser *parser)
+{
+    guint depth;
+
+    depth = get_depth(parser);
+    if (depth == 0)
+        return;
+
+    g_string_truncate(parser->names,
+                      g_array_index(parser->name_offsets, gsize, depth - 1));
+    g_array_set_size(parser->name_offsets, depth - 1);
+}
+
+static gboolean
+is_space (gchar c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static gboolean
+is_blank (const gchar *data, gsize length)
+{
+    gsize i;
+
+    for (i = 0; i < length; i++) {
+        if (!is_space(data[i]))
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static const gchar *
+find (const gchar *data, gsize length, const gchar *pattern)
+{
+    gsize pattern_length;
+    const gchar *current, *end;
+
+    pattern_length = strlen(pattern);
+    if (length < pattern_length)
+        return NULL;
+
+    current = data;
+    end = data + length - pattern_length + 1;
+    while (current < end &&
+           (current = memchr(current, pattern[0], end - current))) {
+        if (memcmp(current, pattern, pattern_length) == 0)
+            return current;
+        current++;
+    }
+    return NULL;
+}
+
+static gboolean
+has_prefix (const gchar *data, gsize length, const gchar *prefix,
+            gboolean *need_more)
+{
+    gsize prefix_length;
+
+    prefix_length = strlen(prefix);
+    if (length < prefix_length) {
+        if (memcmp(data, prefix, length) == 0)
+            *need_more = TRUE;
+        return FALSE;
+    }
+    return memcmp(data, prefix, prefix_length) == 0;
+}
+
+static gboolean
+append_character (CutXMLPullParser *parser, const gchar *entity,
+                  gsize length, GError **error)
+{
+    gulong code;
+    gchar *end;
+    gchar utf8[6];
+    gint base = 10;
+    const gchar *digits;
+
+    digits = entity + 1;
+    if (length > 1 && entity[1] == 'x') {
+        base = 16;
+        digits++;
+    }
+    code = strtoul(digits, &end, base);
+    if (digits == end || end != entity + length ||
+        code == 0 || code > 0x10FFFF ||
+        (code >= 0xD800 && code <= 0xDFFF)) {
+        set_error(parser, error, G_MARKUP_ERROR_PARSE,
+                  "Character reference '%.*s' does not encode "
+                  "a permitted character", (gint)length, entity);
+        return FALSE;
+    }
+
+    g_string_append_len(parser->text, utf8, g_unichar_to_utf8(code, utf8));
+    return TRUE;
+}
+
+static gboolean
+append_entity (CutXMLPullParser *parser, const gchar *entity, gsize length,
+               GError **error)
+{
+#define ENTITY_IS(name)                                 \
+    (length == strlen(name) && memcmp(entity, name, length) == 0)
+
+    if (ENTITY_IS("lt")) {
+        g_string_append_c(parser->text, '<');
+    } else if (ENTITY_IS("gt")) {
+        g_string_append_c(parser->text, '>');
+    } else if (ENTITY_IS("amp")) {
+        g_string_append_c(parser->text, '&');
+    } else if (ENTITY_IS("quot")) {
+        g_string_append_c(parser->text, '"');
+    } else if (ENTITY_IS("apos")) {
+        g_string_append_c(parser->text, '\'');
+    } else if (length > 1 && entity[0] == '#') {
+        gchar digits[16];
+
+        if (length >= sizeof(digits)) {
+            set_error(parser, error, G_MARKUP_ERROR_PARSE,
+                      "Character reference '%.*s' is too long",
+                      (gint)length, entity);
+            return FALSE;
+        }
+        memcpy(digits, entity, length);
+        digits[length] = '\0';
+        return append_character(parser, digits, length, error);
+    } else {
+        set_error(parser, error, G_MARKUP_ERROR_PARSE,
+                  "Entity name '%.*s' is not known", (gint)length, entity);
+        return FALSE;
+    }
+
+#undef ENTITY_IS
+
+    return TRUE;
+}
+
+/* Appends decoded text in [start, end) and returns the
+ * position where decoding stopped. It stops before an
+ * incomplete entity at the end of the buffer when
+ * allow_partial is TRUE. */
+static const gchar *
+append_text (CutXMLPullParser *parser, const gchar *start, const gchar *end,
+             gboolean allow_partial, GError **error)
+{
+    const gchar *current = start;
+
+    while (current < end) {
+        const gchar *ampersand, *semicolon;
+
+        ampersand = memchr(current, '&', end - current);
+        if (!ampersand) {
+            g_string_append_len(parser->text, current, end - current);
+            return end;
+        }
+        g_string_append_len(parser->text, current, ampersand - current);
+
+        semicolon = memchr(ampersand, ';', end - ampersand);
+        if (!semicolon) {
+            if (allow_partial)
+                return ampersand;
+            set_error(parser, error, G_MARKUP_ERROR_PARSE,
+                      "Entity did not end with a semicolon");
+            return NULL;
+        }
+        if (!append_entity(parser, ampersand + 1, semicolon - ampersand - 1,
+                           error))
+            return NULL;
+        current = semicolon + 1;
+    }
+
+    return current;
+}
+
+static const gchar *
+find_tag_end (const gchar *data, gsize length)
+{
+    gsize i;
+    gchar quote = '\0';
+
+    for (i = 0; i < length; i++) {
+        gchar c = data[i];
+
+        if (quote) {
+            if (c == quote)
+                quote = '\0';
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '>') {
+            return data + i;
+        }
+    }
+    return NULL;
+}
+
+static gsize
+name_length (const gchar *data, const gchar *end)
+{
+    const gchar *current;
+
+    for (current = data; current < end; current++) {
+        if (is_space(*current) || *current == '/' || *current == '>')
+            break;
+    }
+    return current - data;
+}
+
+static CutXMLPullParserEvent
+flush_text (CutXMLPullParser *parser, GError **error)
+{
+    parser->in_text = FALSE;
+    parser->event_position = parser->position;
+
+    if (get_depth(parser) == 0) {
+        if (is_blank(parser->text->str, parser->text->len))
+            return CUT_XML_PULL_PARSER_NEED_MORE;
+        set_error(parser, error, G_MARKUP_ERROR_PARSE,
+                  "Document must begin with an element (e.g. <book>)");
+        return CUT_XML_PULL_PARSER_ERROR;
+    }
+
+    if (!g_utf8_validate(parser->text->str, parser->text->len, NULL)) {
+        set_error(parser, error, G_MARKUP_ERROR_BAD_UTF8,
+                  "Invalid UTF-8 encoded text");
+        return CUT_XML_PULL_PARSER_ERROR;
+    }
+
+    return CUT_XML_PULL_PARSER_TEXT;
+}
+
+static CutXMLPullParserEvent
+parse_end_element (CutXMLPullParser *parser, const gchar *start,
+                   const gchar *tag_end, GError **error)
+{
+    const gchar *name, *current_name;
+    gsize length;
+
+    name = start + 2;
+    length = name_length(name, tag_end);
+    parser->position = tag_end + 1 - parser->buffer->str;
+    parser->event_position = parser->position;
+
+    current_name = cut_xml_pull_parser_get_element_name(parser);
+    if (!current_name) {
+        set_error(parser, error, G_MARKUP_ERROR_PARSE,
+                  "Element '%.*s' was closed, "
+                  "no element is currently open",
+                  (gint)length, name);
+        return CUT_XML_PULL_PARSER_ERROR;
+    }
+    if (strlen(current_name) != length ||
+        memcmp(current_name, name, length) != 0) {
+        set_error(parser, error, G_MARKUP_ERROR_PARSE,
+                  "Element '%.*s' was closed, "
+                  "but the currently open element is '%s'",
+                  (gint)length, name, current_name);
+        return CUT_XML_PULL_PARSER_ERROR;
+    }
+
+    parser->pop_pending = TRUE;
+    return CUT_XML_PULL_PARSER_END_ELEMENT;
+}
+
+static CutXMLPullParserEvent
+parse_start_element (CutXMLPullParser *parser, const gchar *start,
+                     const gchar *tag_end, GError **error)
+{
+    const gchar *name;
+    gsize length;
+
+    name = start + 1;
+    length = name_length(name, tag_end);
+    parser->position = tag_end + 1 - parser->buffer->str;
+    parser->event_position = parser->position;
+
+    if (length == 0) {
+        set_error(parser, error, G_MARKUP_ERROR_PARSE,
+                  "'%c' is not a valid character following a '<' "
+                  "character; it may not begin an element name",
+                  name[0]);
+        return CUT_XML_PULL_PARSER_ERROR;
+    }
+
+    push_name(parser, name, length);
+    parser->started = TRUE;
+    if (tag_end[-1] == '/')
+        parser->end_pending = TRUE;
+
+    return CUT_XML_PULL_PARSER_START_ELEMENT;
+}
+
+CutXMLPullParserEvent
+cut_xml_pull_parser_next (CutXMLPullParser *parser, GError **error)
+{
+    if (parser->failed) {
+        g_set_error(error, G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE,
+                    "An error occurred previously");
+        return CUT_XML_PULL_PARSER_ERROR;
+    }
+
+    if (parser->pop_pending) {
+        pop_name(parser);
+        parser->pop_pending = FALSE;
+    }
+    if (parser->end_pending) {
+        parser->end_pending = FALSE;
+        parser->pop_pending = TRUE;
+        return CUT_XML_PULL_PARSER_END_ELEMENT;
+    }
+
+    while (TRUE) {
+        const gchar *data, *start, *end, *tag_end;
+        gsize rest;
+        gboolean need_more = FALSE;
+
+        data = parser->buffer->str;
+        start = data + parser->position;
+        end = data + parser->buffer->len;
+        rest = end - start;
+        if (rest == 0)
+            return CUT_XML_PULL_PARSER_NEED_MORE;
+
+        if (start[0] != '<') {
+            const gchar *text_end, *decoded_end;
+
+            if (!parser->in_text) {
+                g_string_truncate(parser->text, 0);
+                parser->in_text = TRUE;
+            }
+            text_end = memchr(start, '<', rest);
+            decoded_end = append_text(parser, start,
+                                      text_end ? text_end : end,
+                                      text_end == NULL, error);
+            if (!decoded_end) {
+                parser->event_position = parser->position;
+                return CUT_XML_PULL_PARSER_ERROR;
+            }
+            parser->position = decoded_end - data;
+            if (!text_end)
+                return CUT_XML_PULL_PARSER_NEED_MORE;
+            continue;
+        }
+
+        if (rest < 2)
+            return CUT_XML_PULL_PARSER_NEED_MORE;
+
+        if (start[1] == '!') {
+            const gchar *section_end;
+
+            if (has_prefix(start, rest, CDATA_START, &need_more)) {
+                const gchar *content = start + strlen(CDATA_START);
+
+                section_end = find(content, end - content, CDATA_END);
+                if (!section_end)
+                    return CUT_XML_PULL_PARSER_NEED_MORE;
+                if (!parser->in_text) {
+                    g_string_truncate(parser->text, 0);
+                    parser->in_text = TRUE;
+                }
+                g_string_append_len(parser->text, content,
+                                    section_end - content);
+                parser->position =
+                    section_end + strlen(CDATA_END) - data;
+                continue;
+            }
+            if (has_prefix(start, rest, COMMENT_START, &need_more)) {
+                section_end = find(start + strlen(COMMENT_START),
+                                   rest - strlen(COMMENT_START),
+                                   COMMENT_END);
+                if (!section_end)
+                    return CUT_XML_PULL_PARSER_NEED_MORE;
+                parser->position = section_end + strlen(COMMENT_END) - data;
+                continue;
+            }
+            if (need_more)
+                return CUT_XML_PULL_PARSER_NEED_MORE;
+            section_end = memchr(start, '>', rest);
+            if (!section_end)
+                return CUT_XML_PULL_PARSER_NEED_MORE;
+            parser->position = section_end + 1 - data;
+            continue;
+        }
+
+        if (start[1] == '?') {
+            const gchar *section_end;
+
+            section_end = find(start + 2, rest - 2,
+                               PROCESSING_INSTRUCTION_END);
+            if (!section_end)
+                return CUT_XML_PULL_PARSER_NEED_MORE;
+            parser->position =
+                section_end + strlen(PROCESSING_INSTRUCTION_END) - data;
+            continue;
+        }
+
+        if (parser->in_text) {
+            CutXMLPullParserEvent event;
+
+            event = flush_text(parser, error);
+            if (event != CUT_XML_PULL_PARSER_NEED_MORE)
+                return event;
+        }
+
+        tag_end = find_tag_end(start, rest);
+        if (!tag_end)
+            return CUT_XML_PULL_PARSER_NEED_MORE;
+
+        if (start[1] == '/')
+            return parse_end_element(parser, start, tag_end, error);
+        else
+            return parse_start_element(parser, start, tag_end, error);
+    }
+}
+
+gboolean
+cut_xml_pull_parser_end (CutXMLPullParser *parser, GError **error)
+{
+    if (parser->failed) {
+        g_set_error(error, G_MARKUP_ERROR, G_MARKUP_ERROR_PARSE,
+                    "An error occurred previously");
+        return FALSE;
+    }
+
+    if (parser->pop_pending) {
+        pop_name(parser);
+        parser->pop_pending = FALSE;
+    }
+    parser->event_position = parser->buffer->len;
+
+    if (!parser->started &&
+        !(parser->in_text &&
+          !is_blank(parser->text->str, parser->text->len)) &&
+        is_blank(parser->buffer->str + parser->position,
+                 parser->buffer->len - parser->position)) {
+        set_error(parser, error, G_MARKUP_ERROR_EMPTY,
+                  "Document was empty or contained only whitespace");
+        return FALSE;
+    }
+
+    if (get_depth(parser) > 0 || parser->end_pending) {
+        set_error(parser, error, G_MARKUP_ERROR_PARSE,
+                  "Document ended unexpectedly with elements still open - "
+                  "'%s' was the last element opened",
+                  cut_xml_pull_parser_get_element_name(parser));
+        return FALSE;
+    }
+
+    if ((parser->in_text &&
+         !is_blank(parser->text->str, parser->text->len)) ||
+        !is_blank(parser->buffer->str + parser->position,
+                  parser->buffer->len - parser->position)) {
+        set_error(parser, error, G_MARKUP_ERROR_PARSE,
+                  "Document ended unexpectedly");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
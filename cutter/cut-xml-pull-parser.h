@@ -0,0 +1,84 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CUT_XML_PULL_PARSER_H__
+#define __CUT_XML_PULL_PARSER_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * CutXMLPullParser is a small XML tokenizer for the cutter
+ * stream. It accepts input in arbitrary chunks and returns
+ * start element, end element and text events one by one.
+ * It reuses its buffers, so it doesn't allocate memory per
+ * element once it is warmed up.
+ *
+ * It supports only what the cutter stream uses: elements,
+ * text with the predefined and character entities and
+ * CDATA sections. Attributes, comments, processing
+ * instructions and DOCTYPE are skipped. Adjacent text and
+ * CDATA sections are reported as one text event.
+ *
+ * Errors use GMarkupError and the position is computed in
+ * the same way as GMarkupParseContext.
+ */
+
+typedef enum {
+    CUT_XML_PULL_PARSER_NEED_MORE,
+    CUT_XML_PULL_PARSER_START_ELEMENT,
+    CUT_XML_PULL_PARSER_END_ELEMENT,
+    CUT_XML_PULL_PARSER_TEXT,
+    CUT_XML_PULL_PARSER_ERROR
+} CutXMLPullParserEvent;
+
+typedef struct _CutXMLPullParser CutXMLPullParser;
+
+CutXMLPullParser     *cut_xml_pull_parser_new   (void);
+void                  cut_xml_pull_parser_free  (CutXMLPullParser *parser);
+
+void                  cut_xml_pull_parser_feed  (CutXMLPullParser *parser,
+                                                 const gchar      *data,
+                                                 gsize             length);
+CutXMLPullParserEvent cut_xml_pull_parser_next  (CutXMLPullParser *parser,
+                                                 GError          **error);
+gboolean              cut_xml_pull_parser_end   (CutXMLPullParser *parser,
+                                                 GError          **error);
+void                  cut_xml_pull_parser_abort (CutXMLPullParser *parser);
+
+const gchar          *cut_xml_pull_parser_get_element_name
+                                                (CutXMLPullParser *parser);
+const gchar          *cut_xml_pull_parser_get_text
+                                                (CutXMLPullParser *parser,
+                                                 gsize            *length);
+void                  cut_xml_pull_parser_get_position
+                                                (CutXMLPullParser *parser,
+                                                 gint             *line,
+                                                 gint             *char_number);
+gchar                *cut_xml_pull_parser_get_element_path
+                                                (CutXMLPullParser *parser);
+
+G_END_DECLS
+
+#endif /* __CUT_XML_PULL_PARSER_H__ */
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
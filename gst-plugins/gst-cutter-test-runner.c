@@ -226,6 +226,7 @@ start (GstBaseSrc *base_src)
         cut_stream_new("xml",
                        "stream-function", stream_to_string,
                        "stream-function-user-data", priv->xml_string,
+                       "buffer-size", 0,
                        NULL);
     cut_run_context_add_listener(priv->run_context,
                                  CUT_LISTENER(priv->cut_stream));
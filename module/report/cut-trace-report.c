@@ -0,0 +1,889 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gi18n-lib.h>
+#include <glib/gstdio.h>
+#include <gmodule.h>
+
+#ifdef G_OS_WIN32
+#  include <process.h>
+#else
+#  include <unistd.h>
+#endif
+
+#include <cutter/cut-module-impl.h>
+#include <cutter/cut-report.h>
+#include <cutter/cut-listener.h>
+#include <cutter/cut-run-context.h>
+#include <cutter/cut-stream-parser.h>
+#include <cutter/cut-test-case.h>
+#include <cutter/cut-test-context.h>
+#include <cutter/cut-test-iterator.h>
+#include <cutter/cut-iterated-test.h>
+#include <cutter/cut-utils.h>
+#include <cutter/cut-glib-compatible.h>
+
+#define CUT_TYPE_TRACE_REPORT            cut_type_trace_report
+#define CUT_TRACE_REPORT(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), CUT_TYPE_TRACE_REPORT, CutTraceReport))
+#define CUT_TRACE_REPORT_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), CUT_TYPE_TRACE_REPORT, CutTraceReportClass))
+#define CUT_IS_TRACE_REPORT(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), CUT_TYPE_TRACE_REPORT))
+#define CUT_IS_TRACE_REPORT_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), CUT_TYPE_TRACE_REPORT))
+#define CUT_TRACE_REPORT_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), CUT_TYPE_TRACE_REPORT, CutTraceReportClass))
+
+/* Events are buffered up to this size and then written. */
+#define FLUSH_THRESHOLD (64 * 1024)
+/* Assertions per second are sampled at this interval in nanoseconds. */
+#define COUNTER_INTERVAL (100 * 1000 * 1000)
+
+#define CATEGORY_TEST_SUITE   "test-suite"
+#define CATEGORY_TEST_CASE    "test-case"
+#define CATEGORY_TEST_ITERATOR "test-iterator"
+#define CATEGORY_TEST         "test"
+#define CATEGORY_ITERATED_TEST "iterated-test"
+#define CATEGORY_PHASE        "phase"
+
+typedef struct _CutTraceReport CutTraceReport;
+typedef struct _CutTraceReportClass CutTraceReportClass;
+
+/*
+ * CutTraceReport writes events in the Trace Event Format's
+ * JSON array format. Each span is written as a complete
+ * ("X") event when it is completed. Only running spans are
+ * kept in memory. The closing "]" is optional in the format
+ * so that a file of an aborted run can also be loaded.
+ */
+struct _CutTraceReport
+{
+    CutReport object;
+    CutRunContext *run_context;
+    GMutex *mutex;
+    FILE *output;
+    gint owner_process_id;
+    GString *buffer;
+    gboolean have_event;
+    guint64 base_time;
+    GHashTable *spans;
+    GHashTable *process_ids;
+    guint n_assertions;
+    guint64 counter_start_time;
+};
+
+struct _CutTraceReportClass
+{
+    CutReportClass parent_class;
+};
+
+typedef struct _Span Span;
+struct _Span
+{
+    guint64 start_time;
+    gint thread_id;
+};
+
+enum
+{
+    PROP_0,
+    PROP_RUN_CONTEXT
+};
+
+static GType cut_type_trace_report = 0;
+static CutReportClass *parent_class;
+
+static GPrivate thread_id_private = G_PRIVATE_INIT(NULL);
+static volatile gint n_threads = 0;
+
+static void dispose        (GObject         *object);
+static void set_property   (GObject         *object,
+                            guint            prop_id,
+                            const GValue    *value,
+                            GParamSpec      *pspec);
+static void get_property   (GObject         *object,
+                            guint            prop_id,
+                            GValue          *value,
+                            GParamSpec      *pspec);
+
+static void attach_to_run_context   (CutListener   *listener,
+                                     CutRunContext *run_context);
+static void detach_from_run_context (CutListener   *listener,
+                                     CutRunContext *run_context);
+
+static void
+class_init (CutTraceReportClass *klass)
+{
+    GObjectClass *gobject_class;
+    GParamSpec *spec;
+
+    parent_class = g_type_class_peek_parent(klass);
+
+    gobject_class = G_OBJECT_CLASS(klass);
+
+    gobject_class->dispose      = dispose;
+    gobject_class->set_property = set_property;
+    gobject_class->get_property = get_property;
+
+    spec = g_param_spec_object("cut-run-context",
+                               "CutRunContext object",
+                               "A CutRunContext object",
+                               CUT_TYPE_RUN_CONTEXT,
+                               G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_RUN_CONTEXT, spec);
+}
+
+static void
+span_free (Span *span)
+{
+    g_slice_free(Span, span);
+}
+
+static void
+init (CutTraceReport *report)
+{
+    report->run_context = NULL;
+    report->mutex = g_mutex_new();
+    report->output = NULL;
+    report->owner_process_id = 0;
+    report->buffer = g_string_sized_new(FLUSH_THRESHOLD);
+    report->have_event = FALSE;
+    report->base_time = 0;
+    report->spans = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                          g_free, (GDestroyNotify)span_free);
+    report->process_ids = g_hash_table_new(g_direct_hash, g_direct_equal);
+    report->n_assertions = 0;
+    report->counter_start_time = 0;
+}
+
+static void
+listener_init (CutListenerClass *listener)
+{
+    listener->attach_to_run_context   = attach_to_run_context;
+    listener->detach_from_run_context = detach_from_run_context;
+}
+
+static void
+register_type (GTypeModule *type_module)
+{
+    static const GTypeInfo info =
+        {
+            sizeof (CutTraceReportClass),
+            (GBaseInitFunc) NULL,
+            (GBaseFinalizeFunc) NULL,
+            (GClassInitFunc) class_init,
+            NULL,           /* class_finalize */
+            NULL,           /* class_data */
+            sizeof(CutTraceReport),
+            0,
+            (GInstanceInitFunc) init,
+        };
+
+    static const GInterfaceInfo listener_info =
+        {
+            (GInterfaceInitFunc) listener_init,
+            NULL,
+            NULL
+        };
+
+    cut_type_trace_report =
+        g_type_module_register_type(type_module,
+                                    CUT_TYPE_REPORT,
+                                    "CutTraceReport",
+                                    &info, 0);
+
+    g_type_module_add_interface(type_module,
+                                cut_type_trace_report,
+                                CUT_TYPE_LISTENER,
+                                &listener_info);
+}
+
+G_MODULE_EXPORT GList *
+CUT_MODULE_IMPL_INIT (GTypeModule *type_module)
+{
+    GList *registered_types = NULL;
+
+    register_type(type_module);
+    if (cut_type_trace_report)
+        registered_types =
+            g_list_prepend(registered_types,
+                           (gchar *)g_type_name(cut_type_trace_report));
+
+    return registered_types;
+}
+
+G_MODULE_EXPORT void
+CUT_MODULE_IMPL_EXIT (void)
+{
+}
+
+G_MODULE_EXPORT GObject *
+CUT_MODULE_IMPL_INSTANTIATE (const gchar *first_property, va_list var_args)
+{
+    return g_object_new_valist(CUT_TYPE_TRACE_REPORT, first_property, var_args);
+}
+
+static gint
+get_process_id (void)
+{
+    gint process_id;
+
+    process_id = cut_stream_parser_get_current_process_id();
+    if (process_id > 0)
+        return process_id;
+    return (gint)getpid();
+}
+
+static gint
+get_thread_id (void)
+{
+    gint id;
+
+    id = GPOINTER_TO_INT(g_private_get(&thread_id_private));
+    if (id == 0) {
+        id = g_atomic_int_add(&n_threads, 1) + 1;
+        g_private_set(&thread_id_private, GINT_TO_POINTER(id));
+    }
+
+    return id;
+}
+
+static void
+flush_buffer (CutTraceReport *report)
+{
+    if (!report->output || report->buffer->len == 0)
+        return;
+
+    if (fwrite(report->buffer->str, report->buffer->len, 1,
+               report->output) != 1)
+        g_warning("can't write trace report to file [%s]",
+                  cut_report_get_filename(CUT_REPORT(report)));
+    g_string_truncate(report->buffer, 0);
+}
+
+static void
+close_output (CutTraceReport *report, gboolean complete)
+{
+    if (!report->output)
+        return;
+
+    /* A forked child must not write events of its parent. */
+    if (report->owner_process_id == (gint)getpid()) {
+        if (complete)
+            g_string_append(report->buffer, "\n]\n");
+        flush_buffer(report);
+    }
+    g_string_truncate(report->buffer, 0);
+    fclose(report->output);
+    report->output = NULL;
+}
+
+static void
+dispose (GObject *object)
+{
+    CutTraceReport *report = CUT_TRACE_REPORT(object);
+
+    if (report->run_context) {
+        g_object_unref(report->run_context);
+        report->run_context = NULL;
+    }
+
+    if (report->buffer) {
+        close_output(report, FALSE);
+        g_string_free(report->buffer, TRUE);
+        report->buffer = NULL;
+    }
+
+    if (report->spans) {
+        g_hash_table_destroy(report->spans);
+        report->spans = NULL;
+    }
+
+    if (report->process_ids) {
+        g_hash_table_destroy(report->process_ids);
+        report->process_ids = NULL;
+    }
+
+    if (report->mutex) {
+        g_mutex_free(report->mutex);
+        report->mutex = NULL;
+    }
+
+    G_OBJECT_CLASS(parent_class)->dispose(object);
+}
+
+static void
+set_property (GObject      *object,
+              guint         prop_id,
+              const GValue *value,
+              GParamSpec   *pspec)
+{
+    CutTraceReport *report = CUT_TRACE_REPORT(object);
+
+    switch (prop_id) {
+      case PROP_RUN_CONTEXT:
+        attach_to_run_context(CUT_LISTENER(report),
+                              CUT_RUN_CONTEXT(g_value_get_object(value)));
+        break;
+      default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+get_property (GObject    *object,
+              guint       prop_id,
+              GValue     *value,
+              GParamSpec *pspec)
+{
+    CutTraceReport *report = CUT_TRACE_REPORT(object);
+
+    switch (prop_id) {
+      case PROP_RUN_CONTEXT:
+        g_value_set_object(value, G_OBJECT(report->run_context));
+        break;
+      default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+append_json_string (GString *buffer, const gchar *string)
+{
+    const gchar *character;
+
+    g_string_append_c(buffer, '"');
+    for (character = string ? string : ""; *character; character++) {
+        switch (*character) {
+          case '"':
+            g_string_append(buffer, "\\\"");
+            break;
+          case '\\':
+            g_string_append(buffer, "\\\\");
+            break;
+          case '\n':
+            g_string_append(buffer, "\\n");
+            break;
+          case '\r':
+            g_string_append(buffer, "\\r");
+            break;
+          case '\t':
+            g_string_append(buffer, "\\t");
+            break;
+          default:
+            if ((guchar)*character < 0x20)
+                g_string_append_printf(buffer, "\\u%04x", *character);
+            else
+                g_string_append_c(buffer, *character);
+            break;
+        }
+    }
+    g_string_append_c(buffer, '"');
+}
+
+/* Timestamps are in microseconds with nanosecond precision. */
+static void
+append_json_time (GString *buffer, guint64 nanoseconds)
+{
+    g_string_append_printf(buffer, "%" G_GUINT64_FORMAT ".%03u",
+                           nanoseconds / 1000,
+                           (guint)(nanoseconds % 1000));
+}
+
+static guint64
+relative_time (CutTraceReport *report, guint64 time)
+{
+    return time > report->base_time ? time - report->base_time : 0;
+}
+
+static void
+start_event (CutTraceReport *report, const gchar *phase, const gchar *name,
+             gint process_id, gint thread_id)
+{
+    GString *buffer = report->buffer;
+
+    if (report->have_event)
+        g_string_append(buffer, ",\n");
+    report->have_event = TRUE;
+
+    g_string_append(buffer, "{\"name\":");
+    append_json_string(buffer, name);
+    g_string_append_printf(buffer, ",\"ph\":\"%s\",\"pid\":%d,\"tid\":%d",
+                           phase, process_id, thread_id);
+}
+
+static void
+end_event (CutTraceReport *report)
+{
+    g_string_append_c(report->buffer, '}');
+    if (report->buffer->len >= FLUSH_THRESHOLD)
+        flush_buffer(report);
+}
+
+static void
+append_process_name (CutTraceReport *report, gint process_id)
+{
+    const gchar *name;
+
+    if (g_hash_table_lookup(report->process_ids, GINT_TO_POINTER(process_id)))
+        return;
+    g_hash_table_insert(report->process_ids,
+                        GINT_TO_POINTER(process_id), GINT_TO_POINTER(TRUE));
+
+    if (process_id == report->owner_process_id)
+        name = "cutter";
+    else
+        name = "cutter (child)";
+    start_event(report, "M", "process_name", process_id, 0);
+    g_string_append(report->buffer, ",\"args\":{\"name\":");
+    append_json_string(report->buffer, name);
+    g_string_append(report->buffer, "}");
+    end_event(report);
+}
+
+static void
+append_complete_event (CutTraceReport *report, const gchar *category,
+                       const gchar *name, gint process_id, gint thread_id,
+                       guint64 start_time, guint64 end_time,
+                       const gchar *result)
+{
+    GString *buffer = report->buffer;
+
+    append_process_name(report, process_id);
+    start_event(report, "X", name, process_id, thread_id);
+    g_string_append(buffer, ",\"cat\":");
+    append_json_string(buffer, category);
+    g_string_append(buffer, ",\"ts\":");
+    append_json_time(buffer, relative_time(report, start_time));
+    g_string_append(buffer, ",\"dur\":");
+    append_json_time(buffer,
+                     end_time > start_time ? end_time - start_time : 0);
+    if (result) {
+        g_string_append(buffer, ",\"args\":{\"result\":");
+        append_json_string(buffer, result);
+        g_string_append(buffer, "}");
+    }
+    end_event(report);
+}
+
+static void
+append_counter_event (CutTraceReport *report, guint64 time, gdouble value)
+{
+    gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+    start_event(report, "C", "assertions", report->owner_process_id, 0);
+    g_string_append(report->buffer, ",\"ts\":");
+    append_json_time(report->buffer, relative_time(report, time));
+    g_string_append(report->buffer, ",\"args\":{\"per second\":");
+    g_string_append(report->buffer,
+                    g_ascii_formatd(buffer, sizeof(buffer), "%.1f", value));
+    g_string_append(report->buffer, "}");
+    end_event(report);
+}
+
+static void
+update_counter (CutTraceReport *report, guint64 now, gboolean force)
+{
+    guint64 elapsed;
+
+    elapsed = now - report->counter_start_time;
+    if (elapsed == 0 || (!force && elapsed < COUNTER_INTERVAL))
+        return;
+
+    append_counter_event(report, now,
+                         report->n_assertions * 1000000000.0 / elapsed);
+    report->n_assertions = 0;
+    report->counter_start_time = now;
+}
+
+/*
+ * A span is started and completed in the same thread. Tests
+ * of a child process are identified by their names because
+ * they are re-created from its stream.
+ */
+static gchar *
+span_key (gint process_id, gint thread_id, const gchar *category,
+          const gchar *parent_name, const gchar *name)
+{
+    return g_strdup_printf("%d\n%d\n%s\n%s\n%s",
+                           process_id, thread_id, category,
+                           parent_name ? parent_name : "",
+                           name ? name : "");
+}
+
+static void
+start_span (CutTraceReport *report, const gchar *category,
+            const gchar *parent_name, const gchar *name)
+{
+    Span *span;
+    guint64 now;
+
+    now = cut_utils_get_monotonic_time();
+
+    g_mutex_lock(report->mutex);
+    if (report->output) {
+        span = g_slice_new(Span);
+        span->start_time = now;
+        span->thread_id = get_thread_id();
+        g_hash_table_replace(report->spans,
+                             span_key(get_process_id(), span->thread_id,
+                                      category, parent_name, name),
+                             span);
+    }
+    g_mutex_unlock(report->mutex);
+}
+
+static void
+append_phase_events (CutTraceReport *report, CutTest *test,
+                     gint process_id, const Span *span, guint64 end_time)
+{
+    static const CutTestPhase leading_phases[] = {
+        CUT_TEST_PHASE_STARTUP,
+        CUT_TEST_PHASE_DATA_SETUP,
+        CUT_TEST_PHASE_SETUP
+    };
+    static const CutTestPhase trailing_phases[] = {
+        CUT_TEST_PHASE_TEARDOWN,
+        CUT_TEST_PHASE_SHUTDOWN
+    };
+    const CutPhaseElapsed *phase_elapsed;
+    guint64 time;
+    guint i;
+
+    if (!test)
+        return;
+    phase_elapsed = cut_test_get_phase_elapsed(test);
+    if (!phase_elapsed)
+        return;
+
+    /* Only durations are measured. Phases before the body are
+     * placed from the start of the span and phases after the
+     * body are placed to the end of the span. */
+    time = span->start_time;
+    for (i = 0; i < G_N_ELEMENTS(leading_phases); i++) {
+        CutTestPhase phase = leading_phases[i];
+        gint64 elapsed = phase_elapsed->elapsed[phase];
+
+        if (elapsed < 0)
+            continue;
+        append_complete_event(report, CATEGORY_PHASE,
+                              cut_test_phase_to_string(phase),
+                              process_id, span->thread_id,
+                              time, time + elapsed, NULL);
+        time += elapsed;
+    }
+
+    time = end_time;
+    for (i = 0; i < G_N_ELEMENTS(trailing_phases); i++) {
+        CutTestPhase phase = trailing_phases[i];
+        gint64 elapsed = phase_elapsed->elapsed[phase];
+
+        if (elapsed < 0 || (guint64)elapsed > time)
+            continue;
+        append_complete_event(report, CATEGORY_PHASE,
+                              cut_test_phase_to_string(phase),
+                              process_id, span->thread_id,
+                              time - elapsed, time, NULL);
+        time -= elapsed;
+    }
+}
+
+static void
+complete_span (CutTraceReport *report, const gchar *category,
+               const gchar *parent_name, const gchar *name,
+               CutTest *test, gboolean success)
+{
+    Span *span;
+    gchar *key;
+    gint process_id;
+    guint64 now;
+
+    now = cut_utils_get_monotonic_time();
+
+    g_mutex_lock(report->mutex);
+    process_id = get_process_id();
+    key = span_key(process_id, get_thread_id(), category, parent_name, name);
+    span = g_hash_table_lookup(report->spans, key);
+    if (span && report->output) {
+        append_complete_event(report, category, name,
+                              process_id, span->thread_id,
+                              span->start_time, now,
+                              success ? "success" : "failure");
+        append_phase_events(report, test, process_id, span, now);
+        update_counter(report, now, FALSE);
+    }
+    if (span)
+        g_hash_table_remove(report->spans, key);
+    g_mutex_unlock(report->mutex);
+    g_free(key);
+}
+
+static const gchar *
+test_case_name (CutTestContext *test_context)
+{
+    CutTestCase *test_case;
+
+    if (!test_context)
+        return NULL;
+    test_case = cut_test_context_get_test_case(test_context);
+    if (!test_case)
+        return NULL;
+    return cut_test_get_name(CUT_TEST(test_case));
+}
+
+static void
+cb_ready_test_suite (CutRunContext *run_context, CutTestSuite *test_suite,
+                     guint n_test_cases, guint n_tests,
+                     CutTraceReport *report)
+{
+    const gchar *filename;
+
+    filename = cut_report_get_filename(CUT_REPORT(report));
+    if (!filename)
+        return;
+
+    g_mutex_lock(report->mutex);
+    close_output(report, FALSE);
+    report->output = g_fopen(filename, "wb");
+    if (report->output) {
+        setvbuf(report->output, NULL, _IONBF, 0);
+        report->owner_process_id = (gint)getpid();
+        report->have_event = FALSE;
+        report->base_time = cut_utils_get_monotonic_time();
+        report->n_assertions = 0;
+        report->counter_start_time = report->base_time;
+        g_hash_table_remove_all(report->spans);
+        g_hash_table_remove_all(report->process_ids);
+        g_string_append(report->buffer, "[\n");
+        append_process_name(report, report->owner_process_id);
+    } else {
+        g_warning("can't open trace report file [%s]", filename);
+    }
+    g_mutex_unlock(report->mutex);
+}
+
+static void
+cb_start_test_suite (CutRunContext *run_context, CutTestSuite *test_suite,
+                     CutTraceReport *report)
+{
+    start_span(report, CATEGORY_TEST_SUITE,
+               NULL, cut_test_get_name(CUT_TEST(test_suite)));
+}
+
+static void
+cb_start_test_case (CutRunContext *run_context, CutTestCase *test_case,
+                    CutTraceReport *report)
+{
+    start_span(report, CATEGORY_TEST_CASE,
+               NULL, cut_test_get_name(CUT_TEST(test_case)));
+}
+
+static void
+cb_start_test_iterator (CutRunContext *run_context,
+                        CutTestIterator *test_iterator,
+                        CutTraceReport *report)
+{
+    start_span(report, CATEGORY_TEST_ITERATOR,
+               NULL, cut_test_get_name(CUT_TEST(test_iterator)));
+}
+
+static void
+cb_start_test (CutRunContext *run_context, CutTest *test,
+               CutTestContext *test_context, CutTraceReport *report)
+{
+    start_span(report, CATEGORY_TEST,
+               test_case_name(test_context), cut_test_get_name(test));
+}
+
+static void
+cb_start_iterated_test (CutRunContext *run_context,
+                        CutIteratedTest *iterated_test,
+                        CutTestContext *test_context,
+                        CutTraceReport *report)
+{
+    start_span(report, CATEGORY_ITERATED_TEST,
+               test_case_name(test_context),
+               cut_test_get_full_name(CUT_TEST(iterated_test)));
+}
+
+static void
+add_assertions (CutTraceReport *report, guint n_assertions)
+{
+    g_mutex_lock(report->mutex);
+    if (report->output) {
+        report->n_assertions += n_assertions;
+        update_counter(report, cut_utils_get_monotonic_time(), FALSE);
+    }
+    g_mutex_unlock(report->mutex);
+}
+
+static void
+cb_pass_assertions (CutRunContext *run_context, CutTest *test,
+                    CutTestContext *test_context, guint n_assertions,
+                    CutTraceReport *report)
+{
+    add_assertions(report, n_assertions);
+}
+
+static void
+cb_complete_iterated_test (CutRunContext *run_context,
+                           CutIteratedTest *iterated_test,
+                           CutTestContext *test_context, gboolean success,
+                           CutTraceReport *report)
+{
+    complete_span(report, CATEGORY_ITERATED_TEST,
+                  test_case_name(test_context),
+                  cut_test_get_full_name(CUT_TEST(iterated_test)),
+                  CUT_TEST(iterated_test), success);
+}
+
+static void
+cb_complete_test (CutRunContext *run_context, CutTest *test,
+                  CutTestContext *test_context, gboolean success,
+                  CutTraceReport *report)
+{
+    complete_span(report, CATEGORY_TEST,
+                  test_case_name(test_context), cut_test_get_name(test),
+                  test, success);
+}
+
+static void
+cb_complete_test_iterator (CutRunContext *run_context,
+                           CutTestIterator *test_iterator, gboolean success,
+                           CutTraceReport *report)
+{
+    complete_span(report, CATEGORY_TEST_ITERATOR,
+                  NULL, cut_test_get_name(CUT_TEST(test_iterator)),
+                  CUT_TEST(test_iterator), success);
+}
+
+static void
+cb_complete_test_case (CutRunContext *run_context, CutTestCase *test_case,
+                       gboolean success, CutTraceReport *report)
+{
+    complete_span(report, CATEGORY_TEST_CASE,
+                  NULL, cut_test_get_name(CUT_TEST(test_case)),
+                  CUT_TEST(test_case), success);
+}
+
+static void
+cb_complete_test_suite (CutRunContext *run_context, CutTestSuite *test_suite,
+                        gboolean success, CutTraceReport *report)
+{
+    complete_span(report, CATEGORY_TEST_SUITE,
+                  NULL, cut_test_get_name(CUT_TEST(test_suite)),
+                  NULL, success);
+
+    g_mutex_lock(report->mutex);
+    if (report->output) {
+        update_counter(report, cut_utils_get_monotonic_time(), TRUE);
+        close_output(report, TRUE);
+    }
+    g_hash_table_remove_all(report->spans);
+    g_mutex_unlock(report->mutex);
+}
+
+static void
+connect_to_run_context (CutTraceReport *report, CutRunContext *run_context)
+{
+#define CONNECT(name) \
+    g_signal_connect(run_context, #name, G_CALLBACK(cb_ ## name), report)
+
+    CONNECT(ready_test_suite);
+    CONNECT(start_test_suite);
+    CONNECT(start_test_case);
+    CONNECT(start_test_iterator);
+    CONNECT(start_test);
+    CONNECT(start_iterated_test);
+
+    CONNECT(pass_assertions);
+
+    CONNECT(complete_iterated_test);
+    CONNECT(complete_test);
+    CONNECT(complete_test_iterator);
+    CONNECT(complete_test_case);
+    CONNECT(complete_test_suite);
+
+#undef CONNECT
+}
+
+static void
+disconnect_from_run_context (CutTraceReport *report,
+                             CutRunContext *run_context)
+{
+#define DISCONNECT(name)                                               \
+    g_signal_handlers_disconnect_by_func(run_context,                  \
+                                         G_CALLBACK(cb_ ## name),      \
+                                         report)
+
+    DISCONNECT(ready_test_suite);
+    DISCONNECT(start_test_suite);
+    DISCONNECT(start_test_case);
+    DISCONNECT(start_test_iterator);
+    DISCONNECT(start_test);
+    DISCONNECT(start_iterated_test);
+
+    DISCONNECT(pass_assertions);
+
+    DISCONNECT(complete_iterated_test);
+    DISCONNECT(complete_test);
+    DISCONNECT(complete_test_iterator);
+    DISCONNECT(complete_test_case);
+    DISCONNECT(complete_test_suite);
+
+#undef DISCONNECT
+}
+
+static void
+attach_to_run_context (CutListener *listener,
+                       CutRunContext *run_context)
+{
+    CutTraceReport *report = CUT_TRACE_REPORT(listener);
+    if (report->run_context)
+        detach_from_run_context(listener, report->run_context);
+
+    if (run_context) {
+        report->run_context = g_object_ref(run_context);
+        /* Phases are needed for setup and teardown spans. */
+        cut_run_context_set_measure_phases(run_context, TRUE);
+        connect_to_run_context(report, run_context);
+    }
+}
+
+static void
+detach_from_run_context (CutListener *listener,
+                         CutRunContext *run_context)
+{
+    CutTraceReport *report = CUT_TRACE_REPORT(listener);
+    if (report->run_context != run_context)
+        return;
+
+    disconnect_from_run_context(report, run_context);
+    g_object_unref(report->run_context);
+    report->run_context = NULL;
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
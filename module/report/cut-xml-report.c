@@ -408,6 +408,9 @@ attach_to_run_context (CutListener *listener,
 
     if (run_context) {
         report->run_context = g_object_ref(run_context);
+        /* The report is built from all results at the end of
+         * the run. */
+        cut_run_context_set_keep_results(run_context, CUT_KEEP_RESULTS_ALL);
         connect_to_run_context(CUT_XML_REPORT(listener), run_context);
     }
 }
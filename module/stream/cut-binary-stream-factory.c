@@ -0,0 +1,347 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_UNISTD_H
+#  include <unistd.h>
+#endif
+#include <glib.h>
+#include <glib/gi18n-lib.h>
+#include <gmodule.h>
+
+#include <cutter/cut-module-impl.h>
+#include <cutter/cut-stream.h>
+#include <cutter/cut-module-factory.h>
+#include <cutter/cut-enum-types.h>
+
+#ifndef STDOUT_FILENO
+#  define STDOUT_FILENO 1
+#endif
+
+#define CUT_TYPE_BINARY_STREAM_FACTORY            cut_type_binary_stream_factory
+#define CUT_BINARY_STREAM_FACTORY(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), CUT_TYPE_BINARY_STREAM_FACTORY, CutBinaryStreamFactory))
+#define CUT_BINARY_STREAM_FACTORY_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), CUT_TYPE_BINARY_STREAM_FACTORY, CutBinaryStreamFactoryClass))
+#define CUT_IS_BINARY_STREAM_FACTORY(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), CUT_TYPE_BINARY_STREAM_FACTORY))
+#define CUT_IS_BINARY_STREAM_FACTORY_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), CUT_TYPE_BINARY_STREAM_FACTORY))
+#define CUT_BINARY_STREAM_FACTORY_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), CUT_TYPE_BINARY_STREAM_FACTORY, CutBinaryStreamFactoryClass))
+
+typedef struct _CutBinaryStreamFactory CutBinaryStreamFactory;
+typedef struct _CutBinaryStreamFactoryClass CutBinaryStreamFactoryClass;
+
+struct _CutBinaryStreamFactory
+{
+    CutModuleFactory     object;
+
+    gint                 fd;
+    gchar               *directory;
+};
+
+struct _CutBinaryStreamFactoryClass
+{
+    CutModuleFactoryClass parent_class;
+};
+
+enum
+{
+    PROP_0,
+    PROP_FD,
+    PROP_DIRECTORY
+};
+
+static GType cut_type_binary_stream_factory = 0;
+static CutModuleFactoryClass *parent_class;
+
+static void     dispose          (GObject         *object);
+static void     set_property     (GObject         *object,
+                                  guint            prop_id,
+                                  const GValue    *value,
+                                  GParamSpec      *pspec);
+static void     get_property     (GObject         *object,
+                                  guint            prop_id,
+                                  GValue          *value,
+                                  GParamSpec      *pspec);
+static void     set_option_group (CutModuleFactory *factory,
+                                  GOptionContext   *context);
+static GObject *create           (CutModuleFactory *factory);
+
+static void
+class_init (CutModuleFactoryClass *klass)
+{
+    CutModuleFactoryClass *factory_class;
+    GObjectClass *gobject_class;
+    GParamSpec *spec;
+
+    parent_class = g_type_class_peek_parent(klass);
+    gobject_class = G_OBJECT_CLASS(klass);
+    factory_class  = CUT_MODULE_FACTORY_CLASS(klass);
+
+    gobject_class->dispose      = dispose;
+    gobject_class->set_property = set_property;
+    gobject_class->get_property = get_property;
+
+    factory_class->set_option_group = set_option_group;
+    factory_class->create           = create;
+
+    spec = g_param_spec_int("fd",
+                            "FD",
+                            "The FD of output stream",
+                            G_MININT32, G_MAXINT32, -1,
+                            G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
+    g_object_class_install_property(gobject_class, PROP_FD, spec);
+
+    /* The binary stream isn't for logs. "directory" is
+     * accepted only because the stream factory builder
+     * always passes it. */
+    spec = g_param_spec_string("directory",
+                               "Directory",
+                               "Ignored by binary stream",
+                               NULL,
+                               G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
+    g_object_class_install_property(gobject_class, PROP_DIRECTORY, spec);
+}
+
+static void
+init (CutBinaryStreamFactory *factory)
+{
+    factory->fd = -1;
+    factory->directory = NULL;
+}
+
+static void
+dispose (GObject *object)
+{
+    CutBinaryStreamFactory *factory = CUT_BINARY_STREAM_FACTORY(object);
+
+    if (factory->directory) {
+        g_free(factory->directory);
+        factory->directory = NULL;
+    }
+
+    G_OBJECT_CLASS(parent_class)->dispose(object);
+}
+
+static void
+set_property (GObject      *object,
+              guint         prop_id,
+              const GValue *value,
+              GParamSpec   *pspec)
+{
+    CutBinaryStreamFactory *factory;
+
+    factory = CUT_BINARY_STREAM_FACTORY(object);
+    switch (prop_id) {
+      case PROP_FD:
+        factory->fd = g_value_get_int(value);
+        break;
+      case PROP_DIRECTORY:
+        g_free(factory->directory);
+        factory->directory = g_value_dup_string(value);
+        break;
+      default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+get_property (GObject    *object,
+              guint       prop_id,
+              GValue     *value,
+              GParamSpec *pspec)
+{
+    CutBinaryStreamFactory *factory;
+
+    factory = CUT_BINARY_STREAM_FACTORY(object);
+    switch (prop_id) {
+      case PROP_FD:
+        g_value_set_int(value, factory->fd);
+        break;
+      case PROP_DIRECTORY:
+        g_value_set_string(value, factory->directory);
+        break;
+      default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+register_type (GTypeModule *type_module)
+{
+    static const GTypeInfo info =
+        {
+            sizeof (CutBinaryStreamFactoryClass),
+            (GBaseInitFunc) NULL,
+            (GBaseFinalizeFunc) NULL,
+            (GClassInitFunc) class_init,
+            NULL,           /* class_finalize */
+            NULL,           /* class_data */
+            sizeof(CutBinaryStreamFactory),
+            0,
+            (GInstanceInitFunc) init,
+        };
+
+    cut_type_binary_stream_factory =
+        g_type_module_register_type(type_module,
+                                    CUT_TYPE_MODULE_FACTORY,
+                                    "CutBinaryStreamFactory",
+                                    &info, 0);
+}
+
+G_MODULE_EXPORT GList *
+CUT_MODULE_IMPL_INIT (GTypeModule *type_module)
+{
+    GList *registered_types = NULL;
+
+    register_type(type_module);
+    if (cut_type_binary_stream_factory)
+        registered_types =
+            g_list_prepend(registered_types,
+                           (gchar *)g_type_name(cut_type_binary_stream_factory));
+
+    return registered_types;
+}
+
+G_MODULE_EXPORT void
+CUT_MODULE_IMPL_EXIT (void)
+{
+}
+
+G_MODULE_EXPORT GObject *
+CUT_MODULE_IMPL_INSTANTIATE (const gchar *first_property, va_list var_args)
+{
+    return g_object_new_valist(CUT_TYPE_BINARY_STREAM_FACTORY, first_property, var_args);
+}
+
+static void
+set_option_group (CutModuleFactory *factory, GOptionContext *context)
+{
+    if (CUT_MODULE_FACTORY_CLASS(parent_class)->set_option_group)
+        CUT_MODULE_FACTORY_CLASS(parent_class)->set_option_group(factory, context);
+}
+
+typedef struct _StreamData StreamData;
+struct _StreamData
+{
+    gboolean initialized;
+    gint fd;
+    GIOChannel *channel;
+};
+
+static StreamData *
+stream_data_new (gint fd)
+{
+    StreamData *data;
+
+    data = g_slice_new(StreamData);
+    data->initialized = FALSE;
+    data->fd = fd;
+    data->channel = NULL;
+
+    return data;
+}
+
+static void
+stream_data_free (StreamData *data)
+{
+    if (data->channel)
+        g_io_channel_unref(data->channel);
+
+    g_slice_free(StreamData, data);
+}
+
+static GIOChannel *
+create_channel (StreamData *data)
+{
+    gint fd;
+    GIOChannel *channel;
+
+    if (data->fd == -1)
+        fd = STDOUT_FILENO;
+    else
+        fd = data->fd;
+
+#ifdef G_OS_WIN32
+    channel = g_io_channel_win32_new_fd(fd);
+#else
+    channel = g_io_channel_unix_new(fd);
+#endif
+    if (!channel)
+        return NULL;
+
+    g_io_channel_set_close_on_unref(channel, TRUE);
+    /* Records are binary and already buffered per event. */
+    g_io_channel_set_encoding(channel, NULL, NULL);
+    g_io_channel_set_buffered(channel, FALSE);
+
+    return channel;
+}
+
+static gboolean
+stream (const gchar *data, gsize length, GError **error, gpointer user_data)
+{
+    StreamData *stream_data = user_data;
+
+    if (!stream_data->initialized) {
+        stream_data->channel = create_channel(stream_data);
+        stream_data->initialized = TRUE;
+    }
+
+    if (!stream_data->channel)
+        return FALSE;
+
+    while (length > 0) {
+        gsize written = 0;
+
+        g_io_channel_write_chars(stream_data->channel, data, length,
+                                 &written, error);
+        if (*error)
+            break;
+
+        data += written;
+        length -= written;
+    }
+
+    return *error == NULL;
+}
+
+GObject *
+create (CutModuleFactory *factory)
+{
+    CutBinaryStreamFactory *binary_factory;
+    StreamData *data;
+
+    binary_factory = CUT_BINARY_STREAM_FACTORY(factory);
+    data = stream_data_new(binary_factory->fd);
+    return G_OBJECT(cut_stream_new("binary",
+                                   "stream-write-function", stream,
+                                   "stream-write-function-user-data", data,
+                                   "stream-write-function-user-data-destroy-function",
+                                   stream_data_free,
+                                   NULL));
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
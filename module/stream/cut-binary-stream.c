@@ -0,0 +1,927 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gi18n-lib.h>
+#include <gmodule.h>
+
+#include <cutter/cut-module-impl.h>
+#include <cutter/cut-stream.h>
+#include <cutter/cut-listener.h>
+#include <cutter/cut-run-context.h>
+#include <cutter/cut-test-suite.h>
+#include <cutter/cut-test-case.h>
+#include <cutter/cut-test-iterator.h>
+#include <cutter/cut-iterated-test.h>
+#include <cutter/cut-test-context.h>
+#include <cutter/cut-test-data.h>
+#include <cutter/cut-test-result.h>
+#include <cutter/cut-backtrace-entry.h>
+#include <cutter/cut-binary-stream-parser.h>
+#include <cutter/cut-enum-types.h>
+#include <cutter/cut-glib-compatible.h>
+
+#define CUT_TYPE_BINARY_STREAM            cut_type_binary_stream
+#define CUT_BINARY_STREAM(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), CUT_TYPE_BINARY_STREAM, CutBinaryStream))
+#define CUT_BINARY_STREAM_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), CUT_TYPE_BINARY_STREAM, CutBinaryStreamClass))
+#define CUT_IS_BINARY_STREAM(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), CUT_TYPE_BINARY_STREAM))
+#define CUT_IS_BINARY_STREAM_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), CUT_TYPE_BINARY_STREAM))
+#define CUT_BINARY_STREAM_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj), CUT_TYPE_BINARY_STREAM, CutBinaryStreamClass))
+
+typedef struct _CutBinaryStream CutBinaryStream;
+typedef struct _CutBinaryStreamClass CutBinaryStreamClass;
+
+struct _CutBinaryStream
+{
+    CutStream   object;
+    CutRunContext    *run_context;
+    GMutex *mutex;
+    CutStreamWriteFunction write_function;
+    gpointer write_function_user_data;
+    GDestroyNotify write_function_user_data_destroy_function;
+
+    gboolean magic_written;
+    GHashTable *names;
+    GString *output;
+    GString *record;
+};
+
+struct _CutBinaryStreamClass
+{
+    CutStreamClass parent_class;
+};
+
+enum
+{
+    PROP_0,
+    PROP_RUN_CONTEXT,
+    PROP_STREAM_WRITE_FUNCTION,
+    PROP_STREAM_WRITE_FUNCTION_USER_DATA,
+    PROP_STREAM_WRITE_FUNCTION_USER_DATA_DESTROY_FUNCTION
+};
+
+static GType cut_type_binary_stream = 0;
+static CutStreamClass *parent_class;
+
+static void dispose        (GObject         *object);
+static void set_property   (GObject         *object,
+                            guint            prop_id,
+                            const GValue    *value,
+                            GParamSpec      *pspec);
+static void get_property   (GObject         *object,
+                            guint            prop_id,
+                            GValue          *value,
+                            GParamSpec      *pspec);
+
+static void attach_to_run_context             (CutListener *listener,
+                                               CutRunContext   *run_context);
+static void detach_from_run_context           (CutListener *listener,
+                                               CutRunContext   *run_context);
+
+static void
+class_init (CutBinaryStreamClass *klass)
+{
+    GObjectClass *gobject_class;
+    GParamSpec *spec;
+
+    parent_class = g_type_class_peek_parent(klass);
+
+    gobject_class = G_OBJECT_CLASS(klass);
+
+    gobject_class->dispose      = dispose;
+    gobject_class->set_property = set_property;
+    gobject_class->get_property = get_property;
+
+    spec = g_param_spec_object("cut-run-context",
+                               "CutRunContext object",
+                               "A CutRunContext object",
+                               CUT_TYPE_RUN_CONTEXT,
+                               G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_RUN_CONTEXT, spec);
+
+    spec = g_param_spec_pointer("stream-write-function",
+                                "Stream write function",
+                                "A function to write binary data",
+                                G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property(gobject_class, PROP_STREAM_WRITE_FUNCTION,
+                                    spec);
+
+    spec = g_param_spec_pointer("stream-write-function-user-data",
+                                "Stream write function user data",
+                                "A user data to use with stream write function",
+                                G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property(gobject_class,
+                                    PROP_STREAM_WRITE_FUNCTION_USER_DATA, spec);
+
+    spec = g_param_spec_pointer("stream-write-function-user-data-destroy-function",
+                                "Destroy function for stream write function user data",
+                                "A function to destroy user data",
+                                G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property(gobject_class,
+                                    PROP_STREAM_WRITE_FUNCTION_USER_DATA_DESTROY_FUNCTION,
+                                    spec);
+}
+
+static void
+init (CutBinaryStream *stream)
+{
+    stream->run_context = NULL;
+    stream->mutex = g_mutex_new();
+    stream->write_function = NULL;
+    stream->write_function_user_data = NULL;
+    stream->write_function_user_data_destroy_function = NULL;
+
+    stream->magic_written = FALSE;
+    stream->names = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                          g_free, NULL);
+    stream->output = g_string_new(NULL);
+    stream->record = g_string_new(NULL);
+}
+
+static void
+listener_init (CutListenerClass *listener)
+{
+    listener->attach_to_run_context   = attach_to_run_context;
+    listener->detach_from_run_context = detach_from_run_context;
+}
+
+static void
+register_type (GTypeModule *type_module)
+{
+    static const GTypeInfo info =
+        {
+            sizeof (CutBinaryStreamClass),
+            (GBaseInitFunc) NULL,
+            (GBaseFinalizeFunc) NULL,
+            (GClassInitFunc) class_init,
+            NULL,           /* class_finalize */
+            NULL,           /* class_data */
+            sizeof(CutBinaryStream),
+            0,
+            (GInstanceInitFunc) init,
+        };
+
+    static const GInterfaceInfo listener_info =
+        {
+            (GInterfaceInitFunc) listener_init,
+            NULL,
+            NULL
+        };
+
+    cut_type_binary_stream =
+        g_type_module_register_type(type_module,
+                                    CUT_TYPE_STREAM,
+                                    "CutBinaryStream",
+                                    &info, 0);
+
+    g_type_module_add_interface(type_module,
+                                cut_type_binary_stream,
+                                CUT_TYPE_LISTENER,
+                                &listener_info);
+}
+
+G_MODULE_EXPORT GList *
+CUT_MODULE_IMPL_INIT (GTypeModule *type_module)
+{
+    GList *registered_types = NULL;
+
+    register_type(type_module);
+    if (cut_type_binary_stream)
+        registered_types =
+            g_list_prepend(registered_types,
+                           (gchar *)g_type_name(cut_type_binary_stream));
+
+    return registered_types;
+}
+
+G_MODULE_EXPORT void
+CUT_MODULE_IMPL_EXIT (void)
+{
+}
+
+G_MODULE_EXPORT GObject *
+CUT_MODULE_IMPL_INSTANTIATE (const gchar *first_property, va_list var_args)
+{
+    return g_object_new_valist(CUT_TYPE_BINARY_STREAM, first_property, var_args);
+}
+
+static void
+dispose (GObject *object)
+{
+    CutBinaryStream *stream = CUT_BINARY_STREAM(object);
+
+    if (stream->run_context) {
+        g_object_unref(stream->run_context);
+        stream->run_context = NULL;
+    }
+
+    if (stream->mutex) {
+        g_mutex_free(stream->mutex);
+        stream->mutex = NULL;
+    }
+
+    if (stream->write_function_user_data) {
+        if (stream->write_function_user_data_destroy_function)
+            stream->write_function_user_data_destroy_function(stream->write_function_user_data);
+        stream->write_function_user_data = NULL;
+    }
+
+    if (stream->names) {
+        g_hash_table_unref(stream->names);
+        stream->names = NULL;
+    }
+
+    if (stream->output) {
+        g_string_free(stream->output, TRUE);
+        stream->output = NULL;
+    }
+
+    if (stream->record) {
+        g_string_free(stream->record, TRUE);
+        stream->record = NULL;
+    }
+
+    G_OBJECT_CLASS(parent_class)->dispose(object);
+}
+
+static void
+set_property (GObject      *object,
+              guint         prop_id,
+              const GValue *value,
+              GParamSpec   *pspec)
+{
+    CutBinaryStream *stream = CUT_BINARY_STREAM(object);
+
+    switch (prop_id) {
+      case PROP_RUN_CONTEXT:
+        attach_to_run_context(CUT_LISTENER(stream),
+                              CUT_RUN_CONTEXT(g_value_get_object(value)));
+        break;
+      case PROP_STREAM_WRITE_FUNCTION:
+        stream->write_function = g_value_get_pointer(value);
+        break;
+      case PROP_STREAM_WRITE_FUNCTION_USER_DATA:
+        stream->write_function_user_data = g_value_get_pointer(value);
+        break;
+      case PROP_STREAM_WRITE_FUNCTION_USER_DATA_DESTROY_FUNCTION:
+        stream->write_function_user_data_destroy_function =
+            g_value_get_pointer(value);
+        break;
+      default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+get_property (GObject    *object,
+              guint       prop_id,
+              GValue     *value,
+              GParamSpec *pspec)
+{
+    CutBinaryStream *stream = CUT_BINARY_STREAM(object);
+
+    switch (prop_id) {
+      case PROP_RUN_CONTEXT:
+        g_value_set_object(value, G_OBJECT(stream->run_context));
+        break;
+      case PROP_STREAM_WRITE_FUNCTION:
+        g_value_set_pointer(value, stream->write_function);
+        break;
+      case PROP_STREAM_WRITE_FUNCTION_USER_DATA:
+        g_value_set_pointer(value, stream->write_function_user_data);
+        break;
+      case PROP_STREAM_WRITE_FUNCTION_USER_DATA_DESTROY_FUNCTION:
+        g_value_set_pointer(value, stream->write_function_user_data_destroy_function);
+        break;
+      default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+put_uint8 (GString *string, guint8 value)
+{
+    g_string_append_c(string, value);
+}
+
+static void
+put_uint32 (GString *string, guint32 value)
+{
+    g_string_append_len(string, (const gchar *)&value, sizeof(value));
+}
+
+static void
+put_boolean (GString *string, gboolean value)
+{
+    put_uint8(string, value ? 1 : 0);
+}
+
+static void
+put_double (GString *string, gdouble value)
+{
+    g_string_append_len(string, (const gchar *)&value, sizeof(value));
+}
+
+static void
+put_time_val (GString *string, const GTimeVal *time_val)
+{
+    gint64 seconds, microseconds;
+
+    seconds = time_val->tv_sec;
+    microseconds = time_val->tv_usec;
+    g_string_append_len(string, (const gchar *)&seconds, sizeof(seconds));
+    g_string_append_len(string, (const gchar *)&microseconds,
+                        sizeof(microseconds));
+}
+
+static void
+put_resource_usage (GString *string, const CutResourceUsage *usage)
+{
+    put_boolean(string, usage != NULL);
+    if (usage)
+        g_string_append_len(string, (const gchar *)usage, sizeof(*usage));
+}
+
+static void
+put_phase_elapsed (GString *string, const CutPhaseElapsed *phase_elapsed)
+{
+    g_string_append_len(string, (const gchar *)phase_elapsed,
+                        sizeof(*phase_elapsed));
+}
+
+static void
+put_string (GString *string, const gchar *value)
+{
+    gsize length;
+
+    if (!value) {
+        put_uint32(string, G_MAXUINT32);
+        return;
+    }
+
+    length = strlen(value);
+    put_uint32(string, length);
+    g_string_append_len(string, value, length);
+}
+
+static void
+put_record_header (GString *string, CutBinaryRecordType type,
+                   guint32 payload_length)
+{
+    put_uint8(string, type);
+    put_uint32(string, payload_length);
+}
+
+/* The definition of a new name is written to the output
+ * before the record that refers it. */
+static void
+put_name (CutBinaryStream *stream, const gchar *name)
+{
+    guint32 id;
+
+    if (!name) {
+        put_uint32(stream->record, 0);
+        return;
+    }
+
+    id = GPOINTER_TO_UINT(g_hash_table_lookup(stream->names, name));
+    if (id == 0) {
+        gsize length;
+
+        id = g_hash_table_size(stream->names) + 1;
+        g_hash_table_insert(stream->names, g_strdup(name), GUINT_TO_POINTER(id));
+
+        length = strlen(name);
+        put_record_header(stream->output, CUT_BINARY_RECORD_NAME,
+                          sizeof(id) + length);
+        put_uint32(stream->output, id);
+        g_string_append_len(stream->output, name, length);
+    }
+    put_uint32(stream->record, id);
+}
+
+static void
+put_attribute (const gchar *name, const gchar *value, CutBinaryStream *stream)
+{
+    put_name(stream, name);
+    put_name(stream, value);
+}
+
+static void
+put_test (CutBinaryStream *stream, CutTest *test)
+{
+    CutBinaryObjectType type;
+    GTimeVal start_time;
+    GHashTable *attributes;
+
+    if (!test) {
+        put_uint8(stream->record, CUT_BINARY_OBJECT_NONE);
+        return;
+    }
+
+    if (CUT_IS_TEST_SUITE(test))
+        type = CUT_BINARY_OBJECT_TEST_SUITE;
+    else if (CUT_IS_TEST_CASE(test))
+        type = CUT_BINARY_OBJECT_TEST_CASE;
+    else if (CUT_IS_TEST_ITERATOR(test))
+        type = CUT_BINARY_OBJECT_TEST_ITERATOR;
+    else if (CUT_IS_ITERATED_TEST(test))
+        type = CUT_BINARY_OBJECT_ITERATED_TEST;
+    else
+        type = CUT_BINARY_OBJECT_TEST;
+    put_uint8(stream->record, type);
+
+    put_name(stream, cut_test_get_name(test));
+    cut_test_get_start_time(test, &start_time);
+    put_time_val(stream->record, &start_time);
+    put_double(stream->record, cut_test_get_elapsed(test));
+    put_resource_usage(stream->record, cut_test_get_resource_usage(test));
+    put_phase_elapsed(stream->record, cut_test_get_phase_elapsed(test));
+
+    attributes = cut_test_get_attributes(test);
+    if (attributes) {
+        put_uint32(stream->record, g_hash_table_size(attributes));
+        g_hash_table_foreach(attributes, (GHFunc)put_attribute, stream);
+    } else {
+        put_uint32(stream->record, 0);
+    }
+}
+
+static void
+put_test_data (CutBinaryStream *stream, CutTestData *test_data)
+{
+    put_boolean(stream->record, test_data != NULL);
+    if (test_data)
+        put_name(stream, cut_test_data_get_name(test_data));
+}
+
+static void
+put_test_context (CutBinaryStream *stream, CutTestContext *test_context)
+{
+    CutTestData *test_data = NULL;
+
+    put_boolean(stream->record, test_context != NULL);
+    if (!test_context)
+        return;
+
+    put_test(stream, CUT_TEST(cut_test_context_get_test_suite(test_context)));
+    put_test(stream, CUT_TEST(cut_test_context_get_test_case(test_context)));
+    put_test(stream,
+             CUT_TEST(cut_test_context_get_test_iterator(test_context)));
+    put_test(stream, cut_test_context_get_test(test_context));
+    if (cut_test_context_have_data(test_context))
+        test_data = cut_test_context_get_current_data(test_context);
+    put_test_data(stream, test_data);
+    put_boolean(stream->record, cut_test_context_is_failed(test_context));
+}
+
+static void
+put_backtrace (CutBinaryStream *stream, CutTestResult *result)
+{
+    const GList *backtrace = NULL, *node;
+
+    if (cut_test_result_get_status(result) != CUT_TEST_RESULT_SUCCESS)
+        backtrace = cut_test_result_get_backtrace(result);
+
+    put_uint32(stream->record, g_list_length((GList *)backtrace));
+    for (node = backtrace; node; node = g_list_next(node)) {
+        CutBacktraceEntry *entry = node->data;
+
+        put_name(stream, cut_backtrace_entry_get_file(entry));
+        put_uint32(stream->record, cut_backtrace_entry_get_line(entry));
+        put_name(stream, cut_backtrace_entry_get_function(entry));
+        put_string(stream->record, cut_backtrace_entry_get_info(entry));
+    }
+}
+
+static void
+put_test_result (CutBinaryStream *stream, CutTestResult *result)
+{
+    GTimeVal start_time;
+
+    put_uint8(stream->record, cut_test_result_get_status(result));
+    put_test(stream, CUT_TEST(cut_test_result_get_test_case(result)));
+    put_test(stream, CUT_TEST(cut_test_result_get_test_iterator(result)));
+    put_test(stream, cut_test_result_get_test(result));
+    put_test_data(stream, cut_test_result_get_test_data(result));
+    put_string(stream->record, cut_test_result_get_message(result));
+    put_backtrace(stream, result);
+    cut_test_result_get_start_time(result, &start_time);
+    put_time_val(stream->record, &start_time);
+    put_double(stream->record, cut_test_result_get_elapsed(result));
+    put_resource_usage(stream->record,
+                       cut_test_result_get_resource_usage(result));
+    put_phase_elapsed(stream->record,
+                      cut_test_result_get_phase_elapsed(result));
+    put_string(stream->record, cut_test_result_get_expected(result));
+    put_string(stream->record, cut_test_result_get_actual(result));
+    put_string(stream->record, cut_test_result_get_diff(result));
+    put_string(stream->record, cut_test_result_get_folded_diff(result));
+}
+
+static void
+start_record (CutBinaryStream *stream, CutBinaryRecordType type)
+{
+    g_mutex_lock(stream->mutex);
+
+    if (!stream->magic_written) {
+        g_string_append_len(stream->output,
+                            CUT_BINARY_STREAM_MAGIC,
+                            CUT_BINARY_STREAM_MAGIC_LENGTH);
+        stream->magic_written = TRUE;
+    }
+
+    g_string_truncate(stream->record, 0);
+    put_record_header(stream->record, type, 0);
+}
+
+static void
+flow (CutBinaryStream *stream)
+{
+    GError *error = NULL;
+    guint32 payload_length;
+
+    payload_length = stream->record->len - CUT_BINARY_RECORD_HEADER_SIZE;
+    memcpy(stream->record->str + 1, &payload_length, sizeof(payload_length));
+    g_string_append_len(stream->output,
+                        stream->record->str, stream->record->len);
+
+    if (stream->write_function)
+        stream->write_function(stream->output->str, stream->output->len,
+                               &error, stream->write_function_user_data);
+    g_string_truncate(stream->output, 0);
+    g_mutex_unlock(stream->mutex);
+
+    if (error) {
+        g_warning("WriteError: %s:%d: %s",
+                  g_quark_to_string(error->domain),
+                  error->code,
+                  error->message);
+        g_error_free(error);
+    }
+}
+
+static void
+cb_start_run (CutRunContext *run_context, CutBinaryStream *stream)
+{
+    start_record(stream, CUT_BINARY_RECORD_START_RUN);
+    flow(stream);
+}
+
+static void
+cb_ready_test_suite (CutRunContext *run_context, CutTestSuite *test_suite,
+                     guint n_test_cases, guint n_tests,
+                     CutBinaryStream *stream)
+{
+    start_record(stream, CUT_BINARY_RECORD_READY_TEST_SUITE);
+    put_test(stream, CUT_TEST(test_suite));
+    put_uint32(stream->record, n_test_cases);
+    put_uint32(stream->record, n_tests);
+    flow(stream);
+}
+
+static void
+cb_start_test_suite (CutRunContext *run_context, CutTestSuite *test_suite,
+                     CutBinaryStream *stream)
+{
+    start_record(stream, CUT_BINARY_RECORD_START_TEST_SUITE);
+    put_test(stream, CUT_TEST(test_suite));
+    flow(stream);
+}
+
+static void
+cb_ready_test_case (CutRunContext *run_context, CutTestCase *test_case,
+                    guint n_tests, CutBinaryStream *stream)
+{
+    start_record(stream, CUT_BINARY_RECORD_READY_TEST_CASE);
+    put_test(stream, CUT_TEST(test_case));
+    put_uint32(stream->record, n_tests);
+    flow(stream);
+}
+
+static void
+cb_start_test_case (CutRunContext *run_context, CutTestCase *test_case,
+                    CutBinaryStream *stream)
+{
+    start_record(stream, CUT_BINARY_RECORD_START_TEST_CASE);
+    put_test(stream, CUT_TEST(test_case));
+    flow(stream);
+}
+
+static void
+cb_ready_test_iterator (CutRunContext *run_context,
+                        CutTestIterator *test_iterator, guint n_tests,
+                        CutBinaryStream *stream)
+{
+    start_record(stream, CUT_BINARY_RECORD_READY_TEST_ITERATOR);
+    put_test(stream, CUT_TEST(test_iterator));
+    put_uint32(stream->record, n_tests);
+    flow(stream);
+}
+
+static void
+cb_start_test_iterator (CutRunContext *run_context,
+                        CutTestIterator *test_iterator,
+                        CutBinaryStream *stream)
+{
+    start_record(stream, CUT_BINARY_RECORD_START_TEST_ITERATOR);
+    put_test(stream, CUT_TEST(test_iterator));
+    flow(stream);
+}
+
+static void
+cb_start_iterated_test (CutRunContext *run_context,
+                        CutIteratedTest *iterated_test,
+                        CutTestContext *test_context,
+                        CutBinaryStream *stream)
+{
+    start_record(stream, CUT_BINARY_RECORD_START_ITERATED_TEST);
+    put_test(stream, CUT_TEST(iterated_test));
+    put_test_context(stream, test_context);
+    flow(stream);
+}
+
+static void
+cb_start_test (CutRunContext *run_context, CutTest *test,
+               CutTestContext *test_context, CutBinaryStream *stream)
+{
+    start_record(stream, CUT_BINARY_RECORD_START_TEST);
+    put_test(stream, test);
+    put_test_context(stream, test_context);
+    flow(stream);
+}
+
+static void
+cb_pass_assertions (CutRunContext *run_context, CutTest *test,
+                    CutTestContext *test_context, guint n_assertions,
+                    CutBinaryStream *stream)
+{
+    start_record(stream, CUT_BINARY_RECORD_PASS_ASSERTIONS);
+    put_test(stream, test);
+    put_test_context(stream, test_context);
+    put_uint32(stream->record, n_assertions);
+    flow(stream);
+}
+
+static void
+cb_test_result (CutRunContext  *run_context,
+                CutTest        *test,
+                CutTestContext *test_context,
+                CutTestResult  *result,
+                CutBinaryStream *stream)
+{
+    start_record(stream, CUT_BINARY_RECORD_TEST_RESULT);
+    put_test(stream, test);
+    put_test_context(stream, test_context);
+    put_test_result(stream, result);
+    flow(stream);
+}
+
+static void
+cb_complete_test (CutRunContext *run_context, CutTest *test,
+                  CutTestContext *test_context, gboolean success,
+                  CutBinaryStream *stream)
+{
+    start_record(stream, CUT_BINARY_RECORD_COMPLETE_TEST);
+    put_test(stream, test);
+    put_test_context(stream, test_context);
+    put_boolean(stream->record, success);
+    flow(stream);
+}
+
+static void
+cb_complete_iterated_test (CutRunContext *run_context,
+                           CutIteratedTest *iterated_test,
+                           CutTestContext *test_context,
+                           gboolean success,
+                           CutBinaryStream *stream)
+{
+    start_record(stream, CUT_BINARY_RECORD_COMPLETE_ITERATED_TEST);
+    put_test(stream, CUT_TEST(iterated_test));
+    put_test_context(stream, test_context);
+    put_boolean(stream->record, success);
+    flow(stream);
+}
+
+static void
+cb_test_iterator_result (CutRunContext  *run_context,
+                         CutTestIterator *test_iterator,
+                         CutTestResult  *result,
+                         CutBinaryStream *stream)
+{
+    start_record(stream, CUT_BINARY_RECORD_TEST_ITERATOR_RESULT);
+    put_test(stream, CUT_TEST(test_iterator));
+    put_test_result(stream, result);
+    flow(stream);
+}
+
+static void
+cb_complete_test_iterator (CutRunContext *run_context,
+                           CutTestIterator *test_iterator,
+                           gboolean success,
+                           CutBinaryStream *stream)
+{
+    start_record(stream, CUT_BINARY_RECORD_COMPLETE_TEST_ITERATOR);
+    put_test(stream, CUT_TEST(test_iterator));
+    put_boolean(stream->record, success);
+    flow(stream);
+}
+
+static void
+cb_test_case_result (CutRunContext  *run_context,
+                     CutTestCase    *test_case,
+                     CutTestResult  *result,
+                     CutBinaryStream *stream)
+{
+    start_record(stream, CUT_BINARY_RECORD_TEST_CASE_RESULT);
+    put_test(stream, CUT_TEST(test_case));
+    put_test_result(stream, result);
+    flow(stream);
+}
+
+static void
+cb_complete_test_case (CutRunContext *run_context, CutTestCase *test_case,
+                       gboolean success, CutBinaryStream *stream)
+{
+    start_record(stream, CUT_BINARY_RECORD_COMPLETE_TEST_CASE);
+    put_test(stream, CUT_TEST(test_case));
+    put_boolean(stream->record, success);
+    flow(stream);
+}
+
+static void
+cb_complete_test_suite (CutRunContext *run_context, CutTestSuite *test_suite,
+                        gboolean success, CutBinaryStream *stream)
+{
+    start_record(stream, CUT_BINARY_RECORD_COMPLETE_TEST_SUITE);
+    put_test(stream, CUT_TEST(test_suite));
+    put_boolean(stream->record, success);
+    flow(stream);
+}
+
+static void
+cb_complete_run (CutRunContext *run_context, gboolean success,
+                 CutBinaryStream *stream)
+{
+    start_record(stream, CUT_BINARY_RECORD_COMPLETE_RUN);
+    put_boolean(stream->record, success);
+    flow(stream);
+}
+
+static void
+connect_to_run_context (CutBinaryStream *stream, CutRunContext *run_context)
+{
+#define CONNECT(name)                                                   \
+    g_signal_connect(run_context, #name, G_CALLBACK(cb_ ## name), stream)
+
+#define CONNECT_TO_TEST(name)                                           \
+    g_signal_connect(run_context, #name "_test",                        \
+                     G_CALLBACK(cb_test_result), stream)
+
+#define CONNECT_TO_TEST_CASE(name)                                      \
+    g_signal_connect(run_context, #name "_test_case",                   \
+                     G_CALLBACK(cb_test_case_result), stream)
+
+#define CONNECT_TO_TEST_ITERATOR(name)                                  \
+    g_signal_connect(run_context, #name "_test_iterator",               \
+                     G_CALLBACK(cb_test_iterator_result), stream)
+
+    CONNECT(start_run);
+    CONNECT(ready_test_suite);
+    CONNECT(start_test_suite);
+    CONNECT(ready_test_case);
+    CONNECT(start_test_case);
+    CONNECT(ready_test_iterator);
+    CONNECT(start_test_iterator);
+    CONNECT(start_iterated_test);
+    CONNECT(start_test);
+
+    /* Passed assertions are received in batch. They are
+     * too many to stream one by one. */
+    CONNECT(pass_assertions);
+
+    CONNECT_TO_TEST(success);
+    CONNECT_TO_TEST(failure);
+    CONNECT_TO_TEST(error);
+    CONNECT_TO_TEST(pending);
+    CONNECT_TO_TEST(notification);
+    CONNECT_TO_TEST(omission);
+    CONNECT_TO_TEST(crash);
+
+    CONNECT_TO_TEST_ITERATOR(success);
+    CONNECT_TO_TEST_ITERATOR(failure);
+    CONNECT_TO_TEST_ITERATOR(error);
+    CONNECT_TO_TEST_ITERATOR(pending);
+    CONNECT_TO_TEST_ITERATOR(notification);
+    CONNECT_TO_TEST_ITERATOR(omission);
+    CONNECT_TO_TEST_ITERATOR(crash);
+
+    CONNECT_TO_TEST_CASE(success);
+    CONNECT_TO_TEST_CASE(failure);
+    CONNECT_TO_TEST_CASE(error);
+    CONNECT_TO_TEST_CASE(pending);
+    CONNECT_TO_TEST_CASE(notification);
+    CONNECT_TO_TEST_CASE(omission);
+    CONNECT_TO_TEST_CASE(crash);
+
+    CONNECT(complete_test);
+    CONNECT(complete_iterated_test);
+    CONNECT(complete_test_iterator);
+    CONNECT(complete_test_case);
+    CONNECT(complete_test_suite);
+    CONNECT(complete_run);
+
+#undef CONNECT
+#undef CONNECT_TO_TEST
+#undef CONNECT_TO_TEST_CASE
+#undef CONNECT_TO_TEST_ITERATOR
+}
+
+static void
+disconnect_from_run_context (CutBinaryStream *stream,
+                             CutRunContext *run_context)
+{
+#define DISCONNECT(name)                                                \
+    g_signal_handlers_disconnect_by_func(run_context,                   \
+                                         G_CALLBACK(cb_ ## name),       \
+                                         stream)
+    DISCONNECT(start_run);
+    DISCONNECT(ready_test_suite);
+    DISCONNECT(start_test_suite);
+    DISCONNECT(ready_test_case);
+    DISCONNECT(start_test_case);
+    DISCONNECT(ready_test_iterator);
+    DISCONNECT(start_test_iterator);
+    DISCONNECT(start_iterated_test);
+    DISCONNECT(start_test);
+
+    DISCONNECT(pass_assertions);
+
+    DISCONNECT(test_result);
+    DISCONNECT(test_iterator_result);
+    DISCONNECT(test_case_result);
+
+    DISCONNECT(complete_test);
+    DISCONNECT(complete_iterated_test);
+    DISCONNECT(complete_test_iterator);
+    DISCONNECT(complete_test_case);
+    DISCONNECT(complete_test_suite);
+    DISCONNECT(complete_run);
+
+#undef DISCONNECT
+}
+
+static void
+attach_to_run_context (CutListener *listener,
+                       CutRunContext   *run_context)
+{
+    CutBinaryStream *stream = CUT_BINARY_STREAM(listener);
+    if (stream->run_context)
+        detach_from_run_context(listener, stream->run_context);
+
+    if (run_context) {
+        stream->run_context = g_object_ref(run_context);
+        connect_to_run_context(CUT_BINARY_STREAM(listener), run_context);
+    }
+}
+
+static void
+detach_from_run_context (CutListener *listener,
+                         CutRunContext   *run_context)
+{
+    CutBinaryStream *stream = CUT_BINARY_STREAM(listener);
+    if (stream->run_context != run_context)
+        return;
+
+    disconnect_from_run_context(stream, run_context);
+    g_object_unref(stream->run_context);
+    stream->run_context = NULL;
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
@@ -23,9 +23,14 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #ifdef HAVE_UNISTD_H
 #  include <unistd.h>
 #endif
+#ifdef HAVE_SYS_UIO_H
+#  include <sys/uio.h>
+#  include <limits.h>
+#endif
 #include <glib.h>
 #include <glib/gstdio.h>
 #include <glib/gi18n-lib.h>
@@ -40,6 +45,10 @@
 #  define STDOUT_FILENO 1
 #endif
 
+#if defined(HAVE_SYS_UIO_H) && !defined(IOV_MAX)
+#  define IOV_MAX 16
+#endif
+
 #define CUT_TYPE_XML_STREAM_FACTORY            cut_type_xml_stream_factory
 #define CUT_XML_STREAM_FACTORY(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), CUT_TYPE_XML_STREAM_FACTORY, CutXMLStreamFactory))
 #define CUT_XML_STREAM_FACTORY_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), CUT_TYPE_XML_STREAM_FACTORY, CutXMLStreamFactoryClass))
@@ -56,6 +65,7 @@ struct _CutXMLStreamFactory
 
     gint                 fd;
     gchar               *directory;
+    guint                buffer_size;
 };
 
 struct _CutXMLStreamFactoryClass
@@ -67,7 +77,8 @@ enum
 {
     PROP_0,
     PROP_FD,
-    PROP_DIRECTORY
+    PROP_DIRECTORY,
+    PROP_BUFFER_SIZE
 };
 
 static GType cut_type_xml_stream_factory = 0;
@@ -117,6 +128,14 @@ class_init (CutModuleFactoryClass *klass)
                                NULL,
                                G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
     g_object_class_install_property(gobject_class, PROP_DIRECTORY, spec);
+
+    spec = g_param_spec_uint("buffer-size",
+                             "Buffer size",
+                             "Bytes to buffer before streaming. "
+                             "0 streams each event immediately",
+                             0, G_MAXUINT, CUT_STREAM_DEFAULT_BUFFER_SIZE,
+                             G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
+    g_object_class_install_property(gobject_class, PROP_BUFFER_SIZE, spec);
 }
 
 static void
@@ -124,6 +143,7 @@ init (CutXMLStreamFactory *factory)
 {
     factory->fd = -1;
     factory->directory = NULL;
+    factory->buffer_size = CUT_STREAM_DEFAULT_BUFFER_SIZE;
 }
 
 static void
@@ -158,6 +178,9 @@ set_property (GObject      *object,
             g_free(factory->directory);
         factory->directory = g_value_dup_string(value);
         break;
+      case PROP_BUFFER_SIZE:
+        factory->buffer_size = g_value_get_uint(value);
+        break;
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -180,6 +203,9 @@ get_property (GObject    *object,
       case PROP_DIRECTORY:
         g_value_set_string(value, factory->directory);
         break;
+      case PROP_BUFFER_SIZE:
+        g_value_set_uint(value, factory->buffer_size);
+        break;
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -349,12 +375,8 @@ create_channels (StreamData *data, GError **error)
 }
 
 static gboolean
-stream (const gchar *message, GError **error, gpointer user_data)
+prepare_channels (StreamData *data, GError **error)
 {
-    StreamData *data = user_data;
-    GList *node;
-    gsize length;
-
     if (!data->initialized) {
         data->channels = create_channels(data, error);
         data->initialized = TRUE;
@@ -362,26 +384,42 @@ stream (const gchar *message, GError **error, gpointer user_data)
             return FALSE;
     }
 
-    if (!data->channels)
+    return data->channels != NULL;
+}
+
+static gboolean
+write_chars (GIOChannel *channel, const gchar *message, gsize length,
+             GError **error)
+{
+    while (length > 0) {
+        gsize written = 0;
+
+        g_io_channel_write_chars(channel, message, length, &written, error);
+        if (*error)
+            return FALSE;
+
+        message += written;
+        length -= written;
+    }
+
+    return TRUE;
+}
+
+static gboolean
+stream (const gchar *message, GError **error, gpointer user_data)
+{
+    StreamData *data = user_data;
+    GList *node;
+    gsize length;
+
+    if (!prepare_channels(data, error))
         return FALSE;
 
     length = strlen(message);
     for (node = data->channels; node; node = g_list_next(node)) {
         GIOChannel *channel = node->data;
-        gsize len, written;
-        const gchar *snippet;
-
-        len = length;
-        written = 0;
-        snippet = message;
-        while (len > 0) {
-            g_io_channel_write_chars(channel, snippet, len, &written, error);
-            if (*error)
-                break;
-
-            snippet += written;
-            len -= written;
-        }
+
+        write_chars(channel, message, length, error);
         g_io_channel_flush(channel, NULL);
 
         if (*error)
@@ -391,6 +429,86 @@ stream (const gchar *message, GError **error, gpointer user_data)
     return *error == NULL;
 }
 
+#ifdef HAVE_SYS_UIO_H
+static gboolean
+write_vector (GIOChannel *channel, const gchar **messages,
+              const gsize *lengths, guint n_messages, GError **error)
+{
+    struct iovec vector[IOV_MAX];
+    gint fd;
+    guint i = 0;
+    gsize offset = 0;
+
+    fd = g_io_channel_unix_get_fd(channel);
+    while (i < n_messages) {
+        gint n_vectors = 0;
+        guint j;
+        gssize written;
+
+        for (j = i; j < n_messages && n_vectors < IOV_MAX; j++) {
+            gsize skip = (j == i) ? offset : 0;
+
+            vector[n_vectors].iov_base = (gchar *)messages[j] + skip;
+            vector[n_vectors].iov_len = lengths[j] - skip;
+            n_vectors++;
+        }
+
+        written = writev(fd, vector, n_vectors);
+        if (written == -1) {
+            if (errno == EINTR)
+                continue;
+            g_set_error(error,
+                        G_IO_CHANNEL_ERROR,
+                        g_io_channel_error_from_errno(errno),
+                        "%s", g_strerror(errno));
+            return FALSE;
+        }
+
+        while (i < n_messages && offset + written >= lengths[i]) {
+            written -= lengths[i] - offset;
+            offset = 0;
+            i++;
+        }
+        offset += written;
+    }
+
+    return TRUE;
+}
+#else
+static gboolean
+write_vector (GIOChannel *channel, const gchar **messages,
+              const gsize *lengths, guint n_messages, GError **error)
+{
+    guint i;
+
+    for (i = 0; i < n_messages; i++) {
+        if (!write_chars(channel, messages[i], lengths[i], error))
+            break;
+    }
+    g_io_channel_flush(channel, NULL);
+
+    return *error == NULL;
+}
+#endif
+
+static gboolean
+stream_vector (const gchar **messages, const gsize *lengths, guint n_messages,
+               GError **error, gpointer user_data)
+{
+    StreamData *data = user_data;
+    GList *node;
+
+    if (!prepare_channels(data, error))
+        return FALSE;
+
+    for (node = data->channels; node; node = g_list_next(node)) {
+        if (!write_vector(node->data, messages, lengths, n_messages, error))
+            break;
+    }
+
+    return *error == NULL;
+}
+
 GObject *
 create (CutModuleFactory *factory)
 {
@@ -401,6 +519,8 @@ create (CutModuleFactory *factory)
     data = stream_data_new(xml_factory->fd, xml_factory->directory);
     return G_OBJECT(cut_stream_new("xml",
                                    "stream-function", stream,
+                                   "stream-vector-function", stream_vector,
+                                   "buffer-size", xml_factory->buffer_size,
                                    "stream-function-user-data", data,
                                    "stream-function-user-data-destroy-function",
                                    stream_data_free,
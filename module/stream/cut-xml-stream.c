@@ -55,6 +55,11 @@ struct _CutXMLStream
     CutStreamFunction stream_function;
     gpointer stream_function_user_data;
     GDestroyNotify stream_function_user_data_destroy_function;
+    CutStreamVectorFunction stream_vector_function;
+    guint buffer_size;
+    GPtrArray *messages;
+    GArray *lengths;
+    gsize buffered_size;
 };
 
 struct _CutXMLStreamClass
@@ -68,7 +73,9 @@ enum
     PROP_RUN_CONTEXT,
     PROP_STREAM_FUNCTION,
     PROP_STREAM_FUNCTION_USER_DATA,
-    PROP_STREAM_FUNCTION_USER_DATA_DESTROY_FUNCTION
+    PROP_STREAM_FUNCTION_USER_DATA_DESTROY_FUNCTION,
+    PROP_STREAM_VECTOR_FUNCTION,
+    PROP_BUFFER_SIZE
 };
 
 static GType cut_type_xml_stream = 0;
@@ -84,6 +91,8 @@ static void get_property   (GObject         *object,
                             GValue          *value,
                             GParamSpec      *pspec);
 
+static void flush          (CutXMLStream    *stream);
+
 static void attach_to_run_context             (CutListener *listener,
                                           CutRunContext   *run_context);
 static void detach_from_run_context           (CutListener *listener,
@@ -130,6 +139,21 @@ class_init (CutXMLStreamClass *klass)
     g_object_class_install_property(gobject_class,
                                     PROP_STREAM_FUNCTION_USER_DATA_DESTROY_FUNCTION,
                                     spec);
+
+    spec = g_param_spec_pointer("stream-vector-function",
+                                "Stream vector function",
+                                "A function to stream buffered data at once",
+                                G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property(gobject_class,
+                                    PROP_STREAM_VECTOR_FUNCTION, spec);
+
+    spec = g_param_spec_uint("buffer-size",
+                             "Buffer size",
+                             "Bytes to buffer before streaming. "
+                             "0 streams each event immediately",
+                             0, G_MAXUINT, CUT_STREAM_DEFAULT_BUFFER_SIZE,
+                             G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
+    g_object_class_install_property(gobject_class, PROP_BUFFER_SIZE, spec);
 }
 
 static void
@@ -140,6 +164,11 @@ init (CutXMLStream *stream)
     stream->stream_function = NULL;
     stream->stream_function_user_data = NULL;
     stream->stream_function_user_data_destroy_function = NULL;
+    stream->stream_vector_function = NULL;
+    stream->buffer_size = CUT_STREAM_DEFAULT_BUFFER_SIZE;
+    stream->messages = g_ptr_array_new();
+    stream->lengths = g_array_new(FALSE, FALSE, sizeof(gsize));
+    stream->buffered_size = 0;
 }
 
 static void
@@ -219,6 +248,17 @@ dispose (GObject *object)
         stream->run_context = NULL;
     }
 
+    if (stream->messages) {
+        flush(stream);
+        g_ptr_array_free(stream->messages, TRUE);
+        stream->messages = NULL;
+    }
+
+    if (stream->lengths) {
+        g_array_free(stream->lengths, TRUE);
+        stream->lengths = NULL;
+    }
+
     if (stream->mutex) {
         g_mutex_free(stream->mutex);
         stream->mutex = NULL;
@@ -256,6 +296,12 @@ set_property (GObject      *object,
         stream->stream_function_user_data_destroy_function =
             g_value_get_pointer(value);
         break;
+      case PROP_STREAM_VECTOR_FUNCTION:
+        stream->stream_vector_function = g_value_get_pointer(value);
+        break;
+      case PROP_BUFFER_SIZE:
+        stream->buffer_size = g_value_get_uint(value);
+        break;
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -283,6 +329,12 @@ get_property (GObject    *object,
       case PROP_STREAM_FUNCTION_USER_DATA_DESTROY_FUNCTION:
         g_value_set_pointer(value, stream->stream_function_user_data_destroy_function);
         break;
+      case PROP_STREAM_VECTOR_FUNCTION:
+        g_value_set_pointer(value, stream->stream_vector_function);
+        break;
+      case PROP_BUFFER_SIZE:
+        g_value_set_uint(value, stream->buffer_size);
+        break;
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -290,33 +342,115 @@ get_property (GObject    *object,
 }
 
 static void
-flow (CutXMLStream *stream, const gchar *format, ...)
+report_error (GError *error)
+{
+    g_warning("WriteError: %s:%d: %s",
+              g_quark_to_string(error->domain),
+              error->code,
+              error->message);
+    g_error_free(error);
+}
+
+/* must be called with stream->mutex locked */
+static void
+flush_messages (CutXMLStream *stream)
 {
     GError *error = NULL;
-    gchar *message;
-    va_list va_args;
+    guint i;
 
-    if (!stream->stream_function)
+    if (stream->messages->len == 0)
         return;
 
-    va_start(va_args, format);
-    message = g_strdup_vprintf(format, va_args);
-    va_end(va_args);
+    if (stream->stream_vector_function) {
+        stream->stream_vector_function((const gchar **)stream->messages->pdata,
+                                       (const gsize *)stream->lengths->data,
+                                       stream->messages->len,
+                                       &error,
+                                       stream->stream_function_user_data);
+    } else if (stream->messages->len == 1) {
+        stream->stream_function(g_ptr_array_index(stream->messages, 0),
+                                &error,
+                                stream->stream_function_user_data);
+    } else {
+        GString *buffer;
+
+        buffer = g_string_sized_new(stream->buffered_size);
+        for (i = 0; i < stream->messages->len; i++) {
+            g_string_append_len(buffer,
+                                g_ptr_array_index(stream->messages, i),
+                                g_array_index(stream->lengths, gsize, i));
+        }
+        stream->stream_function(buffer->str, &error,
+                                stream->stream_function_user_data);
+        g_string_free(buffer, TRUE);
+    }
+
+    for (i = 0; i < stream->messages->len; i++) {
+        g_free(g_ptr_array_index(stream->messages, i));
+    }
+    g_ptr_array_set_size(stream->messages, 0);
+    g_array_set_size(stream->lengths, 0);
+    stream->buffered_size = 0;
+
+    if (error)
+        report_error(error);
+}
 
+static void
+flush (CutXMLStream *stream)
+{
     g_mutex_lock(stream->mutex);
-    stream->stream_function(message, &error,
-                            stream->stream_function_user_data);
+    flush_messages(stream);
     g_mutex_unlock(stream->mutex);
+}
+
+/* The process may not survive a crash. */
+static void
+flush_if_crashed (CutXMLStream *stream, CutTestResult *result)
+{
+    if (cut_test_result_get_status(result) == CUT_TEST_RESULT_CRASH)
+        flush(stream);
+}
 
-    if (error) {
-        g_warning("WriteError: %s:%d: %s",
-                  g_quark_to_string(error->domain),
-                  error->code,
-                  error->message);
-        g_error_free(error);
+/* takes the ownership of message */
+static void
+flow_message (CutXMLStream *stream, gchar *message, gsize length)
+{
+    if (!stream->stream_function && !stream->stream_vector_function) {
+        g_free(message);
+        return;
     }
 
-    g_free(message);
+    g_mutex_lock(stream->mutex);
+    g_ptr_array_add(stream->messages, message);
+    g_array_append_val(stream->lengths, length);
+    stream->buffered_size += length;
+    if (stream->buffered_size >= stream->buffer_size)
+        flush_messages(stream);
+    g_mutex_unlock(stream->mutex);
+}
+
+/* takes the ownership of string */
+static void
+flow_string (CutXMLStream *stream, GString *string)
+{
+    gsize length;
+
+    length = string->len;
+    flow_message(stream, g_string_free(string, FALSE), length);
+}
+
+static void
+flow (CutXMLStream *stream, const gchar *format, ...)
+{
+    gchar *message;
+    va_list va_args;
+
+    va_start(va_args, format);
+    message = g_strdup_vprintf(format, va_args);
+    va_end(va_args);
+
+    flow_message(stream, message, strlen(message));
 }
 
 static void
@@ -349,9 +483,7 @@ cb_ready_test_suite (CutRunContext *run_context, CutTestSuite *test_suite,
 
     g_string_append(string, "  </ready-test-suite>\n");
 
-    flow(stream, "%s", string->str);
-
-    g_string_free(string, TRUE);
+    flow_string(stream, string);
 }
 
 static void
@@ -366,9 +498,7 @@ cb_start_test_suite (CutRunContext *run_context, CutTestSuite *test_suite,
     cut_test_to_xml_string(CUT_TEST(test_suite), string, 4);
     g_string_append(string, "  </start-test-suite>\n");
 
-    flow(stream, "%s", string->str);
-
-    g_string_free(string, TRUE);
+    flow_string(stream, string);
 }
 
 static void
@@ -390,9 +520,7 @@ cb_ready_test_case (CutRunContext *run_context, CutTestCase *test_case,
 
     g_string_append(string, "  </ready-test-case>\n");
 
-    flow(stream, "%s", string->str);
-
-    g_string_free(string, TRUE);
+    flow_string(stream, string);
 }
 
 static void
@@ -407,9 +535,7 @@ cb_start_test_case (CutRunContext *run_context, CutTestCase *test_case,
     cut_test_to_xml_string(CUT_TEST(test_case), string, 4);
     g_string_append(string, "  </start-test-case>\n");
 
-    flow(stream, "%s", string->str);
-
-    g_string_free(string, TRUE);
+    flow_string(stream, string);
 }
 
 static void
@@ -432,9 +558,7 @@ cb_ready_test_iterator (CutRunContext *run_context,
 
     g_string_append(string, "  </ready-test-iterator>\n");
 
-    flow(stream, "%s", string->str);
-
-    g_string_free(string, TRUE);
+    flow_string(stream, string);
 }
 
 static void
@@ -450,9 +574,7 @@ cb_start_test_iterator (CutRunContext *run_context,
     cut_test_to_xml_string(CUT_TEST(test_iterator), string, 4);
     g_string_append(string, "  </start-test-iterator>\n");
 
-    flow(stream, "%s", string->str);
-
-    g_string_free(string, TRUE);
+    flow_string(stream, string);
 }
 
 static void
@@ -470,9 +592,7 @@ cb_start_iterated_test (CutRunContext *run_context,
     cut_test_context_to_xml_string(test_context, string, 4);
     g_string_append(string, "  </start-iterated-test>\n");
 
-    flow(stream, "%s", string->str);
-
-    g_string_free(string, TRUE);
+    flow_string(stream, string);
 }
 
 static void
@@ -488,27 +608,33 @@ cb_start_test (CutRunContext *run_context, CutTest *test,
     cut_test_context_to_xml_string(test_context, string, 4);
     g_string_append(string, "  </start-test>\n");
 
-    flow(stream, "%s", string->str);
-
-    g_string_free(string, TRUE);
+    flow_string(stream, string);
 }
 
+/*
+ * Passed assertions are written in batch. The batch is
+ * flushed before the result and the completion of the test
+ * so readers can count them per test without an element for
+ * each assertion.
+ */
 static void
-cb_pass_assertion (CutRunContext *run_context, CutTest *test,
-                   CutTestContext *test_context, CutXMLStream *stream)
+cb_pass_assertions (CutRunContext *run_context, CutTest *test,
+                    CutTestContext *test_context, guint n_assertions,
+                    CutXMLStream *stream)
 {
     GString *string;
 
     string = g_string_new(NULL);
 
-    g_string_append(string, "  <pass-assertion>\n");
+    g_string_append(string, "  <pass-assertions>\n");
     cut_test_to_xml_string(test, string, 4);
     cut_test_context_to_xml_string(test_context, string, 4);
-    g_string_append(string, "  </pass-assertion>\n");
-
-    flow(stream, "%s", string->str);
+    g_string_append_printf(string,
+                           "    <n-assertions>%u</n-assertions>\n",
+                           n_assertions);
+    g_string_append(string, "  </pass-assertions>\n");
 
-    g_string_free(string, TRUE);
+    flow_string(stream, string);
 }
 
 static void
@@ -528,9 +654,8 @@ cb_test_result (CutRunContext  *run_context,
     cut_test_result_to_xml_string(result, string, 4);
     g_string_append(string, "  </test-result>\n");
 
-    flow(stream, "%s", string->str);
-
-    g_string_free(string, TRUE);
+    flow_string(stream, string);
+    flush_if_crashed(stream, result);
 }
 
 static void
@@ -550,9 +675,7 @@ cb_complete_test (CutRunContext *run_context, CutTest *test,
                                                     "success", success);
     g_string_append(string, "  </complete-test>\n");
 
-    flow(stream, "%s", string->str);
-
-    g_string_free(string, TRUE);
+    flow_string(stream, string);
 }
 
 static void
@@ -573,9 +696,7 @@ cb_complete_iterated_test (CutRunContext *run_context,
                                                     "success", success);
     g_string_append(string, "  </complete-iterated-test>\n");
 
-    flow(stream, "%s", string->str);
-
-    g_string_free(string, TRUE);
+    flow_string(stream, string);
 }
 
 static void
@@ -593,9 +714,8 @@ cb_test_iterator_result (CutRunContext  *run_context,
     cut_test_result_to_xml_string(result, string, 4);
     g_string_append(string, "  </test-iterator-result>\n");
 
-    flow(stream, "%s", string->str);
-
-    g_string_free(string, TRUE);
+    flow_string(stream, string);
+    flush_if_crashed(stream, result);
 }
 
 static void
@@ -614,9 +734,7 @@ cb_complete_test_iterator (CutRunContext *run_context,
                                                     "success", success);
     g_string_append(string, "  </complete-test-iterator>\n");
 
-    flow(stream, "%s", string->str);
-
-    g_string_free(string, TRUE);
+    flow_string(stream, string);
 }
 
 static void
@@ -634,9 +752,8 @@ cb_test_case_result (CutRunContext  *run_context,
     cut_test_result_to_xml_string(result, string, 4);
     g_string_append(string, "  </test-case-result>\n");
 
-    flow(stream, "%s", string->str);
-
-    g_string_free(string, TRUE);
+    flow_string(stream, string);
+    flush_if_crashed(stream, result);
 }
 
 static void
@@ -653,9 +770,8 @@ cb_complete_test_case (CutRunContext *run_context, CutTestCase *test_case,
                                                     "success", success);
     g_string_append(string, "  </complete-test-case>\n");
 
-    flow(stream, "%s", string->str);
-
-    g_string_free(string, TRUE);
+    flow_string(stream, string);
+    flush(stream);
 }
 
 static void
@@ -672,9 +788,8 @@ cb_complete_test_suite (CutRunContext *run_context, CutTestSuite *test_suite,
                                                     "success", success);
     g_string_append(string, "  </complete-test-suite>\n");
 
-    flow(stream, "%s", string->str);
-
-    g_string_free(string, TRUE);
+    flow_string(stream, string);
+    flush(stream);
 }
 
 static void
@@ -688,9 +803,8 @@ cb_complete_run (CutRunContext *run_context, gboolean success,
                                                     "success", success);
     g_string_append(string, "</stream>\n");
 
-    flow(stream, "%s", string->str);
-
-    g_string_free(string, TRUE);
+    flow_string(stream, string);
+    flush(stream);
 }
 
 static void
@@ -721,7 +835,7 @@ connect_to_run_context (CutXMLStream *stream, CutRunContext *run_context)
     CONNECT(start_iterated_test);
     CONNECT(start_test);
 
-    CONNECT(pass_assertion);
+    CONNECT(pass_assertions);
 
     CONNECT_TO_TEST(success);
     CONNECT_TO_TEST(failure);
@@ -775,7 +889,7 @@ disconnect_from_run_context (CutXMLStream *stream,
     DISCONNECT(start_iterated_test);
     DISCONNECT(start_test);
 
-    DISCONNECT(pass_assertion);
+    DISCONNECT(pass_assertions);
 
     g_signal_handlers_disconnect_by_func(run_context,
                                          G_CALLBACK(cb_test_result),
@@ -822,6 +936,7 @@ detach_from_run_context (CutListener *listener,
         return;
 
     disconnect_from_run_context(stream, run_context);
+    flush(stream);
     g_object_unref(stream->run_context);
     stream->run_context = NULL;
 }
@@ -52,6 +52,7 @@ struct _CutConsoleUIFactory
     CutVerboseLevel      verbose_level;
     gchar               *notify_command;
     gboolean             show_detail_immediately;
+    gint                 n_resource_usage_tests;
 };
 
 struct _CutConsoleUIFactoryClass
@@ -134,6 +135,7 @@ init (CutConsoleUIFactory *console)
     console->verbose_level = CUT_VERBOSE_LEVEL_NORMAL;
     console->notify_command = NULL;
     console->show_detail_immediately = TRUE;
+    console->n_resource_usage_tests = 5;
 }
 
 static void
@@ -424,6 +426,9 @@ set_option_group (CutModuleFactory *factory, GOptionContext *context)
         {"show-detail-immediately", 0, G_OPTION_FLAG_OPTIONAL_ARG,
          G_OPTION_ARG_CALLBACK, parse_show_detail_immediately,
          N_("Show test detail immediately"), "[yes|true|no|false]"},
+        {"show-resource-usage", 0, 0, G_OPTION_ARG_INT,
+         &(console->n_resource_usage_tests),
+         N_("Show top N tests by resource usage (0 disables)"), "N"},
         {NULL}
     };
 
@@ -452,6 +457,8 @@ create (CutModuleFactory *factory)
                                "progress-row-max", guess_term_width(),
                                "show-detail-immediately",
                                console->show_detail_immediately,
+                               "n-resource-usage-tests",
+                               console->n_resource_usage_tests,
                                NULL));
 }
 
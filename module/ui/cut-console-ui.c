@@ -54,6 +54,14 @@
     CUT_CONSOLE_COLOR_RED_BACK                  \
     CUT_CONSOLE_COLOR_WHITE
 
+typedef enum {
+    RESOURCE_CPU_TIME,
+    RESOURCE_MAX_RSS,
+    RESOURCE_PAGE_FAULTS,
+    RESOURCE_CONTEXT_SWITCHES,
+    RESOURCE_LAST
+} Resource;
+
 typedef struct _CutConsoleUI CutConsoleUI;
 typedef struct _CutConsoleUIClass CutConsoleUIClass;
 
@@ -65,9 +73,12 @@ struct _CutConsoleUI
     CutVerboseLevel verbose_level;
     gchar        *notify_command;
     GList        *errors;
+    GList        *benchmarks;
+    GPtrArray    *resource_usages[RESOURCE_LAST];
     gint          progress_row;
     gint          progress_row_max;
     gboolean      show_detail_immediately;
+    gint          n_resource_usage_tests;
 };
 
 struct _CutConsoleUIClass
@@ -82,9 +93,26 @@ enum
     PROP_VERBOSE_LEVEL,
     PROP_NOTIFY_COMMAND,
     PROP_PROGRESS_ROW_MAX,
-    PROP_SHOW_DETAIL_IMMEDIATELY
+    PROP_SHOW_DETAIL_IMMEDIATELY,
+    PROP_N_RESOURCE_USAGE_TESTS
 };
 
+#define N_RESOURCE_USAGE_TESTS_DEFAULT 5
+
+typedef struct _TestResourceUsage TestResourceUsage;
+struct _TestResourceUsage
+{
+    gchar *name;
+    CutResourceUsage usage;
+};
+
+static void
+test_resource_usage_free (TestResourceUsage *test_usage)
+{
+    g_free(test_usage->name);
+    g_free(test_usage);
+}
+
 static GType cut_type_console_ui = 0;
 static GObjectClass *parent_class;
 
@@ -159,18 +187,34 @@ class_init (CutConsoleUIClass *klass)
                                 G_PARAM_READWRITE);
     g_object_class_install_property(gobject_class, PROP_SHOW_DETAIL_IMMEDIATELY,
                                     spec);
+
+    spec = g_param_spec_int("n-resource-usage-tests",
+                            "The number of resource usage tests",
+                            "The number of tests shown for each resource "
+                            "in resource usage ranking",
+                            0, G_MAXINT, N_RESOURCE_USAGE_TESTS_DEFAULT,
+                            G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_N_RESOURCE_USAGE_TESTS,
+                                    spec);
 }
 
 static void
 init (CutConsoleUI *console)
 {
+    Resource resource;
+
     console->use_color = FALSE;
     console->verbose_level = CUT_VERBOSE_LEVEL_NORMAL;
     console->notify_command = NULL;
     console->errors = NULL;
+    console->benchmarks = NULL;
+    for (resource = 0; resource < RESOURCE_LAST; resource++) {
+        console->resource_usages[resource] = NULL;
+    }
     console->progress_row = 0;
     console->progress_row_max = -1;
     console->show_detail_immediately = TRUE;
+    console->n_resource_usage_tests = N_RESOURCE_USAGE_TESTS_DEFAULT;
 }
 
 static void
@@ -261,6 +305,7 @@ static void
 dispose (GObject *object)
 {
     CutConsoleUI *console;
+    Resource resource;
 
     console = CUT_CONSOLE_UI(object);
 
@@ -270,6 +315,25 @@ dispose (GObject *object)
         console->errors = NULL;
     }
 
+    if (console->benchmarks) {
+        g_list_foreach(console->benchmarks, (GFunc)g_free, NULL);
+        g_list_free(console->benchmarks);
+        console->benchmarks = NULL;
+    }
+
+    for (resource = 0; resource < RESOURCE_LAST; resource++) {
+        GPtrArray *usages = console->resource_usages[resource];
+        guint i;
+
+        if (!usages)
+            continue;
+        for (i = 0; i < usages->len; i++) {
+            test_resource_usage_free(g_ptr_array_index(usages, i));
+        }
+        g_ptr_array_free(usages, TRUE);
+        console->resource_usages[resource] = NULL;
+    }
+
     if (console->notify_command) {
         g_free(console->notify_command);
         console->notify_command = NULL;
@@ -304,6 +368,9 @@ set_property (GObject      *object,
     case PROP_SHOW_DETAIL_IMMEDIATELY:
         console->show_detail_immediately = g_value_get_boolean(value);
         break;
+    case PROP_N_RESOURCE_USAGE_TESTS:
+        console->n_resource_usage_tests = g_value_get_int(value);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -334,6 +401,9 @@ get_property (GObject    *object,
     case PROP_SHOW_DETAIL_IMMEDIATELY:
         g_value_set_boolean(value, console->show_detail_immediately);
         break;
+    case PROP_N_RESOURCE_USAGE_TESTS:
+        g_value_set_int(value, console->n_resource_usage_tests);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -736,15 +806,149 @@ cb_crash_test_suite (CutRunContext  *run_context,
     handle_crash(run_context, result, console);
 }
 
+static void
+collect_benchmark (CutConsoleUI *console, CutTest *test)
+{
+    const gchar *mean;
+    gchar *benchmark;
+
+    mean = cut_test_get_attribute(test, "benchmark-mean");
+    if (!mean)
+        return;
+
+    benchmark =
+        g_strdup_printf("%s: mean %s ns, median %s ns, "
+                        "stddev %s ns, min %s ns (%s iterations x %s samples)",
+                        cut_test_get_full_name(test),
+                        mean,
+                        cut_test_get_attribute(test, "benchmark-median"),
+                        cut_test_get_attribute(test, "benchmark-stddev"),
+                        cut_test_get_attribute(test, "benchmark-min"),
+                        cut_test_get_attribute(test, "benchmark-iterations"),
+                        cut_test_get_attribute(test, "benchmark-samples"));
+    console->benchmarks = g_list_append(console->benchmarks, benchmark);
+}
+
+static void
+print_phase_elapsed (const CutPhaseElapsed *phase_elapsed)
+{
+    CutTestPhase phase;
+    gboolean first = TRUE;
+
+    for (phase = 0; phase < CUT_TEST_PHASE_LAST; phase++) {
+        if (phase_elapsed->elapsed[phase] < 0)
+            continue;
+        g_print("%s%s: %.9f",
+                first ? " [" : ", ",
+                cut_test_phase_to_string(phase),
+                phase_elapsed->elapsed[phase] / 1e9);
+        first = FALSE;
+    }
+    if (!first)
+        g_print("]");
+}
+
+static gdouble
+resource_usage_value (const CutResourceUsage *usage, Resource resource)
+{
+    switch (resource) {
+    case RESOURCE_CPU_TIME:
+        return cut_resource_usage_get_cpu_time(usage);
+    case RESOURCE_MAX_RSS:
+        return usage->max_rss;
+    case RESOURCE_PAGE_FAULTS:
+        return usage->minor_faults + usage->major_faults;
+    case RESOURCE_CONTEXT_SWITCHES:
+        return usage->voluntary_context_switches +
+            usage->involuntary_context_switches;
+    default:
+        return 0.0;
+    }
+}
+
+/*
+ * Each ranking keeps only the top n_resource_usage_tests
+ * tests in descending order. Memory doesn't grow with the
+ * number of tests in a run.
+ */
+static void
+rank_resource_usage (CutConsoleUI *console, Resource resource,
+                     CutTest *test, const CutResourceUsage *usage)
+{
+    GPtrArray *usages;
+    TestResourceUsage *test_usage;
+    gdouble value;
+    guint i, j, n_tests;
+
+    value = resource_usage_value(usage, resource);
+    if (value <= 0.0)
+        return;
+
+    usages = console->resource_usages[resource];
+    if (!usages) {
+        usages = g_ptr_array_new();
+        console->resource_usages[resource] = usages;
+    }
+
+    for (i = usages->len; i > 0; i--) {
+        TestResourceUsage *ranked_usage = g_ptr_array_index(usages, i - 1);
+
+        if (resource_usage_value(&(ranked_usage->usage), resource) >= value)
+            break;
+    }
+    n_tests = console->n_resource_usage_tests;
+    if (i >= n_tests)
+        return;
+
+    while (usages->len >= n_tests) {
+        test_resource_usage_free(g_ptr_array_index(usages, usages->len - 1));
+        g_ptr_array_remove_index(usages, usages->len - 1);
+    }
+
+    test_usage = g_new(TestResourceUsage, 1);
+    test_usage->name = g_strdup(cut_test_get_full_name(test));
+    test_usage->usage = *usage;
+    g_ptr_array_add(usages, test_usage);
+    for (j = usages->len - 1; j > i; j--) {
+        usages->pdata[j] = usages->pdata[j - 1];
+    }
+    usages->pdata[i] = test_usage;
+}
+
+static void
+collect_resource_usage (CutConsoleUI *console, CutTest *test)
+{
+    const CutResourceUsage *usage;
+    Resource resource;
+
+    if (console->n_resource_usage_tests == 0)
+        return;
+
+    usage = cut_test_get_resource_usage(test);
+    if (!usage)
+        return;
+
+    for (resource = 0; resource < RESOURCE_LAST; resource++) {
+        rank_resource_usage(console, resource, test, usage);
+    }
+}
+
 static void
 cb_complete_test (CutRunContext *run_context, CutTest *test,
                   CutTestContext *test_context, gboolean success,
                   CutConsoleUI *console)
 {
+    if (console->verbose_level >= CUT_VERBOSE_LEVEL_NORMAL) {
+        collect_benchmark(console, test);
+        collect_resource_usage(console, test);
+    }
+
     if (console->verbose_level < CUT_VERBOSE_LEVEL_VERBOSE)
         return;
 
-    g_print(": (%f)\n", cut_test_get_elapsed(test));
+    g_print(": (%f", cut_test_get_elapsed(test));
+    print_phase_elapsed(cut_test_get_phase_elapsed(test));
+    g_print(")\n");
     fflush(stdout);
 }
 
@@ -992,6 +1196,98 @@ print_results (CutConsoleUI *console, CutRunContext *run_context)
     }
 }
 
+static void
+print_benchmarks (CutConsoleUI *console)
+{
+    GList *node;
+
+    if (!console->benchmarks)
+        return;
+
+    g_print("\nBenchmarks:\n");
+    for (node = console->benchmarks; node; node = g_list_next(node)) {
+        const gchar *benchmark = node->data;
+
+        g_print("  %s\n", benchmark);
+    }
+}
+
+static void
+print_resource_usage_value (const CutResourceUsage *usage, Resource resource)
+{
+    switch (resource) {
+    case RESOURCE_CPU_TIME:
+        g_print("%f (user: %f, system: %f)",
+                cut_resource_usage_get_cpu_time(usage),
+                usage->user_time, usage->system_time);
+        break;
+    case RESOURCE_MAX_RSS:
+        g_print("%" G_GUINT64_FORMAT "KiB", usage->max_rss);
+        break;
+    case RESOURCE_PAGE_FAULTS:
+        g_print("%" G_GUINT64_FORMAT " (major: %" G_GUINT64_FORMAT ")",
+                usage->minor_faults + usage->major_faults,
+                usage->major_faults);
+        break;
+    case RESOURCE_CONTEXT_SWITCHES:
+        g_print("%" G_GUINT64_FORMAT " (involuntary: %" G_GUINT64_FORMAT ")",
+                usage->voluntary_context_switches +
+                usage->involuntary_context_switches,
+                usage->involuntary_context_switches);
+        break;
+    default:
+        break;
+    }
+}
+
+static void
+print_resource_usage_ranking (CutConsoleUI *console,
+                              Resource resource, const gchar *label)
+{
+    GPtrArray *usages;
+    guint i;
+
+    usages = console->resource_usages[resource];
+    if (!usages)
+        return;
+
+    for (i = 0;
+         i < (guint)console->n_resource_usage_tests && i < usages->len;
+         i++) {
+        TestResourceUsage *test_usage = g_ptr_array_index(usages, i);
+
+        if (i == 0)
+            g_print("  %s:\n", label);
+        g_print("    ");
+        print_resource_usage_value(&(test_usage->usage), resource);
+        g_print(": %s\n", test_usage->name);
+    }
+}
+
+static void
+print_resource_usages (CutConsoleUI *console)
+{
+    Resource resource;
+
+    for (resource = 0; resource < RESOURCE_LAST; resource++) {
+        if (console->resource_usages[resource])
+            break;
+    }
+    if (resource == RESOURCE_LAST)
+        return;
+
+    g_print("\nResource usage (top %d):\n",
+            console->n_resource_usage_tests);
+    print_resource_usage_ranking(console, RESOURCE_CPU_TIME,
+                                 "CPU time (seconds)");
+    print_resource_usage_ranking(console, RESOURCE_MAX_RSS,
+                                 "Max RSS growth");
+    print_resource_usage_ranking(console, RESOURCE_PAGE_FAULTS,
+                                 "Page faults");
+    print_resource_usage_ranking(console, RESOURCE_CONTEXT_SWITCHES,
+                                 "Context switches");
+}
+
 static gdouble
 compute_pass_percentage (CutRunContext *run_context)
 {
@@ -1257,6 +1553,8 @@ cb_complete_run (CutRunContext *run_context, gboolean success,
         g_print("\n");
 
     print_results(console, run_context);
+    print_benchmarks(console);
+    print_resource_usages(console);
 
     g_print("\n");
     g_print("Finished in %f seconds (total: %f seconds)",
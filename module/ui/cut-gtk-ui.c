@@ -1260,14 +1260,14 @@ update_summary (CutGtkUI *ui)
 }
 
 static void
-cb_pass_assertion (CutRunContext *run_context,
-                   CutTest *test, CutTestContext *test_context,
-                   gpointer data)
+cb_pass_assertions (CutRunContext *run_context,
+                    CutTest *test, CutTestContext *test_context,
+                    guint n_assertions, gpointer data)
 {
     RowInfo *row_info = data;
 
     /* slow */
-    if (g_random_int_range(0, 1000) == 0) {
+    if (g_random_int_range(0, 1000) < (gint)n_assertions) {
         update_summary(row_info->ui);
     }
 }
@@ -1403,7 +1403,7 @@ cb_complete_test (CutRunContext *run_context,
     g_signal_handlers_disconnect_by_func(run_context,                   \
                                          G_CALLBACK(cb_ ## name),       \
                                          user_data)
-    DISCONNECT(pass_assertion, row_info);
+    DISCONNECT(pass_assertions, row_info);
     DISCONNECT(success_test, row_info);
     DISCONNECT(failure_test, row_info);
     DISCONNECT(error_test, row_info);
@@ -1450,7 +1450,7 @@ cb_start_test (CutRunContext *run_context,
 #define CONNECT(name, user_data)                                        \
     g_signal_connect(run_context, #name, G_CALLBACK(cb_ ## name), user_data)
 
-    CONNECT(pass_assertion, row_info);
+    CONNECT(pass_assertions, row_info);
     CONNECT(success_test, row_info);
     CONNECT(failure_test, row_info);
     CONNECT(error_test, row_info);
@@ -1498,7 +1498,7 @@ cb_complete_iterated_test (CutRunContext *run_context,
     g_signal_handlers_disconnect_by_func(run_context,                   \
                                          G_CALLBACK(cb_ ## name),       \
                                          user_data)
-    DISCONNECT(pass_assertion, row_info);
+    DISCONNECT(pass_assertions, row_info);
     DISCONNECT(success_test, row_info);
     DISCONNECT(failure_test, row_info);
     DISCONNECT(error_test, row_info);
@@ -1552,7 +1552,7 @@ cb_start_iterated_test (CutRunContext *run_context,
 #define CONNECT(name, user_data)                                        \
     g_signal_connect(run_context, #name, G_CALLBACK(cb_ ## name), user_data)
 
-    CONNECT(pass_assertion, row_info);
+    CONNECT(pass_assertions, row_info);
     CONNECT(success_test, row_info);
     CONNECT(failure_test, row_info);
     CONNECT(error_test, row_info);
@@ -0,0 +1,243 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <utime.h>
+#include <glib/gstdio.h>
+#include <gcutter.h>
+#include <cutter/cut-analyzer.h>
+
+#include "../lib/cuttest-utils.h"
+
+void data_analyze(void);
+void test_analyze(gconstpointer data);
+void test_analyze_with_index(void);
+void test_analyze_new_log(void);
+void test_analyze_invalid_log(void);
+
+static CutAnalyzer *analyzer;
+static gchar *tmp_dir;
+
+static void
+copy_log (const gchar *log_name)
+{
+    GError *error = NULL;
+    gchar *contents;
+    gsize length;
+    const gchar *source, *destination;
+
+    source = cut_take_string(g_build_filename(cuttest_get_base_dir(),
+                                              "fixtures",
+                                              "test-history",
+                                              log_name,
+                                              NULL));
+    destination = cut_take_string(g_build_filename(tmp_dir, log_name, NULL));
+    g_file_get_contents(source, &contents, &length, &error);
+    gcut_assert_error(error);
+    g_file_set_contents(destination, contents, length, &error);
+    g_free(contents);
+    gcut_assert_error(error);
+}
+
+void
+cut_setup (void)
+{
+    analyzer = cut_analyzer_new();
+
+    tmp_dir = g_build_filename(cuttest_get_base_dir(),
+                               "tmp-analyzer",
+                               NULL);
+    cut_remove_path(tmp_dir, NULL);
+    if (g_mkdir_with_parents(tmp_dir, 0700) == -1)
+        cut_error_errno();
+
+    copy_log("2014-01-01-00-00-00.xml");
+    copy_log("2014-01-02-00-00-00.xml");
+}
+
+void
+cut_teardown (void)
+{
+    if (analyzer)
+        g_object_unref(analyzer);
+    if (tmp_dir) {
+        cut_remove_path(tmp_dir, NULL);
+        g_free(tmp_dir);
+    }
+}
+
+static const GList *
+log_names (void)
+{
+    const GList *node;
+    GList *names = NULL;
+
+    for (node = cut_analyzer_get_run_summaries(analyzer);
+         node;
+         node = g_list_next(node)) {
+        CutRunSummary *summary = node->data;
+        names = g_list_append(names, summary->log_name);
+    }
+
+    return gcut_take_list(names, NULL);
+}
+
+static gdouble
+test_elapsed (const gchar *log_name,
+              const gchar *test_case_name, const gchar *test_name)
+{
+    const GList *node;
+
+    for (node = cut_analyzer_get_run_summaries(analyzer);
+         node;
+         node = g_list_next(node)) {
+        CutRunSummary *summary = node->data;
+        CutTestSummary *test;
+
+        if (strcmp(summary->log_name, log_name) != 0)
+            continue;
+        test = cut_run_summary_find_test(summary, test_case_name, test_name);
+        if (!test)
+            break;
+        return test->elapsed;
+    }
+
+    return -1.0;
+}
+
+void
+data_analyze (void)
+{
+    cut_add_data("sequential", GINT_TO_POINTER(1), NULL,
+                 "parallel", GINT_TO_POINTER(4), NULL);
+}
+
+void
+test_analyze (gconstpointer data)
+{
+    GError *error = NULL;
+    const gchar *index_file;
+
+    copy_log("2014-01-03-00-00-00.xml");
+    cut_analyzer_set_max_threads(analyzer, GPOINTER_TO_INT(data));
+    cut_assert_true(cut_analyzer_analyze(analyzer, tmp_dir, &error));
+    gcut_assert_error(error);
+
+    gcut_assert_equal_list_string(
+        gcut_take_new_list_string("2014-01-03-00-00-00.xml",
+                                  "2014-01-02-00-00-00.xml",
+                                  "2014-01-01-00-00-00.xml",
+                                  NULL),
+        log_names());
+    cut_assert_equal_double(3.0, 0.0,
+                            test_elapsed("2014-01-01-00-00-00.xml",
+                                         "test_slow", "test_run"));
+    cut_assert_equal_double(0.3, 0.0001,
+                            test_elapsed("2014-01-02-00-00-00.xml",
+                                         "test_fast", "test_run"));
+
+    index_file = cut_take_string(g_build_filename(tmp_dir,
+                                                  "summary-index",
+                                                  NULL));
+    cut_assert_path_exist(index_file);
+}
+
+void
+test_analyze_with_index (void)
+{
+    GError *error = NULL;
+    const gchar *log_file;
+    struct stat buffer;
+    struct utimbuf times;
+    gchar *garbage;
+
+    cut_assert_true(cut_analyzer_analyze(analyzer, tmp_dir, &error));
+    gcut_assert_error(error);
+    g_object_unref(analyzer);
+    analyzer = NULL;
+
+    log_file = cut_take_string(g_build_filename(tmp_dir,
+                                                "2014-01-01-00-00-00.xml",
+                                                NULL));
+    if (g_stat(log_file, &buffer) == -1)
+        cut_error_errno();
+    garbage = g_strnfill(buffer.st_size, 'x');
+    g_file_set_contents(log_file, garbage, buffer.st_size, &error);
+    g_free(garbage);
+    gcut_assert_error(error);
+    times.actime = buffer.st_atime;
+    times.modtime = buffer.st_mtime;
+    if (utime(log_file, &times) == -1)
+        cut_error_errno();
+
+    analyzer = cut_analyzer_new();
+    cut_assert_true(cut_analyzer_analyze(analyzer, tmp_dir, &error));
+    gcut_assert_error(error);
+    cut_assert_equal_double(3.0, 0.0,
+                            test_elapsed("2014-01-01-00-00-00.xml",
+                                         "test_slow", "test_run"));
+}
+
+void
+test_analyze_new_log (void)
+{
+    GError *error = NULL;
+
+    cut_assert_true(cut_analyzer_analyze(analyzer, tmp_dir, &error));
+    gcut_assert_error(error);
+    g_object_unref(analyzer);
+    analyzer = NULL;
+
+    copy_log("2014-01-03-00-00-00.xml");
+    analyzer = cut_analyzer_new();
+    cut_assert_true(cut_analyzer_analyze(analyzer, tmp_dir, &error));
+    gcut_assert_error(error);
+    gcut_assert_equal_list_string(
+        gcut_take_new_list_string("2014-01-03-00-00-00.xml",
+                                  "2014-01-02-00-00-00.xml",
+                                  "2014-01-01-00-00-00.xml",
+                                  NULL),
+        log_names());
+    cut_assert_equal_double(2.0, 0.0,
+                            test_elapsed("2014-01-03-00-00-00.xml",
+                                         "test_slow", "test_run"));
+}
+
+void
+test_analyze_invalid_log (void)
+{
+    GError *error = NULL;
+    const gchar *log_file;
+
+    log_file = cut_take_string(g_build_filename(tmp_dir,
+                                                "2014-01-04-00-00-00.xml",
+                                                NULL));
+    g_file_set_contents(log_file, "<stream><unknown>", -1, &error);
+    gcut_assert_error(error);
+
+    cut_assert_false(cut_analyzer_analyze(analyzer, tmp_dir, &error));
+    cut_assert_not_null(error);
+    g_error_free(error);
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
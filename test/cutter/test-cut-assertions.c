@@ -116,6 +116,8 @@ void test_operator_uint(void);
 void test_operator_size(void);
 void test_operator_double(void);
 void test_equal_memory (void);
+void test_equal_memory_large (void);
+void test_equal_memory_large_full_dump (void);
 void test_not_equal_memory (void);
 void test_equal_string_array (void);
 void test_null(void);
@@ -143,6 +145,7 @@ void test_equal_fixture_data_string_without_file (void);
 void test_error_errno (void);
 void test_equal_sockaddr (void);
 void test_equal_file_raw (void);
+void test_equal_file_raw_large (void);
 void test_not_equal_file_raw (void);
 
 static gboolean compare_function_is_called;
@@ -152,6 +155,7 @@ static CutTest *test;
 static CutRunContext *run_context;
 static CutTestContext *test_context;
 static CutTestResult *test_result;
+static gboolean full_memory_dump;
 
 static gint fail_line;
 
@@ -191,6 +195,7 @@ run (void)
     cut_assert_not_null(test);
 
     run_context = cut_test_runner_new();
+    cut_run_context_set_full_memory_dump(run_context, full_memory_dump);
 
     test_context = cut_test_context_new(run_context, NULL, NULL, NULL, test);
     cut_test_context_set_fixture_data_dir(test_context,
@@ -213,6 +218,7 @@ cut_setup (void)
     run_context = NULL;
     test_context = NULL;
     test_result = NULL;
+    full_memory_dump = FALSE;
     fail_line = 0;
 }
 
@@ -1934,6 +1940,128 @@ test_equal_memory (void)
                            NULL);
 }
 
+#define LARGE_MEMORY_SIZE 2048
+
+static void
+stub_equal_memory_large (void)
+{
+    static gchar expected[LARGE_MEMORY_SIZE];
+    static gchar actual[LARGE_MEMORY_SIZE];
+
+    memset(expected, 0, sizeof(expected));
+    memset(actual, 0, sizeof(actual));
+    cut_assert_equal_memory(expected, sizeof(expected),
+                            actual, sizeof(actual));
+    actual[100] = 'A';
+    MARK_FAIL(cut_assert_equal_memory(expected, sizeof(expected),
+                                      actual, sizeof(actual)));
+}
+
+#define ZERO_ROW(offset)                                                \
+    offset ": 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00  "        \
+    "................"
+
+void
+test_equal_memory_large (void)
+{
+    test = cut_test_new("stub-equal-memory-large", stub_equal_memory_large);
+    cut_assert_false(run());
+    cut_assert_test_result_summary(run_context, 1, 1, 0, 1, 0, 0, 0, 0);
+    cut_assert_test_result(run_context, 0, CUT_TEST_RESULT_FAILURE,
+                           "stub-equal-memory-large", NULL,
+                           "<expected(size: sizeof(expected)) == "
+                           "actual(size: sizeof(actual))>: "
+                           "1 byte(s) differ "
+                           "between 0x00000064 and 0x00000064",
+                           "...\n"
+                           ZERO_ROW("0x00000040") "\n"
+                           ZERO_ROW("0x00000050") "\n"
+                           ZERO_ROW("0x00000060") "\n"
+                           ZERO_ROW("0x00000070") "\n"
+                           ZERO_ROW("0x00000080") "\n"
+                           "...\n"
+                           "(size: 2048)",
+                           "...\n"
+                           ZERO_ROW("0x00000040") "\n"
+                           ZERO_ROW("0x00000050") "\n"
+                           "0x00000060: "
+                           "00 00 00 00 41 00 00 00 00 00 00 00 00 00 00 00  "
+                           "....A...........\n"
+                           ZERO_ROW("0x00000070") "\n"
+                           ZERO_ROW("0x00000080") "\n"
+                           "...\n"
+                           "(size: 2048)",
+                           FAIL_LOCATION,
+                           FUNCTION("stub_equal_memory_large"),
+                           NULL);
+}
+
+#undef ZERO_ROW
+
+static void
+stub_equal_memory_large_full_dump (void)
+{
+    static gchar expected[LARGE_MEMORY_SIZE];
+    static gchar actual[LARGE_MEMORY_SIZE + 1];
+
+    memset(expected, 0, sizeof(expected));
+    memset(actual, 0, sizeof(actual));
+    MARK_FAIL(cut_assert_equal_memory(expected, sizeof(expected),
+                                      actual, sizeof(actual)));
+}
+
+static const gchar *
+zero_memory_dump (gsize size, const gchar *tail)
+{
+    GString *dump;
+    gsize offset;
+
+    dump = g_string_new(NULL);
+    for (offset = 0; offset < size; offset += 16) {
+        g_string_append_printf(dump,
+                               "0x%08" G_GSIZE_MODIFIER "x: "
+                               "00 00 00 00 00 00 00 00 "
+                               "00 00 00 00 00 00 00 00  "
+                               "................\n",
+                               offset);
+    }
+    g_string_append(dump, tail);
+
+    return cut_take_string(g_string_free(dump, FALSE));
+}
+
+void
+test_equal_memory_large_full_dump (void)
+{
+    const gchar *expected, *actual;
+
+    expected = zero_memory_dump(LARGE_MEMORY_SIZE, "(size: 2048)");
+    actual = zero_memory_dump(LARGE_MEMORY_SIZE,
+                              "0x00000800: 00"
+                              "                                               "
+                              ".\n"
+                              "(size: 2049)");
+
+    full_memory_dump = TRUE;
+    test = cut_test_new("stub-equal-memory-large-full-dump",
+                        stub_equal_memory_large_full_dump);
+    cut_assert_false(run());
+    cut_assert_test_result_summary(run_context, 1, 0, 0, 1, 0, 0, 0, 0);
+    cut_assert_test_result(run_context, 0, CUT_TEST_RESULT_FAILURE,
+                           "stub-equal-memory-large-full-dump", NULL,
+                           "<expected(size: sizeof(expected)) == "
+                           "actual(size: sizeof(actual))>: "
+                           "1 byte(s) differ "
+                           "between 0x00000800 and 0x00000800",
+                           expected,
+                           actual,
+                           FAIL_LOCATION,
+                           FUNCTION("stub_equal_memory_large_full_dump"),
+                           NULL);
+}
+
+#undef LARGE_MEMORY_SIZE
+
 static void
 stub_not_equal_memory (void)
 {
@@ -2594,6 +2722,85 @@ test_equal_file_raw (void)
                            NULL);
 }
 
+static void
+equal_file_raw_large (void)
+{
+    const gchar *data, *sub_data;
+
+    data = cut_build_path(cuttest_get_base_dir(),
+                          "fixtures", "assertions", "large-data.txt", NULL);
+    sub_data = cut_build_path(cuttest_get_base_dir(),
+                              "fixtures", "assertions", "sub", "large-data.txt",
+                              NULL);
+    cut_assert_equal_file_raw(data, data);
+    MARK_FAIL(cut_assert_equal_file_raw(data, sub_data));
+}
+
+void
+test_equal_file_raw_large (void)
+{
+    const gchar *data, *sub_data;
+
+    data = cut_build_path(cuttest_get_base_dir(),
+                          "fixtures", "assertions", "large-data.txt", NULL);
+    sub_data = cut_build_path(cuttest_get_base_dir(),
+                              "fixtures", "assertions", "sub", "large-data.txt",
+                              NULL);
+
+    test = cut_test_new("equal-file-raw-large", equal_file_raw_large);
+
+    cut_assert_false(run());
+    cut_assert_test_result_summary(run_context, 1, 5, 0, 1, 0, 0, 0, 0);
+    cut_assert_test_result(
+        run_context, 0, CUT_TEST_RESULT_FAILURE,
+        "equal-file-raw-large", NULL,
+        "<content(data) == content(sub_data)>: "
+        "4 byte(s) differ between 0x00000200 and 0x00000203",
+        cut_take_printf("path: <%s>\n"
+                        "...\n"
+                        "0x000001e0: "
+                        "64 61 74 61 20 6c 69 6e 65 3a 20 30 30 33 30 0a  "
+                        "data line: 0030.\n"
+                        "0x000001f0: "
+                        "64 61 74 61 20 6c 69 6e 65 3a 20 30 30 33 31 0a  "
+                        "data line: 0031.\n"
+                        "0x00000200: "
+                        "64 61 74 61 20 6c 69 6e 65 3a 20 30 30 33 32 0a  "
+                        "data line: 0032.\n"
+                        "0x00000210: "
+                        "64 61 74 61 20 6c 69 6e 65 3a 20 30 30 33 33 0a  "
+                        "data line: 0033.\n"
+                        "0x00000220: "
+                        "64 61 74 61 20 6c 69 6e 65 3a 20 30 30 33 34 0a  "
+                        "data line: 0034.\n"
+                        "...\n"
+                        "(size: 1040)",
+                        data),
+        cut_take_printf("path: <%s>\n"
+                        "...\n"
+                        "0x000001e0: "
+                        "64 61 74 61 20 6c 69 6e 65 3a 20 30 30 33 30 0a  "
+                        "data line: 0030.\n"
+                        "0x000001f0: "
+                        "64 61 74 61 20 6c 69 6e 65 3a 20 30 30 33 31 0a  "
+                        "data line: 0031.\n"
+                        "0x00000200: "
+                        "44 41 54 41 20 6c 69 6e 65 3a 20 30 30 33 32 0a  "
+                        "DATA line: 0032.\n"
+                        "0x00000210: "
+                        "64 61 74 61 20 6c 69 6e 65 3a 20 30 30 33 33 0a  "
+                        "data line: 0033.\n"
+                        "0x00000220: "
+                        "64 61 74 61 20 6c 69 6e 65 3a 20 30 30 33 34 0a  "
+                        "data line: 0034.\n"
+                        "...\n"
+                        "(size: 1040)",
+                        sub_data),
+        FAIL_LOCATION,
+        FUNCTION("equal_file_raw_large"),
+        NULL);
+}
+
 static void
 not_equal_file_raw (void)
 {
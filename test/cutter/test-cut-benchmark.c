@@ -0,0 +1,158 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gcutter.h>
+#include <cutter/cut-benchmark.h>
+#include <cutter/cut-test-runner.h>
+
+void data_is_target(void);
+void test_is_target(gconstpointer data);
+void test_run_not_target(void);
+void test_run_target(void);
+void test_run_min_time_attribute(void);
+
+static CutRunContext *run_context;
+static CutBenchmark *benchmark;
+static gint n_calls = 0;
+
+static void
+stub_benchmark_function (void)
+{
+    n_calls++;
+}
+
+void
+cut_setup (void)
+{
+    n_calls = 0;
+    run_context = CUT_RUN_CONTEXT(cut_test_runner_new());
+    benchmark = cut_benchmark_new("bench_count", stub_benchmark_function);
+}
+
+void
+cut_teardown (void)
+{
+    if (benchmark)
+        g_object_unref(benchmark);
+    g_object_unref(run_context);
+}
+
+static gboolean
+run (void)
+{
+    gboolean success;
+    CutTest *test;
+    CutTestContext *test_context;
+
+    test = CUT_TEST(benchmark);
+    test_context = cut_test_context_new(run_context, NULL, NULL, NULL, test);
+    cut_test_context_current_push(test_context);
+    success = cut_test_run(test, test_context, run_context);
+    cut_test_context_current_pop();
+
+    g_object_unref(test_context);
+
+    return success;
+}
+
+static void
+set_filter (const gchar *name)
+{
+    const gchar *filter[] = {name, NULL};
+
+    cut_run_context_set_benchmark_filter(run_context, filter);
+}
+
+void
+data_is_target (void)
+{
+#define ADD(label, expected, filter)                                    \
+    gcut_add_datum(label,                                               \
+                   "expected", G_TYPE_BOOLEAN, expected,                \
+                   "filter", G_TYPE_STRING, filter,                     \
+                   NULL)
+
+    ADD("no filter", FALSE, NULL);
+    ADD("name", TRUE, "bench_count");
+    ADD("regexp", TRUE, "/count/");
+    ADD("not match", FALSE, "bench_other");
+
+#undef ADD
+}
+
+void
+test_is_target (gconstpointer data)
+{
+    const gchar *filter;
+
+    filter = gcut_data_get_string(data, "filter");
+    if (filter)
+        set_filter(filter);
+    cut_assert_equal_boolean(gcut_data_get_boolean(data, "expected"),
+                             cut_benchmark_is_target(benchmark, run_context));
+}
+
+void
+test_run_not_target (void)
+{
+    cut_assert_true(run());
+    cut_assert_equal_int(1, n_calls);
+    cut_assert_null(cut_test_get_attribute(CUT_TEST(benchmark),
+                                           "benchmark-mean"));
+}
+
+void
+test_run_target (void)
+{
+    CutTest *test;
+
+    set_filter("bench_count");
+    cut_run_context_set_benchmark_min_time(run_context, 0.01);
+    cut_assert_true(run());
+
+    test = CUT_TEST(benchmark);
+    cut_assert_operator_int(n_calls, >, 11);
+    cut_assert_equal_string("10",
+                            cut_test_get_attribute(test, "benchmark-samples"));
+    cut_assert_not_null(cut_test_get_attribute(test, "benchmark-iterations"));
+    cut_assert_not_null(cut_test_get_attribute(test, "benchmark-mean"));
+    cut_assert_not_null(cut_test_get_attribute(test, "benchmark-median"));
+    cut_assert_not_null(cut_test_get_attribute(test, "benchmark-stddev"));
+    cut_assert_not_null(cut_test_get_attribute(test, "benchmark-min"));
+}
+
+void
+test_run_min_time_attribute (void)
+{
+    CutTest *test;
+
+    test = CUT_TEST(benchmark);
+    set_filter("bench_count");
+    cut_test_set_attribute(test, "benchmark-min-time", "0");
+    cut_assert_true(run());
+
+    cut_assert_equal_string("1",
+                            cut_test_get_attribute(test,
+                                                   "benchmark-iterations"));
+    cut_assert_equal_int(1 + 1 + 10, n_calls);
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
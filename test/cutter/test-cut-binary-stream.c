@@ -0,0 +1,301 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gcutter.h>
+#include <cutter/cut-test-runner.h>
+#include <cutter/cut-listener.h>
+#include <cutter/cut-stream.h>
+#include <cutter/cut-stream-parser.h>
+#include <cutter/cut-binary-stream-parser.h>
+#include "../lib/cuttest-event-receiver.h"
+
+void test_success (void);
+void test_failure (void);
+void test_iterated_test (void);
+void test_split_chunks (void);
+void test_invalid_magic (void);
+void test_truncated (void);
+
+static CutStream *stream;
+static CutRunContext *run_context;
+static CutTestCase *test_case;
+static CutTestSuite *test_suite;
+static CutTestContext *test_context;
+static CutStreamParser *parser;
+static CutRunContext *receiver_context;
+static CuttestEventReceiver *receiver;
+
+static GString *binary;
+
+static void
+stub_success_test (void)
+{
+    cut_assert_true(TRUE);
+    cut_assert_true(TRUE);
+}
+
+static void
+stub_failure_test (void)
+{
+    cut_assert_equal_string("expected", "actual");
+}
+
+static void
+stub_iterated_data (void)
+{
+    cut_add_data("first data", NULL, NULL,
+                 "second data", NULL, NULL,
+                 NULL);
+}
+
+static void
+stub_iterated_test (gconstpointer data)
+{
+    cut_assert_true(TRUE);
+}
+
+void
+cut_setup (void)
+{
+    const gchar *test_names[] = {"/.*/", NULL};
+
+    stream = NULL;
+    test_context = NULL;
+
+    run_context = CUT_RUN_CONTEXT(cut_test_runner_new());
+    cut_run_context_set_target_test_names(run_context, test_names);
+
+    test_case = cut_test_case_new("stub test case",
+                                  NULL, NULL, NULL, NULL);
+    test_suite = cut_test_suite_new_empty();
+    cut_test_suite_add_test_case(test_suite, test_case);
+
+    receiver_context = cuttest_event_receiver_new();
+    receiver = CUTTEST_EVENT_RECEIVER(receiver_context);
+    parser = cut_stream_parser_new(receiver_context);
+
+    binary = g_string_new(NULL);
+}
+
+void
+cut_teardown (void)
+{
+    if (test_context)
+        g_object_unref(test_context);
+    if (stream)
+        g_object_unref(stream);
+    g_object_unref(test_case);
+    g_object_unref(test_suite);
+    g_object_unref(run_context);
+    g_object_unref(parser);
+    g_object_unref(receiver);
+    g_string_free(binary, TRUE);
+}
+
+static gboolean
+stream_to_string (const gchar *data, gsize length, GError **error,
+                  gpointer user_data)
+{
+    GString *string = user_data;
+
+    g_string_append_len(string, data, length);
+
+    return TRUE;
+}
+
+static gboolean
+run (void)
+{
+    gboolean success;
+
+    stream = cut_stream_new("binary",
+                            "stream-write-function", stream_to_string,
+                            "stream-write-function-user-data", binary,
+                            NULL);
+    cut_listener_attach_to_run_context(CUT_LISTENER(stream), run_context);
+
+    test_context = cut_test_context_new(run_context,
+                                        NULL, test_case, NULL, NULL);
+    cut_test_context_current_push(test_context);
+    success = cut_test_runner_run_test_suite(CUT_TEST_RUNNER(run_context),
+                                             test_suite);
+    cut_test_context_current_pop();
+
+    cut_listener_detach_from_run_context(CUT_LISTENER(stream), run_context);
+
+    return success;
+}
+
+#define cut_assert_parse(data, length) do                       \
+{                                                               \
+    GError *error = NULL;                                       \
+    cut_stream_parser_parse(parser, (data), (length), &error);  \
+    gcut_assert_error(error);                                   \
+    cut_stream_parser_end_parse(parser, &error);                \
+    gcut_assert_error(error);                                   \
+} while (0)
+
+static void
+assert_magic (void)
+{
+    cut_assert_operator_int(strlen(CUT_BINARY_STREAM_MAGIC), <=, binary->len);
+    cut_assert_equal_memory(CUT_BINARY_STREAM_MAGIC,
+                            strlen(CUT_BINARY_STREAM_MAGIC),
+                            binary->str,
+                            strlen(CUT_BINARY_STREAM_MAGIC));
+}
+
+void
+test_success (void)
+{
+    CuttestStartTestInfo *start_info;
+    CuttestCompleteTestInfo *complete_info;
+
+    cut_test_case_add_test(test_case,
+                           cut_test_new("stub-success-test",
+                                        stub_success_test));
+    cut_assert_true(run());
+    assert_magic();
+
+    cut_assert_parse(binary->str, binary->len);
+    cut_assert_equal_uint(1, receiver->n_start_runs);
+    cut_assert_equal_uint(1, g_list_length(receiver->complete_runs));
+    cut_assert_equal_uint(1, g_list_length(receiver->start_test_cases));
+
+    cut_assert_equal_uint(1, g_list_length(receiver->start_tests));
+    start_info = receiver->start_tests->data;
+    cut_assert_equal_string("stub-success-test",
+                            cut_test_get_name(start_info->test));
+
+    cut_assert_equal_uint(1, g_list_length(receiver->complete_tests));
+    complete_info = receiver->complete_tests->data;
+    cut_assert_true(complete_info->success);
+
+    cut_assert_equal_uint(2, cut_run_context_get_n_assertions(receiver_context));
+    cut_assert_equal_uint(1, cut_run_context_get_n_successes(receiver_context));
+}
+
+void
+test_failure (void)
+{
+    CuttestFailureTestInfo *info;
+    CutTestResult *result;
+
+    cut_test_case_add_test(test_case,
+                           cut_test_new("stub-failure-test",
+                                        stub_failure_test));
+    cut_assert_false(run());
+
+    cut_assert_parse(binary->str, binary->len);
+    cut_assert_equal_uint(1, g_list_length(receiver->failure_tests));
+    info = receiver->failure_tests->data;
+    result = info->test_result;
+    cut_assert_equal_int(CUT_TEST_RESULT_FAILURE,
+                         cut_test_result_get_status(result));
+    cut_assert_equal_string("stub-failure-test",
+                            cut_test_result_get_test_name(result));
+    cut_assert_equal_string("\"expected\"",
+                            cut_test_result_get_expected(result));
+    cut_assert_equal_string("\"actual\"",
+                            cut_test_result_get_actual(result));
+    cut_assert_not_null(cut_test_result_get_backtrace(result));
+    cut_assert_equal_uint(1, cut_run_context_get_n_failures(receiver_context));
+}
+
+void
+test_iterated_test (void)
+{
+    CuttestStartIteratedTestInfo *info;
+
+    cut_test_case_add_test(test_case,
+                           CUT_TEST(cut_test_iterator_new("stub-iterated-test",
+                                                          stub_iterated_test,
+                                                          stub_iterated_data)));
+    cut_assert_true(run());
+
+    cut_assert_parse(binary->str, binary->len);
+    cut_assert_equal_uint(1, g_list_length(receiver->start_test_iterators));
+    cut_assert_equal_uint(2, g_list_length(receiver->start_iterated_tests));
+    info = receiver->start_iterated_tests->data;
+    cut_assert_equal_string("first data",
+                            cut_test_get_data_name(CUT_TEST(info->iterated_test)));
+    info = receiver->start_iterated_tests->next->data;
+    cut_assert_equal_string("second data",
+                            cut_test_get_data_name(CUT_TEST(info->iterated_test)));
+    cut_assert_equal_uint(2, g_list_length(receiver->complete_iterated_tests));
+    cut_assert_equal_uint(2, cut_run_context_get_n_assertions(receiver_context));
+}
+
+void
+test_split_chunks (void)
+{
+    GError *error = NULL;
+    gsize i;
+
+    cut_test_case_add_test(test_case,
+                           cut_test_new("stub-success-test",
+                                        stub_success_test));
+    cut_assert_true(run());
+
+    for (i = 0; i < binary->len; i++) {
+        cut_stream_parser_parse(parser, binary->str + i, 1, &error);
+        gcut_assert_error(error);
+    }
+    cut_stream_parser_end_parse(parser, &error);
+    gcut_assert_error(error);
+
+    cut_assert_equal_uint(1, g_list_length(receiver->complete_tests));
+    cut_assert_equal_uint(2, cut_run_context_get_n_assertions(receiver_context));
+}
+
+void
+test_invalid_magic (void)
+{
+    GError *error = NULL;
+    const gchar data[] = "\x89" "XYZ\x01";
+
+    cut_assert_false(cut_stream_parser_parse(parser, data, sizeof(data) - 1,
+                                             &error));
+    cut_assert_not_null(error);
+    cut_assert_equal_int(CUT_BINARY_STREAM_PARSER_ERROR_INVALID_MAGIC,
+                         error->code);
+    g_error_free(error);
+}
+
+void
+test_truncated (void)
+{
+    GError *error = NULL;
+
+    cut_test_case_add_test(test_case,
+                           cut_test_new("stub-success-test",
+                                        stub_success_test));
+    cut_assert_true(run());
+
+    cut_stream_parser_parse(parser, binary->str, binary->len - 1, &error);
+    gcut_assert_error(error);
+    cut_stream_parser_end_parse(parser, &error);
+    cut_assert_not_null(error);
+    cut_assert_equal_int(CUT_BINARY_STREAM_PARSER_ERROR_TRUNCATED, error->code);
+    g_error_free(error);
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
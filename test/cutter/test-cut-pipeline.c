@@ -37,6 +37,7 @@ void data_signal (void);
 void test_signal (gconstpointer data);
 void data_count (void);
 void test_count (gconstpointer data);
+void test_elapsed_regression (void);
 
 static GHashTable *pipelines;
 static GMutex *fixture_mutex, *run_mutex;
@@ -253,6 +254,23 @@ test_count (gconstpointer data)
     cut_assert_equal_uint(1, test_data->get_count(pipeline));
 }
 
+void
+test_elapsed_regression (void)
+{
+    const gchar *log_directory;
+
+    /* test_success took no time in all previous runs. */
+    log_directory = cut_take_string(build_test_dir("elapsed-regression-log"));
+    cut_run_context_set_log_directory(pipeline, log_directory);
+    cut_run_context_set_elapsed_regression(pipeline,
+                                           CUT_ELAPSED_REGRESSION_FAILURE);
+    cut_run_context_set_elapsed_regression_threshold(pipeline, 0.0);
+
+    cut_assert_false(run(cut_take_string(build_test_dir("success"))));
+    cut_assert_equal_uint(1, cut_run_context_get_n_failures(pipeline));
+    cut_assert_equal_uint(0, cut_run_context_get_n_successes(pipeline));
+}
+
 /*
 vi:ts=4:nowrap:ai:expandtab:sw=4
 */
@@ -0,0 +1,273 @@
+/* -*- indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <glib/gstdio.h>
+#include <gcutter.h>
+#include <cutter/cut-test-runner.h>
+#include <cutter/cut-listener.h>
+#include <cutter/cut-report.h>
+#include <cutter/cut-stream-parser.h>
+#include "../lib/cuttest-utils.h"
+
+void test_spans (void);
+void test_phases (void);
+void test_teardown_phase_in_run (void);
+void test_child_process (void);
+void test_not_completed (void);
+
+static CutRunContext *run_context;
+static CutReport *report;
+static CutTestSuite *test_suite;
+static CutTestCase *test_case;
+static CutTest *test;
+static CutTestContext *test_context;
+static CutStreamParser *parser;
+static gchar *report_file;
+
+void
+cut_setup (void)
+{
+    run_context = CUT_RUN_CONTEXT(cut_test_runner_new());
+
+    report_file = g_build_filename(cuttest_get_base_dir(),
+                                   "tmp-trace-report.json",
+                                   NULL);
+    g_unlink(report_file);
+    report = cut_report_new("trace", "filename", report_file, NULL);
+    cut_listener_attach_to_run_context(CUT_LISTENER(report), run_context);
+
+    test_suite = cut_test_suite_new_empty();
+    test_case = cut_test_case_new("my_test_case",
+                                  NULL, NULL, NULL, NULL);
+    test = cut_test_new("test_run", NULL);
+    test_context = cut_test_context_new(run_context,
+                                        test_suite, test_case, NULL, test);
+    parser = NULL;
+}
+
+void
+cut_teardown (void)
+{
+    if (parser)
+        g_object_unref(parser);
+    g_object_unref(test_context);
+    g_object_unref(test);
+    g_object_unref(test_case);
+    g_object_unref(test_suite);
+    cut_listener_detach_from_run_context(CUT_LISTENER(report), run_context);
+    g_object_unref(report);
+    g_object_unref(run_context);
+
+    g_unlink(report_file);
+    g_free(report_file);
+}
+
+static const gchar *
+read_report (void)
+{
+    GError *error = NULL;
+    gchar *contents;
+
+    g_file_get_contents(report_file, &contents, NULL, &error);
+    gcut_assert_error(error);
+
+    return cut_take_string(contents);
+}
+
+static void
+start (void)
+{
+    g_signal_emit_by_name(run_context, "ready-test-suite", test_suite, 1, 1);
+    g_signal_emit_by_name(run_context, "start-test-suite", test_suite);
+    g_signal_emit_by_name(run_context, "start-test-case", test_case);
+}
+
+static void
+complete (void)
+{
+    g_signal_emit_by_name(run_context, "complete-test-case", test_case, TRUE);
+    g_signal_emit_by_name(run_context, "complete-test-suite",
+                          test_suite, TRUE);
+}
+
+static void
+run_test (void)
+{
+    g_signal_emit_by_name(run_context, "start-test", test, test_context);
+    g_signal_emit_by_name(run_context, "pass-assertions",
+                          test, test_context, 1);
+    g_signal_emit_by_name(run_context, "complete-test",
+                          test, test_context, TRUE);
+}
+
+void
+test_spans (void)
+{
+    const gchar *trace;
+
+    start();
+    run_test();
+    complete();
+
+    trace = read_report();
+    cut_assert_true(g_str_has_prefix(trace, "[\n"),
+                    cut_message("<%s>", trace));
+    cut_assert_true(g_str_has_suffix(trace, "\n]\n"),
+                    cut_message("<%s>", trace));
+    cut_assert_match("\"name\":\"process_name\",\"ph\":\"M\"", trace);
+    cut_assert_match("\"name\":\"my_test_case\",\"ph\":\"X\","
+                     "\"pid\":[0-9]+,\"tid\":[0-9]+,"
+                     "\"cat\":\"test-case\","
+                     "\"ts\":[0-9]+\\.[0-9]{3},\"dur\":[0-9]+\\.[0-9]{3},"
+                     "\"args\":\\{\"result\":\"success\"\\}",
+                     trace);
+    cut_assert_match("\"name\":\"test_run\",\"ph\":\"X\",.*"
+                     "\"cat\":\"test\"",
+                     trace);
+    cut_assert_match("\"cat\":\"test-suite\"", trace);
+    cut_assert_match("\"name\":\"assertions\",\"ph\":\"C\",.*"
+                     "\"args\":\\{\"per second\":[0-9]+\\.[0-9]\\}",
+                     trace);
+}
+
+void
+test_phases (void)
+{
+    CutPhaseElapsed phase_elapsed;
+    const gchar *trace;
+
+    cut_assert_true(cut_run_context_get_measure_phases(run_context));
+
+    cut_phase_elapsed_init(&phase_elapsed);
+    phase_elapsed.elapsed[CUT_TEST_PHASE_SETUP] = 1000;
+    phase_elapsed.elapsed[CUT_TEST_PHASE_TEARDOWN] = 2000;
+
+    start();
+    g_signal_emit_by_name(run_context, "start-test", test, test_context);
+    cut_test_set_phase_elapsed(test, &phase_elapsed);
+    g_signal_emit_by_name(run_context, "complete-test",
+                          test, test_context, TRUE);
+    complete();
+
+    trace = read_report();
+    cut_assert_match("\"name\":\"setup\",\"ph\":\"X\",.*"
+                     "\"cat\":\"phase\",\"ts\":[0-9.]+,\"dur\":1\\.000\\}",
+                     trace);
+    cut_assert_match("\"name\":\"teardown\",\"ph\":\"X\",.*"
+                     "\"cat\":\"phase\",\"ts\":[0-9.]+,\"dur\":2\\.000\\}",
+                     trace);
+}
+
+static void
+stub_test (void)
+{
+}
+
+static void
+stub_teardown (void)
+{
+}
+
+void
+test_teardown_phase_in_run (void)
+{
+    const gchar *test_names[] = {"/.*/", NULL};
+    CutTestSuite *run_test_suite;
+    CutTestCase *run_test_case;
+    CutTest *run_test;
+    const gchar *trace;
+
+    run_test_suite = cut_test_suite_new_empty();
+    gcut_take_object(G_OBJECT(run_test_suite));
+    run_test_case = cut_test_case_new("run_test_case",
+                                      NULL, stub_teardown, NULL, NULL);
+    gcut_take_object(G_OBJECT(run_test_case));
+    run_test = cut_test_new("test_stub", stub_test);
+    gcut_take_object(G_OBJECT(run_test));
+    cut_test_case_add_test(run_test_case, run_test);
+    cut_test_suite_add_test_case(run_test_suite, run_test_case);
+
+    cut_run_context_set_target_test_names(run_context, test_names);
+    cut_assert_true(cut_test_runner_run_test_suite(CUT_TEST_RUNNER(run_context),
+                                                   run_test_suite));
+
+    trace = read_report();
+    cut_assert_match("\"name\":\"test_stub\",\"ph\":\"X\"", trace);
+    cut_assert_match("\"name\":\"teardown\",\"ph\":\"X\",.*"
+                     "\"cat\":\"phase\",\"ts\":[0-9.]+,\"dur\":[0-9.]+\\}",
+                     trace);
+}
+
+void
+test_child_process (void)
+{
+    GError *error = NULL;
+    const gchar stream[] =
+        "<stream>\n"
+        "  <start-test-case>\n"
+        "    <test-case>\n"
+        "      <name>child_test_case</name>\n"
+        "    </test-case>\n"
+        "  </start-test-case>\n"
+        "  <complete-test-case>\n"
+        "    <test-case>\n"
+        "      <name>child_test_case</name>\n"
+        "    </test-case>\n"
+        "    <success>true</success>\n"
+        "  </complete-test-case>\n";
+
+    g_signal_emit_by_name(run_context, "ready-test-suite", test_suite, 1, 1);
+    g_signal_emit_by_name(run_context, "start-test-suite", test_suite);
+
+    parser = cut_stream_parser_new_in_run(run_context);
+    cut_stream_parser_set_process_id(parser, 29);
+    cut_assert_true(cut_stream_parser_parse(parser, stream, strlen(stream),
+                                            &error));
+    gcut_assert_error(error);
+    cut_assert_equal_int(0, cut_stream_parser_get_current_process_id());
+
+    g_signal_emit_by_name(run_context, "complete-test-suite",
+                          test_suite, TRUE);
+
+    cut_assert_match("\"name\":\"process_name\",\"ph\":\"M\","
+                     "\"pid\":29,\"tid\":0,"
+                     "\"args\":\\{\"name\":\"cutter \\(child\\)\"\\}",
+                     read_report());
+    cut_assert_match("\"name\":\"child_test_case\",\"ph\":\"X\","
+                     "\"pid\":29,",
+                     read_report());
+}
+
+void
+test_not_completed (void)
+{
+    start();
+    run_test();
+    cut_listener_detach_from_run_context(CUT_LISTENER(report), run_context);
+    g_object_unref(report);
+    report = cut_report_new("trace", NULL);
+    cut_listener_attach_to_run_context(CUT_LISTENER(report), run_context);
+
+    cut_assert_match("\"name\":\"test_run\",\"ph\":\"X\"", read_report());
+    cut_assert_false(g_str_has_suffix(read_report(), "]\n"));
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
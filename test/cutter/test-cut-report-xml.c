@@ -28,6 +28,7 @@ void test_report_error (void);
 void test_report_pending (void);
 void test_report_notification (void);
 void test_plural_reports (void);
+void test_keep_all_results (void);
 
 static CutRunContext *run_context;
 static CutReport *report;
@@ -478,6 +479,24 @@ test_plural_reports (void)
     cut_assert_equal_string(expected, normalized_result);
 }
 
+void
+test_keep_all_results (void)
+{
+    const gchar *result;
+
+    cut_run_context_set_keep_results(run_context, CUT_KEEP_RESULTS_NONE);
+    cut_listener_attach_to_run_context(CUT_LISTENER(report), run_context);
+    cut_assert_equal_int(CUT_KEEP_RESULTS_ALL,
+                         cut_run_context_get_keep_results(run_context));
+
+    test = cut_test_new("stub-success-test", stub_success_test);
+    cut_test_case_add_test(test_case, test);
+    cut_assert_true(run());
+
+    result = cut_take_string(cut_report_get_success_results(report));
+    cut_assert_match("<name>stub-success-test</name>", result);
+}
+
 /*
 vi:ts=4:nowrap:ai:expandtab:sw=4
 */
@@ -10,6 +10,8 @@
 #include "../lib/cuttest-utils.h"
 
 void test_create_test_suite (void);
+void test_create_test_suite_in_parallel (void);
+void test_create_test_suite_with_target_test_case_names (void);
 
 static CutRepository *test_repository;
 
@@ -79,6 +81,45 @@ test_create_test_suite (void)
     g_object_unref(suite);
 }
 
+void
+test_create_test_suite_in_parallel (void)
+{
+    CutTestSuite *suite;
+    const GList *test_cases, *list;
+    gint i;
+
+    cut_repository_set_max_threads(test_repository, 4);
+    suite = cut_repository_create_test_suite(test_repository);
+    cut_assert(suite);
+    cut_take(suite, g_object_unref);
+
+    test_cases = cut_test_container_get_children(CUT_TEST_CONTAINER(suite));
+    cut_assert_equal_uint(n_expected_test_case_names,
+                          g_list_length((GList *)test_cases));
+    for (list = test_cases, i = 0; list; list = g_list_next(list), i++) {
+        cut_assert_equal_string(expected_test_case_name[i],
+                                cut_test_get_name(CUT_TEST(list->data)));
+    }
+}
+
+void
+test_create_test_suite_with_target_test_case_names (void)
+{
+    CutTestSuite *suite;
+    const GList *test_cases;
+    const gchar *names[] = {"repository-test-case2", NULL};
+
+    cut_repository_set_target_test_case_names(test_repository, names);
+    suite = cut_repository_create_test_suite(test_repository);
+    cut_assert(suite);
+    cut_take(suite, g_object_unref);
+
+    test_cases = cut_test_container_get_children(CUT_TEST_CONTAINER(suite));
+    cut_assert_equal_uint(1, g_list_length((GList *)test_cases));
+    cut_assert_equal_string("repository-test-case2",
+                            cut_test_get_name(CUT_TEST(test_cases->data)));
+}
+
 /*
 vi:nowrap:ai:expandtab:sw=4
 */
@@ -0,0 +1,145 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+#include <gcutter.h>
+#include <cutter/cut-resource-usage.h>
+#include <cutter/cut-test.h>
+
+void test_subtract(void);
+void test_set_value(void);
+void test_set_value_invalid(void);
+void test_to_xml_string(void);
+void test_test_measure(void);
+
+static CutResourceUsage usage;
+static CutTest *test;
+
+static void
+stub_test_function (void)
+{
+}
+
+void
+cut_setup (void)
+{
+    memset(&usage, 0, sizeof(usage));
+    test = NULL;
+}
+
+void
+cut_teardown (void)
+{
+    if (test)
+        g_object_unref(test);
+}
+
+void
+test_subtract (void)
+{
+    CutResourceUsage start;
+
+    memset(&start, 0, sizeof(start));
+    usage.user_time = 1.5;
+    usage.system_time = 0.25;
+    usage.max_rss = 2048;
+    usage.minor_faults = 10;
+    usage.voluntary_context_switches = 3;
+    start.user_time = 0.5;
+    start.system_time = 0.5;
+    start.max_rss = 1024;
+    start.minor_faults = 4;
+    start.voluntary_context_switches = 5;
+
+    cut_resource_usage_subtract(&usage, &start);
+    cut_assert_equal_double(1.0, 0.0001, usage.user_time);
+    cut_assert_equal_double(0.0, 0.0001, usage.system_time);
+    cut_assert_equal_uint(1024, usage.max_rss);
+    cut_assert_equal_uint(6, usage.minor_faults);
+    cut_assert_equal_uint(0, usage.voluntary_context_switches);
+    cut_assert_equal_double(1.0, 0.0001,
+                            cut_resource_usage_get_cpu_time(&usage));
+}
+
+void
+test_set_value (void)
+{
+    cut_assert_true(cut_resource_usage_set_value(&usage, "user-time", "0.5"));
+    cut_assert_true(cut_resource_usage_set_value(&usage, "max-rss", "128"));
+    cut_assert_true(cut_resource_usage_set_value(&usage,
+                                                 "involuntary-context-switches",
+                                                 "7"));
+    cut_assert_equal_double(0.5, 0.0001, usage.user_time);
+    cut_assert_equal_uint(128, usage.max_rss);
+    cut_assert_equal_uint(7, usage.involuntary_context_switches);
+}
+
+void
+test_set_value_invalid (void)
+{
+    cut_assert_false(cut_resource_usage_set_value(&usage, "unknown", "1"));
+    cut_assert_false(cut_resource_usage_set_value(&usage, "max-rss", "many"));
+}
+
+void
+test_to_xml_string (void)
+{
+    GString *string;
+
+    usage.user_time = 0.5;
+    usage.max_rss = 128;
+    usage.major_faults = 2;
+
+    string = g_string_new(NULL);
+    cut_resource_usage_to_xml_string(&usage, string, 2);
+    cut_assert_equal_string("  <resource-usage>\n"
+                            "    <user-time>0.500000</user-time>\n"
+                            "    <system-time>0.000000</system-time>\n"
+                            "    <max-rss>128</max-rss>\n"
+                            "    <minor-faults>0</minor-faults>\n"
+                            "    <major-faults>2</major-faults>\n"
+                            "    <voluntary-context-switches>0"
+                            "</voluntary-context-switches>\n"
+                            "    <involuntary-context-switches>0"
+                            "</involuntary-context-switches>\n"
+                            "  </resource-usage>\n",
+                            cut_take_string(g_string_free(string, FALSE)));
+}
+
+void
+test_test_measure (void)
+{
+    if (!cut_resource_usage_get(&usage, FALSE))
+        cut_omit("getrusage() isn't available");
+
+    test = cut_test_new("test_stub", stub_test_function);
+    cut_assert_null(cut_test_get_resource_usage(test));
+
+    cut_test_start_resource_usage(test, FALSE);
+    cut_assert_not_null(cut_test_get_resource_usage(test));
+    cut_test_stop_resource_usage(test);
+    cut_assert_not_null(cut_test_get_resource_usage(test));
+
+    cut_test_set_resource_usage(test, NULL);
+    cut_assert_null(cut_test_get_resource_usage(test));
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
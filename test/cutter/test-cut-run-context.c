@@ -1,8 +1,29 @@
+#include <signal.h>
+#include <unistd.h>
+
 #include <gcutter.h>
 #include <cutter/cut-run-context.h>
+#include <cutter/cut-test-runner.h>
+#include <cutter/cut-test-suite.h>
+#include <cutter/cut-module-factory-utils.h>
+#include <cutter/cut-scheduler.h>
+#include <cutter/cut-test-history.h>
+#include <cutter/cut-iterated-test.h>
+#include <cutter/cut-test-data.h>
+
+#include "../lib/cuttest-utils.h"
 
 void test_max_threads(void);
+void test_n_processes(void);
+void test_crash_in_process(void);
+void test_shard(void);
 void test_handle_signals(void);
+void test_n_assertions_in_threads(void);
+void test_results(void);
+void data_keep_results(void);
+void test_keep_results(gconstpointer data);
+void test_elapsed_regression(void);
+void test_elapsed_regression_iterated_test(void);
 
 #define CUT_TYPE_RUN_CONTEXT_STUB            (cut_run_context_stub_get_type ())
 #define CUT_RUN_CONTEXT_STUB(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), CUT_TYPE_RUN_CONTEXT_STUB, CutRunContextStub))
@@ -40,16 +61,24 @@ cut_run_context_stub_init (CutRunContextStub *object)
 }
 
 static CutRunContext *run_context;
+static CutScheduler *scheduler;
+static CutTestSuite *test_suite;
 
 void
 cut_setup (void)
 {
     run_context = NULL;
+    scheduler = NULL;
+    test_suite = NULL;
 }
 
 void
 cut_teardown (void)
 {
+    if (test_suite)
+        g_object_unref(test_suite);
+    if (scheduler)
+        cut_scheduler_free(scheduler);
     if (run_context)
         g_object_unref(run_context);
 }
@@ -66,6 +95,96 @@ test_max_threads (void)
     cut_assert_equal_int(100, cut_run_context_get_max_threads(run_context));
 }
 
+void
+test_n_processes (void)
+{
+    run_context = g_object_new(CUT_TYPE_RUN_CONTEXT_STUB, NULL);
+    cut_assert_not_null(run_context);
+
+    cut_assert_equal_int(0, cut_run_context_get_n_processes(run_context));
+
+    cut_run_context_set_n_processes(run_context, 4);
+    cut_assert_equal_int(4, cut_run_context_get_n_processes(run_context));
+}
+
+static void
+stub_crash_in_process (void)
+{
+    kill(getpid(), SIGKILL);
+}
+
+static void
+stub_pass_in_process (void)
+{
+    cut_assert_true(TRUE);
+}
+
+static void
+add_test_case (const gchar *test_case_name, const gchar *test_name,
+               CutTestFunction function)
+{
+    CutTestCase *test_case;
+
+    test_case = cut_test_case_new(test_case_name, NULL, NULL, NULL, NULL);
+    cuttest_add_test(test_case, test_name, function);
+    cut_test_suite_add_test_case(test_suite, test_case);
+    g_object_unref(test_case);
+}
+
+void
+test_crash_in_process (void)
+{
+    const GList *node;
+    CutTestResult *crash_result = NULL;
+
+    /* A worker can't be forked without a stream. The test
+     * would kill this process itself in that case. */
+    if (!cut_module_factory_exist_module("stream", "xml") &&
+        !cut_module_factory_exist_module("stream", "binary"))
+        cut_omit("no stream module to send results from workers");
+
+    run_context = CUT_RUN_CONTEXT(cut_test_runner_new());
+    cut_run_context_set_n_processes(run_context, 2);
+
+    test_suite = cut_test_suite_new_empty();
+    add_test_case("crash_test_case", "test_crash", stub_crash_in_process);
+    add_test_case("pass_test_case", "test_pass", stub_pass_in_process);
+
+    cut_assert_false(cut_test_suite_run(test_suite, run_context));
+    cut_assert_true(cut_run_context_is_crashed(run_context));
+    cut_assert_equal_uint(1, cut_run_context_get_n_successes(run_context));
+
+    for (node = cut_run_context_get_results(run_context);
+         node;
+         node = g_list_next(node)) {
+        CutTestResult *result = node->data;
+
+        if (cut_test_result_get_status(result) == CUT_TEST_RESULT_CRASH) {
+            cut_assert_null(crash_result);
+            crash_result = result;
+        }
+    }
+    cut_assert_not_null(crash_result);
+    cut_assert_equal_string("crash_test_case",
+                            cut_test_result_get_test_case_name(crash_result));
+    cut_assert_match("killed by signal",
+                     cut_test_result_get_system_message(crash_result));
+}
+
+void
+test_shard (void)
+{
+    run_context = g_object_new(CUT_TYPE_RUN_CONTEXT_STUB, NULL);
+    cut_assert_not_null(run_context);
+
+    cut_assert_equal_int(0, cut_run_context_get_shard_index(run_context));
+    cut_assert_equal_int(0, cut_run_context_get_shard_count(run_context));
+
+    cut_run_context_set_shard(run_context, 2, 3);
+    cut_assert_equal_int(2, cut_run_context_get_shard_index(run_context));
+    cut_assert_equal_int(3, cut_run_context_get_shard_count(run_context));
+}
+
 void
 test_handle_signals (void)
 {
@@ -77,6 +196,254 @@ test_handle_signals (void)
     cut_assert_false(cut_run_context_get_handle_signals(run_context));
 }
 
+static void
+pass_assertions (gpointer data, gpointer user_data)
+{
+    gint i, n_assertions;
+
+    n_assertions = GPOINTER_TO_INT(user_data);
+    for (i = 0; i < n_assertions; i++) {
+        g_signal_emit_by_name(run_context, "pass-assertion", NULL, NULL);
+    }
+}
+
+void
+test_n_assertions_in_threads (void)
+{
+    CutSchedulerGroup *group;
+    gint i;
+
+    run_context = g_object_new(CUT_TYPE_RUN_CONTEXT_STUB, NULL);
+    scheduler = cut_scheduler_new(4);
+    group = cut_scheduler_group_new(scheduler, pass_assertions,
+                                    GINT_TO_POINTER(1000));
+    for (i = 0; i < 8; i++)
+        cut_scheduler_group_push(group, NULL);
+    cut_scheduler_group_join(group);
+
+    cut_assert_equal_uint(8000, cut_run_context_get_n_assertions(run_context));
+}
+
+void
+test_results (void)
+{
+    const gchar *messages[] = {"first", "second", "third"};
+    const GList *results;
+    guint i;
+
+    run_context = g_object_new(CUT_TYPE_RUN_CONTEXT_STUB, NULL);
+    for (i = 0; i < G_N_ELEMENTS(messages); i++) {
+        CutTestResult *result;
+
+        result = cut_test_result_new_empty();
+        cut_test_result_set_status(result, CUT_TEST_RESULT_FAILURE);
+        cut_test_result_set_user_message(result, messages[i]);
+        g_signal_emit_by_name(run_context, "failure-test", NULL, NULL, result);
+        g_object_unref(result);
+    }
+
+    cut_assert_equal_uint(3, cut_run_context_get_n_failures(run_context));
+    cut_assert_equal_int(CUT_TEST_RESULT_FAILURE,
+                         cut_run_context_get_status(run_context));
+
+    results = cut_run_context_get_results(run_context);
+    cut_assert_equal_uint(3, g_list_length((GList *)results));
+    for (i = 0; results; results = g_list_next(results), i++) {
+        CutTestResult *result = results->data;
+
+        cut_assert_equal_string(messages[i],
+                                cut_test_result_get_user_message(result));
+    }
+}
+
+typedef struct _KeepResultsTestData
+{
+    CutKeepResults keep_results;
+    guint n_kept_results;
+} KeepResultsTestData;
+
+static KeepResultsTestData *
+keep_results_test_data_new (CutKeepResults keep_results, guint n_kept_results)
+{
+    KeepResultsTestData *data;
+
+    data = g_new(KeepResultsTestData, 1);
+    data->keep_results = keep_results;
+    data->n_kept_results = n_kept_results;
+
+    return data;
+}
+
+void
+data_keep_results (void)
+{
+    cut_add_data("all",
+                 keep_results_test_data_new(CUT_KEEP_RESULTS_ALL, 3),
+                 g_free,
+                 "failures",
+                 keep_results_test_data_new(CUT_KEEP_RESULTS_FAILURES, 1),
+                 g_free,
+                 "none",
+                 keep_results_test_data_new(CUT_KEEP_RESULTS_NONE, 0),
+                 g_free);
+}
+
+static void
+emit_result (CutTestResultStatus status, const gchar *signal_name)
+{
+    CutTestResult *result;
+
+    result = cut_test_result_new_empty();
+    cut_test_result_set_status(result, status);
+    g_signal_emit_by_name(run_context, signal_name, NULL, NULL, result);
+    g_object_unref(result);
+}
+
+void
+test_keep_results (gconstpointer data)
+{
+    const KeepResultsTestData *test_data = data;
+
+    run_context = g_object_new(CUT_TYPE_RUN_CONTEXT_STUB,
+                               "keep-results", test_data->keep_results,
+                               NULL);
+    cut_assert_equal_int(test_data->keep_results,
+                         cut_run_context_get_keep_results(run_context));
+
+    emit_result(CUT_TEST_RESULT_SUCCESS, "success-test");
+    emit_result(CUT_TEST_RESULT_SUCCESS, "success-test");
+    emit_result(CUT_TEST_RESULT_FAILURE, "failure-test");
+
+    cut_assert_equal_uint(2, cut_run_context_get_n_successes(run_context));
+    cut_assert_equal_uint(1, cut_run_context_get_n_failures(run_context));
+    cut_assert_equal_uint(test_data->n_kept_results,
+                          g_list_length((GList *)cut_run_context_get_results(run_context)));
+}
+
+static CutTestResultStatus
+check_elapsed_regression (CutTestCase *test_case, CutTest *test)
+{
+    gchar *message = NULL;
+    CutTestResultStatus status;
+
+    status = cut_run_context_check_elapsed_regression(run_context,
+                                                      test, test_case,
+                                                      &message);
+    if (status == CUT_TEST_RESULT_SUCCESS)
+        cut_assert_null(message);
+    else
+        cut_assert_not_null(cut_take_string(message));
+
+    return status;
+}
+
+void
+test_elapsed_regression (void)
+{
+    CutTestCase *test_case;
+    CutTest *test;
+    const gchar *log_directory;
+
+    run_context = g_object_new(CUT_TYPE_RUN_CONTEXT_STUB, NULL);
+    log_directory = cut_take_string(g_build_filename(cuttest_get_base_dir(),
+                                                     "fixtures",
+                                                     "test-history",
+                                                     NULL));
+    cut_run_context_set_log_directory(run_context, log_directory);
+
+    test_case = cut_test_case_new("test_slow", NULL, NULL, NULL, NULL);
+    gcut_take_object(G_OBJECT(test_case));
+    test = cut_test_new("test_run", NULL);
+    gcut_take_object(G_OBJECT(test));
+
+    /* previous runs: 3.0, 1.0, 2.0: median 2.0, MAD 1.0 */
+    cut_test_set_elapsed(test, 20.0);
+    cut_assert_equal_int(CUT_ELAPSED_REGRESSION_NONE,
+                         cut_run_context_get_elapsed_regression(run_context));
+    cut_assert_equal_int(CUT_TEST_RESULT_SUCCESS,
+                         check_elapsed_regression(test_case, test));
+
+    cut_run_context_set_elapsed_regression(run_context,
+                                           CUT_ELAPSED_REGRESSION_NOTIFICATION);
+    cut_assert_equal_int(CUT_TEST_RESULT_NOTIFICATION,
+                         check_elapsed_regression(test_case, test));
+
+    cut_test_set_elapsed(test, 3.5);
+    cut_assert_equal_int(CUT_TEST_RESULT_SUCCESS,
+                         check_elapsed_regression(test_case, test));
+
+    cut_run_context_set_elapsed_regression_threshold(run_context, 1.0);
+    cut_assert_equal_int(CUT_TEST_RESULT_NOTIFICATION,
+                         check_elapsed_regression(test_case, test));
+
+    cut_test_set_attribute(test, "elapsed-regression", "failure");
+    cut_assert_equal_int(CUT_TEST_RESULT_FAILURE,
+                         check_elapsed_regression(test_case, test));
+
+    cut_test_set_attribute(test, "elapsed-regression-threshold", "5");
+    cut_assert_equal_int(CUT_TEST_RESULT_SUCCESS,
+                         check_elapsed_regression(test_case, test));
+
+    cut_test_set_attribute(test, "elapsed-regression", "none");
+    cut_test_set_elapsed(test, 20.0);
+    cut_assert_equal_int(CUT_TEST_RESULT_SUCCESS,
+                         check_elapsed_regression(test_case, test));
+}
+
+void
+test_elapsed_regression_iterated_test (void)
+{
+    CutTestHistory *history;
+    CutTestCase *test_case;
+    CutTestData *small_data, *large_data;
+    CutIteratedTest *small_test, *large_test;
+
+    run_context = g_object_new(CUT_TYPE_RUN_CONTEXT_STUB,
+                               "elapsed-regression",
+                               CUT_ELAPSED_REGRESSION_NOTIFICATION,
+                               NULL);
+    history = cut_run_context_get_test_history(run_context);
+    cut_test_history_add_iterated_test_elapsed(history,
+                                               "test_data", "test_run", "small",
+                                               0.10);
+    cut_test_history_add_iterated_test_elapsed(history,
+                                               "test_data", "test_run", "small",
+                                               0.11);
+    cut_test_history_add_iterated_test_elapsed(history,
+                                               "test_data", "test_run", "small",
+                                               0.12);
+    cut_test_history_add_iterated_test_elapsed(history,
+                                               "test_data", "test_run", "large",
+                                               2.0);
+    cut_test_history_add_iterated_test_elapsed(history,
+                                               "test_data", "test_run", "large",
+                                               2.1);
+    cut_test_history_add_iterated_test_elapsed(history,
+                                               "test_data", "test_run", "large",
+                                               2.2);
+
+    test_case = cut_test_case_new("test_data", NULL, NULL, NULL, NULL);
+    gcut_take_object(G_OBJECT(test_case));
+    small_data = cut_test_data_new("small", NULL, NULL);
+    gcut_take_object(G_OBJECT(small_data));
+    large_data = cut_test_data_new("large", NULL, NULL);
+    gcut_take_object(G_OBJECT(large_data));
+    small_test = cut_iterated_test_new("test_run", NULL, small_data);
+    gcut_take_object(G_OBJECT(small_test));
+    large_test = cut_iterated_test_new("test_run", NULL, large_data);
+    gcut_take_object(G_OBJECT(large_test));
+
+    /* each test data is compared with its own previous runs. */
+    cut_test_set_elapsed(CUT_TEST(small_test), 2.0);
+    cut_assert_equal_int(CUT_TEST_RESULT_NOTIFICATION,
+                         check_elapsed_regression(test_case,
+                                                  CUT_TEST(small_test)));
+    cut_test_set_elapsed(CUT_TEST(large_test), 2.0);
+    cut_assert_equal_int(CUT_TEST_RESULT_SUCCESS,
+                         check_elapsed_regression(test_case,
+                                                  CUT_TEST(large_test)));
+}
+
 /*
 vi:nowrap:ai:expandtab:sw=4:ts=4
 */
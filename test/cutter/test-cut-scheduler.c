@@ -0,0 +1,140 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gcutter.h>
+#include <cutter/cut-scheduler.h>
+
+void test_join(void);
+void test_join_without_task(void);
+void test_nested(void);
+void data_max_threads(void);
+void test_max_threads(gconstpointer data);
+
+static CutScheduler *scheduler;
+static volatile gint n_runs;
+
+void
+cut_setup (void)
+{
+    scheduler = NULL;
+    n_runs = 0;
+}
+
+void
+cut_teardown (void)
+{
+    if (scheduler)
+        cut_scheduler_free(scheduler);
+}
+
+static void
+count_up (gpointer data, gpointer user_data)
+{
+    g_atomic_int_inc(&n_runs);
+}
+
+void
+test_join (void)
+{
+    CutSchedulerGroup *group;
+    gint i;
+
+    scheduler = cut_scheduler_new(4);
+    group = cut_scheduler_group_new(scheduler, count_up, NULL);
+    for (i = 0; i < 100; i++)
+        cut_scheduler_group_push(group, NULL);
+    cut_scheduler_group_join(group);
+
+    cut_assert_equal_int(100, g_atomic_int_get(&n_runs));
+}
+
+void
+test_join_without_task (void)
+{
+    CutSchedulerGroup *group;
+
+    scheduler = cut_scheduler_new(4);
+    group = cut_scheduler_group_new(scheduler, count_up, NULL);
+    cut_scheduler_group_join(group);
+
+    cut_assert_equal_int(0, g_atomic_int_get(&n_runs));
+    cut_assert_equal_uint(0, cut_scheduler_get_n_threads(scheduler));
+}
+
+static void
+run_inner_group (gpointer data, gpointer user_data)
+{
+    CutSchedulerGroup *group;
+    gint i;
+
+    group = cut_scheduler_group_new(scheduler, count_up, NULL);
+    for (i = 0; i < 10; i++)
+        cut_scheduler_group_push(group, NULL);
+    cut_scheduler_group_join(group);
+}
+
+void
+test_nested (void)
+{
+    CutSchedulerGroup *group;
+    gint i;
+
+    scheduler = cut_scheduler_new(2);
+    group = cut_scheduler_group_new(scheduler, run_inner_group, NULL);
+    for (i = 0; i < 10; i++)
+        cut_scheduler_group_push(group, NULL);
+    cut_scheduler_group_join(group);
+
+    cut_assert_equal_int(100, g_atomic_int_get(&n_runs));
+    cut_assert_operator_uint(cut_scheduler_get_n_threads(scheduler), <=, 1);
+}
+
+void
+data_max_threads (void)
+{
+    cut_add_data("one", GINT_TO_POINTER(1), NULL,
+                 "two", GINT_TO_POINTER(2), NULL,
+                 "ten", GINT_TO_POINTER(10), NULL);
+}
+
+void
+test_max_threads (gconstpointer data)
+{
+    CutSchedulerGroup *group;
+    gint i, max_threads;
+
+    max_threads = GPOINTER_TO_INT(data);
+    scheduler = cut_scheduler_new(max_threads);
+    cut_assert_equal_int(max_threads,
+                         cut_scheduler_get_max_threads(scheduler));
+
+    group = cut_scheduler_group_new(scheduler, run_inner_group, NULL);
+    for (i = 0; i < 50; i++)
+        cut_scheduler_group_push(group, NULL);
+    cut_scheduler_group_join(group);
+
+    cut_assert_equal_int(500, g_atomic_int_get(&n_runs));
+    cut_assert_operator_uint(cut_scheduler_get_n_threads(scheduler),
+                             <,
+                             max_threads);
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
@@ -1,6 +1,6 @@
 /* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
 /*
- *  Copyright (C) 2008-2010  Kouhei Sutou <kou@clear-code.com>
+ *  Copyright (C) 2008-2014  Kouhei Sutou <kou@clear-code.com>
  *
  *  This library is free software: you can redistribute it and/or modify
  *  it under the terms of the GNU Lesser General Public License as published by
@@ -33,6 +33,10 @@ void test_get_matches_complex_for_char_sequence(void);
 void test_get_blocks_for_string_sequence(void);
 void test_get_blocks_for_char_sequence(void);
 void test_get_blocks_complex_for_char_sequence(void);
+void test_get_blocks_by_myers_for_string_sequence(void);
+void test_get_blocks_by_myers_for_char_sequence(void);
+void test_get_blocks_by_myers_for_large_char_sequence(void);
+void test_max_cost(void);
 void test_get_operations_for_string_sequence(void);
 void test_get_operations_for_char_sequence(void);
 void test_get_grouped_operations(void);
@@ -750,6 +754,100 @@ inspect_operations (const GList *operations)
                                              inspect_operation_func, NULL));
 }
 
+static CutSequenceMatcher *
+myers_matcher_new (CutSequenceMatcher *sequence_matcher)
+{
+    cut_sequence_matcher_set_algorithm(sequence_matcher,
+                                       CUT_SEQUENCE_MATCHER_ALGORITHM_MYERS);
+    return sequence_matcher;
+}
+
+void
+test_get_blocks_by_myers_for_string_sequence (void)
+{
+    gchar *abxcd[] = {"a", "b", "x", "c", "d", NULL};
+    gchar *abcd[] = {"a", "b", "c", "d", NULL};
+    gchar *qabxcd[] = {"q", "a", "b", "x", "c", "d", NULL};
+    gchar *abycdf[] = {"a", "b", "y", "c", "d", "f", NULL};
+
+    expected_matches = append_match_info(NULL, 0, 0, 2);
+    expected_matches = append_match_info(expected_matches, 3, 2, 2);
+    expected_matches = append_match_info(expected_matches, 5, 4, 0);
+    cut_assert_blocks(expected_matches,
+                      myers_matcher_new(string_matcher_new(abxcd, abcd)),
+                      inspect_string_matcher(abxcd, abcd));
+    free_matches(expected_matches);
+
+    expected_matches = append_match_info(NULL, 1, 0, 2);
+    expected_matches = append_match_info(expected_matches, 4, 3, 2);
+    expected_matches = append_match_info(expected_matches, 6, 6, 0);
+    cut_assert_blocks(expected_matches,
+                      myers_matcher_new(string_matcher_new(qabxcd, abycdf)),
+                      inspect_string_matcher(qabxcd, abycdf));
+}
+
+void
+test_get_blocks_by_myers_for_char_sequence (void)
+{
+    expected_matches = append_match_info(NULL, 0, 0, 2);
+    expected_matches = append_match_info(expected_matches, 3, 2, 2);
+    expected_matches = append_match_info(expected_matches, 5, 4, 0);
+    cut_assert_blocks(expected_matches,
+                      myers_matcher_new(char_matcher_new("abxcd", "abcd")),
+                      inspect_char_matcher("abxcd", "abcd"));
+    free_matches(expected_matches);
+
+    expected_matches = append_match_info(NULL, 0, 0, 1);
+    expected_matches = append_match_info(expected_matches, 2, 1, 1);
+    expected_matches = append_match_info(expected_matches, 3, 2, 0);
+    cut_assert_blocks(expected_matches,
+                      myers_matcher_new(char_matcher_new("efg", "eg")),
+                      inspect_char_matcher("efg", "eg"));
+}
+
+void
+test_get_blocks_by_myers_for_large_char_sequence (void)
+{
+    gchar *from, *to;
+
+    from = g_strnfill(2000, 'a');
+    to = g_strdup(from);
+    to[1000] = 'b';
+    cut_take_string(from);
+    cut_take_string(to);
+
+    expected_matches = append_match_info(NULL, 0, 0, 1000);
+    expected_matches = append_match_info(expected_matches, 1001, 1001, 999);
+    expected_matches = append_match_info(expected_matches, 2000, 2000, 0);
+    cut_assert_blocks(expected_matches,
+                      char_matcher_new(from, to),
+                      "cut_sequence_matcher_char_new(\"a\" * 2000, "
+                      "\"a\" * 1000 + \"b\" + \"a\" * 999)");
+}
+
+void
+test_max_cost (void)
+{
+    matcher = myers_matcher_new(char_matcher_new("qabxcd", "abycdf"));
+    cut_sequence_matcher_set_max_cost(matcher, 0);
+    cut_assert_equal_uint(0, cut_sequence_matcher_get_max_cost(matcher));
+    cut_assert_true(cut_sequence_matcher_is_coarse(matcher));
+
+    expected_matches = append_match_info(NULL, 6, 6, 0);
+    cut_assert_equal_matches(expected_matches,
+                             cut_sequence_matcher_get_blocks(matcher));
+    free_matches(expected_matches);
+
+    cut_sequence_matcher_set_max_cost(matcher,
+                                      CUT_SEQUENCE_MATCHER_DEFAULT_MAX_COST);
+    cut_assert_false(cut_sequence_matcher_is_coarse(matcher));
+    expected_matches = append_match_info(NULL, 1, 0, 2);
+    expected_matches = append_match_info(expected_matches, 4, 3, 2);
+    expected_matches = append_match_info(expected_matches, 6, 6, 0);
+    cut_assert_equal_matches(expected_matches,
+                             cut_sequence_matcher_get_blocks(matcher));
+}
+
 #define cut_assert_operations(expected,                                 \
                               sequence_matcher,                         \
                               sequence_matcher_inspect) do              \
@@ -38,6 +38,7 @@ void test_result_test_iterator (void);
 void test_result_test_case (void);
 void test_pass_assertion_test (void);
 void test_pass_assertion_iterated_test (void);
+void test_pass_assertions (void);
 void test_fail_assertion_test (void);
 void test_complete_iterated_test (void);
 void test_complete_test (void);
@@ -1187,6 +1188,36 @@ test_pass_assertion_iterated_test (void)
     cut_assert_false(cut_test_context_is_failed(test_context));
 }
 
+void
+test_pass_assertions (void)
+{
+    const gchar xml[] =
+        "<stream>\n"
+        "  <pass-assertions>\n"
+        "    <test>\n"
+        "      <name>test_error_signal</name>\n"
+        "      <elapsed>0.000039</elapsed>\n"
+        "    </test>\n"
+        "    <test-context>\n"
+        "      <test-case>\n"
+        "        <name>test_cut_test</name>\n"
+        "        <elapsed>0.000062</elapsed>\n"
+        "      </test-case>\n"
+        "      <test>\n"
+        "        <name>test_error_signal</name>\n"
+        "        <elapsed>0.000077</elapsed>\n"
+        "      </test>\n"
+        "      <failed>FALSE</failed>\n"
+        "    </test-context>\n"
+        "    <n-assertions>3</n-assertions>\n"
+        "  </pass-assertions>\n"
+        "</stream>\n";
+
+    cut_assert_parse(xml);
+    cut_assert_null(receiver->pass_assertions);
+    cut_assert_equal_uint(3, cut_run_context_get_n_assertions(run_context));
+}
+
 void
 test_fail_assertion_test (void)
 {
@@ -2,6 +2,7 @@
 #include <cutter/cut-test.h>
 #include <cutter/cut-test-result.h>
 #include <cutter/cut-loader.h>
+#include <cutter/cut-test-index.h>
 #include <cutter/cut-utils.h>
 #include "../lib/cuttest-assertions.h"
 
@@ -9,12 +10,15 @@ void test_set_attribute (void);
 void test_bug_id (void);
 void test_multi_attributes (void);
 void test_description (void);
+void test_cpp_attribute (void);
+void test_cpp_attribute_from_test_index (void);
 
 static GList *tests;
 static GList *expected_names;
 static CutTest *test;
 static CutLoader *test_loader;
 static CutTestCase *test_case;
+static gchar *tmp_dir;
 
 #define cut_omit_if_loader_does_not_support_attribute(loader) do        \
 {                                                                       \
@@ -46,6 +50,8 @@ cut_setup (void)
 
     test_case = NULL;
     test = NULL;
+
+    tmp_dir = NULL;
 }
 
 void
@@ -62,6 +68,11 @@ cut_teardown (void)
         g_object_unref(test_loader);
     if (test_case)
         g_object_unref(test_case);
+
+    if (tmp_dir) {
+        cut_remove_path(tmp_dir, NULL);
+        g_free(tmp_dir);
+    }
 }
 
 static const GList *
@@ -166,6 +177,129 @@ test_description (void)
                             cut_test_get_description(CUT_TEST(tests->data)));
 }
 
+static const gchar *
+cpp_test_path (void)
+{
+    return cut_take_string(g_build_filename(cuttest_get_base_dir(),
+                                            "fixtures",
+                                            "loader",
+                                            "cpp",
+#ifndef G_OS_WIN32
+                                            ".libs",
+#endif
+                                            "stub-attribute." G_MODULE_SUFFIX,
+                                            NULL));
+}
+
+static CutLoader *
+cpp_loader_new (CutTestIndex *test_index)
+{
+    CutLoader *loader;
+
+    loader = cut_loader_new(cpp_test_path());
+    cut_loader_set_enable_convenience_attribute_definition(loader, TRUE);
+    cut_loader_set_test_index(loader, test_index);
+    gcut_take_object(G_OBJECT(loader));
+
+    return loader;
+}
+
+static GHashTable *
+find_attributes (GList *test_cases, const gchar *test_name)
+{
+    GList *node;
+
+    for (node = test_cases; node; node = g_list_next(node)) {
+        CutTestContainer *container = node->data;
+        const GList *test_node;
+
+        for (test_node = cut_test_container_get_children(container);
+             test_node;
+             test_node = g_list_next(test_node)) {
+            CutTest *test = test_node->data;
+
+            if (g_str_equal(cut_test_get_name(test), test_name))
+                return cut_test_get_attributes(test);
+        }
+    }
+
+    cut_fail("<%s> isn't loaded", test_name);
+    return NULL;
+}
+
+static void
+assert_cpp_attributes (CutLoader *loader)
+{
+    GList *test_cases;
+    GHashTable *expected;
+
+    test_cases = cut_loader_load_test_cases(loader);
+    gcut_take_list(test_cases, g_object_unref);
+
+    expected = gcut_take_new_hash_table_string_string("bug", "1234",
+                                                      "priority", "high",
+                                                      NULL);
+    gcut_assert_equal_hash_table_string_string(
+        expected,
+        find_attributes(test_cases, "adder::test_compute"));
+
+    expected = gcut_take_new_hash_table_string_string("bug", "5678",
+                                                      NULL);
+    gcut_assert_equal_hash_table_string_string(
+        expected,
+        find_attributes(test_cases, "subtracter::test_compute"));
+}
+
+void
+test_cpp_attribute (void)
+{
+    CutLoader *loader;
+
+    loader = cpp_loader_new(NULL);
+    cut_omit_if_loader_does_not_support_attribute(loader);
+
+    cut_trace(assert_cpp_attributes(loader));
+}
+
+void
+test_cpp_attribute_from_test_index (void)
+{
+    GError *error = NULL;
+    CutTestIndex *test_index;
+    CutLoader *loader;
+    GList *symbols = NULL;
+    gboolean support_attribute = FALSE;
+
+    tmp_dir = g_build_filename(cuttest_get_base_dir(),
+                               "tmp-test-attribute",
+                               NULL);
+    cut_remove_path(tmp_dir, NULL);
+    test_index = cut_test_index_new(cut_take_string(g_build_filename(tmp_dir,
+                                                                     "index",
+                                                                     NULL)));
+    cut_take(test_index, (CutDestroyFunction)cut_test_index_free);
+
+    loader = cpp_loader_new(test_index);
+    cut_omit_if_loader_does_not_support_attribute(loader);
+    cut_trace(assert_cpp_attributes(loader));
+    cut_test_index_save(test_index, &error);
+    gcut_assert_error(error);
+
+    test_index = cut_test_index_new(cut_test_index_get_file_name(test_index));
+    cut_take(test_index, (CutDestroyFunction)cut_test_index_free);
+    cut_test_index_load(test_index, &error);
+    gcut_assert_error(error);
+
+    /* attribute functions must be loaded from the index. */
+    cut_assert_true(cut_test_index_lookup(test_index, cpp_test_path(), TRUE,
+                                          &symbols, &support_attribute));
+    gcut_take_list(symbols, g_free);
+    cut_assert_true(support_attribute);
+
+    loader = cpp_loader_new(test_index);
+    cut_trace(assert_cpp_attributes(loader));
+}
+
 /*
 vi:ts=4:nowrap:ai:expandtab:sw=4
 */
@@ -1,6 +1,6 @@
 /* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
 /*
- *  Copyright (C) 2009-2010  Kouhei Sutou <kou@clear-code.com>
+ *  Copyright (C) 2009-2014  Kouhei Sutou <kou@clear-code.com>
  *
  *  This library is free software: you can redistribute it and/or modify
  *  it under the terms of the GNU Lesser General Public License as published by
@@ -23,6 +23,9 @@
 #include <cutter/cut-test-case.h>
 #include <cutter/cut-test-runner.h>
 #include <cutter/cut-crash-backtrace.h>
+#include <cutter/cut-listener.h>
+#include <cutter/cut-stream.h>
+#include <cutter/cut-glib-compatible.h>
 
 #include "../lib/cuttest-assertions.h"
 
@@ -46,6 +49,7 @@ void test_pending_signal(void);
 void test_notification_signal(void);
 void test_omission_signal(void);
 void test_crash_signal(void);
+void test_crash_signal_in_thread(void);
 void test_failure_in_signal(void);
 void test_error_in_signal(void);
 void test_pending_in_signal(void);
@@ -53,6 +57,8 @@ void test_notification_in_signal(void);
 void test_omission_in_signal(void);
 void test_crash_in_signal(void);
 void test_complete_signal(void);
+void test_measure_phases(void);
+void test_not_measure_phases(void);
 
 static CutTestCase *test_object;
 static CutRunContext *run_context;
@@ -507,6 +513,42 @@ test_crash_signal (void)
 #endif
 }
 
+#ifndef G_OS_WIN32
+static gpointer
+run_test_case_in_thread (gpointer data)
+{
+    return GINT_TO_POINTER(cut_test_case_run(test_object, run_context));
+}
+#endif
+
+void
+test_crash_signal_in_thread (void)
+{
+#ifdef G_OS_WIN32
+    cut_omit("crash isn't supported yet on Windows.");
+#else
+    GThread *thread;
+    GError *error = NULL;
+    gint n_crashes = 0;
+
+    cut_crash_backtrace_set_show_on_the_moment(FALSE);
+    cut_run_context_set_multi_thread(run_context, TRUE);
+
+    g_signal_connect(test_object, "crash",
+                     G_CALLBACK(cb_count_status), &n_crashes);
+    cuttest_add_test(test_object, "stub_crash_test",
+                     stub_crash_test);
+    thread = g_thread_create(run_test_case_in_thread, NULL, TRUE, &error);
+    gcut_assert_error(error);
+    cut_assert_false(GPOINTER_TO_INT(g_thread_join(thread)));
+    g_signal_handlers_disconnect_by_func(test_object,
+                                         G_CALLBACK(cb_count_status),
+                                         &n_crashes);
+    cut_assert_equal_int(1, n_crashes);
+    cut_assert_true(cut_run_context_is_canceled(run_context));
+#endif
+}
+
 void
 test_failure_in_signal (void)
 {
@@ -670,6 +712,98 @@ test_complete_signal (void)
     cut_assert_equal_int(3, n_complete_tests);
 }
 
+static void
+cb_collect_result (CutTest *test, CutTestContext *test_context,
+                   CutTestResult *result, gpointer data)
+{
+    CutTestResult **collected_result = data;
+
+    *collected_result =
+        CUT_TEST_RESULT(gcut_take_object(G_OBJECT(g_object_ref(result))));
+}
+
+static gboolean
+stream_to_string (const gchar *message, GError **error, gpointer user_data)
+{
+    GString *string = user_data;
+
+    g_string_append(string, message);
+
+    return TRUE;
+}
+
+void
+test_measure_phases (void)
+{
+    const CutPhaseElapsed *phase_elapsed;
+    CutTest *test;
+    CutTestResult *result = NULL;
+    CutStream *stream;
+    GString *xml;
+
+    test = cut_test_container_get_children(CUT_TEST_CONTAINER(test_object))->data;
+    g_signal_connect(test, "success",
+                     G_CALLBACK(cb_collect_result), &result);
+    xml = gcut_take_string(g_string_new(NULL));
+    stream = cut_stream_new("xml",
+                            "stream-function", stream_to_string,
+                            "stream-function-user-data", xml,
+                            NULL);
+    gcut_take_object(G_OBJECT(stream));
+
+    cut_run_context_set_measure_phases(run_context, TRUE);
+    cut_listener_attach_to_run_context(CUT_LISTENER(stream), run_context);
+    cut_assert_true(cut_test_runner_run_test_case(CUT_TEST_RUNNER(run_context),
+                                                  test_object));
+    cut_listener_detach_from_run_context(CUT_LISTENER(stream), run_context);
+    g_signal_handlers_disconnect_by_func(test,
+                                         G_CALLBACK(cb_collect_result),
+                                         &result);
+
+    phase_elapsed = cut_test_get_phase_elapsed(CUT_TEST(test_object));
+    cut_assert_operator_int(phase_elapsed->elapsed[CUT_TEST_PHASE_STARTUP],
+                            >=, 0);
+    cut_assert_operator_int(phase_elapsed->elapsed[CUT_TEST_PHASE_SHUTDOWN],
+                            >=, 0);
+    cut_assert_equal_int(-1, phase_elapsed->elapsed[CUT_TEST_PHASE_SETUP]);
+
+    phase_elapsed = cut_test_get_phase_elapsed(test);
+    cut_assert_operator_int(phase_elapsed->elapsed[CUT_TEST_PHASE_SETUP],
+                            >=, 0);
+    cut_assert_operator_int(phase_elapsed->elapsed[CUT_TEST_PHASE_TEST],
+                            >=, 0);
+    cut_assert_operator_int(phase_elapsed->elapsed[CUT_TEST_PHASE_TEARDOWN],
+                            >=, 0);
+    cut_assert_equal_int(-1, phase_elapsed->elapsed[CUT_TEST_PHASE_STARTUP]);
+
+    cut_assert_not_null(result);
+    phase_elapsed = cut_test_result_get_phase_elapsed(result);
+    cut_assert_operator_int(phase_elapsed->elapsed[CUT_TEST_PHASE_TEARDOWN],
+                            >=, 0);
+
+    cut_assert_match("<status>success</status>\\s*"
+                     "<start-time>[^<]*</start-time>\\s*"
+                     "<elapsed>[^<]*</elapsed>\\s*"
+                     "<phase-elapsed>"
+                     "(?:\\s*<[a-z-]+>[0-9.]+</[a-z-]+>)*\\s*"
+                     "<teardown>[0-9.]+</teardown>",
+                     xml->str);
+}
+
+void
+test_not_measure_phases (void)
+{
+    CutTest *test;
+
+    cut_assert_true(run_the_test());
+
+    cut_assert_true(cut_phase_elapsed_is_empty(
+                        cut_test_get_phase_elapsed(CUT_TEST(test_object))));
+    test = cut_test_container_get_children(CUT_TEST_CONTAINER(test_object))->data;
+    cut_assert_true(cut_phase_elapsed_is_empty(
+                        cut_test_get_phase_elapsed(test)));
+}
+
 /*
 vi:nowrap:ai:expandtab:sw=4
 */
@@ -0,0 +1,245 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gcutter.h>
+#include <cutter/cut-test-history.h>
+
+#include "../lib/cuttest-utils.h"
+
+void test_median(void);
+void test_unknown(void);
+void test_baseline(void);
+void test_iterated_test_baseline(void);
+void test_load(void);
+void test_load_max_runs(void);
+void test_load_nonexistent(void);
+void test_load_iterated_test(void);
+
+static CutTestHistory *history;
+static gchar *log_directory;
+
+void
+cut_setup (void)
+{
+    history = cut_test_history_new();
+    log_directory = g_build_filename(cuttest_get_base_dir(),
+                                     "fixtures",
+                                     "test-history",
+                                     NULL);
+}
+
+void
+cut_teardown (void)
+{
+    cut_test_history_free(history);
+    g_free(log_directory);
+}
+
+void
+test_median (void)
+{
+    gdouble elapsed;
+
+    cut_test_history_add_test_case_elapsed(history, "test_case", 3.0);
+    cut_test_history_add_test_case_elapsed(history, "test_case", 1.0);
+    cut_test_history_add_test_case_elapsed(history, "test_case", 100.0);
+    cut_assert_true(cut_test_history_get_test_case_elapsed(history,
+                                                           "test_case",
+                                                           &elapsed));
+    cut_assert_equal_double(3.0, 0.0, elapsed);
+
+    cut_test_history_add_test_case_elapsed(history, "test_case", 4.0);
+    cut_assert_true(cut_test_history_get_test_case_elapsed(history,
+                                                           "test_case",
+                                                           &elapsed));
+    cut_assert_equal_double(3.5, 0.0, elapsed);
+
+    cut_test_history_add_test_elapsed(history, "test_case", "test_a", 0.5);
+    cut_assert_true(cut_test_history_get_test_elapsed(history,
+                                                      "test_case",
+                                                      "test_a",
+                                                      &elapsed));
+    cut_assert_equal_double(0.5, 0.0, elapsed);
+}
+
+void
+test_unknown (void)
+{
+    gdouble elapsed;
+
+    cut_test_history_add_test_elapsed(history, "test_case", "test_a", 0.5);
+    cut_assert_false(cut_test_history_get_test_case_elapsed(history,
+                                                            "test_case",
+                                                            &elapsed));
+    cut_assert_false(cut_test_history_get_test_elapsed(history,
+                                                       "test_case",
+                                                       "test_b",
+                                                       &elapsed));
+    cut_assert_false(cut_test_history_get_test_elapsed(history,
+                                                       "other_test_case",
+                                                       "test_a",
+                                                       &elapsed));
+}
+
+void
+test_baseline (void)
+{
+    gdouble median = 0.0, mad = 0.0;
+
+    cut_assert_equal_uint(0,
+                          cut_test_history_get_test_elapsed_baseline(history,
+                                                                     "test_case",
+                                                                     "test_a",
+                                                                     &median,
+                                                                     &mad));
+
+    cut_test_history_add_test_elapsed(history, "test_case", "test_a", 1.0);
+    cut_test_history_add_test_elapsed(history, "test_case", "test_a", 1.2);
+    cut_test_history_add_test_elapsed(history, "test_case", "test_a", 0.9);
+    cut_test_history_add_test_elapsed(history, "test_case", "test_a", 10.0);
+    cut_test_history_add_test_elapsed(history, "test_case", "test_a", 1.1);
+    cut_assert_equal_uint(5,
+                          cut_test_history_get_test_elapsed_baseline(history,
+                                                                     "test_case",
+                                                                     "test_a",
+                                                                     &median,
+                                                                     &mad));
+    cut_assert_equal_double(1.1, 0.0001, median);
+    cut_assert_equal_double(0.1, 0.0001, mad);
+}
+
+void
+test_iterated_test_baseline (void)
+{
+    gdouble median = 0.0, mad = 0.0;
+
+    cut_test_history_add_iterated_test_elapsed(history,
+                                               "test_case", "test_a", "small",
+                                               0.1);
+    cut_test_history_add_iterated_test_elapsed(history,
+                                               "test_case", "test_a", "large",
+                                               2.0);
+    cut_test_history_add_iterated_test_elapsed(history,
+                                               "test_case", "test_a", "large",
+                                               3.0);
+
+    cut_assert_equal_uint(1,
+                          cut_test_history_get_iterated_test_elapsed_baseline(
+                              history, "test_case", "test_a", "small",
+                              &median, &mad));
+    cut_assert_equal_double(0.1, 0.0001, median);
+    cut_assert_equal_uint(2,
+                          cut_test_history_get_iterated_test_elapsed_baseline(
+                              history, "test_case", "test_a", "large",
+                              &median, &mad));
+    cut_assert_equal_double(2.5, 0.0001, median);
+    cut_assert_equal_double(0.5, 0.0001, mad);
+    cut_assert_equal_uint(0,
+                          cut_test_history_get_test_elapsed_baseline(
+                              history, "test_case", "test_a",
+                              &median, &mad));
+}
+
+void
+test_load (void)
+{
+    GError *error = NULL;
+    gdouble elapsed;
+
+    cut_assert_true(cut_test_history_load(history, log_directory, 0, &error));
+    gcut_assert_error(error);
+    cut_assert_equal_uint(3, cut_test_history_get_n_runs(history));
+
+    cut_assert_true(cut_test_history_get_test_case_elapsed(history,
+                                                           "test_fast",
+                                                           &elapsed));
+    cut_assert_equal_double(0.2, 0.0001, elapsed);
+    cut_assert_true(cut_test_history_get_test_case_elapsed(history,
+                                                           "test_slow",
+                                                           &elapsed));
+    cut_assert_equal_double(2.0, 0.0001, elapsed);
+    cut_assert_true(cut_test_history_get_test_elapsed(history,
+                                                      "test_slow",
+                                                      "test_run",
+                                                      &elapsed));
+    cut_assert_equal_double(2.0, 0.0001, elapsed);
+}
+
+void
+test_load_max_runs (void)
+{
+    GError *error = NULL;
+    gdouble elapsed;
+
+    cut_assert_true(cut_test_history_load(history, log_directory, 2, &error));
+    gcut_assert_error(error);
+    cut_assert_equal_uint(2, cut_test_history_get_n_runs(history));
+
+    cut_assert_true(cut_test_history_get_test_case_elapsed(history,
+                                                           "test_fast",
+                                                           &elapsed));
+    cut_assert_equal_double(0.25, 0.0001, elapsed);
+    cut_assert_true(cut_test_history_get_test_case_elapsed(history,
+                                                           "test_slow",
+                                                           &elapsed));
+    cut_assert_equal_double(1.5, 0.0001, elapsed);
+}
+
+void
+test_load_nonexistent (void)
+{
+    GError *error = NULL;
+    gchar *nonexistent;
+
+    nonexistent = g_build_filename(log_directory, "nonexistent", NULL);
+    cut_take_string(nonexistent);
+    cut_assert_false(cut_test_history_load(history, nonexistent, 0, &error));
+    cut_assert_not_null(error);
+    g_error_free(error);
+    cut_assert_equal_uint(0, cut_test_history_get_n_runs(history));
+}
+
+void
+test_load_iterated_test (void)
+{
+    GError *error = NULL;
+    const gchar *file_name;
+    gdouble median = 0.0, mad = 0.0;
+
+    file_name = cut_take_string(g_build_filename(log_directory,
+                                                 "iterated-test.xml",
+                                                 NULL));
+    cut_assert_true(cut_test_history_load_file(history, file_name, &error));
+    gcut_assert_error(error);
+
+    cut_assert_equal_uint(1,
+                          cut_test_history_get_iterated_test_elapsed_baseline(
+                              history, "test_data", "test_run", "small",
+                              &median, &mad));
+    cut_assert_equal_double(0.1, 0.0001, median);
+    cut_assert_equal_uint(1,
+                          cut_test_history_get_iterated_test_elapsed_baseline(
+                              history, "test_data", "test_run", "large",
+                              &median, &mad));
+    cut_assert_equal_double(2.0, 0.0001, median);
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
@@ -0,0 +1,231 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <glib/gstdio.h>
+#include <gcutter.h>
+#include <cutter/cut-test-index.h>
+
+#include "../lib/cuttest-utils.h"
+
+void test_store_and_lookup(void);
+void test_lookup_modified(void);
+void test_lookup_need_all_symbols(void);
+void test_save_and_load(void);
+void test_save_removes_vanished_module(void);
+void data_load_other_version(void);
+void test_load_other_version(gconstpointer data);
+
+static gchar *tmp_dir;
+static gchar *module_file;
+static CutTestIndex *test_index;
+static GList *symbols;
+
+void
+cut_setup (void)
+{
+    GError *error = NULL;
+    const gchar *index_file;
+
+    test_index = NULL;
+    symbols = NULL;
+
+    tmp_dir = g_build_filename(cuttest_get_base_dir(),
+                               "tmp-test-index",
+                               NULL);
+    cut_remove_path(tmp_dir, NULL);
+    if (g_mkdir_with_parents(tmp_dir, 0700) == -1)
+        cut_error_errno();
+
+    module_file = g_build_filename(tmp_dir, "test-module.so", NULL);
+    g_file_set_contents(module_file, "not an ELF", -1, &error);
+    gcut_assert_error(error);
+
+    index_file = cut_take_string(g_build_filename(tmp_dir, "index", NULL));
+    test_index = cut_test_index_new(index_file);
+}
+
+void
+cut_teardown (void)
+{
+    if (test_index)
+        cut_test_index_free(test_index);
+    if (symbols) {
+        g_list_foreach(symbols, (GFunc)g_free, NULL);
+        g_list_free(symbols);
+    }
+    g_free(module_file);
+    if (tmp_dir) {
+        cut_remove_path(tmp_dir, NULL);
+        g_free(tmp_dir);
+    }
+}
+
+static const GList *
+stored_symbols (void)
+{
+    return gcut_take_new_list_string("test_a", "test_b", "setup", NULL);
+}
+
+void
+test_store_and_lookup (void)
+{
+    gboolean support_attribute = FALSE;
+
+    cut_assert_false(cut_test_index_lookup(test_index, module_file, FALSE,
+                                           &symbols, &support_attribute));
+
+    cut_test_index_store(test_index, module_file,
+                         FALSE, stored_symbols(), TRUE);
+    cut_assert_true(cut_test_index_lookup(test_index, module_file, FALSE,
+                                          &symbols, &support_attribute));
+    gcut_assert_equal_list_string(stored_symbols(), symbols);
+    cut_assert_true(support_attribute);
+}
+
+void
+test_lookup_modified (void)
+{
+    GError *error = NULL;
+    gboolean support_attribute;
+
+    cut_test_index_store(test_index, module_file,
+                         FALSE, stored_symbols(), FALSE);
+
+    g_file_set_contents(module_file, "modified module", -1, &error);
+    gcut_assert_error(error);
+    cut_assert_false(cut_test_index_lookup(test_index, module_file, FALSE,
+                                           &symbols, &support_attribute));
+}
+
+void
+test_lookup_need_all_symbols (void)
+{
+    gboolean support_attribute;
+
+    cut_test_index_store(test_index, module_file,
+                         FALSE, stored_symbols(), FALSE);
+    cut_assert_false(cut_test_index_lookup(test_index, module_file, TRUE,
+                                           &symbols, &support_attribute));
+
+    cut_test_index_store(test_index, module_file,
+                         TRUE, stored_symbols(), FALSE);
+    cut_assert_true(cut_test_index_lookup(test_index, module_file, TRUE,
+                                          &symbols, &support_attribute));
+    gcut_assert_equal_list_string(stored_symbols(), symbols);
+}
+
+void
+test_save_and_load (void)
+{
+    GError *error = NULL;
+    CutTestIndex *loaded_index;
+    gboolean support_attribute = FALSE;
+
+    cut_test_index_store(test_index, module_file,
+                         FALSE, stored_symbols(), TRUE);
+    cut_test_index_save(test_index, &error);
+    gcut_assert_error(error);
+    cut_assert_path_exist(cut_test_index_get_file_name(test_index));
+
+    loaded_index = cut_test_index_new(cut_test_index_get_file_name(test_index));
+    cut_take(loaded_index, (CutDestroyFunction)cut_test_index_free);
+    cut_test_index_load(loaded_index, &error);
+    gcut_assert_error(error);
+    cut_assert_true(cut_test_index_lookup(loaded_index, module_file, FALSE,
+                                          &symbols, &support_attribute));
+    gcut_assert_equal_list_string(stored_symbols(), symbols);
+    cut_assert_true(support_attribute);
+}
+
+void
+test_save_removes_vanished_module (void)
+{
+    GError *error = NULL;
+    gchar *data = NULL;
+
+    cut_test_index_store(test_index, module_file,
+                         FALSE, stored_symbols(), FALSE);
+    if (g_unlink(module_file) == -1)
+        cut_assert_errno();
+    cut_test_index_save(test_index, &error);
+    gcut_assert_error(error);
+
+    g_file_get_contents(cut_test_index_get_file_name(test_index), &data, NULL,
+                        &error);
+    gcut_assert_error(error);
+    cut_take_string(data);
+    cut_assert_null(strstr(data, "test-module.so"));
+}
+
+void
+data_load_other_version (void)
+{
+    cut_add_data("no version", NULL, NULL,
+                 "old version", "0", NULL,
+                 "newer version", "999", NULL);
+}
+
+void
+test_load_other_version (gconstpointer data)
+{
+    const gchar *version = data;
+    GError *error = NULL;
+    GKeyFile *key_file;
+    CutTestIndex *loaded_index;
+    const gchar *index_file;
+    gchar *index_data = NULL;
+    gboolean support_attribute = FALSE;
+
+    index_file = cut_test_index_get_file_name(test_index);
+    cut_test_index_store(test_index, module_file,
+                         FALSE, stored_symbols(), TRUE);
+    cut_test_index_save(test_index, &error);
+    gcut_assert_error(error);
+
+    key_file = g_key_file_new();
+    cut_take(key_file, (CutDestroyFunction)g_key_file_free);
+    g_key_file_load_from_file(key_file, index_file, G_KEY_FILE_NONE, &error);
+    gcut_assert_error(error);
+    if (version)
+        g_key_file_set_string(key_file, "test-index", "version", version);
+    else
+        g_key_file_remove_group(key_file, "test-index", NULL);
+    index_data = g_key_file_to_data(key_file, NULL, NULL);
+    g_file_set_contents(index_file, index_data, -1, &error);
+    g_free(index_data);
+    gcut_assert_error(error);
+
+    loaded_index = cut_test_index_new(index_file);
+    cut_take(loaded_index, (CutDestroyFunction)cut_test_index_free);
+    cut_test_index_load(loaded_index, &error);
+    gcut_assert_error(error);
+    cut_assert_false(cut_test_index_lookup(loaded_index, module_file, FALSE,
+                                           &symbols, &support_attribute));
+
+    cut_test_index_save(loaded_index, &error);
+    gcut_assert_error(error);
+    g_file_get_contents(index_file, &index_data, NULL, &error);
+    gcut_assert_error(error);
+    cut_take_string(index_data);
+    cut_assert_null(strstr(index_data, "test-module.so"));
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
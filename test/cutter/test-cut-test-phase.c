@@ -0,0 +1,108 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gcutter.h>
+#include <cutter/cut-test-phase.h>
+
+void test_init(void);
+void test_add(void);
+void test_to_string(void);
+void test_set_value(void);
+void test_set_value_invalid(void);
+void test_to_xml_string(void);
+
+static CutPhaseElapsed phase_elapsed;
+
+void
+cut_setup (void)
+{
+    cut_phase_elapsed_init(&phase_elapsed);
+}
+
+void
+test_init (void)
+{
+    cut_assert_true(cut_phase_elapsed_is_empty(&phase_elapsed));
+    cut_assert_equal_int(-1, phase_elapsed.elapsed[CUT_TEST_PHASE_TEST]);
+}
+
+void
+test_add (void)
+{
+    cut_phase_elapsed_add(&phase_elapsed, CUT_TEST_PHASE_SETUP, 100);
+    cut_phase_elapsed_add(&phase_elapsed, CUT_TEST_PHASE_SETUP, 20);
+    cut_phase_elapsed_add(&phase_elapsed, CUT_TEST_PHASE_TEARDOWN, -5);
+
+    cut_assert_false(cut_phase_elapsed_is_empty(&phase_elapsed));
+    cut_assert_equal_int(120, phase_elapsed.elapsed[CUT_TEST_PHASE_SETUP]);
+    cut_assert_equal_int(0, phase_elapsed.elapsed[CUT_TEST_PHASE_TEARDOWN]);
+    cut_assert_equal_int(-1, phase_elapsed.elapsed[CUT_TEST_PHASE_TEST]);
+}
+
+void
+test_to_string (void)
+{
+    cut_assert_equal_string("startup",
+                            cut_test_phase_to_string(CUT_TEST_PHASE_STARTUP));
+    cut_assert_equal_string("data-setup",
+                            cut_test_phase_to_string(CUT_TEST_PHASE_DATA_SETUP));
+    cut_assert_equal_string("teardown",
+                            cut_test_phase_to_string(CUT_TEST_PHASE_TEARDOWN));
+    cut_assert_null(cut_test_phase_to_string(CUT_TEST_PHASE_LAST));
+}
+
+void
+test_set_value (void)
+{
+    cut_assert_true(cut_phase_elapsed_set_value(&phase_elapsed,
+                                                "test", "0.000001234"));
+    cut_assert_equal_int(1234, phase_elapsed.elapsed[CUT_TEST_PHASE_TEST]);
+}
+
+void
+test_set_value_invalid (void)
+{
+    cut_assert_false(cut_phase_elapsed_set_value(&phase_elapsed,
+                                                 "unknown", "1.0"));
+    cut_assert_false(cut_phase_elapsed_set_value(&phase_elapsed,
+                                                 "setup", "slow"));
+    cut_assert_false(cut_phase_elapsed_set_value(&phase_elapsed,
+                                                 "setup", "-1.0"));
+}
+
+void
+test_to_xml_string (void)
+{
+    GString *string;
+
+    phase_elapsed.elapsed[CUT_TEST_PHASE_SETUP] = 1500;
+    phase_elapsed.elapsed[CUT_TEST_PHASE_TEST] = 2000000001;
+
+    string = g_string_new(NULL);
+    cut_phase_elapsed_to_xml_string(&phase_elapsed, string, 2);
+    cut_assert_equal_string("  <phase-elapsed>\n"
+                            "    <setup>0.000001500</setup>\n"
+                            "    <test>2.000000001</test>\n"
+                            "  </phase-elapsed>\n",
+                            cut_take_string(g_string_free(string, FALSE)));
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
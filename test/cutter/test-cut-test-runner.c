@@ -1,9 +1,14 @@
-#include <cutter.h>
+#include <gcutter.h>
 #include <cutter/cut-test-runner.h>
+#include <cutter/cut-test-history.h>
 
 #include "../lib/cuttest-utils.h"
 
 void test_sort_test_cases (void);
+void test_sort_test_cases_by_elapsed (void);
+void test_shard_test_cases (void);
+void test_shard_test_cases_by_elapsed (void);
+void test_shard_test_cases_with_different_histories (void);
 void test_n_ (void);
 void test_get_test_directory (void);
 void test_get_source_directory (void);
@@ -156,6 +161,194 @@ test_sort_test_cases (void)
     cut_assert_equal_string_array(expected_names, actual_names);
 }
 
+void
+test_sort_test_cases_by_elapsed (void)
+{
+    CutTestHistory *history;
+
+    test_cases = g_list_append(test_cases,
+                               cut_test_case_new("abc", NULL, NULL,
+                                                 NULL, NULL));
+    test_cases = g_list_append(test_cases,
+                               cut_test_case_new("xyz", NULL, NULL,
+                                                 NULL, NULL));
+    test_cases = g_list_append(test_cases,
+                               cut_test_case_new("123", NULL, NULL,
+                                                 NULL, NULL));
+    test_cases = g_list_append(test_cases,
+                               cut_test_case_new("XYZ", NULL, NULL,
+                                                 NULL, NULL));
+
+    cut_run_context_set_test_case_order(run_context,
+                                        CUT_ORDER_ELAPSED_DESCENDING);
+    test_cases = cut_run_context_sort_test_cases(run_context, test_cases);
+    expected_names = g_strsplit("123 XYZ abc xyz", " ", -1);
+    actual_names = collect_test_case_names(test_cases);
+    cut_assert_equal_string_array(expected_names, actual_names);
+    g_strfreev(expected_names);
+    g_strfreev(actual_names);
+
+    history = cut_run_context_get_test_history(run_context);
+    cut_test_history_add_test_case_elapsed(history, "xyz", 0.5);
+    cut_test_history_add_test_case_elapsed(history, "abc", 2.0);
+    test_cases = cut_run_context_sort_test_cases(run_context, test_cases);
+    expected_names = g_strsplit("abc xyz 123 XYZ", " ", -1);
+    actual_names = collect_test_case_names(test_cases);
+    cut_assert_equal_string_array(expected_names, actual_names);
+}
+
+static GList *
+create_test_cases (const gchar *names)
+{
+    GList *cases = NULL;
+    gchar **split_names, **name;
+
+    split_names = g_strsplit(names, " ", -1);
+    for (name = split_names; *name; name++) {
+        cases = g_list_append(cases,
+                              cut_test_case_new(*name, NULL, NULL,
+                                                NULL, NULL));
+    }
+    g_strfreev(split_names);
+
+    return cases;
+}
+
+void
+test_shard_test_cases (void)
+{
+    GHashTable *seen_names;
+    gint shard;
+
+    test_cases = create_test_cases("a b c d e f g h i j k l m n o p");
+    seen_names = g_hash_table_new(g_str_hash, g_str_equal);
+    gcut_take_hash_table(seen_names);
+
+    for (shard = 0; shard < 3; shard++) {
+        GList *sharded_test_cases, *node;
+
+        cut_run_context_set_shard(run_context, shard, 3);
+        sharded_test_cases =
+            cut_run_context_shard_test_cases(run_context,
+                                             g_list_copy(test_cases));
+        for (node = sharded_test_cases; node; node = g_list_next(node)) {
+            const gchar *name;
+
+            name = cut_test_get_name(CUT_TEST(node->data));
+            cut_assert_null(g_hash_table_lookup(seen_names, name),
+                            cut_message("<%s> is in two shards", name));
+            g_hash_table_insert(seen_names, (gpointer)name, (gpointer)name);
+        }
+        g_list_free(sharded_test_cases);
+    }
+
+    cut_assert_equal_uint(g_list_length(test_cases),
+                          g_hash_table_size(seen_names));
+}
+
+static const gchar *
+shard_log_file_name (void)
+{
+    return cut_take_string(g_build_filename(cuttest_get_base_dir(),
+                                            "fixtures",
+                                            "test-history",
+                                            "2014-01-01-00-00-00.xml",
+                                            NULL));
+}
+
+void
+test_shard_test_cases_by_elapsed (void)
+{
+    CutTestHistory *history;
+    GList *sharded_test_cases;
+
+    test_cases = create_test_cases("test_slow test_fast a");
+    /* the own history must not be used for sharding. */
+    history = cut_run_context_get_test_history(run_context);
+    cut_test_history_add_test_case_elapsed(history, "test_fast", 100.0);
+    cut_run_context_set_shard_log(run_context, shard_log_file_name());
+
+    cut_run_context_set_shard(run_context, 0, 2);
+    sharded_test_cases =
+        cut_run_context_shard_test_cases(run_context, g_list_copy(test_cases));
+    expected_names = g_strsplit("test_fast a", " ", -1);
+    actual_names = collect_test_case_names(sharded_test_cases);
+    g_list_free(sharded_test_cases);
+    cut_assert_equal_string_array(expected_names, actual_names);
+    g_strfreev(expected_names);
+    g_strfreev(actual_names);
+
+    cut_run_context_set_shard(run_context, 1, 2);
+    sharded_test_cases =
+        cut_run_context_shard_test_cases(run_context, g_list_copy(test_cases));
+    expected_names = g_strsplit("test_slow", " ", -1);
+    actual_names = collect_test_case_names(sharded_test_cases);
+    g_list_free(sharded_test_cases);
+    cut_assert_equal_string_array(expected_names, actual_names);
+}
+
+static void
+assert_shard_with_different_histories (const gchar *shard_log)
+{
+    GHashTable *n_shards;
+    GList *node;
+    gint shard, n_shard_contexts = 3;
+
+    n_shards = g_hash_table_new(g_str_hash, g_str_equal);
+    gcut_take_hash_table(n_shards);
+
+    for (shard = 0; shard < n_shard_contexts; shard++) {
+        CutRunContext *shard_context;
+        CutTestHistory *history;
+        GList *sharded_test_cases;
+
+        /* each shard has its own --log-directory contents. */
+        shard_context = CUT_RUN_CONTEXT(cut_test_runner_new());
+        history = cut_run_context_get_test_history(shard_context);
+        for (node = test_cases; node; node = g_list_next(node)) {
+            cut_test_history_add_test_case_elapsed(
+                history,
+                cut_test_get_name(CUT_TEST(node->data)),
+                g_random_double_range(0.0, 10.0));
+        }
+        cut_run_context_set_shard_log(shard_context, shard_log);
+        cut_run_context_set_shard(shard_context, shard, n_shard_contexts);
+        sharded_test_cases =
+            cut_run_context_shard_test_cases(shard_context,
+                                             g_list_copy(test_cases));
+        for (node = sharded_test_cases; node; node = g_list_next(node)) {
+            const gchar *name;
+
+            name = cut_test_get_name(CUT_TEST(node->data));
+            g_hash_table_insert(n_shards, (gpointer)name,
+                                GUINT_TO_POINTER(GPOINTER_TO_UINT(
+                                    g_hash_table_lookup(n_shards, name)) + 1));
+        }
+        g_list_free(sharded_test_cases);
+        g_object_unref(shard_context);
+    }
+
+    for (node = test_cases; node; node = g_list_next(node)) {
+        const gchar *name;
+
+        name = cut_test_get_name(CUT_TEST(node->data));
+        cut_assert_equal_uint(1,
+                              GPOINTER_TO_UINT(g_hash_table_lookup(n_shards,
+                                                                   name)),
+                              cut_message("<%s>", name));
+    }
+}
+
+void
+test_shard_test_cases_with_different_histories (void)
+{
+    test_cases = create_test_cases("test_slow test_fast "
+                                   "a b c d e f g h i j k l m n o p");
+
+    cut_trace(assert_shard_with_different_histories(NULL));
+    cut_trace(assert_shard_with_different_histories(shard_log_file_name()));
+}
+
 void
 test_n_ (void)
 {
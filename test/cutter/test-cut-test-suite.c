@@ -1,11 +1,14 @@
 #ifdef HAVE_CONFIG_H
 #  include <config.h>
 #endif
-#include <cutter.h>
+#include <gcutter.h>
 #include <cutter/cut-test-runner.h>
 #include <cutter/cut-test-case.h>
 #include <cutter/cut-test-suite.h>
 #include <cutter/cut-loader.h>
+#include <cutter/cut-crash-backtrace.h>
+
+#include <signal.h>
 
 #include "../lib/cuttest-utils.h"
 
@@ -20,6 +23,7 @@ void test_run_test_in_test_case_with_regex (void);
 void test_run_test_with_regex_in_test_case_with_regex (void);
 void test_run_test_in_test_case_with_null (void);
 void test_run_test_with_filter_with_null (void);
+void test_crash_in_thread_with_running_test (void);
 
 static CutRunContext *run_context;
 static CutTestSuite *test_object;
@@ -33,6 +37,10 @@ static gint n_run_stock_run_test_function = 0;
 static gint n_run_stock_test_function1 = 0;
 static gint n_run_stock_test_function2 = 0;
 
+static volatile gint n_waiting_tests = 0;
+static volatile gint n_crash_tests = 0;
+static gint n_success_tests = 0;
+
 static void
 stub_test_function1 (void)
 {
@@ -86,6 +94,10 @@ cut_setup (void)
     n_run_stock_test_function2 = 0;
     n_run_stock_run_test_function = 0;
 
+    n_waiting_tests = 0;
+    n_crash_tests = 0;
+    n_success_tests = 0;
+
     run_context = CUT_RUN_CONTEXT(cut_test_runner_new());
 
     test_object = cut_test_suite_new_empty();
@@ -126,6 +138,8 @@ cut_setup (void)
 void
 cut_teardown (void)
 {
+    cut_crash_backtrace_set_show_on_the_moment(TRUE);
+
     g_object_unref(loader);
     g_object_unref(test_object);
     g_object_unref(run_context);
@@ -297,6 +311,98 @@ test_run_test_with_filter_with_null (void)
     cut_assert_equal_int(1, n_run_stock_run_test_function);
 }
 
+#ifndef G_OS_WIN32
+static gboolean
+wait_count (volatile gint *count)
+{
+    GTimer *timer;
+    gboolean counted;
+
+    timer = g_timer_new();
+    while (!(counted = g_atomic_int_get(count) > 0) &&
+           g_timer_elapsed(timer, NULL) < 10.0) {
+        g_usleep(1000);
+    }
+    g_timer_destroy(timer);
+
+    return counted;
+}
+
+static void
+stub_crash_test (void)
+{
+    cut_assert_true(wait_count(&n_waiting_tests));
+    raise(SIGABRT);
+}
+
+static void
+stub_wait_crash_test (void)
+{
+    g_atomic_int_inc(&n_waiting_tests);
+    cut_assert_true(wait_count(&n_crash_tests));
+}
+
+static void
+cb_count_crash_test (CutRunContext *run_context, CutTest *test,
+                     CutTestContext *test_context, CutTestResult *result,
+                     gpointer data)
+{
+    g_atomic_int_inc(&n_crash_tests);
+}
+
+static void
+cb_count_success_test (CutRunContext *run_context, CutTest *test,
+                       CutTestContext *test_context, CutTestResult *result,
+                       gpointer data)
+{
+    g_atomic_int_inc(&n_success_tests);
+}
+#endif
+
+void
+test_crash_in_thread_with_running_test (void)
+{
+#ifdef G_OS_WIN32
+    cut_omit("crash isn't supported yet on Windows.");
+#else
+    const gchar *test_names[] = {"/.*/", NULL};
+    CutTestSuite *test_suite;
+    CutTestCase *test_case;
+
+    cut_crash_backtrace_set_show_on_the_moment(FALSE);
+    cut_run_context_set_multi_thread(run_context, TRUE);
+    cut_run_context_set_max_threads(run_context, 2);
+    cut_run_context_set_target_test_names(run_context, test_names);
+
+    test_suite = cut_test_suite_new_empty();
+    gcut_take_object(G_OBJECT(test_suite));
+    test_case = cut_test_case_new("crash-test-case", NULL, NULL, NULL, NULL);
+    cuttest_add_test(test_case, "stub_crash_test", stub_crash_test);
+    cut_test_suite_add_test_case(test_suite, test_case);
+    g_object_unref(test_case);
+    test_case = cut_test_case_new("wait-test-case", NULL, NULL, NULL, NULL);
+    cuttest_add_test(test_case, "stub_wait_crash_test", stub_wait_crash_test);
+    cut_test_suite_add_test_case(test_suite, test_case);
+    g_object_unref(test_case);
+
+    g_signal_connect(run_context, "crash-test",
+                     G_CALLBACK(cb_count_crash_test), NULL);
+    g_signal_connect(run_context, "success-test",
+                     G_CALLBACK(cb_count_success_test), NULL);
+    cut_assert_false(cut_test_runner_run_test_suite(CUT_TEST_RUNNER(run_context),
+                                                    test_suite));
+    g_signal_handlers_disconnect_by_func(run_context,
+                                         G_CALLBACK(cb_count_crash_test),
+                                         NULL);
+    g_signal_handlers_disconnect_by_func(run_context,
+                                         G_CALLBACK(cb_count_success_test),
+                                         NULL);
+
+    cut_assert_equal_int(1, g_atomic_int_get(&n_crash_tests));
+    cut_assert_equal_int(1, g_atomic_int_get(&n_success_tests));
+#endif
+}
+
 /*
 vi:ts=4:nowrap:ai:expandtab:sw=4
 */
@@ -2,6 +2,7 @@
 #include <cutter/cut-test.h>
 #include <cutter/cut-test-runner.h>
 #include <cutter/cut-crash-backtrace.h>
+#include <cutter/cut-event-sink.h>
 
 #ifndef G_OS_WIN32
 #  include <signal.h>
@@ -14,6 +15,7 @@ void test_start_signal(void);
 void test_complete_signal(void);
 void test_error_signal(void);
 void test_pass_assertion_signal(void);
+void test_pass_assertions_signal(void);
 void test_failure_signal(void);
 void test_pending_signal(void);
 void test_notification_signal(void);
@@ -22,6 +24,9 @@ void test_crash_signal (void);
 void test_test_function(void);
 void test_set_elapsed(void);
 void test_start_time(void);
+void test_event_sink(void);
+void test_event_sink_failure(void);
+void test_event_sink_without_pass_assertion(void);
 
 static CutRunContext *run_context;
 static CutTest *test;
@@ -33,9 +38,15 @@ static gint n_failure_signal = 0;
 static gint n_error_signal = 0;
 static gint n_pending_signal = 0;
 static gint n_pass_assertion_signal = 0;
+static gint n_pass_assertions_signal = 0;
+static guint n_passed_assertions = 0;
 static gint n_notification_signal = 0;
 static gint n_omission_signal = 0;
 static gint n_crash_signal = 0;
+static gint n_sink_start = 0;
+static gint n_sink_result = 0;
+static gint n_sink_complete = 0;
+static guint n_sink_passed_assertions = 0;
 
 static void
 stub_test_function (void)
@@ -88,8 +99,14 @@ cut_setup (void)
     n_pending_signal = 0;
     n_notification_signal = 0;
     n_pass_assertion_signal = 0;
+    n_pass_assertions_signal = 0;
+    n_passed_assertions = 0;
     n_omission_signal = 0;
     n_crash_signal = 0;
+    n_sink_start = 0;
+    n_sink_result = 0;
+    n_sink_complete = 0;
+    n_sink_passed_assertions = 0;
 
     run_context = CUT_RUN_CONTEXT(cut_test_runner_new());
 
@@ -148,6 +165,14 @@ cb_pass_assertion_signal (CutTest *test, gpointer data)
     n_pass_assertion_signal++;
 }
 
+static void
+cb_pass_assertions_signal (CutTest *test, CutTestContext *test_context,
+                           guint n_assertions, gpointer data)
+{
+    n_pass_assertions_signal++;
+    n_passed_assertions += n_assertions;
+}
+
 static void
 cb_omission_signal (CutTest *test, gpointer data)
 {
@@ -358,6 +383,21 @@ test_pass_assertion_signal (void)
     cut_assert_equal_uint(3, n_pass_assertion_signal);
 }
 
+void
+test_pass_assertions_signal (void)
+{
+    test = cut_test_new("stub-test", stub_test_function);
+
+    g_signal_connect(test, "pass_assertions",
+                     G_CALLBACK(cb_pass_assertions_signal), NULL);
+    cut_assert_true(run());
+    g_signal_handlers_disconnect_by_func(test,
+                                         G_CALLBACK(cb_pass_assertions_signal),
+                                         NULL);
+    cut_assert_equal_uint(1, n_pass_assertions_signal);
+    cut_assert_equal_uint(3, n_passed_assertions);
+}
+
 void
 test_set_elapsed (void)
 {
@@ -398,6 +438,112 @@ test_start_time (void)
 }
 
 
+static void
+cb_sink_start (CutTest *test, CutTestContext *test_context, gpointer data)
+{
+    n_sink_start++;
+}
+
+static void
+cb_sink_pass_assertions (CutTest *test, CutTestContext *test_context,
+                         guint n_assertions, gpointer data)
+{
+    n_sink_passed_assertions += n_assertions;
+}
+
+static void
+cb_sink_result (CutTest *test, CutTestContext *test_context,
+                CutTestResult *result, gpointer data)
+{
+    n_sink_result++;
+}
+
+static void
+cb_sink_complete (CutTest *test, CutTestContext *test_context,
+                  gboolean success, gpointer data)
+{
+    n_sink_complete++;
+}
+
+static const CutEventSink event_sink = {
+    cb_sink_start,
+    NULL,
+    cb_sink_pass_assertions,
+    cb_sink_result,
+    cb_sink_complete
+};
+
+static gboolean
+run_with_event_sink (CutTestResultStatus *status)
+{
+    gboolean success;
+    CutTestContext *test_context;
+
+    test_context = cut_test_context_new(run_context, NULL, NULL, NULL, test);
+    cut_test_context_set_event_sink(test_context, &event_sink, NULL);
+    cut_test_context_current_push(test_context);
+    success = cut_test_run(test, test_context, run_context);
+    cut_test_context_current_pop();
+    *status = cut_test_context_get_result_status(test_context);
+
+    g_object_unref(test_context);
+
+    return success;
+}
+
+void
+test_event_sink (void)
+{
+    CutTestResultStatus status;
+
+    test = cut_test_new("stub-test", stub_test_function);
+
+    cut_assert_true(run_with_event_sink(&status));
+    cut_assert_equal_int(1, n_sink_start);
+    cut_assert_equal_uint(3, n_sink_passed_assertions);
+    cut_assert_equal_int(1, n_sink_result);
+    cut_assert_equal_int(1, n_sink_complete);
+    cut_assert_equal_int(CUT_TEST_RESULT_SUCCESS, status);
+}
+
+void
+test_event_sink_failure (void)
+{
+    CutTestResultStatus status;
+
+    test = cut_test_new("stub-failure-test", stub_fail_function);
+
+    cut_assert_false(run_with_event_sink(&status));
+    cut_assert_equal_int(1, n_sink_start);
+    cut_assert_equal_int(1, n_sink_result);
+    cut_assert_equal_int(1, n_sink_complete);
+    cut_assert_equal_int(CUT_TEST_RESULT_FAILURE, status);
+}
+
+void
+test_event_sink_without_pass_assertion (void)
+{
+    CutTestResultStatus status;
+
+    test = cut_test_new("stub-test", stub_test_function);
+
+    g_signal_connect(test, "pass_assertion",
+                     G_CALLBACK(cb_pass_assertion_signal), NULL);
+    g_signal_connect(test, "pass_assertions",
+                     G_CALLBACK(cb_pass_assertions_signal), NULL);
+    cut_assert_true(run_with_event_sink(&status));
+    g_signal_handlers_disconnect_by_func(test,
+                                         G_CALLBACK(cb_pass_assertion_signal),
+                                         NULL);
+    g_signal_handlers_disconnect_by_func(test,
+                                         G_CALLBACK(cb_pass_assertions_signal),
+                                         NULL);
+
+    cut_assert_equal_uint(3, n_sink_passed_assertions);
+    cut_assert_equal_int(0, n_pass_assertion_signal);
+    cut_assert_equal_uint(3, n_passed_assertions);
+}
+
 /*
 vi:ts=4:nowrap:ai:expandtab:sw=4
 */
@@ -1,6 +1,6 @@
 /* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
 /*
- *  Copyright (C) 2009-2010  Kouhei Sutou <kou@clear-code.com>
+ *  Copyright (C) 2009-2014  Kouhei Sutou <kou@clear-code.com>
  *
  *  This library is free software: you can redistribute it and/or modify
  *  it under the terms of the GNU Lesser General Public License as published by
@@ -44,6 +44,11 @@
 void test_inspect_memory (void);
 void test_inspect_memory_with_printable (void);
 void test_inspect_memory_huge_data (void);
+void test_equal_memory (void);
+void test_find_memory_difference (void);
+void test_find_memory_difference_different_size (void);
+void test_inspect_memory_difference (void);
+void test_inspect_memory_difference_full (void);
 void test_compare_string_array (void);
 void test_inspect_string_array (void);
 void test_inspect_string (void);
@@ -150,6 +155,142 @@ test_inspect_memory_huge_data (void)
 #undef INSPECT_SIZE
 }
 
+void
+test_equal_memory (void)
+{
+    gchar memory1[] = {0x00, 0x01, 0x02};
+    gchar memory2[] = {0x00, 0x01, 0x02};
+    gchar memory3[] = {0x00, 0x01, 0x03};
+
+    cut_assert_true(cut_utils_equal_memory(memory1, sizeof(memory1),
+                                           memory1, sizeof(memory1)));
+    cut_assert_true(cut_utils_equal_memory(memory1, sizeof(memory1),
+                                           memory2, sizeof(memory2)));
+    cut_assert_true(cut_utils_equal_memory(NULL, 0, memory1, 0));
+    cut_assert_false(cut_utils_equal_memory(memory1, sizeof(memory1),
+                                            memory3, sizeof(memory3)));
+    cut_assert_false(cut_utils_equal_memory(memory1, sizeof(memory1),
+                                            memory2, sizeof(memory2) - 1));
+}
+
+void
+test_find_memory_difference (void)
+{
+#define MEMORY_SIZE 10000
+    CutMemoryDifference difference;
+    gchar *memory1, *memory2;
+
+    memory1 = g_new0(gchar, MEMORY_SIZE);
+    cut_take_memory(memory1);
+    memory2 = g_new0(gchar, MEMORY_SIZE);
+    cut_take_memory(memory2);
+    cut_assert_false(cut_utils_find_memory_difference(memory1, MEMORY_SIZE,
+                                                      memory2, MEMORY_SIZE,
+                                                      &difference));
+
+    memory2[5000] = 0x01;
+    memory2[5007] = 0x10;
+    memory2[9000] = 0x01;
+    cut_assert_true(cut_utils_find_memory_difference(memory1, MEMORY_SIZE,
+                                                     memory2, MEMORY_SIZE,
+                                                     &difference));
+    cut_assert_equal_size(5000, difference.first);
+    cut_assert_equal_size(9000, difference.last);
+    cut_assert_equal_size(3, difference.n_differences);
+#undef MEMORY_SIZE
+}
+
+void
+test_find_memory_difference_different_size (void)
+{
+    CutMemoryDifference difference;
+    gchar memory1[] = {0x00, 0x01, 0x02, 0x03};
+    gchar memory2[] = {0x00, 0x01, 0x12, 0x03, 0x04, 0x05};
+
+    cut_assert_true(cut_utils_find_memory_difference(memory1, sizeof(memory1),
+                                                     memory2, sizeof(memory2),
+                                                     &difference));
+    cut_assert_equal_size(2, difference.first);
+    cut_assert_equal_size(5, difference.last);
+    cut_assert_equal_size(3, difference.n_differences);
+}
+
+#define ZERO_ROW(offset)                                                \
+    offset ": 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00  "        \
+    "................"
+
+void
+test_inspect_memory_difference (void)
+{
+    gchar memory1[256], memory2[256];
+    CutMemoryDifference difference;
+    gchar *inspected1, *inspected2;
+
+    memset(memory1, 0, sizeof(memory1));
+    memset(memory2, 0, sizeof(memory2));
+    memory2[100] = 'A';
+    cut_assert_true(cut_utils_find_memory_difference(memory1, sizeof(memory1),
+                                                     memory2, sizeof(memory2),
+                                                     &difference));
+    cut_utils_inspect_memory_difference(memory1, sizeof(memory1),
+                                        memory2, sizeof(memory2),
+                                        &difference,
+                                        FALSE,
+                                        &inspected1, &inspected2);
+    cut_take_string(inspected1);
+    cut_take_string(inspected2);
+
+    cut_assert_equal_string("...\n"
+                            ZERO_ROW("0x00000040") "\n"
+                            ZERO_ROW("0x00000050") "\n"
+                            ZERO_ROW("0x00000060") "\n"
+                            ZERO_ROW("0x00000070") "\n"
+                            ZERO_ROW("0x00000080") "\n"
+                            "...",
+                            inspected1);
+    cut_assert_equal_string("...\n"
+                            ZERO_ROW("0x00000040") "\n"
+                            ZERO_ROW("0x00000050") "\n"
+                            "0x00000060: "
+                            "00 00 00 00 41 00 00 00 00 00 00 00 00 00 00 00  "
+                            "....A...........\n"
+                            ZERO_ROW("0x00000070") "\n"
+                            ZERO_ROW("0x00000080") "\n"
+                            "...",
+                            inspected2);
+}
+
+void
+test_inspect_memory_difference_full (void)
+{
+    gchar memory1[] = {'a', 'b', 'c'};
+    gchar memory2[] = {'a', 'b', 'c', 'd', 0x00};
+    CutMemoryDifference difference;
+    gchar *inspected1, *inspected2;
+
+    cut_assert_true(cut_utils_find_memory_difference(memory1, sizeof(memory1),
+                                                     memory2, sizeof(memory2),
+                                                     &difference));
+    cut_utils_inspect_memory_difference(memory1, sizeof(memory1),
+                                        memory2, sizeof(memory2),
+                                        &difference,
+                                        TRUE,
+                                        &inspected1, &inspected2);
+    cut_take_string(inspected1);
+    cut_take_string(inspected2);
+
+    cut_assert_equal_string("0x00000000: 61 62 63"
+                            "                                         "
+                            "abc",
+                            inspected1);
+    cut_assert_equal_string("0x00000000: 61 62 63 64 00"
+                            "                                   "
+                            "abcd.",
+                            inspected2);
+}
+
+#undef ZERO_ROW
+
 void
 test_compare_string_array (void)
 {
@@ -0,0 +1,474 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ *  Copyright (C) 2014  Kouhei Sutou <kou@clear-code.com>
+ *
+ *  This library is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gcutter.h>
+#include <cutter/cut-test-runner.h>
+#include <cutter/cut-listener.h>
+#include <cutter/cut-stream.h>
+#include <cutter/cut-stream-parser.h>
+#include <cutter/cut-xml-pull-parser.h>
+#include "../lib/cuttest-event-receiver.h"
+
+void data_events (void);
+void test_events (gconstpointer data);
+void test_mismatched_end_element (void);
+void test_unclosed_element (void);
+void test_empty (void);
+void test_parse_error_position (void);
+void test_stream (void);
+
+static CutXMLPullParser *pull_parser;
+static GMarkupParseContext *markup_context;
+static GString *pull_events;
+static GString *markup_events;
+static gboolean markup_in_text;
+
+static CutStream *stream;
+static CutRunContext *run_context;
+static CutTestCase *test_case;
+static CutTestSuite *test_suite;
+static CutTestContext *test_context;
+static GString *xml;
+
+static void
+stub_success_test (void)
+{
+    cut_assert_true(TRUE);
+}
+
+static void
+stub_failure_test (void)
+{
+    cut_assert_equal_string("<expected> & \"quoted\"", "actual");
+}
+
+static void
+stub_iterated_data (void)
+{
+    cut_add_data("first data", NULL, NULL,
+                 "second data", NULL, NULL,
+                 NULL);
+}
+
+static void
+stub_iterated_test (gconstpointer data)
+{
+    cut_assert_true(TRUE);
+}
+
+static void
+append_text_event (GString *events, gboolean in_text,
+                   const gchar *text, gsize text_len)
+{
+    gchar *text_copy, *escaped_text;
+
+    if (!in_text)
+        g_string_append(events, "text: ");
+    else
+        g_string_truncate(events, events->len - 1);
+    text_copy = g_strndup(text, text_len);
+    escaped_text = g_strescape(text_copy, NULL);
+    g_string_append(events, escaped_text);
+    g_string_append(events, "\n");
+    g_free(escaped_text);
+    g_free(text_copy);
+}
+
+static void
+markup_start_element (GMarkupParseContext *context,
+                      const gchar         *element_name,
+                      const gchar        **attribute_names,
+                      const gchar        **attribute_values,
+                      gpointer             user_data,
+                      GError             **error)
+{
+    g_string_append_printf(markup_events, "start: %s\n", element_name);
+    markup_in_text = FALSE;
+}
+
+static void
+markup_end_element (GMarkupParseContext *context,
+                    const gchar         *element_name,
+                    gpointer             user_data,
+                    GError             **error)
+{
+    g_string_append_printf(markup_events, "end: %s\n", element_name);
+    markup_in_text = FALSE;
+}
+
+static void
+markup_text (GMarkupParseContext *context,
+             const gchar         *text,
+             gsize                text_len,
+             gpointer             user_data,
+             GError             **error)
+{
+    if (text_len == 0)
+        return;
+    append_text_event(markup_events, markup_in_text, text, text_len);
+    markup_in_text = TRUE;
+}
+
+static GMarkupParser markup_parser = {
+    markup_start_element,
+    markup_end_element,
+    markup_text,
+    NULL,
+    NULL,
+};
+
+void
+cut_setup (void)
+{
+    const gchar *test_names[] = {"/.*/", NULL};
+
+    pull_parser = cut_xml_pull_parser_new();
+    markup_context = g_markup_parse_context_new(&markup_parser,
+                                                G_MARKUP_TREAT_CDATA_AS_TEXT,
+                                                NULL, NULL);
+    pull_events = g_string_new(NULL);
+    markup_events = g_string_new(NULL);
+    markup_in_text = FALSE;
+
+    stream = NULL;
+    test_context = NULL;
+    run_context = CUT_RUN_CONTEXT(cut_test_runner_new());
+    cut_run_context_set_target_test_names(run_context, test_names);
+    test_case = cut_test_case_new("stub test case",
+                                  NULL, NULL, NULL, NULL);
+    test_suite = cut_test_suite_new_empty();
+    cut_test_suite_add_test_case(test_suite, test_case);
+    xml = g_string_new(NULL);
+}
+
+void
+cut_teardown (void)
+{
+    cut_xml_pull_parser_free(pull_parser);
+    g_markup_parse_context_free(markup_context);
+    g_string_free(pull_events, TRUE);
+    g_string_free(markup_events, TRUE);
+
+    if (test_context)
+        g_object_unref(test_context);
+    if (stream)
+        g_object_unref(stream);
+    g_object_unref(test_case);
+    g_object_unref(test_suite);
+    g_object_unref(run_context);
+    g_string_free(xml, TRUE);
+}
+
+static gboolean
+pull (GError **error)
+{
+    gboolean in_text = FALSE;
+
+    while (TRUE) {
+        const gchar *text;
+        gsize text_len;
+
+        switch (cut_xml_pull_parser_next(pull_parser, error)) {
+          case CUT_XML_PULL_PARSER_NEED_MORE:
+            return TRUE;
+          case CUT_XML_PULL_PARSER_START_ELEMENT:
+            g_string_append_printf(pull_events, "start: %s\n",
+                                   cut_xml_pull_parser_get_element_name(pull_parser));
+            in_text = FALSE;
+            break;
+          case CUT_XML_PULL_PARSER_END_ELEMENT:
+            g_string_append_printf(pull_events, "end: %s\n",
+                                   cut_xml_pull_parser_get_element_name(pull_parser));
+            in_text = FALSE;
+            break;
+          case CUT_XML_PULL_PARSER_TEXT:
+            text = cut_xml_pull_parser_get_text(pull_parser, &text_len);
+            append_text_event(pull_events, in_text, text, text_len);
+            in_text = TRUE;
+            break;
+          case CUT_XML_PULL_PARSER_ERROR:
+            return FALSE;
+        }
+    }
+}
+
+static gboolean
+parse_by_pull_parser (const gchar *document, gsize chunk_size,
+                      GError **error)
+{
+    gsize i, length;
+
+    length = strlen(document);
+    for (i = 0; i < length; i += chunk_size) {
+        cut_xml_pull_parser_feed(pull_parser, document + i,
+                                 MIN(chunk_size, length - i));
+        if (!pull(error))
+            return FALSE;
+    }
+
+    return cut_xml_pull_parser_end(pull_parser, error);
+}
+
+static gboolean
+parse_by_markup (const gchar *document, GError **error)
+{
+    if (!g_markup_parse_context_parse(markup_context, document, -1, error))
+        return FALSE;
+    return g_markup_parse_context_end_parse(markup_context, error);
+}
+
+void
+data_events (void)
+{
+    cut_add_data("stream",
+                 "<stream>\n"
+                 "  <test>\n"
+                 "    <name>test &amp; &lt;name&gt;</name>\n"
+                 "    <description>&quot;quoted&quot; &apos;text&apos;"
+                 "</description>\n"
+                 "  </test>\n"
+                 "</stream>\n",
+                 NULL,
+                 "prolog",
+                 "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                 "<!-- comment -->\n"
+                 "<stream><success>TRUE</success></stream>\n",
+                 NULL,
+                 "CDATA and comment",
+                 "<stream><detail>x<!-- comment -->y"
+                 "<![CDATA[<z> & ]]>w</detail></stream>",
+                 NULL,
+                 "empty element",
+                 "<stream><empty/><empty-with-space /></stream>",
+                 NULL,
+                 "attributes",
+                 "<stream><a key=\"x>y\" other='1'>value</a></stream>",
+                 NULL,
+                 "character reference",
+                 "<stream><a>&#65;&#x42;&#x263A;</a></stream>",
+                 NULL,
+                 "UTF-8",
+                 "<stream><name>\xe6\x97\xa5\xe6\x9c\xac</name></stream>",
+                 NULL,
+                 NULL);
+}
+
+void
+test_events (gconstpointer data)
+{
+    const gchar *document = data;
+    GError *error = NULL;
+    gsize chunk_sizes[] = {1, 3, 64};
+    guint i;
+
+    parse_by_markup(document, &error);
+    gcut_assert_error(error);
+
+    for (i = 0; i < G_N_ELEMENTS(chunk_sizes); i++) {
+        cut_xml_pull_parser_free(pull_parser);
+        pull_parser = cut_xml_pull_parser_new();
+        g_string_truncate(pull_events, 0);
+
+        parse_by_pull_parser(document, chunk_sizes[i], &error);
+        gcut_assert_error(error);
+        cut_assert_equal_string(markup_events->str, pull_events->str,
+                                cut_message("chunk size: %" G_GSIZE_FORMAT,
+                                            chunk_sizes[i]));
+    }
+}
+
+void
+test_mismatched_end_element (void)
+{
+    GError *error = NULL;
+    const GError *taken_error;
+
+    cut_assert_false(parse_by_markup("<stream><a></b></stream>", NULL));
+    cut_assert_false(parse_by_pull_parser("<stream><a></b></stream>", 1,
+                                          &error));
+    taken_error = gcut_take_error(error);
+    cut_assert_equal_int(G_MARKUP_ERROR_PARSE, taken_error->code);
+    cut_assert_equal_string("Error on line 1 char 16: "
+                            "Element 'b' was closed, "
+                            "but the currently open element is 'a'",
+                            taken_error->message);
+}
+
+void
+test_unclosed_element (void)
+{
+    GError *error = NULL;
+    const GError *taken_error;
+
+    cut_assert_false(parse_by_markup("<stream><a>", NULL));
+    cut_assert_false(parse_by_pull_parser("<stream><a>", 4, &error));
+    taken_error = gcut_take_error(error);
+    cut_assert_equal_int(G_MARKUP_ERROR_PARSE, taken_error->code);
+}
+
+void
+test_empty (void)
+{
+    GError *error = NULL;
+    const GError *taken_error;
+
+    cut_assert_false(parse_by_pull_parser(" \n", 1, &error));
+    taken_error = gcut_take_error(error);
+    cut_assert_equal_int(G_MARKUP_ERROR_EMPTY, taken_error->code);
+}
+
+static gchar *
+parse_error_message (gboolean use_pull_parser, const gchar *document)
+{
+    CutStreamParser *parser;
+    GError *error = NULL;
+    gchar *message = NULL;
+
+    parser = g_object_new(CUT_TYPE_STREAM_PARSER,
+                          "use-pull-parser", use_pull_parser,
+                          NULL);
+    if (!cut_stream_parser_parse(parser, document, -1, &error)) {
+        message = g_strdup(error->message);
+        g_error_free(error);
+    }
+    g_object_unref(parser);
+
+    return message;
+}
+
+void
+test_parse_error_position (void)
+{
+    const gchar document[] =
+        "<stream>\n"
+        "  <ready-test-suite>\n"
+        "    <test-suite>\n"
+        "      <invalid/>\n"
+        "    </test-suite>\n"
+        "  </ready-test-suite>\n"
+        "</stream>\n";
+
+    cut_assert_equal_string_with_free(parse_error_message(FALSE, document),
+                                      parse_error_message(TRUE, document));
+}
+
+static gboolean
+stream_to_string (const gchar *data, gsize length, GError **error,
+                  gpointer user_data)
+{
+    GString *string = user_data;
+
+    g_string_append_len(string, data, length);
+
+    return TRUE;
+}
+
+static void
+run (void)
+{
+    stream = cut_stream_new("xml",
+                            "stream-write-function", stream_to_string,
+                            "stream-write-function-user-data", xml,
+                            NULL);
+    cut_listener_attach_to_run_context(CUT_LISTENER(stream), run_context);
+
+    test_context = cut_test_context_new(run_context,
+                                        NULL, test_case, NULL, NULL);
+    cut_test_context_current_push(test_context);
+    cut_test_runner_run_test_suite(CUT_TEST_RUNNER(run_context), test_suite);
+    cut_test_context_current_pop();
+
+    cut_listener_detach_from_run_context(CUT_LISTENER(stream), run_context);
+}
+
+static CuttestEventReceiver *
+parse_stream (gboolean use_pull_parser, gsize chunk_size)
+{
+    CutRunContext *receiver_context;
+    CutStreamParser *parser;
+    GError *error = NULL;
+    gsize i;
+
+    receiver_context = cuttest_event_receiver_new();
+    gcut_take_object(G_OBJECT(receiver_context));
+    parser = g_object_new(CUT_TYPE_STREAM_PARSER,
+                          "run-context", receiver_context,
+                          "use-pull-parser", use_pull_parser,
+                          NULL);
+    gcut_take_object(G_OBJECT(parser));
+
+    for (i = 0; i < xml->len; i += chunk_size) {
+        cut_stream_parser_parse(parser, xml->str + i,
+                                MIN(chunk_size, xml->len - i), &error);
+        gcut_assert_error(error);
+    }
+    cut_stream_parser_end_parse(parser, &error);
+    gcut_assert_error(error);
+
+    return CUTTEST_EVENT_RECEIVER(receiver_context);
+}
+
+void
+test_stream (void)
+{
+    CuttestEventReceiver *markup_receiver, *pull_receiver;
+    CuttestFailureTestInfo *markup_info, *pull_info;
+
+    cut_test_case_add_test(test_case,
+                           cut_test_new("stub-success-test",
+                                        stub_success_test));
+    cut_test_case_add_test(test_case,
+                           cut_test_new("stub-failure-test",
+                                        stub_failure_test));
+    cut_test_case_add_test(test_case,
+                           CUT_TEST(cut_test_iterator_new("stub-iterated-test",
+                                                          stub_iterated_test,
+                                                          stub_iterated_data)));
+    run();
+
+    markup_receiver = parse_stream(FALSE, xml->len);
+    pull_receiver = parse_stream(TRUE, 7);
+
+    cut_assert_equal_uint(1, pull_receiver->n_start_runs);
+    cut_assert_equal_uint(g_list_length(markup_receiver->start_tests),
+                          g_list_length(pull_receiver->start_tests));
+    cut_assert_equal_uint(g_list_length(markup_receiver->complete_tests),
+                          g_list_length(pull_receiver->complete_tests));
+    cut_assert_equal_uint(g_list_length(markup_receiver->start_iterated_tests),
+                          g_list_length(pull_receiver->start_iterated_tests));
+    cut_assert_equal_uint(g_list_length(markup_receiver->complete_runs),
+                          g_list_length(pull_receiver->complete_runs));
+    cut_assert_equal_uint(
+        cut_run_context_get_n_assertions(CUT_RUN_CONTEXT(markup_receiver)),
+        cut_run_context_get_n_assertions(CUT_RUN_CONTEXT(pull_receiver)));
+
+    cut_assert_equal_uint(1, g_list_length(pull_receiver->failure_tests));
+    markup_info = markup_receiver->failure_tests->data;
+    pull_info = pull_receiver->failure_tests->data;
+    cut_assert_equal_string(
+        cut_test_result_get_expected(markup_info->test_result),
+        cut_test_result_get_expected(pull_info->test_result));
+    cut_assert_equal_string(
+        cut_test_result_get_message(markup_info->test_result),
+        cut_test_result_get_message(pull_info->test_result));
+}
+
+/*
+vi:ts=4:nowrap:ai:expandtab:sw=4
+*/
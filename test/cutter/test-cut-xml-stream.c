@@ -31,6 +31,8 @@
 void attributes_stream (void);
 void data_stream (void);
 void test_stream (gconstpointer data);
+void test_buffered (void);
+void test_flush_each_event (void);
 
 static CutStream *stream;
 static CutRunContext *run_context;
@@ -42,6 +44,7 @@ static CutTestSuite *test_suite;
 static CutTestContext *test_context;
 
 static GString *xml;
+static guint n_flows;
 
 static void
 stub_success_test (void)
@@ -75,6 +78,7 @@ cut_setup (void)
     test_context = NULL;
     stream = NULL;
     xml = NULL;
+    n_flows = 0;
 
     run_context = CUT_RUN_CONTEXT(cut_test_runner_new());
     cut_run_context_set_target_test_names(run_context, test_names);
@@ -234,6 +238,53 @@ test_stream (gconstpointer data)
     cut_assert_equal_string(expected, normalize_xml(xml->str));
 }
 
+static gboolean
+stream_to_string_with_count (const gchar *message, GError **error,
+                             gpointer user_data)
+{
+    n_flows++;
+    return stream_to_string(message, error, user_data);
+}
+
+static const gchar *
+run_with_buffer_size (guint buffer_size)
+{
+    xml = g_string_new(NULL);
+    stream = cut_stream_new("xml",
+                            "stream-function", stream_to_string_with_count,
+                            "stream-function-user-data", xml,
+                            "buffer-size", buffer_size,
+                            NULL);
+    cut_listener_attach_to_run_context(CUT_LISTENER(stream), run_context);
+    cut_assert(run());
+    cut_listener_detach_from_run_context(CUT_LISTENER(stream), run_context);
+
+    return normalize_xml(xml->str);
+}
+
+void
+test_buffered (void)
+{
+    const gchar *expected;
+
+    setup_success_test();
+    expected = cut_get_fixture_data_string("test.xml", NULL);
+    cut_assert_equal_string(expected, run_with_buffer_size(G_MAXUINT));
+    /* flushed at test case and test suite completion */
+    cut_assert_equal_uint(2, n_flows);
+}
+
+void
+test_flush_each_event (void)
+{
+    const gchar *expected;
+
+    setup_success_test();
+    expected = cut_get_fixture_data_string("test.xml", NULL);
+    cut_assert_equal_string(expected, run_with_buffer_size(0));
+    cut_assert_operator_uint(2, <, n_flows);
+}
+
 /*
 vi:ts=4:nowrap:ai:expandtab:sw=4
 */
@@ -51,6 +51,8 @@ void test_version (void);
 void test_invalid_option (void);
 void test_invalid_color_option (void);
 void test_invalid_order_option (void);
+void data_invalid_shard_option (void);
+void test_invalid_shard_option (gconstpointer data);
 void test_invalid_verbose_option (void);
 void test_no_option (void);
 void test_get_test_directory (void);
@@ -91,36 +93,49 @@ cut_setup (void)
         "" LINE_FEED_CODE
         "Help Options:" LINE_FEED_CODE
 #if GLIB_CHECK_VERSION(2, 21, 0)
-        "  -h, --help                                        Show help options" LINE_FEED_CODE
+        "  -h, --help                                         Show help options" LINE_FEED_CODE
 #else
-        "  -?, --help                                        Show help options" LINE_FEED_CODE
+        "  -?, --help                                         Show help options" LINE_FEED_CODE
 #endif
-        "  --help-all                                        Show all help options" LINE_FEED_CODE
-        "  --help-stream                                     Show stream options" LINE_FEED_CODE
-        "  --help-report                                     Show report options" LINE_FEED_CODE
-        "  --help-ui                                         Show UI options" LINE_FEED_CODE
-        "  --help-console-ui                                 Show console UI options" LINE_FEED_CODE
+        "  --help-all                                         Show all help options" LINE_FEED_CODE
+        "  --help-stream                                      Show stream options" LINE_FEED_CODE
+        "  --help-report                                      Show report options" LINE_FEED_CODE
+        "  --help-ui                                          Show UI options" LINE_FEED_CODE
+        "  --help-console-ui                                  Show console UI options" LINE_FEED_CODE
         "" LINE_FEED_CODE
         "Application Options:" LINE_FEED_CODE
-        "  --version                                         Show version" LINE_FEED_CODE
-        "  --log-level=LEVEL                                 "
+        "  --version                                          Show version" LINE_FEED_CODE
+        "  --log-level=LEVEL                                  "
         "Set log level to LEVEL. LEVEL can be combined them with '|': "
         "(all|default|none|critical|error|warning|message|info|debug|trace) "
         "(default: critical|error|warning|message)" LINE_FEED_CODE
-        "  --mode=[test|analyze|play]                        Set run mode (default: test)" LINE_FEED_CODE
-        "  -s, --source-directory=DIRECTORY                  Set directory of source code" LINE_FEED_CODE
-        "  -n, --name=TEST_NAME                              Specify tests" LINE_FEED_CODE
-        "  -t, --test-case=TEST_CASE_NAME                    Specify test cases" LINE_FEED_CODE
-        "  -m, --multi-thread                                Run test cases and iterated tests with multi-thread" LINE_FEED_CODE
-        "  --max-threads=MAX_THREADS                         Run test cases and iterated tests with MAX_THREADS threads concurrently at a maximum (default: 10; -1 is no limit)" LINE_FEED_CODE
-        "  --disable-signal-handling                         Disable signal handling" LINE_FEED_CODE
-        "  --test-case-order=[none|name|name-desc]           Sort test case by. Default is 'none'." LINE_FEED_CODE
-        "  --exclude-file=FILE                               Skip files" LINE_FEED_CODE
-        "  --exclude-directory=DIRECTORY                     Skip directories" LINE_FEED_CODE
-        "  --fatal-failures                                  Treat failures as fatal problem" LINE_FEED_CODE
-        "  --keep-opening-modules                            Keep opening loaded modules to resolve symbols for debugging" LINE_FEED_CODE
-        "  --enable-convenience-attribute-definition         Enable convenience but danger '#{ATTRIBUTE_NAME}_#{TEST_NAME - 'test_' PREFIX}' attribute set function" LINE_FEED_CODE
-        "  --stop-before-test                                Set breakpoints at each line which invokes test. You can step into a test function with your debugger easily." LINE_FEED_CODE
+        "  --mode=[test|analyze|play]                         Set run mode (default: test)" LINE_FEED_CODE
+        "  -s, --source-directory=DIRECTORY                   Set directory of source code" LINE_FEED_CODE
+        "  -n, --name=TEST_NAME                               Specify tests" LINE_FEED_CODE
+        "  -t, --test-case=TEST_CASE_NAME                     Specify test cases" LINE_FEED_CODE
+        "  -m, --multi-thread                                 Run test cases and iterated tests with multi-thread" LINE_FEED_CODE
+        "  --max-threads=MAX_THREADS                          Run test cases and iterated tests with MAX_THREADS threads concurrently at a maximum (default: 10; -1 is no limit)" LINE_FEED_CODE
+        "  --multi-process=N_PROCESSES                        Run test cases in N_PROCESSES forked worker processes (default: 0; 0 or 1 is disabled)" LINE_FEED_CODE
+        "  --shard=INDEX/COUNT                                Run only test cases in the INDEX-th (0 origin) of COUNT shards" LINE_FEED_CODE
+        "  --shard-log=FILE                                   Partition test cases for --shard by elapsed time in FILE" LINE_FEED_CODE
+        "  --disable-signal-handling                          Disable signal handling" LINE_FEED_CODE
+        "  --test-case-order=[none|name|name-desc|elapsed]    Sort test case by. Default is 'none'." LINE_FEED_CODE
+        "  --log-directory=DIRECTORY                          Read logs of previous runs in DIRECTORY for --test-case-order=elapsed" LINE_FEED_CODE
+        "  --exclude-file=FILE                                Skip files" LINE_FEED_CODE
+        "  --exclude-directory=DIRECTORY                      Skip directories" LINE_FEED_CODE
+        "  --test-index=FILE                                  Cache symbols of test modules in FILE to skip scanning unchanged modules" LINE_FEED_CODE
+        "  --keep-results=[all|failures|none]                 Keep results of tests until the end of run. 'failures' releases results of succeeded tests after they are reported. 'none' releases all results after they are reported. Default is 'all'." LINE_FEED_CODE
+        "  --elapsed-regression=[none|notification|failure]   Report tests that are significantly slower than in previous runs in --log-directory. Default is 'none'." LINE_FEED_CODE
+        "  --elapsed-regression-threshold=THRESHOLD           Report a test as slow when it is slower than the median of previous runs by more than THRESHOLD times the scaled MAD (default: 5.0)" LINE_FEED_CODE
+        "  --benchmark-filter=NAME                            Measure benchmarks whose name is NAME. Other benchmarks are run only once as tests." LINE_FEED_CODE
+        "  --benchmark-min-time=SECONDS                       Run a measured benchmark for SECONDS at least (default: 1.0)" LINE_FEED_CODE
+        "  --measure-resource-usage                           Measure CPU time, memory, page faults and context switches used by each test" LINE_FEED_CODE
+        "  --measure-phases                                   Measure elapsed time of startup, shutdown, data setup, setup, test and teardown separately" LINE_FEED_CODE
+        "  --full-memory-dump                                 Show whole memories instead of differences on memory assertion failures" LINE_FEED_CODE
+        "  --fatal-failures                                   Treat failures as fatal problem" LINE_FEED_CODE
+        "  --keep-opening-modules                             Keep opening loaded modules to resolve symbols for debugging" LINE_FEED_CODE
+        "  --enable-convenience-attribute-definition          Enable convenience but danger '#{ATTRIBUTE_NAME}_#{TEST_NAME - 'test_' PREFIX}' attribute set function" LINE_FEED_CODE
+        "  --stop-before-test                                 Set breakpoints at each line which invokes test. You can step into a test function with your debugger easily." LINE_FEED_CODE
       "" LINE_FEED_CODE;
     help_message = cut_take_printf(format,
                                    g_get_prgname(),
@@ -219,92 +234,108 @@ test_help_all (void)
         "" LINE_FEED_CODE
         "Help Options:" LINE_FEED_CODE
 #if GLIB_CHECK_VERSION(2, 21, 0)
-        "  -h, --help                                        Show help options" LINE_FEED_CODE
+        "  -h, --help                                         Show help options" LINE_FEED_CODE
 #else
-        "  -?, --help                                        Show help options" LINE_FEED_CODE
+        "  -?, --help                                         Show help options" LINE_FEED_CODE
 #endif
-        "  --help-all                                        Show all help options" LINE_FEED_CODE
-        "  --help-stream                                     Show stream options" LINE_FEED_CODE
-        "  --help-report                                     Show report options" LINE_FEED_CODE
-        "  --help-ui                                         Show UI options" LINE_FEED_CODE
-        "  --help-console-ui                                 Show console UI options" LINE_FEED_CODE
+        "  --help-all                                         Show all help options" LINE_FEED_CODE
+        "  --help-stream                                      Show stream options" LINE_FEED_CODE
+        "  --help-report                                      Show report options" LINE_FEED_CODE
+        "  --help-ui                                          Show UI options" LINE_FEED_CODE
+        "  --help-console-ui                                  Show console UI options" LINE_FEED_CODE
 #ifdef HAVE_GTK
-        "  --help-gtk                                        Show GTK+ Options" LINE_FEED_CODE
+        "  --help-gtk                                         Show GTK+ Options" LINE_FEED_CODE
 #endif
         "" LINE_FEED_CODE
         "Stream Options" LINE_FEED_CODE
-        "  --stream=[xml]                                    Specify stream" LINE_FEED_CODE
-        "  --stream-fd=FILE_DESCRIPTOR                       Stream to FILE_DESCRIPTOR (default: stdout)" LINE_FEED_CODE
-        "  --stream-directory=DIRECTORY                      Stream to a file under DIRECTORY (default: none)" LINE_FEED_CODE
-        "  --stream-log-directory=DIRECTORY                  Obsoleted. Use --stream-directory instead" LINE_FEED_CODE
+        "  --stream=[binary|xml]                              Specify stream" LINE_FEED_CODE
+        "  --stream-fd=FILE_DESCRIPTOR                        Stream to FILE_DESCRIPTOR (default: stdout)" LINE_FEED_CODE
+        "  --stream-directory=DIRECTORY                       Stream to a file under DIRECTORY (default: none)" LINE_FEED_CODE
+        "  --stream-log-directory=DIRECTORY                   Obsoleted. Use --stream-directory instead" LINE_FEED_CODE
+        "  --stream-buffer-size=SIZE                          Buffer SIZE bytes before streaming. 0 streams each event immediately" LINE_FEED_CODE
         "" LINE_FEED_CODE
         "Report Options" LINE_FEED_CODE
 #if defined(HAVE_PANGO_CAIRO) && defined(HAVE_CAIRO_PDF)
-        "  --pdf-report=FILE                                 Set filename of pdf report" LINE_FEED_CODE
+        "  --pdf-report=FILE                                  Set filename of pdf report" LINE_FEED_CODE
 #endif
-        "  --xml-report=FILE                                 Set filename of xml report" LINE_FEED_CODE
+        "  --trace-report=FILE                                Set filename of trace report" LINE_FEED_CODE
+        "  --xml-report=FILE                                  Set filename of xml report" LINE_FEED_CODE
         "" LINE_FEED_CODE
         "UI Options" LINE_FEED_CODE
 #ifdef HAVE_GTK
-        "  -u, --ui=[console|gtk]                            Specify UI" LINE_FEED_CODE
+        "  -u, --ui=[console|gtk]                             Specify UI" LINE_FEED_CODE
 #else
-        "  -u, --ui=[console]                                Specify UI" LINE_FEED_CODE
+        "  -u, --ui=[console]                                 Specify UI" LINE_FEED_CODE
 #endif
         "" LINE_FEED_CODE
         "Console UI Options" LINE_FEED_CODE
-        "  -v, --verbose=[s|silent|n|normal|v|verbose]       Set verbose level" LINE_FEED_CODE
-        "  -c, --color=[yes|true|no|false|auto]              Output log with colors" LINE_FEED_CODE
-        "  --notify=[yes|true|no|false|auto]                 Notify test result" LINE_FEED_CODE
-        "  --show-detail-immediately=[yes|true|no|false]     Show test detail immediately" LINE_FEED_CODE
+        "  -v, --verbose=[s|silent|n|normal|v|verbose]        Set verbose level" LINE_FEED_CODE
+        "  -c, --color=[yes|true|no|false|auto]               Output log with colors" LINE_FEED_CODE
+        "  --notify=[yes|true|no|false|auto]                  Notify test result" LINE_FEED_CODE
+        "  --show-detail-immediately=[yes|true|no|false]      Show test detail immediately" LINE_FEED_CODE
+        "  --show-resource-usage=N                            Show top N tests by resource usage (0 disables)" LINE_FEED_CODE
         "" LINE_FEED_CODE
 #ifdef HAVE_GTK
         "GTK+ Options" LINE_FEED_CODE
-        "  --class=CLASS                                     Program class as used by the window manager" LINE_FEED_CODE
-        "  --gtk-name=NAME                                   Program name as used by the window manager" LINE_FEED_CODE
-        "  --screen=SCREEN                                   X screen to use" LINE_FEED_CODE
+        "  --class=CLASS                                      Program class as used by the window manager" LINE_FEED_CODE
+        "  --gtk-name=NAME                                    Program name as used by the window manager" LINE_FEED_CODE
+        "  --screen=SCREEN                                    X screen to use" LINE_FEED_CODE
 #  ifdef HAVE_GTK_ENABLE_DEBUG
-        "  --gdk-debug=FLAGS                                 GDK debugging flags to set" LINE_FEED_CODE
-        "  --gdk-no-debug=FLAGS                              GDK debugging flags to unset" LINE_FEED_CODE
+        "  --gdk-debug=FLAGS                                  GDK debugging flags to set" LINE_FEED_CODE
+        "  --gdk-no-debug=FLAGS                               GDK debugging flags to unset" LINE_FEED_CODE
 #  endif
 #  ifdef GDK_WINDOWING_X11
-        "  --sync                                            Make X calls synchronous" LINE_FEED_CODE
+        "  --sync                                             Make X calls synchronous" LINE_FEED_CODE
 #  elif defined(GDK_WINDOWING_WIN32)
-        "  --sync                                            Don't batch GDI requests" LINE_FEED_CODE
-        "  --no-wintab                                       Don't use the Wintab API for tablet support" LINE_FEED_CODE
-        "  --ignore-wintab                                   Same as --no-wintab" LINE_FEED_CODE
-        "  --use-wintab                                      Do use the Wintab API [default]" LINE_FEED_CODE
-        "  --max-colors=COLORS                               Size of the palette in 8 bit mode" LINE_FEED_CODE
+        "  --sync                                             Don't batch GDI requests" LINE_FEED_CODE
+        "  --no-wintab                                        Don't use the Wintab API for tablet support" LINE_FEED_CODE
+        "  --ignore-wintab                                    Same as --no-wintab" LINE_FEED_CODE
+        "  --use-wintab                                       Do use the Wintab API [default]" LINE_FEED_CODE
+        "  --max-colors=COLORS                                Size of the palette in 8 bit mode" LINE_FEED_CODE
 #  endif
-        "  --gtk-module=MODULES                              Load additional GTK+ modules" LINE_FEED_CODE
-        "  --g-fatal-warnings                                Make all warnings fatal" LINE_FEED_CODE
+        "  --gtk-module=MODULES                               Load additional GTK+ modules" LINE_FEED_CODE
+        "  --g-fatal-warnings                                 Make all warnings fatal" LINE_FEED_CODE
 #  ifdef HAVE_GTK_ENABLE_DEBUG
-        "  --gtk-debug=FLAGS                                 GTK+ debugging flags to set" LINE_FEED_CODE
-        "  --gtk-no-debug=FLAGS                              GTK+ debugging flags to unset" LINE_FEED_CODE
+        "  --gtk-debug=FLAGS                                  GTK+ debugging flags to set" LINE_FEED_CODE
+        "  --gtk-no-debug=FLAGS                               GTK+ debugging flags to unset" LINE_FEED_CODE
 #  endif
         "" LINE_FEED_CODE
 #endif
         "Application Options:" LINE_FEED_CODE
-        "  --version                                         Show version" LINE_FEED_CODE
-        "  --log-level=LEVEL                                 "
+        "  --version                                          Show version" LINE_FEED_CODE
+        "  --log-level=LEVEL                                  "
         "Set log level to LEVEL. LEVEL can be combined them with '|': "
         "(all|default|none|critical|error|warning|message|info|debug|trace) "
         "(default: critical|error|warning|message)" LINE_FEED_CODE
-        "  --mode=[test|analyze|play]                        Set run mode (default: test)" LINE_FEED_CODE
-        "  -s, --source-directory=DIRECTORY                  Set directory of source code" LINE_FEED_CODE
-        "  -n, --name=TEST_NAME                              Specify tests" LINE_FEED_CODE
-        "  -t, --test-case=TEST_CASE_NAME                    Specify test cases" LINE_FEED_CODE
-        "  -m, --multi-thread                                Run test cases and iterated tests with multi-thread" LINE_FEED_CODE
-        "  --max-threads=MAX_THREADS                         Run test cases and iterated tests with MAX_THREADS threads concurrently at a maximum (default: 10; -1 is no limit)" LINE_FEED_CODE
-        "  --disable-signal-handling                         Disable signal handling" LINE_FEED_CODE
-        "  --test-case-order=[none|name|name-desc]           Sort test case by. Default is 'none'." LINE_FEED_CODE
-        "  --exclude-file=FILE                               Skip files" LINE_FEED_CODE
-        "  --exclude-directory=DIRECTORY                     Skip directories" LINE_FEED_CODE
-        "  --fatal-failures                                  Treat failures as fatal problem" LINE_FEED_CODE
-        "  --keep-opening-modules                            Keep opening loaded modules to resolve symbols for debugging" LINE_FEED_CODE
-        "  --enable-convenience-attribute-definition         Enable convenience but danger '#{ATTRIBUTE_NAME}_#{TEST_NAME - 'test_' PREFIX}' attribute set function" LINE_FEED_CODE
-        "  --stop-before-test                                Set breakpoints at each line which invokes test. You can step into a test function with your debugger easily." LINE_FEED_CODE
+        "  --mode=[test|analyze|play]                         Set run mode (default: test)" LINE_FEED_CODE
+        "  -s, --source-directory=DIRECTORY                   Set directory of source code" LINE_FEED_CODE
+        "  -n, --name=TEST_NAME                               Specify tests" LINE_FEED_CODE
+        "  -t, --test-case=TEST_CASE_NAME                     Specify test cases" LINE_FEED_CODE
+        "  -m, --multi-thread                                 Run test cases and iterated tests with multi-thread" LINE_FEED_CODE
+        "  --max-threads=MAX_THREADS                          Run test cases and iterated tests with MAX_THREADS threads concurrently at a maximum (default: 10; -1 is no limit)" LINE_FEED_CODE
+        "  --multi-process=N_PROCESSES                        Run test cases in N_PROCESSES forked worker processes (default: 0; 0 or 1 is disabled)" LINE_FEED_CODE
+        "  --shard=INDEX/COUNT                                Run only test cases in the INDEX-th (0 origin) of COUNT shards" LINE_FEED_CODE
+        "  --shard-log=FILE                                   Partition test cases for --shard by elapsed time in FILE" LINE_FEED_CODE
+        "  --disable-signal-handling                          Disable signal handling" LINE_FEED_CODE
+        "  --test-case-order=[none|name|name-desc|elapsed]    Sort test case by. Default is 'none'." LINE_FEED_CODE
+        "  --log-directory=DIRECTORY                          Read logs of previous runs in DIRECTORY for --test-case-order=elapsed" LINE_FEED_CODE
+        "  --exclude-file=FILE                                Skip files" LINE_FEED_CODE
+        "  --exclude-directory=DIRECTORY                      Skip directories" LINE_FEED_CODE
+        "  --test-index=FILE                                  Cache symbols of test modules in FILE to skip scanning unchanged modules" LINE_FEED_CODE
+        "  --keep-results=[all|failures|none]                 Keep results of tests until the end of run. 'failures' releases results of succeeded tests after they are reported. 'none' releases all results after they are reported. Default is 'all'." LINE_FEED_CODE
+        "  --elapsed-regression=[none|notification|failure]   Report tests that are significantly slower than in previous runs in --log-directory. Default is 'none'." LINE_FEED_CODE
+        "  --elapsed-regression-threshold=THRESHOLD           Report a test as slow when it is slower than the median of previous runs by more than THRESHOLD times the scaled MAD (default: 5.0)" LINE_FEED_CODE
+        "  --benchmark-filter=NAME                            Measure benchmarks whose name is NAME. Other benchmarks are run only once as tests." LINE_FEED_CODE
+        "  --benchmark-min-time=SECONDS                       Run a measured benchmark for SECONDS at least (default: 1.0)" LINE_FEED_CODE
+        "  --measure-resource-usage                           Measure CPU time, memory, page faults and context switches used by each test" LINE_FEED_CODE
+        "  --measure-phases                                   Measure elapsed time of startup, shutdown, data setup, setup, test and teardown separately" LINE_FEED_CODE
+        "  --full-memory-dump                                 Show whole memories instead of differences on memory assertion failures" LINE_FEED_CODE
+        "  --fatal-failures                                   Treat failures as fatal problem" LINE_FEED_CODE
+        "  --keep-opening-modules                             Keep opening loaded modules to resolve symbols for debugging" LINE_FEED_CODE
+        "  --enable-convenience-attribute-definition          Enable convenience but danger '#{ATTRIBUTE_NAME}_#{TEST_NAME - 'test_' PREFIX}' attribute set function" LINE_FEED_CODE
+        "  --stop-before-test                                 Set breakpoints at each line which invokes test. You can step into a test function with your debugger easily." LINE_FEED_CODE
 #ifdef HAVE_GTK
-        "  --display=DISPLAY                                 X display to use" LINE_FEED_CODE
+        "  --display=DISPLAY                                  X display to use" LINE_FEED_CODE
 #endif
         "" LINE_FEED_CODE;
 
@@ -345,6 +376,29 @@ test_invalid_order_option (void)
                             stdout_string);
 }
 
+void
+data_invalid_shard_option (void)
+{
+    cut_add_data("no count", "1", NULL,
+                 "no index", "/2", NULL,
+                 "index == count", "2/2", NULL,
+                 "zero count", "0/0", NULL,
+                 "garbage", "1/2x", NULL);
+}
+
+void
+test_invalid_shard_option (gconstpointer data)
+{
+    const gchar *value = data;
+
+    cut_assert(run_cutter(cut_take_printf("--shard=%s", value)));
+    cut_assert_exit_failure();
+    cut_assert_equal_string(cut_take_printf("Invalid shard value: %s"
+                                            LINE_FEED_CODE,
+                                            value),
+                            stdout_string);
+}
+
 void
 test_invalid_verbose_option (void)
 {
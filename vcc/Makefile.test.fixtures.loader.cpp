@@ -1,6 +1,9 @@
 tests =  \
-	stub-namespace.dll
+	stub-namespace.dll \
+	stub-attribute.dll
 
 stub-namespace.dll: stub-namespace.obj $(top_srcdir)\vcc\resource\test\fixtures\loader\cpp\stub-namespace.def
 	$(CC) $(CFLAGS) $(stub_namespace_CFLAGS) -LD -Fe$@ stub-namespace.obj $(LIBS) $(LDFLAGS) $(stub_namespace_LDFLAGS) /def:$(top_srcdir)\vcc\resource\test\fixtures\loader\cpp\stub-namespace.def
 
+stub-attribute.dll: stub-attribute.obj $(top_srcdir)\vcc\resource\test\fixtures\loader\cpp\stub-attribute.def
+	$(CC) $(CFLAGS) $(stub_attribute_CFLAGS) -LD -Fe$@ stub-attribute.obj $(LIBS) $(LDFLAGS) $(stub_attribute_LDFLAGS) /def:$(top_srcdir)\vcc\resource\test\fixtures\loader\cpp\stub-attribute.def
@@ -18,6 +18,10 @@ GType cut_pipeline_error_get_type (void);
 #define CUT_TYPE_PIPELINE_ERROR (cut_pipeline_error_get_type())
 GType cut_order_get_type (void);
 #define CUT_TYPE_ORDER (cut_order_get_type())
+GType cut_keep_results_get_type (void);
+#define CUT_TYPE_KEEP_RESULTS (cut_keep_results_get_type())
+GType cut_elapsed_regression_get_type (void);
+#define CUT_TYPE_ELAPSED_REGRESSION (cut_elapsed_regression_get_type())
 GType cut_stream_reader_error_get_type (void);
 #define CUT_TYPE_STREAM_READER_ERROR (cut_stream_reader_error_get_type())
 GType cut_test_context_error_get_type (void);
@@ -86,6 +86,14 @@ extern void _gcut_marshal_VOID__OBJECT_OBJECT_BOOLEAN (GClosure     *closure,
                                                        gpointer      invocation_hint,
                                                        gpointer      marshal_data);
 
+/* VOID:OBJECT,OBJECT,UINT (../gcutter/gcut-marshalers.list:12) */
+extern void _gcut_marshal_VOID__OBJECT_OBJECT_UINT (GClosure     *closure,
+                                                    GValue       *return_value,
+                                                    guint         n_param_values,
+                                                    const GValue *param_values,
+                                                    gpointer      invocation_hint,
+                                                    gpointer      marshal_data);
+
 G_END_DECLS
 
 #endif /* ___gcut_marshal_MARSHAL_H__ */
@@ -136,6 +136,7 @@ cut_order_get_type (void)
       { CUT_ORDER_NONE_SPECIFIED, "CUT_ORDER_NONE_SPECIFIED", "none-specified" },
       { CUT_ORDER_NAME_ASCENDING, "CUT_ORDER_NAME_ASCENDING", "name-ascending" },
       { CUT_ORDER_NAME_DESCENDING, "CUT_ORDER_NAME_DESCENDING", "name-descending" },
+      { CUT_ORDER_ELAPSED_DESCENDING, "CUT_ORDER_ELAPSED_DESCENDING", "elapsed-descending" },
       { 0, NULL, NULL }
     };
     etype = g_enum_register_static ("CutOrder", values);
@@ -143,6 +144,36 @@ cut_order_get_type (void)
   return etype;
 }
 GType
+cut_keep_results_get_type (void)
+{
+  static GType etype = 0;
+  if (etype == 0) {
+    static const GEnumValue values[] = {
+      { CUT_KEEP_RESULTS_ALL, "CUT_KEEP_RESULTS_ALL", "all" },
+      { CUT_KEEP_RESULTS_FAILURES, "CUT_KEEP_RESULTS_FAILURES", "failures" },
+      { CUT_KEEP_RESULTS_NONE, "CUT_KEEP_RESULTS_NONE", "none" },
+      { 0, NULL, NULL }
+    };
+    etype = g_enum_register_static ("CutKeepResults", values);
+  }
+  return etype;
+}
+GType
+cut_elapsed_regression_get_type (void)
+{
+  static GType etype = 0;
+  if (etype == 0) {
+    static const GEnumValue values[] = {
+      { CUT_ELAPSED_REGRESSION_NONE, "CUT_ELAPSED_REGRESSION_NONE", "none" },
+      { CUT_ELAPSED_REGRESSION_NOTIFICATION, "CUT_ELAPSED_REGRESSION_NOTIFICATION", "notification" },
+      { CUT_ELAPSED_REGRESSION_FAILURE, "CUT_ELAPSED_REGRESSION_FAILURE", "failure" },
+      { 0, NULL, NULL }
+    };
+    etype = g_enum_register_static ("CutElapsedRegression", values);
+  }
+  return etype;
+}
+GType
 cut_stream_reader_error_get_type (void)
 {
   static GType etype = 0;